@@ -0,0 +1,222 @@
+#include "ltfathelper.h"
+#include "ltfat/thirdparty/fftw3.h"
+#include "cxxopts.hpp"
+#include <algorithm>
+#include <tuple>
+
+template<class T>
+using uni_ptrdel = unique_ptr<T, void(*)( T*)>;
+
+// Plans the DGT and its inverse for one configuration so that FFTW
+// accumulates wisdom for all the FFTs involved.
+static int
+plan_config(ltfat_int L, ltfat_int a, ltfat_int M, ltfat_int gl, ltfat_int W,
+            LTFAT_FIRWIN win, ltfat_dgt_params* params, bool do_complex)
+{
+    ltfat_int N = L / a;
+    int status = 0;
+
+    auto g = uni_ptrdel<LTFAT_REAL>(LTFAT_NAME_REAL(malloc)(gl),
+                                    [](auto * p) { ltfat_free(p); });
+    auto f = uni_ptrdel<LTFAT_REAL>(LTFAT_NAME_REAL(malloc)(L * W),
+                                    [](auto * p) { ltfat_free(p); });
+    auto c = uni_ptrdel<LTFAT_COMPLEX>(LTFAT_NAME_COMPLEX(malloc)(M * N * W),
+                                       [](auto * p) { ltfat_free(p); });
+
+    if (!g || !f || !c) return LTFATERR_NOMEM;
+
+    if ((status = LTFAT_NAME_REAL(firwin)(win, gl, g.get())) < 0)
+        return status;
+
+    LTFAT_NAME(dgtreal_plan)* rplan = NULL;
+    status = LTFAT_NAME(dgtreal_init_gen)(g.get(), gl, g.get(), gl, L, W, a, M,
+                                          f.get(), c.get(), params, &rplan);
+    if (rplan) LTFAT_NAME(dgtreal_done)(&rplan);
+    if (status < 0) return status;
+
+    if (do_complex)
+    {
+        auto gc = uni_ptrdel<LTFAT_COMPLEX>(LTFAT_NAME_COMPLEX(malloc)(gl),
+                                            [](auto * p) { ltfat_free(p); });
+        auto fc = uni_ptrdel<LTFAT_COMPLEX>(LTFAT_NAME_COMPLEX(malloc)(L * W),
+                                            [](auto * p) { ltfat_free(p); });
+        if (!gc || !fc) return LTFATERR_NOMEM;
+
+        for (ltfat_int l = 0; l < gl; l++) gc.get()[l] = g.get()[l];
+
+        LTFAT_NAME_COMPLEX(dgt_plan)* cplan = NULL;
+        status = LTFAT_NAME_COMPLEX(dgt_init_gen)(gc.get(), gl, gc.get(), gl,
+                 L, W, a, M, fc.get(), c.get(), params, &cplan);
+        if (cplan) LTFAT_NAME_COMPLEX(dgt_done)(&cplan);
+        if (status < 0) return status;
+    }
+
+    return status;
+}
+
+int main(int argc, char* argv[])
+{
+    string outFile, inFile;
+    string winstr{"hann"};
+    ltfat_int W = 1;
+    bool do_patient = false;
+    bool do_complex = false;
+    // L, a, M, gl
+    vector<tuple<ltfat_int, ltfat_int, ltfat_int, ltfat_int>> configs;
+
+    try
+    {
+        string examplestr{"Usage:\n" +
+            string(argv[0]) + " -o wisdom.dat L,a,M[,gl][:L2,a2,M2[,gl2]:...]"
+            + "\nExample:\n" +
+            string(argv[0]) + " -o wisdom.dat 44100,441,2048:88200,512,2048,4096"
+        };
+        cxxopts::Options options(argv[0], "\nPre-generation of FFTW wisdom for DGT configurations");
+        options
+        .positional_help("-o wisdom.dat L,a,M[,gl][:L2,a2,M2[,gl2]:...]"
+                         "\n\nPlans DGTs of all given configurations with FFTW_MEASURE"
+                         " (or FFTW_PATIENT) and saves the accumulated wisdom."
+                         " The wisdom can be loaded using ltfat_fftw_wisdom_load.")
+        .show_positional_help();
+
+        options.add_options()
+        ("c,configs", "Configurations (REQUIRED). Format: L,a,M[,gl]:L2,a2,M2[,gl2]:... "
+                      "gl defaults to M. L must be divisible by lcm(a,M). "
+                      "gl smaller than L selects the filter bank algorithm.",
+                      cxxopts::value<string>() )
+        ("o,output", "Output wisdom file (REQUIRED)", cxxopts::value<string>())
+        ("i,input", "Wisdom file to be extended", cxxopts::value<string>())
+        ("w,win", "Window", cxxopts::value<string>()->default_value(winstr))
+        ("W,channels", "Number of channels", cxxopts::value<ltfat_int>()->default_value(to_string(W)))
+        ("patient", "Use FFTW_PATIENT instead of FFTW_MEASURE", cxxopts::value<bool>(do_patient))
+        ("complex", "Include plans for the complex DGT", cxxopts::value<bool>(do_complex))
+        ("help", "Print help");
+
+        options.parse_positional({"configs"});
+
+        auto result = options.parse(argc, argv);
+
+        if (result.count("help"))
+        {
+            cout << options.help({""}) << endl;
+            exit(0);
+        }
+
+        if (result.count("output"))
+            outFile = result["output"].as<string>();
+        else
+        {
+            cout << "No output file specified." << endl;
+            cout << examplestr << endl;
+            exit(1);
+        }
+
+        if (result.count("input"))
+            inFile = result["input"].as<string>();
+
+        if (result.count("win"))
+            winstr = result["win"].as<string>();
+
+        if (result.count("channels"))
+        {
+            W = result["channels"].as<ltfat_int>();
+            if (W <= 0)
+            {
+                cout << "Number of channels must be positive." << endl;
+                exit(1);
+            }
+        }
+
+        if (result.count("configs"))
+        {
+            string toparse = result["configs"].as<string>() + ":";
+
+            int pos;
+            while ((pos = toparse.find(":")) != -1)
+            {
+                string confstr = toparse.substr(0, pos);
+                toparse = toparse.substr(pos + 1, toparse.size() - pos);
+                if ( !confstr.empty() )
+                {
+                    confstr += ",";
+                    vector<ltfat_int> confvec;
+                    int pos2;
+                    while ((pos2 = confstr.find(",")) != -1)
+                    {
+                        string itemstr = confstr.substr(0, pos2);
+                        confstr = confstr.substr(pos2 + 1, confstr.size() - pos2);
+                        if ( !itemstr.empty())
+                            confvec.push_back(stoi(itemstr));
+                    }
+                    if (confvec.size() != 3 && confvec.size() != 4)
+                    {
+                        cout << "Parse error: Configuration should consist of 3 or 4 items: L,a,M or L,a,M,gl" << endl;
+                        exit(1);
+                    }
+                    if (confvec.size() == 3)
+                        confvec.push_back(confvec[2]);
+
+                    configs.push_back(make_tuple(confvec[0], confvec[1], confvec[2], confvec[3]));
+                }
+            }
+        }
+        else
+        {
+            cout << "No configuration specified." << endl;
+            cout << examplestr << endl;
+            exit(1);
+        }
+    }
+    catch (const cxxopts::OptionException& e)
+    {
+        std::cout << "error parsing options: " << e.what() << std::endl;
+        exit(1);
+    }
+
+    transform(winstr.begin(), winstr.end(), winstr.begin(), ::tolower);
+    int winenum = ltfat_str2firwin(winstr.c_str());
+    if ( winenum < 0 )
+    {
+        cout << "Window " << winstr << " not recognized." << endl;
+        exit(1);
+    }
+
+    if (!inFile.empty() && LTFAT_NAME_REAL(fftw_wisdom_load)(inFile.c_str()) < 0)
+    {
+        cout << "Cannot load wisdom from " << inFile << endl;
+        exit(1);
+    }
+
+    auto params = uni_ptrdel<ltfat_dgt_params>(ltfat_dgt_params_allocdef(),
+                  [](auto * p) { ltfat_dgt_params_free(p); });
+    ltfat_dgt_setpar_fftwflags(params.get(), do_patient ? FFTW_PATIENT : FFTW_MEASURE);
+
+    for (auto conf : configs)
+    {
+        ltfat_int L, a, M, gl;
+        tie(L, a, M, gl) = conf;
+
+        auto t1 = Clock::now();
+        int status = plan_config(L, a, M, gl, W, static_cast<LTFAT_FIRWIN>(winenum),
+                                 params.get(), do_complex);
+        auto t2 = Clock::now();
+        int dur = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
+
+        cout << "L=" << L << ", a=" << a << ", M=" << M << ", gl=" << gl;
+        if (status < 0)
+        {
+            cout << ": planning failed with status " << status << endl;
+            exit(1);
+        }
+        cout << ": " << dur << " ms" << endl;
+    }
+
+    if (LTFAT_NAME_REAL(fftw_wisdom_save)(outFile.c_str()) < 0)
+    {
+        cout << "Cannot save wisdom to " << outFile <<
+             ". Is libltfat compiled with FFTW?" << endl;
+        exit(1);
+    }
+
+    return 0;
+}
@@ -59,6 +59,21 @@ LTFAT_API int
 LTFAT_NAME(block_processor_setcallback)(
         LTFAT_NAME(block_processor_state)* p,
         LTFAT_NAME(block_processor_callback)* callback, void* userdata);
+
+/* Recording of the execute timings, see \ref procstats.
+ * setstats is not thread safe, getstats and resetstats can be
+ * called from any thread. */
+LTFAT_API int
+LTFAT_NAME(block_processor_setstats)(
+        LTFAT_NAME(block_processor_state)* p, int enable);
+
+LTFAT_API int
+LTFAT_NAME(block_processor_getstats)(
+        const LTFAT_NAME(block_processor_state)* p, ltfat_procstats* stats);
+
+LTFAT_API int
+LTFAT_NAME(block_processor_resetstats)(
+        LTFAT_NAME(block_processor_state)* p);
 /** @} */
 
 /** \name Extended interface
@@ -76,6 +91,14 @@ LTFAT_NAME(block_processor_execute_compact)(
     LTFAT_NAME(block_processor_state)* p,
     const LTFAT_REAL* in, ltfat_int inLen, ltfat_int chanNo, ltfat_int outLen,
     LTFAT_REAL* out);
+
+/* Interleaved buffers i.e. sample l of channel w is at in[w + l*chanNo].
+ * The samples are copied to and from the FIFOs directly. */
+LTFAT_API int
+LTFAT_NAME(block_processor_execute_interleaved)(
+    LTFAT_NAME(block_processor_state)* p,
+    const LTFAT_REAL* in, ltfat_int inLen, ltfat_int chanNo, ltfat_int outLen,
+    LTFAT_REAL* out);
 /** @} */
 
 /** \name Advanced interface
@@ -128,6 +151,12 @@ LTFAT_NAME(block_processor_advanceby)(
  * The buffer read and write pointers are initialized such that they
  * reflect the processing delay.
  *
+ * One thread may write to the buffer while another thread reads from it
+ * without any locking (single producer, single consumer). The read and
+ * write positions are published with release/acquire semantics.
+ * Resetting the buffer or changing the hop size is only allowed
+ * when neither thread is accessing it.
+ *
  * \param[in]  fifoLen  Ring buffer size. This should be at least winLen + max. expected
  *                      buffer length.
  *                      One more slot is actually allocated for the "one slot open" implementation.
@@ -183,6 +212,16 @@ LTFAT_NAME(analysis_fifo_write)(LTFAT_NAME(analysis_fifo_state)* p, const LTFAT_
 LTFAT_API ltfat_int
 LTFAT_NAME(analysis_fifo_read)(LTFAT_NAME(analysis_fifo_state)* p, LTFAT_REAL buf[]);
 
+/** Number of frames available in the analysis ring buffer
+ *
+ * \param[in]   p        Analysis ring buffer struct
+ *
+ * \returns Number of consecutive analysis_fifo_read calls which would
+ *          succeed with no further write
+ */
+LTFAT_API ltfat_int
+LTFAT_NAME(analysis_fifo_readable)(const LTFAT_NAME(analysis_fifo_state)* p);
+
 /** Destroy DGT analysis ring buffer
  * \param[in]  p      DGT analysis ring buffer
  */
@@ -199,6 +238,9 @@ LTFAT_NAME(analysis_fifo_done)(LTFAT_NAME(analysis_fifo_state)** p);
  *
  * The buffer read and write pointers are both initialized to the same value.
  *
+ * Like the analysis ring buffer, it can be written to and read from two
+ * different threads without locking.
+ *
  * \param[in]  fifoLen  Ring buffer size. This should be at least winLen + max. expected
  *                      buffer length. (winLen+1) more slots are actually allocated
  *                      to accomodate the overlaps.
@@ -237,6 +279,16 @@ LTFAT_API ltfat_int
 LTFAT_NAME(synthesis_fifo_write)(LTFAT_NAME(synthesis_fifo_state)* p,
                                  const LTFAT_REAL buf[]);
 
+/** Number of frames which can be written to the synthesis ring buffer
+ *
+ * \param[in]   p        Synthesis ring buffer struct
+ *
+ * \returns Number of consecutive synthesis_fifo_write calls which would
+ *          succeed with no read in between
+ */
+LTFAT_API ltfat_int
+LTFAT_NAME(synthesis_fifo_writable)(const LTFAT_NAME(synthesis_fifo_state)* p);
+
 /** Read bufLen samples from DGT analysis ring buffer
  *
  * The function attempts to read bufLen samples from the buffer.
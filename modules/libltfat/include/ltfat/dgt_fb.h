@@ -105,6 +105,81 @@ LTFAT_NAME(dgt_fb_init)(const LTFAT_TYPE g[],
                         ltfat_int gl, ltfat_int a, ltfat_int M,
                         const ltfat_phaseconvention ptype, unsigned flags, LTFAT_NAME(dgt_fb_plan)** p);
 
+/** Set number of frames transformed by a single FFT call
+ *
+ * Frames are processed in blocks of \a blocksize consecutive frames
+ * which are transformed together using one multi-column FFT plan.
+ * This reduces the per-call FFT overhead for short windows.
+ * The default is 1, i.e. one frame at a time.
+ *
+ * \param[in] plan       DGT plan
+ * \param[in] blocksize  Number of frames in a block or 0 to choose
+ *                       a block size based on \a M
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_dgt_fb_set_blocksize_d(ltfat_dgt_fb_plan_d* plan,
+ *                              ltfat_int blocksize);
+ *
+ * ltfat_dgt_fb_set_blocksize_s(ltfat_dgt_fb_plan_s* plan,
+ *                              ltfat_int blocksize);
+ *
+ * ltfat_dgt_fb_set_blocksize_dc(ltfat_dgt_fb_plan_dc* plan,
+ *                               ltfat_int blocksize);
+ *
+ * ltfat_dgt_fb_set_blocksize_sc(ltfat_dgt_fb_plan_sc* plan,
+ *                               ltfat_int blocksize);
+ * </tt>
+ * \returns
+ * Status code              | Description
+ * -------------------------|--------------------------------------------
+ * LTFATERR_SUCCESS         | Indicates no error
+ * LTFATERR_NULLPOINTER     | \a plan was NULL
+ * LTFATERR_BADARG          | \a blocksize was negative
+ * LTFATERR_INITFAILED      | FFTW plan creation failed
+ * LTFATERR_NOMEM           | Indicates that heap allocation failed
+ */
+LTFAT_API int
+LTFAT_NAME(dgt_fb_set_blocksize)(LTFAT_NAME(dgt_fb_plan)* plan, ltfat_int blocksize);
+
+/** Set number of threads processing the frames
+ *
+ * The frames are distributed among the threads, each thread having its
+ * own buffers and FFT plan.
+ * The worker threads are shared by the whole library. Calls made while
+ * they are busy with another call process all frames in the calling thread.
+ * The default is 1.
+ *
+ * \param[in] plan       DGT plan
+ * \param[in] nthreads   Number of threads, 0 selects the number set by
+ *                       ltfat_set_num_threads()
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_dgt_fb_set_numthreads_d(ltfat_dgt_fb_plan_d* plan,
+ *                               int nthreads);
+ *
+ * ltfat_dgt_fb_set_numthreads_s(ltfat_dgt_fb_plan_s* plan,
+ *                               int nthreads);
+ *
+ * ltfat_dgt_fb_set_numthreads_dc(ltfat_dgt_fb_plan_dc* plan,
+ *                                int nthreads);
+ *
+ * ltfat_dgt_fb_set_numthreads_sc(ltfat_dgt_fb_plan_sc* plan,
+ *                                int nthreads);
+ * </tt>
+ * \returns
+ * Status code              | Description
+ * -------------------------|--------------------------------------------
+ * LTFATERR_SUCCESS         | Indicates no error
+ * LTFATERR_NULLPOINTER     | \a plan was NULL
+ * LTFATERR_NOTINRANGE      | \a nthreads was not in range 0-256
+ * LTFATERR_INITFAILED      | FFTW plan creation failed
+ * LTFATERR_NOMEM           | Indicates that heap allocation failed
+ */
+LTFAT_API int
+LTFAT_NAME(dgt_fb_set_numthreads)(LTFAT_NAME(dgt_fb_plan)* plan, int nthreads);
+
 /** Execute plan for Discrete Gabor Transform using the filter bank algorithm
  *
  * \param[in]  plan   DGT plan
@@ -142,6 +217,65 @@ LTFAT_NAME(dgt_fb_execute)(const LTFAT_NAME(dgt_fb_plan)* plan,
                            const LTFAT_TYPE f[], ltfat_int L,
                            ltfat_int W, LTFAT_COMPLEX c[]);
 
+/** Size of the workspace needed by dgt_fb_execute_ws in bytes
+ *
+ * The size depends on the block size, see dgt_fb_set_blocksize.
+ *
+ * \param[in]  plan   DGT plan
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_dgt_fb_get_workspace_size_d(const ltfat_dgt_fb_plan_d* plan);
+ *
+ * ltfat_dgt_fb_get_workspace_size_s(const ltfat_dgt_fb_plan_s* plan);
+ *
+ * ltfat_dgt_fb_get_workspace_size_dc(const ltfat_dgt_fb_plan_dc* plan);
+ *
+ * ltfat_dgt_fb_get_workspace_size_sc(const ltfat_dgt_fb_plan_sc* plan);
+ * </tt>
+ * \returns Workspace size in bytes, 0 if \a plan was NULL
+ */
+LTFAT_API size_t
+LTFAT_NAME(dgt_fb_get_workspace_size)(const LTFAT_NAME(dgt_fb_plan)* plan);
+
+/** Execute plan using a caller-supplied workspace
+ *
+ * Same as dgt_fb_execute, but the frame buffers are taken from \a ws
+ * instead of the plan, such that several threads can execute the plan
+ * at once, each with its own workspace. The frames are processed by the
+ * calling thread.
+ *
+ * \param[in]  plan   DGT plan
+ * \param[in]     f   Input signal, size L x W
+ * \param[in]     L   Signal length
+ * \param[in]     W   Number of channels of the signal
+ * \param[out]    c   DGT coefficients, size M x N x W
+ * \param[in]    ws   Workspace of dgt_fb_get_workspace_size bytes,
+ *                    any alignment
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_dgt_fb_execute_ws_d(const ltfat_dgt_fb_plan_d* plan, const double f[],
+ *                           ltfat_int L, ltfat_int W, ltfat_complex_d c[], void* ws);
+ *
+ * ltfat_dgt_fb_execute_ws_s(const ltfat_dgt_fb_plan_s* plan, const float f[],
+ *                           ltfat_int L, ltfat_int W, ltfat_complex_s c[], void* ws);
+ *
+ * ltfat_dgt_fb_execute_ws_dc(const ltfat_dgt_fb_plan_dc* plan, const ltfat_complex_d f[],
+ *                            ltfat_int L, ltfat_int W, ltfat_complex_d c[], void* ws);
+ *
+ * ltfat_dgt_fb_execute_ws_sc(const ltfat_dgt_fb_plan_sc* plan, const ltfat_complex_s f[],
+ *                            ltfat_int L, ltfat_int W, ltfat_complex_s c[], void* ws);
+ * </tt>
+ *
+ * \returns
+ * Same status codes as dgt_fb_execute, LTFATERR_NULLPOINTER also if \a ws was NULL
+ */
+LTFAT_API int
+LTFAT_NAME(dgt_fb_execute_ws)(const LTFAT_NAME(dgt_fb_plan)* plan,
+                              const LTFAT_TYPE f[], ltfat_int L,
+                              ltfat_int W, LTFAT_COMPLEX c[], void* ws);
+
 /** Destroy the plan
  *
  * \param[in]  plan   DGT plan
@@ -100,6 +100,44 @@ LTFAT_NAME(dgt_long_init)(const LTFAT_TYPE g[], ltfat_int L,
                           const ltfat_phaseconvention ptype, unsigned flags,
                           LTFAT_NAME(dgt_long_plan)** p);
 
+/** Set number of threads computing the factorization
+ *
+ * The cosets of the factorization are distributed among the threads.
+ * If there are fewer cosets than threads, the short FFTs and the matrix
+ * products of each coset are distributed instead. The final FFT uses
+ * the threads requested by the planning flags.
+ * The default is 1.
+ *
+ * \param[in]     plan  DGT plan
+ * \param[in] nthreads  Number of threads, 0 selects the number set by
+ *                      ltfat_set_num_threads()
+ *
+ *  Function versions
+ *  -----------------
+ *
+ *  <tt>
+ *  ltfat_dgt_long_set_numthreads_d(ltfat_dgt_long_plan_d* plan, int nthreads);
+ *
+ *  ltfat_dgt_long_set_numthreads_s(ltfat_dgt_long_plan_s* plan, int nthreads);
+ *
+ *  ltfat_dgt_long_set_numthreads_dc(ltfat_dgt_long_plan_dc* plan, int nthreads);
+ *
+ *  ltfat_dgt_long_set_numthreads_sc(ltfat_dgt_long_plan_sc* plan, int nthreads);
+ *  </tt>
+ *
+ * \returns
+ * Status code              | Description
+ * -------------------------|--------------------------------------------
+ * LTFATERR_SUCCESS         | Indicates no error
+ * LTFATERR_NULLPOINTER     | \a plan was NULL
+ * LTFATERR_NOTINRANGE      | \a nthreads was not in range 0-256
+ * LTFATERR_INITFAILED      | FFTW plan creation failed
+ * LTFATERR_NOMEM           | Indicates that heap allocation failed
+ */
+LTFAT_API int
+LTFAT_NAME(dgt_long_set_numthreads)(LTFAT_NAME(dgt_long_plan)* plan,
+                                    int nthreads);
+
 /** Execute DGT plan
  *
  * \param[in]     plan  DGT plan
@@ -149,6 +187,72 @@ LTFAT_API int
 LTFAT_NAME(dgt_long_execute_newarray)(LTFAT_NAME(dgt_long_plan)* plan,
                                       const LTFAT_TYPE f[], LTFAT_COMPLEX c[]);
 
+/** Size of the workspace needed by dgt_long_execute_ws in bytes
+ *
+ * \param[in]     plan  DGT plan
+ *
+ *  Function versions
+ *  -----------------
+ *
+ *  <tt>
+ *  ltfat_dgt_long_get_workspace_size_d(const ltfat_dgt_long_plan_d* plan);
+ *
+ *  ltfat_dgt_long_get_workspace_size_s(const ltfat_dgt_long_plan_s* plan);
+ *
+ *  ltfat_dgt_long_get_workspace_size_dc(const ltfat_dgt_long_plan_dc* plan);
+ *
+ *  ltfat_dgt_long_get_workspace_size_sc(const ltfat_dgt_long_plan_sc* plan);
+ *  </tt>
+ *
+ * \returns Workspace size in bytes, 0 if \a plan was NULL
+ */
+LTFAT_API size_t
+LTFAT_NAME(dgt_long_get_workspace_size)(const LTFAT_NAME(dgt_long_plan)* plan);
+
+/** Execute DGT plan using a caller-supplied workspace
+ *
+ * Works like dgt_long_execute_newarray, but all buffers the computation
+ * writes to are taken from \a ws and the plan itself is only read.
+ * A single plan can therefore be executed by several threads at once
+ * provided each passes its own workspace. The computation runs on the
+ * calling thread regardless of dgt_long_set_numthreads.
+ *
+ * \param[in]     plan  DGT plan
+ * \param[in]        f  Input signal, size L x W
+ * \param[out]       c  Coefficients, size M x N x W
+ * \param[in]       ws  Workspace of dgt_long_get_workspace_size bytes,
+ *                      no alignment is required
+ *
+ *  Function versions
+ *  -----------------
+ *
+ *  <tt>
+ *  ltfat_dgt_long_execute_ws_d(const ltfat_dgt_long_plan_d* plan,
+ *                              const double f[], ltfat_complex_d c[], void* ws);
+ *
+ *  ltfat_dgt_long_execute_ws_s(const ltfat_dgt_long_plan_s* plan,
+ *                              const float f[], ltfat_complex_s c[], void* ws);
+ *
+ *  ltfat_dgt_long_execute_ws_dc(const ltfat_dgt_long_plan_dc* plan,
+ *                               const ltfat_complex_d f[], ltfat_complex_d c[],
+ *                               void* ws);
+ *
+ *  ltfat_dgt_long_execute_ws_sc(const ltfat_dgt_long_plan_sc* plan,
+ *                               const ltfat_complex_s f[], ltfat_complex_s c[],
+ *                               void* ws);
+ *  </tt>
+ *
+ * \returns
+ * Status code              | Description
+ * -------------------------|--------------------------------------------
+ * LTFATERR_SUCCESS         | Indicates no error
+ * LTFATERR_NULLPOINTER     | At least one of the arguments was NULL
+ */
+LTFAT_API int
+LTFAT_NAME(dgt_long_execute_ws)(const LTFAT_NAME(dgt_long_plan)* plan,
+                                const LTFAT_TYPE f[], LTFAT_COMPLEX c[],
+                                void* ws);
+
 
 /** Destroy DGT plan
  *
@@ -88,6 +88,69 @@ LTFAT_NAME(dgtreal_fb_init)(const LTFAT_REAL g[],
                             ltfat_int M, const ltfat_phaseconvention ptype,
                             unsigned flags, LTFAT_NAME(dgtreal_fb_plan)** plan);
 
+/** Set number of frames transformed by a single FFT call
+ *
+ * Frames are processed in blocks of \a blocksize consecutive frames
+ * which are transformed together using one multi-column FFT plan.
+ * This reduces the per-call FFT overhead for short windows.
+ * The default is 1, i.e. one frame at a time.
+ *
+ * \param[in] plan       DGT plan
+ * \param[in] blocksize  Number of frames in a block or 0 to choose
+ *                       a block size based on \a M
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_dgtreal_fb_set_blocksize_d(ltfat_dgtreal_fb_plan_d* plan,
+ *                                  ltfat_int blocksize);
+ *
+ * ltfat_dgtreal_fb_set_blocksize_s(ltfat_dgtreal_fb_plan_s* plan,
+ *                                  ltfat_int blocksize);
+ * </tt>
+ * \returns
+ * Status code              | Description
+ * -------------------------|--------------------------------------------
+ * LTFATERR_SUCCESS         | Indicates no error
+ * LTFATERR_NULLPOINTER     | \a plan was NULL
+ * LTFATERR_BADARG          | \a blocksize was negative
+ * LTFATERR_INITFAILED      | FFTW plan creation failed
+ * LTFATERR_NOMEM           | Indicates that heap allocation failed
+ */
+LTFAT_API int
+LTFAT_NAME(dgtreal_fb_set_blocksize)(LTFAT_NAME(dgtreal_fb_plan)* plan, ltfat_int blocksize);
+
+/** Set number of threads processing the frames
+ *
+ * The frames are distributed among the threads, each thread having its
+ * own buffers and FFT plan.
+ * The worker threads are shared by the whole library. Calls made while
+ * they are busy with another call process all frames in the calling thread.
+ * The default is 1.
+ *
+ * \param[in] plan       DGT plan
+ * \param[in] nthreads   Number of threads, 0 selects the number set by
+ *                       ltfat_set_num_threads()
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_dgtreal_fb_set_numthreads_d(ltfat_dgtreal_fb_plan_d* plan,
+ *                                   int nthreads);
+ *
+ * ltfat_dgtreal_fb_set_numthreads_s(ltfat_dgtreal_fb_plan_s* plan,
+ *                                   int nthreads);
+ * </tt>
+ * \returns
+ * Status code              | Description
+ * -------------------------|--------------------------------------------
+ * LTFATERR_SUCCESS         | Indicates no error
+ * LTFATERR_NULLPOINTER     | \a plan was NULL
+ * LTFATERR_NOTINRANGE      | \a nthreads was not in range 0-256
+ * LTFATERR_INITFAILED      | FFTW plan creation failed
+ * LTFATERR_NOMEM           | Indicates that heap allocation failed
+ */
+LTFAT_API int
+LTFAT_NAME(dgtreal_fb_set_numthreads)(LTFAT_NAME(dgtreal_fb_plan)* plan, int nthreads);
+
 /** Execute plan for Discrete Gabor Transform for real signals using the filter bank algorithm
  *
  * \param[in]  plan   DGT plan
@@ -119,6 +182,57 @@ LTFAT_NAME(dgtreal_fb_execute)(LTFAT_NAME(dgtreal_fb_plan)* plan,
                                const LTFAT_REAL f[], ltfat_int L,
                                ltfat_int W, LTFAT_COMPLEX c[]);
 
+/** Size of the workspace needed by dgtreal_fb_execute_ws in bytes
+ *
+ * The size depends on the block size, see dgtreal_fb_set_blocksize.
+ *
+ * \param[in]  plan   DGT plan
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_dgtreal_fb_get_workspace_size_d(const ltfat_dgtreal_fb_plan_d* plan);
+ *
+ * ltfat_dgtreal_fb_get_workspace_size_s(const ltfat_dgtreal_fb_plan_s* plan);
+ * </tt>
+ * \returns Workspace size in bytes, 0 if \a plan was NULL
+ */
+LTFAT_API size_t
+LTFAT_NAME(dgtreal_fb_get_workspace_size)(const LTFAT_NAME(dgtreal_fb_plan)* plan);
+
+/** Execute plan using a caller-supplied workspace
+ *
+ * Same as dgtreal_fb_execute, except that the plan is not modified and the
+ * frame buffers are taken from \a ws. Concurrent calls on the same plan
+ * must pass distinct workspaces. The frames are processed by the calling
+ * thread.
+ *
+ * \param[in]  plan   DGT plan
+ * \param[in]     f   Input signal, size L x W
+ * \param[in]     L   Signal length
+ * \param[in]     W   Number of channels of the signal
+ * \param[out]    c   DGT coefficients, size M2 x N x W
+ * \param[in]    ws   Workspace of dgtreal_fb_get_workspace_size bytes,
+ *                    any alignment
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_dgtreal_fb_execute_ws_d(const ltfat_dgtreal_fb_plan_d* plan, const double f[],
+ *                               ltfat_int L, ltfat_int W, ltfat_complex_d c[],
+ *                               void* ws);
+ *
+ * ltfat_dgtreal_fb_execute_ws_s(const ltfat_dgtreal_fb_plan_s* plan, const float f[],
+ *                               ltfat_int L, ltfat_int W, ltfat_complex_s c[],
+ *                               void* ws);
+ * </tt>
+ *
+ * \returns
+ * Same status codes as dgtreal_fb_execute, LTFATERR_NULLPOINTER also if \a ws was NULL
+ */
+LTFAT_API int
+LTFAT_NAME(dgtreal_fb_execute_ws)(const LTFAT_NAME(dgtreal_fb_plan)* plan,
+                                  const LTFAT_REAL f[], ltfat_int L,
+                                  ltfat_int W, LTFAT_COMPLEX c[], void* ws);
+
 /** Destroy the plan
  *
  * \param[in]  plan   DGT plan
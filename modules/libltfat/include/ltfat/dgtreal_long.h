@@ -97,6 +97,36 @@ LTFAT_NAME(dgtreal_long_init)(const LTFAT_REAL g[],
                               const ltfat_phaseconvention ptype, unsigned flags,
                               LTFAT_NAME(dgtreal_long_plan)** plan);
 
+/** Set number of threads computing the factorization
+ *
+ * Works the same way as ltfat_dgt_long_set_numthreads().
+ * The default is 1.
+ *
+ * \param[in]  plan      DGT plan
+ * \param[in]  nthreads  Number of threads, 0 selects the number set by
+ *                       ltfat_set_num_threads()
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_dgtreal_long_set_numthreads_d(ltfat_dgtreal_long_plan_d* plan,
+ *                                     int nthreads);
+ *
+ * ltfat_dgtreal_long_set_numthreads_s(ltfat_dgtreal_long_plan_s* plan,
+ *                                     int nthreads);
+ * </tt>
+ * \returns
+ * Status code              | Description
+ * -------------------------|--------------------------------------------
+ * LTFATERR_SUCCESS         | Indicates no error
+ * LTFATERR_NULLPOINTER     | \a plan was NULL
+ * LTFATERR_NOTINRANGE      | \a nthreads was not in range 0-256
+ * LTFATERR_INITFAILED      | FFTW plan creation failed
+ * LTFATERR_NOMEM           | Indicates that heap allocation failed
+ */
+LTFAT_API int
+LTFAT_NAME(dgtreal_long_set_numthreads)(LTFAT_NAME(dgtreal_long_plan)* plan,
+                                        int nthreads);
+
 /** Execute plan for Discrete Gabor Transform for real signals using the factorization algorithm
  *
  * \param[in]  plan   DGT plan
@@ -142,6 +172,53 @@ LTFAT_API int
 LTFAT_NAME(dgtreal_long_execute_newarray)(LTFAT_NAME(dgtreal_long_plan)* plan,
         const LTFAT_REAL* f, LTFAT_COMPLEX* c);
 
+/** Size of the workspace needed by dgtreal_long_execute_ws in bytes
+ *
+ * \param[in]  plan   DGT plan
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_dgtreal_long_get_workspace_size_d(const ltfat_dgtreal_long_plan_d* plan);
+ *
+ * ltfat_dgtreal_long_get_workspace_size_s(const ltfat_dgtreal_long_plan_s* plan);
+ * </tt>
+ * \returns Workspace size in bytes, 0 if \a plan was NULL
+ */
+LTFAT_API size_t
+LTFAT_NAME(dgtreal_long_get_workspace_size)(
+    const LTFAT_NAME(dgtreal_long_plan)* plan);
+
+/** Execute plan using a caller-supplied workspace
+ *
+ * Same as dgtreal_long_execute_newarray except that the plan is only read
+ * and the buffers are taken from \a ws. Threads sharing a plan must pass
+ * distinct workspaces. The computation is done by the calling thread.
+ *
+ * \param[in]   plan   DGT plan
+ * \param[in]      f   Input signal, size L x W
+ * \param[out]     c   Coefficients, size M2 x N x W
+ * \param[in]     ws   Workspace of dgtreal_long_get_workspace_size bytes,
+ *                     any alignment
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_dgtreal_long_execute_ws_d(const ltfat_dgtreal_long_plan_d* plan,
+ *                                 const double f[], ltfat_complex_d c[], void* ws);
+ *
+ * ltfat_dgtreal_long_execute_ws_s(const ltfat_dgtreal_long_plan_s* plan,
+ *                                 const float f[], ltfat_complex_s c[], void* ws);
+ * </tt>
+ * \returns
+ * Status code              | Description
+ * -------------------------|--------------------------------------------
+ * LTFATERR_SUCCESS         | Indicates no error
+ * LTFATERR_NULLPOINTER     | At least one of the arguments was NULL.
+ */
+LTFAT_API int
+LTFAT_NAME(dgtreal_long_execute_ws)(const LTFAT_NAME(dgtreal_long_plan)* plan,
+                                    const LTFAT_REAL f[], LTFAT_COMPLEX c[],
+                                    void* ws);
+
 /** Destroy the plan
  *
  * \param[in]  plan   DGT plan
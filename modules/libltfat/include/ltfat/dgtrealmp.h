@@ -4,6 +4,7 @@
  * */
 typedef struct LTFAT_NAME(dgtrealmp_state) LTFAT_NAME(dgtrealmp_state);
 typedef struct LTFAT_NAME(dgtrealmp_parbuf) LTFAT_NAME(dgtrealmp_parbuf);
+typedef struct LTFAT_NAME(dgtrealmp_dict) LTFAT_NAME(dgtrealmp_dict);
 
 #ifndef _LTFAT_DGTREALMP_H
 #define _LTFAT_DGTREALMP_H
@@ -30,8 +31,15 @@ typedef enum
     ltfat_dgtmp_alg_locomp          = 1,
     ltfat_dgtmp_alg_loccyclicmp     = 2,
     ltfat_dgtmp_alg_locselfprojmp   = 3,
+    ltfat_dgtmp_alg_batchmp         = 4,
 } ltfat_dgtmp_alg;
 
+typedef enum
+{
+    ltfat_dgtmp_searchtree_binary   = 0,
+    ltfat_dgtmp_searchtree_flat     = 1,
+} ltfat_dgtmp_searchtree;
+
 typedef struct ltfat_dgtmp_params ltfat_dgtmp_params;
 
 LTFAT_API ltfat_dgtmp_params*
@@ -88,6 +96,18 @@ LTFAT_API int
 ltfat_dgtmp_setpar_cycles(
         ltfat_dgtmp_params* params, size_t cycles);
 
+LTFAT_API int
+ltfat_dgtmp_setpar_nthreads(
+        ltfat_dgtmp_params* params, int nthreads);
+
+LTFAT_API int
+ltfat_dgtmp_setpar_batchsize(
+        ltfat_dgtmp_params* params, size_t batchsize);
+
+LTFAT_API int
+ltfat_dgtmp_setpar_searchtree(
+        ltfat_dgtmp_params* params, ltfat_dgtmp_searchtree tree);
+
 // LTFAT_API int
 // ltfat_dgtmp_setpar_checkerreverynit(
 //     ltfat_dgtmp_params* p, ltfat_int itstep, double errtoldb);
@@ -101,6 +121,99 @@ ltfat_dgtmp_params_defaults(ltfat_dgtmp_params* params);
 int
 ltfat_dgtmp_alg_isvalid(ltfat_dgtmp_alg in);
 
+int
+ltfat_dgtmp_searchtree_isvalid(ltfat_dgtmp_searchtree in);
+
+/** \addtogroup multidgtrealmp  */
+/**@{*/
+
+/** Statistics of the Gram kernel cache
+ *
+ * The Gram kernels computed by dgtrealmp_init_gen() are kept in
+ * a library-wide cache. The entries are identified by the content of both
+ * windows, their a and M, the length the kernel is computed on, the phase
+ * convention, kernrelthr and the precision. A state re-created with the same
+ * dictionary copies the kernels from the cache instead of computing them.
+ * The least recently used entries are evicted whenever the memory held
+ * by the cache exceeds the limit.
+ *
+ * All kernel cache functions are thread-safe.
+ */
+typedef struct
+{
+    size_t bytes;      /**< Memory currently held by the cache */
+    size_t limit;      /**< Current limit, see ltfat_dgtmp_kernelcache_set_limit() */
+    ltfat_int entries; /**< Number of kernels */
+    size_t hits;       /**< Number of kernels found in the cache */
+    size_t misses;     /**< Number of kernels computed */
+    size_t evictions;  /**< Number of kernels evicted */
+} ltfat_dgtmp_kernelcache_stats;
+
+/** Set limit of the memory held by the Gram kernel cache
+ *
+ * 0 disables the cache. The default is 64 MiB.
+ *
+ * \param[in] bytes  Limit in bytes
+ *
+ * \returns LTFATERR_SUCCESS
+ */
+LTFAT_API int
+ltfat_dgtmp_kernelcache_set_limit(size_t bytes);
+
+/** Get statistics of the Gram kernel cache
+ *
+ * \param[out] stats  Statistics
+ *
+ * \returns
+ * Status code          |  Description
+ * ---------------------|----------------
+ * LTFATERR_SUCCESS     |  No error occured
+ * LTFATERR_NULLPOINTER |  \a stats was NULL
+ */
+LTFAT_API int
+ltfat_dgtmp_kernelcache_get_stats(ltfat_dgtmp_kernelcache_stats* stats);
+
+/** Evict all kernels from the cache
+ *
+ * \returns Number of evicted kernels
+ */
+LTFAT_API int
+ltfat_dgtmp_kernelcache_clear(void);
+
+/** Add kernels stored by ltfat_dgtmp_kernelcache_save() to the cache
+ *
+ * Kernels already in the cache are kept. The file must have been written
+ * by the same version of the kernel computation on a platform with the same
+ * byte order.
+ *
+ * \param[in]  path   Kernel cache file
+ *
+ * \returns
+ * Status code           |  Description
+ * ----------------------|----------------
+ * LTFATERR_SUCCESS      |  No error occured
+ * LTFATERR_NULLPOINTER  |  \a path was NULL
+ * LTFATERR_FAILED       |  The file could not be read or is not compatible
+ * LTFATERR_NOMEM        |  Memory allocation failed
+ */
+LTFAT_API int
+ltfat_dgtmp_kernelcache_load(const char* path);
+
+/** Store all kernels in the cache to a file
+ *
+ * \param[in]  path   Kernel cache file
+ *
+ * \returns
+ * Status code           |  Description
+ * ----------------------|----------------
+ * LTFATERR_SUCCESS      |  No error occured
+ * LTFATERR_NULLPOINTER  |  \a path was NULL
+ * LTFATERR_FAILED       |  The file could not be written
+ */
+LTFAT_API int
+ltfat_dgtmp_kernelcache_save(const char* path);
+/**@}*/
+
 #endif
 
 /** \addtogroup multidgtrealmp  */
@@ -306,6 +419,110 @@ LTFAT_NAME(dgtrealmp_execute_synthesize)(
 
 /** @}*/
 
+/** \name Sharing the dictionary between states
+ *
+ * The Gram kernels and the DGT plans depend only on the dictionaries and
+ * on L. A dictionary object holds them and any number of states can be
+ * created from it, each having only its own residual and search
+ * structures. States created from one dictionary can run in different
+ * threads. The shared DGT plans are only read, each state runs them on its
+ * own workspace, see dgtreal_execute_ana_ws().
+ *
+ * ~~~~~~~~~~~~~~~{.c}
+ * ltfat_dgtrealmp_dict_d* dict;
+ * ltfat_dgtrealmp_dict_init_d(pb, L, &dict);
+ * // In each worker thread
+ * ltfat_dgtrealmp_state_d* state;
+ * ltfat_dgtrealmp_init_fromdict_d(dict, NULL, &state);
+ * ltfat_dgtrealmp_execute_d(state, f, c, fout);
+ * ltfat_dgtrealmp_done_d(&state);
+ * // Once
+ * ltfat_dgtrealmp_dict_done_d(&dict);
+ * ~~~~~~~~~~~~~~~
+ * @{ */
+
+/** Initialize the dictionary
+ *
+ * Takes the dictionaries, parameters, dictionary mask and callback
+ * from \a pb. The states created from it inherit all of them.
+ *
+ * \param[in]   pb  Parameter buffer
+ * \param[in]    L  Signal length
+ * \param[out]   d  Dictionary
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_dgtrealmp_dict_init_d( ltfat_dgtrealmp_parbuf_d* pb, ltfat_int L, ltfat_dgtrealmp_dict_d** d);
+ *
+ * ltfat_dgtrealmp_dict_init_s( ltfat_dgtrealmp_parbuf_s* pb, ltfat_int L, ltfat_dgtrealmp_dict_s** d);
+ * </tt>
+ * \returns
+ * Status code              | Description
+ * -------------------------|------------
+ * LTFATERR_SUCCESS         | Indicates no error
+ * LTFATERR_NULLPOINTER     | At least one of the following was NULL: \a pb, \a d
+ * LTFATERR_BADARG          | \a pb holds no dictionary or \a L is not positive
+ * LTFATERR_BADTRALEN       | \a L is not compatible with the dictionaries
+ * LTFATERR_NOMEM           | Indicates that heap allocation failed
+ */
+LTFAT_API int
+LTFAT_NAME(dgtrealmp_dict_init)(
+    LTFAT_NAME(dgtrealmp_parbuf)* pb, ltfat_int L, LTFAT_NAME(dgtrealmp_dict)** d);
+
+/** Initialize DGTREAL Matching Pursuit state using a dictionary
+ *
+ * The state keeps a reference to \a d, so the dictionary can be released
+ * by dgtrealmp_dict_done() before the state is deleted.
+ *
+ * \param[in]        d  Dictionary
+ * \param[in]   params  Parameters of the state or NULL to take those of \a d.
+ *                       The kernel threshold and the phase convention
+ *                       are always taken from \a d.
+ * \param[out]       p  DGTREALMP state
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_dgtrealmp_init_fromdict_d( ltfat_dgtrealmp_dict_d* d, ltfat_dgtmp_params* params,
+ *                                  ltfat_dgtrealmp_state_d** p);
+ *
+ * ltfat_dgtrealmp_init_fromdict_s( ltfat_dgtrealmp_dict_s* d, ltfat_dgtmp_params* params,
+ *                                  ltfat_dgtrealmp_state_s** p);
+ * </tt>
+ * \returns
+ * Status code              | Description
+ * -------------------------|------------
+ * LTFATERR_SUCCESS         | Indicates no error
+ * LTFATERR_NULLPOINTER     | At least one of the following was NULL: \a d, \a p
+ * LTFATERR_NOMEM           | Indicates that heap allocation failed
+ */
+LTFAT_API int
+LTFAT_NAME(dgtrealmp_init_fromdict)(
+    LTFAT_NAME(dgtrealmp_dict)* d, ltfat_dgtmp_params* params,
+    LTFAT_NAME(dgtrealmp_state)** p);
+
+/** Release the dictionary
+ *
+ * The dictionary is deleted once all states created from it are deleted.
+ *
+ * \param[in]   d  Dictionary
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_dgtrealmp_dict_done_d( ltfat_dgtrealmp_dict_d** d);
+ *
+ * ltfat_dgtrealmp_dict_done_s( ltfat_dgtrealmp_dict_s** d);
+ * </tt>
+ * \returns
+ * Status code              | Description
+ * -------------------------|------------
+ * LTFATERR_SUCCESS         | Indicates no error
+ * LTFATERR_NULLPOINTER     | \a d or \a *d is NULL
+ */
+LTFAT_API int
+LTFAT_NAME(dgtrealmp_dict_done)(LTFAT_NAME(dgtrealmp_dict)** d);
+
+/** @}*/
+
 /***********************************************************************/
 
 /** \name Parameter setup struct */
@@ -799,6 +1016,101 @@ LTFAT_API int
 LTFAT_NAME(dgtrealmp_setparbuf_pedanticsearch)(
     LTFAT_NAME(dgtrealmp_parbuf)* parbuf, int do_pedantic);
 
+/** Set number of threads used by the batch MP algorithm
+ *
+ * The batch MP algorithm (ltfat_dgtmp_alg_batchmp) selects several atoms
+ * in each round. The atoms are chosen from the largest column maxima such
+ * that their Gram kernels do not reach any common time frame in any of the
+ * dictionaries. Their residual updates are independent and are distributed
+ * among the threads. The result does not depend on the number of threads.
+ * Other algorithms ignore this setting.
+ *
+ * \param[in]     parbuf  DGTREALMP parameter buffer
+ * \param[in]   nthreads  Number of threads, 0 (default) means ltfat_get_num_threads()
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_dgtrealmp_setparbuf_nthreads_d( ltfat_dgtrealmp_parbuf_d* p,
+ *                                       int nthreads);
+ *
+ * ltfat_dgtrealmp_setparbuf_nthreads_s( ltfat_dgtrealmp_parbuf_s* p,
+ *                                       int nthreads);
+ * </tt>
+ * \returns
+ * Status code              | Description
+ * -------------------------|------------
+ * LTFATERR_SUCCESS         | Indicates no error
+ * LTFATERR_NULLPOINTER     | At least one of the following was NULL: \a p
+ * LTFATERR_NOTINRANGE      | \a nthreads is negative or larger than LTFAT_MAXTHREADS
+ */
+LTFAT_API int
+LTFAT_NAME(dgtrealmp_setparbuf_nthreads)(
+    LTFAT_NAME(dgtrealmp_parbuf)* parbuf, int nthreads);
+
+/** Set maximum number of atoms selected in one round of batch MP
+ *
+ * Each selected atom counts as one iteration. The first atom of each round
+ * is always the one plain MP would select. Batches of a single atom make the
+ * batch MP equal to plain MP.
+ *
+ * \param[in]     parbuf  DGTREALMP parameter buffer
+ * \param[in]  batchsize  Maximum number of atoms, 0 (default) means 8 per thread
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_dgtrealmp_setparbuf_batchsize_d( ltfat_dgtrealmp_parbuf_d* p,
+ *                                        size_t batchsize);
+ *
+ * ltfat_dgtrealmp_setparbuf_batchsize_s( ltfat_dgtrealmp_parbuf_s* p,
+ *                                        size_t batchsize);
+ * </tt>
+ * \returns
+ * Status code              | Description
+ * -------------------------|------------
+ * LTFATERR_SUCCESS         | Indicates no error
+ * LTFATERR_NULLPOINTER     | At least one of the following was NULL: \a p
+ */
+LTFAT_API int
+LTFAT_NAME(dgtrealmp_setparbuf_batchsize)(
+    LTFAT_NAME(dgtrealmp_parbuf)* parbuf, size_t batchsize);
+
+/** Set the structure used for finding the maximum coefficient
+ *
+ * Each coefficient column and each dictionary keep a tree of maxima which
+ * is updated in the ranges touched by the residual update.
+ *
+ * ltfat_dgtmp_searchtree_binary (default) is a binary tree.
+ * ltfat_dgtmp_searchtree_flat has 8 (double) or 16 (single) children per
+ * node, each node fills one cache line and is reduced using SIMD
+ * instructions. It needs fewer levels and less memory, which pays off
+ * with large M.
+ *
+ * Both find the same maximum. When several coefficients have exactly the
+ * same value, the flat tree picks the one with the lowest index, the
+ * binary tree might pick another one.
+ *
+ * \param[in]     parbuf  DGTREALMP parameter buffer
+ * \param[in]       tree  Tree type
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_dgtrealmp_setparbuf_searchtree_d( ltfat_dgtrealmp_parbuf_d* p,
+ *                                         ltfat_dgtmp_searchtree tree);
+ *
+ * ltfat_dgtrealmp_setparbuf_searchtree_s( ltfat_dgtrealmp_parbuf_s* p,
+ *                                         ltfat_dgtmp_searchtree tree);
+ * </tt>
+ * \returns
+ * Status code              | Description
+ * -------------------------|------------
+ * LTFATERR_SUCCESS         | Indicates no error
+ * LTFATERR_NULLPOINTER     | At least one of the following was NULL: \a p
+ * LTFATERR_BADARG          | \a tree is not a valid value from the ltfat_dgtmp_searchtree enum
+ */
+LTFAT_API int
+LTFAT_NAME(dgtrealmp_setparbuf_searchtree)(
+    LTFAT_NAME(dgtrealmp_parbuf)* parbuf, ltfat_dgtmp_searchtree tree);
+
 /* TODO:
 LTFAT_API int
 LTFAT_NAME(dgtrealmp_parbuf_mod_chirpmod)(
@@ -1011,6 +1323,12 @@ LTFAT_NAME(dgtrealmp_init_gen)(
         ltfat_int a[], ltfat_int M[], ltfat_dgtmp_params* params,
         LTFAT_NAME(dgtrealmp_state)** p);
 
+LTFAT_API int
+LTFAT_NAME(dgtrealmp_dict_init_gen)(
+        const LTFAT_REAL* g[], ltfat_int gl[], ltfat_int L, ltfat_int P,
+        ltfat_int a[], ltfat_int M[], ltfat_dgtmp_params* params,
+        LTFAT_NAME(dgtrealmp_dict)** d);
+
 LTFAT_API int
 LTFAT_NAME(dgtrealmp_execute_niters)(
         LTFAT_NAME(dgtrealmp_state)* p, size_t itno, LTFAT_COMPLEX** cout);
@@ -121,6 +121,81 @@ LTFAT_NAME(dgtreal_execute_ana_newarray)(LTFAT_NAME(dgtreal_plan)* p,
 LTFAT_API int
 LTFAT_NAME(dgtreal_execute_ana)(LTFAT_NAME(dgtreal_plan)* p);
 
+/** Size of the workspace needed by dgtreal_execute_ana_ws and
+ * dgtreal_execute_syn_ws in bytes
+ *
+ * \param[in]    p  Transform plan
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_dgtreal_get_workspace_size_d(const ltfat_dgtreal_plan_d* p);
+ *
+ * ltfat_dgtreal_get_workspace_size_s(const ltfat_dgtreal_plan_s* p);
+ * </tt>
+ * \returns Workspace size in bytes, 0 if \a p was NULL
+ */
+LTFAT_API size_t
+LTFAT_NAME(dgtreal_get_workspace_size)(const LTFAT_NAME(dgtreal_plan)* p);
+
+/** Perform DGTREAL analysis using a caller-supplied workspace
+ *
+ * Same as dgtreal_execute_ana_newarray except that the plan is only read
+ * and the buffers are taken from \a ws. Threads sharing a plan must pass
+ * distinct workspaces. The computation is done by the calling thread.
+ *
+ * \param[in]    p  Transform plan
+ * \param[in]    f  Input signal, size L x W
+ * \param[out]   c  Coefficients, size M2 x N x W
+ * \param[in]   ws  Workspace of dgtreal_get_workspace_size bytes,
+ *                  any alignment
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_dgtreal_execute_ana_ws_d(const ltfat_dgtreal_plan_d* p,
+ *                                const double f[], ltfat_complex_d c[], void* ws);
+ *
+ * ltfat_dgtreal_execute_ana_ws_s(const ltfat_dgtreal_plan_s* p,
+ *                                const float f[], ltfat_complex_s c[], void* ws);
+ * </tt>
+ * \returns
+ * Status code              | Description
+ * -------------------------|--------------------------------------------
+ * LTFATERR_SUCCESS         | Indicates no error
+ * LTFATERR_NULLPOINTER     | At least one of the arguments was NULL.
+ */
+LTFAT_API int
+LTFAT_NAME(dgtreal_execute_ana_ws)(const LTFAT_NAME(dgtreal_plan)* p,
+                                   const LTFAT_REAL f[], LTFAT_COMPLEX c[], void* ws);
+
+/** Perform DGTREAL synthesis using a caller-supplied workspace
+ *
+ * Same as dgtreal_execute_syn_newarray, see dgtreal_execute_ana_ws.
+ *
+ * \param[in]    p  Transform plan
+ * \param[in]    c  Input coefficients, size M2 x N x W
+ * \param[out]   f  Reconstructed signal, size L x W
+ * \param[in]   ws  Workspace of dgtreal_get_workspace_size bytes,
+ *                  any alignment
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_dgtreal_execute_syn_ws_d(const ltfat_dgtreal_plan_d* p,
+ *                                const ltfat_complex_d c[], double f[], void* ws);
+ *
+ * ltfat_dgtreal_execute_syn_ws_s(const ltfat_dgtreal_plan_s* p,
+ *                                const ltfat_complex_s c[], float f[], void* ws);
+ * </tt>
+ * \returns
+ * Status code              | Description
+ * -------------------------|--------------------------------------------
+ * LTFATERR_SUCCESS         | Indicates no error
+ * LTFATERR_NULLPOINTER     | At least one of the arguments was NULL.
+ * LTFATERR_NOTSUPPORTED    | The plan was created with FFTW_DESTROY_INPUT
+ */
+LTFAT_API int
+LTFAT_NAME(dgtreal_execute_syn_ws)(const LTFAT_NAME(dgtreal_plan)* p,
+                                   const LTFAT_COMPLEX c[], LTFAT_REAL f[], void* ws);
+
 /** Destroy transform plan
  *
  * \param[in]   p  Transform plan
@@ -152,6 +227,21 @@ LTFAT_NAME(dgtreal_get_L)(LTFAT_NAME(dgtreal_plan)* p);
 
 LTFAT_API int
 LTFAT_NAME(dgtreal_get_phaseconv)(LTFAT_NAME(dgtreal_plan)* p);
+
+/** Algorithm used by the analysis
+ *
+ * \returns ltfat_dgt_long, ltfat_dgt_fb or ltfat_dgt_ola. With ltfat_dgt_auto,
+ * this is the algorithm the cost model predicted to be faster.
+ */
+LTFAT_API ltfat_dgt_hint
+LTFAT_NAME(dgtreal_get_anahint)(LTFAT_NAME(dgtreal_plan)* p);
+
+/** Algorithm used by the synthesis
+ *
+ * \returns ltfat_dgt_long, ltfat_dgt_fb or ltfat_dgt_ola
+ */
+LTFAT_API ltfat_dgt_hint
+LTFAT_NAME(dgtreal_get_synhint)(LTFAT_NAME(dgtreal_plan)* p);
 /** @} */
 /** @} */
 
@@ -183,4 +273,18 @@ LTFAT_NAME(idgtreal_fb_done_wrapper)(void** plan);
 int
 LTFAT_NAME(dgtreal_fb_done_wrapper)(void** plan);
 
+int
+LTFAT_NAME(idgtreal_ola_execute_wrapper)(void* plan, const LTFAT_COMPLEX* c, ltfat_int L,
+        ltfat_int W, LTFAT_REAL* f);
+
+int
+LTFAT_NAME(dgtreal_ola_execute_wrapper)(void* plan, const LTFAT_REAL* f, ltfat_int L, ltfat_int W,
+        LTFAT_COMPLEX* c);
+
+int
+LTFAT_NAME(idgtreal_ola_done_wrapper)(void** plan);
+
+int
+LTFAT_NAME(dgtreal_ola_done_wrapper)(void** plan);
+
 
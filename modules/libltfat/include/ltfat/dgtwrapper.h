@@ -265,6 +265,21 @@ LTFAT_NAME(dgt_get_L)(LTFAT_NAME(dgt_plan)* p);
 
 LTFAT_API int
 LTFAT_NAME(dgt_get_phaseconv)(LTFAT_NAME(dgt_plan)* p);
+
+/** Algorithm used by the analysis
+ *
+ * \returns ltfat_dgt_long, ltfat_dgt_fb or ltfat_dgt_ola. With ltfat_dgt_auto,
+ * this is the algorithm the cost model predicted to be faster.
+ */
+LTFAT_API ltfat_dgt_hint
+LTFAT_NAME(dgt_get_anahint)(LTFAT_NAME(dgt_plan)* p);
+
+/** Algorithm used by the synthesis
+ *
+ * \returns ltfat_dgt_long, ltfat_dgt_fb or ltfat_dgt_ola
+ */
+LTFAT_API ltfat_dgt_hint
+LTFAT_NAME(dgt_get_synhint)(LTFAT_NAME(dgt_plan)* p);
 /** @} */
 /** @} */
 
@@ -295,3 +310,17 @@ LTFAT_NAME(idgt_fb_done_wrapper)(void** plan);
 
 int
 LTFAT_NAME(dgt_fb_done_wrapper)(void** plan);
+
+int
+LTFAT_NAME(idgt_ola_execute_wrapper)(void* plan, const LTFAT_COMPLEX* c, ltfat_int L,
+        ltfat_int W, LTFAT_COMPLEX* f);
+
+int
+LTFAT_NAME(dgt_ola_execute_wrapper)(void* plan, const LTFAT_TYPE* f, ltfat_int L, ltfat_int W,
+        LTFAT_COMPLEX* c);
+
+int
+LTFAT_NAME(idgt_ola_done_wrapper)(void** plan);
+
+int
+LTFAT_NAME(dgt_ola_done_wrapper)(void** plan);
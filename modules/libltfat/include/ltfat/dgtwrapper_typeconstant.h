@@ -11,7 +11,8 @@ typedef enum
 {
     ltfat_dgt_auto,
     ltfat_dgt_long,
-    ltfat_dgt_fb
+    ltfat_dgt_fb,
+    ltfat_dgt_ola
 } ltfat_dgt_hint;
 
 /** \name Parameter setup struct
@@ -52,7 +53,74 @@ ltfat_dgt_getpar_phaseconv(ltfat_dgt_params* params);
 LTFAT_API int
 ltfat_dgt_setpar_fftwflags(ltfat_dgt_params* params, unsigned fftw_flags);
 
+/** Set number of threads
+ *
+ * The filter bank algorithm distributes the frames among the threads and
+ * the factorization algorithm distributes the cosets of the window
+ * factorization. The remaining FFTs are multithreaded.
+ * 0 (default) means the library-wide setting from ltfat_set_num_threads().
+ * Without the FFTW threads library, the FFTs always run in a single thread.
+ *
+ * \returns
+ * Status code          |  Description
+ * ---------------------|----------------
+ * LTFATERR_SUCESS      |  No error occured
+ * LTFATERR_NULLPOINTER |  \a params was NULL
+ * LTFATERR_NOTINRANGE  |  \a nthreads was not in range 0-255
+ */
+LTFAT_API int
+ltfat_dgt_setpar_numthreads(ltfat_dgt_params* params, int nthreads);
+
+/** Set number of frames transformed together by the filter bank algorithm
+ *
+ * 1 (default) transforms one frame at a time, 0 chooses the number based
+ * on the number of frequency channels.
+ *
+ * \returns
+ * Status code          |  Description
+ * ---------------------|----------------
+ * LTFATERR_SUCESS      |  No error occured
+ * LTFATERR_NULLPOINTER |  \a params was NULL
+ * LTFATERR_BADARG      |  \a blocksize was negative
+ * \see ltfat_dgt_fb_set_blocksize_d
+ */
+LTFAT_API int
+ltfat_dgt_setpar_fbblocksize(ltfat_dgt_params* params, ltfat_int blocksize);
+
+/** Set block length of the overlap-add algorithm
+ *
+ * 0 (default) picks the shortest block at least 8 times longer than
+ * the window such that it divides L. An explicit block length must divide L,
+ * it must be divisible by lcm(a,M) and it must be at least half the window
+ * length rounded up to a multiple of lcm(a,M) and 2a.
+ *
+ * \returns
+ * Status code          |  Description
+ * ---------------------|----------------
+ * LTFATERR_SUCESS      |  No error occured
+ * LTFATERR_NULLPOINTER |  \a params was NULL
+ * LTFATERR_BADARG      |  \a bl was negative
+ * \see ltfat_dgt_setpar_hint
+ */
+LTFAT_API int
+ltfat_dgt_setpar_olablocklength(ltfat_dgt_params* params, ltfat_int bl);
+
 /** Set algorithm hint
+ *
+ * With ltfat_dgt_auto (default), the analysis and the synthesis
+ * use independently the filter bank, the factorization or the overlap-add
+ * algorithm, whichever is predicted to be the fastest by a cost model
+ * of the algorithms.
+ * The model depends on the window length, a, M, L and the FFT lengths.
+ * Its constants can be fitted to the machine by
+ * ltfat_dgt_costmodel_calibrate().
+ *
+ * ltfat_dgt_ola splits the signal into blocks, transforms each block
+ * extended by the window length using the factorization algorithm and
+ * overlap-adds the results. It needs memory proportional to the block
+ * length instead of L, which pays off for very long signals and moderate
+ * windows. ltfat_dgt_auto considers it with the block length set by
+ * ltfat_dgt_setpar_olablocklength().
  *
  * \returns
  * Status code          |  Description
@@ -66,6 +134,21 @@ ltfat_dgt_setpar_hint(ltfat_dgt_params* params, ltfat_dgt_hint hint);
 LTFAT_API int
 ltfat_dgt_setpar_synoverwrites(ltfat_dgt_params* params, int do_synoverwrites);
 
+/** Create FFT plans from the loaded FFTW wisdom only
+ *
+ * No time is spent measuring even if the FFTW flags ask for it.
+ * FFTs not covered by the wisdom fall back to FFTW_ESTIMATE plans.
+ *
+ * \returns
+ * Status code          |  Description
+ * ---------------------|----------------
+ * LTFATERR_SUCESS      |  No error occured
+ * LTFATERR_NULLPOINTER |  \a params was NULL
+ * \see ltfat_fftw_wisdom_load_d
+ */
+LTFAT_API int
+ltfat_dgt_setpar_wisdomonly(ltfat_dgt_params* params, int do_wisdomonly);
+
 /** Destroy struct
  *
  * \returns
@@ -77,6 +160,53 @@ ltfat_dgt_setpar_synoverwrites(ltfat_dgt_params* params, int do_synoverwrites);
 LTFAT_API int
 ltfat_dgt_params_free(ltfat_dgt_params* params);
 
+/** Fit the cost model of ltfat_dgt_auto to this machine
+ *
+ * Runs a micro-benchmark of both algorithms (takes about a second) and
+ * replaces the constants of the model. The result can be stored with
+ * ltfat_dgt_costmodel_save() such that it does not have to be repeated.
+ *
+ * \returns
+ * Status code          |  Description
+ * ---------------------|----------------
+ * LTFATERR_SUCESS      |  No error occured
+ * LTFATERR_FAILED      |  The measurements did not fit, the model was not changed
+ * LTFATERR_NOMEM       |  Heap allocation failed
+ */
+LTFAT_API int
+ltfat_dgt_costmodel_calibrate(void);
+
+/** Load constants of the cost model from a file
+ *
+ * The file is in the format written by ltfat_dgt_costmodel_save().
+ *
+ * \returns
+ * Status code          |  Description
+ * ---------------------|----------------
+ * LTFATERR_SUCESS      |  No error occured
+ * LTFATERR_NULLPOINTER |  \a path was NULL
+ * LTFATERR_FAILED      |  The file could not be opened or it was malformed
+ */
+LTFAT_API int
+ltfat_dgt_costmodel_load(const char* path);
+
+/** Save constants of the cost model to a file
+ *
+ * \returns
+ * Status code          |  Description
+ * ---------------------|----------------
+ * LTFATERR_SUCESS      |  No error occured
+ * LTFATERR_NULLPOINTER |  \a path was NULL
+ * LTFATERR_FAILED      |  The file could not be opened
+ */
+LTFAT_API int
+ltfat_dgt_costmodel_save(const char* path);
+
+/** Restore the built-in constants of the cost model
+ */
+LTFAT_API int
+ltfat_dgt_costmodel_reset(void);
+
 /** @} */
 /** @} */
 
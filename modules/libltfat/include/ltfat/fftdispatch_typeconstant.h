@@ -0,0 +1,127 @@
+#ifndef _ltfat_fftdispatch_typeconstant_h
+#define _ltfat_fftdispatch_typeconstant_h
+
+/** \defgroup fftdispatch FFT backend selection
+ *
+ * When the library is compiled with several FFT backends (FFTBACKEND=DISPATCH
+ * with make, FFTDISPATCH=ON with cmake), the backend is selected at runtime
+ * separately for each fft_init, ifft_init, fftreal_init and ifftreal_init
+ * call. The backend is, in the order of precedence,
+ *
+ * 1. the one requested in the plan flags using LTFAT_FFT_BACKEND(),
+ * 2. the library-wide one set by ltfat_fft_set_backend(),
+ * 3. the one found for the given precision, transform type, length and
+ *    number of channels in the tuning table,
+ * 4. the fastest one measured on the spot if autotuning is enabled
+ *    (see ltfat_fft_set_autotune()); the result is added to the table,
+ * 5. the first available one out of FFTW, native and KISS.
+ *
+ * The tuning table can be saved to and loaded from a file such that the
+ * measurements are done only once.
+ *
+ * With a single backend compiled in, the functions only report
+ * what is available.
+ *
+ * \addtogroup fftdispatch
+ * @{
+ */
+
+typedef enum
+{
+    LTFAT_FFT_BACKEND_AUTO   = 0,
+    LTFAT_FFT_BACKEND_FFTW   = 1,
+    LTFAT_FFT_BACKEND_NATIVE = 2,
+    LTFAT_FFT_BACKEND_KISS   = 3
+} ltfat_fft_backend;
+
+/** FFT backend for a single FFT plan
+ *
+ * The value is to be OR-ed with the flags passed to fft_init,
+ * ifft_init, fftreal_init and ifftreal_init (and to any function passing
+ * the flags to them). LTFAT_FFT_BACKEND_AUTO leaves the choice to the
+ * library.
+ */
+#define LTFAT_FFT_BACKEND(b) ( ((unsigned)(b) & 0x3U) << 22 )
+
+/** \returns 1 if the backend is compiled in, 0 otherwise
+ */
+LTFAT_API int
+ltfat_fft_backend_available(ltfat_fft_backend backend);
+
+/** \returns Name of the backend ("auto", "fftw", "native" or "kiss") or NULL
+ */
+LTFAT_API const char*
+ltfat_fft_backend_name(ltfat_fft_backend backend);
+
+/** Force a backend for all plans created afterwards
+ *
+ * \param[in] backend  Backend or LTFAT_FFT_BACKEND_AUTO to restore the
+ *                     default behavior
+ *
+ * \returns
+ * Status code          |  Description
+ * ---------------------|----------------
+ * LTFATERR_SUCESS      |  No error occured
+ * LTFATERR_NOTSUPPORTED|  The backend is not compiled in
+ */
+LTFAT_API int
+ltfat_fft_set_backend(ltfat_fft_backend backend);
+
+/** \returns The backend set by ltfat_fft_set_backend()
+ */
+LTFAT_API ltfat_fft_backend
+ltfat_fft_get_backend(void);
+
+/** Enable or disable autotuning
+ *
+ * When enabled, the first plan with a combination of precision,
+ * transform type, length and number of channels not yet present in the
+ * tuning table times all available backends and records the fastest one.
+ * This makes the first plan creation considerably slower.
+ * Disabled by default.
+ *
+ * \returns LTFATERR_SUCCESS
+ */
+LTFAT_API int
+ltfat_fft_set_autotune(int do_autotune);
+
+/** Load the tuning table from a file
+ *
+ * The entries are added to the table, overwriting entries with the same
+ * key. Entries referring to backends not compiled in are ignored.
+ *
+ * \returns
+ * Status code          |  Description
+ * ---------------------|----------------
+ * LTFATERR_SUCESS      |  No error occured
+ * LTFATERR_NULLPOINTER |  \a path is NULL
+ * LTFATERR_FAILED      |  The file cannot be read or parsed
+ * LTFATERR_NOMEM       |  Memory allocation failed
+ */
+LTFAT_API int
+ltfat_fft_tune_load(const char* path);
+
+/** Save the tuning table to a file
+ *
+ * \returns
+ * Status code          |  Description
+ * ---------------------|----------------
+ * LTFATERR_SUCESS      |  No error occured
+ * LTFATERR_NULLPOINTER |  \a path is NULL
+ * LTFATERR_FAILED      |  The file cannot be written
+ */
+LTFAT_API int
+ltfat_fft_tune_save(const char* path);
+
+/** Remove all entries from the tuning table
+ *
+ * \returns Number of removed entries
+ */
+LTFAT_API int
+ltfat_fft_tune_clear(void);
+
+/** @} */
+
+#define LTFAT_FFT_GETBACKEND(flags) ( (ltfat_fft_backend)(((flags) >> 22) & 0x3U) )
+
+#endif
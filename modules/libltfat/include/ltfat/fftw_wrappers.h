@@ -77,3 +77,147 @@ LTFAT_NAME(ifftreal_execute_newarray)(LTFAT_NAME(ifftreal_plan)* p,
 
 LTFAT_API int
 LTFAT_NAME(ifftreal_done)(LTFAT_NAME(ifftreal_plan)** p);
+
+/** Size of the workspace needed by fft_execute_ws in bytes
+ *
+ * The *_execute_ws functions do the same as *_execute_newarray, but
+ * the scratch memory of the backend is taken from \a work instead of
+ * from the plan. The plan is not modified and it can therefore be
+ * executed by several threads at once, each of them passing its own
+ * workspace. \a work can be NULL, the plan-owned scratch is used then.
+ *
+ * Arrays must have the same alignment and in-place-ness as the arrays
+ * the plan was created with, as with *_execute_newarray.
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_fft_get_workspace_size_d(const ltfat_fft_plan_d* p);
+ * ltfat_ifft_get_workspace_size_d(const ltfat_ifft_plan_d* p);
+ * ltfat_fftreal_get_workspace_size_d(const ltfat_fftreal_plan_d* p);
+ * ltfat_ifftreal_get_workspace_size_d(const ltfat_ifftreal_plan_d* p);
+ * </tt>
+ * \returns Workspace size in bytes, possibly 0
+ */
+LTFAT_API size_t
+LTFAT_NAME(fft_get_workspace_size)(const LTFAT_NAME(fft_plan)* p);
+
+LTFAT_API int
+LTFAT_NAME(fft_execute_ws)(const LTFAT_NAME(fft_plan)* p,
+                           const LTFAT_COMPLEX in[], LTFAT_COMPLEX out[],
+                           void* work);
+
+LTFAT_API size_t
+LTFAT_NAME(ifft_get_workspace_size)(const LTFAT_NAME(ifft_plan)* p);
+
+LTFAT_API int
+LTFAT_NAME(ifft_execute_ws)(const LTFAT_NAME(ifft_plan)* p,
+                            const LTFAT_COMPLEX in[], LTFAT_COMPLEX out[],
+                            void* work);
+
+LTFAT_API size_t
+LTFAT_NAME(fftreal_get_workspace_size)(const LTFAT_NAME(fftreal_plan)* p);
+
+LTFAT_API int
+LTFAT_NAME(fftreal_execute_ws)(const LTFAT_NAME(fftreal_plan)* p,
+                               const LTFAT_REAL in[], LTFAT_COMPLEX out[],
+                               void* work);
+
+LTFAT_API size_t
+LTFAT_NAME(ifftreal_get_workspace_size)(const LTFAT_NAME(ifftreal_plan)* p);
+
+LTFAT_API int
+LTFAT_NAME(ifftreal_execute_ws)(const LTFAT_NAME(ifftreal_plan)* p,
+                                const LTFAT_COMPLEX in[], LTFAT_REAL out[],
+                                void* work);
+
+/** Release cached FFT plans which are not used by any plan
+ *
+ * FFT plans are shared by all plans with identical transform geometry
+ * (length, number of channels, in-place-ness, array alignment and flags).
+ * Plans which are not referenced anymore are kept for reuse until this
+ * function is called.
+ *
+ * \returns Number of released plans
+ */
+LTFAT_API int
+LTFAT_NAME(fft_cache_clear)(void);
+
+/** Measure all available FFT backends for the given length and number of channels
+ *
+ * The fastest backend for each of fft, ifft, fftreal and ifftreal is
+ * stored in the tuning table (see \ref fftdispatch), overwriting
+ * existing entries. The flags are used when creating the plans being
+ * timed.
+ *
+ * \returns
+ * Status code          |  Description
+ * ---------------------|----------------
+ * LTFATERR_SUCESS      |  No error occured
+ * LTFATERR_NOTPOSARG   |  \a L or \a W is not positive
+ * LTFATERR_NOTSUPPORTED|  The library was compiled with a single FFT backend
+ * LTFATERR_FAILED      |  No backend could be timed
+ */
+LTFAT_API int
+LTFAT_NAME(fft_tune)(ltfat_int L, ltfat_int W, unsigned flags);
+
+/** Import FFTW wisdom from a file
+ *
+ * Plans created after the import with FFTW_MEASURE, FFTW_PATIENT or
+ * FFTW_EXHAUSTIVE flags are obtained from the wisdom whenever it covers
+ * the transform geometry.
+ *
+ * \param[in]  path   Wisdom file
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_fftw_wisdom_load_d(const char* path);
+ *
+ * ltfat_fftw_wisdom_load_s(const char* path);
+ * </tt>
+ * \returns
+ * Status code           |  Description
+ * ----------------------|----------------
+ * LTFATERR_SUCCESS      |  No error occured
+ * LTFATERR_NULLPOINTER  |  \a path was NULL
+ * LTFATERR_FAILED       |  The file could not be read or parsed
+ * LTFATERR_NOTSUPPORTED |  The library was not compiled with FFTW
+ */
+LTFAT_API int
+LTFAT_NAME(fftw_wisdom_load)(const char* path);
+
+/** Export accumulated FFTW wisdom to a file
+ *
+ * \param[in]  path   Wisdom file
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_fftw_wisdom_save_d(const char* path);
+ *
+ * ltfat_fftw_wisdom_save_s(const char* path);
+ * </tt>
+ * \returns
+ * Status code           |  Description
+ * ----------------------|----------------
+ * LTFATERR_SUCCESS      |  No error occured
+ * LTFATERR_NULLPOINTER  |  \a path was NULL
+ * LTFATERR_FAILED       |  The file could not be written
+ * LTFATERR_NOTSUPPORTED |  The library was not compiled with FFTW
+ */
+LTFAT_API int
+LTFAT_NAME(fftw_wisdom_save)(const char* path);
+
+/** Enable wisdom-only planning for all plans
+ *
+ * When enabled, FFTW_WISDOM_ONLY is added to the flags of every plan which
+ * would otherwise measure, such that no plan ever spends time measuring.
+ * The same can be requested for individual plans by passing
+ * FFTW_WISDOM_ONLY in flags.
+ * In both cases, transforms not covered by the wisdom fall back to
+ * FFTW_ESTIMATE plans.
+ *
+ * \param[in]  do_wisdomonly   0 to disable, nonzero to enable
+ *
+ * \returns LTFATERR_SUCCESS
+ */
+LTFAT_API int
+LTFAT_NAME(fftw_set_wisdomonly)(int do_wisdomonly);
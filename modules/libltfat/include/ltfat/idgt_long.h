@@ -92,6 +92,43 @@ LTFAT_NAME(idgt_long_init)( const LTFAT_TYPE g[],
                             const ltfat_phaseconvention ptype, unsigned flags,
                             LTFAT_NAME(idgt_long_plan)** plan);
 
+/** Set number of threads computing the factorization
+ *
+ * Works the same way as ltfat_dgt_long_set_numthreads(). The initial
+ * inverse FFT uses the threads requested by the planning flags.
+ * The default is 1.
+ *
+ * \param[in]  plan      IDGT plan
+ * \param[in]  nthreads  Number of threads, 0 selects the number set by
+ *                       ltfat_set_num_threads()
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_idgt_long_set_numthreads_d(ltfat_idgt_long_plan_d* plan,
+ *                                  int nthreads);
+ *
+ * ltfat_idgt_long_set_numthreads_s(ltfat_idgt_long_plan_s* plan,
+ *                                  int nthreads);
+ *
+ * ltfat_idgt_long_set_numthreads_dc(ltfat_idgt_long_plan_dc* plan,
+ *                                   int nthreads);
+ *
+ * ltfat_idgt_long_set_numthreads_sc(ltfat_idgt_long_plan_sc* plan,
+ *                                   int nthreads);
+ * </tt>
+ * \returns
+ * Status code              | Description
+ * -------------------------|--------------------------------------------
+ * LTFATERR_SUCCESS         | Indicates no error
+ * LTFATERR_NULLPOINTER     | \a plan was NULL
+ * LTFATERR_NOTINRANGE      | \a nthreads was not in range 0-256
+ * LTFATERR_INITFAILED      | FFTW plan creation failed
+ * LTFATERR_NOMEM           | Indicates that heap allocation failed
+ */
+LTFAT_API int
+LTFAT_NAME(idgt_long_set_numthreads)(LTFAT_NAME(idgt_long_plan)* plan,
+                                     int nthreads);
+
 
 /** Execute the Inverse Discrete Gabor Transform plan
  *
@@ -142,6 +179,59 @@ LTFAT_NAME(idgt_long_execute_newarray)(LTFAT_NAME(idgt_long_plan)* p,
                                        const LTFAT_COMPLEX c[],
                                        LTFAT_COMPLEX f[]);
 
+/** Size of the workspace needed by idgt_long_execute_ws in bytes
+ *
+ * \param[in]       p   Plan
+ * \returns Workspace size in bytes, 0 if \a p was NULL
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_idgt_long_get_workspace_size_d(const ltfat_idgt_long_plan_d* p);
+ *
+ * ltfat_idgt_long_get_workspace_size_s(const ltfat_idgt_long_plan_s* p);
+ *
+ * ltfat_idgt_long_get_workspace_size_dc(const ltfat_idgt_long_plan_dc* p);
+ *
+ * ltfat_idgt_long_get_workspace_size_sc(const ltfat_idgt_long_plan_sc* p);
+ * </tt>
+ */
+LTFAT_API size_t
+LTFAT_NAME(idgt_long_get_workspace_size)(const LTFAT_NAME(idgt_long_plan)* p);
+
+/** Execute plan using a caller-supplied workspace
+ *
+ * Same as idgt_long_execute_newarray, but the intermediate coefficients
+ * and all other buffers live in \a ws, so that one plan can be executed
+ * concurrently by threads passing distinct workspaces. The computation
+ * is done by the calling thread.
+ *
+ * \param[in]       p   Plan
+ * \param[in]       c   Input coefficients, size M x N x W
+ * \param[out]      f   Output signal, size L x W
+ * \param[in]      ws   Workspace of idgt_long_get_workspace_size bytes,
+ *                      any alignment
+ * \returns Status code
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_idgt_long_execute_ws_d(const ltfat_idgt_long_plan_d* p, const ltfat_complex_d c[],
+ *                              ltfat_complex_d f[], void* ws);
+ *
+ * ltfat_idgt_long_execute_ws_s(const ltfat_idgt_long_plan_s* p, const ltfat_complex_s c[],
+ *                              ltfat_complex_s f[], void* ws);
+ *
+ * ltfat_idgt_long_execute_ws_dc(const ltfat_idgt_long_plan_dc* p, const ltfat_complex_d c[],
+ *                               ltfat_complex_d f[], void* ws);
+ *
+ * ltfat_idgt_long_execute_ws_sc(const ltfat_idgt_long_plan_sc* p, const ltfat_complex_s c[],
+ *                               ltfat_complex_s f[], void* ws);
+ * </tt>
+ */
+LTFAT_API int
+LTFAT_NAME(idgt_long_execute_ws)(const LTFAT_NAME(idgt_long_plan)* p,
+                                 const LTFAT_COMPLEX c[], LTFAT_COMPLEX f[],
+                                 void* ws);
+
 
 /** Destroy the Discrete Gabor Transform plan
  *
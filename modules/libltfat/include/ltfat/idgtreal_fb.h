@@ -89,6 +89,72 @@ LTFAT_NAME(idgtreal_fb_init)(const LTFAT_REAL g[], ltfat_int gl,
                              ltfat_int a, ltfat_int M, const ltfat_phaseconvention ptype,
                              unsigned flags, LTFAT_NAME(idgtreal_fb_plan)** plan);
 
+/** Set number of frames transformed by a single FFT call
+ *
+ * Frames are processed in blocks of \a blocksize consecutive frames
+ * which are transformed together using one multi-column FFT plan.
+ * This reduces the per-call FFT overhead for short windows.
+ * The default is 1, i.e. one frame at a time.
+ *
+ * \param[in] plan       DGT plan
+ * \param[in] blocksize  Number of frames in a block or 0 to choose
+ *                       a block size based on \a M
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_idgtreal_fb_set_blocksize_d(ltfat_idgtreal_fb_plan_d* plan,
+ *                                   ltfat_int blocksize);
+ *
+ * ltfat_idgtreal_fb_set_blocksize_s(ltfat_idgtreal_fb_plan_s* plan,
+ *                                   ltfat_int blocksize);
+ * </tt>
+ * \returns
+ * Status code              | Description
+ * -------------------------|--------------------------------------------
+ * LTFATERR_SUCCESS         | Indicates no error
+ * LTFATERR_NULLPOINTER     | \a plan was NULL
+ * LTFATERR_BADARG          | \a blocksize was negative
+ * LTFATERR_INITFAILED      | FFTW plan creation failed
+ * LTFATERR_NOMEM           | Indicates that heap allocation failed
+ */
+LTFAT_API int
+LTFAT_NAME(idgtreal_fb_set_blocksize)(LTFAT_NAME(idgtreal_fb_plan)* plan, ltfat_int blocksize);
+
+/** Set number of threads processing the frames
+ *
+ * The frames are distributed among the threads, each thread having its
+ * own buffers and FFT plan.
+ * The frames are split into tiles processed in two passes such that
+ * the overlap-add of the concurrently processed tiles never touches the
+ * same samples.
+ * The worker threads are shared by the whole library. Calls made while
+ * they are busy with another call process all frames in the calling thread.
+ * The default is 1.
+ *
+ * \param[in] plan       DGT plan
+ * \param[in] nthreads   Number of threads, 0 selects the number set by
+ *                       ltfat_set_num_threads()
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_idgtreal_fb_set_numthreads_d(ltfat_idgtreal_fb_plan_d* plan,
+ *                                    int nthreads);
+ *
+ * ltfat_idgtreal_fb_set_numthreads_s(ltfat_idgtreal_fb_plan_s* plan,
+ *                                    int nthreads);
+ * </tt>
+ * \returns
+ * Status code              | Description
+ * -------------------------|--------------------------------------------
+ * LTFATERR_SUCCESS         | Indicates no error
+ * LTFATERR_NULLPOINTER     | \a plan was NULL
+ * LTFATERR_NOTINRANGE      | \a nthreads was not in range 0-256
+ * LTFATERR_INITFAILED      | FFTW plan creation failed
+ * LTFATERR_NOMEM           | Indicates that heap allocation failed
+ */
+LTFAT_API int
+LTFAT_NAME(idgtreal_fb_set_numthreads)(LTFAT_NAME(idgtreal_fb_plan)* plan, int nthreads);
+
 LTFAT_API int
 LTFAT_NAME(idgtreal_fb_set_overwriteoutarray)(
     LTFAT_NAME(idgtreal_fb_plan)* p, int do_overwriteoutarray);
@@ -123,6 +189,57 @@ LTFAT_API int
 LTFAT_NAME(idgtreal_fb_execute)(LTFAT_NAME(idgtreal_fb_plan)* plan, const LTFAT_COMPLEX c[],
                                 ltfat_int L, ltfat_int W, LTFAT_REAL f[]);
 
+/** Size of the workspace needed by idgtreal_fb_execute_ws in bytes
+ *
+ * The size depends on the block size, see idgtreal_fb_set_blocksize.
+ *
+ * \param[in]  plan   IDGT plan
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_idgtreal_fb_get_workspace_size_d(const ltfat_idgtreal_fb_plan_d* plan);
+ *
+ * ltfat_idgtreal_fb_get_workspace_size_s(const ltfat_idgtreal_fb_plan_s* plan);
+ * </tt>
+ * \returns Workspace size in bytes, 0 if \a plan was NULL
+ */
+LTFAT_API size_t
+LTFAT_NAME(idgtreal_fb_get_workspace_size)(const LTFAT_NAME(idgtreal_fb_plan)* plan);
+
+/** Execute plan using a caller-supplied workspace
+ *
+ * Same as idgtreal_fb_execute with the frame buffers taken from \a ws, so
+ * that the plan is only read and can be shared by concurrently running
+ * threads with distinct workspaces. The frames are processed by the
+ * calling thread.
+ *
+ * \param[in]  plan   IDGT plan
+ * \param[in]     c   DGT coefficients, size M2 x N x W
+ * \param[in]     L   Signal length
+ * \param[in]     W   Number of channels of the signal
+ * \param[out]    f   Output signal, size L x W
+ * \param[in]    ws   Workspace of idgtreal_fb_get_workspace_size bytes,
+ *                    any alignment
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_idgtreal_fb_execute_ws_d(const ltfat_idgtreal_fb_plan_d* plan,
+ *                                const ltfat_complex_d c[], ltfat_int L,
+ *                                ltfat_int W, double f[], void* ws);
+ *
+ * ltfat_idgtreal_fb_execute_ws_s(const ltfat_idgtreal_fb_plan_s* plan,
+ *                                const ltfat_complex_s c[], ltfat_int L,
+ *                                ltfat_int W, float f[], void* ws);
+ * </tt>
+ *
+ * \returns
+ * Same status codes as idgtreal_fb_execute, LTFATERR_NULLPOINTER also if \a ws was NULL
+ */
+LTFAT_API int
+LTFAT_NAME(idgtreal_fb_execute_ws)(const LTFAT_NAME(idgtreal_fb_plan)* plan,
+                                   const LTFAT_COMPLEX c[], ltfat_int L,
+                                   ltfat_int W, LTFAT_REAL f[], void* ws);
+
 /** Destroy the plan
  *
  * \param[in]  plan   DGT plan
@@ -96,6 +96,37 @@ LTFAT_NAME(idgtreal_long_init)( const LTFAT_REAL g[],
                                 const ltfat_phaseconvention ptype, unsigned flags,
                                 LTFAT_NAME(idgtreal_long_plan)** plan);
 
+/** Set number of threads computing the factorization
+ *
+ * Works the same way as ltfat_dgt_long_set_numthreads(). The initial
+ * inverse FFT uses the threads requested by the planning flags.
+ * The default is 1.
+ *
+ * \param[in]  plan      IDGT plan
+ * \param[in]  nthreads  Number of threads, 0 selects the number set by
+ *                       ltfat_set_num_threads()
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_idgtreal_long_set_numthreads_d(ltfat_idgtreal_long_plan_d* plan,
+ *                                      int nthreads);
+ *
+ * ltfat_idgtreal_long_set_numthreads_s(ltfat_idgtreal_long_plan_s* plan,
+ *                                      int nthreads);
+ * </tt>
+ * \returns
+ * Status code              | Description
+ * -------------------------|--------------------------------------------
+ * LTFATERR_SUCCESS         | Indicates no error
+ * LTFATERR_NULLPOINTER     | \a plan was NULL
+ * LTFATERR_NOTINRANGE      | \a nthreads was not in range 0-256
+ * LTFATERR_INITFAILED      | FFTW plan creation failed
+ * LTFATERR_NOMEM           | Indicates that heap allocation failed
+ */
+LTFAT_API int
+LTFAT_NAME(idgtreal_long_set_numthreads)(LTFAT_NAME(idgtreal_long_plan)* plan,
+                                         int nthreads);
+
 
 LTFAT_API int
 LTFAT_NAME(idgtreal_long_set_overwriteoutarray)(
@@ -149,6 +180,55 @@ LTFAT_API int
 LTFAT_NAME(idgtreal_long_execute_newarray)(LTFAT_NAME(idgtreal_long_plan)* p,
         const LTFAT_COMPLEX* c, LTFAT_REAL* f);
 
+/** Size of the workspace needed by idgtreal_long_execute_ws in bytes
+ *
+ * \param[in]  plan   IDGT plan
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_idgtreal_long_get_workspace_size_d(const ltfat_idgtreal_long_plan_d* plan);
+ *
+ * ltfat_idgtreal_long_get_workspace_size_s(const ltfat_idgtreal_long_plan_s* plan);
+ * </tt>
+ * \returns Workspace size in bytes, 0 if \a plan was NULL
+ */
+LTFAT_API size_t
+LTFAT_NAME(idgtreal_long_get_workspace_size)(
+    const LTFAT_NAME(idgtreal_long_plan)* p);
+
+/** Execute plan using a caller-supplied workspace
+ *
+ * Same as idgtreal_long_execute_newarray, but the plan is only read and
+ * all buffers are taken from \a ws. Threads executing the same plan at
+ * once must pass distinct workspaces. The computation is done by the
+ * calling thread.
+ *
+ * \param[in]  plan   IDGT plan
+ * \param[in]     c   Coefficients, size M2 x N x W
+ * \param[out]    f   Output signal, size L x W
+ * \param[in]    ws   Workspace of idgtreal_long_get_workspace_size bytes,
+ *                    any alignment
+ *
+ * #### Versions #
+ * <tt>
+ * ltfat_idgtreal_long_execute_ws_d(const ltfat_idgtreal_long_plan_d* plan,
+ *                                  const ltfat_complex_d c[], double f[], void* ws);
+ *
+ * ltfat_idgtreal_long_execute_ws_s(const ltfat_idgtreal_long_plan_s* plan,
+ *                                  const ltfat_complex_s c[], float f[], void* ws);
+ * </tt>
+ * \returns
+ * Status code              | Description
+ * -------------------------|--------------------------------------------
+ * LTFATERR_SUCCESS         | Indicates no error
+ * LTFATERR_NULLPOINTER     | Al least one of the arguments was NULL.
+ * LTFATERR_NOTSUPPORTED    | The plan was created with FFTW_DESTROY_INPUT
+ */
+LTFAT_API int
+LTFAT_NAME(idgtreal_long_execute_ws)(const LTFAT_NAME(idgtreal_long_plan)* p,
+                                     const LTFAT_COMPLEX c[], LTFAT_REAL f[],
+                                     void* ws);
+
 /** Destroy the plan
  *
  * \param[in]  plan   IDGT plan
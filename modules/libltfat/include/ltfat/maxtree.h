@@ -15,6 +15,12 @@ LTFAT_NAME(maxtree_init)(
     LTFAT_NAME(maxtree)** p);
 
 
+// Same interface, but each node has 64/sizeof(LTFAT_REAL) children stored
+// in one cache line.
+LTFAT_API int
+LTFAT_NAME(maxtree_init_flat)(
+    ltfat_int L, ltfat_int Lstep, LTFAT_NAME(maxtree)** p);
+
 LTFAT_API int
 LTFAT_NAME(maxtree_initwitharray)(
     ltfat_int L, ltfat_int depth, const LTFAT_REAL inarray[],
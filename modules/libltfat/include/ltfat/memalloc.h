@@ -146,6 +146,48 @@ ltfat_postpad (void* ptr, size_t nold, size_t nnew);
 LTFAT_API
 void  ltfat_free(const void *ptr);
 
+/** \name Real-time safety checking
+ *
+ * The execute functions of the streaming processors (rtdgtreal_processor,
+ * block_processor, slicing_processor and slidgtrealmp) are meant to be
+ * called from an audio thread and they are not supposed to allocate or
+ * block. When enabled, every call to ltfat_malloc() or ltfat_free() (and
+ * the functions built on top of them) made from within such execute call,
+ * including the user callbacks, is reported as a violation. So is waiting
+ * for a lock the library shares with other threads, i.e. the pool behind
+ * the nthreads parameters of the DGT plans and the FFT plan caches.
+ *
+ * The work the processors hand over to their own threads (the worker and
+ * the parallel modes of rtdgtreal_processor, the batches of
+ * slicing_processor) is checked as if it was done by the execute call.
+ * Allocations made by other threads, e.g. by one initializing a different
+ * processor, are not reported.
+ * @{
+ */
+typedef enum
+{
+    ltfat_rtsafe_off = 0, /**< No checking (default) */
+    ltfat_rtsafe_count,   /**< Count the violations, see ltfat_rtsafe_getviolations() */
+    ltfat_rtsafe_abort    /**< Print a message to stderr and call abort() */
+} ltfat_rtsafe_policy;
+
+/** Set policy of the real-time safety checking
+ *
+ * \returns Old policy
+ */
+LTFAT_API ltfat_rtsafe_policy
+ltfat_rtsafe_setpolicy(ltfat_rtsafe_policy policy);
+
+/** Number of allocations made from within the execute functions
+ *  since the last call to ltfat_rtsafe_resetviolations()
+ */
+LTFAT_API size_t
+ltfat_rtsafe_getviolations(void);
+
+LTFAT_API void
+ltfat_rtsafe_resetviolations(void);
+/** @} */
+
 /** @} */
 
 
@@ -0,0 +1,62 @@
+#ifndef _ltfat_procstats_typeconstant_h
+#define _ltfat_procstats_typeconstant_h
+
+/** \defgroup procstats Stream processor instrumentation
+ *
+ * The stream processors (see rtdgtreal_processor_setstats() and
+ * block_processor_setstats()) can record how long the individual stages
+ * of the execute calls take. The durations are collected in logarithmic
+ * histograms with 8 bins per octave, so the reported percentiles
+ * are accurate to about 9 %.
+ *
+ * The counters are updated with atomic operations only, the execute
+ * function never waits for a reader. Snapshots can be taken and the
+ * counters can be reset from any thread while the processor is running.
+ * A snapshot taken concurrently with an execute call might
+ * include only part of that call.
+ *
+ * When the recording is disabled (the default), the execute functions
+ * only test a single pointer.
+ *
+ * \addtogroup procstats
+ * @{
+ */
+
+typedef enum
+{
+    ltfat_procstats_total = 0, /**< Whole execute call */
+    ltfat_procstats_fifowrite, /**< Writing the input samples to the input FIFO */
+    ltfat_procstats_fiforead,  /**< Reading the output samples from the output FIFO */
+    ltfat_procstats_forward,   /**< Reading and windowing the frames, forward transform */
+    ltfat_procstats_callback,  /**< User callback */
+    ltfat_procstats_inverse,   /**< Inverse transform, windowing, overlap-add to the output FIFO */
+    ltfat_procstats_nstages
+} ltfat_procstats_stage;
+
+typedef struct
+{
+    size_t count;  /**< Number of recorded durations */
+    double mean;   /**< Mean duration in seconds */
+    double p50;    /**< Median duration in seconds */
+    double p99;    /**< 99th percentile of the durations in seconds */
+    double max;    /**< Longest duration in seconds */
+} ltfat_procstats_timing;
+
+/** Snapshot of the counters
+ *
+ * Each stage is recorded once per execute call, summed over all frames
+ * processed in that call. Stages which did not occur in a call (e.g. no frame
+ * was complete) are not recorded. In the worker mode of rtdgtreal_processor,
+ * the forward, callback and inverse stages are recorded once per pass of
+ * the worker thread.
+ */
+typedef struct
+{
+    size_t calls;   /**< Number of execute calls */
+    size_t frames;  /**< Number of processed frames (blocks) */
+    ltfat_procstats_timing stage[ltfat_procstats_nstages]; /**< Indexed by ltfat_procstats_stage */
+} ltfat_procstats;
+
+/** @} */
+
+#endif
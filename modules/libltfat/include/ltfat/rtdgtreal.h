@@ -54,6 +54,55 @@ LTFAT_NAME(rtdgtreal_execute)(const LTFAT_NAME(rtdgtreal_plan)* p,
                               const LTFAT_REAL f[], ltfat_int W,
                               LTFAT_COMPLEX c[]);
 
+/** Size of the workspace needed by rtdgtreal_execute_ws in bytes
+ * \param[in]  p      RTDGTREAL plan
+ * \returns Workspace size, 0 if \a p was NULL
+ */
+LTFAT_API size_t
+LTFAT_NAME(rtdgtreal_get_workspace_size)(const LTFAT_NAME(rtdgtreal_plan)* p);
+
+/** Execute RTDGTREAL plan using a caller-supplied workspace
+ *
+ * Same as rtdgtreal_execute, but the frame buffers are taken from \a ws
+ * such that threads can share a single plan, each with its own workspace.
+ *
+ * \param[in]  p      RTDGTREAL plan
+ * \param[in]  f      Input buffer (gl x W)
+ * \param[in]  W      Number of channels
+ * \param[out] c      Output DGT coefficients (M2 x W)
+ * \param[in]  ws     Workspace of rtdgtreal_get_workspace_size bytes
+ */
+LTFAT_API int
+LTFAT_NAME(rtdgtreal_execute_ws)(const LTFAT_NAME(rtdgtreal_plan)* p,
+                                 const LTFAT_REAL f[], ltfat_int W,
+                                 LTFAT_COMPLEX c[], void* ws);
+
+/** Prepare RTDGTREAL plan for multi-frame execution
+ *
+ * Creates a single FFT plan transforming framesMax frames at once.
+ * rtdgtreal_execute_frames() falls back to transforming the frames one
+ * by one when it is passed less than half of framesMax frames.
+ * 0 releases the multi-frame FFT plan.
+ *
+ * \param[in]  p          RTDGTREAL plan
+ * \param[in]  framesMax  Maximum number of frames (of all channels together)
+ */
+LTFAT_API int
+LTFAT_NAME(rtdgtreal_setmaxframes)(LTFAT_NAME(rtdgtreal_plan)* p,
+                                   ltfat_int framesMax);
+
+/** Execute RTDGTREAL plan on multiple frames
+ * \param[in]  p      RTDGTREAL plan
+ * \param[in]  f      Input frames (gl x N x W)
+ * \param[in]  N      Number of frames
+ * \param[in]  W      Number of channels
+ * \param[out] c      Output DGT coefficients (M2 x N x W)
+ */
+LTFAT_API int
+LTFAT_NAME(rtdgtreal_execute_frames)(const LTFAT_NAME(rtdgtreal_plan)* p,
+                                     const LTFAT_REAL f[], ltfat_int N,
+                                     ltfat_int W, LTFAT_COMPLEX c[]);
+
 /** Destroy RTDGTREAL plan
  * \param[in]  p      RTDGTREAL plan
  */
@@ -88,6 +137,51 @@ LTFAT_NAME(rtidgtreal_execute)(const LTFAT_NAME(rtidgtreal_plan)* p,
                                const LTFAT_COMPLEX c[], ltfat_int W,
                                LTFAT_REAL f[]);
 
+/** Size of the workspace needed by rtidgtreal_execute_ws in bytes
+ * \param[in]  p      RTIDGTREAL plan
+ * \returns Workspace size, 0 if \a p was NULL
+ */
+LTFAT_API size_t
+LTFAT_NAME(rtidgtreal_get_workspace_size)(const LTFAT_NAME(rtidgtreal_plan)* p);
+
+/** Execute RTIDGTREAL plan using a caller-supplied workspace
+ *
+ * See rtdgtreal_execute_ws().
+ *
+ * \param[in]  p      RTIDGTREAL plan
+ * \param[in]  c      Input DGT coefficients (M2 x W)
+ * \param[in]  W      Number of channels
+ * \param[out] f      Output buffer (gl x W)
+ * \param[in]  ws     Workspace of rtidgtreal_get_workspace_size bytes
+ */
+LTFAT_API int
+LTFAT_NAME(rtidgtreal_execute_ws)(const LTFAT_NAME(rtidgtreal_plan)* p,
+                                  const LTFAT_COMPLEX c[], ltfat_int W,
+                                  LTFAT_REAL f[], void* ws);
+
+/** Prepare RTIDGTREAL plan for multi-frame execution
+ *
+ * See rtdgtreal_setmaxframes().
+ *
+ * \param[in]  p          RTIDGTREAL plan
+ * \param[in]  framesMax  Maximum number of frames (of all channels together)
+ */
+LTFAT_API int
+LTFAT_NAME(rtidgtreal_setmaxframes)(LTFAT_NAME(rtidgtreal_plan)* p,
+                                    ltfat_int framesMax);
+
+/** Execute RTIDGTREAL plan on multiple frames
+ * \param[in]  p      RTIDGTREAL plan
+ * \param[in]  c      Input DGT coefficients (M2 x N x W)
+ * \param[in]  N      Number of frames
+ * \param[in]  W      Number of channels
+ * \param[out] f      Output frames (gl x N x W)
+ */
+LTFAT_API int
+LTFAT_NAME(rtidgtreal_execute_frames)(const LTFAT_NAME(rtidgtreal_plan)* p,
+                                      const LTFAT_COMPLEX c[], ltfat_int N,
+                                      ltfat_int W, LTFAT_REAL f[]);
+
 /** Destroy RTIDGTREAL plan
  * \param[in]  p      RTIDGTREAL plan
  */
@@ -155,6 +249,62 @@ typedef struct LTFAT_NAME(rtdgtreal_processor_state) LTFAT_NAME(rtdgtreal_proces
 typedef void LTFAT_NAME(rtdgtreal_processor_callback)(void* userdata,
         const LTFAT_COMPLEX in[], int M2, int W, LTFAT_COMPLEX out[]);
 
+/** Processor multi-frame callback signature
+ *
+ * The callback receives all frames which became available during a single
+ * execute call. Coefficients of frame n of channel w start at
+ * in[(n + w*N)*M2]. Frames are in the chronological order.
+ *
+ * It is safe to assume that out and in are not aliased.
+ *
+ * \param[in]  userdata   User defined data
+ * \param[in]        in   Input coefficients, M2 x N x W array
+ * \param[in]        M2   Number of unique FFT channels; equals to M/2 + 1
+ * \param[in]         N   Number of frames
+ * \param[in]         W   Number of channels
+ * \param[out]      out   Output coefficients, M2 x N x W array
+ *
+ *  #### Function versions #
+ *  <tt>
+ *  typedef void ltfat_rtdgtreal_processor_batchcallback_d(void* userdata, const ltfat_complex_d in[],
+ *                                                         int M2, int N, int W, ltfat_complex_d out[]);
+ *
+ *  typedef void ltfat_rtdgtreal_processor_batchcallback_s(void* userdata, const ltfat_complex_s in[],
+ *                                                         int M2, int N, int W, ltfat_complex_s out[]);
+ *  </tt>
+ */
+typedef void LTFAT_NAME(rtdgtreal_processor_batchcallback)(void* userdata,
+        const LTFAT_COMPLEX in[], int M2, int N, int W, LTFAT_COMPLEX out[]);
+
+/** Processor callback working on a group of channels
+ *
+ * Used with rtdgtreal_processor_set_numthreads(). One frame of channels
+ * chanStart to chanStart+W-1 is passed at once. Coefficients of channel
+ * chanStart+w start at in[w*M2]. The callback is called from several
+ * threads at once, each time with a disjoint group of channels, so it
+ * must not modify anything shared among the channels.
+ *
+ * \param[in]  userdata   User defined data
+ * \param[in]        in   Input coefficients, M2 x W array
+ * \param[in]        M2   Number of unique FFT channels; equals to M/2 + 1
+ * \param[in] chanStart   Index of the first channel of the group
+ * \param[in]         W   Number of channels in the group
+ * \param[out]      out   Output coefficients, M2 x W array
+ *
+ *  #### Function versions #
+ *  <tt>
+ *  typedef void ltfat_rtdgtreal_processor_groupcallback_d(void* userdata, const ltfat_complex_d in[],
+ *                                                         int M2, int chanStart, int W,
+ *                                                         ltfat_complex_d out[]);
+ *
+ *  typedef void ltfat_rtdgtreal_processor_groupcallback_s(void* userdata, const ltfat_complex_s in[],
+ *                                                         int M2, int chanStart, int W,
+ *                                                         ltfat_complex_s out[]);
+ *  </tt>
+ */
+typedef void LTFAT_NAME(rtdgtreal_processor_groupcallback)(void* userdata,
+        const LTFAT_COMPLEX in[], int M2, int chanStart, int W, LTFAT_COMPLEX out[]);
+
 /** Create DGTREAL processor state struct
  *
  * The processor wraps DGTREAL analysis-modify-synthesis loop suitable for
@@ -218,6 +368,7 @@ LTFAT_NAME(rtdgtreal_processor_init)(const LTFAT_REAL ga[], ltfat_int gal,
  * ----------------------|----------------------
  * LTFATERR_SUCCESS      |  No error occured
  * LTFATERR_NULLPOINTER  |  \a p was NULL
+ * LTFATERR_BADARG       |  The worker was running
  */
 LTFAT_API int
 LTFAT_NAME(rtdgtreal_processor_reset)(LTFAT_NAME(rtdgtreal_processor_state)* p);
@@ -342,6 +493,48 @@ LTFAT_NAME(rtdgtreal_processor_execute_gen_compact)(
     LTFAT_NAME(rtdgtreal_processor_state)* p, const LTFAT_REAL* in,
     ltfat_int inLen, ltfat_int chanNo, ltfat_int outLen, LTFAT_REAL* out);
 
+/** Process interleaved samples
+ *
+ * Works exactly like rtdgtreal_processor_execute except that the channels
+ * are interleaved, i.e. sample l of channel w is stored at in[w + l*chanNo],
+ * the layout audio hosts usually deliver. The samples are copied
+ * directly between the buffers and the internal FIFOs, no de-interleaving
+ * is necessary. The function can run inplace i.e. in==out.
+ *
+ * \param[in]      p  DGTREAL processor
+ * \param[in]     in  Input samples, chanNo x len interleaved array
+ * \param[in]    len  Number of samples per channel
+ * \param[in] chanNo  Number of channels
+ * \param[out]   out  Output samples, chanNo x len interleaved array
+ *
+ * #### Function versions #
+ * <tt>
+ * ltfat_rtdgtreal_processor_execute_interleaved_d(ltfat_rtdgtreal_processor_state_d* p, const double in[],
+ *                                                 ltfat_int len, ltfat_int chanNo, double out[]);
+ *
+ * ltfat_rtdgtreal_processor_execute_interleaved_s(ltfat_rtdgtreal_processor_state_s* p, const float in[],
+ *                                                 ltfat_int len, ltfat_int chanNo, float out[]);
+ * </tt>
+ *
+ * \returns
+ * Status code           |  Description
+ * ----------------------|----------------------
+ * LTFATERR_SUCCESS      |  No error occured
+ * LTFATERR_NULLPOINTER  |  One of the following was NULL: \a p, \a in, \a out
+ * LTFATERR_OVERFLOW     |  More than Wmax channels or more than bufLenMax samples were passed
+ */
+LTFAT_API int
+LTFAT_NAME(rtdgtreal_processor_execute_interleaved)(
+    LTFAT_NAME(rtdgtreal_processor_state)* p,
+    const LTFAT_REAL in[],
+    ltfat_int len, ltfat_int chanNo,
+    LTFAT_REAL out[]);
+
+LTFAT_API int
+LTFAT_NAME(rtdgtreal_processor_execute_gen_interleaved)(
+    LTFAT_NAME(rtdgtreal_processor_state)* p, const LTFAT_REAL* in,
+    ltfat_int inLen, ltfat_int chanNo, ltfat_int outLen, LTFAT_REAL* out);
+
 
 /** Destroy DGTREAL processor state
  * \param[in]  p      DGTREAL processor
@@ -383,12 +576,258 @@ LTFAT_NAME(rtdgtreal_processor_done)(LTFAT_NAME(rtdgtreal_processor_state)** pla
  *                                         ltfat_rtdgtreal_processor_callback_s* callback,
  *                                         void* userdata);
  * </tt>
+ *
+ * \returns
+ * Status code           |  Description
+ * ----------------------|----------------------
+ * LTFATERR_SUCCESS      |  No error occured
+ * LTFATERR_NULLPOINTER  |  \a p was NULL
+ * LTFATERR_BADARG       |  The worker was running
  */
 LTFAT_API int
 LTFAT_NAME(rtdgtreal_processor_setcallback)(LTFAT_NAME(rtdgtreal_processor_state)* p,
         LTFAT_NAME(rtdgtreal_processor_callback)* callback,
         void* userdata);
 
+/** Switch DGTREAL processor to the multi-frame mode
+ *
+ * In the multi-frame mode, all frames available after writing the input
+ * samples are transformed by a single multi-column FFT, passed to
+ * \a callback at once and the whole batch is overlap-added to the output.
+ * The output is the same as in the default frame-by-frame mode with an
+ * equivalent callback. A batch holds at most ceil(bufLenMax/a)+1 frames,
+ * where a is the analysis hop size at the time of this call.
+ *
+ * Passing NULL as \a callback returns the processor to the frame-by-frame
+ * mode with the callback set by rtdgtreal_processor_setcallback().
+ *
+ * The function allocates memory and it is not thread safe. Only call it
+ * if there is no chance that the execute function is called simultaneously
+ * in a different thread.
+ *
+ * \param[in]            p   DGTREAL processor state
+ * \param[in]     callback   Custom function to process batches of coefficients
+ * \param[in]     userdata   Custom callback data. Will be passed to the callback.
+ *
+ * #### Function versions #
+ * <tt>
+ * ltfat_rtdgtreal_processor_setbatchcallback_d(ltfat_rtdgtreal_processor_state_d* p,
+ *                                              ltfat_rtdgtreal_processor_batchcallback_d* callback,
+ *                                              void* userdata);
+ *
+ * ltfat_rtdgtreal_processor_setbatchcallback_s(ltfat_rtdgtreal_processor_state_s* p,
+ *                                              ltfat_rtdgtreal_processor_batchcallback_s* callback,
+ *                                              void* userdata);
+ * </tt>
+ *
+ * \returns
+ * Status code           |  Description
+ * ----------------------|----------------------
+ * LTFATERR_SUCCESS      |  No error occured
+ * LTFATERR_NULLPOINTER  |  \a p was NULL
+ * LTFATERR_BADARG       |  The worker was running
+ * LTFATERR_NOMEM        |  Heap memory allocation failed
+ */
+LTFAT_API int
+LTFAT_NAME(rtdgtreal_processor_setbatchcallback)(LTFAT_NAME(rtdgtreal_processor_state)* p,
+        LTFAT_NAME(rtdgtreal_processor_batchcallback)* callback,
+        void* userdata);
+
+/** Split the channels of DGTREAL processor among threads
+ *
+ * The channels are processed independently, therefore the output is
+ * identical to the single-threaded one. The threads share the transform
+ * plans, each of them gets its own workspace (see rtdgtreal_execute_ws())
+ * and a contiguous range of channels. The processor starts nthreads - 1
+ * threads of its own, the thread calling execute (or the worker thread,
+ * see rtdgtreal_processor_startworker()) processes a range as well.
+ * They are not shared with other processors or with the offline transforms,
+ * so a frame never waits for an unrelated job. Waking them up does not
+ * block on a lock. A thread which is late takes no range and the others
+ * process it instead.
+ *
+ * Only the transforms run in parallel unless a group callback is set, see
+ * rtdgtreal_processor_setgroupcallback(). The batch mode
+ * (rtdgtreal_processor_setbatchcallback()) is always single-threaded.
+ *
+ * The execute call still waits for all threads to finish the frame.
+ * In a real-time setting, consider moving the processing to the worker
+ * thread using rtdgtreal_processor_startworker() as well.
+ *
+ * \param[in]            p   DGTREAL processor state
+ * \param[in]     nthreads   Number of threads. 0 means ltfat_get_num_threads(),
+ *                           1 turns the parallel processing off. It is
+ *                           silently limited to the number of channels.
+ *
+ * #### Function versions #
+ * <tt>
+ * ltfat_rtdgtreal_processor_set_numthreads_d(ltfat_rtdgtreal_processor_state_d* p, int nthreads);
+ *
+ * ltfat_rtdgtreal_processor_set_numthreads_s(ltfat_rtdgtreal_processor_state_s* p, int nthreads);
+ * </tt>
+ *
+ * \returns
+ * Status code           |  Description
+ * ----------------------|----------------------
+ * LTFATERR_SUCCESS      |  No error occured
+ * LTFATERR_NULLPOINTER  |  \a p was NULL
+ * LTFATERR_NOTINRANGE   |  \a nthreads is negative or larger than LTFAT_MAXTHREADS
+ * LTFATERR_BADARG       |  The worker thread is running
+ * LTFATERR_INITFAILED   |  The threads could not be created
+ * LTFATERR_NOMEM        |  Heap memory allocation failed
+ */
+LTFAT_API int
+LTFAT_NAME(rtdgtreal_processor_set_numthreads)(LTFAT_NAME(rtdgtreal_processor_state)* p,
+        int nthreads);
+
+/** Set processor callback working on groups of channels
+ *
+ * With more than one thread, the forward transform, the callback and the
+ * inverse transform of a channel group are done by the same thread without
+ * synchronization in between. The stage timings report the whole pass as the
+ * callback stage. The group callback takes over the callback set by
+ * rtdgtreal_processor_setcallback(). Passing NULL reverts to it.
+ *
+ * \param[in]            p   DGTREAL processor state
+ * \param[in]     callback   Custom function to process groups of channels
+ * \param[in]     userdata   Custom callback data. Will be passed to the callback.
+ *
+ * #### Function versions #
+ * <tt>
+ * ltfat_rtdgtreal_processor_setgroupcallback_d(ltfat_rtdgtreal_processor_state_d* p,
+ *                                              ltfat_rtdgtreal_processor_groupcallback_d* callback,
+ *                                              void* userdata);
+ *
+ * ltfat_rtdgtreal_processor_setgroupcallback_s(ltfat_rtdgtreal_processor_state_s* p,
+ *                                              ltfat_rtdgtreal_processor_groupcallback_s* callback,
+ *                                              void* userdata);
+ * </tt>
+ *
+ * \returns
+ * Status code           |  Description
+ * ----------------------|----------------------
+ * LTFATERR_SUCCESS      |  No error occured
+ * LTFATERR_NULLPOINTER  |  \a p was NULL
+ * LTFATERR_BADARG       |  The worker was running
+ */
+LTFAT_API int
+LTFAT_NAME(rtdgtreal_processor_setgroupcallback)(LTFAT_NAME(rtdgtreal_processor_state)* p,
+        LTFAT_NAME(rtdgtreal_processor_groupcallback)* callback,
+        void* userdata);
+
+/** Move the processing of DGTREAL processor to a worker thread
+ *
+ * In the worker mode, execute only writes the input samples, wakes up
+ * a DSP thread and reads the output samples. The DSP thread does the
+ * transforms and calls the processor callback (or the multi-frame callback).
+ * The audio thread never waits for it and it never takes a lock.
+ *
+ * The output is delayed by \a latency samples in addition to the processing
+ * delay. This gives the DSP thread time to finish frames which become
+ * complete in an execute call. If the output samples are still not
+ * ready, execute fills them with zeros and returns LTFATERR_UNDERFLOW. The
+ * late samples are dropped once the DSP thread delivers them, so the delay
+ * stays the same. Such samples are counted, see
+ * rtdgtreal_processor_getunderruns().
+ *
+ * The processor is reset. Only execute can be called while the worker is
+ * running. The functions replacing the callbacks, changing the hop sizes or
+ * resetting the processor fail with LTFATERR_BADARG until it is stopped.
+ *
+ * \param[in]            p   DGTREAL processor state
+ * \param[in]      latency   Additional delay in samples
+ *
+ * #### Function versions #
+ * <tt>
+ * ltfat_rtdgtreal_processor_startworker_d(ltfat_rtdgtreal_processor_state_d* p, ltfat_int latency);
+ *
+ * ltfat_rtdgtreal_processor_startworker_s(ltfat_rtdgtreal_processor_state_s* p, ltfat_int latency);
+ * </tt>
+ *
+ * \returns
+ * Status code           |  Description
+ * ----------------------|----------------------
+ * LTFATERR_SUCCESS      |  No error occured
+ * LTFATERR_NULLPOINTER  |  \a p was NULL
+ * LTFATERR_BADARG       |  \a latency was negative or the worker was already running
+ * LTFATERR_INITFAILED   |  The thread could not be created
+ * LTFATERR_NOMEM        |  Heap memory allocation failed
+ */
+LTFAT_API int
+LTFAT_NAME(rtdgtreal_processor_startworker)(LTFAT_NAME(rtdgtreal_processor_state)* p,
+        ltfat_int latency);
+
+/** Stop the worker thread
+ *
+ * Joins the DSP thread and returns the processor to processing in execute.
+ * The processor is reset. Does nothing if the worker is not running.
+ *
+ * \param[in]            p   DGTREAL processor state
+ *
+ * \returns
+ * Status code           |  Description
+ * ----------------------|----------------------
+ * LTFATERR_SUCCESS      |  No error occured
+ * LTFATERR_NULLPOINTER  |  \a p was NULL
+ * LTFATERR_NOMEM        |  Heap memory allocation failed
+ */
+LTFAT_API int
+LTFAT_NAME(rtdgtreal_processor_stopworker)(LTFAT_NAME(rtdgtreal_processor_state)* p);
+
+/** Number of output samples replaced by zeros because the worker was late
+ *
+ * The counter is cleared by rtdgtreal_processor_startworker().
+ */
+LTFAT_API size_t
+LTFAT_NAME(rtdgtreal_processor_getunderruns)(const LTFAT_NAME(rtdgtreal_processor_state)* p);
+
+/** Enable or disable recording of the execute timings
+ *
+ * When enabled, execute records the durations of its stages and the number
+ * of processed frames, see \ref procstats. Disabling releases the counters.
+ * Like the callback setters, this is not thread safe and it cannot be
+ * called while the worker is running.
+ *
+ * \param[in]            p   DGTREAL processor state
+ * \param[in]       enable   Nonzero to enable
+ *
+ * \returns
+ * Status code           |  Description
+ * ----------------------|----------------------
+ * LTFATERR_SUCCESS      |  No error occured
+ * LTFATERR_NULLPOINTER  |  \a p was NULL
+ * LTFATERR_BADARG       |  The worker was running
+ * LTFATERR_NOMEM        |  Heap memory allocation failed
+ */
+LTFAT_API int
+LTFAT_NAME(rtdgtreal_processor_setstats)(LTFAT_NAME(rtdgtreal_processor_state)* p,
+        int enable);
+
+/** Take a snapshot of the execute timings
+ *
+ * Can be called from any thread while the processor is running.
+ *
+ * \param[in]            p   DGTREAL processor state
+ * \param[out]       stats   Snapshot
+ *
+ * \returns
+ * Status code           |  Description
+ * ----------------------|----------------------
+ * LTFATERR_SUCCESS      |  No error occured
+ * LTFATERR_NULLPOINTER  |  \a p or \a stats was NULL
+ * LTFATERR_FAILED       |  The recording was not enabled
+ */
+LTFAT_API int
+LTFAT_NAME(rtdgtreal_processor_getstats)(const LTFAT_NAME(rtdgtreal_processor_state)* p,
+        ltfat_procstats* stats);
+
+/** Clear the execute timings
+ *
+ * Can be called from any thread while the processor is running.
+ */
+LTFAT_API int
+LTFAT_NAME(rtdgtreal_processor_resetstats)(LTFAT_NAME(rtdgtreal_processor_state)* p);
+
 /** Default processor callback
  *
  * The callback just copies data from input to the output.
@@ -66,6 +66,18 @@ LTFAT_NAME(slicing_processor_execute_gen_compact)(
     const LTFAT_REAL* in, ltfat_int inLen, ltfat_int chanNo, ltfat_int outLen,
     LTFAT_REAL* out);
 
+/* Interleaved buffers i.e. sample l of channel w is at in[w + l*chanNo] */
+LTFAT_API int
+LTFAT_NAME(slicing_processor_execute_interleaved)(
+    LTFAT_NAME(slicing_processor_state)* p,
+    const LTFAT_REAL* in, ltfat_int inLen, ltfat_int chanNo, LTFAT_REAL* out);
+
+LTFAT_API int
+LTFAT_NAME(slicing_processor_execute_gen_interleaved)(
+    LTFAT_NAME(slicing_processor_state)* p,
+    const LTFAT_REAL* in, ltfat_int inLen, ltfat_int chanNo, ltfat_int outLen,
+    LTFAT_REAL* out);
+
 /** \name Setup interface
  * @{ 
  * */
@@ -78,6 +90,27 @@ LTFAT_NAME(slicing_processor_settaperwin)(
 LTFAT_API int
 LTFAT_NAME(slicing_processor_settaper)(
     LTFAT_NAME(slicing_processor_state)* p, const LTFAT_REAL g[], int do_analysis);
+
+/* Process slices in batches of nthreads on threads owned by the processor
+ *
+ * The slices are collected and a complete batch is handed over to the
+ * processor threads, which work on it while the next batch is being filled.
+ * The execute functions therefore never wait for the processing unless the
+ * threads fall behind. The output is the same as with a single thread, only
+ * delayed by additional 2*nthreads slice hops (winLen - zpadLen - taperLen/2
+ * samples each). The total delay is reported by
+ * slicing_processor_getprocdelay().
+ *
+ * The callback set by slicing_processor_setcallback() is not required to be
+ * reentrant, the slices of a batch are passed to it one after another from
+ * a single processor thread. It can however run concurrently with the
+ * execute functions.
+ *
+ * Changing the number of threads resets the processor. nthreads = 0 means
+ * ltfat_get_num_threads(), nthreads = 1 turns the pipelining off. */
+LTFAT_API int
+LTFAT_NAME(slicing_processor_set_numthreads)(
+    LTFAT_NAME(slicing_processor_state)* p, int nthreads);
 /** @} */
 /** @} */
 
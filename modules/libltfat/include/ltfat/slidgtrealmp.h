@@ -61,8 +61,49 @@ LTFAT_NAME(slidgtrealmp_execute_compact)(
     const LTFAT_REAL in[], ltfat_int inLen, ltfat_int chanNo,
     LTFAT_REAL fout[]);
 
+LTFAT_API int
+LTFAT_NAME(slidgtrealmp_execute_interleaved)(
+    LTFAT_NAME(slidgtrealmp_state)* p,
+    const LTFAT_REAL in[], ltfat_int inLen, ltfat_int chanNo,
+    LTFAT_REAL fout[]);
+
 LTFAT_API ltfat_int
 LTFAT_NAME(slidgtrealmp_getprocdelay)( LTFAT_NAME(slidgtrealmp_state)* p);
+
+/** Decompose several slices at once
+ *
+ * Each thread gets its own dgtrealmp state sharing the dictionary
+ * (see dgtrealmp_init_fromdict()), so the decomposition
+ * of each slice is the same as with a single thread. The slices are processed
+ * in batches of \a nthreads on threads owned by the processor while the next
+ * batch is being collected, so the processing delay grows by 2*\a nthreads
+ * slice hops. Use slidgtrealmp_getprocdelay() to get the new delay.
+ * The callback set by slidgtrealmp_setcallback() and the iteration step
+ * callback of the dgtrealmp state get called from several threads at once.
+ *
+ * The processor is reset.
+ *
+ * \param[in]          p  Sliding MP state
+ * \param[in]   nthreads  Number of threads, 0 means ltfat_get_num_threads()
+ *
+ * #### Function versions #
+ * <tt>
+ * ltfat_slidgtrealmp_set_numthreads_d( ltfat_slidgtrealmp_state_d* p, int nthreads);
+ *
+ * ltfat_slidgtrealmp_set_numthreads_s( ltfat_slidgtrealmp_state_s* p, int nthreads);
+ * </tt>
+ *
+ * \returns
+ * Status code           |  Description
+ * ----------------------|----------------------
+ * LTFATERR_SUCCESS      |  No error occured
+ * LTFATERR_NULLPOINTER  |  \a p was NULL
+ * LTFATERR_NOTINRANGE   |  \a nthreads is negative or larger than LTFAT_MAXTHREADS
+ * LTFATERR_NOMEM        |  Heap memory allocation failed
+ */
+LTFAT_API int
+LTFAT_NAME(slidgtrealmp_set_numthreads)( LTFAT_NAME(slidgtrealmp_state)* p,
+        int nthreads);
 /** @} */
 /** @} */
 
@@ -124,6 +124,18 @@ LTFAT_KISS(fftri)(LTFAT_KISS(fftr_plan)* cfg, const kiss_fft_cpx *freqdata, kiss
  output timedata has nfft scalar points
 */
 
+void
+LTFAT_KISS(fftr_tmp)(const LTFAT_KISS(fftr_plan)* cfg, const kiss_fft_scalar *timedata,
+                     kiss_fft_cpx *freqdata, kiss_fft_cpx *tmpbuf);
+
+void
+LTFAT_KISS(fftri_tmp)(const LTFAT_KISS(fftr_plan)* cfg, const kiss_fft_cpx *freqdata,
+                      kiss_fft_scalar *timedata, kiss_fft_cpx *tmpbuf);
+/*
+ Same as kiss_fftr and kiss_fftri, but cfg is not modified. tmpbuf has
+ nfft/2 complex points, the scratch of cfg is used if it is NULL.
+*/
+
 /*
  * Returns the smallest integer k, such that k>=n and k has only "fast" factors (2,3,5)
  */
@@ -0,0 +1,50 @@
+#ifndef _ltfat_threads_typeconstant_h
+#define _ltfat_threads_typeconstant_h
+
+/** \defgroup threads Multithreading
+ *
+ * Library-wide number of threads used by the multithreaded parts of the
+ * library, i.e. the FFTs when the library is compiled with the FFTW
+ * threads.
+ * The default is 1 i.e. no multithreading.
+ * The number of threads can also be set for individual plans, see e.g.
+ * ltfat_dgt_setpar_numthreads().
+ *
+ * \addtogroup threads
+ * @{
+ */
+
+/** Set the number of threads
+ *
+ * The setting affects plans created afterwards.
+ *
+ * \param[in] nthreads  Number of threads. 0 selects the number of online processors.
+ *
+ * \returns
+ * Status code          |  Description
+ * ---------------------|----------------
+ * LTFATERR_SUCESS      |  No error occured
+ * LTFATERR_NOTINRANGE  |  \a nthreads was negative
+ */
+LTFAT_API int
+ltfat_set_num_threads(int nthreads);
+
+/** \returns Current number of threads
+ */
+LTFAT_API int
+ltfat_get_num_threads(void);
+
+/** Number of threads for a single FFT plan
+ *
+ * The value is to be OR-ed with the FFTW flags passed to fft_init,
+ * ifft_init, fftreal_init and ifftreal_init (and to any function passing
+ * the flags to them). At most 255 threads can be requested this way,
+ * 0 selects the library-wide setting.
+ */
+#define LTFAT_FFT_NTHREADS(n) ( ((unsigned)(n) & 0xFFU) << 24 )
+
+/** @} */
+
+#define LTFAT_FFT_GETNTHREADS(flags) ( (int)(((flags) >> 24) & 0xFFU) )
+
+#endif
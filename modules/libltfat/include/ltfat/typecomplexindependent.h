@@ -45,6 +45,10 @@ LTFAT_API int
 LTFAT_NAME(iwfac_init)(ltfat_int L, ltfat_int a, ltfat_int M,
                        unsigned flags, LTFAT_NAME(iwfac_plan)** plan);
 
+/* nthreads == 0 selects the number set by ltfat_set_num_threads() */
+LTFAT_API int
+LTFAT_NAME(iwfac_set_numthreads)(LTFAT_NAME(iwfac_plan)* plan, int nthreads);
+
 LTFAT_API int
 LTFAT_NAME(iwfac_execute)(LTFAT_NAME(iwfac_plan)* plan, const LTFAT_COMPLEX* gf,
                           ltfat_int R, LTFAT_TYPE* g);
@@ -4,6 +4,10 @@
 #include "memalloc.h"
 #include "dgt_common.h"
 #include "dgtwrapper_typeconstant.h"
+#include "threads_typeconstant.h"
+#include "fftdispatch_typeconstant.h"
+#include "wfaccache_typeconstant.h"
+#include "procstats_typeconstant.h"
 
 typedef struct
 {
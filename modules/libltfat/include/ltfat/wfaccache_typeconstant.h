@@ -0,0 +1,78 @@
+#ifndef _ltfat_wfaccache_typeconstant_h
+#define _ltfat_wfaccache_typeconstant_h
+
+/** \defgroup wfaccache Window factorization cache
+ *
+ * The plans of the factorization algorithm (ltfat_dgt_long_init(),
+ * ltfat_dgtreal_long_init(), ltfat_idgt_long_init() and
+ * ltfat_idgtreal_long_init()) obtain the factorization of the window from
+ * a library-wide cache. The entries are identified by the content of the
+ * window, L, a, M and the kind of the factorization (real or complex, single
+ * or double precision). Plans created with the same window share
+ * a single read-only buffer which is released when the last plan using it
+ * is destroyed.
+ *
+ * Released entries are kept in the cache so that a plan re-created with the same
+ * parameters does not recompute the factorization. The least recently used
+ * released entries are evicted whenever the memory held by the cache exceeds
+ * the limit set by ltfat_wfac_cache_set_limit(). Entries in use are never
+ * evicted.
+ *
+ * All functions are thread-safe.
+ *
+ * \addtogroup wfaccache
+ * @{
+ */
+
+typedef struct
+{
+    size_t bytes;      /**< Memory currently held by the cache */
+    size_t limit;      /**< Current limit, see ltfat_wfac_cache_set_limit() */
+    ltfat_int entries; /**< Number of entries */
+    ltfat_int inuse;   /**< Number of entries referenced by at least one plan */
+    size_t hits;       /**< Number of factorizations found in the cache */
+    size_t misses;     /**< Number of factorizations computed */
+    size_t evictions;  /**< Number of entries evicted */
+} ltfat_wfac_cache_stats;
+
+/** Set limit of the memory held by the cache
+ *
+ * Released entries are evicted until the memory held by the cache (the
+ * factorizations, copies of the windows and the bookkeeping) drops below the
+ * limit. 0 disables keeping the released entries, but plans existing
+ * at the same time still share the factorization.
+ * The default is 64 MiB.
+ *
+ * \param[in] bytes  Limit in bytes
+ *
+ * \returns
+ * Status code          |  Description
+ * ---------------------|----------------
+ * LTFATERR_SUCESS      |  No error occured
+ */
+LTFAT_API int
+ltfat_wfac_cache_set_limit(size_t bytes);
+
+/** Get statistics of the cache
+ *
+ * \param[out] stats  Statistics
+ *
+ * \returns
+ * Status code          |  Description
+ * ---------------------|----------------
+ * LTFATERR_SUCESS      |  No error occured
+ * LTFATERR_NULLPOINTER |  \a stats was NULL
+ */
+LTFAT_API int
+ltfat_wfac_cache_get_stats(ltfat_wfac_cache_stats* stats);
+
+/** Evict all entries not used by any plan
+ *
+ * \returns Number of evicted entries
+ */
+LTFAT_API int
+ltfat_wfac_cache_clear(void);
+
+/** @} */
+
+#endif
@@ -2,6 +2,8 @@
 #include "ltfat/types.h"
 #include "ltfat/macros.h"
 #include "circularbuf_private.h"
+#include "threads_private.h"
+#include "rtsafe_private.h"
 
 LTFAT_API int
 LTFAT_NAME(block_processor_init)( ltfat_int winLen, ltfat_int hop,
@@ -120,14 +122,16 @@ error:
     return status;
 }
 
-LTFAT_API int
-LTFAT_NAME(block_processor_execute)(
+/* Sample l of channel w is in[w][l*stride] and out[w][l*stride] */
+static int
+LTFAT_NAME(block_processor_execute_guts)(
     LTFAT_NAME(block_processor_state)* p,
     const LTFAT_REAL** in, ltfat_int inLen, ltfat_int chanNo,
-    ltfat_int outLen, LTFAT_REAL** out)
+    ltfat_int outLen, LTFAT_REAL** out, ltfat_int stride)
 {
     int status = LTFATERR_FAILED, callbackstatus = 0;
     ltfat_int samplesWritten = 0, samplesRead = 0;
+    ltfat_procstats_call scbuf, *sc = NULL;
 
     // Failing these checks prohibits execution altogether
     CHECKNULL(p); CHECKNULL(in); // CHECKNULL(out);
@@ -144,6 +148,12 @@ LTFAT_NAME(block_processor_execute)(
     // Just dont do anything
     if (chanNo == 0 || (inLen == 0 && outLen == 0)) return LTFATERR_SUCCESS;
 
+    if (p->stats)
+    {
+        sc = &scbuf;
+        ltfat_procstats_begin(sc);
+    }
+
     if ( chanNo > p->fwdfifo->numChans )
     {
         DEBUG("Channel overflow (passed %td, max %td)", chanNo, p->fwdfifo->numChans);
@@ -151,7 +161,7 @@ LTFAT_NAME(block_processor_execute)(
 
         if (out)
             for (ltfat_int w = p->fwdfifo->numChans; w < chanNo; w++)
-                memset(out[w], 0, outLen * sizeof * out[w]);
+                LTFAT_NAME(clear_strided)(out[w], outLen, stride);
 
         chanNo = p->fwdfifo->numChans;
     }
@@ -169,14 +179,17 @@ LTFAT_NAME(block_processor_execute)(
         status = LTFATERR_OVERFLOW;
 
         for (ltfat_int w = 0; w < chanNo; w++)
-            memset(out[w] + p->bufLenMax, 0, (outLen - p->bufLenMax)*sizeof * out[w]);
+            LTFAT_NAME(clear_strided)(out[w] + p->bufLenMax * stride,
+                                      outLen - p->bufLenMax, stride);
 
         outLen = p->bufLenMax;
     }
 
     // Write new data
     samplesWritten =
-        LTFAT_NAME(analysis_fifo_write)(p->fwdfifo, in, inLen, chanNo);
+        LTFAT_NAME(analysis_fifo_write_strided)(p->fwdfifo, in, inLen, stride,
+                chanNo);
+    if (sc) ltfat_procstats_lap(sc, ltfat_procstats_fifowrite);
 
     // While there is new data in the input fifo
     while ( LTFAT_NAME(analysis_fifo_read)(p->fwdfifo, p->prebuf) > 0 )
@@ -187,12 +200,14 @@ LTFAT_NAME(block_processor_execute)(
                 for (ltfat_int l = 0; l < p->fwdfifo->winLen; l++)
                     p->prebuf[l + w * p->fwdfifo->numChans] *= p->prewin[l];
         }
+        if (sc) ltfat_procstats_lap(sc, ltfat_procstats_forward);
 
         if (out)
         {
             callbackstatus =
                 p->processorCallback(p->userdata, p->prebuf, p->fwdfifo->winLen,
                                      p->fwdfifo->numChans, p->postbuf);
+            if (sc) ltfat_procstats_lap(sc, ltfat_procstats_callback);
 
             if (p->postwin)
             {
@@ -202,14 +217,18 @@ LTFAT_NAME(block_processor_execute)(
             }
 
             LTFAT_NAME(synthesis_fifo_write)(p->backfifo, p->postbuf);
+            if (sc) ltfat_procstats_lap(sc, ltfat_procstats_inverse);
         }
         else
         {
             callbackstatus =
                 p->processorCallback(p->userdata, p->prebuf, p->fwdfifo->winLen,
                                      p->fwdfifo->numChans, NULL);
+            if (sc) ltfat_procstats_lap(sc, ltfat_procstats_callback);
         }
 
+        if (sc) sc->frames++;
+
         if (callbackstatus < 0)
             CHECKSTATUS(LTFATERR_FAILED);
     }
@@ -218,12 +237,20 @@ LTFAT_NAME(block_processor_execute)(
     if (out)
     {
         samplesRead =
-            LTFAT_NAME(synthesis_fifo_read)(p->backfifo, outLen, chanNo, out);
+            LTFAT_NAME(synthesis_fifo_read_strided)(p->backfifo, outLen, chanNo,
+                    stride, out);
+        if (sc) ltfat_procstats_lap(sc, ltfat_procstats_fiforead);
     }
 
     LTFAT_NAME(block_processor_advanceby)( p, samplesWritten, samplesRead);
     LTFAT_NAME(analysis_fifo_sethop)(p->fwdfifo, p->prehop);
     LTFAT_NAME(synthesis_fifo_sethop)(p->backfifo, p->posthop);
+
+    if (sc)
+    {
+        ltfat_procstats_end(sc);
+        ltfat_procstats_commit(p->stats, sc, 1);
+    }
     status = LTFATERR_SUCCESS;
 error:
     if (status != LTFATERR_SUCCESS) return status;
@@ -234,6 +261,72 @@ error:
 
 }
 
+LTFAT_API int
+LTFAT_NAME(block_processor_execute)(
+    LTFAT_NAME(block_processor_state)* p,
+    const LTFAT_REAL** in, ltfat_int inLen, ltfat_int chanNo,
+    ltfat_int outLen, LTFAT_REAL** out)
+{
+    int status;
+
+    // Nothing called from here on is allowed to allocate
+    ltfat_rtsafe_enter();
+    status = LTFAT_NAME(block_processor_execute_guts)(p, in, inLen, chanNo, outLen,
+             out, 1);
+    ltfat_rtsafe_leave();
+    return status;
+}
+
+LTFAT_API int
+LTFAT_NAME(block_processor_execute_interleaved)(
+    LTFAT_NAME(block_processor_state)* p,
+    const LTFAT_REAL* in, ltfat_int inLen, ltfat_int chanNo, ltfat_int outLen,
+    LTFAT_REAL* out)
+{
+    ltfat_int chanLoc;
+    LTFAT_REAL** outTmpLoc = NULL;
+    int status2 = LTFATERR_SUCCESS;
+    int status = LTFATERR_SUCCESS;
+
+    CHECKNULL(p); CHECKNULL(in);
+    CHECK(LTFATERR_BADSIZE, chanNo >= 0,
+          "chanNo must be positive or zero (passed %td)", chanNo);
+    if (chanNo == 0) return LTFATERR_SUCCESS;
+
+    chanLoc = chanNo > p->fwdfifo->numChans ? p->fwdfifo->numChans : chanNo;
+
+    // The channels are read and written in place with stride chanNo
+    for (ltfat_int w = 0; w < chanLoc; w++)
+    {
+        p->inTmp[w] = in + w;
+        if (out)
+        {
+            outTmpLoc = p->outTmp;
+            p->outTmp[w] = out + w;
+        }
+    }
+
+    // Clear superfluous channels
+    if (chanNo > chanLoc)
+    {
+        DEBUG("Channel overflow (passed %td, max %td)", chanNo, chanLoc);
+        status = LTFATERR_OVERFLOW;
+
+        if (out)
+            for (ltfat_int w = chanLoc; w < chanNo; w++)
+                LTFAT_NAME(clear_strided)(out + w, outLen, chanNo);
+    }
+
+    ltfat_rtsafe_enter();
+    status2 = LTFAT_NAME(block_processor_execute_guts)( p, p->inTmp, inLen,
+              chanLoc, outLen, outTmpLoc, chanNo);
+    ltfat_rtsafe_leave();
+
+    if (status2 != LTFATERR_SUCCESS) return status2;
+error:
+    return status;
+}
+
 
 
 LTFAT_API int
@@ -301,6 +394,7 @@ LTFAT_NAME(block_processor_done)( LTFAT_NAME(block_processor_state)** p)
         LTFAT_SAFEFREEALL(pp->prebuf, pp->postbuf);
     }
     LTFAT_SAFEFREEALL(pp->prewin, pp->postwin, pp->inTmp, pp->outTmp);
+    ltfat_procstats_done(pp->stats);
 
     ltfat_free(pp); pp = NULL;
     return LTFATERR_SUCCESS;
@@ -416,6 +510,53 @@ LTFAT_NAME(block_processor_setpostbufchanstride)( LTFAT_NAME(
     return LTFAT_NAME(synthesis_fifo_setwritechanstride)( p->backfifo, stride);
 }
 
+LTFAT_API int
+LTFAT_NAME(block_processor_setstats)(
+    LTFAT_NAME(block_processor_state)* p, int enable)
+{
+    int status = LTFATERR_FAILED;
+    CHECKNULL(p);
+
+    if (enable && !p->stats)
+        CHECKSTATUS( ltfat_procstats_init(&p->stats) );
+    else if (!enable && p->stats)
+    {
+        ltfat_procstats_done(p->stats);
+        p->stats = NULL;
+    }
+
+    return LTFATERR_SUCCESS;
+error:
+    return status;
+}
+
+LTFAT_API int
+LTFAT_NAME(block_processor_getstats)(
+    const LTFAT_NAME(block_processor_state)* p, ltfat_procstats* stats)
+{
+    int status = LTFATERR_FAILED;
+    CHECKNULL(p); CHECKNULL(stats);
+    CHECK(LTFATERR_FAILED, p->stats, "The stats are not enabled.");
+
+    return ltfat_procstats_snapshot(p->stats, stats);
+error:
+    return status;
+}
+
+LTFAT_API int
+LTFAT_NAME(block_processor_resetstats)(
+    LTFAT_NAME(block_processor_state)* p)
+{
+    int status = LTFATERR_FAILED;
+    CHECKNULL(p);
+    CHECK(LTFATERR_FAILED, p->stats, "The stats are not enabled.");
+
+    ltfat_procstats_reset(p->stats);
+    return LTFATERR_SUCCESS;
+error:
+    return status;
+}
+
 LTFAT_API int
 LTFAT_NAME(block_processor_setcallback)(
     LTFAT_NAME(block_processor_state)* p,
@@ -524,14 +665,55 @@ error:
     return status;
 }
 
+void
+LTFAT_NAME(clear_strided)(LTFAT_REAL* buf, ltfat_int len, ltfat_int stride)
+{
+    if (stride == 1)
+        memset(buf, 0, len * sizeof * buf);
+    else
+        for (ltfat_int l = 0; l < len; l++)
+            buf[l * stride] = 0;
+}
+
+static void
+LTFAT_NAME(fifo_gather)(LTFAT_REAL* dst, const LTFAT_REAL* src,
+                        ltfat_int len, ltfat_int stride)
+{
+    if (stride == 1)
+        memcpy(dst, src, len * sizeof * dst);
+    else
+        for (ltfat_int l = 0; l < len; l++)
+            dst[l] = src[l * stride];
+}
+
+static void
+LTFAT_NAME(fifo_scatter)(LTFAT_REAL* dst, ltfat_int stride,
+                         const LTFAT_REAL* src, ltfat_int len)
+{
+    if (stride == 1)
+        memcpy(dst, src, len * sizeof * dst);
+    else
+        for (ltfat_int l = 0; l < len; l++)
+            dst[l * stride] = src[l];
+}
+
 LTFAT_API ltfat_int
 LTFAT_NAME(analysis_fifo_write)(LTFAT_NAME(analysis_fifo_state)* p,
                                 const LTFAT_REAL** buf, ltfat_int bufLen, ltfat_int W)
+{
+    return LTFAT_NAME(analysis_fifo_write_strided)(p, buf, bufLen, 1, W);
+}
+
+ltfat_int
+LTFAT_NAME(analysis_fifo_write_strided)(LTFAT_NAME(analysis_fifo_state)* p,
+                                        const LTFAT_REAL** buf, ltfat_int bufLen,
+                                        ltfat_int stride, ltfat_int W)
 {
     ltfat_int Wact, freeSpace, toWrite, valid, over, endWriteIdx;
     int status = LTFATERR_FAILED;
     CHECKNULL(p); CHECKNULL(buf);
     CHECK(LTFATERR_NOTPOSARG, bufLen >= 0, "bufLen must be positive.");
+    CHECK(LTFATERR_NOTPOSARG, stride > 0, "stride must be positive.");
     CHECK(LTFATERR_NOTPOSARG, W > 0, "W must be positive.");
 
     if ( bufLen == 0 ) return 0;
@@ -540,7 +722,7 @@ LTFAT_NAME(analysis_fifo_write)(LTFAT_NAME(analysis_fifo_state)* p,
         CHECKNULL(buf[w]);
 
 
-    freeSpace = p->readIdx - p->writeIdx - 1;
+    freeSpace = ltfat_atomic_load_acquire(&p->readIdx) - p->writeIdx - 1;
     if (freeSpace < 0) freeSpace += p->bufLen;
 
     // CHECK(LTFATERR_OVERFLOW, freeSpace, "FIFO owerflow");
@@ -565,23 +747,24 @@ LTFAT_NAME(analysis_fifo_write)(LTFAT_NAME(analysis_fifo_state)* p,
         {
             LTFAT_REAL* pbufchan = p->buf + w * p->bufLen + p->writeIdx;
             if (w < Wact)
-                memcpy(pbufchan, buf[w], valid * sizeof * p->buf );
+                LTFAT_NAME(fifo_gather)(pbufchan, buf[w], valid, stride);
             else
                 memset(pbufchan, 0, valid * sizeof * p->buf );
         }
     }
     if (over > 0)
     {
-        for (ltfat_int w = 0; w < Wact; w++)
+        for (ltfat_int w = 0; w < p->numChans; w++)
         {
             LTFAT_REAL* pbufchan = p->buf + w * p->bufLen;
             if (w < Wact)
-                memcpy(pbufchan, buf[w] + valid, over * sizeof * p->buf);
+                LTFAT_NAME(fifo_gather)(pbufchan, buf[w] + valid * stride, over,
+                                        stride);
             else
                 memset(pbufchan, 0,  over * sizeof * p->buf);
         }
     }
-    p->writeIdx = ( p->writeIdx + toWrite ) % p->bufLen;
+    ltfat_atomic_store_release(&p->writeIdx, ( p->writeIdx + toWrite ) % p->bufLen);
 
     return toWrite;
 error:
@@ -596,7 +779,7 @@ LTFAT_NAME(analysis_fifo_read)(LTFAT_NAME(analysis_fifo_state)* p,
     int status = LTFATERR_FAILED;
     CHECKNULL(p); CHECKNULL(buf);
 
-    available = p->writeIdx - p->readIdx;
+    available = ltfat_atomic_load_acquire(&p->writeIdx) - p->readIdx;
     if (available < 0) available += p->bufLen;
 
     // CHECK(LTFATERR_UNDERFLOW, available >= p->winLen, "FIFO underflow");
@@ -634,13 +817,32 @@ LTFAT_NAME(analysis_fifo_read)(LTFAT_NAME(analysis_fifo_state)* p,
     }
 
     // Only advance by hop
-    p->readIdx = ( p->readIdx + p->hop ) % p->bufLen;
+    ltfat_atomic_store_release(&p->readIdx, ( p->readIdx + p->hop ) % p->bufLen);
 
     return toRead;
 error:
     return status;
 }
 
+LTFAT_API ltfat_int
+LTFAT_NAME(analysis_fifo_readable)(const LTFAT_NAME(analysis_fifo_state)* p)
+{
+    ltfat_int available, minAvailable;
+    int status = LTFATERR_FAILED;
+    CHECKNULL(p);
+
+    available = ltfat_atomic_load_acquire(&p->writeIdx) - p->readIdx;
+    if (available < 0) available += p->bufLen;
+
+    // Mirrors the condition in analysis_fifo_read
+    minAvailable = p->winLen > p->hop ? p->winLen : p->hop;
+    if (available < minAvailable) return 0;
+
+    return 1 + (available - minAvailable) / p->hop;
+error:
+    return status;
+}
+
 /* BACK FIFO */
 
 
@@ -743,7 +945,7 @@ LTFAT_NAME(synthesis_fifo_write)(LTFAT_NAME(synthesis_fifo_state)* p,
     int status = LTFATERR_FAILED;
     CHECKNULL(p); CHECKNULL(buf);
 
-    freeSpace = p->readIdx - p->writeIdx - 1;
+    freeSpace = ltfat_atomic_load_acquire(&p->readIdx) - p->writeIdx - 1;
     if (freeSpace < 0) freeSpace += p->bufLen;
 
     // CHECK(LTFATERR_OVERFLOW, freeSpace >= p->winLen, "FIFO overflow");
@@ -782,29 +984,56 @@ LTFAT_NAME(synthesis_fifo_write)(LTFAT_NAME(synthesis_fifo_state)* p,
         }
     }
 
-    p->writeIdx = ( p->writeIdx + p->hop ) % p->bufLen;
+    ltfat_atomic_store_release(&p->writeIdx, ( p->writeIdx + p->hop ) % p->bufLen);
 
     return toWrite;
 error:
     return status;
 }
 
+LTFAT_API ltfat_int
+LTFAT_NAME(synthesis_fifo_writable)(const LTFAT_NAME(synthesis_fifo_state)* p)
+{
+    ltfat_int freeSpace;
+    int status = LTFATERR_FAILED;
+    CHECKNULL(p);
+
+    freeSpace = ltfat_atomic_load_acquire(&p->readIdx) - p->writeIdx - 1;
+    if (freeSpace < 0) freeSpace += p->bufLen;
+
+    // Mirrors the condition in synthesis_fifo_write
+    if (freeSpace < p->winLen) return 0;
+
+    return 1 + (freeSpace - p->winLen) / p->hop;
+error:
+    return status;
+}
+
 LTFAT_API ltfat_int
 LTFAT_NAME(synthesis_fifo_read)(LTFAT_NAME(synthesis_fifo_state)* p,
                                 ltfat_int bufLen, ltfat_int W,
                                 LTFAT_REAL** buf)
+{
+    return LTFAT_NAME(synthesis_fifo_read_strided)(p, bufLen, W, 1, buf);
+}
+
+ltfat_int
+LTFAT_NAME(synthesis_fifo_read_strided)(LTFAT_NAME(synthesis_fifo_state)* p,
+                                        ltfat_int bufLen, ltfat_int W,
+                                        ltfat_int stride, LTFAT_REAL** buf)
 {
     ltfat_int available, toRead, valid, over, endReadIdx;
     int status = LTFATERR_FAILED;
     CHECKNULL(p); CHECKNULL(buf);
     CHECK(LTFATERR_NOTPOSARG, W > 0, "W must be positive.");
+    CHECK(LTFATERR_NOTPOSARG, stride > 0, "stride must be positive.");
     CHECK(LTFATERR_NOTPOSARG, bufLen >= 0, "bufLen must be positive.");
     if (bufLen == 0) return 0;
 
     for (ltfat_int w = 0; w < W; w++) CHECKNULL(buf[w]);
 
 
-    available = p->writeIdx - p->readIdx;
+    available = ltfat_atomic_load_acquire(&p->writeIdx) - p->readIdx;
     if (available < 0) available += p->bufLen;
 
     // CHECK(LTFATERR_UNDERFLOW, available, "FIFO underflow");
@@ -829,7 +1058,7 @@ LTFAT_NAME(synthesis_fifo_read)(LTFAT_NAME(synthesis_fifo_state)* p,
         for (ltfat_int w = 0; w < W; w++)
         {
             LTFAT_REAL* pbufchan = p->buf + p->readIdx + w * p->bufLen;
-            memcpy(buf[w], pbufchan, valid * sizeof * p->buf);
+            LTFAT_NAME(fifo_scatter)(buf[w], stride, pbufchan, valid);
             memset(pbufchan, 0, valid * sizeof * p->buf);
         }
     }
@@ -838,14 +1067,39 @@ LTFAT_NAME(synthesis_fifo_read)(LTFAT_NAME(synthesis_fifo_state)* p,
         for (ltfat_int w = 0; w < W; w++)
         {
             LTFAT_REAL* pbufchan = p->buf + w * p->bufLen;
-            memcpy(buf[w] + valid, pbufchan, over * sizeof * p->buf);
+            LTFAT_NAME(fifo_scatter)(buf[w] + valid * stride, stride, pbufchan, over);
             memset(pbufchan, 0, over * sizeof * p->buf);
         }
     }
 
-    p->readIdx = ( p->readIdx + toRead ) % p->bufLen;
+    ltfat_atomic_store_release(&p->readIdx, ( p->readIdx + toRead ) % p->bufLen);
 
     return toRead;
 error:
     return status;
 }
+
+ltfat_int
+LTFAT_NAME(synthesis_fifo_skip)(LTFAT_NAME(synthesis_fifo_state)* p,
+                                ltfat_int len)
+{
+    ltfat_int available, toSkip, valid, over;
+
+    available = ltfat_atomic_load_acquire(&p->writeIdx) - p->readIdx;
+    if (available < 0) available += p->bufLen;
+
+    toSkip = available < len ? available : len;
+    valid = p->readIdx + toSkip > p->bufLen ? p->bufLen - p->readIdx : toSkip;
+    over = toSkip - valid;
+
+    // Same as in read, the samples must be zero when written again
+    for (ltfat_int w = 0; w < p->numChans; w++)
+    {
+        memset(p->buf + p->readIdx + w * p->bufLen, 0, valid * sizeof * p->buf);
+        memset(p->buf + w * p->bufLen, 0, over * sizeof * p->buf);
+    }
+
+    ltfat_atomic_store_release(&p->readIdx, ( p->readIdx + toSkip ) % p->bufLen);
+
+    return toSkip;
+}
@@ -1,5 +1,6 @@
 #ifndef _circularbuf_private_h
 #define _circularbuf_private_h
+#include "procstats_private.h"
 
 struct LTFAT_NAME(analysis_fifo_state)
 {
@@ -46,6 +47,30 @@ struct LTFAT_NAME(block_processor_state)
     double out_in_in_offset;
     ltfat_int prehop;
     ltfat_int posthop;
+    ltfat_procstats_state* stats; //!< NULL unless recording is enabled
 };
 
+/* Same as analysis_fifo_write and synthesis_fifo_read, but sample l of
+ * channel w is at buf[w][l*stride]. Interleaved audio is passed as
+ * buf[w] = base + w and stride equal to the number of channels. */
+ltfat_int
+LTFAT_NAME(analysis_fifo_write_strided)(LTFAT_NAME(analysis_fifo_state)* p,
+                                        const LTFAT_REAL** buf, ltfat_int bufLen,
+                                        ltfat_int stride, ltfat_int W);
+
+ltfat_int
+LTFAT_NAME(synthesis_fifo_read_strided)(LTFAT_NAME(synthesis_fifo_state)* p,
+                                        ltfat_int bufLen, ltfat_int W,
+                                        ltfat_int stride, LTFAT_REAL** buf);
+
+/* Drops at most len of the readable samples as if they were read.
+ * Returns the number of samples dropped. */
+ltfat_int
+LTFAT_NAME(synthesis_fifo_skip)(LTFAT_NAME(synthesis_fifo_state)* p,
+                                ltfat_int len);
+
+/* Sets buf[l*stride] to zero for l = 0,...,len-1 */
+void
+LTFAT_NAME(clear_strided)(LTFAT_REAL* buf, ltfat_int len, ltfat_int stride);
+
 #endif
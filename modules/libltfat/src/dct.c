@@ -3,6 +3,7 @@
 #include "ltfat/macros.h"
 
 #include "ltfat/thirdparty/fftw3.h"
+#include "fftw_private.h"
 
 /* typedef LTFAT_NAME(dct_plan) LTFAT_FFTW(plan); */
 
@@ -52,10 +53,9 @@ LTFAT_NAME(dct_init)( ltfat_int L, ltfat_int W, LTFAT_TYPE* cout,
         case DCTIV:  kindFftw = FFTW_REDFT11; break;
     };
 
-    p = LTFAT_FFTW(plan_guru64_r2r)(1, &dims,
-                                    1, &howmanydims,
-                                    (LTFAT_REAL*)cout, (LTFAT_REAL*)cout,
-                                    &kindFftw, flag);
+    p = LTFAT_NAME_REAL(fftw_plan_r2r)(&dims, &howmanydims,
+                                       (LTFAT_REAL*)cout, (LTFAT_REAL*)cout,
+                                       kindFftw, flag);
 
     return (LTFAT_NAME(dct_plan)*) p;
 }
@@ -76,7 +76,7 @@ LTFAT_NAME(dct)(const LTFAT_TYPE* f, ltfat_int L, ltfat_int W,
 LTFAT_API void
 LTFAT_NAME(dct_done)( LTFAT_NAME(dct_plan)* p)
 {
-    LTFAT_FFTW(destroy_plan)((LTFAT_FFTW(plan))p);
+    LTFAT_NAME_REAL(fftw_destroy_plan)((LTFAT_FFTW(plan)) p);
 }
 
 // f and cout can be equal, provided plan was already created
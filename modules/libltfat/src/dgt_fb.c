@@ -1,18 +1,32 @@
 #include "ltfat.h"
 #include "ltfat/types.h"
 #include "ltfat/macros.h"
+#include "dgt_fb_private.h"
+#include "threads_private.h"
+#include "workspace_private.h"
 
 #include "ltfat/thirdparty/fftw3.h"
 
+/* Buffers and FFT plan used by a single thread. fftwork is the FFT
+ * scratch, NULL for the one owned by the FFT plan. */
+typedef struct
+{
+    LTFAT_NAME_REAL(fft_plan)* p_small;
+    LTFAT_COMPLEX* sbuf;
+    LTFAT_COMPLEX* fw;
+    void* fftwork;
+} LTFAT_NAME(dgt_fb_scratch);
+
 struct LTFAT_NAME(dgt_fb_plan)
 {
     ltfat_int a;
     ltfat_int M;
     ltfat_int gl;
     ltfat_phaseconvention ptype;
-    LTFAT_NAME_REAL(fft_plan)* p_small;
-    LTFAT_COMPLEX* sbuf;
-    LTFAT_COMPLEX* fw;
+    unsigned flags;
+    ltfat_int blocksize;
+    int nthreads;
+    LTFAT_NAME(dgt_fb_scratch)* scratch;
     LTFAT_TYPE* gw;
 };
 
@@ -38,6 +52,56 @@ error:
     return status;
 }
 
+static void
+LTFAT_NAME(dgt_fb_scratch_free)(LTFAT_NAME(dgt_fb_scratch)* scratch,
+                                int nthreads)
+{
+    for (int t = 0; t < nthreads; t++)
+    {
+        if (scratch[t].p_small) LTFAT_NAME_REAL(fft_done)(&scratch[t].p_small);
+        LTFAT_SAFEFREEALL(scratch[t].sbuf, scratch[t].fw);
+    }
+    ltfat_free(scratch);
+}
+
+/* Replaces the per-thread scratch such that it is prepared for
+ * blocks of K frames and nthreads threads. */
+static int
+LTFAT_NAME(dgt_fb_scratch_realloc)(LTFAT_NAME(dgt_fb_plan)* p,
+                                   ltfat_int K, int nthreads)
+{
+    LTFAT_NAME(dgt_fb_scratch)* scratch = NULL;
+    unsigned flags = p->flags;
+    int status = LTFATERR_SUCCESS;
+
+    if (K == p->blocksize && nthreads == p->nthreads)
+        return status;
+
+    /* Frames are already processed in parallel */
+    if (nthreads > 1)
+        flags &= ~LTFAT_FFT_NTHREADS(0xFF);
+
+    CHECKMEM( scratch = LTFAT_NEWARRAY(LTFAT_NAME(dgt_fb_scratch), nthreads));
+
+    for (int t = 0; t < nthreads; t++)
+    {
+        CHECKMEM( scratch[t].fw   = LTFAT_NAME_COMPLEX(calloc)(p->gl));
+        CHECKMEM( scratch[t].sbuf = LTFAT_NAME_COMPLEX(malloc)(p->M * K));
+        CHECKSTATUS(
+            LTFAT_NAME_REAL(fft_init)(p->M, K, scratch[t].sbuf, scratch[t].sbuf,
+                                      flags, &scratch[t].p_small));
+    }
+
+    if (p->scratch) LTFAT_NAME(dgt_fb_scratch_free)(p->scratch, p->nthreads);
+    p->scratch = scratch;
+    p->blocksize = K;
+    p->nthreads = nthreads;
+    return status;
+error:
+    if (scratch) LTFAT_NAME(dgt_fb_scratch_free)(scratch, nthreads);
+    return status;
+}
+
 LTFAT_API int
 LTFAT_NAME(dgt_fb_init)(const LTFAT_TYPE* g,
                         ltfat_int gl, ltfat_int a, ltfat_int M,
@@ -60,13 +124,11 @@ LTFAT_NAME(dgt_fb_init)(const LTFAT_TYPE* g,
     plan->M = M;
     plan->gl = gl;
     plan->ptype = ptype;
+    plan->flags = flags;
 
     CHECKMEM(plan->gw  = LTFAT_NAME(malloc)(plan->gl));
-    CHECKMEM(plan->fw  = LTFAT_NAME_COMPLEX(calloc)(plan->gl));
-    CHECKMEM(plan->sbuf = LTFAT_NAME_COMPLEX(malloc)(M));
 
-    CHECKSTATUS(
-        LTFAT_NAME_REAL(fft_init)(M, 1, plan->sbuf, plan->sbuf, flags, &plan->p_small));
+    CHECKSTATUS( LTFAT_NAME(dgt_fb_scratch_realloc)(plan, 1, 1));
     LTFAT_NAME(fftshift)(g, gl, plan->gw);
     LTFAT_NAME(conjugate_array)(plan->gw, gl, plan->gw);
 
@@ -78,6 +140,35 @@ error:
     return status;
 }
 
+LTFAT_API int
+LTFAT_NAME(dgt_fb_set_blocksize)(LTFAT_NAME(dgt_fb_plan)* p,
+                                 ltfat_int blocksize)
+{
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(p);
+    CHECK(LTFATERR_BADARG, blocksize >= 0,
+          "blocksize (passed %td) must be nonnegative.", blocksize);
+
+    return LTFAT_NAME(dgt_fb_scratch_realloc)(
+               p, ltfat_dgt_fb_blocksize(p->M, blocksize), p->nthreads);
+error:
+    return status;
+}
+
+LTFAT_API int
+LTFAT_NAME(dgt_fb_set_numthreads)(LTFAT_NAME(dgt_fb_plan)* p, int nthreads)
+{
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(p);
+    CHECK(LTFATERR_NOTINRANGE, nthreads >= 0 && nthreads <= LTFAT_MAXTHREADS,
+          "nthreads (passed %d) must be in range 0-%d.", nthreads, LTFAT_MAXTHREADS);
+
+    return LTFAT_NAME(dgt_fb_scratch_realloc)(
+               p, p->blocksize, nthreads ? nthreads : ltfat_get_num_threads());
+error:
+    return status;
+}
+
 LTFAT_API int
 LTFAT_NAME(dgt_fb_done)(LTFAT_NAME(dgt_fb_plan)** plan)
 {
@@ -86,29 +177,85 @@ LTFAT_NAME(dgt_fb_done)(LTFAT_NAME(dgt_fb_plan)** plan)
     CHECKNULL(plan); CHECKNULL(*plan);
     pp = *plan;
 
-    LTFAT_SAFEFREEALL(pp->sbuf, pp->gw, pp->fw);
-    if (pp->p_small) LTFAT_NAME_REAL(fft_done)(&pp->p_small);
+    if (pp->scratch) LTFAT_NAME(dgt_fb_scratch_free)(pp->scratch, pp->nthreads);
+    ltfat_safefree(pp->gw);
     ltfat_free(pp);
     pp = NULL;
 error:
     return status;
 }
 
-/* The following macro adds the coefficients together performing the
- * last part of the Poisson summation, executes the FFT on the summed
- * coefficients, and places the coefficients in the output array.
+/* Multiplies frame n of a single channel with the window.
+ * The frame wraps around the end of the signal close to the boundaries.
+ */
+static void
+LTFAT_NAME(dgt_fb_windowframe)(const LTFAT_NAME(dgt_fb_plan)* p,
+                               const LTFAT_TYPE* fchan, ltfat_int L,
+                               ltfat_int n, LTFAT_COMPLEX* fw)
+{
+    ltfat_int gl = p->gl;
+    ltfat_int sp = ltfat_positiverem(n * p->a - gl / 2, L);
+    ltfat_int glfirst = ltfat_imin(gl, L - sp);
+
+    for (ltfat_int l = 0; l < glfirst; l++)
+        fw[l] = fchan[sp + l] * p->gw[l];
+
+    for (ltfat_int l = glfirst; l < gl; l++)
+        fw[l] = fchan[l - glfirst] * p->gw[l];
+}
+
+typedef struct
+{
+    const LTFAT_NAME(dgt_fb_plan)* p;
+    const LTFAT_TYPE* f;
+    ltfat_int L;
+    ltfat_int N;
+    ltfat_int nblocks;
+    LTFAT_COMPLEX* cout;
+} LTFAT_NAME(dgt_fb_job);
+
+/* The windowed frames are folded (the last part of the Poisson summation)
+ * into consecutive columns of sbuf and p->blocksize frames are transformed
+ * by a single FFT call. Consecutive frames of a channel are adjacent
+ * in the output array, so the whole block is copied at once.
  *
- * The first summation is done in that peculiar way to obtain the
+ * The folding is done in that peculiar way to obtain the
  * correct phase for a frequency invariant Gabor transform. Summing
  * them directly would lead to a time invariant (phase-locked) Gabor
  * transform.
  *
- * The macro is called in three different places in the dgt_fb function.
+ * Items start,...,end-1 index the blocks of all channels.
  */
-#define THE_SUM { \
-LTFAT_NAME_COMPLEX(fold_array)(fw,gl,plan.ptype==LTFAT_TIMEINV?-glh:n*a-glh,M,sbuf); \
-LTFAT_NAME_REAL(fft_execute)(plan.p_small); \
-memcpy(cout + (n*M + w*M*N),sbuf,M*sizeof*cout); \
+static void
+LTFAT_NAME(dgt_fb_execute_blocks)(void* userdata, ltfat_int start,
+                                  ltfat_int end, int threadid)
+{
+    LTFAT_NAME(dgt_fb_job)* job = (LTFAT_NAME(dgt_fb_job)*) userdata;
+    const LTFAT_NAME(dgt_fb_plan)* p = job->p;
+    LTFAT_NAME(dgt_fb_scratch)* s = &p->scratch[threadid];
+    ltfat_int L = job->L, N = job->N, a = p->a, M = p->M, K = p->blocksize;
+    ltfat_int gl = p->gl, glh = p->gl / 2;
+
+    for (ltfat_int b = start; b < end; b++)
+    {
+        ltfat_int w = b / job->nblocks;
+        ltfat_int nstart = (b % job->nblocks) * K;
+        ltfat_int nK = ltfat_imin(K, N - nstart);
+        const LTFAT_TYPE* fchan = job->f + w * L;
+
+        for (ltfat_int k = 0; k < nK; k++)
+        {
+            ltfat_int n = nstart + k;
+            LTFAT_NAME(dgt_fb_windowframe)(p, fchan, L, n, s->fw);
+            LTFAT_NAME_COMPLEX(fold_array)(
+                s->fw, gl, p->ptype == LTFAT_TIMEINV ? -glh : n * a - glh,
+                M, s->sbuf + k * M);
+        }
+
+        LTFAT_NAME_REAL(fft_execute_ws)(s->p_small, s->sbuf, s->sbuf, s->fftwork);
+        memcpy(job->cout + w * M * N + nstart * M, s->sbuf,
+               nK * M * sizeof * job->cout);
+    }
 }
 
 LTFAT_API int
@@ -116,88 +263,68 @@ LTFAT_NAME(dgt_fb_execute)(const LTFAT_NAME(dgt_fb_plan)* p,
                            const LTFAT_TYPE* f,
                            ltfat_int L, ltfat_int W,  LTFAT_COMPLEX* cout)
 {
-    ltfat_int a, M, N, gl, glh, glh_d_a;
-    LTFAT_COMPLEX* sbuf, *fw;
-    LTFAT_TYPE* fbd;
-    LTFAT_NAME(dgt_fb_plan) plan;
+    LTFAT_NAME(dgt_fb_job) job;
     int status = LTFATERR_SUCCESS;
     CHECKNULL(p); CHECKNULL(f); CHECKNULL(cout);
     CHECK(LTFATERR_BADTRALEN, L >= p->gl && !(L % p->a) ,
           "L (passed %td) must be positive and divisible by a (passed %td).", L, p->a);
     CHECK(LTFATERR_NOTPOSARG, W > 0, "W must be positive");
 
-    /*  --------- initial declarations -------------- */
-    plan = *p;
-
-    a = plan.a;
-    M = plan.M;
-    N = L / a;
-
-    gl = plan.gl;
-    sbuf = plan.sbuf;
-    fw = plan.fw;
-
-    /* This is a floor operation. */
-    glh = plan.gl / 2;
-
+    job.p = p; job.f = f; job.L = L; job.cout = cout;
+    job.N = L / p->a;
     /* This is a ceil operation. */
-    glh_d_a = (ltfat_int)ceil((glh * 1.0) / (a));
-
-
-    /*  ---------- main body ----------- */
-
-    /*----- Handle the first boundary using periodic boundary conditions.*/
-    for (ltfat_int n = 0; n < glh_d_a; n++)
-    {
-        for (ltfat_int w = 0; w < W; w++)
-        {
-
-            fbd = (LTFAT_TYPE*)f + (L - (glh - n * a) + L * w);
-            for (ltfat_int l = 0; l < glh - n * a; l++)
-                fw[l] = fbd[l] * plan.gw[l];
-
-            fbd = (LTFAT_TYPE*)f -  (glh - n * a) +  L * w;
-            for (ltfat_int l = glh - n * a; l < gl; l++)
-                fw[l] = fbd[l] * plan.gw[l];
+    job.nblocks = (job.N + p->blocksize - 1) / p->blocksize;
 
-            THE_SUM
-
-        }
-    }
-
-    /* ----- Handle the middle case. --------------------- */
-    for (ltfat_int n = glh_d_a; n < (L - (gl + 1) / 2) / a + 1; n++)
-    {
-        for (ltfat_int w = 0; w < W; w++)
-        {
-            fbd = (LTFAT_TYPE*)f + (n * a - glh + L * w);
-            for (ltfat_int l = 0; l < gl; l++)
-                fw[l] = fbd[l] * plan.gw[l];
+    ltfat_parallel_for(p->nthreads, W * job.nblocks,
+                       LTFAT_NAME(dgt_fb_execute_blocks), &job);
+error:
+    return status;
+}
 
-            THE_SUM
-        }
+/* Takes the buffers of a single-threaded scratch from the workspace at
+ * base, or only counts their size if base is NULL */
+static size_t
+LTFAT_NAME(dgt_fb_ws_carve)(const LTFAT_NAME(dgt_fb_plan)* p, char* base,
+                            LTFAT_NAME(dgt_fb_scratch)* sc)
+{
+    size_t off = 0;
+
+    *sc = p->scratch[0];
+    sc->sbuf = (LTFAT_COMPLEX*) ltfat_ws_take(base, &off,
+                                              p->M * p->blocksize * sizeof(LTFAT_COMPLEX));
+    sc->fw = (LTFAT_COMPLEX*) ltfat_ws_take(base, &off, p->gl * sizeof(LTFAT_COMPLEX));
+    sc->fftwork = ltfat_ws_take(base, &off,
+                                LTFAT_NAME_REAL(fft_get_workspace_size)(sc->p_small));
+    return off;
+}
 
-    }
+LTFAT_API size_t
+LTFAT_NAME(dgt_fb_get_workspace_size)(const LTFAT_NAME(dgt_fb_plan)* p)
+{
+    LTFAT_NAME(dgt_fb_scratch) sc;
+    if (!p) return 0;
+    return ltfat_ws_size(LTFAT_NAME(dgt_fb_ws_carve)(p, NULL, &sc));
+}
 
-    /* Handle the last boundary using periodic boundary conditions. */
-    for (ltfat_int n = (L - (gl + 1) / 2) / a + 1; n < N; n++)
-    {
-        for (ltfat_int w = 0; w < W; w++)
-        {
-            fbd = (LTFAT_TYPE*)f + (n * a - glh + L * w);
-            for (ltfat_int l = 0; l < L - n * a + glh; l++)
-                fw[l] = fbd[l] * plan.gw[l];
+LTFAT_API int
+LTFAT_NAME(dgt_fb_execute_ws)(const LTFAT_NAME(dgt_fb_plan)* p,
+                              const LTFAT_TYPE* f,
+                              ltfat_int L, ltfat_int W, LTFAT_COMPLEX* cout,
+                              void* ws)
+{
+    LTFAT_NAME(dgt_fb_plan) p2;
+    LTFAT_NAME(dgt_fb_scratch) sc;
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(p); CHECKNULL(ws);
 
-            fbd = (LTFAT_TYPE*)f - (L - n * a + glh) +  L * w;
-            for (ltfat_int l = L - n * a + glh; l < gl; l++)
-                fw[l] = fbd[l] * plan.gw[l];
+    LTFAT_NAME(dgt_fb_ws_carve)(p, ltfat_ws_begin(ws), &sc);
 
-            THE_SUM
-        }
-    }
+    // Shallow copy running single-threaded on the workspace
+    p2 = *p;
+    p2.nthreads = 1;
+    p2.scratch = &sc;
 
+    return LTFAT_NAME(dgt_fb_execute)(&p2, f, L, W, cout);
 error:
     return status;
 }
-
-#undef THE_SUM
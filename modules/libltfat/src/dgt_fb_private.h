@@ -0,0 +1,46 @@
+#ifndef _ltfat_dgt_fb_private_h
+#define _ltfat_dgt_fb_private_h
+
+/* Number of frames transformed together by the fb plans.
+ *
+ * blocksize == 0 picks a block such that the M x blocksize FFT buffer
+ * holds about LTFAT_DGT_FB_AUTOBLOCKELEMS complex numbers.
+ */
+#define LTFAT_DGT_FB_AUTOBLOCKELEMS 4096
+#define LTFAT_DGT_FB_MAXBLOCKSIZE 64
+
+static inline ltfat_int
+ltfat_dgt_fb_blocksize(ltfat_int M, ltfat_int blocksize)
+{
+    if (blocksize > 0)
+        return blocksize;
+
+    blocksize = LTFAT_DGT_FB_AUTOBLOCKELEMS / M;
+    if (blocksize < 1) blocksize = 1;
+    if (blocksize > LTFAT_DGT_FB_MAXBLOCKSIZE)
+        blocksize = LTFAT_DGT_FB_MAXBLOCKSIZE;
+    return blocksize;
+}
+
+/* Number of frame tiles per channel for the parallel overlap-add.
+ *
+ * The tiles are processed in two passes, the even ones first and the odd
+ * ones second. Each tile is at least ceil(gl/a) + 1 frames long such that
+ * the supports of two tiles from the same pass never overlap, even
+ * circularly since the number of tiles is even.
+ * Returns 1 if the signal is too short to be split.
+ */
+static inline ltfat_int
+ltfat_dgt_fb_ntiles(ltfat_int N, ltfat_int a, ltfat_int gl, int nthreads)
+{
+    ltfat_int mintile = (gl + a - 1) / a + 1;
+    ltfat_int ntiles = 2 * (ltfat_int) nthreads;
+
+    if (ntiles > N / mintile)
+        ntiles = N / mintile;
+
+    ntiles -= ntiles % 2;
+    return nthreads > 1 && ntiles >= 2 ? ntiles : 1;
+}
+
+#endif
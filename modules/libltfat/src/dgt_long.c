@@ -1,4 +1,17 @@
 #include "dgt_long_private.h"
+#include "threads_private.h"
+#include "walnut_private.h"
+#include "wfaccache_private.h"
+#include "workspace_private.h"
+
+/* Job shared by the threads of a single dgt_walnut_execute call */
+typedef struct
+{
+    LTFAT_NAME(dgt_long_plan)* p;
+    const LTFAT_TYPE* f;
+    LTFAT_COMPLEX* cout;
+    ltfat_int r;
+} LTFAT_NAME(dgt_walnut_job);
 
 LTFAT_API int
 LTFAT_NAME(dgt_long)(const LTFAT_TYPE* f, const LTFAT_TYPE* g,
@@ -21,6 +34,78 @@ error:
     return status;
 }
 
+static void
+LTFAT_NAME(dgt_long_scratch_free)(LTFAT_NAME_REAL(dgt_long_scratch)* scratch,
+                                  int nthreads)
+{
+    for (int t = 0; t < nthreads; t++)
+    {
+        if (scratch[t].p_before) LTFAT_NAME_REAL(fft_done)(&scratch[t].p_before);
+        if (scratch[t].p_after) LTFAT_NAME_REAL(ifft_done)(&scratch[t].p_after);
+        LTFAT_SAFEFREEALL(scratch[t].sbuf, scratch[t].gt, scratch[t].ff,
+                          scratch[t].cf);
+    }
+    ltfat_free(scratch);
+}
+
+/* Replaces the per-thread scratch such that it is prepared for nthreads
+ * threads. */
+static int
+LTFAT_NAME(dgt_long_scratch_realloc)(LTFAT_NAME(dgt_long_plan)* plan,
+                                     int nthreads)
+{
+    LTFAT_NAME_REAL(dgt_long_scratch)* scratch = NULL;
+    ltfat_int p = plan->a / plan->c;
+    ltfat_int q = plan->M / plan->c;
+    ltfat_int d = plan->L / plan->M / p;
+    unsigned flags = plan->flags;
+    int nbufs;
+    int status = LTFATERR_SUCCESS;
+
+    if (nthreads == plan->nthreads)
+        return status;
+
+    nbufs = ltfat_walnut_parallel_cosets(plan->c, nthreads) ? nthreads : 1;
+
+    /* The short FFTs are already done in parallel */
+    if (nthreads > 1)
+        flags &= ~LTFAT_FFT_NTHREADS(0xFF);
+
+    CHECKMEM( scratch = LTFAT_NEWARRAY(LTFAT_NAME_REAL(dgt_long_scratch),
+                                       nthreads));
+
+    for (int t = 0; t < nthreads; t++)
+    {
+        CHECKMEM( scratch[t].sbuf = LTFAT_NAME_REAL(malloc)(2 * d));
+        CHECKMEM( scratch[t].gt   = LTFAT_NAME_REAL(malloc)(2 * p * q));
+
+        if (t < nbufs)
+        {
+            CHECKMEM( scratch[t].ff = LTFAT_NAME_REAL(malloc)(2 * d * p * q * plan->W));
+            CHECKMEM( scratch[t].cf = LTFAT_NAME_REAL(malloc)(2 * d * q * q * plan->W));
+        }
+
+        CHECKSTATUS(
+            LTFAT_NAME_REAL(fft_init)(d, 1, (LTFAT_COMPLEX*) scratch[t].sbuf,
+                                      (LTFAT_COMPLEX*) scratch[t].sbuf, flags,
+                                      &scratch[t].p_before));
+
+        CHECKSTATUS(
+            LTFAT_NAME_REAL(ifft_init)(d, 1, (LTFAT_COMPLEX*) scratch[t].sbuf,
+                                       (LTFAT_COMPLEX*) scratch[t].sbuf, flags,
+                                       &scratch[t].p_after));
+    }
+
+    if (plan->scratch)
+        LTFAT_NAME(dgt_long_scratch_free)(plan->scratch, plan->nthreads);
+    plan->scratch = scratch;
+    plan->nthreads = nthreads;
+    return status;
+error:
+    if (scratch) LTFAT_NAME(dgt_long_scratch_free)(scratch, nthreads);
+    return status;
+}
+
 LTFAT_API int
 LTFAT_NAME(dgt_long_init)( const LTFAT_TYPE* g,
                            ltfat_int L, ltfat_int W,
@@ -30,7 +115,7 @@ LTFAT_NAME(dgt_long_init)( const LTFAT_TYPE* g,
                            LTFAT_NAME(dgt_long_plan)** pout)
 {
     LTFAT_NAME(dgt_long_plan)* plan = NULL;
-    ltfat_int h_m, N, b, p, q, d, minL;
+    ltfat_int h_m, N, minL;
 
     int status = LTFATERR_SUCCESS;
     // CHECKNULL(f); // Can be NULL
@@ -57,36 +142,23 @@ LTFAT_NAME(dgt_long_init)( const LTFAT_TYPE* g,
     plan->L = L;
     plan->W = W;
     plan->ptype = ptype;
+    plan->flags = flags;
     N = L / a;
-    b = L / M;
 
     plan->c = ltfat_gcd(a, M, &plan->h_a, &h_m);
-    p = a / plan->c;
-    q = M / plan->c;
-    d = b / p;
     plan->h_a = -plan->h_a;
 
-    CHECKMEM( plan->sbuf = LTFAT_NAME_REAL(malloc)(2 * d));
-    CHECKMEM( plan->gf   = LTFAT_NAME_COMPLEX(malloc)(L));
-    CHECKMEM( plan->ff = LTFAT_NAME_REAL(malloc)(2 * d * p * q * W));
-    CHECKMEM( plan->cf = LTFAT_NAME_REAL(malloc)(2 * d * q * q * W));
     plan->cout = cout;
     plan->f    = f;
 
-    /* Get factorization of window */
+    /* Get factorization of window, possibly shared with other plans */
     CHECKSTATUS(
-        LTFAT_NAME(wfac)(g, L, 1, a, M, plan->gf));
+        LTFAT_NAME(wfac_shared)(g, L, a, M, &plan->gf));
 
     CHECKSTATUS(
         LTFAT_NAME_REAL(fft_init)(M, N * W, cout, cout, flags, &plan->p_veryend));
 
-    CHECKSTATUS(
-        LTFAT_NAME_REAL(fft_init)(d, 1, (LTFAT_COMPLEX*) plan->sbuf,
-                                  (LTFAT_COMPLEX*) plan->sbuf, flags, &plan->p_before));
-
-    CHECKSTATUS(
-        LTFAT_NAME_REAL(ifft_init)(d, 1, (LTFAT_COMPLEX*) plan->sbuf,
-                                   (LTFAT_COMPLEX*) plan->sbuf, flags, &plan->p_after));
+    CHECKSTATUS( LTFAT_NAME(dgt_long_scratch_realloc)(plan, 1));
 
     // Assign the "return" value
     *pout = plan;
@@ -96,6 +168,21 @@ error:
     return status;
 }
 
+LTFAT_API int
+LTFAT_NAME(dgt_long_set_numthreads)(LTFAT_NAME(dgt_long_plan)* plan,
+                                    int nthreads)
+{
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(plan);
+    CHECK(LTFATERR_NOTINRANGE, nthreads >= 0 && nthreads <= LTFAT_MAXTHREADS,
+          "nthreads (passed %d) must be in range 0-%d.", nthreads, LTFAT_MAXTHREADS);
+
+    return LTFAT_NAME(dgt_long_scratch_realloc)(
+               plan, nthreads ? nthreads : ltfat_get_num_threads());
+error:
+    return status;
+}
+
 LTFAT_API int
 LTFAT_NAME(dgt_long_done)(LTFAT_NAME(dgt_long_plan)** plan)
 {
@@ -105,9 +192,8 @@ LTFAT_NAME(dgt_long_done)(LTFAT_NAME(dgt_long_plan)** plan)
     pp = *plan;
 
     if (pp->p_veryend) LTFAT_NAME_REAL(fft_done)(&pp->p_veryend);
-    if (pp->p_before) LTFAT_NAME_REAL(fft_done)(&pp->p_before);
-    if (pp->p_after) LTFAT_NAME_REAL(ifft_done)(&pp->p_after);
-    LTFAT_SAFEFREEALL(pp->sbuf, pp->gf, pp->ff, pp->cf);
+    if (pp->scratch) LTFAT_NAME(dgt_long_scratch_free)(pp->scratch, pp->nthreads);
+    ltfat_wfac_cache_release(pp->gf);
     ltfat_free(pp);
     pp = NULL;
 error:
@@ -161,6 +247,73 @@ error:
     return status;
 }
 
+/* Takes the buffers of a single-threaded scratch from the workspace at
+ * base, or only counts their size if base is NULL. The FFT plans of the
+ * first plan-owned scratch are reused, they are not modified by
+ * fft_execute_ws. */
+static size_t
+LTFAT_NAME(dgt_long_ws_carve)(const LTFAT_NAME(dgt_long_plan)* plan, char* base,
+                              LTFAT_NAME_REAL(dgt_long_scratch)* sc)
+{
+    const LTFAT_NAME_REAL(dgt_long_scratch)* sc0 = plan->scratch;
+    ltfat_int p = plan->a / plan->c;
+    ltfat_int q = plan->M / plan->c;
+    ltfat_int d = plan->L / plan->M / p;
+    size_t fftws, off = 0;
+
+    fftws = LTFAT_NAME_REAL(fft_get_workspace_size)(sc0->p_before);
+    fftws = ltfat_ws_max(fftws, LTFAT_NAME_REAL(ifft_get_workspace_size)(sc0->p_after));
+    fftws = ltfat_ws_max(fftws, LTFAT_NAME_REAL(fft_get_workspace_size)(plan->p_veryend));
+
+    *sc = *sc0;
+    sc->sbuf = (LTFAT_REAL*) ltfat_ws_take(base, &off, 2 * d * sizeof(LTFAT_REAL));
+    sc->gt = (LTFAT_REAL*) ltfat_ws_take(base, &off, 2 * p * q * sizeof(LTFAT_REAL));
+    sc->ff = (LTFAT_REAL*) ltfat_ws_take(base, &off,
+                                         2 * d * p * q * plan->W * sizeof(LTFAT_REAL));
+    sc->cf = (LTFAT_REAL*) ltfat_ws_take(base, &off,
+                                         2 * d * q * q * plan->W * sizeof(LTFAT_REAL));
+    sc->fftwork = ltfat_ws_take(base, &off, fftws);
+    return off;
+}
+
+LTFAT_API size_t
+LTFAT_NAME(dgt_long_get_workspace_size)(const LTFAT_NAME(dgt_long_plan)* plan)
+{
+    LTFAT_NAME_REAL(dgt_long_scratch) sc;
+    if (!plan) return 0;
+    return ltfat_ws_size(LTFAT_NAME(dgt_long_ws_carve)(plan, NULL, &sc));
+}
+
+LTFAT_API int
+LTFAT_NAME(dgt_long_execute_ws)(const LTFAT_NAME(dgt_long_plan)* plan,
+                                const LTFAT_TYPE f[], LTFAT_COMPLEX c[],
+                                void* ws)
+{
+    LTFAT_NAME(dgt_long_plan) plan2;
+    LTFAT_NAME_REAL(dgt_long_scratch) sc;
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(plan); CHECKNULL(f); CHECKNULL(c); CHECKNULL(ws);
+
+    LTFAT_NAME(dgt_long_ws_carve)(plan, ltfat_ws_begin(ws), &sc);
+
+    // Shallow copy running single-threaded on the workspace
+    plan2 = *plan;
+    plan2.f = f;
+    plan2.nthreads = 1;
+    plan2.scratch = &sc;
+
+    LTFAT_NAME(dgt_walnut_execute)(&plan2, c);
+
+    if (LTFAT_TIMEINV == plan->ptype)
+        LTFAT_NAME_COMPLEX(dgtphaselockhelper)(c, plan->L, plan->W,
+                                               plan->a, plan->M, plan->M, c);
+
+    LTFAT_NAME_REAL(fft_execute_ws)(plan->p_veryend, c, c, sc.fftwork);
+
+error:
+    return status;
+}
+
 
 
 /*  This routine computes the DGT factorization using strided FFTs so
@@ -175,25 +328,19 @@ error:
     Special code for integer oversampling.
 
     Code works on LTFAT_REAL's instead on LTFAT_COMPLEX
-*/
 
+    Each coset r is done in three stages, the signal factorization, the
+    matrix product and the inverse coefficient factorization. Either the
+    cosets or the items of each stage are distributed among the threads.
+*/
 
-LTFAT_API int
-LTFAT_NAME(dgt_walnut_execute)(LTFAT_NAME(dgt_long_plan)* plan,
-                               LTFAT_COMPLEX* cout)
+/* Signal factorization of coset r, items (w,l,k) in range start..end-1 */
+static void
+LTFAT_NAME(dgt_walnut_fac)(LTFAT_NAME(dgt_long_plan)* plan,
+                           LTFAT_NAME_REAL(dgt_long_scratch)* sc,
+                           const LTFAT_TYPE* f, ltfat_int r, LTFAT_REAL* ff,
+                           ltfat_int start, ltfat_int end)
 {
-
-    /*  --------- initial declarations -------------- */
-
-    LTFAT_REAL* gbase, *fbase, *cbase;
-
-    ltfat_int rem;
-
-    LTFAT_REAL* ffp, *cfp;
-    LTFAT_TYPE* fp;
-
-    /*  ----------- calculation of parameters and plans -------- */
-
     ltfat_int a = plan->a;
     ltfat_int M = plan->M;
     ltfat_int L = plan->L;
@@ -203,14 +350,9 @@ LTFAT_NAME(dgt_walnut_execute)(LTFAT_NAME(dgt_long_plan)* plan,
     ltfat_int p = a / c;
     ltfat_int q = M / c;
     ltfat_int d = N / q;
-
-    LTFAT_TYPE* f = (LTFAT_TYPE*) plan->f;
-    const LTFAT_COMPLEX* gf = (const LTFAT_COMPLEX*)plan->gf;
-
     ltfat_int h_a = plan->h_a;
 
-    LTFAT_REAL* sbuf = plan->sbuf;
-    //LTFAT_COMPLEX* cout = plan->cout;
+    LTFAT_REAL* sbuf = sc->sbuf;
 
     /* Scaling constant needed because of FFTWs normalization. */
     LTFAT_REAL scalconst = (LTFAT_REAL)( 1.0 / ((double)d * sqrt((
@@ -219,172 +361,203 @@ LTFAT_NAME(dgt_walnut_execute)(LTFAT_NAME(dgt_long_plan)* plan,
     /* Leading dimensions of the 4dim array. */
     ltfat_int ld2a = 2 * p * q * W;
 
-    /* Leading dimensions of cf */
-    ltfat_int ld3b = 2 * q * q * W;
-    ltfat_int ld5c = M * N;
-
-    /* --------- main loop begins here ------------------- */
-    for (ltfat_int r = 0; r < c; r++)
+    for (ltfat_int t = start; t < end; t++)
     {
-        /*  ---------- compute signal factorization ----------- */
-        ffp = plan->ff;
-        fp = f + r;
-        if (p == 1)
+        ltfat_int w = t / (q * p);
+        ltfat_int l = (t / p) % q;
+        ltfat_int k = t % p;
+        const LTFAT_TYPE* fp = f + r + w * L;
+        LTFAT_REAL* ffp = ff + 2 * t;
+
+        for (ltfat_int s = 0; s < d; s++)
         {
-            /* Integer oversampling case */
-            for (ltfat_int w = 0; w < W; w++)
-            {
-                for (ltfat_int l = 0; l < q; l++)
-                {
-                    for (ltfat_int s = 0; s < d; s++)
-                    {
-                        rem = (s * M + l * a) % L;
+            ltfat_int rem;
+            if (p == 1)
+                /* Integer oversampling case */
+                rem = (s * M + l * a) % L;
+            else
+                /* rational sampling case */
+                rem = ltfat_positiverem(k * M + s * p * M - l * h_a * a, L);
 #ifdef LTFAT_COMPLEXTYPE
-                        sbuf[2 * s]   = ltfat_real(fp[rem]);
-                        sbuf[2 * s + 1] = ltfat_imag(fp[rem]);
+            sbuf[2 * s]   = ltfat_real(fp[rem]);
+            sbuf[2 * s + 1] = ltfat_imag(fp[rem]);
 #else
-                        sbuf[2 * s]   = fp[rem];
-                        sbuf[2 * s + 1] = 0.0;
+            sbuf[2 * s]   = fp[rem];
+            sbuf[2 * s + 1] = 0.0;
 #endif
-                    }
-
-                    LTFAT_NAME_REAL(fft_execute)(plan->p_before);
-
-                    for (ltfat_int s = 0; s < d; s++)
-                    {
-                        ffp[s * ld2a]   = sbuf[2 * s] * scalconst;
-                        ffp[s * ld2a + 1] = sbuf[2 * s + 1] * scalconst;
-                    }
-                    ffp += 2;
-                }
-                fp += L;
-            }
-            fp -= L * W;
-
-            /* Do the Matmul */
-            for (ltfat_int s = 0; s < d; s++)
-            {
-                gbase = (LTFAT_REAL*)gf + 2 * (r + s * c) * q;
-                fbase = plan->ff + 2 * s * q * W;
-                cbase = plan->cf + 2 * s * q * q * W;
-
-                for (ltfat_int nm = 0; nm < q * W; nm++)
-                {
-                    for (ltfat_int mm = 0; mm < q; mm++)
-                    {
-                        cbase[0] = gbase[0] * fbase[0] + gbase[1] * fbase[1];
-                        cbase[1] = gbase[0] * fbase[1] - gbase[1] * fbase[0];
-                        gbase += 2;
-                        cbase += 2;
-                    }
-                    gbase -= 2 * q;
-                    fbase += 2;
-                }
-                cbase -= 2 * q * q * W;
-            }
         }
-        else
+
+        LTFAT_NAME_REAL(fft_execute_ws)(sc->p_before, (LTFAT_COMPLEX*) sbuf,
+                                        (LTFAT_COMPLEX*) sbuf, sc->fftwork);
+
+        for (ltfat_int s = 0; s < d; s++)
         {
-            /* rational sampling case */
-
-            for (ltfat_int w = 0; w < W; w++)
-            {
-                for (ltfat_int l = 0; l < q; l++)
-                {
-                    for (ltfat_int k = 0; k < p; k++)
-                    {
-                        for (ltfat_int s = 0; s < d; s++)
-                        {
-                            rem = ltfat_positiverem(k * M + s * p * M - l * h_a * a, L);
-#ifdef LTFAT_COMPLEXTYPE
-                            sbuf[2 * s]   = ltfat_real(fp[rem]);
-                            sbuf[2 * s + 1] = ltfat_imag(fp[rem]);
-#else
-                            sbuf[2 * s]   = fp[rem];
-                            sbuf[2 * s + 1] = 0.0;
-#endif
-                        }
-
-                        LTFAT_NAME_REAL(fft_execute)(plan->p_before);
-
-                        for (ltfat_int s = 0; s < d; s++)
-                        {
-                            ffp[s * ld2a]   = sbuf[2 * s] * scalconst;
-                            ffp[s * ld2a + 1] = sbuf[2 * s + 1] * scalconst;
-                        }
-                        ffp += 2;
-                    }
-                }
-                fp += L;
-            }
-            fp -= L * W;
-
-            // Matmul
-            for (ltfat_int s = 0; s < d; s++)
-            {
-                gbase = (LTFAT_REAL*)gf + 2 * (r + s * c) * p * q;
-                fbase = plan->ff + 2 * s * p * q * W;
-                cbase = plan->cf + 2 * s * q * q * W;
-
-                for (ltfat_int nm = 0; nm < q * W; nm++)
-                {
-                    for (ltfat_int mm = 0; mm < q; mm++)
-                    {
-                        cbase[0] = 0.0;
-                        cbase[1] = 0.0;
-                        for (ltfat_int km = 0; km < p; km++)
-                        {
-                            cbase[0] += gbase[0] * fbase[0] + gbase[1] * fbase[1];
-                            cbase[1] += gbase[0] * fbase[1] - gbase[1] * fbase[0];
-                            gbase += 2;
-                            fbase += 2;
-                        }
-                        fbase -= 2 * p;
-                        cbase += 2;
-                    }
-                    gbase -= 2 * q * p;
-                    fbase += 2 * p;
-                }
-                cbase -= 2 * q * q * W;
-                fbase -= 2 * p * q * W;
-            }
-
-        } /* end of if p==1 */
-
-        /*  -------  compute inverse coefficient factorization ------- */
-        cfp = plan->cf;
-
-        /* Cover both integer and rational sampling case */
-        for (ltfat_int w = 0; w < W; w++)
+            ffp[s * ld2a]   = sbuf[2 * s] * scalconst;
+            ffp[s * ld2a + 1] = sbuf[2 * s + 1] * scalconst;
+        }
+    }
+}
+
+/* Matrix product of coset r for s in range start..end-1 */
+static void
+LTFAT_NAME(dgt_walnut_matmul)(LTFAT_NAME(dgt_long_plan)* plan,
+                              LTFAT_NAME_REAL(dgt_long_scratch)* sc,
+                              ltfat_int r, const LTFAT_REAL* ff, LTFAT_REAL* cf,
+                              ltfat_int start, ltfat_int end)
+{
+    ltfat_int c = plan->c;
+    ltfat_int p = plan->a / c;
+    ltfat_int q = plan->M / c;
+    ltfat_int W = plan->W;
+    const LTFAT_REAL* gf = (const LTFAT_REAL*) plan->gf;
+
+    for (ltfat_int ss = start; ss < end; ss++)
+    {
+        const LTFAT_REAL* gbase = gf + 2 * (r + ss * c) * p * q;
+
+        if (p > 1)
+        {
+            LTFAT_NAME_REAL(walnut_transpose)(gbase, p, q, sc->gt);
+            gbase = sc->gt;
+        }
+
+        LTFAT_NAME_REAL(walnut_fwdmatmul)(gbase, ff + 2 * ss * p * q * W, p, q,
+                                          q * W, cf + 2 * ss * q * q * W);
+    }
+}
+
+/* Inverse coefficient factorization of coset r, items (w,l,u) in range
+ * start..end-1 */
+static void
+LTFAT_NAME(dgt_walnut_ifac)(LTFAT_NAME(dgt_long_plan)* plan,
+                            LTFAT_NAME_REAL(dgt_long_scratch)* sc,
+                            ltfat_int r, const LTFAT_REAL* cf,
+                            LTFAT_COMPLEX* cout, ltfat_int start, ltfat_int end)
+{
+    ltfat_int M = plan->M;
+    ltfat_int N = plan->L / plan->a;
+    ltfat_int c = plan->c;
+    ltfat_int q = M / c;
+    ltfat_int d = N / q;
+    ltfat_int h_a = plan->h_a;
+
+    LTFAT_REAL* sbuf = sc->sbuf;
+
+    /* Leading dimensions of cf */
+    ltfat_int ld3b = 2 * q * q * plan->W;
+    ltfat_int ld5c = M * N;
+
+    /* Cover both integer and rational sampling case */
+    for (ltfat_int t = start; t < end; t++)
+    {
+        ltfat_int w = t / (q * q);
+        ltfat_int l = (t / q) % q;
+        ltfat_int u = t % q;
+        const LTFAT_REAL* cfp = cf + 2 * t;
+
+        for (ltfat_int s = 0; s < d; s++)
+        {
+            sbuf[2 * s]   = cfp[s * ld3b];
+            sbuf[2 * s + 1] = cfp[s * ld3b + 1];
+        }
+
+        /* Do inverse fft of length d */
+        LTFAT_NAME_REAL(ifft_execute_ws)(sc->p_after, (LTFAT_COMPLEX*) sbuf,
+                                         (LTFAT_COMPLEX*) sbuf, sc->fftwork);
+
+        for (ltfat_int s = 0; s < d; s++)
         {
-            /* Complete inverse fac of coefficients */
-            for (ltfat_int l = 0; l < q; l++)
-            {
-                for (ltfat_int u = 0; u < q; u++)
-                {
-                    for (ltfat_int s = 0; s < d; s++)
-                    {
-                        sbuf[2 * s]   = cfp[s * ld3b];
-                        sbuf[2 * s + 1] = cfp[s * ld3b + 1];
-                    }
-                    cfp += 2;
-
-                    /* Do inverse fft of length d */
-                    LTFAT_NAME_REAL(ifft_execute)(plan->p_after);
-
-                    for (ltfat_int s = 0; s < d; s++)
-                    {
-                        rem = r + l * c + ltfat_positiverem(u + s * q - l * h_a, N) * M + w * ld5c;
-                        LTFAT_REAL* coutTmp = (LTFAT_REAL*) &cout[rem];
-                        coutTmp[0] = sbuf[2 * s];
-                        coutTmp[1] = sbuf[2 * s + 1];
-                    }
-                }
-            }
+            ltfat_int rem = r + l * c + ltfat_positiverem(u + s * q - l * h_a, N) * M + w * ld5c;
+            LTFAT_REAL* coutTmp = (LTFAT_REAL*) &cout[rem];
+            coutTmp[0] = sbuf[2 * s];
+            coutTmp[1] = sbuf[2 * s + 1];
         }
+    }
+}
 
+static void
+LTFAT_NAME(dgt_walnut_cosets)(void* userdata, ltfat_int start, ltfat_int end,
+                              int threadid)
+{
+    LTFAT_NAME(dgt_walnut_job)* job = (LTFAT_NAME(dgt_walnut_job)*) userdata;
+    LTFAT_NAME(dgt_long_plan)* p = job->p;
+    LTFAT_NAME_REAL(dgt_long_scratch)* sc = p->scratch + threadid;
+    ltfat_int q = p->M / p->c;
+    ltfat_int pp = p->a / p->c;
+    ltfat_int d = p->L / p->M / pp;
+
+    for (ltfat_int r = start; r < end; r++)
+    {
+        LTFAT_NAME(dgt_walnut_fac)(p, sc, job->f, r, sc->ff, 0, p->W * q * pp);
+        LTFAT_NAME(dgt_walnut_matmul)(p, sc, r, sc->ff, sc->cf, 0, d);
+        LTFAT_NAME(dgt_walnut_ifac)(p, sc, r, sc->cf, job->cout, 0, p->W * q * q);
+    }
+}
+
+static void
+LTFAT_NAME(dgt_walnut_fac_items)(void* userdata, ltfat_int start, ltfat_int end,
+                                 int threadid)
+{
+    LTFAT_NAME(dgt_walnut_job)* job = (LTFAT_NAME(dgt_walnut_job)*) userdata;
+    LTFAT_NAME(dgt_long_plan)* p = job->p;
+
+    LTFAT_NAME(dgt_walnut_fac)(p, p->scratch + threadid, job->f, job->r,
+                               p->scratch[0].ff, start, end);
+}
+
+static void
+LTFAT_NAME(dgt_walnut_matmul_items)(void* userdata, ltfat_int start,
+                                    ltfat_int end, int threadid)
+{
+    LTFAT_NAME(dgt_walnut_job)* job = (LTFAT_NAME(dgt_walnut_job)*) userdata;
+    LTFAT_NAME(dgt_long_plan)* p = job->p;
 
-        /* ----------- Main loop ends here ------------------------ */
+    LTFAT_NAME(dgt_walnut_matmul)(p, p->scratch + threadid, job->r,
+                                  p->scratch[0].ff, p->scratch[0].cf, start, end);
+}
+
+static void
+LTFAT_NAME(dgt_walnut_ifac_items)(void* userdata, ltfat_int start, ltfat_int end,
+                                  int threadid)
+{
+    LTFAT_NAME(dgt_walnut_job)* job = (LTFAT_NAME(dgt_walnut_job)*) userdata;
+    LTFAT_NAME(dgt_long_plan)* p = job->p;
+
+    LTFAT_NAME(dgt_walnut_ifac)(p, p->scratch + threadid, job->r,
+                                p->scratch[0].cf, job->cout, start, end);
+}
+
+LTFAT_API int
+LTFAT_NAME(dgt_walnut_execute)(LTFAT_NAME(dgt_long_plan)* plan,
+                               LTFAT_COMPLEX* cout)
+{
+    LTFAT_NAME(dgt_walnut_job) job;
+    ltfat_int c = plan->c;
+    ltfat_int p = plan->a / c;
+    ltfat_int q = plan->M / c;
+    ltfat_int d = plan->L / plan->M / p;
+
+    job.p = plan;
+    job.f = (const LTFAT_TYPE*) plan->f;
+    job.cout = cout;
+    job.r = 0;
+
+    if (ltfat_walnut_parallel_cosets(c, plan->nthreads))
+    {
+        ltfat_parallel_for(plan->nthreads, c,
+                           &LTFAT_NAME(dgt_walnut_cosets), &job);
+    }
+    else
+    {
+        for (job.r = 0; job.r < c; job.r++)
+        {
+            ltfat_parallel_for(plan->nthreads, plan->W * q * p,
+                               &LTFAT_NAME(dgt_walnut_fac_items), &job);
+            ltfat_parallel_for(plan->nthreads, d,
+                               &LTFAT_NAME(dgt_walnut_matmul_items), &job);
+            ltfat_parallel_for(plan->nthreads, plan->W * q * q,
+                               &LTFAT_NAME(dgt_walnut_ifac_items), &job);
+        }
     }
 
     return LTFATERR_SUCCESS;
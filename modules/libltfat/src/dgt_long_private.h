@@ -4,6 +4,19 @@
 
 #include "ltfat/thirdparty/fftw3.h"
 
+/* Buffers and FFT plans of the factorization used by a single thread.
+ * ff and cf are only allocated for the threads processing whole cosets.
+ * fftwork is the FFT scratch, NULL for the one owned by the FFT plans. */
+typedef struct
+{
+    LTFAT_NAME_REAL(fft_plan)* p_before;
+    LTFAT_NAME_REAL(ifft_plan)* p_after;
+    LTFAT_REAL* sbuf;
+    LTFAT_REAL* gt;
+    LTFAT_REAL* ff, *cf;
+    void* fftwork;
+} LTFAT_NAME_REAL(dgt_long_scratch);
+
 struct LTFAT_NAME_REAL(dgt_long_plan)
 {
     ltfat_int a;
@@ -13,14 +26,13 @@ struct LTFAT_NAME_REAL(dgt_long_plan)
     ltfat_int c;
     ltfat_int h_a;
     ltfat_phaseconvention ptype;
-    LTFAT_NAME_REAL(fft_plan)* p_before;
-    LTFAT_NAME_REAL(ifft_plan)* p_after;
+    unsigned flags;
+    int nthreads;
+    LTFAT_NAME_REAL(dgt_long_scratch)* scratch;
     LTFAT_NAME_REAL(fft_plan)* p_veryend;
-    LTFAT_REAL* sbuf;
     const LTFAT_REAL* f;
-    LTFAT_COMPLEX* gf;
+    const LTFAT_COMPLEX* gf;
     LTFAT_COMPLEX* cout;
-    LTFAT_REAL* ff, *cf;
 };
 
 struct LTFAT_NAME_COMPLEX(dgt_long_plan)
@@ -32,13 +44,12 @@ struct LTFAT_NAME_COMPLEX(dgt_long_plan)
     ltfat_int c;
     ltfat_int h_a;
     ltfat_phaseconvention ptype;
-    LTFAT_NAME_REAL(fft_plan)* p_before;
-    LTFAT_NAME_REAL(ifft_plan)* p_after;
+    unsigned flags;
+    int nthreads;
+    LTFAT_NAME_REAL(dgt_long_scratch)* scratch;
     LTFAT_NAME_REAL(fft_plan)* p_veryend;
-    LTFAT_REAL* sbuf;
     const LTFAT_COMPLEX* f;
-    LTFAT_COMPLEX* gf;
+    const LTFAT_COMPLEX* gf;
     LTFAT_COMPLEX* cout;
-    LTFAT_REAL* ff, *cf;
 };
 
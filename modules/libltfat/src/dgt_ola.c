@@ -1,15 +1,261 @@
+#include "ltfat.h"
+#include "ltfat/types.h"
+#include "ltfat/macros.h"
 #include "dgt_long_private.h"
+#ifndef LTFAT_COMPLEXTYPE
 #include "dgtreal_long_private.h"
+#endif
+#include "dgt_ola_private.h"
+#include "workspace_private.h"
+
+/* Overlap-add algorithm
+ *
+ * Block ii of bl samples is padded with glext zeros and transformed
+ * by the factorization algorithm. The first bl/a frames belong to the block,
+ * the next glext/(2a) frames overlap the following block and the last
+ * glext/(2a) frames overlap the preceding block. The synthesis does the
+ * same with the roles of the samples and the frames swapped.
+ *
+ * The file is compiled for the complex types too: the real pass gives the
+ * real input dgt and the dgtreal variants, the complex pass the complex
+ * input dgt. The old by-value dgt_ola and dgtreal_ola plans are thin
+ * layers over the same code.
+ */
+
+/* Adds coefficients of block ii, Mc x (bl+glext)/a x W in cbuf, to c */
+static void
+LTFAT_NAME(ola_addcoefs)(const LTFAT_COMPLEX* cbuf, ltfat_int Mc, ltfat_int a,
+                         ltfat_int bl, ltfat_int glext, ltfat_int L, ltfat_int W,
+                         ltfat_int ii, LTFAT_COMPLEX* c)
+{
+    ltfat_int N = L / a, Nb = L / bl;
+    ltfat_int Nblock = bl / a, Nblocke = (bl + glext) / a;
+    ltfat_int b2 = glext / a / 2;
+
+    for (ltfat_int w = 0; w < W; w++)
+    {
+        const LTFAT_COMPLEX* cb = cbuf + w * Mc * Nblocke;
+        LTFAT_COMPLEX* cw = c + w * Mc * N;
+        LTFAT_COMPLEX* cnext = cw + Mc * (ltfat_positiverem(ii + 1, Nb) * Nblock);
+        LTFAT_COMPLEX* cprev = cw + Mc * ltfat_positiverem(ii * Nblock - b2, N);
+
+        for (ltfat_int n = 0; n < Mc * Nblock; n++)
+            cw[ii * Mc * Nblock + n] += cb[n];
+
+        for (ltfat_int n = 0; n < Mc * b2; n++)
+            cnext[n] += cb[Mc * Nblock + n];
+
+        for (ltfat_int n = 0; n < Mc * b2; n++)
+            cprev[n] += cb[Mc * (Nblock + b2) + n];
+    }
+}
+
+/* Copies the coefficients of block ii to cbuf, the rest of cbuf is kept */
+static void
+LTFAT_NAME(ola_getcoefs)(const LTFAT_COMPLEX* c, ltfat_int Mc, ltfat_int a,
+                         ltfat_int bl, ltfat_int glext, ltfat_int L, ltfat_int W,
+                         ltfat_int ii, LTFAT_COMPLEX* cbuf)
+{
+    ltfat_int N = L / a;
+    ltfat_int Nblock = bl / a, Nblocke = (bl + glext) / a;
+
+    for (ltfat_int w = 0; w < W; w++)
+        memcpy(cbuf + w * Mc * Nblocke, c + Mc * (ii * Nblock + w * N),
+               Mc * Nblock * sizeof * c);
+}
+
+static int
+LTFAT_NAME(dgt_ola_blocks)(LTFAT_NAME(dgt_long_plan)* plan, LTFAT_TYPE* buf,
+                           const LTFAT_COMPLEX* cbuf, ltfat_int bl, ltfat_int glext,
+                           ltfat_int a, ltfat_int M,
+                           const LTFAT_TYPE* f, ltfat_int L, ltfat_int W,
+                           LTFAT_COMPLEX* c)
+{
+    ltfat_int Lext = bl + glext;
+    int status = LTFATERR_SUCCESS;
+
+    LTFAT_NAME_COMPLEX(clear_array)(c, M * (L / a) * W);
+
+    for (ltfat_int ii = 0; ii < L / bl; ii++)
+    {
+        for (ltfat_int w = 0; w < W; w++)
+            memcpy(buf + w * Lext, f + ii * bl + w * L, bl * sizeof * f);
+
+        CHECKSTATUS( LTFAT_NAME(dgt_long_execute)(plan));
+
+        LTFAT_NAME(ola_addcoefs)(cbuf, M, a, bl, glext, L, W, ii, c);
+    }
+error:
+    return status;
+}
+
+static int
+LTFAT_NAME(idgt_ola_blocks)(LTFAT_NAME(idgt_long_plan)* plan, LTFAT_COMPLEX* cbuf,
+                            const LTFAT_COMPLEX* buf, ltfat_int bl, ltfat_int glext,
+                            ltfat_int a, ltfat_int M, int do_overwriteoutarray,
+                            const LTFAT_COMPLEX* c, ltfat_int L, ltfat_int W,
+                            LTFAT_COMPLEX* f)
+{
+    ltfat_int Lext = bl + glext, Nb = L / bl, g2 = glext / 2;
+    int status = LTFATERR_SUCCESS;
+
+    if (do_overwriteoutarray)
+        LTFAT_NAME_COMPLEX(clear_array)(f, L * W);
+
+    for (ltfat_int ii = 0; ii < Nb; ii++)
+    {
+        LTFAT_NAME(ola_getcoefs)(c, M, a, bl, glext, L, W, ii, cbuf);
+
+        CHECKSTATUS( LTFAT_NAME(idgt_long_execute)(plan));
+
+        for (ltfat_int w = 0; w < W; w++)
+        {
+            const LTFAT_COMPLEX* fb = buf + w * Lext;
+            LTFAT_COMPLEX* fw = f + w * L;
+            LTFAT_COMPLEX* fnext = fw + ltfat_positiverem(ii + 1, Nb) * bl;
+            LTFAT_COMPLEX* fprev = fw + ltfat_positiverem(ii * bl - g2, L);
+
+            for (ltfat_int l = 0; l < bl; l++)
+                fw[ii * bl + l] += fb[l];
+
+            for (ltfat_int l = 0; l < g2; l++)
+                fnext[l] += fb[bl + l];
+
+            for (ltfat_int l = 0; l < g2; l++)
+                fprev[l] += fb[bl + g2 + l];
+        }
+    }
+error:
+    return status;
+}
 
+int
+LTFAT_NAME(dgt_olablock_init)(const LTFAT_TYPE g[], ltfat_int gl, ltfat_int L,
+                              ltfat_int W, ltfat_int a, ltfat_int M,
+                              ltfat_dgt_params* params,
+                              LTFAT_NAME(dgt_olablock_plan)** pout)
+{
+    LTFAT_NAME(dgt_olablock_plan)* p = NULL;
+    LTFAT_TYPE* gext = NULL;
+    ltfat_int bl, glext, Lext;
+    int status = LTFATERR_SUCCESS;
+
+    CHECKSTATUS( bl = ltfat_dgt_ola_blocklength(gl, L, a, M,
+                      params->olablocklength, &glext));
+    Lext = bl + glext;
+
+    CHECKMEM( p = LTFAT_NEW(LTFAT_NAME(dgt_olablock_plan)));
+    p->bl = bl; p->glext = glext; p->a = a; p->M = M;
+    CHECKMEM( p->buf = LTFAT_NAME(calloc)(Lext * W));
+    CHECKMEM( p->cbuf = LTFAT_NAME_COMPLEX(malloc)(M * (Lext / a) * W));
+    CHECKMEM( gext = LTFAT_NAME(malloc)(Lext));
+    LTFAT_NAME(fir2long)(g, gl, Lext, gext);
+
+    CHECKSTATUS(
+        LTFAT_NAME(dgt_long_init)( gext, Lext, W, a, M, p->buf, p->cbuf,
+                                   params->ptype, params->fftw_flags, &p->plan));
+    CHECKSTATUS(
+        LTFAT_NAME(dgt_long_set_numthreads)(p->plan, params->nthreads));
+
+    ltfat_free(gext);
+    *pout = p;
+    return status;
+error:
+    ltfat_safefree(gext);
+    if (p) LTFAT_NAME(dgt_olablock_done)(&p);
+    return status;
+}
+
+int
+LTFAT_NAME(dgt_olablock_execute)(LTFAT_NAME(dgt_olablock_plan)* p,
+                                 const LTFAT_TYPE f[], ltfat_int L, ltfat_int W,
+                                 LTFAT_COMPLEX c[])
+{
+    return LTFAT_NAME(dgt_ola_blocks)(p->plan, p->buf, p->cbuf, p->bl, p->glext,
+                                      p->a, p->M, f, L, W, c);
+}
+
+int
+LTFAT_NAME(dgt_olablock_done)(LTFAT_NAME(dgt_olablock_plan)** p)
+{
+    LTFAT_NAME(dgt_olablock_plan)* pp = *p;
+    if (pp->plan) LTFAT_NAME(dgt_long_done)(&pp->plan);
+    LTFAT_SAFEFREEALL(pp->buf, pp->cbuf);
+    ltfat_free(pp);
+    *p = NULL;
+    return LTFATERR_SUCCESS;
+}
+
+int
+LTFAT_NAME(idgt_olablock_init)(const LTFAT_TYPE g[], ltfat_int gl, ltfat_int L,
+                               ltfat_int W, ltfat_int a, ltfat_int M,
+                               ltfat_dgt_params* params,
+                               LTFAT_NAME(idgt_olablock_plan)** pout)
+{
+    LTFAT_NAME(idgt_olablock_plan)* p = NULL;
+    LTFAT_TYPE* gext = NULL;
+    ltfat_int bl, glext, Lext;
+    int status = LTFATERR_SUCCESS;
+
+    CHECKSTATUS( bl = ltfat_dgt_ola_blocklength(gl, L, a, M,
+                      params->olablocklength, &glext));
+    Lext = bl + glext;
+
+    CHECKMEM( p = LTFAT_NEW(LTFAT_NAME(idgt_olablock_plan)));
+    p->bl = bl; p->glext = glext; p->a = a; p->M = M;
+    p->do_overwriteoutarray = 1;
+    CHECKMEM( p->cbuf = LTFAT_NAME_COMPLEX(calloc)(M * (Lext / a) * W));
+    CHECKMEM( p->buf = LTFAT_NAME_COMPLEX(malloc)(Lext * W));
+    CHECKMEM( gext = LTFAT_NAME(malloc)(Lext));
+    LTFAT_NAME(fir2long)(g, gl, Lext, gext);
+
+    CHECKSTATUS(
+        LTFAT_NAME(idgt_long_init)( gext, Lext, W, a, M, p->cbuf, p->buf,
+                                    params->ptype, params->fftw_flags, &p->plan));
+    CHECKSTATUS(
+        LTFAT_NAME(idgt_long_set_numthreads)(p->plan, params->nthreads));
+
+    ltfat_free(gext);
+    *pout = p;
+    return status;
+error:
+    ltfat_safefree(gext);
+    if (p) LTFAT_NAME(idgt_olablock_done)(&p);
+    return status;
+}
+
+int
+LTFAT_NAME(idgt_olablock_execute)(LTFAT_NAME(idgt_olablock_plan)* p,
+                                  const LTFAT_COMPLEX c[], ltfat_int L, ltfat_int W,
+                                  LTFAT_COMPLEX f[])
+{
+    return LTFAT_NAME(idgt_ola_blocks)(p->plan, p->cbuf, p->buf, p->bl, p->glext,
+                                       p->a, p->M, p->do_overwriteoutarray,
+                                       c, L, W, f);
+}
+
+int
+LTFAT_NAME(idgt_olablock_done)(LTFAT_NAME(idgt_olablock_plan)** p)
+{
+    LTFAT_NAME(idgt_olablock_plan)* pp = *p;
+    if (pp->plan) LTFAT_NAME(idgt_long_done)(&pp->plan);
+    LTFAT_SAFEFREEALL(pp->buf, pp->cbuf);
+    ltfat_free(pp);
+    *p = NULL;
+    return LTFATERR_SUCCESS;
+}
+
+#ifdef LTFAT_COMPLEXTYPE
 
-LTFAT_API LTFAT_NAME(dgt_ola_plan)
-LTFAT_NAME(dgt_ola_init)(const LTFAT_COMPLEX* g, ltfat_int gl,
-                         ltfat_int W, ltfat_int a, ltfat_int M,
-                         ltfat_int bl, const ltfat_phaseconvention ptype,
-                         unsigned flags)
+/* The by-value plan of the complex dgt_ola keeps the real type suffix */
+LTFAT_API LTFAT_NAME_REAL(dgt_ola_plan)
+LTFAT_NAME_REAL(dgt_ola_init)(const LTFAT_COMPLEX* g, ltfat_int gl,
+                              ltfat_int W, ltfat_int a, ltfat_int M,
+                              ltfat_int bl, const ltfat_phaseconvention ptype,
+                              unsigned flags)
 {
 
-    LTFAT_NAME(dgt_ola_plan) plan;
+    LTFAT_NAME_REAL(dgt_ola_plan) plan;
 
     plan.bl = bl;
     plan.gl = gl;
@@ -18,28 +264,12 @@ LTFAT_NAME(dgt_ola_init)(const LTFAT_COMPLEX* g, ltfat_int gl,
     ltfat_int Lext    = bl + gl;
     ltfat_int Nblocke = Lext / a;
 
-    plan.buf  = LTFAT_NAME_COMPLEX(malloc)(Lext * W);
+    plan.buf  = LTFAT_NAME_COMPLEX(calloc)(Lext * W);
     plan.gext = LTFAT_NAME_COMPLEX(malloc)(Lext);
     plan.cbuf = LTFAT_NAME_COMPLEX(malloc)(M * Nblocke * W);
 
     LTFAT_NAME_COMPLEX(fir2long)(g, gl, Lext, plan.gext);
 
-    /* Zero the last part of the buffer, it will always be zero. */
-    for (ltfat_int w = 0; w < W; w++)
-    {
-        for (ltfat_int jj = bl; jj < Lext; jj++)
-        {
-            plan.buf[jj + w * Lext] = (LTFAT_COMPLEX) 0.0;
-        }
-    }
-
-    /* plan.plan = */
-    /*     LTFAT_NAME(dgt_long_init)((const LTFAT_COMPLEX*)plan.buf, */
-    /*                               (const LTFAT_COMPLEX*)plan.gext, */
-    /*                               Lext, W, a, M, */
-    /*                               plan.cbuf, ptype, flags); */
-
-
     LTFAT_NAME_COMPLEX(dgt_long_init)(plan.gext,
                                       Lext, W, a, M,
                                       plan.buf, plan.cbuf, ptype, flags,
@@ -50,100 +280,312 @@ LTFAT_NAME(dgt_ola_init)(const LTFAT_COMPLEX* g, ltfat_int gl,
 }
 
 LTFAT_API void
-LTFAT_NAME(dgt_ola_execute)(const LTFAT_NAME(dgt_ola_plan) plan,
-                            const LTFAT_COMPLEX* f, ltfat_int L,
-                            LTFAT_COMPLEX* cout)
+LTFAT_NAME_REAL(dgt_ola_execute)(const LTFAT_NAME_REAL(dgt_ola_plan) plan,
+                                 const LTFAT_COMPLEX* f, ltfat_int L,
+                                 LTFAT_COMPLEX* cout)
 
 {
-    ltfat_int bl      = plan.bl;
-    ltfat_int gl      = plan.gl;
-    ltfat_int a       = plan.plan->a;
-    ltfat_int M       = plan.plan->M;
-    ltfat_int N       = L / a;
-    ltfat_int Lext    = bl + gl;
-    ltfat_int Nb      = L / bl;
-    ltfat_int b2      = gl / a / 2;
-    ltfat_int Nblock  = bl / a;
-    ltfat_int Nblocke = Lext / a;
-    ltfat_int W       = plan.W;
+    LTFAT_NAME(dgt_ola_blocks)(plan.plan, plan.buf, plan.cbuf, plan.bl, plan.gl,
+                               plan.plan->a, plan.plan->M,
+                               f, L, plan.W, cout);
+}
+
+LTFAT_API void
+LTFAT_NAME_REAL(dgt_ola_done)(LTFAT_NAME_REAL(dgt_ola_plan) plan)
+{
+    LTFAT_NAME_COMPLEX(dgt_long_done)(&plan.plan);
+    LTFAT_SAFEFREEALL(plan.cbuf, plan.gext, plan.buf);
+}
 
+#else
+
+/* With lws == NULL, plan runs on buf and cbuf it was created with, otherwise
+ * on the passed ones using lws as its workspace */
+static int
+LTFAT_NAME(dgtreal_ola_blocks)(LTFAT_NAME(dgtreal_long_plan)* plan, void* lws,
+                               LTFAT_REAL* buf, LTFAT_COMPLEX* cbuf,
+                               ltfat_int bl, ltfat_int glext, ltfat_int a, ltfat_int M,
+                               const LTFAT_REAL* f, ltfat_int L, ltfat_int W,
+                               LTFAT_COMPLEX* c)
+{
+    ltfat_int Lext = bl + glext, M2 = M / 2 + 1;
+    int status = LTFATERR_SUCCESS;
+
+    LTFAT_NAME_COMPLEX(clear_array)(c, M2 * (L / a) * W);
+
+    for (ltfat_int w = 0; w < W; w++)
+        memset(buf + w * Lext + bl, 0, glext * sizeof * buf);
 
-    /* Zero the output array, as we will be adding to it */
-    for (ltfat_int ii = 0; ii < M * N * W; ii++)
+    for (ltfat_int ii = 0; ii < L / bl; ii++)
     {
-        cout[ii] = (LTFAT_COMPLEX) 0.0;
+        for (ltfat_int w = 0; w < W; w++)
+            memcpy(buf + w * Lext, f + ii * bl + w * L, bl * sizeof * f);
+
+        if (lws)
+            CHECKSTATUS( LTFAT_NAME(dgtreal_long_execute_ws)(plan, buf, cbuf, lws));
+        else
+            CHECKSTATUS( LTFAT_NAME(dgtreal_long_execute)(plan));
+
+        LTFAT_NAME(ola_addcoefs)(cbuf, M2, a, bl, glext, L, W, ii, c);
     }
+error:
+    return status;
+}
+
+/* lws as in dgtreal_ola_blocks */
+static int
+LTFAT_NAME(idgtreal_ola_blocks)(LTFAT_NAME(idgtreal_long_plan)* plan, void* lws,
+                                LTFAT_COMPLEX* cbuf, LTFAT_REAL* buf,
+                                ltfat_int bl, ltfat_int glext, ltfat_int a,
+                                ltfat_int M, int do_overwriteoutarray,
+                                const LTFAT_COMPLEX* c, ltfat_int L, ltfat_int W,
+                                LTFAT_REAL* f)
+{
+    ltfat_int Lext = bl + glext, Nb = L / bl, g2 = glext / 2, M2 = M / 2 + 1;
+    int status = LTFATERR_SUCCESS;
+
+    if (do_overwriteoutarray)
+        memset(f, 0, L * W * sizeof * f);
+
+    for (ltfat_int w = 0; w < W; w++)
+        LTFAT_NAME_COMPLEX(clear_array)(cbuf + M2 * ((w * Lext + bl) / a),
+                                        M2 * (glext / a));
 
     for (ltfat_int ii = 0; ii < Nb; ii++)
     {
-        ltfat_int s_ii;
+        LTFAT_NAME(ola_getcoefs)(c, M2, a, bl, glext, L, W, ii, cbuf);
+
+        if (lws)
+            CHECKSTATUS( LTFAT_NAME(idgtreal_long_execute_ws)(plan, cbuf, buf, lws));
+        else
+            CHECKSTATUS( LTFAT_NAME(idgtreal_long_execute)(plan));
 
-        /* Copy to working buffer. */
         for (ltfat_int w = 0; w < W; w++)
         {
-            memcpy(plan.buf + Lext * w, f + ii * bl + w * L, sizeof(LTFAT_COMPLEX)*bl);
-        }
+            const LTFAT_REAL* fb = buf + w * Lext;
+            LTFAT_REAL* fw = f + w * L;
+            LTFAT_REAL* fnext = fw + ltfat_positiverem(ii + 1, Nb) * bl;
+            LTFAT_REAL* fprev = fw + ltfat_positiverem(ii * bl - g2, L);
 
-        /* Execute the short DGT */
-        LTFAT_NAME_COMPLEX(dgt_long_execute)(plan.plan);
+            for (ltfat_int l = 0; l < bl; l++)
+                fw[ii * bl + l] += fb[l];
 
-        /* Place the results */
-        for (ltfat_int w = 0; w < W; w++)
-        {
-            LTFAT_COMPLEX* cout_p;
-            LTFAT_COMPLEX* cbuf_p;
-
-            /* Place large block */
-            cout_p = cout + ii * M * Nblock + w * M * N ;
-            cbuf_p = plan.cbuf +             w * M * Nblocke;
-            for (ltfat_int m = 0; m < M; m++)
-            {
-                for (ltfat_int n = 0; n < Nblock; n++)
-                {
-                    cout_p[m + n * M] += cbuf_p[m + n * M];
-                }
-            }
-
-            /* Small block + */
-            s_ii = ltfat_positiverem(ii + 1, Nb);
-            cout_p = cout + s_ii * M * Nblock + w * M * N ;
-            cbuf_p = plan.cbuf +      M * Nblock + w * M * Nblocke;
-            for (ltfat_int m = 0; m < M; m++)
-            {
-                for (ltfat_int n = 0; n < b2; n++)
-                {
-                    cout_p[m + n * M] += cbuf_p[m + n * M];
-                }
-            }
-
-
-            /* Small block - */
-            s_ii = ltfat_positiverem(ii - 1, Nb) + 1;
-            cout_p = cout + M * (s_ii * Nblock - b2) + w * M * N ;
-            cbuf_p = plan.cbuf + M * (Nblock + b2)     + w * M * Nblocke;
-            for (ltfat_int m = 0; m < M; m++)
-            {
-                for (ltfat_int n = 0; n < b2; n++)
-                {
-                    cout_p[m + n * M] += cbuf_p[m + n * M];
-                }
-            }
+            for (ltfat_int l = 0; l < g2; l++)
+                fnext[l] += fb[bl + l];
 
+            for (ltfat_int l = 0; l < g2; l++)
+                fprev[l] += fb[bl + g2 + l];
         }
-
     }
+error:
+    return status;
+}
 
+int
+LTFAT_NAME(dgtreal_olablock_init)(const LTFAT_REAL g[], ltfat_int gl, ltfat_int L,
+                                  ltfat_int W, ltfat_int a, ltfat_int M,
+                                  ltfat_dgt_params* params,
+                                  LTFAT_NAME(dgtreal_olablock_plan)** pout)
+{
+    LTFAT_NAME(dgtreal_olablock_plan)* p = NULL;
+    LTFAT_REAL* gext = NULL;
+    ltfat_int bl, glext, Lext;
+    int status = LTFATERR_SUCCESS;
+
+    CHECKSTATUS( bl = ltfat_dgt_ola_blocklength(gl, L, a, M,
+                      params->olablocklength, &glext));
+    Lext = bl + glext;
+
+    CHECKMEM( p = LTFAT_NEW(LTFAT_NAME(dgtreal_olablock_plan)));
+    p->W = W; p->bl = bl; p->glext = glext; p->a = a; p->M = M;
+    CHECKMEM( p->buf = LTFAT_NAME_REAL(calloc)(Lext * W));
+    CHECKMEM( p->cbuf = LTFAT_NAME_COMPLEX(malloc)((M / 2 + 1) * (Lext / a) * W));
+    CHECKMEM( gext = LTFAT_NAME_REAL(malloc)(Lext));
+    LTFAT_NAME(fir2long)(g, gl, Lext, gext);
+
+    CHECKSTATUS(
+        LTFAT_NAME(dgtreal_long_init)( gext, Lext, W, a, M, p->buf, p->cbuf,
+                                       params->ptype, params->fftw_flags, &p->plan));
+    CHECKSTATUS(
+        LTFAT_NAME(dgtreal_long_set_numthreads)(p->plan, params->nthreads));
+
+    ltfat_free(gext);
+    *pout = p;
+    return status;
+error:
+    ltfat_safefree(gext);
+    if (p) LTFAT_NAME(dgtreal_olablock_done)(&p);
+    return status;
+}
 
+int
+LTFAT_NAME(dgtreal_olablock_execute)(LTFAT_NAME(dgtreal_olablock_plan)* p,
+                                     const LTFAT_REAL f[], ltfat_int L, ltfat_int W,
+                                     LTFAT_COMPLEX c[])
+{
+    return LTFAT_NAME(dgtreal_ola_blocks)(p->plan, NULL, p->buf, p->cbuf, p->bl,
+                                          p->glext, p->a, p->M, f, L, W, c);
 }
 
-LTFAT_API void
-LTFAT_NAME(dgt_ola_done)(LTFAT_NAME(dgt_ola_plan) plan)
+/* The workspace holds the extended block, its coefficients and the
+ * workspace of the factorization plan */
+static size_t
+LTFAT_NAME(dgtreal_olablock_ws_carve)(const LTFAT_NAME(dgtreal_olablock_plan)* p,
+                                      char* base, LTFAT_REAL** buf,
+                                      LTFAT_COMPLEX** cbuf, void** lws)
 {
-    LTFAT_NAME_COMPLEX(dgt_long_done)(&plan.plan);
-    LTFAT_SAFEFREEALL(plan.cbuf, plan.gext, plan.buf);
+    size_t off = 0;
+    ltfat_int Lext = p->bl + p->glext, W = p->W;
+
+    *buf = (LTFAT_REAL*) ltfat_ws_take(base, &off, Lext * W * sizeof(LTFAT_REAL));
+    *cbuf = (LTFAT_COMPLEX*) ltfat_ws_take(base, &off,
+                                           (p->M / 2 + 1) * (Lext / p->a) * W *
+                                           sizeof(LTFAT_COMPLEX));
+    *lws = ltfat_ws_take(base, &off,
+                         LTFAT_NAME(dgtreal_long_get_workspace_size)(p->plan));
+    return off;
+}
+
+size_t
+LTFAT_NAME(dgtreal_olablock_get_workspace_size)(
+    const LTFAT_NAME(dgtreal_olablock_plan)* p)
+{
+    LTFAT_REAL* buf; LTFAT_COMPLEX* cbuf; void* lws;
+    if (!p) return 0;
+    return ltfat_ws_size(
+               LTFAT_NAME(dgtreal_olablock_ws_carve)(p, NULL, &buf, &cbuf, &lws));
+}
+
+int
+LTFAT_NAME(dgtreal_olablock_execute_ws)(const LTFAT_NAME(dgtreal_olablock_plan)* p,
+                                        const LTFAT_REAL f[], ltfat_int L, ltfat_int W,
+                                        LTFAT_COMPLEX c[], void* ws)
+{
+    LTFAT_REAL* buf; LTFAT_COMPLEX* cbuf; void* lws;
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(p); CHECKNULL(ws);
+
+    LTFAT_NAME(dgtreal_olablock_ws_carve)(p, ltfat_ws_begin(ws), &buf, &cbuf, &lws);
+    return LTFAT_NAME(dgtreal_ola_blocks)(p->plan, lws, buf, cbuf, p->bl,
+                                          p->glext, p->a, p->M, f, L, W, c);
+error:
+    return status;
+}
+
+int
+LTFAT_NAME(dgtreal_olablock_done)(LTFAT_NAME(dgtreal_olablock_plan)** p)
+{
+    LTFAT_NAME(dgtreal_olablock_plan)* pp = *p;
+    if (pp->plan) LTFAT_NAME(dgtreal_long_done)(&pp->plan);
+    LTFAT_SAFEFREEALL(pp->buf, pp->cbuf);
+    ltfat_free(pp);
+    *p = NULL;
+    return LTFATERR_SUCCESS;
+}
+
+int
+LTFAT_NAME(idgtreal_olablock_init)(const LTFAT_REAL g[], ltfat_int gl, ltfat_int L,
+                                   ltfat_int W, ltfat_int a, ltfat_int M,
+                                   ltfat_dgt_params* params,
+                                   LTFAT_NAME(idgtreal_olablock_plan)** pout)
+{
+    LTFAT_NAME(idgtreal_olablock_plan)* p = NULL;
+    LTFAT_REAL* gext = NULL;
+    ltfat_int bl, glext, Lext;
+    int status = LTFATERR_SUCCESS;
+
+    CHECKSTATUS( bl = ltfat_dgt_ola_blocklength(gl, L, a, M,
+                      params->olablocklength, &glext));
+    Lext = bl + glext;
+
+    CHECKMEM( p = LTFAT_NEW(LTFAT_NAME(idgtreal_olablock_plan)));
+    p->W = W; p->bl = bl; p->glext = glext; p->a = a; p->M = M;
+    p->do_overwriteoutarray = params->do_synoverwrites;
+    CHECKMEM( p->cbuf = LTFAT_NAME_COMPLEX(calloc)((M / 2 + 1) * (Lext / a) * W));
+    CHECKMEM( p->buf = LTFAT_NAME_REAL(malloc)(Lext * W));
+    CHECKMEM( gext = LTFAT_NAME_REAL(malloc)(Lext));
+    LTFAT_NAME(fir2long)(g, gl, Lext, gext);
+
+    CHECKSTATUS(
+        LTFAT_NAME(idgtreal_long_init)( gext, Lext, W, a, M, p->cbuf, p->buf,
+                                        params->ptype, params->fftw_flags, &p->plan));
+    LTFAT_NAME(idgtreal_long_set_overwriteoutarray)(p->plan, 1);
+    CHECKSTATUS(
+        LTFAT_NAME(idgtreal_long_set_numthreads)(p->plan, params->nthreads));
+
+    ltfat_free(gext);
+    *pout = p;
+    return status;
+error:
+    ltfat_safefree(gext);
+    if (p) LTFAT_NAME(idgtreal_olablock_done)(&p);
+    return status;
+}
+
+int
+LTFAT_NAME(idgtreal_olablock_execute)(LTFAT_NAME(idgtreal_olablock_plan)* p,
+                                      const LTFAT_COMPLEX c[], ltfat_int L, ltfat_int W,
+                                      LTFAT_REAL f[])
+{
+    return LTFAT_NAME(idgtreal_ola_blocks)(p->plan, NULL, p->cbuf, p->buf, p->bl,
+                                           p->glext, p->a, p->M,
+                                           p->do_overwriteoutarray, c, L, W, f);
+}
+
+static size_t
+LTFAT_NAME(idgtreal_olablock_ws_carve)(const LTFAT_NAME(idgtreal_olablock_plan)* p,
+                                       char* base, LTFAT_COMPLEX** cbuf,
+                                       LTFAT_REAL** buf, void** lws)
+{
+    size_t off = 0;
+    ltfat_int Lext = p->bl + p->glext, W = p->W;
+
+    *cbuf = (LTFAT_COMPLEX*) ltfat_ws_take(base, &off,
+                                           (p->M / 2 + 1) * (Lext / p->a) * W *
+                                           sizeof(LTFAT_COMPLEX));
+    *buf = (LTFAT_REAL*) ltfat_ws_take(base, &off, Lext * W * sizeof(LTFAT_REAL));
+    *lws = ltfat_ws_take(base, &off,
+                         LTFAT_NAME(idgtreal_long_get_workspace_size)(p->plan));
+    return off;
+}
+
+size_t
+LTFAT_NAME(idgtreal_olablock_get_workspace_size)(
+    const LTFAT_NAME(idgtreal_olablock_plan)* p)
+{
+    LTFAT_REAL* buf; LTFAT_COMPLEX* cbuf; void* lws;
+    if (!p) return 0;
+    return ltfat_ws_size(
+               LTFAT_NAME(idgtreal_olablock_ws_carve)(p, NULL, &cbuf, &buf, &lws));
 }
 
+int
+LTFAT_NAME(idgtreal_olablock_execute_ws)(const LTFAT_NAME(idgtreal_olablock_plan)* p,
+        const LTFAT_COMPLEX c[], ltfat_int L, ltfat_int W,
+        LTFAT_REAL f[], void* ws)
+{
+    LTFAT_REAL* buf; LTFAT_COMPLEX* cbuf; void* lws;
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(p); CHECKNULL(ws);
+
+    LTFAT_NAME(idgtreal_olablock_ws_carve)(p, ltfat_ws_begin(ws), &cbuf, &buf, &lws);
+    return LTFAT_NAME(idgtreal_ola_blocks)(p->plan, lws, cbuf, buf, p->bl,
+                                           p->glext, p->a, p->M,
+                                           p->do_overwriteoutarray, c, L, W, f);
+error:
+    return status;
+}
 
+int
+LTFAT_NAME(idgtreal_olablock_done)(LTFAT_NAME(idgtreal_olablock_plan)** p)
+{
+    LTFAT_NAME(idgtreal_olablock_plan)* pp = *p;
+    if (pp->plan) LTFAT_NAME(idgtreal_long_done)(&pp->plan);
+    LTFAT_SAFEFREEALL(pp->buf, pp->cbuf);
+    ltfat_free(pp);
+    *p = NULL;
+    return LTFATERR_SUCCESS;
+}
 
 LTFAT_API LTFAT_NAME(dgtreal_ola_plan)
 LTFAT_NAME(dgtreal_ola_init)(const LTFAT_REAL* g, ltfat_int gl,
@@ -162,22 +604,12 @@ LTFAT_NAME(dgtreal_ola_init)(const LTFAT_REAL* g, ltfat_int gl,
     ltfat_int Lext    = bl + gl;
     ltfat_int Nblocke = Lext / a;
 
-    plan.buf  = (LTFAT_REAL*) ltfat_malloc(Lext * W * sizeof(LTFAT_REAL));
-    plan.gext = (LTFAT_REAL*) ltfat_malloc(Lext * sizeof(LTFAT_REAL));
-    plan.cbuf = (LTFAT_COMPLEX*) ltfat_malloc(M2 * Nblocke * W * sizeof(
-                    LTFAT_COMPLEX));
+    plan.buf  = LTFAT_NAME_REAL(calloc)(Lext * W);
+    plan.gext = LTFAT_NAME_REAL(malloc)(Lext);
+    plan.cbuf = LTFAT_NAME_COMPLEX(malloc)(M2 * Nblocke * W);
 
     LTFAT_NAME_REAL(fir2long)(g, gl, Lext, plan.gext);
 
-    /* Zero the last part of the buffer, it will always be zero. */
-    for (ltfat_int w = 0; w < W; w++)
-    {
-        for (ltfat_int jj = bl; jj < Lext; jj++)
-        {
-            plan.buf[jj + w * Lext] = 0.0;
-        }
-    }
-
     LTFAT_NAME(dgtreal_long_init)( (const LTFAT_REAL*)plan.gext,
                                    Lext, W, a, M, (const LTFAT_REAL*)plan.buf,
                                    plan.cbuf, ptype, flags, &plan.plan);
@@ -186,96 +618,15 @@ LTFAT_NAME(dgtreal_ola_init)(const LTFAT_REAL* g, ltfat_int gl,
 
 }
 
-
-
-
-
-
-
 LTFAT_API void
 LTFAT_NAME(dgtreal_ola_execute)(const LTFAT_NAME(dgtreal_ola_plan) plan,
                                 const LTFAT_REAL* f, ltfat_int L,
                                 LTFAT_COMPLEX* cout)
 
 {
-    ltfat_int bl      = plan.bl;
-    ltfat_int gl      = plan.gl;
-    ltfat_int a       = plan.plan->a;
-    ltfat_int M       = plan.plan->M;
-    ltfat_int N       = L / a;
-    ltfat_int Lext    = bl + gl;
-    ltfat_int Nb      = L / bl;
-    ltfat_int b2      = gl / a / 2;
-    ltfat_int Nblock  = bl / a;
-    ltfat_int Nblocke = Lext / a;
-    ltfat_int W       = plan.W;
-    ltfat_int M2      = M / 2 + 1;
-
-    /* Zero the output array, as we will be adding to it */
-    for (ltfat_int ii = 0; ii < M2 * N * W; ii++)
-    {
-        cout[ii] = (LTFAT_COMPLEX) 0.0;
-    }
-
-
-    for (ltfat_int ii = 0; ii < Nb; ii++)
-    {
-        ltfat_int s_ii;
-
-        /* Copy to working buffer. */
-        for (ltfat_int w = 0; w < W; w++)
-        {
-            memcpy(plan.buf + Lext * w, f + ii * bl + w * L, sizeof(LTFAT_REAL)*bl);
-        }
-
-        /* Execute the short DGTREAL */
-        LTFAT_NAME(dgtreal_long_execute)(plan.plan);
-
-        /* Place the results */
-        for (ltfat_int w = 0; w < W; w++)
-        {
-            LTFAT_COMPLEX* cout_p;
-            LTFAT_COMPLEX* cbuf_p;
-
-            /* Place large block */
-            cout_p = cout + ii * M2 * Nblock + w * M2 * N ;
-            cbuf_p = plan.cbuf +             w * M2 * Nblocke;
-            for (ltfat_int m = 0; m < M2; m++)
-            {
-                for (ltfat_int n = 0; n < Nblock; n++)
-                {
-                    cout_p[m + n * M2] += cbuf_p[m + n * M2];
-                }
-            }
-
-            /* Small block + */
-            s_ii = ltfat_positiverem(ii + 1, Nb);
-            cout_p = cout + s_ii * M2 * Nblock + w * M2 * N ;
-            cbuf_p = plan.cbuf +      M2 * Nblock + w * M2 * Nblocke;
-            for (ltfat_int m = 0; m < M2; m++)
-            {
-                for (ltfat_int n = 0; n < b2; n++)
-                {
-                    cout_p[m + n * M2] += cbuf_p[m + n * M2];
-                }
-            }
-
-
-            /* Small block - */
-            s_ii = ltfat_positiverem(ii - 1, Nb) + 1;
-            cout_p = cout + M2 * (s_ii * Nblock - b2) + w * M2 * N ;
-            cbuf_p = plan.cbuf + M2 * (     Nblock + b2) + w * M2 * Nblocke;
-            for (ltfat_int m = 0; m < M2; m++)
-            {
-                for (ltfat_int n = 0; n < b2; n++)
-                {
-                    cout_p[m + n * M2] += cbuf_p[m + n * M2];
-                }
-            }
-
-        }
-
-    }
+    LTFAT_NAME(dgtreal_ola_blocks)(plan.plan, NULL, plan.buf, plan.cbuf, plan.bl, plan.gl,
+                                   plan.plan->a, plan.plan->M,
+                                   f, L, plan.W, cout);
 }
 
 
@@ -285,3 +636,5 @@ LTFAT_NAME(dgtreal_ola_done)(LTFAT_NAME(dgtreal_ola_plan) plan)
     LTFAT_NAME(dgtreal_long_done)(&plan.plan);
     LTFAT_SAFEFREEALL(plan.cbuf, plan.gext, plan.buf);
 }
+
+#endif
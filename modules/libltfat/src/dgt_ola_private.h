@@ -0,0 +1,133 @@
+#ifndef _ltfat_dgt_ola_private_h
+#define _ltfat_dgt_ola_private_h
+#include "dgtwrapper_private.h"
+
+/* Overlap-add plans used by the ltfat_dgt_ola hint of the wrappers, see
+ * dgt_ola.c. The window is given as in dgt_init and the block length is
+ * chosen by ltfat_dgt_ola_blocklength(). */
+typedef struct
+{
+    LTFAT_NAME(dgt_long_plan)* plan;
+    ltfat_int bl;
+    ltfat_int glext;
+    ltfat_int a;
+    ltfat_int M;
+    LTFAT_TYPE* buf; //!< Extended block, the last glext samples stay zero
+    LTFAT_COMPLEX* cbuf;
+} LTFAT_NAME(dgt_olablock_plan);
+
+typedef struct
+{
+    LTFAT_NAME(idgt_long_plan)* plan;
+    ltfat_int bl;
+    ltfat_int glext;
+    ltfat_int a;
+    ltfat_int M;
+    int do_overwriteoutarray;
+    LTFAT_COMPLEX* cbuf; //!< Coefficients of a block, the last glext/a frames stay zero
+    LTFAT_COMPLEX* buf;
+} LTFAT_NAME(idgt_olablock_plan);
+
+int
+LTFAT_NAME(dgt_olablock_init)(const LTFAT_TYPE g[], ltfat_int gl, ltfat_int L,
+                              ltfat_int W, ltfat_int a, ltfat_int M,
+                              ltfat_dgt_params* params,
+                              LTFAT_NAME(dgt_olablock_plan)** p);
+
+int
+LTFAT_NAME(dgt_olablock_execute)(LTFAT_NAME(dgt_olablock_plan)* p,
+                                 const LTFAT_TYPE f[], ltfat_int L, ltfat_int W,
+                                 LTFAT_COMPLEX c[]);
+
+int
+LTFAT_NAME(dgt_olablock_done)(LTFAT_NAME(dgt_olablock_plan)** p);
+
+int
+LTFAT_NAME(idgt_olablock_init)(const LTFAT_TYPE g[], ltfat_int gl, ltfat_int L,
+                               ltfat_int W, ltfat_int a, ltfat_int M,
+                               ltfat_dgt_params* params,
+                               LTFAT_NAME(idgt_olablock_plan)** p);
+
+int
+LTFAT_NAME(idgt_olablock_execute)(LTFAT_NAME(idgt_olablock_plan)* p,
+                                  const LTFAT_COMPLEX c[], ltfat_int L, ltfat_int W,
+                                  LTFAT_COMPLEX f[]);
+
+int
+LTFAT_NAME(idgt_olablock_done)(LTFAT_NAME(idgt_olablock_plan)** p);
+
+#ifndef LTFAT_COMPLEXTYPE
+typedef struct
+{
+    LTFAT_NAME(dgtreal_long_plan)* plan;
+    ltfat_int W;
+    ltfat_int bl;
+    ltfat_int glext;
+    ltfat_int a;
+    ltfat_int M;
+    LTFAT_REAL* buf; //!< Extended block, the last glext samples stay zero
+    LTFAT_COMPLEX* cbuf;
+} LTFAT_NAME(dgtreal_olablock_plan);
+
+typedef struct
+{
+    LTFAT_NAME(idgtreal_long_plan)* plan;
+    ltfat_int W;
+    ltfat_int bl;
+    ltfat_int glext;
+    ltfat_int a;
+    ltfat_int M;
+    int do_overwriteoutarray;
+    LTFAT_COMPLEX* cbuf; //!< Coefficients of a block, the last glext/a frames stay zero
+    LTFAT_REAL* buf;
+} LTFAT_NAME(idgtreal_olablock_plan);
+
+int
+LTFAT_NAME(dgtreal_olablock_init)(const LTFAT_REAL g[], ltfat_int gl, ltfat_int L,
+                                  ltfat_int W, ltfat_int a, ltfat_int M,
+                                  ltfat_dgt_params* params,
+                                  LTFAT_NAME(dgtreal_olablock_plan)** p);
+
+int
+LTFAT_NAME(dgtreal_olablock_execute)(LTFAT_NAME(dgtreal_olablock_plan)* p,
+                                     const LTFAT_REAL f[], ltfat_int L, ltfat_int W,
+                                     LTFAT_COMPLEX c[]);
+
+/* The plan is only read, see dgtreal_long_execute_ws */
+size_t
+LTFAT_NAME(dgtreal_olablock_get_workspace_size)(
+    const LTFAT_NAME(dgtreal_olablock_plan)* p);
+
+int
+LTFAT_NAME(dgtreal_olablock_execute_ws)(const LTFAT_NAME(dgtreal_olablock_plan)* p,
+                                        const LTFAT_REAL f[], ltfat_int L, ltfat_int W,
+                                        LTFAT_COMPLEX c[], void* ws);
+
+int
+LTFAT_NAME(dgtreal_olablock_done)(LTFAT_NAME(dgtreal_olablock_plan)** p);
+
+int
+LTFAT_NAME(idgtreal_olablock_init)(const LTFAT_REAL g[], ltfat_int gl, ltfat_int L,
+                                   ltfat_int W, ltfat_int a, ltfat_int M,
+                                   ltfat_dgt_params* params,
+                                   LTFAT_NAME(idgtreal_olablock_plan)** p);
+
+int
+LTFAT_NAME(idgtreal_olablock_execute)(LTFAT_NAME(idgtreal_olablock_plan)* p,
+                                      const LTFAT_COMPLEX c[], ltfat_int L, ltfat_int W,
+                                      LTFAT_REAL f[]);
+
+size_t
+LTFAT_NAME(idgtreal_olablock_get_workspace_size)(
+    const LTFAT_NAME(idgtreal_olablock_plan)* p);
+
+int
+LTFAT_NAME(idgtreal_olablock_execute_ws)(const LTFAT_NAME(idgtreal_olablock_plan)* p,
+        const LTFAT_COMPLEX c[], ltfat_int L, ltfat_int W,
+        LTFAT_REAL f[], void* ws);
+
+int
+LTFAT_NAME(idgtreal_olablock_done)(LTFAT_NAME(idgtreal_olablock_plan)** p);
+#endif
+
+#endif
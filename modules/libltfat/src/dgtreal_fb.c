@@ -1,21 +1,34 @@
 #include "ltfat.h"
 #include "ltfat/types.h"
 #include "ltfat/macros.h"
+#include "dgt_fb_private.h"
+#include "threads_private.h"
+#include "workspace_private.h"
 
 #include "ltfat/thirdparty/fftw3.h"
 
+/* Buffers and FFT plan used by a single thread. fftwork is the FFT
+ * scratch, NULL for the one owned by the FFT plan. */
+typedef struct
+{
+    LTFAT_NAME_REAL(fftreal_plan)* p_small;
+    LTFAT_REAL*    sbuf;
+    LTFAT_COMPLEX* cbuf;
+    LTFAT_REAL*    fw;
+    void*          fftwork;
+} LTFAT_NAME(dgtreal_fb_scratch);
+
 struct LTFAT_NAME(dgtreal_fb_plan)
 {
     ltfat_int a;
     ltfat_int M;
     ltfat_int gl;
     ltfat_phaseconvention ptype;
-    LTFAT_NAME_REAL(fftreal_plan)* p_small;
-    LTFAT_REAL*    sbuf;
-    LTFAT_COMPLEX* cbuf;
-    LTFAT_REAL* fw;
+    unsigned flags;
+    ltfat_int blocksize;
+    int nthreads;
+    LTFAT_NAME(dgtreal_fb_scratch)* scratch;
     LTFAT_REAL* gw;
-    LTFAT_COMPLEX* cout;
 };
 
 LTFAT_API int
@@ -39,6 +52,59 @@ error:
     return status;
 }
 
+static void
+LTFAT_NAME(dgtreal_fb_scratch_free)(LTFAT_NAME(dgtreal_fb_scratch)* scratch,
+                                    int nthreads)
+{
+    for (int t = 0; t < nthreads; t++)
+    {
+        if (scratch[t].p_small)
+            LTFAT_NAME_REAL(fftreal_done)(&scratch[t].p_small);
+        LTFAT_SAFEFREEALL(scratch[t].sbuf, scratch[t].cbuf, scratch[t].fw);
+    }
+    ltfat_free(scratch);
+}
+
+static int
+LTFAT_NAME(dgtreal_fb_scratch_realloc)(LTFAT_NAME(dgtreal_fb_plan)* p,
+                                       ltfat_int K, int nthreads)
+{
+    LTFAT_NAME(dgtreal_fb_scratch)* scratch = NULL;
+    unsigned flags = p->flags;
+    /* This is a floor operation. */
+    ltfat_int M2 = p->M / 2 + 1;
+    int status = LTFATERR_SUCCESS;
+
+    if (K == p->blocksize && nthreads == p->nthreads)
+        return status;
+
+    /* Frames are already processed in parallel */
+    if (nthreads > 1)
+        flags &= ~LTFAT_FFT_NTHREADS(0xFF);
+
+    CHECKMEM( scratch = LTFAT_NEWARRAY(LTFAT_NAME(dgtreal_fb_scratch), nthreads));
+
+    for (int t = 0; t < nthreads; t++)
+    {
+        CHECKMEM( scratch[t].fw   = LTFAT_NAME_REAL(malloc)(p->gl));
+        CHECKMEM( scratch[t].sbuf = LTFAT_NAME_REAL(malloc)(p->M * K));
+        CHECKMEM( scratch[t].cbuf = LTFAT_NAME_COMPLEX(malloc)(M2 * K));
+        CHECKSTATUS(
+            LTFAT_NAME_REAL(fftreal_init)(p->M, K, scratch[t].sbuf, scratch[t].cbuf,
+                                          flags, &scratch[t].p_small));
+    }
+
+    if (p->scratch)
+        LTFAT_NAME(dgtreal_fb_scratch_free)(p->scratch, p->nthreads);
+    p->scratch = scratch;
+    p->blocksize = K;
+    p->nthreads = nthreads;
+    return status;
+error:
+    if (scratch) LTFAT_NAME(dgtreal_fb_scratch_free)(scratch, nthreads);
+    return status;
+}
+
 LTFAT_API int
 LTFAT_NAME(dgtreal_fb_init)(const LTFAT_REAL* g,
                             ltfat_int gl, ltfat_int a,
@@ -46,7 +112,6 @@ LTFAT_NAME(dgtreal_fb_init)(const LTFAT_REAL* g,
                             unsigned flags, LTFAT_NAME(dgtreal_fb_plan)** pout)
 {
     LTFAT_NAME(dgtreal_fb_plan)* plan = NULL;
-    ltfat_int M2;
     int status = LTFATERR_SUCCESS;
     CHECKNULL(g); CHECKNULL(pout);
     CHECK(LTFATERR_BADSIZE, gl > 0, "gl must be positive");
@@ -59,18 +124,13 @@ LTFAT_NAME(dgtreal_fb_init)(const LTFAT_REAL* g,
 
     plan->a = a;
     plan->M = M;
-    M2 = M / 2 + 1;
     plan->gl = gl;
     plan->ptype = ptype;
+    plan->flags = flags;
 
     CHECKMEM( plan->gw   = LTFAT_NAME_REAL(malloc)(gl));
-    CHECKMEM( plan->fw   = LTFAT_NAME_REAL(malloc)(gl));
-    CHECKMEM( plan->sbuf = LTFAT_NAME_REAL(malloc)(M));
-    CHECKMEM( plan->cbuf = LTFAT_NAME_COMPLEX(malloc)(M2));
 
-    CHECKSTATUS(
-        LTFAT_NAME_REAL(fftreal_init)(M, 1, plan->sbuf, plan->cbuf, flags,
-                                      &plan->p_small));
+    CHECKSTATUS( LTFAT_NAME(dgtreal_fb_scratch_realloc)(plan, 1, 1));
 
     LTFAT_NAME(fftshift)(g, gl, plan->gw);
 
@@ -81,6 +141,36 @@ error:
     return status;
 }
 
+LTFAT_API int
+LTFAT_NAME(dgtreal_fb_set_blocksize)(LTFAT_NAME(dgtreal_fb_plan)* p,
+                                     ltfat_int blocksize)
+{
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(p);
+    CHECK(LTFATERR_BADARG, blocksize >= 0,
+          "blocksize (passed %td) must be nonnegative.", blocksize);
+
+    return LTFAT_NAME(dgtreal_fb_scratch_realloc)(
+               p, ltfat_dgt_fb_blocksize(p->M, blocksize), p->nthreads);
+error:
+    return status;
+}
+
+LTFAT_API int
+LTFAT_NAME(dgtreal_fb_set_numthreads)(LTFAT_NAME(dgtreal_fb_plan)* p,
+                                      int nthreads)
+{
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(p);
+    CHECK(LTFATERR_NOTINRANGE, nthreads >= 0 && nthreads <= LTFAT_MAXTHREADS,
+          "nthreads (passed %d) must be in range 0-%d.", nthreads, LTFAT_MAXTHREADS);
+
+    return LTFAT_NAME(dgtreal_fb_scratch_realloc)(
+               p, p->blocksize, nthreads ? nthreads : ltfat_get_num_threads());
+error:
+    return status;
+}
+
 LTFAT_API int
 LTFAT_NAME(dgtreal_fb_done)(LTFAT_NAME(dgtreal_fb_plan)** plan)
 {
@@ -88,41 +178,79 @@ LTFAT_NAME(dgtreal_fb_done)(LTFAT_NAME(dgtreal_fb_plan)** plan)
     int status = LTFATERR_SUCCESS;
     CHECKNULL(plan); CHECKNULL(*plan);
     pp = *plan;
-    LTFAT_SAFEFREEALL(pp->sbuf, pp->cbuf, pp->gw, pp->fw);
-    if (pp->p_small) LTFAT_NAME_REAL(fftreal_done)(&pp->p_small);
+    if (pp->scratch)
+        LTFAT_NAME(dgtreal_fb_scratch_free)(pp->scratch, pp->nthreads);
+    ltfat_safefree(pp->gw);
     ltfat_free(pp);
     pp = NULL;
 error:
     return status;
 }
 
-/* #define THE_SUM_REAL { \ */
-/* ltfat_int premarg = plan.ptype?-glh:n*a-glh; \ */
-/* for (ltfat_int m=0;m<M;m++) \ */
-/* { \ */
-/*    rem = ltfat_positiverem(m+(premarg), M); \ */
-/*    sbuf[rem]=0.0; \ */
-/*    fbd=fw+m; \ */
-/*    for (ltfat_int k=0;k<gl/M;k++) \ */
-/*    { \ */
-/*      sbuf[rem]+=(*fbd);         \ */
-/*       fbd+=M; \ */
-/*    } \ */
-/* } \ */
-/* \ */
-/*  LTFAT_FFTW(execute)(plan.p_small);         \ */
-/* \ */
-/* coefsum=(LTFAT_REAL*)cout+2*(n*M2+w*M2*N); \ */
-/* for (ltfat_int m=0;m<M2;m++) \ */
-/* { \ */
-/*    coefsum[2*m]   = CH(creal)(cbuf[m]); \ */
-/*    coefsum[2*m+1] = CH(cimag)(cbuf[m]); \ */
-/* }} */
-
-#define THE_SUM_REAL { \
-LTFAT_NAME(fold_array)(fw,gl,plan->ptype==LTFAT_TIMEINV?-glh:n*a-glh,M,sbuf); \
-LTFAT_NAME_REAL(fftreal_execute)(plan->p_small); \
-memcpy(cout+(n*M2+w*M2*N),cbuf,M2*sizeof*cbuf); \
+/* Multiplies frame n of a single channel with the window.
+ * The frame wraps around the end of the signal close to the boundaries.
+ */
+static void
+LTFAT_NAME(dgtreal_fb_windowframe)(const LTFAT_NAME(dgtreal_fb_plan)* p,
+                                   const LTFAT_REAL* fchan, ltfat_int L,
+                                   ltfat_int n, LTFAT_REAL* fw)
+{
+    ltfat_int gl = p->gl;
+    ltfat_int sp = ltfat_positiverem(n * p->a - gl / 2, L);
+    ltfat_int glfirst = ltfat_imin(gl, L - sp);
+
+    for (ltfat_int l = 0; l < glfirst; l++)
+        fw[l] = fchan[sp + l] * p->gw[l];
+
+    for (ltfat_int l = glfirst; l < gl; l++)
+        fw[l] = fchan[l - glfirst] * p->gw[l];
+}
+
+typedef struct
+{
+    const LTFAT_NAME(dgtreal_fb_plan)* p;
+    const LTFAT_REAL* f;
+    ltfat_int L;
+    ltfat_int N;
+    ltfat_int nblocks;
+    LTFAT_COMPLEX* cout;
+} LTFAT_NAME(dgtreal_fb_job);
+
+/* Frames are folded into consecutive columns of sbuf and transformed
+ * p->blocksize at a time, see dgt_fb_execute_blocks.
+ */
+static void
+LTFAT_NAME(dgtreal_fb_execute_blocks)(void* userdata, ltfat_int start,
+                                      ltfat_int end, int threadid)
+{
+    LTFAT_NAME(dgtreal_fb_job)* job = (LTFAT_NAME(dgtreal_fb_job)*) userdata;
+    const LTFAT_NAME(dgtreal_fb_plan)* p = job->p;
+    LTFAT_NAME(dgtreal_fb_scratch)* s = &p->scratch[threadid];
+    ltfat_int L = job->L, N = job->N, a = p->a, M = p->M, K = p->blocksize;
+    ltfat_int gl = p->gl, glh = p->gl / 2;
+    /* This is a floor operation. */
+    ltfat_int M2 = M / 2 + 1;
+
+    for (ltfat_int b = start; b < end; b++)
+    {
+        ltfat_int w = b / job->nblocks;
+        ltfat_int nstart = (b % job->nblocks) * K;
+        ltfat_int nK = ltfat_imin(K, N - nstart);
+        const LTFAT_REAL* fchan = job->f + w * L;
+
+        for (ltfat_int k = 0; k < nK; k++)
+        {
+            ltfat_int n = nstart + k;
+            LTFAT_NAME(dgtreal_fb_windowframe)(p, fchan, L, n, s->fw);
+            LTFAT_NAME(fold_array)(
+                s->fw, gl, p->ptype == LTFAT_TIMEINV ? -glh : n * a - glh,
+                M, s->sbuf + k * M);
+        }
+
+        LTFAT_NAME_REAL(fftreal_execute_ws)(s->p_small, s->sbuf, s->cbuf, s->fftwork);
+        memcpy(job->cout + w * M2 * N + nstart * M2, s->cbuf,
+               nK * M2 * sizeof * job->cout);
+    }
 }
 
 LTFAT_API int
@@ -131,10 +259,7 @@ LTFAT_NAME(dgtreal_fb_execute)(LTFAT_NAME(dgtreal_fb_plan)* plan,
                                ltfat_int L, ltfat_int W,
                                LTFAT_COMPLEX* cout)
 {
-    ltfat_int a, M, M2, N, gl, glh, glh_d_a;
-    LTFAT_REAL* sbuf, *fw;
-    const LTFAT_REAL* fbd;
-    LTFAT_COMPLEX* cbuf;
+    LTFAT_NAME(dgtreal_fb_job) job;
     int status = LTFATERR_SUCCESS;
     CHECKNULL(plan); CHECKNULL(f); CHECKNULL(cout);
     CHECK(LTFATERR_BADSIZE, L > 0, "L must be positive");
@@ -143,75 +268,64 @@ LTFAT_NAME(dgtreal_fb_execute)(LTFAT_NAME(dgtreal_fb_plan)* plan,
           L, plan->a);
     CHECK(LTFATERR_NOTPOSARG, W > 0, "W must be positive");
 
-    /*  --------- initial declarations -------------- */
-    a = plan->a;
-    M = plan->M;
-    N = L / a;
-
-    gl = plan->gl;
-    sbuf = plan->sbuf;
-    cbuf = plan->cbuf;
-    fw = plan->fw;
-
-    /* These are floor operations. */
-    glh = plan->gl / 2;
-    M2 = M / 2 + 1;
-
+    job.p = plan; job.f = f; job.L = L; job.cout = cout;
+    job.N = L / plan->a;
     /* This is a ceil operation. */
-    glh_d_a = (ltfat_int)ceil((glh * 1.0) / (a));
-
-    /*  ---------- main body ----------- */
-
-    /*----- Handle the first boundary using periodic boundary conditions.*/
-    for (ltfat_int n = 0; n < glh_d_a; n++)
-    {
-        for (ltfat_int w = 0; w < W; w++)
-        {
-            fbd = f + L - (glh - n * a) + L * w;
-            for (ltfat_int l = 0; l < glh - n * a; l++)
-                fw[l]  = fbd[l] * plan->gw[l];
-
-            fbd = f - (glh - n * a) + L * w;
-            for (ltfat_int l = glh - n * a; l < gl; l++)
-                fw[l]  = fbd[l] * plan->gw[l];
+    job.nblocks = (job.N + plan->blocksize - 1) / plan->blocksize;
 
-            THE_SUM_REAL
-        }
-    }
-
-    /* ----- Handle the middle case. --------------------- */
-    for (ltfat_int n = glh_d_a; n < (L - (gl + 1) / 2) / a + 1; n++)
-    {
-        for (ltfat_int w = 0; w < W; w++)
-        {
-            fbd = f + (n * a - glh + L * w);
-            for (ltfat_int l = 0; l < gl; l++)
-                fw[l]  = fbd[l] * plan->gw[l];
+    ltfat_parallel_for(plan->nthreads, W * job.nblocks,
+                       LTFAT_NAME(dgtreal_fb_execute_blocks), &job);
+error:
+    return status;
+}
 
-            THE_SUM_REAL
-        }
+/* Takes the buffers of a single-threaded scratch from the workspace at
+ * base, or only counts their size if base is NULL */
+static size_t
+LTFAT_NAME(dgtreal_fb_ws_carve)(const LTFAT_NAME(dgtreal_fb_plan)* p, char* base,
+                                LTFAT_NAME(dgtreal_fb_scratch)* sc)
+{
+    ltfat_int M2 = p->M / 2 + 1;
+    size_t off = 0;
+
+    *sc = p->scratch[0];
+    sc->fw = (LTFAT_REAL*) ltfat_ws_take(base, &off, p->gl * sizeof(LTFAT_REAL));
+    sc->sbuf = (LTFAT_REAL*) ltfat_ws_take(base, &off,
+                                           p->M * p->blocksize * sizeof(LTFAT_REAL));
+    sc->cbuf = (LTFAT_COMPLEX*) ltfat_ws_take(base, &off,
+                                              M2 * p->blocksize * sizeof(LTFAT_COMPLEX));
+    sc->fftwork = ltfat_ws_take(base, &off,
+                                LTFAT_NAME_REAL(fftreal_get_workspace_size)(sc->p_small));
+    return off;
+}
 
-    }
+LTFAT_API size_t
+LTFAT_NAME(dgtreal_fb_get_workspace_size)(const LTFAT_NAME(dgtreal_fb_plan)* p)
+{
+    LTFAT_NAME(dgtreal_fb_scratch) sc;
+    if (!p) return 0;
+    return ltfat_ws_size(LTFAT_NAME(dgtreal_fb_ws_carve)(p, NULL, &sc));
+}
 
-    /* Handle the last boundary using periodic boundary conditions. */
-    for (ltfat_int n = (L - (gl + 1) / 2) / a + 1; n < N; n++)
-    {
-        for (ltfat_int w = 0; w < W; w++)
-        {
-            fbd = f + (n * a - glh + L * w);
-            for (ltfat_int l = 0; l < L - n * a + glh; l++)
-                fw[l]  = fbd[l] * plan->gw[l];
+LTFAT_API int
+LTFAT_NAME(dgtreal_fb_execute_ws)(const LTFAT_NAME(dgtreal_fb_plan)* p,
+                                  const LTFAT_REAL* f,
+                                  ltfat_int L, ltfat_int W,
+                                  LTFAT_COMPLEX* cout, void* ws)
+{
+    LTFAT_NAME(dgtreal_fb_plan) p2;
+    LTFAT_NAME(dgtreal_fb_scratch) sc;
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(p); CHECKNULL(ws);
 
-            fbd = f - (L - n * a + glh) + L * w;
-            for (ltfat_int l = L - n * a + glh; l < gl; l++)
-                fw[l]  = fbd[l] * plan->gw[l];
+    LTFAT_NAME(dgtreal_fb_ws_carve)(p, ltfat_ws_begin(ws), &sc);
 
-            THE_SUM_REAL
-        }
-    }
+    // Shallow copy running single-threaded on the workspace
+    p2 = *p;
+    p2.nthreads = 1;
+    p2.scratch = &sc;
 
+    return LTFAT_NAME(dgtreal_fb_execute)(&p2, f, L, W, cout);
 error:
     return status;
 }
-
-#undef THE_SUM_REAL
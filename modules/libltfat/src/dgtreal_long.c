@@ -1,4 +1,15 @@
 #include "dgtreal_long_private.h"
+#include "threads_private.h"
+#include "walnut_private.h"
+#include "wfaccache_private.h"
+#include "workspace_private.h"
+
+/* Job shared by the threads of a single dgtreal_walnut_plan call */
+typedef struct
+{
+    LTFAT_NAME(dgtreal_long_plan)* p;
+    ltfat_int r;
+} LTFAT_NAME(dgtreal_walnut_job);
 
 LTFAT_API int
 LTFAT_NAME(dgtreal_long)(const LTFAT_REAL* f, const LTFAT_REAL* g,
@@ -24,6 +35,78 @@ error:
     return status;
 }
 
+static void
+LTFAT_NAME(dgtreal_long_scratch_free)(LTFAT_NAME(dgtreal_long_scratch)* scratch,
+                                      int nthreads)
+{
+    for (int t = 0; t < nthreads; t++)
+    {
+        if (scratch[t].p_before) LTFAT_NAME(fftreal_done)(&scratch[t].p_before);
+        if (scratch[t].p_after) LTFAT_NAME(ifftreal_done)(&scratch[t].p_after);
+        LTFAT_SAFEFREEALL(scratch[t].sbuf, scratch[t].cbuf, scratch[t].gt,
+                          scratch[t].ff, scratch[t].cf);
+    }
+    ltfat_free(scratch);
+}
+
+/* Replaces the per-thread scratch such that it is prepared for nthreads
+ * threads. */
+static int
+LTFAT_NAME(dgtreal_long_scratch_realloc)(LTFAT_NAME(dgtreal_long_plan)* plan,
+        int nthreads)
+{
+    LTFAT_NAME(dgtreal_long_scratch)* scratch = NULL;
+    ltfat_int p = plan->a / plan->c;
+    ltfat_int q = plan->M / plan->c;
+    ltfat_int d = plan->L / plan->M / p;
+    ltfat_int d2 = d / 2 + 1;
+    unsigned flags = plan->flags;
+    int nbufs;
+    int status = LTFATERR_SUCCESS;
+
+    if (nthreads == plan->nthreads)
+        return status;
+
+    nbufs = ltfat_walnut_parallel_cosets(plan->c, nthreads) ? nthreads : 1;
+
+    /* The short FFTs are already done in parallel */
+    if (nthreads > 1)
+        flags &= ~LTFAT_FFT_NTHREADS(0xFF);
+
+    CHECKMEM( scratch = LTFAT_NEWARRAY(LTFAT_NAME(dgtreal_long_scratch),
+                                       nthreads));
+
+    for (int t = 0; t < nthreads; t++)
+    {
+        CHECKMEM( scratch[t].sbuf = LTFAT_NAME_REAL(malloc)(d));
+        CHECKMEM( scratch[t].cbuf = LTFAT_NAME_COMPLEX(malloc)(d2));
+        CHECKMEM( scratch[t].gt   = LTFAT_NAME_REAL(malloc)(2 * p * q));
+
+        if (t < nbufs)
+        {
+            CHECKMEM( scratch[t].ff = LTFAT_NAME_REAL(malloc)(2 * d2 * p * q * plan->W));
+            CHECKMEM( scratch[t].cf = LTFAT_NAME_REAL(malloc)(2 * d2 * q * q * plan->W));
+        }
+
+        CHECKSTATUS(
+            LTFAT_NAME(fftreal_init)(d, 1, scratch[t].sbuf, scratch[t].cbuf, flags,
+                                     &scratch[t].p_before));
+
+        CHECKSTATUS(
+            LTFAT_NAME(ifftreal_init)(d, 1, scratch[t].cbuf, scratch[t].sbuf, flags,
+                                      &scratch[t].p_after));
+    }
+
+    if (plan->scratch)
+        LTFAT_NAME(dgtreal_long_scratch_free)(plan->scratch, plan->nthreads);
+    plan->scratch = scratch;
+    plan->nthreads = nthreads;
+    return status;
+error:
+    if (scratch) LTFAT_NAME(dgtreal_long_scratch_free)(scratch, nthreads);
+    return status;
+}
+
 LTFAT_API int
 LTFAT_NAME(dgtreal_long_init)( const LTFAT_REAL* g,
                                ltfat_int L, ltfat_int W,
@@ -33,7 +116,7 @@ LTFAT_NAME(dgtreal_long_init)( const LTFAT_REAL* g,
                                unsigned flags, LTFAT_NAME(dgtreal_long_plan)** pout)
 {
     LTFAT_NAME(dgtreal_long_plan)* plan = NULL;
-    ltfat_int minL, N, h_m, b, p, q, d, d2, wfs;
+    ltfat_int minL, N, h_m;
 
     int status = LTFATERR_SUCCESS;
     CHECK(LTFATERR_NULLPOINTER, (flags & FFTW_ESTIMATE) || cout != NULL,
@@ -59,29 +142,19 @@ LTFAT_NAME(dgtreal_long_init)( const LTFAT_REAL* g,
     plan->L = L;
     plan->W = W;
     plan->ptype = ptype;
+    plan->flags = flags;
     N = L / a;
 
     plan->c = ltfat_gcd(a, M, &plan->h_a, &h_m);
-    b = L / M;
-    p = a / plan->c;
-    q = M / plan->c;
-    d = b / p;
     plan->h_a = -plan->h_a;
 
-    d2 = d / 2 + 1;
-    wfs = wfacreal_size(L, a, M);
-
     plan->cout = cout;
     plan->f    = f;
-    CHECKMEM( plan->sbuf = LTFAT_NAME_REAL(malloc)( d ));
-    CHECKMEM( plan->cbuf = LTFAT_NAME_COMPLEX(malloc)(d2));
-    CHECKMEM( plan->ff = LTFAT_NAME_REAL(malloc)(2 * d2 * p * q * W));
-    CHECKMEM( plan->cf = LTFAT_NAME_REAL(malloc)(2 * d2 * q * q * W));
-    CHECKMEM( plan->gf = LTFAT_NAME_COMPLEX(malloc)(wfs));
     //CHECKMEM( plan->cwork = (LTFAT_REAL*) LTFAT_NAME_COMPLEX(malloc)(M2 * N * W));
 
-    /* Get factorization of window */
-    LTFAT_NAME(wfacreal)(g, L, 1, a, M, plan->gf);
+    /* Get factorization of window, possibly shared with other plans */
+    CHECKSTATUS(
+        LTFAT_NAME(wfacreal_shared)(g, L, a, M, &plan->gf));
 
     /* Create plans. In-place. */
 
@@ -89,11 +162,7 @@ LTFAT_NAME(dgtreal_long_init)( const LTFAT_REAL* g,
         LTFAT_NAME(fftreal_init)(M, N * W,
                                  (LTFAT_REAL*) cout, cout, flags, &plan->p_veryend));
 
-    CHECKSTATUS(
-        LTFAT_NAME(fftreal_init)(d, 1, plan->sbuf, plan->cbuf, flags, &plan->p_before));
-
-    CHECKSTATUS(
-        LTFAT_NAME(ifftreal_init)(d, 1, plan->cbuf, plan->sbuf, flags, &plan->p_after));
+    CHECKSTATUS( LTFAT_NAME(dgtreal_long_scratch_realloc)(plan, 1));
 
     *pout = plan;
     return status;
@@ -102,6 +171,21 @@ error:
     return status;
 }
 
+LTFAT_API int
+LTFAT_NAME(dgtreal_long_set_numthreads)(LTFAT_NAME(dgtreal_long_plan)* plan,
+                                        int nthreads)
+{
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(plan);
+    CHECK(LTFATERR_NOTINRANGE, nthreads >= 0 && nthreads <= LTFAT_MAXTHREADS,
+          "nthreads (passed %d) must be in range 0-%d.", nthreads, LTFAT_MAXTHREADS);
+
+    return LTFAT_NAME(dgtreal_long_scratch_realloc)(
+               plan, nthreads ? nthreads : ltfat_get_num_threads());
+error:
+    return status;
+}
+
 LTFAT_API int
 LTFAT_NAME(dgtreal_long_done)(LTFAT_NAME(dgtreal_long_plan)** plan)
 {
@@ -110,10 +194,9 @@ LTFAT_NAME(dgtreal_long_done)(LTFAT_NAME(dgtreal_long_plan)** plan)
     CHECKNULL(plan); CHECKNULL(*plan);
     pp = *plan;
     if (pp->p_veryend) LTFAT_NAME(fftreal_done)(&pp->p_veryend);
-    if (pp->p_before)  LTFAT_NAME(fftreal_done)(&pp->p_before);
-    if (pp->p_after)   LTFAT_NAME(ifftreal_done)(&pp->p_after);
-    LTFAT_SAFEFREEALL(pp->sbuf, pp->cbuf,// pp->cwork,
-                      pp->gf, pp->ff, pp->cf);
+    if (pp->scratch)
+        LTFAT_NAME(dgtreal_long_scratch_free)(pp->scratch, pp->nthreads);
+    ltfat_wfac_cache_release(pp->gf);
     ltfat_free(pp);
     pp = NULL;
 error:
@@ -170,6 +253,78 @@ error:
     return status;
 }
 
+/* Takes the buffers of a single-threaded scratch from the workspace at
+ * base, or only counts their size if base is NULL */
+static size_t
+LTFAT_NAME(dgtreal_long_ws_carve)(const LTFAT_NAME(dgtreal_long_plan)* plan,
+                                  char* base, LTFAT_NAME(dgtreal_long_scratch)* sc)
+{
+    const LTFAT_NAME(dgtreal_long_scratch)* sc0 = plan->scratch;
+    ltfat_int p = plan->a / plan->c;
+    ltfat_int q = plan->M / plan->c;
+    ltfat_int d = plan->L / plan->M / p;
+    ltfat_int d2 = d / 2 + 1;
+    size_t fftws, off = 0;
+
+    fftws = LTFAT_NAME(fftreal_get_workspace_size)(sc0->p_before);
+    fftws = ltfat_ws_max(fftws, LTFAT_NAME(ifftreal_get_workspace_size)(sc0->p_after));
+    fftws = ltfat_ws_max(fftws, LTFAT_NAME(fftreal_get_workspace_size)(plan->p_veryend));
+
+    *sc = *sc0;
+    sc->sbuf = (LTFAT_REAL*) ltfat_ws_take(base, &off, d * sizeof(LTFAT_REAL));
+    sc->cbuf = (LTFAT_COMPLEX*) ltfat_ws_take(base, &off, d2 * sizeof(LTFAT_COMPLEX));
+    sc->gt = (LTFAT_REAL*) ltfat_ws_take(base, &off, 2 * p * q * sizeof(LTFAT_REAL));
+    sc->ff = (LTFAT_REAL*) ltfat_ws_take(base, &off,
+                                         2 * d2 * p * q * plan->W * sizeof(LTFAT_REAL));
+    sc->cf = (LTFAT_REAL*) ltfat_ws_take(base, &off,
+                                         2 * d2 * q * q * plan->W * sizeof(LTFAT_REAL));
+    sc->fftwork = ltfat_ws_take(base, &off, fftws);
+    return off;
+}
+
+LTFAT_API size_t
+LTFAT_NAME(dgtreal_long_get_workspace_size)(
+    const LTFAT_NAME(dgtreal_long_plan)* plan)
+{
+    LTFAT_NAME(dgtreal_long_scratch) sc;
+    if (!plan) return 0;
+    return ltfat_ws_size(LTFAT_NAME(dgtreal_long_ws_carve)(plan, NULL, &sc));
+}
+
+LTFAT_API int
+LTFAT_NAME(dgtreal_long_execute_ws)(const LTFAT_NAME(dgtreal_long_plan)* plan,
+                                    const LTFAT_REAL f[], LTFAT_COMPLEX c[],
+                                    void* ws)
+{
+    int status = LTFATERR_SUCCESS;
+    LTFAT_NAME(dgtreal_long_plan) plan2;
+    LTFAT_NAME(dgtreal_long_scratch) sc;
+    ltfat_int M2;
+
+    CHECKNULL(plan); CHECKNULL(f); CHECKNULL(c); CHECKNULL(ws);
+    M2 = plan->M / 2 + 1;
+
+    LTFAT_NAME(dgtreal_long_ws_carve)(plan, ltfat_ws_begin(ws), &sc);
+
+    // Shallow copy running single-threaded on the workspace
+    plan2 = *plan;
+    plan2.f = f;
+    plan2.cout = c;
+    plan2.nthreads = 1;
+    plan2.scratch = &sc;
+
+    LTFAT_NAME(dgtreal_walnut_plan)(&plan2);
+
+    if (plan->ptype == LTFAT_TIMEINV)
+        LTFAT_NAME_REAL(dgtphaselockhelper)((LTFAT_REAL*)c, plan->L, plan->W, plan->a,
+                                            2 * M2, plan->M, (LTFAT_REAL*) c);
+
+    LTFAT_NAME(fftreal_execute_ws)(plan->p_veryend, (LTFAT_REAL*)c, c, sc.fftwork);
+
+error:
+    return status;
+}
+
 
 /*  This routine computes the DGT factorization using strided FFTs so
     the memory layout is optimized for the matrix product. Compared to
@@ -182,13 +337,17 @@ error:
 
     Special code for integer oversampling.
 
+    The three stages of each coset are split among the threads in the
+    same way as in dgt_walnut_execute.
 */
 
-LTFAT_API int
-LTFAT_NAME(dgtreal_walnut_plan)(LTFAT_NAME(dgtreal_long_plan)* plan)
+/* Signal factorization of coset r, items (w,l,k) in range start..end-1 */
+static void
+LTFAT_NAME(dgtreal_walnut_fac)(LTFAT_NAME(dgtreal_long_plan)* plan,
+                               LTFAT_NAME(dgtreal_long_scratch)* sc,
+                               ltfat_int r, LTFAT_REAL* ff,
+                               ltfat_int start, ltfat_int end)
 {
-    /*  --------- initial declarations -------------- */
-
     ltfat_int a = plan->a;
     ltfat_int M = plan->M;
     ltfat_int L = plan->L;
@@ -198,201 +357,211 @@ LTFAT_NAME(dgtreal_walnut_plan)(LTFAT_NAME(dgtreal_long_plan)* plan)
     ltfat_int p = a / c;
     ltfat_int q = M / c;
     ltfat_int d = N / q;
-    ltfat_int M2 = M / 2 + 1;
-
+    ltfat_int h_a = plan->h_a;
 
     /* This is a floor operation. */
     ltfat_int d2 = d / 2 + 1;
 
-    const LTFAT_REAL* f = plan->f;
-    const LTFAT_COMPLEX* gf = (const LTFAT_COMPLEX*)plan->gf;
-
-    ltfat_int h_a = plan->h_a;
-
-    LTFAT_REAL* sbuf = plan->sbuf;
-    LTFAT_COMPLEX* cbuf = plan->cbuf;
-
-    LTFAT_REAL* cout = (LTFAT_REAL*) plan->cout;
-
-
-    LTFAT_REAL* gbase, *fbase, *cbase;
-
-    LTFAT_REAL* ffp;
-
-    const LTFAT_REAL* fp;
+    LTFAT_REAL* sbuf = sc->sbuf;
+    LTFAT_COMPLEX* cbuf = sc->cbuf;
 
     /* Scaling constant needed because of FFTWs normalization. */
-    LTFAT_REAL scalconst = 
+    LTFAT_REAL scalconst =
         ( LTFAT_REAL) ( 1.0 / ((double)d * sqrt(( double)M)));
 
     /* Leading dimensions of the 4dim array. */
     ltfat_int ld2a = 2 * p * q * W;
 
-    /* Leading dimensions of cf */
-    ltfat_int ld3b = 2 * q * q * W;
-
-    /* --------- main loop begins here ------------------- */
-    for (ltfat_int r = 0; r < c; r++)
+    for (ltfat_int t = start; t < end; t++)
     {
-        /*  ---------- compute signal factorization ----------- */
-        ffp = plan->ff;
-        fp = f + r;
+        ltfat_int w = t / (q * p);
+        ltfat_int l = (t / p) % q;
+        ltfat_int k = t % p;
+        const LTFAT_REAL* fp = plan->f + r + w * L;
+        LTFAT_REAL* ffp = ff + 2 * t;
+
         if (p == 1)
         {
             /* Integer oversampling case */
-            for (ltfat_int w = 0; w < W; w++)
-            {
-                for (ltfat_int l = 0; l < q; l++)
-                {
-                    for (ltfat_int s = 0; s < d; s++)
-                    {
-                        sbuf[s]   = fp[(s * M + l * a) % L];
-                    }
-
-                    LTFAT_NAME(fftreal_execute)(plan->p_before);
-
-                    for (ltfat_int s = 0; s < d2; s++)
-                    {
-                        ffp[s * ld2a]   = ltfat_real(cbuf[s]) * scalconst;
-                        ffp[s * ld2a + 1] = ltfat_imag(cbuf[s]) * scalconst;
-                    }
-                    ffp += 2;
-                }
-                fp += L;
-            }
-            /* fp -= 2 * L * W; */
+            for (ltfat_int s = 0; s < d; s++)
+                sbuf[s] = fp[(s * M + l * a) % L];
         }
         else
         {
             /* rational sampling case */
-
-            for (ltfat_int w = 0; w < W; w++)
-            {
-                for (ltfat_int l = 0; l < q; l++)
-                {
-                    for (ltfat_int k = 0; k < p; k++)
-                    {
-                        for (ltfat_int s = 0; s < d; s++)
-                        {
-                            sbuf[s]   = fp[ ltfat_positiverem(k * M + s * p * M - l * h_a * a, L) ];
-                        }
-
-                        LTFAT_NAME(fftreal_execute)(plan->p_before);
-
-                        for (ltfat_int s = 0; s < d2; s++)
-                        {
-                            ffp[s * ld2a]   = ltfat_real(cbuf[s]) * scalconst;
-                            ffp[s * ld2a + 1] = ltfat_imag(cbuf[s]) * scalconst;
-                        }
-                        ffp += 2;
-                    }
-                }
-                fp += L;
-            }
-            /* fp -= 2 * L * W; */
+            for (ltfat_int s = 0; s < d; s++)
+                sbuf[s] = fp[ ltfat_positiverem(k * M + s * p * M - l * h_a * a, L) ];
         }
 
-        /* ----------- compute matrix multiplication ----------- */
+        LTFAT_NAME(fftreal_execute_ws)(sc->p_before, sbuf, cbuf, sc->fftwork);
 
-        /* Do the matmul  */
-        if (p == 1)
+        for (ltfat_int s = 0; s < d2; s++)
         {
-            /* Integer oversampling case */
+            ffp[s * ld2a]   = ltfat_real(cbuf[s]) * scalconst;
+            ffp[s * ld2a + 1] = ltfat_imag(cbuf[s]) * scalconst;
+        }
+    }
+}
 
+/* Matrix product of coset r for s in range start..end-1 */
+static void
+LTFAT_NAME(dgtreal_walnut_matmul)(LTFAT_NAME(dgtreal_long_plan)* plan,
+                                  LTFAT_NAME(dgtreal_long_scratch)* sc,
+                                  ltfat_int r, const LTFAT_REAL* ff,
+                                  LTFAT_REAL* cf, ltfat_int start, ltfat_int end)
+{
+    ltfat_int c = plan->c;
+    ltfat_int p = plan->a / c;
+    ltfat_int q = plan->M / c;
+    ltfat_int W = plan->W;
+    const LTFAT_REAL* gf = (const LTFAT_REAL*) plan->gf;
 
-            /* Rational oversampling case */
-            for (ltfat_int s = 0; s < d2; s++)
-            {
-                gbase = (LTFAT_REAL*)gf + 2 * (r + s * c) * q;
-                fbase = plan->ff + 2 * s * q * W;
-                cbase = plan->cf + 2 * s * q * q * W;
-
-                for (ltfat_int nm = 0; nm < q * W; nm++)
-                {
-                    for (ltfat_int mm = 0; mm < q; mm++)
-                    {
-                        cbase[0] = gbase[0] * fbase[0] + gbase[1] * fbase[1];
-                        cbase[1] = gbase[0] * fbase[1] - gbase[1] * fbase[0];
-                        gbase += 2;
-                        cbase += 2;
-                    }
-                    gbase -= 2 * q;
-                    fbase += 2;
-                }
-                cbase -= 2 * q * q * W;
-            }
+    for (ltfat_int s = start; s < end; s++)
+    {
+        const LTFAT_REAL* gbase = gf + 2 * (r + s * c) * p * q;
 
-        }
-        else
+        if (p > 1)
         {
-
-            /* Rational oversampling case */
-            for (ltfat_int s = 0; s < d2; s++)
-            {
-                gbase = (LTFAT_REAL*)gf + 2 * (r + s * c) * p * q;
-                fbase = plan->ff + 2 * s * p * q * W;
-                cbase = plan->cf + 2 * s * q * q * W;
-
-                for (ltfat_int nm = 0; nm < q * W; nm++)
-                {
-                    for (ltfat_int mm = 0; mm < q; mm++)
-                    {
-                        cbase[0] = 0.0;
-                        cbase[1] = 0.0;
-                        for (ltfat_int km = 0; km < p; km++)
-                        {
-                            cbase[0] += gbase[0] * fbase[0] + gbase[1] * fbase[1];
-                            cbase[1] += gbase[0] * fbase[1] - gbase[1] * fbase[0];
-                            gbase += 2;
-                            fbase += 2;
-                        }
-                        fbase -= 2 * p;
-                        cbase += 2;
-                    }
-                    gbase -= 2 * q * p;
-                    fbase += 2 * p;
-                }
-                cbase -= 2 * q * q * W;
-                fbase -= 2 * p * q * W;
-            }
+            LTFAT_NAME_REAL(walnut_transpose)(gbase, p, q, sc->gt);
+            gbase = sc->gt;
         }
 
+        LTFAT_NAME_REAL(walnut_fwdmatmul)(gbase, ff + 2 * s * p * q * W, p, q,
+                                          q * W, cf + 2 * s * q * q * W);
+    }
+}
 
+/* Inverse coefficient factorization of coset r, items (w,l,u) in range
+ * start..end-1 */
+static void
+LTFAT_NAME(dgtreal_walnut_ifac)(LTFAT_NAME(dgtreal_long_plan)* plan,
+                                LTFAT_NAME(dgtreal_long_scratch)* sc,
+                                ltfat_int r, const LTFAT_REAL* cf,
+                                ltfat_int start, ltfat_int end)
+{
+    ltfat_int M = plan->M;
+    ltfat_int N = plan->L / plan->a;
+    ltfat_int c = plan->c;
+    ltfat_int q = M / c;
+    ltfat_int d = N / q;
+    ltfat_int d2 = d / 2 + 1;
+    ltfat_int M2 = M / 2 + 1;
+    ltfat_int h_a = plan->h_a;
 
-        /*  -------  compute inverse coefficient factorization ------- */
-        LTFAT_REAL* cfp = plan->cf;
-        ltfat_int ld5c = 2 * M2 * N;
+    LTFAT_REAL* sbuf = sc->sbuf;
+    LTFAT_REAL* cout = (LTFAT_REAL*) plan->cout;
 
-        /* Cover both integer and rational sampling case */
-        for (ltfat_int w = 0; w < W; w++)
+    /* Leading dimensions of cf */
+    ltfat_int ld3b = 2 * q * q * plan->W;
+    ltfat_int ld5c = 2 * M2 * N;
+
+    /* Cover both integer and rational sampling case */
+    for (ltfat_int t = start; t < end; t++)
+    {
+        ltfat_int w = t / (q * q);
+        ltfat_int l = (t / q) % q;
+        ltfat_int u = t % q;
+        const LTFAT_REAL* cfp = cf + 2 * t;
+
+        for (ltfat_int s = 0; s < d2; s++)
         {
-            /* Complete inverse fac of coefficients */
-            for (ltfat_int l = 0; l < q; l++)
-            {
-                for (ltfat_int u = 0; u < q; u++)
-                {
-                    for (ltfat_int s = 0; s < d2; s++)
-                    {
-                        LTFAT_REAL* cbufTmp = (LTFAT_REAL*) &cbuf[s];
-                        cbufTmp[0] = cfp[s * ld3b];
-                        cbufTmp[1] = cfp[s * ld3b + 1];
-                    }
-                    cfp += 2;
-
-                    /* Do inverse fft of length d */
-                    LTFAT_NAME(ifftreal_execute)(plan->p_after);
-
-                    for (ltfat_int s = 0; s < d; s++)
-                    {
-                        cout[ r + l * c + ltfat_positiverem(u + s * q - l * h_a,
-                                                            N) * 2 * M2 + w * ld5c ] = sbuf[s];
-                    }
-                }
-            }
+            LTFAT_REAL* cbufTmp = (LTFAT_REAL*) &sc->cbuf[s];
+            cbufTmp[0] = cfp[s * ld3b];
+            cbufTmp[1] = cfp[s * ld3b + 1];
         }
 
+        /* Do inverse fft of length d */
+        LTFAT_NAME(ifftreal_execute_ws)(sc->p_after, sc->cbuf, sbuf, sc->fftwork);
+
+        for (ltfat_int s = 0; s < d; s++)
+        {
+            cout[ r + l * c + ltfat_positiverem(u + s * q - l * h_a,
+                                                N) * 2 * M2 + w * ld5c ] = sbuf[s];
+        }
+    }
+}
 
-        /* ----------- Main loop ends here ------------------------ */
+static void
+LTFAT_NAME(dgtreal_walnut_cosets)(void* userdata, ltfat_int start,
+                                  ltfat_int end, int threadid)
+{
+    LTFAT_NAME(dgtreal_walnut_job)* job = (LTFAT_NAME(dgtreal_walnut_job)*) userdata;
+    LTFAT_NAME(dgtreal_long_plan)* p = job->p;
+    LTFAT_NAME(dgtreal_long_scratch)* sc = p->scratch + threadid;
+    ltfat_int q = p->M / p->c;
+    ltfat_int pp = p->a / p->c;
+    ltfat_int d2 = p->L / p->M / pp / 2 + 1;
+
+    for (ltfat_int r = start; r < end; r++)
+    {
+        LTFAT_NAME(dgtreal_walnut_fac)(p, sc, r, sc->ff, 0, p->W * q * pp);
+        LTFAT_NAME(dgtreal_walnut_matmul)(p, sc, r, sc->ff, sc->cf, 0, d2);
+        LTFAT_NAME(dgtreal_walnut_ifac)(p, sc, r, sc->cf, 0, p->W * q * q);
+    }
+}
+
+static void
+LTFAT_NAME(dgtreal_walnut_fac_items)(void* userdata, ltfat_int start,
+                                     ltfat_int end, int threadid)
+{
+    LTFAT_NAME(dgtreal_walnut_job)* job = (LTFAT_NAME(dgtreal_walnut_job)*) userdata;
+    LTFAT_NAME(dgtreal_long_plan)* p = job->p;
+
+    LTFAT_NAME(dgtreal_walnut_fac)(p, p->scratch + threadid, job->r,
+                                   p->scratch[0].ff, start, end);
+}
+
+static void
+LTFAT_NAME(dgtreal_walnut_matmul_items)(void* userdata, ltfat_int start,
+                                        ltfat_int end, int threadid)
+{
+    LTFAT_NAME(dgtreal_walnut_job)* job = (LTFAT_NAME(dgtreal_walnut_job)*) userdata;
+    LTFAT_NAME(dgtreal_long_plan)* p = job->p;
+
+    LTFAT_NAME(dgtreal_walnut_matmul)(p, p->scratch + threadid, job->r,
+                                      p->scratch[0].ff, p->scratch[0].cf,
+                                      start, end);
+}
+
+static void
+LTFAT_NAME(dgtreal_walnut_ifac_items)(void* userdata, ltfat_int start,
+                                      ltfat_int end, int threadid)
+{
+    LTFAT_NAME(dgtreal_walnut_job)* job = (LTFAT_NAME(dgtreal_walnut_job)*) userdata;
+    LTFAT_NAME(dgtreal_long_plan)* p = job->p;
+
+    LTFAT_NAME(dgtreal_walnut_ifac)(p, p->scratch + threadid, job->r,
+                                    p->scratch[0].cf, start, end);
+}
+
+LTFAT_API int
+LTFAT_NAME(dgtreal_walnut_plan)(LTFAT_NAME(dgtreal_long_plan)* plan)
+{
+    LTFAT_NAME(dgtreal_walnut_job) job;
+    ltfat_int c = plan->c;
+    ltfat_int p = plan->a / c;
+    ltfat_int q = plan->M / c;
+    ltfat_int d2 = plan->L / plan->M / p / 2 + 1;
+
+    job.p = plan;
+    job.r = 0;
+
+    if (ltfat_walnut_parallel_cosets(c, plan->nthreads))
+    {
+        ltfat_parallel_for(plan->nthreads, c,
+                           &LTFAT_NAME(dgtreal_walnut_cosets), &job);
+    }
+    else
+    {
+        for (job.r = 0; job.r < c; job.r++)
+        {
+            ltfat_parallel_for(plan->nthreads, plan->W * q * p,
+                               &LTFAT_NAME(dgtreal_walnut_fac_items), &job);
+            ltfat_parallel_for(plan->nthreads, d2,
+                               &LTFAT_NAME(dgtreal_walnut_matmul_items), &job);
+            ltfat_parallel_for(plan->nthreads, plan->W * q * q,
+                               &LTFAT_NAME(dgtreal_walnut_ifac_items), &job);
+        }
     }
 
     return 0;
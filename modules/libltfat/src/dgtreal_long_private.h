@@ -4,6 +4,20 @@
 
 #include "ltfat/thirdparty/fftw3.h"
 
+/* Buffers and FFT plans of the factorization used by a single thread.
+ * ff and cf are only allocated for the threads processing whole cosets.
+ * fftwork is the FFT scratch, NULL for the one owned by the FFT plans. */
+typedef struct
+{
+    LTFAT_NAME(fftreal_plan)* p_before;
+    LTFAT_NAME(ifftreal_plan)* p_after;
+    LTFAT_REAL* sbuf;
+    LTFAT_COMPLEX* cbuf;
+    LTFAT_REAL* gt;
+    LTFAT_REAL* ff, *cf;
+    void* fftwork;
+} LTFAT_NAME(dgtreal_long_scratch);
+
 struct LTFAT_NAME(dgtreal_long_plan)
 {
     ltfat_int a;
@@ -13,14 +27,12 @@ struct LTFAT_NAME(dgtreal_long_plan)
     ltfat_int c;
     ltfat_int h_a;
     ltfat_phaseconvention ptype;
-    LTFAT_NAME(fftreal_plan)* p_before;
-    LTFAT_NAME(ifftreal_plan)* p_after;
+    unsigned flags;
+    int nthreads;
+    LTFAT_NAME(dgtreal_long_scratch)* scratch;
     LTFAT_NAME(fftreal_plan)* p_veryend;
-    LTFAT_REAL* sbuf;
-    LTFAT_COMPLEX* cbuf;
     const LTFAT_REAL* f;
-    LTFAT_COMPLEX* gf;
+    const LTFAT_COMPLEX* gf;
     LTFAT_REAL* cwork;
     LTFAT_COMPLEX* cout;
-    LTFAT_REAL* ff, *cf;
 };
@@ -1,4 +1,5 @@
 #include "dgtrealmp_private.h"
+#include "threads_private.h"
 
 LTFAT_REAL
 LTFAT_NAME(pedantic_callback)(void* userdata,
@@ -18,6 +19,86 @@ LTFAT_API int
 LTFAT_NAME(dgtrealmp_init)(
     LTFAT_NAME(dgtrealmp_parbuf)* pb, ltfat_int L,
     LTFAT_NAME(dgtrealmp_state)** pout)
+{
+    LTFAT_NAME(dgtrealmp_dict)* dict = NULL;
+    int status = LTFATERR_FAILED;
+
+    CHECKSTATUS( LTFAT_NAME(dgtrealmp_dict_init)(pb, L, &dict));
+    CHECKSTATUS( LTFAT_NAME(dgtrealmp_init_fromdict)(dict, NULL, pout));
+    // The state holds the last reference
+    LTFAT_NAME(dgtrealmp_dict_done)(&dict);
+
+    return LTFATERR_SUCCESS;
+error:
+    if (dict) LTFAT_NAME(dgtrealmp_dict_done)(&dict);
+    return status;
+}
+
+LTFAT_API int
+LTFAT_NAME(dgtrealmp_init_gen)(
+    const LTFAT_REAL* g[], ltfat_int gl[], ltfat_int L, ltfat_int P, ltfat_int a[],
+    ltfat_int M[], ltfat_dgtmp_params* params, LTFAT_NAME(dgtrealmp_state)** pout)
+{
+    LTFAT_NAME(dgtrealmp_dict)* dict = NULL;
+    int status = LTFATERR_FAILED;
+
+    CHECKSTATUS(
+        LTFAT_NAME(dgtrealmp_dict_init_gen)(g, gl, L, P, a, M, params, &dict));
+    CHECKSTATUS( LTFAT_NAME(dgtrealmp_init_fromdict)(dict, NULL, pout));
+    LTFAT_NAME(dgtrealmp_dict_done)(&dict);
+
+    return LTFATERR_SUCCESS;
+error:
+    if (dict) LTFAT_NAME(dgtrealmp_dict_done)(&dict);
+    return status;
+}
+
+static void
+LTFAT_NAME(dgtrealmp_params_setdefaults)(ltfat_dgtmp_params* params, ltfat_int L)
+{
+    if ( params->maxatoms == 0 )
+        params->maxatoms =  (size_t) ( 0.1 * L);
+
+    if ( params->maxit == 0 )
+        params->maxit = 2 * params->maxatoms;
+
+    if (params->iterstep == 0)
+        params->iterstep = params->maxit;
+}
+
+static void
+LTFAT_NAME(dgtrealmp_dict_free)(LTFAT_NAME(dgtrealmp_dict)* d)
+{
+    if (d->dgtplans)
+    {
+        for (ltfat_int k = 0; k < d->P; k++)
+            if (d->dgtplans[k])
+                LTFAT_NAME(dgtreal_done)(&d->dgtplans[k]);
+
+        ltfat_free(d->dgtplans);
+    }
+
+    if (d->gramkerns)
+    {
+        for (ltfat_int k = 0; k < d->P * d->P; k++)
+            if (d->gramkerns[k])
+                LTFAT_NAME(dgtrealmp_kernel_done)( &d->gramkerns[k]);
+
+        ltfat_free(d->gramkerns);
+    }
+
+    if (d->params)
+        ltfat_dgtmp_params_free(d->params);
+
+    LTFAT_SAFEFREEALL(d->a, d->M, d->chanmask);
+    ltfat_mutex_destroy(&d->lock);
+    ltfat_free(d);
+}
+
+LTFAT_API int
+LTFAT_NAME(dgtrealmp_dict_init)(
+    LTFAT_NAME(dgtrealmp_parbuf)* pb, ltfat_int L,
+    LTFAT_NAME(dgtrealmp_dict)** dout)
 {
     int status = LTFATERR_FAILED;
 
@@ -26,35 +107,34 @@ LTFAT_NAME(dgtrealmp_init)(
           L > 0 , "Signal length L must be positive (passed %td)", L);
     CHECK(LTFATERR_BADARG, pb->P > 0 , "No Gabor system set in the plan");
 
-    CHECKSTATUS( LTFAT_NAME(dgtrealmp_init_gen)(
+    CHECKSTATUS( LTFAT_NAME(dgtrealmp_dict_init_gen)(
                (const LTFAT_REAL**)pb->g, pb->gl, L, pb->P, pb->a, pb->M,
-               pb->params, pout));
-
-    LTFAT_NAME(dgtrealmp_set_iterstepcallback)( *pout,
-        pb->iterstepcallback, pb->iterstepcallbackdata);
+               pb->params, dout));
 
-    memcpy((*pout)->chanmask, pb->chanmask, pb->P*sizeof*pb->chanmask);
+    (*dout)->callback = pb->iterstepcallback;
+    (*dout)->userdata = pb->iterstepcallbackdata;
+    memcpy((*dout)->chanmask, pb->chanmask, pb->P*sizeof*pb->chanmask);
     return LTFATERR_SUCCESS;
 error:
     return status;
 }
 
 LTFAT_API int
-LTFAT_NAME(dgtrealmp_init_gen)(
+LTFAT_NAME(dgtrealmp_dict_init_gen)(
     const LTFAT_REAL* g[], ltfat_int gl[], ltfat_int L, ltfat_int P, ltfat_int a[],
-    ltfat_int M[], ltfat_dgtmp_params* params, LTFAT_NAME(dgtrealmp_state)** pout)
+    ltfat_int M[], ltfat_dgtmp_params* params, LTFAT_NAME(dgtrealmp_dict)** dout)
 {
     int status = LTFATERR_FAILED;
     const LTFAT_REAL* gtmp[2]; ltfat_int gltmp[2]; ltfat_int atmp[2];
     ltfat_int Mtmp[2];
     ltfat_int nextL;
     ltfat_int amax = 0, Mmax = 0;
-    LTFAT_NAME(dgtrealmp_state)* p = NULL;
+    LTFAT_NAME(dgtrealmp_dict)* p = NULL;
     ltfat_dgt_params* dgtparams = NULL;
 
     CHECK(LTFATERR_NOTPOSARG, P > 0, "P must be positive (passed %td)", P);
     CHECK(LTFATERR_NOTPOSARG, L > 0, "L must be positive (passed %td)", L);
-    CHECKNULL(gl); CHECKNULL(g); CHECKNULL(a); CHECKNULL(M); CHECKNULL(pout);
+    CHECKNULL(gl); CHECKNULL(g); CHECKNULL(a); CHECKNULL(M); CHECKNULL(dout);
 
 
     for (ltfat_int pIdx = 0; pIdx < P; pIdx++)
@@ -102,47 +182,30 @@ LTFAT_NAME(dgtrealmp_init_gen)(
     CHECK(LTFATERR_BADTRALEN, L == nextL,
           "Next compatible transform length is %d (passed %d).", nextL, L);
 
-    CHECKMEM( p = LTFAT_NEW( LTFAT_NAME(dgtrealmp_state)) );
+    CHECKMEM( p = LTFAT_NEW( LTFAT_NAME(dgtrealmp_dict)) );
+    ltfat_mutex_init(&p->lock);
+    p->refcount = 1;
+    p->P = P; p->L = L;
+
     CHECKMEM( p->params = ltfat_dgtmp_params_allocdef() );
 
     if (params)
         memcpy( p->params, params, sizeof * p->params);
 
-    if ( p->params->maxatoms == 0 )
-        p->params->maxatoms =  (size_t) ( 0.1 * L);
-
-    if ( p->params->maxit == 0 )
-        p->params->maxit = 2 * p->params->maxatoms;
-
-    if (p->params->iterstep == 0)
-        p->params->iterstep = p->params->maxit;
-
-#ifdef NOBLASLAPACK
-    CHECK( LTFATERR_NOBLASLAPACK,
-           p->params->alg != ltfat_dgtmp_alg_locomp,
-           "LocOMP requires LAPACK, but libltfat was compiled without it.");
-#endif
-
-    p->params->initwasrun = 1;
+    LTFAT_NAME(dgtrealmp_params_setdefaults)(p->params, L);
 
     CHECKMEM( p->dgtplans  = LTFAT_NEWARRAY( LTFAT_NAME(dgtreal_plan)*, P) );
     CHECKMEM( p->gramkerns = LTFAT_NEWARRAY( LTFAT_NAME(kerns)*, P * P) );
     CHECKMEM( p->a  = LTFAT_NEWARRAY( ltfat_int, P));
     CHECKMEM( p->M  = LTFAT_NEWARRAY( ltfat_int, P));
-    CHECKMEM( p->M2 = LTFAT_NEWARRAY( ltfat_int, P));
-    CHECKMEM( p->N  = LTFAT_NEWARRAY( ltfat_int, P));
     CHECKMEM( p->chanmask  = LTFAT_NEWARRAY( int, P));
-    CHECKMEM( p->couttmp = LTFAT_NEWARRAY( LTFAT_COMPLEX*, P));
 
     for (ltfat_int k = 0; k < P; k++)
     {
         p->chanmask[k] = 1;
         p->a[k] = a[k]; p->M[k] = M[k];
-        p->M2[k] = M[k] / 2 + 1; p->N[k] = L / a[k];
     }
 
-    p->P = P; p->L = L;
-
     CHECKMEM( dgtparams = ltfat_dgt_params_allocdef());
     ltfat_dgt_setpar_phaseconv(dgtparams, p->params->ptype);
     ltfat_dgt_setpar_synoverwrites(dgtparams, 0);
@@ -172,29 +235,102 @@ LTFAT_NAME(dgtrealmp_init_gen)(
         }
     }
 
-#ifndef NDEBUG
-    /* for(ltfat_int kNo=0;kNo<P;kNo++) */
-    /* { */
-    /*     LTFAT_NAME(kerns)* kk = p->gramkerns[kNo]; */
-    /*     printf("h=%td, w=%td \n", kk->size.height, kk->size.width); */
-    /*     for (ltfat_int n = 0; n < kk->size.width; n++ ) */
-    /*     { */
-    /*         printf("s=%td,e=%td \n", kk->range[n].start, kk->range[n].end); */
-    /*     } */
-    /*  */
-    /*     for (ltfat_int m = 0; m < kk->size.height; m++ ) */
-    /*     { */
-    /*         for (ltfat_int n = 0; n < kk->size.width; n++ ) */
-    /*         { */
-    /*             printf("r=% 5.3e,i=% 5.3e ", ltfat_real(kk->kval[n * kk->size.height + m]), */
-    /*                    ltfat_imag(kk->kval[n * kk->size.height + m])); */
-    /*         } */
-    /*         printf("\n"); */
-    /*     } */
-    /* } */
+    *dout = p;
+    return LTFATERR_SUCCESS;
+error:
+    if (p) LTFAT_NAME(dgtrealmp_dict_free)(p);
+    if (dgtparams) ltfat_dgt_params_free(dgtparams);
+    if (dout) *dout = NULL;
+    return status;
+}
+
+LTFAT_API int
+LTFAT_NAME(dgtrealmp_dict_done)(LTFAT_NAME(dgtrealmp_dict)** d)
+{
+    LTFAT_NAME(dgtrealmp_dict)* dd;
+    int refcount;
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(d); CHECKNULL(*d);
+    dd = *d;
+
+    ltfat_mutex_lock(&dd->lock);
+    refcount = --dd->refcount;
+    ltfat_mutex_unlock(&dd->lock);
+
+    if (refcount == 0)
+        LTFAT_NAME(dgtrealmp_dict_free)(dd);
+
+    *d = NULL;
+error:
+    return status;
+}
+
+LTFAT_API int
+LTFAT_NAME(dgtrealmp_init_fromdict)(
+    LTFAT_NAME(dgtrealmp_dict)* dict, ltfat_dgtmp_params* params,
+    LTFAT_NAME(dgtrealmp_state)** pout)
+{
+    int status = LTFATERR_FAILED;
+    LTFAT_NAME(dgtrealmp_state)* p = NULL;
+    ltfat_int P, L;
+    size_t wssize = 0;
+
+    CHECKNULL(dict); CHECKNULL(pout);
+    P = dict->P; L = dict->L;
+
+    CHECKMEM( p = LTFAT_NEW( LTFAT_NAME(dgtrealmp_state)) );
+
+    ltfat_mutex_lock(&dict->lock);
+    dict->refcount++;
+    ltfat_mutex_unlock(&dict->lock);
+    p->dict = dict;
+    p->gramkerns = dict->gramkerns;
+    p->dgtplans = dict->dgtplans;
+
+    CHECKMEM( p->params = ltfat_dgtmp_params_allocdef() );
+    memcpy( p->params, params ? params : dict->params, sizeof * p->params);
+    LTFAT_NAME(dgtrealmp_params_setdefaults)(p->params, L);
+
+    // The kernels were computed with these
+    p->params->kernrelthr = dict->params->kernrelthr;
+    p->params->ptype = dict->params->ptype;
+
+#ifdef NOBLASLAPACK
+    CHECK( LTFATERR_NOBLASLAPACK,
+           p->params->alg != ltfat_dgtmp_alg_locomp,
+           "LocOMP requires LAPACK, but libltfat was compiled without it.");
 #endif
 
-    CHECKSTATUS( LTFAT_NAME(dgtrealmpiter_init)(a, M, P, L, &p->iterstate));
+    p->params->initwasrun = 1;
+
+    CHECKMEM( p->a  = LTFAT_NEWARRAY( ltfat_int, P));
+    CHECKMEM( p->M  = LTFAT_NEWARRAY( ltfat_int, P));
+    CHECKMEM( p->M2 = LTFAT_NEWARRAY( ltfat_int, P));
+    CHECKMEM( p->N  = LTFAT_NEWARRAY( ltfat_int, P));
+    CHECKMEM( p->chanmask  = LTFAT_NEWARRAY( int, P));
+    CHECKMEM( p->couttmp = LTFAT_NEWARRAY( LTFAT_COMPLEX*, P));
+
+    // The shared plans are only read, each state brings its own buffers
+    for (ltfat_int k = 0; k < P; k++)
+    {
+        size_t wsk = LTFAT_NAME(dgtreal_get_workspace_size)(dict->dgtplans[k]);
+        if (wsk > wssize) wssize = wsk;
+    }
+    CHECKMEM( p->dgtws = ltfat_malloc(wssize));
+
+    for (ltfat_int k = 0; k < P; k++)
+    {
+        p->chanmask[k] = dict->chanmask[k];
+        p->a[k] = dict->a[k]; p->M[k] = dict->M[k];
+        p->M2[k] = p->M[k] / 2 + 1; p->N[k] = L / p->a[k];
+    }
+
+    p->P = P; p->L = L;
+    p->callback = dict->callback;
+    p->userdata = dict->userdata;
+
+    CHECKSTATUS( LTFAT_NAME(dgtrealmpiter_init)(p->a, p->M, P, L,
+                 p->params->searchtree, &p->iterstate));
 
     if (p->params->alg == ltfat_dgtmp_alg_locomp)
     {
@@ -232,18 +368,34 @@ LTFAT_NAME(dgtrealmp_init_gen)(
         p->params->do_pedantic = 1;
     }
 
+    if (p->params->alg == ltfat_dgtmp_alg_batchmp)
+    {
+        LTFAT_NAME(dgtrealmpiter_state)* s = p->iterstate;
+        if (p->params->nthreads == 0)
+            p->params->nthreads = ltfat_get_num_threads();
+        if (p->params->batchsize == 0)
+            p->params->batchsize = 8 * p->params->nthreads;
+
+        s->nthreads = p->params->nthreads;
+        s->batchSize = p->params->batchsize;
+        CHECKMEM( s->candBuf = LTFAT_NEWARRAY( kpoint,
+                                               LTFAT_DGTREALMP_BATCHCANDS * s->batchSize));
+        CHECKMEM( s->batchPos = LTFAT_NEWARRAY( kpoint, s->batchSize));
+        CHECKMEM( s->batchRange = LTFAT_NEWARRAY( ltfat_int, 2 * P * s->batchSize));
+        CHECKMEM( s->batchEnergy = LTFAT_NAME_REAL(calloc)( s->batchSize));
+    }
+
     if (p->params->ptype == LTFAT_FREQINV)
     {
-        CHECKMEM(p->iterstate->cvalModBuf = LTFAT_NEWARRAY(LTFAT_COMPLEX*, P * P));
-        for (ltfat_int k1 = 0; k1 < P; k1++)
+        // Each thread of batch MP needs its own block of P*P buffers
+        ltfat_int modBufNo = P * P * p->iterstate->nthreads;
+        CHECKMEM(p->iterstate->cvalModBuf = LTFAT_NEWARRAY(LTFAT_COMPLEX*, modBufNo));
+        for (ltfat_int kIdx = 0; kIdx < modBufNo; kIdx++)
         {
-            for (ltfat_int k2 = 0; k2 < P; k2++)
-            {
-                LTFAT_NAME(kerns)* currkern = p->gramkerns[k1 + k2 * P];
-                ltfat_int h2 = ltfat_idivceil( currkern->size.height , currkern->Mstep);
-                CHECKMEM(p->iterstate->cvalModBuf[k1 + k2 * P] =
-                             LTFAT_NAME_COMPLEX(malloc)( h2));
-            }
+            LTFAT_NAME(kerns)* currkern = p->gramkerns[kIdx % (P * P)];
+            ltfat_int h2 = ltfat_idivceil( currkern->size.height , currkern->Mstep);
+            CHECKMEM(p->iterstate->cvalModBuf[kIdx] =
+                         LTFAT_NAME_COMPLEX(malloc)( h2));
         }
     }
 
@@ -279,8 +431,7 @@ LTFAT_NAME(dgtrealmp_init_gen)(
     return LTFATERR_SUCCESS;
 error:
     if (p) LTFAT_NAME(dgtrealmp_done)(&p);
-    if (dgtparams) ltfat_dgt_params_free(dgtparams);
-    *pout = NULL;
+    if (pout) *pout = NULL;
     return status;
 }
 
@@ -307,14 +458,19 @@ LTFAT_NAME(dgtrealmp_reset)(LTFAT_NAME(dgtrealmp_state)* p, const LTFAT_REAL* f)
     p->params->errtoladj = powl((long double)10.0,
                                 p->params->errtoldb / 10.0) * p->iterstate->fnorm2;
 
-    CHECK( LTFAT_DGTREALMP_STATUS_EMPTY, istate->fnorm2 > 0.0, "Zero energy signal");
+    // Silent input is a valid outcome, not an error worth reporting
+    if ( !(istate->fnorm2 > 0.0) )
+    {
+        status = LTFAT_DGTREALMP_STATUS_EMPTY;
+        goto error;
+    }
 
     for (ltfat_int k = 0; k < p->P; k++)
     {
         LTFAT_COMPLEX* cEl = istate->c[k];
 
         CHECKSTATUS(
-            LTFAT_NAME(dgtreal_execute_ana_newarray)(p->dgtplans[k], f, cEl));
+            LTFAT_NAME(dgtreal_execute_ana_ws)(p->dgtplans[k], f, cEl, p->dgtws));
 
         for (ltfat_int n = 0; n < p->N[k]; n++)
         {
@@ -334,13 +490,64 @@ LTFAT_NAME(dgtrealmp_reset)(LTFAT_NAME(dgtrealmp_state)* p, const LTFAT_REAL* f)
     LTFAT_NAME(dgtrealmp_execute_findmaxatom)(p, &origpos);
     initcmax = ltfat_norm(istate->c[PTOI(origpos)]);
 
-    CHECK( LTFAT_DGTREALMP_STATUS_EMPTY, initcmax > 0.0, " Sanity check (zero max init in prod)");
+    if ( !(initcmax > 0.0) )
+    {
+        status = LTFAT_DGTREALMP_STATUS_EMPTY;
+        goto error;
+    }
     p->params->atprodreltoladj = pow(10.0, p->params->atprodreltoldb / 10.0) * initcmax;
 error:
     return status;
 }
 
 
+/* Each iteration of batch MP selects several atoms, each of them counts
+ * as one iteration. */
+static int
+LTFAT_NAME(dgtrealmp_execute_niters_batch)(
+    LTFAT_NAME(dgtrealmp_state)* p, size_t itno, LTFAT_COMPLEX** cout)
+{
+    LTFAT_NAME(dgtrealmpiter_state)* s = p->iterstate;
+
+    for (size_t iter = 0; iter < itno; )
+    {
+        kpoint origpos;
+        size_t maxbatch = itno - iter, batchNo = 0;
+
+        if ( LTFAT_NAME(dgtrealmp_execute_findmaxatom)(p, &origpos)
+             != LTFATERR_SUCCESS )
+            return LTFAT_DGTREALMP_STATUS_EMPTY;
+
+        if (ltfat_norm(s->c[PTOI(origpos)]) < p->params->atprodreltoladj)
+            return LTFAT_DGTREALMP_STATUS_ATPRODTOL;
+
+        // Do not overshoot maxatoms and maxit
+        if (p->params->maxit - s->currit < maxbatch)
+            maxbatch = p->params->maxit - s->currit;
+        if (p->params->maxatoms - s->curratoms < maxbatch)
+            maxbatch = p->params->maxatoms - s->curratoms;
+
+        LTFAT_NAME(dgtrealmp_execute_batchmp)( p, origpos, maxbatch, cout,
+                                               &batchNo);
+        s->currit += batchNo;
+        iter += batchNo;
+
+        if (s->err < 0)
+            return LTFAT_DGTREALMP_STATUS_STALLED;
+
+        if (s->err <= p->params->errtoladj)
+            return LTFAT_DGTREALMP_STATUS_TOLREACHED;
+
+        if (s->curratoms >= p->params->maxatoms)
+            return LTFAT_DGTREALMP_STATUS_MAXATOMS;
+
+        if (s->currit >= p->params->maxit)
+            return LTFAT_DGTREALMP_STATUS_MAXITER;
+    }
+
+    return LTFAT_DGTREALMP_STATUS_CANCONTINUE;
+}
+
 LTFAT_API int
 LTFAT_NAME(dgtrealmp_execute_niters)(
     LTFAT_NAME(dgtrealmp_state)* p, size_t itno, LTFAT_COMPLEX** cout)
@@ -352,6 +559,9 @@ LTFAT_NAME(dgtrealmp_execute_niters)(
     if (s->fnorm2 == 0.0)
         return LTFAT_DGTREALMP_STATUS_EMPTY;
 
+    if (p->params->alg == ltfat_dgtmp_alg_batchmp)
+        return LTFAT_NAME(dgtrealmp_execute_niters_batch)(p, itno, cout);
+
     for (size_t iter = 0;
          iter < itno && status == LTFAT_DGTREALMP_STATUS_CANCONTINUE;
          iter++)
@@ -365,10 +575,7 @@ LTFAT_NAME(dgtrealmp_execute_niters)(
             return LTFAT_DGTREALMP_STATUS_EMPTY;
 
         if (ltfat_norm(s->c[PTOI(origpos)]) < p->params->atprodreltoladj)
-        {
-            printf("At prod: %.6f \n",10.0*log10(ltfat_norm(s->c[PTOI(origpos)])));
             return LTFAT_DGTREALMP_STATUS_ATPRODTOL;
-        }
 
         if ( !s->suppind[PTOI(origpos)] ) s->curratoms++;
 
@@ -387,6 +594,9 @@ LTFAT_NAME(dgtrealmp_execute_niters)(
         case ltfat_dgtmp_alg_locselfprojmp:
             status  = LTFAT_NAME(dgtrealmp_execute_selfprojmp)( p, origpos, cout);
             break;
+        case ltfat_dgtmp_alg_batchmp:
+            // Handled by dgtrealmp_execute_niters_batch
+            break;
         }
 
         if (s->err < 0)
@@ -456,7 +666,7 @@ LTFAT_NAME(dgtrealmp_execute_synthesize)(
         {
             CHECKNULL(c[k]);
             CHECKSTATUS(
-                LTFAT_NAME(dgtreal_execute_syn_newarray)( p->dgtplans[k], c[k], f));
+                LTFAT_NAME(dgtreal_execute_syn_ws)( p->dgtplans[k], c[k], f, p->dgtws));
         }
     }
 
@@ -514,7 +724,7 @@ LTFAT_NAME(dgtrealmp_done)( LTFAT_NAME(dgtrealmp_state)** p)
     CHECKNULL(p); CHECKNULL(*p);
     pp = *p;
 
-    LTFAT_SAFEFREEALL(pp->a,pp->M,pp->M2,pp->N,pp->chanmask,pp->couttmp);
+    LTFAT_SAFEFREEALL(pp->a,pp->M,pp->M2,pp->N,pp->chanmask,pp->couttmp,pp->dgtws);
 
 
     if (pp->params)
@@ -529,29 +739,12 @@ LTFAT_NAME(dgtrealmp_done)( LTFAT_NAME(dgtrealmp_state)** p)
         pp->closures = NULL;
     }
 
-    if (pp->dgtplans)
-    {
-        for (ltfat_int k = 0; k < pp->P; k++)
-            LTFAT_NAME(dgtreal_done)(&pp->dgtplans[k]);
-
-        ltfat_free(pp->dgtplans);
-        pp->dgtplans = NULL;
-    }
-
-    if (pp->gramkerns)
-    {
-        for (ltfat_int k = 0; k < pp->P * pp->P; k++)
-        {
-                LTFAT_NAME(dgtrealmp_kernel_done)( &pp->gramkerns[k]);
-        }
-
-        ltfat_free(pp->gramkerns);
-        pp->gramkerns = NULL;
-    }
-
     if (pp->iterstate)
         LTFAT_NAME(dgtrealmpiter_done)(&pp->iterstate);
 
+    if (pp->dict)
+        LTFAT_NAME(dgtrealmp_dict_done)(&pp->dict);
+
     ltfat_free(pp);
     *p = NULL;
 error:
@@ -561,7 +754,7 @@ error:
 int
 LTFAT_NAME(dgtrealmpiter_init)(
     ltfat_int a[], ltfat_int M[], ltfat_int P, ltfat_int L,
-    LTFAT_NAME(dgtrealmpiter_state)** state)
+    ltfat_dgtmp_searchtree tree, LTFAT_NAME(dgtrealmpiter_state)** state)
 {
     LTFAT_NAME(dgtrealmpiter_state)* s = NULL;
     int status = LTFATERR_FAILED;
@@ -576,6 +769,7 @@ LTFAT_NAME(dgtrealmpiter_init)(
     CHECKMEM( s->tmaxtree =  LTFAT_NEWARRAY( LTFAT_NAME(maxtree)*, P));
     CHECKMEM( s->fmaxtree =  LTFAT_NEWARRAY( LTFAT_NAME(maxtree)**, P));
     s->P = P;
+    s->nthreads = 1;
 
     for (ltfat_int p = 0; p < P; p++)
     {
@@ -586,17 +780,29 @@ LTFAT_NAME(dgtrealmpiter_init)(
         CHECKMEM( s->suppind[p] = LTFAT_NEWARRAY(unsigned int, N * M2 ));
         CHECKMEM( s->maxcols[p]    = LTFAT_NAME_REAL(malloc)(N) );
         CHECKMEM( s->maxcolspos[p] = LTFAT_NEWARRAY(ltfat_int, N) );
-        CHECKSTATUS( LTFAT_NAME(maxtree_init)(N, N,
-                                              ltfat_imax(0, ltfat_pow2base(ltfat_nextpow2(N)) - 4),
-                                              &s->tmaxtree[p]));
-
         CHECKMEM( s->fmaxtree[p] = LTFAT_NEWARRAY(LTFAT_NAME(maxtree)*, N));
-        for (ltfat_int n = 0; n < N; n++ )
+
+        if (tree == ltfat_dgtmp_searchtree_flat)
         {
-            CHECKSTATUS( LTFAT_NAME(maxtree_init)(
-                             M2, M[p],
-                             ltfat_imax(0, ltfat_pow2base(ltfat_nextpow2(M[p])) - 4),
-                             &s->fmaxtree[p][n]));
+            CHECKSTATUS( LTFAT_NAME(maxtree_init_flat)(N, N, &s->tmaxtree[p]));
+
+            for (ltfat_int n = 0; n < N; n++ )
+                CHECKSTATUS( LTFAT_NAME(maxtree_init_flat)(
+                                 M2, M[p], &s->fmaxtree[p][n]));
+        }
+        else
+        {
+            CHECKSTATUS( LTFAT_NAME(maxtree_init)(N, N,
+                             ltfat_imax(0, ltfat_pow2base(ltfat_nextpow2(N)) - 4),
+                             &s->tmaxtree[p]));
+
+            for (ltfat_int n = 0; n < N; n++ )
+            {
+                CHECKSTATUS( LTFAT_NAME(maxtree_init)(
+                                 M2, M[p],
+                                 ltfat_imax(0, ltfat_pow2base(ltfat_nextpow2(M[p])) - 4),
+                                 &s->fmaxtree[p][n]));
+            }
         }
 
     }
@@ -677,7 +883,7 @@ LTFAT_NAME(dgtrealmpiter_done)(LTFAT_NAME(dgtrealmpiter_state)** state)
 
     if (s->cvalModBuf)
     {
-        for (ltfat_int p = 0; p < s->P * s->P; p++)
+        for (ltfat_int p = 0; p < s->P * s->P * s->nthreads; p++)
             ltfat_safefree(s->cvalModBuf[p]);
 
         ltfat_free(s->cvalModBuf);
@@ -688,6 +894,10 @@ LTFAT_NAME(dgtrealmpiter_done)(LTFAT_NAME(dgtrealmpiter_state)** state)
     ltfat_safefree(s->cvalinvBuf);
     ltfat_safefree(s->cvalBufPos);
     ltfat_safefree(s->pBuf);
+    ltfat_safefree(s->candBuf);
+    ltfat_safefree(s->batchPos);
+    ltfat_safefree(s->batchRange);
+    ltfat_safefree(s->batchEnergy);
     if (s->hplan) LTFAT_NAME_COMPLEX(hermsystemsolver_done)(&s->hplan);
     ltfat_safefree(s->N);
     ltfat_free(s);
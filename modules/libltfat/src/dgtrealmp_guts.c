@@ -2,6 +2,64 @@
 #include "ltfat/types.h"
 #include "ltfat/macros.h"
 #include "dgtrealmp_private.h"
+#include "threads_private.h"
+#include "simd_private.h"
+
+/* c[i] += a * k[i] for i < n */
+static inline void
+LTFAT_NAME(dgtrealmp_caxpy)(LTFAT_COMPLEX a, const LTFAT_COMPLEX* k,
+                            ltfat_int n, LTFAT_COMPLEX* c)
+{
+    const LTFAT_REAL* kp = (const LTFAT_REAL*) k;
+    LTFAT_REAL* cp = (LTFAT_REAL*) c;
+    const LTFAT_REAL ar = ltfat_real(a), ai = ltfat_imag(a);
+    ltfat_int ii = 0;
+#ifdef LTFAT_SIMD
+    const ltfat_simd_v arv = V_SET1(ar);
+    const ltfat_simd_v aiv = V_PAIR(-ai, ai);
+
+    for (; ii + LTFAT_SIMD_VL <= n; ii += LTFAT_SIMD_VL)
+    {
+        ltfat_simd_v kv = V_LOAD(kp + 2 * ii);
+        ltfat_simd_v t = V_ADD(V_MUL(kv, arv), V_MUL(V_SWAP(kv), aiv));
+        V_STORE(cp + 2 * ii, V_ADD(V_LOAD(cp + 2 * ii), t));
+    }
+#endif
+    for (; ii < n; ii++)
+    {
+        cp[2 * ii]     += kp[2 * ii] * ar - kp[2 * ii + 1] * ai;
+        cp[2 * ii + 1] += kp[2 * ii + 1] * ar + kp[2 * ii] * ai;
+    }
+}
+
+/* c[i] += a[i] * k[i] for i < n */
+static inline void
+LTFAT_NAME(dgtrealmp_cvmuladd)(const LTFAT_COMPLEX* a, const LTFAT_COMPLEX* k,
+                               ltfat_int n, LTFAT_COMPLEX* c)
+{
+    const LTFAT_REAL* ap = (const LTFAT_REAL*) a;
+    const LTFAT_REAL* kp = (const LTFAT_REAL*) k;
+    LTFAT_REAL* cp = (LTFAT_REAL*) c;
+    ltfat_int ii = 0;
+#ifdef LTFAT_SIMD
+    const ltfat_simd_v sgnv = V_PAIR(-1.0, 1.0);
+
+    for (; ii + LTFAT_SIMD_VL <= n; ii += LTFAT_SIMD_VL)
+    {
+        ltfat_simd_v av = V_LOAD(ap + 2 * ii);
+        ltfat_simd_v kv = V_LOAD(kp + 2 * ii);
+        ltfat_simd_v t = V_ADD(V_MUL(V_DUPRE(av), kv),
+                               V_MUL(V_MUL(V_DUPIM(av), V_SWAP(kv)), sgnv));
+        V_STORE(cp + 2 * ii, V_ADD(V_LOAD(cp + 2 * ii), t));
+    }
+#endif
+    for (; ii < n; ii++)
+    {
+        const LTFAT_REAL ar = ap[2 * ii], ai = ap[2 * ii + 1];
+        cp[2 * ii]     += kp[2 * ii] * ar - kp[2 * ii + 1] * ai;
+        cp[2 * ii + 1] += kp[2 * ii + 1] * ar + kp[2 * ii] * ai;
+    }
+}
 
 #define NLOOP \
     for ( ltfat_int nidx = n2start, knidx = kstart2.n; \
@@ -25,45 +83,50 @@ for ( ltfat_int nidx = n2start, knidx = kstart2.n; \
           midx = ++midx>=p->M[w2]? midx - p->M[w2]: midx, kmidx += k->Mstep)
 
 
-#define  MLOOPBOTH(body){\
+/* The two row ranges of a column, the first one wrapping around the top.
+ * midx is the first row of the residuum, mmidx the first row of the kernel
+ * phase and mlen the length of the range. */
+#define  MRANGES(body){\
 ltfat_int movertmp = ltfat_imin(mover - k->srange[knidx].end, p->M2[w2]);\
-for ( ltfat_int midx = 0, mmidx = (kdim2.height-moverM2), kmidx = kstart2.m + mmidx*k->Mstep; \
-    midx < movertmp; midx++, mmidx++, kmidx+=k->Mstep ) {body}\
+{ ltfat_int midx = 0, mmidx = kdim2.height - moverM2, mlen = movertmp;\
+  if (mlen > 0) {body} }\
 \
 ltfat_int m2endtmp = ltfat_imin(m2end - k->srange[knidx].end, p->M2[w2]);\
-for ( ltfat_int mmidx = k->srange[knidx].start, midx = m2start + mmidx, kmidx = kstart2.m + mmidx*k->Mstep; \
-    midx < m2endtmp; midx++, mmidx++, kmidx+=k->Mstep ) {body}}\
+{ ltfat_int mmidx = k->srange[knidx].start, midx = m2start + mmidx,\
+            mlen = m2endtmp - midx;\
+  if (mlen > 0) {body} }}
 
+/* The sign is folded into the coefficient, the kernel is read from its
+ * Mstep phase kstart2.m with kdim2.height rows per column */
 #define LTFAT_DGTREALMP_APPLYKERNEL(ctmp){\
-LTFAT_COMPLEX cvaltmp = ctmp;\
-if (do_substract){ LTFAT_DGTREALMP_APPLYKERNEL_SIGN(cvaltmp, -) }\
-else{              LTFAT_DGTREALMP_APPLYKERNEL_SIGN(cvaltmp, +) }}
-
-#define LTFAT_DGTREALMP_APPLYKERNEL_SIGN(ctmp, SIGN){\
+LTFAT_COMPLEX cvaltmp = do_substract ? -(ctmp) : (ctmp);\
+LTFAT_COMPLEX* kph = k->kvalph[kstart2.m];\
 if (p->params->ptype == LTFAT_TIMEINV){\
 NLOOPBOTH(\
     LTFAT_COMPLEX* currcCol = s->c[w2] + nidx * p->M2[w2];\
-    LTFAT_COMPLEX* kcurrCol = k->kval + knidx * k->size.height;\
-    LTFAT_COMPLEX  cvaltmp2 = ctmp * kexp[knidx];\
-MLOOPBOTH(\
-    currcCol[midx] = currcCol[midx] SIGN (cvaltmp2) * kcurrCol[kmidx]; ))}\
+    LTFAT_COMPLEX* kcurrCol = kph + knidx * kdim2.height;\
+    LTFAT_COMPLEX  cvaltmp2 = cvaltmp * kexp[knidx];\
+MRANGES(\
+    LTFAT_NAME(dgtrealmp_caxpy)(cvaltmp2, kcurrCol + mmidx, mlen,\
+                                currcCol + midx); ))}\
 else if (p->params->ptype == LTFAT_FREQINV){\
     for(ltfat_int kmidx = kstart2.m, mmidx = 0; kmidx < k->size.height;\
         kmidx += k->Mstep, mmidx++){\
-        s->cvalModBuf[kIdx][mmidx] = ctmp * kexp[kmidx];}\
+        cvalModBuf[kIdx][mmidx] = cvaltmp * kexp[kmidx];}\
 NLOOPBOTH(\
     LTFAT_COMPLEX* currcCol = s->c[w2] + nidx * p->M2[w2];\
-    LTFAT_COMPLEX* kcurrCol = k->kval + knidx * k->size.height;\
-MLOOPBOTH(\
-    currcCol[midx] = currcCol[midx] SIGN s->cvalModBuf[kIdx][mmidx] * kcurrCol[kmidx]; \
-    ))}}
+    LTFAT_COMPLEX* kcurrCol = kph + knidx * kdim2.height;\
+MRANGES(\
+    LTFAT_NAME(dgtrealmp_cvmuladd)(cvalModBuf[kIdx] + mmidx, kcurrCol + mmidx,\
+                                   mlen, currcCol + midx); ))}}
 
 #define LTFAT_DGTREALMP_MARKMODIFIED \
 NLOOPBOTH(\
     LTFAT_NAME(maxtree_setdirty)(s->fmaxtree[w2][nidx],\
                                  m2start + k->srange[knidx].start,\
                                  m2start + kdim2.height - k->srange[knidx].end);)\
-    LTFAT_NAME(maxtree_setdirty)(s->tmaxtree[w2],       n2start, n2start + kdim2.width);
+    if (do_marktmaxtree)\
+        LTFAT_NAME(maxtree_setdirty)(s->tmaxtree[w2],   n2start, n2start + kdim2.width);
 
 int
 LTFAT_NAME(dgtrealmp_execute_locomp)(
@@ -506,7 +569,19 @@ LTFAT_NAME(dgtrealmp_execute_updateresiduum)(
     LTFAT_NAME(dgtrealmp_state)* p, kpoint origpos, LTFAT_COMPLEX cval,
     int do_substract)
 {
+    return LTFAT_NAME(dgtrealmp_execute_updateresiduum_buf)(
+               p, origpos, cval, do_substract, p->iterstate->cvalModBuf, 1);
+}
 
+/* Same as dgtrealmp_execute_updateresiduum with the FREQINV modulation
+ * buffers passed explicitly. The dirty range of tmaxtree is only marked if
+ * do_marktmaxtree is nonzero so that updates of atoms touching disjoint
+ * columns can run concurrently. */
+int
+LTFAT_NAME(dgtrealmp_execute_updateresiduum_buf)(
+    LTFAT_NAME(dgtrealmp_state)* p, kpoint origpos, LTFAT_COMPLEX cval,
+    int do_substract, LTFAT_COMPLEX** cvalModBuf, int do_marktmaxtree)
+{
 
     int uniquenyquest = p->M[origpos.w] % 2 == 0;
     int do_conj = !( origpos.m == 0 ||
@@ -577,6 +652,203 @@ LTFAT_NAME(dgtrealmp_execute_updateresiduum)(
     return 0;
 }
 
+/* Time range [start,end) of the columns of dictionary w2 the kernel
+ * centered at pos reaches. end can exceed N[w2], the range then wraps. */
+static void
+LTFAT_NAME(dgtrealmp_batchmp_timerange)(
+    LTFAT_NAME(dgtrealmp_state)* p, kpoint origpos, ltfat_int w2,
+    ltfat_int range[2])
+{
+    ltfat_int m2start, n2start;
+    ksize   kdim2; kanchor kmid2; kpoint  kstart2;
+    kpoint pos; pos.w = w2;
+
+    LTFAT_NAME(dgtrealmp_execute_indices)(
+        p, origpos, &pos, &m2start, &n2start, &kdim2, &kmid2, &kstart2);
+
+    range[0] = n2start;
+    range[1] = n2start + ltfat_imin(kdim2.width, p->N[w2]);
+}
+
+static int
+LTFAT_NAME(dgtrealmp_batchmp_overlap)(
+    const ltfat_int r1[2], const ltfat_int r2[2], ltfat_int N)
+{
+    return ltfat_positiverem(r2[0] - r1[0], N) < r1[1] - r1[0] ||
+           ltfat_positiverem(r1[0] - r2[0], N) < r2[1] - r2[0];
+}
+
+/* Excludes columns start..end-1 of dictionary w from the search for the
+ * maximum by lowering their maxima below any energy */
+static void
+LTFAT_NAME(dgtrealmp_batchmp_mask)(
+    LTFAT_NAME(dgtrealmp_state)* p, ltfat_int w, ltfat_int start, ltfat_int end)
+{
+    LTFAT_NAME(dgtrealmpiter_state)* s = p->iterstate;
+
+    for (ltfat_int nidx = start; nidx < end; nidx++)
+        s->maxcols[w][nidx % p->N[w]] = (LTFAT_REAL) -1.0;
+
+    LTFAT_NAME(maxtree_updaterange)(s->tmaxtree[w], start, end);
+}
+
+static int
+LTFAT_NAME(dgtrealmp_batchmp_findmax)(
+    LTFAT_NAME(dgtrealmp_state)* p, kpoint* pos)
+{
+    LTFAT_NAME(dgtrealmpiter_state)* s = p->iterstate;
+    LTFAT_REAL val = 0.0;
+    int found = 0;
+
+    for (ltfat_int k = 0; k < s->P; k++)
+    {
+        LTFAT_REAL valTmp; ltfat_int nTmp;
+        LTFAT_NAME(maxtree_findmax)(s->tmaxtree[k], &valTmp, &nTmp);
+
+        if ( valTmp > val )
+        {
+            val = valTmp; *pos = kpoint_init(s->maxcolspos[k][nTmp], nTmp, k);
+            found = 1;
+        }
+    }
+    return found;
+}
+
+typedef struct
+{
+    LTFAT_NAME(dgtrealmp_state)* p;
+    LTFAT_COMPLEX** cout;
+} LTFAT_NAME(dgtrealmp_batchmp_job);
+
+/* MP steps of the batch atoms start..end-1. The atoms touch disjoint
+ * columns, so the residuum and the column max-trees can be updated
+ * concurrently. */
+static void
+LTFAT_NAME(dgtrealmp_batchmp_range)(void* userdata, ltfat_int start,
+                                    ltfat_int end, int threadid)
+{
+    LTFAT_NAME(dgtrealmp_batchmp_job)* job =
+        (LTFAT_NAME(dgtrealmp_batchmp_job)*) userdata;
+    LTFAT_NAME(dgtrealmp_state)* p = job->p;
+    LTFAT_NAME(dgtrealmpiter_state)* s = p->iterstate;
+    LTFAT_COMPLEX** cvalModBuf =
+        s->cvalModBuf ? s->cvalModBuf + threadid * s->P * s->P : NULL;
+
+    for (ltfat_int b = start; b < end; b++)
+    {
+        kpoint pos = s->batchPos[b];
+        const ltfat_int* range = s->batchRange + 2 * s->P * b;
+        LTFAT_COMPLEX cvaldual;
+
+        LTFAT_NAME(dgtrealmp_execute_dualprodandprojenergy)(
+            p, pos, s->c[PTOI(pos)], &cvaldual, &s->batchEnergy[b]);
+
+        LTFAT_NAME(dgtrealmp_execute_updateresiduum_buf)(
+            p, pos, cvaldual, 1, cvalModBuf, 0);
+
+        s->suppind[PTOI(pos)]++;
+        job->cout[PTOI(pos)] += cvaldual;
+
+        for (ltfat_int w2 = 0; w2 < s->P; w2++)
+        {
+            for (ltfat_int nidx = range[2 * w2]; nidx < range[2 * w2 + 1]; nidx++)
+            {
+                ltfat_int n = nidx % p->N[w2];
+                LTFAT_NAME(maxtree_findmax)( s->fmaxtree[w2][n],
+                                             &s->maxcols[w2][n],
+                                             &s->maxcolspos[w2][n]);
+            }
+        }
+    }
+}
+
+int
+LTFAT_NAME(dgtrealmp_execute_batchmp)(
+    LTFAT_NAME(dgtrealmp_state)* p,
+    kpoint origpos, size_t maxbatch, LTFAT_COMPLEX** cout, size_t* batchNo)
+{
+    LTFAT_NAME(dgtrealmpiter_state)* s = p->iterstate;
+    LTFAT_NAME(dgtrealmp_batchmp_job) job;
+    size_t bNo = 0, rejNo = 0;
+    kpoint pos = origpos;
+
+    if (maxbatch > s->batchSize) maxbatch = s->batchSize;
+    if (maxbatch < 1) maxbatch = 1;
+
+    // STEP 1: Take the column maxima in descending order and keep those
+    // not interacting with any atom kept before. The columns the kept atoms
+    // reach and the rejected columns are masked in the time max-trees.
+    while (1)
+    {
+        ltfat_int* range = s->batchRange + 2 * s->P * bNo;
+        int do_keep = 1;
+
+        for (ltfat_int w2 = 0; w2 < s->P; w2++)
+            LTFAT_NAME(dgtrealmp_batchmp_timerange)(p, pos, w2, range + 2 * w2);
+
+        for (size_t b = 0; b < bNo && do_keep; b++)
+            for (ltfat_int w2 = 0; w2 < s->P && do_keep; w2++)
+                if (LTFAT_NAME(dgtrealmp_batchmp_overlap)(
+                        s->batchRange + 2 * s->P * b + 2 * w2, range + 2 * w2,
+                        p->N[w2]))
+                    do_keep = 0;
+
+        if (do_keep)
+        {
+            if ( !s->suppind[PTOI(pos)] ) s->curratoms++;
+            s->batchPos[bNo++] = pos;
+        }
+        else
+            s->candBuf[rejNo++] = pos;
+
+        if (bNo == maxbatch ||
+            bNo + rejNo >= LTFAT_DGTREALMP_BATCHCANDS * maxbatch)
+            break;
+
+        if (do_keep)
+            for (ltfat_int w2 = 0; w2 < s->P; w2++)
+                LTFAT_NAME(dgtrealmp_batchmp_mask)(p, w2, range[2 * w2],
+                                                   range[2 * w2 + 1]);
+        else
+            LTFAT_NAME(dgtrealmp_batchmp_mask)(p, pos.w, pos.n, pos.n + 1);
+
+        if (!LTFAT_NAME(dgtrealmp_batchmp_findmax)(p, &pos) ||
+            ltfat_norm(s->c[PTOI(pos)]) < p->params->atprodreltoladj)
+            break;
+    }
+
+    // STEP 2: Update the residuum around all atoms at once
+    job.p = p; job.cout = cout;
+    ltfat_parallel_for(s->nthreads, bNo,
+                       LTFAT_NAME(dgtrealmp_batchmp_range), &job);
+
+    // STEP 3: Unmask the rejected columns, they were not modified unless
+    // a kept atom reaches them
+    for (size_t r = 0; r < rejNo; r++)
+    {
+        kpoint rpos = s->candBuf[r];
+        LTFAT_NAME(maxtree_findmax)( s->fmaxtree[rpos.w][rpos.n],
+                                     &s->maxcols[rpos.w][rpos.n],
+                                     &s->maxcolspos[rpos.w][rpos.n]);
+        LTFAT_NAME(maxtree_updaterange)(s->tmaxtree[rpos.w], rpos.n, rpos.n + 1);
+    }
+
+    // STEP 4: Time max-trees and the error, in a fixed order
+    for (size_t b = 0; b < bNo; b++)
+    {
+        const ltfat_int* range = s->batchRange + 2 * s->P * b;
+
+        for (ltfat_int w2 = 0; w2 < s->P; w2++)
+            LTFAT_NAME(maxtree_updaterange)(s->tmaxtree[w2],
+                                            range[2 * w2], range[2 * w2 + 1]);
+
+        s->err -= s->batchEnergy[b];
+    }
+
+    *batchNo = bNo;
+    return LTFAT_DGTREALMP_STATUS_CANCONTINUE;
+}
+
 inline LTFAT_COMPLEX*
 LTFAT_NAME(dgtrealmp_execute_pickmod)(
     LTFAT_NAME(kerns)* k, ltfat_int m, ltfat_int n,
@@ -17,6 +17,9 @@ LTFAT_NAME(dgtrealmp_kernel_init)(
     LTFAT_NAME(kerns)* ktmp = NULL;
     ltfat_int kernskip = 1;
     LTFAT_COMPLEX* kvalwmid;
+    ltfat_dgtmp_kernelkey key;
+    double absthr;
+    int is_cached;
     int status = LTFATERR_SUCCESS;
 
     CHECKMEM( ktmp = LTFAT_NEW(LTFAT_NAME(kerns)) );
@@ -42,22 +45,51 @@ LTFAT_NAME(dgtrealmp_kernel_init)(
 
     Nshort = Lshort / amin;
 
-    CHECKMEM(g0tmp     = LTFAT_NAME_REAL(malloc)(Lshort));
-    CHECKMEM(g1tmp     = LTFAT_NAME_REAL(malloc)(Lshort));
-    CHECKMEM(kernlarge = LTFAT_NAME_COMPLEX(malloc)(Mmax * Nshort));
+    key.realsize = sizeof(LTFAT_REAL); key.ptype = ptype;
+    key.Lshort = Lshort; key.reltol = reltol;
+    for (int k = 0; k < 2; k++)
+    {
+        key.a[k] = a[k]; key.M[k] = M[k]; key.gl[k] = gl[k]; key.g[k] = g[k];
+    }
+
+    CHECKSTATUS( is_cached = ltfat_dgtmp_kernelcache_find(
+                                 &key, &ktmp->size, &ktmp->mid, &absthr,
+                                 (void**) &ktmp->kval));
+
+    if (is_cached)
+    {
+        ktmp->absthr = (LTFAT_REAL) absthr;
+    }
+    else
+    {
+        CHECKMEM(g0tmp     = LTFAT_NAME_REAL(malloc)(Lshort));
+        CHECKMEM(g1tmp     = LTFAT_NAME_REAL(malloc)(Lshort));
+        CHECKMEM(kernlarge = LTFAT_NAME_COMPLEX(malloc)(Mmax * Nshort));
+
+        LTFAT_NAME(middlepad)(g[0], gl[0], LTFAT_WHOLEPOINT, Lshort, g0tmp);
+        LTFAT_NAME(middlepad)(g[1], gl[1], LTFAT_WHOLEPOINT, Lshort, g1tmp);
+
+        LTFAT_NAME_REAL(dgtreal_fb)(g0tmp, g1tmp, Lshort, Lshort, 1, amin, Mmax,
+                                    ptype, kernlarge);
+        LTFAT_NAME_COMPLEX(dgtreal2dgt)(kernlarge,Mmax,Nshort,kernlarge);
 
-    LTFAT_NAME(middlepad)(g[0], gl[0], LTFAT_WHOLEPOINT, Lshort, g0tmp);
-    LTFAT_NAME(middlepad)(g[1], gl[1], LTFAT_WHOLEPOINT, Lshort, g1tmp);
+        LTFAT_NAME(dgtrealmp_kernel_findsmallsize)(
+            kernlarge, Mmax, Nshort, reltol, &ktmp->absthr, &ktmp->size, &ktmp->mid);
 
-    LTFAT_NAME_REAL(dgtreal_fb)(g0tmp, g1tmp, Lshort, Lshort, 1, amin, Mmax,
-                                ptype, kernlarge);
-    LTFAT_NAME_COMPLEX(dgtreal2dgt)(kernlarge,Mmax,Nshort,kernlarge);
+        LTFAT_NAME_COMPLEX(circshift2)(
+            kernlarge, Mmax, Nshort, ktmp->mid.hmid, ktmp->mid.wmid, kernlarge);
 
-    LTFAT_NAME(dgtrealmp_kernel_findsmallsize)(
-        kernlarge, Mmax, Nshort, reltol, &ktmp->absthr, &ktmp->size, &ktmp->mid);
+        // Copy the zero-th kernel
+        CHECKMEM( ktmp->kval =
+                      LTFAT_NAME_COMPLEX(malloc)( ktmp->size.height * ktmp->size.width));
 
-    LTFAT_NAME_COMPLEX(circshift2)(
-        kernlarge, Mmax, Nshort, ktmp->mid.hmid, ktmp->mid.wmid, kernlarge);
+        for (ltfat_int n = 0; n < ktmp->size.width; n++)
+            memcpy(ktmp->kval + n * ktmp->size.height,
+                   kernlarge + n * Mmax, ktmp->size.height * sizeof * kernlarge);
+
+        CHECKSTATUS( ltfat_dgtmp_kernelcache_insert(
+                         &key, ktmp->size, ktmp->mid, ktmp->absthr, ktmp->kval));
+    }
 
     modNo = ltfat_lcm(amin, Mmax) / amin;
 
@@ -89,8 +121,6 @@ LTFAT_NAME(dgtrealmp_kernel_init)(
           a[0], a[1], M[0], M[1],
           ktmp->astep, ktmp->Mstep, ktmp->arat, ktmp->Mrat, Lshort);
 
-    CHECKMEM( ktmp->kval =
-                  LTFAT_NAME_COMPLEX(malloc)( ktmp->size.height * ktmp->size.width));
     CHECKMEM( ktmp->range =
                   LTFAT_NEWARRAY(krange, ktmp->size.width) );
     CHECKMEM( ktmp->srange =
@@ -104,14 +134,28 @@ LTFAT_NAME(dgtrealmp_kernel_init)(
         for (ltfat_int k = 0; k < ktmp->kNo; k++)
             CHECKMEM(ktmp->mods[k] = LTFAT_NAME_COMPLEX(malloc)(ktmp->size.width));
 
-    // Copy the zero-th kernel
-    for (ltfat_int n = 0; n < ktmp->size.width; n++)
-        memcpy(ktmp->kval + n * ktmp->size.height,
-               kernlarge + n * Mmax, ktmp->size.height * sizeof * kernlarge);
-
         /* LTFAT_COMPLEX kk = *( ktmp->kval + ktmp->mid.hmid + ktmp->mid.wmid * ktmp->size.height); */
         /* DEBUG("re=%.3f,im=%.3f", ltfat_real(kk),ltfat_imag(kk)); */
 
+    // Rows of the kernel used with the coarser lattice are Mstep apart.
+    // Store each of the Mstep phases separately such that the residuum
+    // update runs over contiguous memory.
+    CHECKMEM( ktmp->kvalph = LTFAT_NEWARRAY(LTFAT_COMPLEX*, ktmp->Mstep));
+    if (ktmp->Mstep == 1)
+        ktmp->kvalph[0] = ktmp->kval;
+    else
+        for (ltfat_int ph = 0; ph < ktmp->Mstep; ph++)
+        {
+            ltfat_int hph = ltfat_idivceil(ktmp->size.height - ph, ktmp->Mstep);
+            CHECKMEM( ktmp->kvalph[ph] =
+                          LTFAT_NAME_COMPLEX(malloc)( hph * ktmp->size.width));
+
+            for (ltfat_int n = 0; n < ktmp->size.width; n++)
+                for (ltfat_int mm = 0; mm < hph; mm++)
+                    ktmp->kvalph[ph][n * hph + mm] =
+                        ktmp->kval[n * ktmp->size.height + ph + mm * ktmp->Mstep];
+        }
+
 
     if (ptype == LTFAT_FREQINV)
         for (ltfat_int n = 0; n < ktmp->kNo; n++)
@@ -185,6 +229,13 @@ LTFAT_NAME(dgtrealmp_kernel_done)(LTFAT_NAME(kerns)** k)
 
     if(kk->cloned == 0)
     {
+        if (kk->kvalph)
+        {
+            if (kk->Mstep > 1)
+                for (ltfat_int ph = 0; ph < kk->Mstep; ph++)
+                    ltfat_safefree( kk->kvalph[ph] );
+            ltfat_free(kk->kvalph);
+        }
         ltfat_safefree(kk->kval);
     LTFAT_SAFEFREEALL( kk->range, kk->srange, kk->atprods,
                       kk->oneover1minatprodnorms);
@@ -0,0 +1,428 @@
+#include "ltfat.h"
+#include "ltfat/types.h"
+#include "ltfat/macros.h"
+#include "dgtrealmp_private.h"
+#include "wfaccache_private.h"
+#include "threads_private.h"
+
+#include <stdint.h>
+
+typedef struct ltfat_dgtmp_kernelcacheentry ltfat_dgtmp_kernelcacheentry;
+
+struct ltfat_dgtmp_kernelcacheentry
+{
+    uint64_t hash;
+    size_t realsize;
+    int ptype;
+    ltfat_int a[2];
+    ltfat_int M[2];
+    ltfat_int gl[2];
+    ltfat_int Lshort;
+    double reltol;
+    void* g[2];
+    ksize size;
+    kanchor mid;
+    double absthr;
+    void* kval;
+    uint64_t lastuse;
+    ltfat_dgtmp_kernelcacheentry* next;
+};
+
+static ltfat_mutex_t kcache_mutex = LTFAT_MUTEX_INITIALIZER;
+static ltfat_dgtmp_kernelcacheentry* kcache_head = NULL;
+static size_t kcache_limit = 64 * 1024 * 1024;
+static size_t kcache_bytes = 0;
+static uint64_t kcache_tick = 0;
+static size_t kcache_hits = 0, kcache_misses = 0, kcache_evictions = 0;
+
+/* Bumped whenever the computation of the kernels or the layout changes */
+#define LTFAT_DGTMP_KERNELCACHE_VERSION 1
+static const char kcache_magic[8] = { 'L', 'T', 'F', 'A', 'T', 'G', 'K', 'C' };
+
+static size_t
+ltfat_dgtmp_kernelcache_kvalbytes(size_t realsize, ksize size)
+{
+    return 2 * realsize * size.height * size.width;
+}
+
+static uint64_t
+ltfat_dgtmp_kernelcache_hash(const ltfat_dgtmp_kernelkey* key)
+{
+    int64_t fields[9] =
+    {
+        (int64_t) key->realsize, key->ptype, key->a[0], key->a[1],
+        key->M[0], key->M[1], key->gl[0], key->gl[1], key->Lshort
+    };
+    uint64_t h;
+
+    h = ltfat_wfac_cache_hash(fields, sizeof fields, 0);
+    h = ltfat_wfac_cache_hash(&key->reltol, sizeof key->reltol, h);
+    h = ltfat_wfac_cache_hash(key->g[0], key->gl[0] * key->realsize, h);
+    h = ltfat_wfac_cache_hash(key->g[1], key->gl[1] * key->realsize, h);
+    return h;
+}
+
+static size_t
+ltfat_dgtmp_kernelcacheentry_bytes(ltfat_dgtmp_kernelcacheentry* e)
+{
+    return sizeof * e + (e->gl[0] + e->gl[1]) * e->realsize +
+           ltfat_dgtmp_kernelcache_kvalbytes(e->realsize, e->size);
+}
+
+static void
+ltfat_dgtmp_kernelcacheentry_free(ltfat_dgtmp_kernelcacheentry* e)
+{
+    ltfat_safefree(e->g[0]);
+    ltfat_safefree(e->g[1]);
+    ltfat_safefree(e->kval);
+    ltfat_free(e);
+}
+
+static int
+ltfat_dgtmp_kernelcacheentry_matches(ltfat_dgtmp_kernelcacheentry* e,
+                                     uint64_t hash,
+                                     const ltfat_dgtmp_kernelkey* key)
+{
+    return e->hash == hash && e->realsize == key->realsize &&
+           e->ptype == key->ptype && e->Lshort == key->Lshort &&
+           e->reltol == key->reltol &&
+           e->a[0] == key->a[0] && e->a[1] == key->a[1] &&
+           e->M[0] == key->M[0] && e->M[1] == key->M[1] &&
+           e->gl[0] == key->gl[0] && e->gl[1] == key->gl[1] &&
+           !memcmp(e->g[0], key->g[0], key->gl[0] * key->realsize) &&
+           !memcmp(e->g[1], key->g[1], key->gl[1] * key->realsize);
+}
+
+static ltfat_dgtmp_kernelcacheentry*
+ltfat_dgtmp_kernelcacheentry_new(const ltfat_dgtmp_kernelkey* key,
+                                 ksize size, kanchor mid, double absthr,
+                                 const void* kval)
+{
+    ltfat_dgtmp_kernelcacheentry* e = NULL;
+    size_t kvalbytes = ltfat_dgtmp_kernelcache_kvalbytes(key->realsize, size);
+    int status = LTFATERR_SUCCESS;
+
+    CHECKMEM( e = LTFAT_NEW(ltfat_dgtmp_kernelcacheentry) );
+    CHECKMEM( e->g[0] = ltfat_malloc(key->gl[0] * key->realsize) );
+    CHECKMEM( e->g[1] = ltfat_malloc(key->gl[1] * key->realsize) );
+    CHECKMEM( e->kval = ltfat_malloc(kvalbytes) );
+
+    e->realsize = key->realsize; e->ptype = key->ptype;
+    e->Lshort = key->Lshort; e->reltol = key->reltol;
+    for (int k = 0; k < 2; k++)
+    {
+        e->a[k] = key->a[k]; e->M[k] = key->M[k]; e->gl[k] = key->gl[k];
+    }
+    e->size = size; e->mid = mid; e->absthr = absthr;
+
+    /* The windows and the values are read later when loading from a file */
+    if (key->g[0] && key->g[1] && kval)
+    {
+        memcpy(e->g[0], key->g[0], key->gl[0] * key->realsize);
+        memcpy(e->g[1], key->g[1], key->gl[1] * key->realsize);
+        memcpy(e->kval, kval, kvalbytes);
+        e->hash = ltfat_dgtmp_kernelcache_hash(key);
+    }
+
+    return e;
+error:
+    if (e) ltfat_dgtmp_kernelcacheentry_free(e);
+    return NULL;
+}
+
+/* Expects the cache to be locked.
+ * Evicts the least recently used entries until the cache holds at most
+ * limit bytes. */
+static int
+ltfat_dgtmp_kernelcache_shrink_locked(size_t limit)
+{
+    int removed = 0;
+
+    while (kcache_bytes > limit && kcache_head)
+    {
+        ltfat_dgtmp_kernelcacheentry** victim = &kcache_head;
+
+        for (ltfat_dgtmp_kernelcacheentry** e = &kcache_head; *e; e = &(*e)->next)
+            if ((*e)->lastuse < (*victim)->lastuse)
+                victim = e;
+
+        ltfat_dgtmp_kernelcacheentry* tmp = *victim;
+        *victim = tmp->next;
+        kcache_bytes -= ltfat_dgtmp_kernelcacheentry_bytes(tmp);
+        ltfat_dgtmp_kernelcacheentry_free(tmp);
+        removed++;
+    }
+
+    kcache_evictions += removed;
+    return removed;
+}
+
+/* Expects the cache to be locked */
+static ltfat_dgtmp_kernelcacheentry*
+ltfat_dgtmp_kernelcache_find_locked(uint64_t hash,
+                                    const ltfat_dgtmp_kernelkey* key)
+{
+    for (ltfat_dgtmp_kernelcacheentry* e = kcache_head; e; e = e->next)
+        if (ltfat_dgtmp_kernelcacheentry_matches(e, hash, key))
+            return e;
+
+    return NULL;
+}
+
+/* Expects the cache to be locked. Takes ownership of e. */
+static void
+ltfat_dgtmp_kernelcache_add_locked(ltfat_dgtmp_kernelcacheentry* e)
+{
+    ltfat_dgtmp_kernelkey key;
+    size_t ebytes = ltfat_dgtmp_kernelcacheentry_bytes(e);
+
+    key.realsize = e->realsize; key.ptype = e->ptype;
+    key.Lshort = e->Lshort; key.reltol = e->reltol;
+    for (int k = 0; k < 2; k++)
+    {
+        key.a[k] = e->a[k]; key.M[k] = e->M[k];
+        key.gl[k] = e->gl[k]; key.g[k] = e->g[k];
+    }
+
+    /* Another thread might have inserted the same kernel meanwhile */
+    if (ltfat_dgtmp_kernelcache_find_locked(e->hash, &key) || ebytes > kcache_limit)
+    {
+        ltfat_dgtmp_kernelcacheentry_free(e);
+        return;
+    }
+
+    ltfat_dgtmp_kernelcache_shrink_locked(kcache_limit - ebytes);
+    e->lastuse = ++kcache_tick;
+    e->next = kcache_head;
+    kcache_head = e;
+    kcache_bytes += ebytes;
+}
+
+int
+ltfat_dgtmp_kernelcache_find(const ltfat_dgtmp_kernelkey* key,
+                             ksize* size, kanchor* mid, double* absthr,
+                             void** kval)
+{
+    ltfat_dgtmp_kernelcacheentry* e;
+    uint64_t hash;
+    void* kvaltmp = NULL;
+    int found = 0;
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(key); CHECKNULL(size); CHECKNULL(mid); CHECKNULL(absthr);
+    CHECKNULL(kval);
+
+    hash = ltfat_dgtmp_kernelcache_hash(key);
+
+    ltfat_mutex_lock(&kcache_mutex);
+    e = ltfat_dgtmp_kernelcache_find_locked(hash, key);
+    if (e)
+    {
+        size_t kvalbytes = ltfat_dgtmp_kernelcache_kvalbytes(e->realsize, e->size);
+        kvaltmp = ltfat_malloc(kvalbytes);
+        if (kvaltmp)
+        {
+            memcpy(kvaltmp, e->kval, kvalbytes);
+            *size = e->size; *mid = e->mid; *absthr = e->absthr;
+            e->lastuse = ++kcache_tick;
+            kcache_hits++;
+            found = 1;
+        }
+    }
+    else
+        kcache_misses++;
+    ltfat_mutex_unlock(&kcache_mutex);
+
+    CHECKMEM(!e || kvaltmp);
+    *kval = kvaltmp;
+    return found;
+error:
+    return status;
+}
+
+int
+ltfat_dgtmp_kernelcache_insert(const ltfat_dgtmp_kernelkey* key,
+                               ksize size, kanchor mid, double absthr,
+                               const void* kval)
+{
+    ltfat_dgtmp_kernelcacheentry* e = NULL;
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(key); CHECKNULL(kval);
+
+    CHECKMEM( e = ltfat_dgtmp_kernelcacheentry_new(key, size, mid, absthr, kval));
+
+    ltfat_mutex_lock(&kcache_mutex);
+    ltfat_dgtmp_kernelcache_add_locked(e);
+    ltfat_mutex_unlock(&kcache_mutex);
+error:
+    return status;
+}
+
+LTFAT_API int
+ltfat_dgtmp_kernelcache_set_limit(size_t bytes)
+{
+    ltfat_mutex_lock(&kcache_mutex);
+    kcache_limit = bytes;
+    ltfat_dgtmp_kernelcache_shrink_locked(kcache_limit);
+    ltfat_mutex_unlock(&kcache_mutex);
+    return LTFATERR_SUCCESS;
+}
+
+LTFAT_API int
+ltfat_dgtmp_kernelcache_get_stats(ltfat_dgtmp_kernelcache_stats* stats)
+{
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(stats);
+
+    ltfat_mutex_lock(&kcache_mutex);
+    stats->bytes = kcache_bytes;
+    stats->limit = kcache_limit;
+    stats->entries = 0;
+    for (ltfat_dgtmp_kernelcacheentry* e = kcache_head; e; e = e->next)
+        stats->entries++;
+    stats->hits = kcache_hits;
+    stats->misses = kcache_misses;
+    stats->evictions = kcache_evictions;
+    ltfat_mutex_unlock(&kcache_mutex);
+error:
+    return status;
+}
+
+LTFAT_API int
+ltfat_dgtmp_kernelcache_clear(void)
+{
+    int removed;
+
+    ltfat_mutex_lock(&kcache_mutex);
+    removed = ltfat_dgtmp_kernelcache_shrink_locked(0);
+    ltfat_mutex_unlock(&kcache_mutex);
+
+    return removed;
+}
+
+/*
+ * The file starts with the magic "LTFATGKC", the version and the byte order
+ * mark 0x01020304 as uint32. Each entry then consists of
+ *
+ *   int64   realsize ptype a[0] a[1] M[0] M[1] gl[0] gl[1] Lshort
+ *           height width hmid wmid
+ *   double  reltol absthr
+ *           g[0], g[1] and the kernel values as stored in memory
+ *
+ * in the native byte order. Files with a different version or byte order
+ * are rejected as a whole.
+ */
+#define LTFAT_DGTMP_KERNELCACHE_NFIELDS 13
+
+LTFAT_API int
+ltfat_dgtmp_kernelcache_load(const char* path)
+{
+    FILE* fp = NULL;
+    char magic[8];
+    uint32_t head[2];
+    ltfat_dgtmp_kernelcacheentry* e = NULL;
+    int status = LTFATERR_SUCCESS;
+
+    CHECKNULL(path);
+    fp = fopen(path, "rb");
+    CHECK(LTFATERR_FAILED, fp, "Cannot open %s", path);
+
+    CHECK(LTFATERR_FAILED,
+          fread(magic, 1, sizeof magic, fp) == sizeof magic &&
+          !memcmp(magic, kcache_magic, sizeof magic) &&
+          fread(head, sizeof head[0], 2, fp) == 2,
+          "%s is not a kernel cache file", path);
+    CHECK(LTFATERR_FAILED,
+          head[0] == LTFAT_DGTMP_KERNELCACHE_VERSION && head[1] == 0x01020304,
+          "%s was written by an incompatible version or platform", path);
+
+    while (1)
+    {
+        int64_t f[LTFAT_DGTMP_KERNELCACHE_NFIELDS];
+        double d[2];
+        ltfat_dgtmp_kernelkey key;
+        ksize size; kanchor mid;
+        size_t nread = fread(f, sizeof f[0], LTFAT_DGTMP_KERNELCACHE_NFIELDS, fp);
+
+        if (nread == 0 && feof(fp))
+            break;
+
+        CHECK(LTFATERR_FAILED,
+              nread == LTFAT_DGTMP_KERNELCACHE_NFIELDS &&
+              fread(d, sizeof d[0], 2, fp) == 2, "%s is truncated", path);
+        CHECK(LTFATERR_FAILED,
+              (f[0] == sizeof(float) || f[0] == sizeof(double)) &&
+              f[6] > 0 && f[7] > 0 && f[9] > 0 && f[10] > 0 &&
+              f[11] >= 0 && f[11] < f[9] && f[12] >= 0 && f[12] < f[10],
+              "%s is corrupted", path);
+
+        key.realsize = (size_t) f[0]; key.ptype = (int) f[1];
+        key.a[0] = f[2]; key.a[1] = f[3]; key.M[0] = f[4]; key.M[1] = f[5];
+        key.gl[0] = f[6]; key.gl[1] = f[7]; key.Lshort = f[8];
+        key.reltol = d[0];
+        key.g[0] = NULL; key.g[1] = NULL;
+        size.height = f[9]; size.width = f[10];
+        mid.hmid = f[11]; mid.wmid = f[12];
+
+        CHECKMEM( e = ltfat_dgtmp_kernelcacheentry_new(&key, size, mid, d[1], NULL));
+        CHECK(LTFATERR_FAILED,
+              fread(e->g[0], e->realsize, e->gl[0], fp) == (size_t) e->gl[0] &&
+              fread(e->g[1], e->realsize, e->gl[1], fp) == (size_t) e->gl[1] &&
+              fread(e->kval, 2 * e->realsize, size.height * size.width, fp) ==
+              (size_t)(size.height * size.width), "%s is truncated", path);
+
+        key.g[0] = e->g[0]; key.g[1] = e->g[1];
+        e->hash = ltfat_dgtmp_kernelcache_hash(&key);
+
+        ltfat_mutex_lock(&kcache_mutex);
+        ltfat_dgtmp_kernelcache_add_locked(e);
+        ltfat_mutex_unlock(&kcache_mutex);
+        e = NULL;
+    }
+
+error:
+    if (e) ltfat_dgtmp_kernelcacheentry_free(e);
+    if (fp) fclose(fp);
+    return status;
+}
+
+LTFAT_API int
+ltfat_dgtmp_kernelcache_save(const char* path)
+{
+    FILE* fp = NULL;
+    uint32_t head[2] = { LTFAT_DGTMP_KERNELCACHE_VERSION, 0x01020304 };
+    int werr = 0;
+    int status = LTFATERR_SUCCESS;
+
+    CHECKNULL(path);
+    fp = fopen(path, "wb");
+    CHECK(LTFATERR_FAILED, fp, "Cannot open %s", path);
+
+    werr |= fwrite(kcache_magic, 1, sizeof kcache_magic, fp) != sizeof kcache_magic;
+    werr |= fwrite(head, sizeof head[0], 2, fp) != 2;
+
+    ltfat_mutex_lock(&kcache_mutex);
+    for (ltfat_dgtmp_kernelcacheentry* e = kcache_head; e && !werr; e = e->next)
+    {
+        int64_t f[LTFAT_DGTMP_KERNELCACHE_NFIELDS] =
+        {
+            (int64_t) e->realsize, e->ptype, e->a[0], e->a[1], e->M[0], e->M[1],
+            e->gl[0], e->gl[1], e->Lshort,
+            e->size.height, e->size.width, e->mid.hmid, e->mid.wmid
+        };
+        double d[2] = { e->reltol, e->absthr };
+        size_t kvalno = e->size.height * e->size.width;
+
+        werr |= fwrite(f, sizeof f[0], LTFAT_DGTMP_KERNELCACHE_NFIELDS, fp) !=
+                LTFAT_DGTMP_KERNELCACHE_NFIELDS;
+        werr |= fwrite(d, sizeof d[0], 2, fp) != 2;
+        werr |= fwrite(e->g[0], e->realsize, e->gl[0], fp) != (size_t) e->gl[0];
+        werr |= fwrite(e->g[1], e->realsize, e->gl[1], fp) != (size_t) e->gl[1];
+        werr |= fwrite(e->kval, 2 * e->realsize, kvalno, fp) != kvalno;
+    }
+    ltfat_mutex_unlock(&kcache_mutex);
+
+    CHECK(LTFATERR_FAILED, !werr, "Could not write %s", path);
+error:
+    if (fp) fclose(fp);
+    return status;
+}
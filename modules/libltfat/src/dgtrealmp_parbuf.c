@@ -356,3 +356,33 @@ LTFAT_NAME(dgtrealmp_setparbuf_pedanticsearch)(
 error:
     return status;
 }
+
+LTFAT_API int
+LTFAT_NAME(dgtrealmp_setparbuf_nthreads)(
+    LTFAT_NAME(dgtrealmp_parbuf)* p, int nthreads)
+{
+    int status = LTFATERR_FAILED; CHECKNULL(p);
+    return ltfat_dgtmp_setpar_nthreads(p->params, nthreads);
+error:
+    return status;
+}
+
+LTFAT_API int
+LTFAT_NAME(dgtrealmp_setparbuf_batchsize)(
+    LTFAT_NAME(dgtrealmp_parbuf)* p, size_t batchsize)
+{
+    int status = LTFATERR_FAILED; CHECKNULL(p);
+    return ltfat_dgtmp_setpar_batchsize(p->params, batchsize);
+error:
+    return status;
+}
+
+LTFAT_API int
+LTFAT_NAME(dgtrealmp_setparbuf_searchtree)(
+    LTFAT_NAME(dgtrealmp_parbuf)* p, ltfat_dgtmp_searchtree tree)
+{
+    int status = LTFATERR_FAILED; CHECKNULL(p);
+    return ltfat_dgtmp_setpar_searchtree(p->params, tree);
+error:
+    return status;
+}
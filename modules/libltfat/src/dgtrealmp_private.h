@@ -3,6 +3,7 @@
 #include "ltfat.h"
 #include "ltfat/types.h"
 #include "ltfat/macros.h"
+#include "threads_private.h"
 
 struct LTFAT_NAME(dgtrealmp_parbuf)
 {
@@ -37,6 +38,9 @@ struct ltfat_dgtmp_params
     size_t                cycles;
     ltfat_phaseconvention ptype;
     int                   do_pedantic;
+    int                   nthreads;
+    size_t                batchsize;
+    ltfat_dgtmp_searchtree searchtree;
 };
 
 typedef struct
@@ -69,6 +73,9 @@ typedef struct
 #define kpoint_init2(m,n,n2,w) LTFAT_STRUCTINIT(kpoint,m,n,w,n2)
 #define kpoint_isequal(k1,k2) (k1.m == k2.m && k1.n == k2.n && k1.w == k2.w)
 
+/* Number of column maxima examined for each atom of a batch */
+#define LTFAT_DGTREALMP_BATCHCANDS 4
+
 
 typedef struct
 {
@@ -78,6 +85,7 @@ typedef struct
     ltfat_int         kSkip;
     LTFAT_COMPLEX**    mods;
     LTFAT_COMPLEX*     kval;
+    LTFAT_COMPLEX**  kvalph; // Mstep phases of kval, columns contiguous
     krange*           range;
     krange*          srange;
     LTFAT_REAL       absthr;
@@ -118,6 +126,13 @@ typedef struct
     kpoint*                pBuf;
     size_t                 pBufSize;
     size_t                 pBufNo;
+    // BatchMP related
+    int                    nthreads;   // cvalModBuf holds nthreads blocks of P*P
+    size_t                 batchSize;
+    kpoint*                candBuf;    // Rejected candidates
+    kpoint*                batchPos;
+    ltfat_int*             batchRange; // [start,end) time range in each dict
+    LTFAT_REAL*            batchEnergy;
 } LTFAT_NAME(dgtrealmpiter_state);
 
 
@@ -128,13 +143,31 @@ typedef struct
     LTFAT_NAME(dgtrealmp_state)* state;
 } LTFAT_NAME(dgtrealmp_state_closure);
 
-struct LTFAT_NAME(dgtrealmp_state)
+struct LTFAT_NAME(dgtrealmp_dict)
 {
-    LTFAT_NAME(dgtrealmpiter_state)* iterstate;
     LTFAT_NAME(kerns)**             gramkerns; // PxP plans
     LTFAT_NAME(dgtreal_plan)**       dgtplans;  // P plans
     ltfat_int*        a;
     ltfat_int*        M;
+    int*       chanmask;
+    ltfat_int         P;
+    ltfat_int         L;
+    ltfat_dgtmp_params* params;
+    LTFAT_NAME(dgtrealmp_iterstep_callback)* callback;
+    void* userdata;
+    ltfat_mutex_t      lock; // Guards refcount
+    int            refcount; // The owner plus one for each state
+};
+
+struct LTFAT_NAME(dgtrealmp_state)
+{
+    LTFAT_NAME(dgtrealmpiter_state)* iterstate;
+    LTFAT_NAME(dgtrealmp_dict)*          dict;
+    LTFAT_NAME(kerns)**             gramkerns; // Borrowed from dict
+    LTFAT_NAME(dgtreal_plan)**       dgtplans;  // Borrowed from dict
+    void*                           dgtws;     // Workspace for dgtplans
+    ltfat_int*        a;
+    ltfat_int*        M;
     ltfat_int*       M2;
     ltfat_int*        N;
     int*       chanmask;
@@ -181,7 +214,7 @@ extern "C" {
 int
 LTFAT_NAME(dgtrealmpiter_init)(
     ltfat_int a[], ltfat_int M[], ltfat_int P, ltfat_int L,
-    LTFAT_NAME(dgtrealmpiter_state)** state);
+    ltfat_dgtmp_searchtree tree, LTFAT_NAME(dgtrealmpiter_state)** state);
 
 int
 LTFAT_NAME(dgtrealmpiter_done)(LTFAT_NAME(dgtrealmpiter_state)** state);
@@ -266,6 +299,11 @@ LTFAT_NAME(dgtrealmp_execute_updateresiduum)(
     LTFAT_NAME(dgtrealmp_state)* p, kpoint pos, LTFAT_COMPLEX cval,
     int do_substract);
 
+int
+LTFAT_NAME(dgtrealmp_execute_updateresiduum_buf)(
+    LTFAT_NAME(dgtrealmp_state)* p, kpoint pos, LTFAT_COMPLEX cval,
+    int do_substract, LTFAT_COMPLEX** cvalModBuf, int do_marktmaxtree);
+
 LTFAT_REAL
 LTFAT_NAME(dgtrealmp_execute_atenergy)(
     LTFAT_COMPLEX ainprod, LTFAT_COMPLEX cval);
@@ -299,6 +337,11 @@ LTFAT_NAME(dgtrealmp_execute_selfprojmp)(
     LTFAT_NAME(dgtrealmp_state)* p,
     kpoint origpos, LTFAT_COMPLEX** cout);
 
+int
+LTFAT_NAME(dgtrealmp_execute_batchmp)(
+    LTFAT_NAME(dgtrealmp_state)* p,
+    kpoint origpos, size_t maxbatch, LTFAT_COMPLEX** cout, size_t* batchNo);
+
 int
 LTFAT_NAME(dgtrealmp_execute_locomp)(
     LTFAT_NAME(dgtrealmp_state)* p,
@@ -317,6 +360,37 @@ LTFAT_NAME(dgtrealmp_execute_realatenergy)(
 LTFAT_REAL
 LTFAT_NAME(pedantic_callback)(void* userdata,
                               LTFAT_COMPLEX cval, ltfat_int pos);
+
+/* Kernel cache, see dgtrealmp_kernelcache_typeconstant.c
+ *
+ * Holds the values of the Gram kernels (before the modulations and the
+ * lookup tables are derived) identified by everything
+ * dgtrealmp_kernel_init uses to compute them. */
+typedef struct
+{
+    size_t      realsize; // sizeof(LTFAT_REAL)
+    int         ptype;
+    ltfat_int   a[2];
+    ltfat_int   M[2];
+    ltfat_int   gl[2];
+    ltfat_int   Lshort;
+    double      reltol;
+    const void* g[2];     // gl[k]*realsize bytes each
+} ltfat_dgtmp_kernelkey;
+
+/* Returns 1 and a copy of the kernel values in kval (to be freed with
+ * ltfat_free) if the kernel is in the cache, 0 otherwise */
+int
+ltfat_dgtmp_kernelcache_find(const ltfat_dgtmp_kernelkey* key,
+                             ksize* size, kanchor* mid, double* absthr,
+                             void** kval);
+
+/* Stores a copy of the kernel, kval holds size.height*size.width complex
+ * values */
+int
+ltfat_dgtmp_kernelcache_insert(const ltfat_dgtmp_kernelkey* key,
+                               ksize size, kanchor mid, double absthr,
+                               const void* kval);
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -2,6 +2,7 @@
 #include "ltfat/types.h"
 #include "ltfat/macros.h"
 #include "dgtrealmp_private.h"
+#include "threads_private.h"
 
 int
 ltfat_dgtmp_params_defaults(ltfat_dgtmp_params* params)
@@ -20,6 +21,9 @@ ltfat_dgtmp_params_defaults(ltfat_dgtmp_params* params)
     params->cycles = 1;
     params->atprodreltoldb = -80.0;
     params->ptype = LTFAT_TIMEINV;
+    params->nthreads = 0;
+    params->batchsize = 0;
+    params->searchtree = ltfat_dgtmp_searchtree_binary;
 error:
     return status;
 }
@@ -144,6 +148,46 @@ error:
     return status;
 }
 
+LTFAT_API int
+ltfat_dgtmp_setpar_nthreads(
+    ltfat_dgtmp_params* params, int nthreads)
+{
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(params);
+    CHECK(LTFATERR_NOTINRANGE, nthreads >= 0 && nthreads <= LTFAT_MAXTHREADS,
+          "nthreads (passed %d) must be in range 0-%d.", nthreads, LTFAT_MAXTHREADS);
+
+    params->nthreads = nthreads;
+error:
+    return status;
+}
+
+LTFAT_API int
+ltfat_dgtmp_setpar_batchsize(
+    ltfat_dgtmp_params* params, size_t batchsize)
+{
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(params);
+
+    params->batchsize = batchsize;
+error:
+    return status;
+}
+
+LTFAT_API int
+ltfat_dgtmp_setpar_searchtree(
+    ltfat_dgtmp_params* params, ltfat_dgtmp_searchtree tree)
+{
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(params);
+    CHECK(LTFATERR_BADARG, ltfat_dgtmp_searchtree_isvalid(tree),
+          "Invalid search tree passed (passed %d)", tree);
+
+    params->searchtree = tree;
+error:
+    return status;
+}
+
 LTFAT_API int
 ltfat_dgtmp_setpar_errtoldb(
     ltfat_dgtmp_params* params, double errtoldb)
@@ -222,6 +266,22 @@ ltfat_dgtmp_alg_isvalid(ltfat_dgtmp_alg in)
     case ltfat_dgtmp_alg_locomp:
     case ltfat_dgtmp_alg_loccyclicmp:
     case ltfat_dgtmp_alg_locselfprojmp:
+    case ltfat_dgtmp_alg_batchmp:
+        isvalid = 1;
+    }
+
+    return isvalid;
+}
+
+int
+ltfat_dgtmp_searchtree_isvalid(ltfat_dgtmp_searchtree in)
+{
+    int isvalid = 0;
+
+    switch (in)
+    {
+    case ltfat_dgtmp_searchtree_binary:
+    case ltfat_dgtmp_searchtree_flat:
         isvalid = 1;
     }
 
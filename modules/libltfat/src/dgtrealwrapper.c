@@ -1,7 +1,9 @@
 #include "ltfat.h"
 #include "ltfat/types.h"
 #include "ltfat/macros.h"
+#include "ltfat/thirdparty/fftw3.h"
 #include "dgtrealwrapper_private.h"
+#include "dgt_ola_private.h"
 
 LTFAT_API ltfat_int
 LTFAT_NAME(dgtreal_get_M)(LTFAT_NAME(dgtreal_plan)* p)
@@ -31,6 +33,20 @@ LTFAT_NAME(dgtreal_get_phaseconv)(LTFAT_NAME(dgtreal_plan)* p)
     else return LTFATERR_NULLPOINTER;
 }
 
+LTFAT_API ltfat_dgt_hint
+LTFAT_NAME(dgtreal_get_anahint)(LTFAT_NAME(dgtreal_plan)* p)
+{
+    if(p) return p->anahint;
+    else return (ltfat_dgt_hint) LTFATERR_NULLPOINTER;
+}
+
+LTFAT_API ltfat_dgt_hint
+LTFAT_NAME(dgtreal_get_synhint)(LTFAT_NAME(dgtreal_plan)* p)
+{
+    if(p) return p->synhint;
+    else return (ltfat_dgt_hint) LTFATERR_NULLPOINTER;
+}
+
 LTFAT_API ltfat_int
 LTFAT_NAME(dgtreal_get_L)(LTFAT_NAME(dgtreal_plan)* p)
 {
@@ -70,6 +86,68 @@ LTFAT_NAME(dgtreal_fb_execute_wrapper)(void* plan,
                (LTFAT_NAME(dgtreal_fb_plan)*) plan, f, L, W, c);
 }
 
+int
+LTFAT_NAME(idgtreal_long_execute_ws_wrapper)(const void* plan,
+        const LTFAT_COMPLEX* c, ltfat_int UNUSED(L), ltfat_int UNUSED(W), LTFAT_REAL* f,
+        void* ws)
+{
+    return LTFAT_NAME(idgtreal_long_execute_ws)(
+               (const LTFAT_NAME(idgtreal_long_plan)*) plan, c, f, ws);
+}
+
+int
+LTFAT_NAME(dgtreal_long_execute_ws_wrapper)(const void* plan,
+        const LTFAT_REAL* f, ltfat_int UNUSED(L), ltfat_int UNUSED(W), LTFAT_COMPLEX* c,
+        void* ws)
+{
+    return LTFAT_NAME(dgtreal_long_execute_ws)(
+               (const LTFAT_NAME(dgtreal_long_plan)*) plan, f, c, ws);
+}
+
+int
+LTFAT_NAME(idgtreal_fb_execute_ws_wrapper)(const void* plan,
+        const LTFAT_COMPLEX* c, ltfat_int L, ltfat_int W, LTFAT_REAL* f, void* ws)
+{
+    return LTFAT_NAME(idgtreal_fb_execute_ws)(
+               (const LTFAT_NAME(idgtreal_fb_plan)*) plan, c, L, W, f, ws);
+}
+
+int
+LTFAT_NAME(dgtreal_fb_execute_ws_wrapper)(const void* plan,
+        const LTFAT_REAL* f, ltfat_int L, ltfat_int W, LTFAT_COMPLEX* c, void* ws)
+{
+    return LTFAT_NAME(dgtreal_fb_execute_ws)(
+               (const LTFAT_NAME(dgtreal_fb_plan)*) plan, f, L, W, c, ws);
+}
+
+size_t
+LTFAT_NAME(idgtreal_long_workspace_size_wrapper)(const void* plan)
+{
+    return LTFAT_NAME(idgtreal_long_get_workspace_size)(
+               (const LTFAT_NAME(idgtreal_long_plan)*) plan);
+}
+
+size_t
+LTFAT_NAME(dgtreal_long_workspace_size_wrapper)(const void* plan)
+{
+    return LTFAT_NAME(dgtreal_long_get_workspace_size)(
+               (const LTFAT_NAME(dgtreal_long_plan)*) plan);
+}
+
+size_t
+LTFAT_NAME(idgtreal_fb_workspace_size_wrapper)(const void* plan)
+{
+    return LTFAT_NAME(idgtreal_fb_get_workspace_size)(
+               (const LTFAT_NAME(idgtreal_fb_plan)*) plan);
+}
+
+size_t
+LTFAT_NAME(dgtreal_fb_workspace_size_wrapper)(const void* plan)
+{
+    return LTFAT_NAME(dgtreal_fb_get_workspace_size)(
+               (const LTFAT_NAME(dgtreal_fb_plan)*) plan);
+}
+
 int
 LTFAT_NAME(idgtreal_long_done_wrapper)(void** plan)
 {
@@ -94,6 +172,65 @@ LTFAT_NAME(dgtreal_fb_done_wrapper)(void** plan)
     return LTFAT_NAME(dgtreal_fb_done)((LTFAT_NAME(dgtreal_fb_plan)**) plan);
 }
 
+int
+LTFAT_NAME(dgtreal_ola_execute_wrapper)(void* plan,
+                                        const LTFAT_REAL* f, ltfat_int L, ltfat_int W,
+                                        LTFAT_COMPLEX* c)
+{
+    return LTFAT_NAME(dgtreal_olablock_execute)(
+               (LTFAT_NAME(dgtreal_olablock_plan)*) plan, f, L, W, c);
+}
+
+int
+LTFAT_NAME(idgtreal_ola_execute_wrapper)(void* plan,
+        const LTFAT_COMPLEX* c, ltfat_int L, ltfat_int W, LTFAT_REAL* f)
+{
+    return LTFAT_NAME(idgtreal_olablock_execute)(
+               (LTFAT_NAME(idgtreal_olablock_plan)*) plan, c, L, W, f);
+}
+
+int
+LTFAT_NAME(dgtreal_ola_execute_ws_wrapper)(const void* plan,
+        const LTFAT_REAL* f, ltfat_int L, ltfat_int W, LTFAT_COMPLEX* c, void* ws)
+{
+    return LTFAT_NAME(dgtreal_olablock_execute_ws)(
+               (const LTFAT_NAME(dgtreal_olablock_plan)*) plan, f, L, W, c, ws);
+}
+
+int
+LTFAT_NAME(idgtreal_ola_execute_ws_wrapper)(const void* plan,
+        const LTFAT_COMPLEX* c, ltfat_int L, ltfat_int W, LTFAT_REAL* f, void* ws)
+{
+    return LTFAT_NAME(idgtreal_olablock_execute_ws)(
+               (const LTFAT_NAME(idgtreal_olablock_plan)*) plan, c, L, W, f, ws);
+}
+
+size_t
+LTFAT_NAME(dgtreal_ola_workspace_size_wrapper)(const void* plan)
+{
+    return LTFAT_NAME(dgtreal_olablock_get_workspace_size)(
+               (const LTFAT_NAME(dgtreal_olablock_plan)*) plan);
+}
+
+size_t
+LTFAT_NAME(idgtreal_ola_workspace_size_wrapper)(const void* plan)
+{
+    return LTFAT_NAME(idgtreal_olablock_get_workspace_size)(
+               (const LTFAT_NAME(idgtreal_olablock_plan)*) plan);
+}
+
+int
+LTFAT_NAME(dgtreal_ola_done_wrapper)(void** plan)
+{
+    return LTFAT_NAME(dgtreal_olablock_done)((LTFAT_NAME(dgtreal_olablock_plan)**) plan);
+}
+
+int
+LTFAT_NAME(idgtreal_ola_done_wrapper)(void** plan)
+{
+    return LTFAT_NAME(idgtreal_olablock_done)((LTFAT_NAME(idgtreal_olablock_plan)**) plan);
+}
+
 LTFAT_API int
 LTFAT_NAME(dgtreal_execute_proj)(
     LTFAT_NAME(dgtreal_plan)* p, const LTFAT_COMPLEX cin[],
@@ -154,6 +291,38 @@ error:
     return status;
 }
 
+LTFAT_API size_t
+LTFAT_NAME(dgtreal_get_workspace_size)(const LTFAT_NAME(dgtreal_plan)* p)
+{
+    size_t fwdws, backws;
+    if (!p) return 0;
+
+    // The directions run one after another, so they share the workspace
+    fwdws = p->fwdwsfunc(p->fwdtra_userdata);
+    backws = p->backwsfunc(p->backtra_userdata);
+    return fwdws > backws ? fwdws : backws;
+}
+
+LTFAT_API int
+LTFAT_NAME(dgtreal_execute_ana_ws)(const LTFAT_NAME(dgtreal_plan)* p,
+                                   const LTFAT_REAL f[], LTFAT_COMPLEX c[], void* ws)
+{
+    int status = LTFATERR_FAILED; CHECKNULL(p);
+    return p->fwdtra_ws(p->fwdtra_userdata, f, p->L, p->W, c, ws);
+error:
+    return status;
+}
+
+LTFAT_API int
+LTFAT_NAME(dgtreal_execute_syn_ws)(const LTFAT_NAME(dgtreal_plan)* p,
+                                   const LTFAT_COMPLEX c[], LTFAT_REAL f[], void* ws)
+{
+    int status = LTFATERR_FAILED; CHECKNULL(p);
+    return p->backtra_ws(p->backtra_userdata, c, p->L, p->W, f, ws);
+error:
+    return status;
+}
+
 LTFAT_API int
 LTFAT_NAME(dgtreal_done)(LTFAT_NAME(dgtreal_plan)** p)
 {
@@ -241,6 +410,11 @@ LTFAT_NAME(dgtreal_init_gen)(const LTFAT_REAL ga[], ltfat_int gal,
     else
         ltfat_dgt_params_defaults(&paramsLoc);
 
+    if (paramsLoc.do_wisdomonly)
+        paramsLoc.fftw_flags |= FFTW_WISDOM_ONLY;
+
+    paramsLoc.fftw_flags |= LTFAT_FFT_NTHREADS(paramsLoc.nthreads);
+
     CHECKNULL( pout );
     CHECK(LTFATERR_BADTRALEN, !(L % minL),
           "L must divisible by lcm(a,M)=%d.", minL);
@@ -248,13 +422,34 @@ LTFAT_NAME(dgtreal_init_gen)(const LTFAT_REAL ga[], ltfat_int gal,
     CHECKMEM( p = LTFAT_NEW(LTFAT_NAME(dgtreal_plan)) );
     p->M = M, p->a = a, p->L = L, p->W = W, p->c = c; p->f = f;
 
-    if (ltfat_dgt_long == paramsLoc.hint)
+    if ( ltfat_dgt_auto == paramsLoc.hint )
     {
-        // Make the dual window longer if it is not already
+        // Pick the faster algorithm for each direction separately
+        p->synhint = ltfat_dgt_auto_hint(gsl, L, W, a, M,
+                                     paramsLoc.olablocklength, 1);
+        p->anahint = ltfat_dgt_auto_hint(gal, L, W, a, M,
+                                     paramsLoc.olablocklength, 1);
+    }
+    else
+    {
+        CHECK(LTFATERR_CANNOTHAPPEN,
+              ltfat_dgt_long == paramsLoc.hint || ltfat_dgt_fb == paramsLoc.hint ||
+              ltfat_dgt_ola == paramsLoc.hint,
+              "No such dgtreal hint");
+        p->synhint = p->anahint = paramsLoc.hint;
+    }
+
+    if (ltfat_dgt_long == p->synhint || ltfat_dgt_long == p->anahint)
         CHECKMEM( g2 = LTFAT_NAME_REAL(malloc)(L) );
+
+    if (ltfat_dgt_long == p->synhint)
+    {
+        // Make the dual window longer if it is not already
         LTFAT_NAME(fir2long)(gs, gsl, L, g2);
 
         p->backtra = &LTFAT_NAME(idgtreal_long_execute_wrapper);
+        p->backtra_ws = &LTFAT_NAME(idgtreal_long_execute_ws_wrapper);
+        p->backwsfunc = &LTFAT_NAME(idgtreal_long_workspace_size_wrapper);
         p->backdonefunc = &LTFAT_NAME(idgtreal_long_done_wrapper);
 
         LTFAT_NAME(idgtreal_long_plan)* backtra_tmp = NULL;
@@ -267,23 +462,25 @@ LTFAT_NAME(dgtreal_init_gen)(const LTFAT_REAL ga[], ltfat_int gal,
             backtra_tmp, paramsLoc.do_synoverwrites);
         p->backtra_userdata = (void*) backtra_tmp;
 
-        p->fwdtra = &LTFAT_NAME(dgtreal_long_execute_wrapper);
-        p->fwddonefunc = &LTFAT_NAME(dgtreal_long_done_wrapper);
-
-        // Ensure the original window is long enough
-        LTFAT_NAME(fir2long)(ga, gal, L, g2);
-
         CHECKSTATUS(
-            LTFAT_NAME(dgtreal_long_init)( g2, L, W, a, M, p->f, c, paramsLoc.ptype,
-                                           paramsLoc.fftw_flags,
-                                           (LTFAT_NAME(dgtreal_long_plan)**)&p->fwdtra_userdata));
+            LTFAT_NAME(idgtreal_long_set_numthreads)(backtra_tmp, paramsLoc.nthreads));
+    }
+    else if (ltfat_dgt_ola == p->synhint)
+    {
+        p->backtra = &LTFAT_NAME(idgtreal_ola_execute_wrapper);
+        p->backtra_ws = &LTFAT_NAME(idgtreal_ola_execute_ws_wrapper);
+        p->backwsfunc = &LTFAT_NAME(idgtreal_ola_workspace_size_wrapper);
+        p->backdonefunc = &LTFAT_NAME(idgtreal_ola_done_wrapper);
 
-        ltfat_safefree(g2);
+        CHECKSTATUS(
+            LTFAT_NAME(idgtreal_olablock_init)( gs, gsl, L, W, a, M, &paramsLoc,
+                (LTFAT_NAME(idgtreal_olablock_plan)**)&p->backtra_userdata));
     }
-    else if ( ltfat_dgt_fb == paramsLoc.hint )
+    else
     {
-        // Use _fb functions only
         p->backtra = &LTFAT_NAME(idgtreal_fb_execute_wrapper);
+        p->backtra_ws = &LTFAT_NAME(idgtreal_fb_execute_ws_wrapper);
+        p->backwsfunc = &LTFAT_NAME(idgtreal_fb_workspace_size_wrapper);
         p->backdonefunc = &LTFAT_NAME(idgtreal_fb_done_wrapper);
 
         LTFAT_NAME(idgtreal_fb_plan)* backtra_tmp = NULL;
@@ -296,82 +493,64 @@ LTFAT_NAME(dgtreal_init_gen)(const LTFAT_REAL ga[], ltfat_int gal,
                 paramsLoc.do_synoverwrites);
         p->backtra_userdata = (void*) backtra_tmp;
 
-        p->fwdtra = &LTFAT_NAME(dgtreal_fb_execute_wrapper);
-        p->fwddonefunc = &LTFAT_NAME(dgtreal_fb_done_wrapper);
-
         CHECKSTATUS(
-            LTFAT_NAME(dgtreal_fb_init)( ga, gal, a, M, paramsLoc.ptype,
-                                         paramsLoc.fftw_flags,
-                                         (LTFAT_NAME(dgtreal_fb_plan)**)&p->fwdtra_userdata));
-
+            LTFAT_NAME(idgtreal_fb_set_blocksize)(backtra_tmp, paramsLoc.fbblocksize));
+        CHECKSTATUS(
+            LTFAT_NAME(idgtreal_fb_set_numthreads)(backtra_tmp, paramsLoc.nthreads));
     }
-    else if ( ltfat_dgt_auto == paramsLoc.hint )
-    {
-        // Decide whether to use _fb or _long depending on the window lengths
-        if (gsl < L)
-        {
-            p->backtra = &LTFAT_NAME(idgtreal_fb_execute_wrapper);
-            p->backdonefunc = &LTFAT_NAME(idgtreal_fb_done_wrapper);
-
-            LTFAT_NAME(idgtreal_fb_plan)* backtra_tmp = NULL;
-            LTFAT_NAME(idgtreal_fb_init)( gs, gsl, a, M, paramsLoc.ptype,
-                                          paramsLoc.fftw_flags,
-                                          &backtra_tmp);
-
-            LTFAT_NAME(idgtreal_fb_set_overwriteoutarray)(backtra_tmp,
-                    paramsLoc.do_synoverwrites);
-            p->backtra_userdata = (void*) backtra_tmp;
-        }
-        else
-        {
-            p->backtra = &LTFAT_NAME(idgtreal_long_execute_wrapper);
-            p->backdonefunc = &LTFAT_NAME(idgtreal_long_done_wrapper);
-
-            CHECKMEM( g2 = LTFAT_NAME_REAL(malloc)(L) );
-            LTFAT_NAME(fir2long)(gs, gsl, L, g2);
-
-            LTFAT_NAME(idgtreal_long_plan)* backtra_tmp = NULL;
-            LTFAT_NAME(idgtreal_long_init)(g2, L, W, a, M, c, p->f, paramsLoc.ptype,
-                                           paramsLoc.fftw_flags, &backtra_tmp);
-
-            LTFAT_NAME(idgtreal_long_set_overwriteoutarray)(
-                backtra_tmp, paramsLoc.do_synoverwrites);
-            p->backtra_userdata = (void*) backtra_tmp;
-
-            ltfat_safefree(g2);
-        }
 
-        if (gal < L)
-        {
-            p->fwdtra = &LTFAT_NAME(dgtreal_fb_execute_wrapper);
-            p->fwddonefunc = &LTFAT_NAME(dgtreal_fb_done_wrapper);
-
-            LTFAT_NAME(dgtreal_fb_init)(ga, gal, a, M, paramsLoc.ptype,
-                                        paramsLoc.fftw_flags,
-                                        (LTFAT_NAME(dgtreal_fb_plan)**)&p->fwdtra_userdata);
-
-        }
-        else
-        {
-            p->fwdtra = &LTFAT_NAME(dgtreal_long_execute_wrapper);
-            p->fwddonefunc = &LTFAT_NAME(dgtreal_long_done_wrapper);
-
-            CHECKMEM( g2 = LTFAT_NAME_REAL(malloc)(L) );
-            LTFAT_NAME(fir2long)(ga, gal, L, g2);
+    if (ltfat_dgt_long == p->anahint)
+    {
+        p->fwdtra = &LTFAT_NAME(dgtreal_long_execute_wrapper);
+        p->fwdtra_ws = &LTFAT_NAME(dgtreal_long_execute_ws_wrapper);
+        p->fwdwsfunc = &LTFAT_NAME(dgtreal_long_workspace_size_wrapper);
+        p->fwddonefunc = &LTFAT_NAME(dgtreal_long_done_wrapper);
 
+        // Ensure the original window is long enough
+        LTFAT_NAME(fir2long)(ga, gal, L, g2);
 
+        CHECKSTATUS(
             LTFAT_NAME(dgtreal_long_init)( g2, L, W, a, M, p->f, c, paramsLoc.ptype,
                                            paramsLoc.fftw_flags,
-                                           (LTFAT_NAME(dgtreal_long_plan)**)&p->fwdtra_userdata);
+                                           (LTFAT_NAME(dgtreal_long_plan)**)&p->fwdtra_userdata));
 
-            ltfat_safefree(g2);
-        }
+        CHECKSTATUS(
+            LTFAT_NAME(dgtreal_long_set_numthreads)(
+                (LTFAT_NAME(dgtreal_long_plan)*) p->fwdtra_userdata, paramsLoc.nthreads));
+    }
+    else if (ltfat_dgt_ola == p->anahint)
+    {
+        p->fwdtra = &LTFAT_NAME(dgtreal_ola_execute_wrapper);
+        p->fwdtra_ws = &LTFAT_NAME(dgtreal_ola_execute_ws_wrapper);
+        p->fwdwsfunc = &LTFAT_NAME(dgtreal_ola_workspace_size_wrapper);
+        p->fwddonefunc = &LTFAT_NAME(dgtreal_ola_done_wrapper);
+
+        CHECKSTATUS(
+            LTFAT_NAME(dgtreal_olablock_init)( ga, gal, L, W, a, M, &paramsLoc,
+                (LTFAT_NAME(dgtreal_olablock_plan)**)&p->fwdtra_userdata));
     }
     else
     {
-        CHECKCANTHAPPEN("No such dgtreal hint");
+        p->fwdtra = &LTFAT_NAME(dgtreal_fb_execute_wrapper);
+        p->fwdtra_ws = &LTFAT_NAME(dgtreal_fb_execute_ws_wrapper);
+        p->fwdwsfunc = &LTFAT_NAME(dgtreal_fb_workspace_size_wrapper);
+        p->fwddonefunc = &LTFAT_NAME(dgtreal_fb_done_wrapper);
+
+        CHECKSTATUS(
+            LTFAT_NAME(dgtreal_fb_init)( ga, gal, a, M, paramsLoc.ptype,
+                                         paramsLoc.fftw_flags,
+                                         (LTFAT_NAME(dgtreal_fb_plan)**)&p->fwdtra_userdata));
+
+        CHECKSTATUS(
+            LTFAT_NAME(dgtreal_fb_set_blocksize)(
+                (LTFAT_NAME(dgtreal_fb_plan)*) p->fwdtra_userdata, paramsLoc.fbblocksize));
+        CHECKSTATUS(
+            LTFAT_NAME(dgtreal_fb_set_numthreads)(
+                (LTFAT_NAME(dgtreal_fb_plan)*) p->fwdtra_userdata, paramsLoc.nthreads));
     }
 
+    ltfat_safefree(g2);
+
     *pout = p;
 
     return status;
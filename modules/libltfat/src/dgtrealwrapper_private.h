@@ -4,6 +4,9 @@
 
 typedef int LTFAT_NAME(complextorealtransform)(void* userdata, const LTFAT_COMPLEX* c, ltfat_int L, ltfat_int W, LTFAT_REAL* f);
 typedef int LTFAT_NAME(realtocomplextransform)(void* userdata, const LTFAT_REAL* f, ltfat_int L, ltfat_int W, LTFAT_COMPLEX* c);
+typedef int LTFAT_NAME(complextorealtransform_ws)(const void* userdata, const LTFAT_COMPLEX* c, ltfat_int L, ltfat_int W, LTFAT_REAL* f, void* ws);
+typedef int LTFAT_NAME(realtocomplextransform_ws)(const void* userdata, const LTFAT_REAL* f, ltfat_int L, ltfat_int W, LTFAT_COMPLEX* c, void* ws);
+typedef size_t LTFAT_NAME(workspacesizefunc)(const void* userdata);
 
 struct LTFAT_NAME(dgtreal_plan)
 {
@@ -14,12 +17,18 @@ struct LTFAT_NAME(dgtreal_plan)
     LTFAT_REAL* f;
     LTFAT_COMPLEX* c;
     ltfat_phaseconvention ptype;
+    ltfat_dgt_hint anahint;
+    ltfat_dgt_hint synhint;
     LTFAT_NAME(complextorealtransform)* backtra;
     void* backtra_userdata;
     LTFAT_NAME(donefunc)* backdonefunc;
     LTFAT_NAME(realtocomplextransform)* fwdtra;
     void* fwdtra_userdata;
     LTFAT_NAME(donefunc)* fwddonefunc;
+    LTFAT_NAME(complextorealtransform_ws)* backtra_ws;
+    LTFAT_NAME(workspacesizefunc)* backwsfunc;
+    LTFAT_NAME(realtocomplextransform_ws)* fwdtra_ws;
+    LTFAT_NAME(workspacesizefunc)* fwdwsfunc;
 };
 
 #endif
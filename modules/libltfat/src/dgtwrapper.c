@@ -1,7 +1,9 @@
 #include "ltfat.h"
 #include "ltfat/types.h"
 #include "ltfat/macros.h"
+#include "ltfat/thirdparty/fftw3.h"
 #include "dgtwrapper_private.h"
+#include "dgt_ola_private.h"
 
 
 LTFAT_API ltfat_int
@@ -32,6 +34,20 @@ LTFAT_NAME(dgt_get_phaseconv)(LTFAT_NAME(dgt_plan)* p)
     else return LTFATERR_NULLPOINTER;
 }
 
+LTFAT_API ltfat_dgt_hint
+LTFAT_NAME(dgt_get_anahint)(LTFAT_NAME(dgt_plan)* p)
+{
+    if(p) return p->anahint;
+    else return (ltfat_dgt_hint) LTFATERR_NULLPOINTER;
+}
+
+LTFAT_API ltfat_dgt_hint
+LTFAT_NAME(dgt_get_synhint)(LTFAT_NAME(dgt_plan)* p)
+{
+    if(p) return p->synhint;
+    else return (ltfat_dgt_hint) LTFATERR_NULLPOINTER;
+}
+
 
 LTFAT_API ltfat_int
 LTFAT_NAME(dgt_get_L)(LTFAT_NAME(dgt_plan)* p)
@@ -98,6 +114,36 @@ LTFAT_NAME(dgt_fb_done_wrapper)(void** plan)
     return LTFAT_NAME(dgt_fb_done)((LTFAT_NAME(dgt_fb_plan)**) plan);
 }
 
+int
+LTFAT_NAME(dgt_ola_execute_wrapper)(void* plan,
+                                    const LTFAT_TYPE* f, ltfat_int L, ltfat_int W,
+                                    LTFAT_COMPLEX* c)
+{
+    return LTFAT_NAME(dgt_olablock_execute)(
+               (LTFAT_NAME(dgt_olablock_plan)*) plan, f, L, W, c);
+}
+
+int
+LTFAT_NAME(idgt_ola_execute_wrapper)(void* plan,
+                                     const LTFAT_COMPLEX* c, ltfat_int L, ltfat_int W,
+                                     LTFAT_COMPLEX* f)
+{
+    return LTFAT_NAME(idgt_olablock_execute)(
+               (LTFAT_NAME(idgt_olablock_plan)*) plan, c, L, W, f);
+}
+
+int
+LTFAT_NAME(dgt_ola_done_wrapper)(void** plan)
+{
+    return LTFAT_NAME(dgt_olablock_done)((LTFAT_NAME(dgt_olablock_plan)**) plan);
+}
+
+int
+LTFAT_NAME(idgt_ola_done_wrapper)(void** plan)
+{
+    return LTFAT_NAME(idgt_olablock_done)((LTFAT_NAME(idgt_olablock_plan)**) plan);
+}
+
 #ifdef LTFAT_COMPLEXTYPE
 LTFAT_API int
 LTFAT_NAME(dgt_execute_proj)(
@@ -247,6 +293,11 @@ LTFAT_NAME(dgt_init_gen)(const LTFAT_TYPE ga[], ltfat_int gal,
     else
         ltfat_dgt_params_defaults(&paramsLoc);
 
+    if (paramsLoc.do_wisdomonly)
+        paramsLoc.fftw_flags |= FFTW_WISDOM_ONLY;
+
+    paramsLoc.fftw_flags |= LTFAT_FFT_NTHREADS(paramsLoc.nthreads);
+
     CHECKNULL( pout );
     CHECK(LTFATERR_BADTRALEN, !(L % minL),
           "L must divisible by lcm(a,M)=%d.", minL);
@@ -255,10 +306,29 @@ LTFAT_NAME(dgt_init_gen)(const LTFAT_TYPE ga[], ltfat_int gal,
     p->M = M, p->a = a, p->L = L, p->W = W, p->c = c; p->f = f;
     p->ptype = paramsLoc.ptype;
 
-    if (ltfat_dgt_long == paramsLoc.hint)
+    if ( ltfat_dgt_auto == paramsLoc.hint )
     {
-        // Make the dual window longer if it is not already
+        // Pick the faster algorithm for each direction separately
+        p->synhint = ltfat_dgt_auto_hint(gsl, L, W, a, M,
+                                     paramsLoc.olablocklength, 0);
+        p->anahint = ltfat_dgt_auto_hint(gal, L, W, a, M,
+                                     paramsLoc.olablocklength, 0);
+    }
+    else
+    {
+        CHECK(LTFATERR_CANNOTHAPPEN,
+              ltfat_dgt_long == paramsLoc.hint || ltfat_dgt_fb == paramsLoc.hint ||
+              ltfat_dgt_ola == paramsLoc.hint,
+              "No such dgt hint");
+        p->synhint = p->anahint = paramsLoc.hint;
+    }
+
+    if (ltfat_dgt_long == p->synhint || ltfat_dgt_long == p->anahint)
         CHECKMEM( g2 = LTFAT_NAME(malloc)(L) );
+
+    if (ltfat_dgt_long == p->synhint)
+    {
+        // Make the dual window longer if it is not already
         LTFAT_NAME(fir2long)(gs, gsl, L, g2);
 
         p->backtra = &LTFAT_NAME(idgt_long_execute_wrapper);
@@ -269,6 +339,39 @@ LTFAT_NAME(dgt_init_gen)(const LTFAT_TYPE ga[], ltfat_int gal,
                                         paramsLoc.fftw_flags,
                                         (LTFAT_NAME(idgt_long_plan)**)&p->backtra_userdata));
 
+        CHECKSTATUS(
+            LTFAT_NAME(idgt_long_set_numthreads)(
+                (LTFAT_NAME(idgt_long_plan)*) p->backtra_userdata, paramsLoc.nthreads));
+    }
+    else if (ltfat_dgt_ola == p->synhint)
+    {
+        p->backtra = &LTFAT_NAME(idgt_ola_execute_wrapper);
+        p->backdonefunc = &LTFAT_NAME(idgt_ola_done_wrapper);
+
+        CHECKSTATUS(
+            LTFAT_NAME(idgt_olablock_init)( gs, gsl, L, W, a, M, &paramsLoc,
+                (LTFAT_NAME(idgt_olablock_plan)**)&p->backtra_userdata));
+    }
+    else
+    {
+        p->backtra = &LTFAT_NAME(idgt_fb_execute_wrapper);
+        p->backdonefunc = &LTFAT_NAME(idgt_fb_done_wrapper);
+
+        CHECKSTATUS(
+            LTFAT_NAME(idgt_fb_init)( gs, gsl, a, M, paramsLoc.ptype,
+                                      paramsLoc.fftw_flags,
+                                      (LTFAT_NAME(idgt_fb_plan)**)&p->backtra_userdata));
+
+        CHECKSTATUS(
+            LTFAT_NAME(idgt_fb_set_blocksize)(
+                (LTFAT_NAME(idgt_fb_plan)*) p->backtra_userdata, paramsLoc.fbblocksize));
+        CHECKSTATUS(
+            LTFAT_NAME(idgt_fb_set_numthreads)(
+                (LTFAT_NAME(idgt_fb_plan)*) p->backtra_userdata, paramsLoc.nthreads));
+    }
+
+    if (ltfat_dgt_long == p->anahint)
+    {
         p->fwdtra = &LTFAT_NAME(dgt_long_execute_wrapper);
         p->fwddonefunc = &LTFAT_NAME(dgt_long_done_wrapper);
 
@@ -281,19 +384,21 @@ LTFAT_NAME(dgt_init_gen)(const LTFAT_TYPE ga[], ltfat_int gal,
                                        paramsLoc.fftw_flags,
                                        (LTFAT_NAME(dgt_long_plan)**)&p->fwdtra_userdata));
 
-        ltfat_safefree(g2);
+        CHECKSTATUS(
+            LTFAT_NAME(dgt_long_set_numthreads)(
+                (LTFAT_NAME(dgt_long_plan)*) p->fwdtra_userdata, paramsLoc.nthreads));
     }
-    else if ( ltfat_dgt_fb == paramsLoc.hint )
+    else if (ltfat_dgt_ola == p->anahint)
     {
-        // Use _fb functions only
-        p->backtra = &LTFAT_NAME(idgt_fb_execute_wrapper);
-        p->backdonefunc = &LTFAT_NAME(idgt_fb_done_wrapper);
+        p->fwdtra = &LTFAT_NAME(dgt_ola_execute_wrapper);
+        p->fwddonefunc = &LTFAT_NAME(dgt_ola_done_wrapper);
 
         CHECKSTATUS(
-            LTFAT_NAME(idgt_fb_init)( gs, gsl, a, M, paramsLoc.ptype,
-                                      paramsLoc.fftw_flags,
-                                      (LTFAT_NAME(idgt_fb_plan)**)&p->backtra_userdata));
-
+            LTFAT_NAME(dgt_olablock_init)( ga, gal, L, W, a, M, &paramsLoc,
+                (LTFAT_NAME(dgt_olablock_plan)**)&p->fwdtra_userdata));
+    }
+    else
+    {
         p->fwdtra = &LTFAT_NAME(dgt_fb_execute_wrapper);
         p->fwddonefunc = &LTFAT_NAME(dgt_fb_done_wrapper);
 
@@ -302,65 +407,15 @@ LTFAT_NAME(dgt_init_gen)(const LTFAT_TYPE ga[], ltfat_int gal,
                                      paramsLoc.fftw_flags,
                                      (LTFAT_NAME(dgt_fb_plan)**)&p->fwdtra_userdata));
 
+        CHECKSTATUS(
+            LTFAT_NAME(dgt_fb_set_blocksize)(
+                (LTFAT_NAME(dgt_fb_plan)*) p->fwdtra_userdata, paramsLoc.fbblocksize));
+        CHECKSTATUS(
+            LTFAT_NAME(dgt_fb_set_numthreads)(
+                (LTFAT_NAME(dgt_fb_plan)*) p->fwdtra_userdata, paramsLoc.nthreads));
     }
-    else if ( ltfat_dgt_auto == paramsLoc.hint )
-    {
-        // Decide whether to use _fb or _long depending on the window lengths
-        if (gsl < L)
-        {
-            p->backtra = &LTFAT_NAME(idgt_fb_execute_wrapper);
-            p->backdonefunc = &LTFAT_NAME(idgt_fb_done_wrapper);
-
-            LTFAT_NAME(idgt_fb_init)( gs, gsl, a, M, paramsLoc.ptype,
-                                      paramsLoc.fftw_flags,
-                                      (LTFAT_NAME(idgt_fb_plan)**)&p->backtra_userdata);
-
-        }
-        else
-        {
-            p->backtra = &LTFAT_NAME(idgt_long_execute_wrapper);
-            p->backdonefunc = &LTFAT_NAME(idgt_long_done_wrapper);
-
-            CHECKMEM( g2 = LTFAT_NAME(malloc)(L) );
-            LTFAT_NAME(fir2long)(gs, gsl, L, g2);
-
-            LTFAT_NAME(idgt_long_init)(g2, L, W, a, M, c, p->f, paramsLoc.ptype,
-                                       paramsLoc.fftw_flags,
-                                       (LTFAT_NAME(idgt_long_plan)**)&p->backtra_userdata);
-
-            ltfat_safefree(g2);
-        }
-
-        if (gal < L)
-        {
-            p->fwdtra = &LTFAT_NAME(dgt_fb_execute_wrapper);
-            p->fwddonefunc = &LTFAT_NAME(dgt_fb_done_wrapper);
-
-            LTFAT_NAME(dgt_fb_init)(ga, gal, a, M, paramsLoc.ptype,
-                                    paramsLoc.fftw_flags,
-                                    (LTFAT_NAME(dgt_fb_plan)**)&p->fwdtra_userdata);
 
-        }
-        else
-        {
-            p->fwdtra = &LTFAT_NAME(dgt_long_execute_wrapper);
-            p->fwddonefunc = &LTFAT_NAME(dgt_long_done_wrapper);
-
-            CHECKMEM( g2 = LTFAT_NAME(malloc)(L) );
-            LTFAT_NAME(fir2long)(ga, gal, L, g2);
-
-
-            LTFAT_NAME(dgt_long_init)( g2, L, W, a, M, (LTFAT_TYPE*) p->f, c,
-                                       paramsLoc.ptype, paramsLoc.fftw_flags,
-                                       (LTFAT_NAME(dgt_long_plan)**)&p->fwdtra_userdata);
-
-            ltfat_safefree(g2);
-        }
-    }
-    else
-    {
-        CHECKCANTHAPPEN("No such dgt hint");
-    }
+    ltfat_safefree(g2);
 
     *pout = p;
 
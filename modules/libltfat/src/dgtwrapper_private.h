@@ -8,8 +8,29 @@ struct ltfat_dgt_params
     unsigned fftw_flags;
     ltfat_dgt_hint hint;
     int do_synoverwrites;
+    int do_wisdomonly;
+    int nthreads;
+    ltfat_int fbblocksize;
+    ltfat_int olablocklength;
 };
 
+/* Returns ltfat_dgt_long, ltfat_dgt_fb or ltfat_dgt_ola, whichever the cost
+ * model predicts to be the fastest for a window of length gl. bl is the
+ * OLA block length as in ltfat_dgt_ola_blocklength().
+ * See dgtwrapper_typeconstant.c */
+ltfat_dgt_hint
+ltfat_dgt_auto_hint(ltfat_int gl, ltfat_int L, ltfat_int W, ltfat_int a,
+                    ltfat_int M, ltfat_int bl, int isreal);
+
+/* Block length of the overlap-add algorithm for a window of length gl.
+ * bl=0 picks a length at least 8x the window length, otherwise bl
+ * is checked. glext is the window length rounded up such that the
+ * blocks extended by it have a valid length for the factorization
+ * algorithm. Returns the block length or a negative error code. */
+ltfat_int
+ltfat_dgt_ola_blocklength(ltfat_int gl, ltfat_int L, ltfat_int a, ltfat_int M,
+                          ltfat_int bl, ltfat_int* glext);
+
 typedef int LTFAT_NAME(donefunc)(void** pla);
 
 typedef int LTFAT_NAME(complextocomplextransform)(void* userdata, const LTFAT_COMPLEX* c, ltfat_int L, ltfat_int W, LTFAT_COMPLEX* f);
@@ -24,6 +45,8 @@ struct LTFAT_NAME(dgt_plan)
     LTFAT_COMPLEX* f;
     LTFAT_COMPLEX* c;
     ltfat_phaseconvention ptype;
+    ltfat_dgt_hint anahint;
+    ltfat_dgt_hint synhint;
     LTFAT_NAME(complextocomplextransform)* backtra;
     void* backtra_userdata;
     LTFAT_NAME(donefunc)* backdonefunc;
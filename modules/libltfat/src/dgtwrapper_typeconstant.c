@@ -2,9 +2,13 @@
 #include "ltfat/types.h"
 #include "ltfat/macros.h"
 #include "dgtwrapper_private.h"
+#include "fftdispatch_private.h"
+#include "threads_private.h"
 
 #include "ltfat/thirdparty/fftw3.h"
 
+#include <stdio.h>
+
 int
 ltfat_dgt_params_defaults(ltfat_dgt_params* params)
 {
@@ -14,6 +18,10 @@ ltfat_dgt_params_defaults(ltfat_dgt_params* params)
     params->fftw_flags = FFTW_ESTIMATE;
     params->hint = ltfat_dgt_auto;
     params->do_synoverwrites = 1;
+    params->do_wisdomonly = 0;
+    params->nthreads = 0;
+    params->fbblocksize = 1;
+    params->olablocklength = 0;
 error:
     return status;
 }
@@ -70,6 +78,52 @@ error:
     return status;
 }
 
+LTFAT_API int
+ltfat_dgt_setpar_wisdomonly(ltfat_dgt_params* params, int do_wisdomonly)
+{
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(params);
+    params->do_wisdomonly = do_wisdomonly;
+error:
+    return status;
+}
+
+LTFAT_API int
+ltfat_dgt_setpar_numthreads(ltfat_dgt_params* params, int nthreads)
+{
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(params);
+    CHECK(LTFATERR_NOTINRANGE, nthreads >= 0 && nthreads <= 255,
+          "nthreads must be in range 0-255");
+    params->nthreads = nthreads;
+error:
+    return status;
+}
+
+LTFAT_API int
+ltfat_dgt_setpar_fbblocksize(ltfat_dgt_params* params, ltfat_int blocksize)
+{
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(params);
+    CHECK(LTFATERR_BADARG, blocksize >= 0,
+          "blocksize (passed %td) must be nonnegative.", blocksize);
+    params->fbblocksize = blocksize;
+error:
+    return status;
+}
+
+LTFAT_API int
+ltfat_dgt_setpar_olablocklength(ltfat_dgt_params* params, ltfat_int bl)
+{
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(params);
+    CHECK(LTFATERR_BADARG, bl >= 0,
+          "bl (passed %td) must be nonnegative.", bl);
+    params->olablocklength = bl;
+error:
+    return status;
+}
+
 LTFAT_API int
 ltfat_dgt_setpar_hint(ltfat_dgt_params* params,
                               ltfat_dgt_hint hint)
@@ -101,3 +155,444 @@ ltfat_dgt_params_free(ltfat_dgt_params* params)
 error:
     return status;
 }
+
+/*
+ * Cost model of ltfat_dgt_auto
+ *
+ * Per channel, the filter bank algorithm windows and folds N blocks of
+ * length gl into M samples and does N FFTs of length M. The factorization
+ * algorithm does FFTs of length d=L/(M*p) over both L input samples
+ * and M*N coefficients, L*q complex multiply-adds in the p x q matrix
+ * products and the final N FFTs of length M. The overlap-add algorithm
+ * does the factorization of L/bl blocks of length bl+glext.
+ *
+ * The cost of an FFT of length n is modelled as n times the sum of the
+ * prime factors of n halved (i.e. n*log2(n) for powers of two) which
+ * also captures the slow transforms of lengths with large prime factors.
+ *
+ * The real and the complex transforms have separate constants.
+ */
+typedef struct
+{
+    double win; /* seconds per windowed and folded sample */
+    double fft; /* seconds per FFT unit */
+    double mac; /* seconds per multiply-add of the matrix products */
+} ltfat_dgt_costmodel;
+
+/* Fitted by ltfat_dgt_costmodel_calibrate() with the native FFT, double
+ * precision, on a x86-64 machine. Index 0 is complex, 1 is real. */
+static const ltfat_dgt_costmodel costmodel_default[2] =
+{
+    { 1.9e-9, 1.8e-10, 8.1e-9 }, { 7.2e-10, 1.5e-10, 5.0e-9 }
+};
+static ltfat_dgt_costmodel costmodel[2] =
+{
+    { 1.9e-9, 1.8e-10, 8.1e-9 }, { 7.2e-10, 1.5e-10, 5.0e-9 }
+};
+static ltfat_mutex_t costmodel_mutex = LTFAT_MUTEX_INITIALIZER;
+
+static double
+ltfat_dgt_fftcost(ltfat_int n)
+{
+    double factorsum = 0.0;
+    ltfat_int nrem = n;
+
+    for (ltfat_int f = 2; f * f <= nrem; f++)
+        while (nrem % f == 0)
+        {
+            factorsum += f / 2.0;
+            nrem /= f;
+        }
+
+    if (nrem > 1) factorsum += nrem / 2.0;
+
+    return (double) n * factorsum;
+}
+
+/* Work of both algorithms in units of the cost model */
+static void
+ltfat_dgt_costfeatures(ltfat_int gl, ltfat_int L, ltfat_int W, ltfat_int a,
+                       ltfat_int M, double fb[3], double lng[3])
+{
+    ltfat_int h_a, h_m;
+    ltfat_int N = L / a;
+    ltfat_int c = ltfat_gcd(a, M, &h_a, &h_m);
+    ltfat_int p = a / c, q = M / c;
+    ltfat_int d = L / M / p;
+    double Md = (double) M, Nd = (double) N, Ld = (double) L;
+
+    fb[0] = W * Nd * (double)(gl + M);
+    fb[1] = W * Nd * ltfat_dgt_fftcost(M);
+    fb[2] = 0.0;
+
+    lng[0] = 0.0;
+    lng[1] = W * ((Ld + Md * Nd) / d * ltfat_dgt_fftcost(d) +
+                  Nd * ltfat_dgt_fftcost(M));
+    lng[2] = W * Ld * (double) q;
+}
+
+/* Block length of the overlap-add algorithm, 0 if there is none
+ * for the given bl */
+static ltfat_int
+ltfat_dgt_ola_pickblocklength(ltfat_int gl, ltfat_int L, ltfat_int a, ltfat_int M,
+                              ltfat_int bl, ltfat_int* glext)
+{
+    ltfat_int minL = ltfat_lcm(a, M);
+    // Each side of the window must span whole frames
+    ltfat_int glstep = ltfat_lcm(minL, 2 * a);
+    ltfat_int nmax = L / minL, kmin, kbest;
+
+    *glext = ltfat_idivceil(gl, glstep) * glstep;
+
+    if (bl > 0)
+    {
+        if (L % bl != 0 || bl % minL != 0) return 0;
+    }
+    else
+    {
+        // The smallest divisor of L/minL giving a long enough block
+        kmin = ltfat_idivceil(ltfat_imax(8 * *glext, 4096), minL);
+        kbest = nmax;
+        for (ltfat_int k = 1; k * k <= nmax; k++)
+        {
+            if (nmax % k) continue;
+            if (k >= kmin && k < kbest) kbest = k;
+            if (nmax / k >= kmin && nmax / k < kbest) kbest = nmax / k;
+        }
+        bl = kbest * minL;
+    }
+
+    return 2 * bl >= *glext ? bl : 0;
+}
+
+ltfat_int
+ltfat_dgt_ola_blocklength(ltfat_int gl, ltfat_int L, ltfat_int a, ltfat_int M,
+                          ltfat_int bl, ltfat_int* glext)
+{
+    ltfat_int minL = ltfat_lcm(a, M), blpicked;
+    int status = LTFATERR_SUCCESS;
+
+    CHECKNULL(glext);
+    CHECK(LTFATERR_BADARG, gl <= L,
+          "Window is too long. gl=%td > L=%td", gl, L);
+    CHECK(LTFATERR_BADARG, bl <= 0 || (L % bl == 0 && bl % minL == 0),
+          "Block length must divide L and be divisible by lcm(a,M)=%td (passed %td).",
+          minL, bl);
+
+    blpicked = ltfat_dgt_ola_pickblocklength(gl, L, a, M, bl, glext);
+
+    CHECK(LTFATERR_BADARG, blpicked > 0,
+          "Block length (passed %td) must be at least %td for this window.",
+          bl, *glext / 2);
+
+    return blpicked;
+error:
+    return status;
+}
+
+ltfat_dgt_hint
+ltfat_dgt_auto_hint(ltfat_int gl, ltfat_int L, ltfat_int W, ltfat_int a,
+                    ltfat_int M, ltfat_int bl, int isreal)
+{
+    double fb[3], lng[3], olafb[3], ola[3];
+    double tfb, tlong, tola;
+    ltfat_int glext, Lext, Mc = isreal ? M / 2 + 1 : M;
+    ltfat_dgt_costmodel cm;
+
+    ltfat_mutex_lock(&costmodel_mutex);
+    cm = costmodel[isreal ? 1 : 0];
+    ltfat_mutex_unlock(&costmodel_mutex);
+
+    ltfat_dgt_costfeatures(gl, L, W, a, M, fb, lng);
+
+    tfb = cm.win * fb[0] + cm.fft * fb[1];
+    tlong = cm.fft * lng[1] + cm.mac * lng[2];
+
+    // The overlap-add algorithm is the factorization of L/bl blocks extended
+    // by the window plus moving the blocks and their coefficients around,
+    // which is counted as windowing.
+    tola = tlong + 1.0;
+    if (gl <= L && (bl = ltfat_dgt_ola_pickblocklength(gl, L, a, M, bl, &glext)) > 0
+        && bl < L)
+    {
+        Lext = bl + glext;
+        ltfat_dgt_costfeatures(glext, Lext, W, a, M, olafb, ola);
+        tola = (double)(L / bl) * (cm.fft * ola[1] + cm.mac * ola[2] +
+                                   cm.win * W * (bl + (double) Mc * Lext / a));
+    }
+
+    if (tfb <= tlong && tfb <= tola) return ltfat_dgt_fb;
+    return tlong <= tola ? ltfat_dgt_long : ltfat_dgt_ola;
+}
+
+static int
+ltfat_dgt_costmodel_ana_real(void* plan)
+{
+    return LTFAT_NAME_REAL(dgtreal_execute_ana)((LTFAT_NAME_REAL(dgtreal_plan)*) plan);
+}
+
+static int
+ltfat_dgt_costmodel_ana_complex(void* plan)
+{
+    return LTFAT_NAME_COMPLEX(dgt_execute_ana)((LTFAT_NAME_COMPLEX(dgt_plan)*) plan);
+}
+
+/* Best time of a single analysis */
+static double
+ltfat_dgt_costmodel_time(int (*ana)(void*), void* plan)
+{
+    double best = 1e300;
+
+    for (int rep = 0; rep < 3; rep++)
+    {
+        int niter = 0;
+        double start = ltfat_fft_tune_clock(), elapsed;
+        do
+        {
+            ana(plan);
+            niter++;
+            elapsed = ltfat_fft_tune_clock() - start;
+        }
+        while (elapsed < 2e-3);
+
+        if (elapsed / niter < best) best = elapsed / niter;
+    }
+    return best;
+}
+
+/* Solves 3x3 system A x = b by Gaussian elimination with pivoting */
+static int
+ltfat_dgt_costmodel_solve(double A[3][3], double b[3], double x[3])
+{
+    for (int k = 0; k < 3; k++)
+    {
+        int piv = k;
+        for (int i = k + 1; i < 3; i++)
+            if (fabs(A[i][k]) > fabs(A[piv][k])) piv = i;
+
+        if (fabs(A[piv][k]) < 1e-300) return LTFATERR_FAILED;
+
+        for (int j = 0; j < 3; j++)
+        {
+            double tmp = A[k][j]; A[k][j] = A[piv][j]; A[piv][j] = tmp;
+        }
+        double tmp = b[k]; b[k] = b[piv]; b[piv] = tmp;
+
+        for (int i = k + 1; i < 3; i++)
+        {
+            double f = A[i][k] / A[k][k];
+            for (int j = k; j < 3; j++) A[i][j] -= f * A[k][j];
+            b[i] -= f * b[k];
+        }
+    }
+
+    for (int k = 2; k >= 0; k--)
+    {
+        x[k] = b[k];
+        for (int j = k + 1; j < 3; j++) x[k] -= A[k][j] * x[j];
+        x[k] /= A[k][k];
+    }
+    return LTFATERR_SUCCESS;
+}
+
+/* Times both algorithms and adds the measurements to the normal equations
+ * of the least squares fit of the relative error */
+static int
+ltfat_dgt_costmodel_measure(ltfat_int L, ltfat_int a, ltfat_int M,
+                            ltfat_int gl, int isreal, ltfat_dgt_params* params,
+                            double A[3][3], double b[3])
+{
+    ltfat_dgt_hint hints[2] = { ltfat_dgt_fb, ltfat_dgt_long };
+    double feat[2][3];
+    void* plan = NULL;
+    LTFAT_COMPLEX* f = NULL, *g = NULL, *c = NULL;
+    int status = LTFATERR_SUCCESS;
+
+    /* The real transforms use the real parts only */
+    CHECKMEM( f = LTFAT_NAME_COMPLEX(malloc)(L) );
+    CHECKMEM( g = LTFAT_NAME_COMPLEX(malloc)(gl) );
+    CHECKMEM( c = LTFAT_NAME_COMPLEX(malloc)(M * (L / a)) );
+
+    for (ltfat_int l = 0; l < L; l++)
+        f[l] = (LTFAT_REAL) ((l * 7919) % 1000) / 1000;
+    for (ltfat_int l = 0; l < gl; l++)
+        g[l] = (LTFAT_REAL) 1.0;
+
+    ltfat_dgt_costfeatures(gl, L, 1, a, M, feat[0], feat[1]);
+
+    for (int h = 0; h < 2; h++)
+    {
+        double t;
+        CHECKSTATUS( ltfat_dgt_setpar_hint(params, hints[h]));
+
+        if (isreal)
+        {
+            CHECKSTATUS(
+                LTFAT_NAME_REAL(dgtreal_init_gen)(
+                    (LTFAT_REAL*) g, gl, (LTFAT_REAL*) g, gl, L, 1, a, M,
+                    (LTFAT_REAL*) f, c, params, (LTFAT_NAME_REAL(dgtreal_plan)**) &plan));
+            t = ltfat_dgt_costmodel_time(&ltfat_dgt_costmodel_ana_real, plan);
+            LTFAT_NAME_REAL(dgtreal_done)((LTFAT_NAME_REAL(dgtreal_plan)**) &plan);
+        }
+        else
+        {
+            CHECKSTATUS(
+                LTFAT_NAME_COMPLEX(dgt_init_gen)(
+                    g, gl, g, gl, L, 1, a, M, f, c, params,
+                    (LTFAT_NAME_COMPLEX(dgt_plan)**) &plan));
+            t = ltfat_dgt_costmodel_time(&ltfat_dgt_costmodel_ana_complex, plan);
+            LTFAT_NAME_COMPLEX(dgt_done)((LTFAT_NAME_COMPLEX(dgt_plan)**) &plan);
+        }
+        plan = NULL;
+
+        for (int i = 0; i < 3; i++)
+        {
+            for (int j = 0; j < 3; j++)
+                A[i][j] += feat[h][i] * feat[h][j] / (t * t);
+            b[i] += feat[h][i] / t;
+        }
+    }
+
+error:
+    LTFAT_SAFEFREEALL(f, g, c);
+    return status;
+}
+
+LTFAT_API int
+ltfat_dgt_costmodel_calibrate(void)
+{
+    /* L, a, M, gl */
+    static const ltfat_int configs[][4] =
+    {
+        { 6144,  32,  128,  256 }, { 6144,  32,  128, 6144 },
+        { 8192,  64,  512, 2048 }, { 8192,  64,  512, 8192 },
+        { 7680,  40,  240,  960 }, { 7680,  40,  240, 7680 },
+        { 9216, 128, 1152, 1152 }, { 9216, 128, 1152, 4608 },
+        { 9450,  45,  270,  540 }, { 9450,  45,  270, 9450 },
+    };
+    const int nconfigs = sizeof configs / sizeof configs[0];
+    ltfat_dgt_params* params = NULL;
+    ltfat_dgt_costmodel fitted[2];
+    int status = LTFATERR_SUCCESS;
+
+    CHECKMEM( params = ltfat_dgt_params_allocdef() );
+    CHECKSTATUS( ltfat_dgt_setpar_numthreads(params, 1));
+
+    for (int isreal = 0; isreal < 2; isreal++)
+    {
+        double A[3][3] = {{0.0}}, b[3] = {0.0}, x[3];
+
+        for (int ii = 0; ii < nconfigs; ii++)
+            CHECKSTATUS(
+                ltfat_dgt_costmodel_measure(configs[ii][0], configs[ii][1],
+                                            configs[ii][2], configs[ii][3],
+                                            isreal, params, A, b));
+
+        CHECKSTATUS( ltfat_dgt_costmodel_solve(A, b, x));
+        CHECK(LTFATERR_FAILED, x[0] > 0.0 && x[1] > 0.0 && x[2] > 0.0,
+              "The measurements do not fit the cost model");
+
+        fitted[isreal].win = x[0];
+        fitted[isreal].fft = x[1];
+        fitted[isreal].mac = x[2];
+    }
+
+    ltfat_mutex_lock(&costmodel_mutex);
+    costmodel[0] = fitted[0];
+    costmodel[1] = fitted[1];
+    ltfat_mutex_unlock(&costmodel_mutex);
+
+error:
+    if (params) ltfat_dgt_params_free(params);
+    return status;
+}
+
+LTFAT_API int
+ltfat_dgt_costmodel_reset(void)
+{
+    ltfat_mutex_lock(&costmodel_mutex);
+    costmodel[0] = costmodel_default[0];
+    costmodel[1] = costmodel_default[1];
+    ltfat_mutex_unlock(&costmodel_mutex);
+    return LTFATERR_SUCCESS;
+}
+
+/*
+ * The file is a text file with one constant per line
+ *
+ *   transform name seconds
+ *
+ * where transform is real or complex and name is one of win, fft, mac
+ * e.g. "real fft 3.7e-10". Lines starting with # are ignored.
+ */
+LTFAT_API int
+ltfat_dgt_costmodel_load(const char* path)
+{
+    FILE* fp = NULL;
+    char line[256];
+    ltfat_dgt_costmodel cm[2];
+    int status = LTFATERR_SUCCESS;
+
+    CHECKNULL(path);
+    fp = fopen(path, "r");
+    CHECK(LTFATERR_FAILED, fp, "Cannot open %s", path);
+
+    ltfat_mutex_lock(&costmodel_mutex);
+    cm[0] = costmodel[0];
+    cm[1] = costmodel[1];
+    ltfat_mutex_unlock(&costmodel_mutex);
+
+    while (fgets(line, sizeof line, fp))
+    {
+        char kind[16], name[16];
+        double val;
+        ltfat_dgt_costmodel* cmp;
+
+        if (line[0] == '#' || sscanf(line, "%15s %15s %lf", kind, name, &val) != 3)
+            continue;
+
+        CHECK(LTFATERR_FAILED, val > 0.0, "Invalid constant in %s: %s", path, line);
+
+        if (!strcmp(kind, "complex")) cmp = &cm[0];
+        else if (!strcmp(kind, "real")) cmp = &cm[1];
+        else continue;
+
+        if (!strcmp(name, "win")) cmp->win = val;
+        else if (!strcmp(name, "fft")) cmp->fft = val;
+        else if (!strcmp(name, "mac")) cmp->mac = val;
+    }
+
+    ltfat_mutex_lock(&costmodel_mutex);
+    costmodel[0] = cm[0];
+    costmodel[1] = cm[1];
+    ltfat_mutex_unlock(&costmodel_mutex);
+error:
+    if (fp) fclose(fp);
+    return status;
+}
+
+LTFAT_API int
+ltfat_dgt_costmodel_save(const char* path)
+{
+    FILE* fp = NULL;
+    ltfat_dgt_costmodel cm[2];
+    const char* kinds[2] = { "complex", "real" };
+    int status = LTFATERR_SUCCESS;
+
+    CHECKNULL(path);
+    fp = fopen(path, "w");
+    CHECK(LTFATERR_FAILED, fp, "Cannot open %s", path);
+
+    ltfat_mutex_lock(&costmodel_mutex);
+    cm[0] = costmodel[0];
+    cm[1] = costmodel[1];
+    ltfat_mutex_unlock(&costmodel_mutex);
+
+    fprintf(fp, "# ltfat dgt cost model\n");
+    for (int k = 0; k < 2; k++)
+        fprintf(fp, "%s win %.6e\n%s fft %.6e\n%s mac %.6e\n",
+                kinds[k], cm[k].win, kinds[k], cm[k].fft, kinds[k], cm[k].mac);
+error:
+    if (fp) fclose(fp);
+    return status;
+}
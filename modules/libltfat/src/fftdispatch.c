@@ -0,0 +1,414 @@
+#include "ltfat.h"
+#include "ltfat/types.h"
+#include "ltfat/macros.h"
+#include "ltfat/thirdparty/fftw3.h"
+#include "fftdispatch_private.h"
+
+#ifdef LTFAT_FFT_DISPATCH
+
+#ifdef LTFAT_SINGLE
+#define LTFAT_FFT_ISSINGLE 1
+#else
+#define LTFAT_FFT_ISSINGLE 0
+#endif
+
+/* Minimum duration of a single timing run in seconds */
+#ifndef LTFAT_FFT_TUNE_MINTIME
+#define LTFAT_FFT_TUNE_MINTIME 1e-3
+#endif
+
+/* Backends in the order of preference */
+static const ltfat_fft_backend LTFAT_NAME(fft_backends)[] =
+{
+#ifdef FFTW
+    LTFAT_FFT_BACKEND_FFTW,
+#endif
+#ifdef NATIVEFFT
+    LTFAT_FFT_BACKEND_NATIVE,
+#endif
+#ifdef KISS
+    LTFAT_FFT_BACKEND_KISS,
+#endif
+};
+
+#define LTFAT_FFT_NBACKENDS \
+    (ltfat_int)(sizeof LTFAT_NAME(fft_backends) / sizeof LTFAT_NAME(fft_backends)[0])
+
+/*
+ * DISPATCH(backend, OP, kind) expands OP(b, kind) for the backend b
+ * matching the runtime value backend.
+ */
+#ifdef FFTW
+#  define DISPATCH_FFTW(OP, k) case LTFAT_FFT_BACKEND_FFTW: OP(fftw, k) break;
+#else
+#  define DISPATCH_FFTW(OP, k)
+#endif
+#ifdef NATIVEFFT
+#  define DISPATCH_NATIVE(OP, k) case LTFAT_FFT_BACKEND_NATIVE: OP(native, k) break;
+#else
+#  define DISPATCH_NATIVE(OP, k)
+#endif
+#ifdef KISS
+#  define DISPATCH_KISS(OP, k) case LTFAT_FFT_BACKEND_KISS: OP(kiss, k) break;
+#else
+#  define DISPATCH_KISS(OP, k)
+#endif
+
+#define DISPATCH(backend, OP, k) \
+    switch (backend) \
+    { \
+    DISPATCH_FFTW(OP, k) \
+    DISPATCH_NATIVE(OP, k) \
+    DISPATCH_KISS(OP, k) \
+    default: status = LTFATERR_NOTSUPPORTED; \
+    }
+
+#define OP_INIT(b, k) \
+    { \
+        LTFAT_NAME(b ## _ ## k ## _plan)* bp = NULL; \
+        status = LTFAT_NAME(b ## _ ## k ## _init)(L, W, in, out, flags, &bp); \
+        pp->plan = bp; \
+    }
+
+#define OP_EXECUTE(b, k) \
+    status = LTFAT_NAME(b ## _ ## k ## _execute_newarray)( \
+                 (LTFAT_NAME(b ## _ ## k ## _plan)*) p->plan, in, out);
+
+#define OP_EXECUTE_WS(b, k) \
+    status = LTFAT_NAME(b ## _ ## k ## _execute_ws)( \
+                 (const LTFAT_NAME(b ## _ ## k ## _plan)*) p->plan, in, out, work);
+
+#define OP_WORKSPACE_SIZE(b, k) \
+    size = LTFAT_NAME(b ## _ ## k ## _get_workspace_size)( \
+               (const LTFAT_NAME(b ## _ ## k ## _plan)*) p->plan);
+
+#define OP_DONE(b, k) \
+    { \
+        LTFAT_NAME(b ## _ ## k ## _plan)* bp = (LTFAT_NAME(b ## _ ## k ## _plan)*) pp->plan; \
+        status = LTFAT_NAME(b ## _ ## k ## _done)(&bp); \
+    }
+
+#define OP_CACHECLEAR(b, k) destroyed += LTFAT_NAME(b ## _fft_cache_clear)();
+
+static ltfat_fft_backend
+LTFAT_NAME(fft_tune_kind)(ltfat_fft_kind kind, ltfat_int L, ltfat_int W,
+                          unsigned flags);
+
+static ltfat_fft_backend
+LTFAT_NAME(fft_choose)(ltfat_fft_kind kind, ltfat_int L, ltfat_int W,
+                       unsigned flags)
+{
+    ltfat_fft_backend backend = LTFAT_FFT_GETBACKEND(flags);
+
+    if (backend == LTFAT_FFT_BACKEND_AUTO)
+        backend = ltfat_fft_get_backend();
+
+    if (backend == LTFAT_FFT_BACKEND_AUTO)
+        backend = ltfat_fft_tune_lookup(LTFAT_FFT_ISSINGLE, kind, L, W);
+
+    if (backend == LTFAT_FFT_BACKEND_AUTO && ltfat_fft_get_autotune())
+    {
+        backend = LTFAT_NAME(fft_tune_kind)(kind, L, W, flags);
+        if (backend != LTFAT_FFT_BACKEND_AUTO)
+            ltfat_fft_tune_store(LTFAT_FFT_ISSINGLE, kind, L, W, backend);
+    }
+
+    if (backend == LTFAT_FFT_BACKEND_AUTO)
+        backend = LTFAT_NAME(fft_backends)[0];
+
+    return backend;
+}
+
+/*
+ * Defines the plan struct and the public functions of one transform type.
+ * All of them just forward to the backend chosen at init.
+ */
+#define LTFAT_FFT_DISPATCH_DEFINE(k, KIND, TIN, TOUT) \
+struct LTFAT_NAME(k ## _plan) \
+{ \
+    ltfat_fft_backend backend; \
+    void* plan; \
+    TIN* in; \
+    TOUT* out; \
+}; \
+\
+LTFAT_API int \
+LTFAT_NAME(k)(TIN in[], ltfat_int L, ltfat_int W, TOUT out[]) \
+{ \
+    LTFAT_NAME(k ## _plan)* p = NULL; \
+    int status = LTFATERR_SUCCESS; \
+\
+    CHECKSTATUS( LTFAT_NAME(k ## _init)(L, W, in, out, FFTW_ESTIMATE, &p)); \
+    status = LTFAT_NAME(k ## _execute)(p); \
+    LTFAT_NAME(k ## _done)(&p); \
+error: \
+    return status; \
+} \
+\
+LTFAT_API int \
+LTFAT_NAME(k ## _init)(ltfat_int L, ltfat_int W, TIN in[], TOUT out[], \
+                       unsigned flags, LTFAT_NAME(k ## _plan)** p) \
+{ \
+    LTFAT_NAME(k ## _plan)* pp = NULL; \
+    int status = LTFATERR_SUCCESS; \
+\
+    CHECKNULL(p); \
+    CHECK(LTFATERR_NOTPOSARG, L > 0, "L must be positive"); \
+    CHECK(LTFATERR_NOTPOSARG, W > 0, "W must be positive"); \
+\
+    CHECKMEM( pp = LTFAT_NEW(LTFAT_NAME(k ## _plan)) ); \
+    pp->in = in; pp->out = out; \
+    pp->backend = LTFAT_NAME(fft_choose)(KIND, L, W, flags); \
+    flags &= ~LTFAT_FFT_BACKENDMASK; \
+\
+    DISPATCH(pp->backend, OP_INIT, k) \
+    CHECKSTATUS(status); \
+\
+    *p = pp; \
+    return status; \
+error: \
+    ltfat_safefree(pp); \
+    if (p) *p = NULL; \
+    return status; \
+} \
+\
+LTFAT_API int \
+LTFAT_NAME(k ## _execute_newarray)(LTFAT_NAME(k ## _plan)* p, \
+                                   const TIN in[], TOUT out[]) \
+{ \
+    int status = LTFATERR_SUCCESS; \
+    CHECKNULL(p); \
+    DISPATCH(p->backend, OP_EXECUTE, k) \
+error: \
+    return status; \
+} \
+\
+LTFAT_API size_t \
+LTFAT_NAME(k ## _get_workspace_size)(const LTFAT_NAME(k ## _plan)* p) \
+{ \
+    size_t size = 0; \
+    int status = LTFATERR_SUCCESS; \
+    if (!p) return 0; \
+    DISPATCH(p->backend, OP_WORKSPACE_SIZE, k) \
+    (void) status; \
+    return size; \
+} \
+\
+LTFAT_API int \
+LTFAT_NAME(k ## _execute_ws)(const LTFAT_NAME(k ## _plan)* p, \
+                             const TIN in[], TOUT out[], void* work) \
+{ \
+    int status = LTFATERR_SUCCESS; \
+    CHECKNULL(p); \
+    DISPATCH(p->backend, OP_EXECUTE_WS, k) \
+error: \
+    return status; \
+} \
+\
+LTFAT_API int \
+LTFAT_NAME(k ## _execute)(LTFAT_NAME(k ## _plan)* p) \
+{ \
+    int status = LTFATERR_SUCCESS; \
+    CHECKNULL(p); \
+    status = LTFAT_NAME(k ## _execute_newarray)(p, p->in, p->out); \
+error: \
+    return status; \
+} \
+\
+LTFAT_API int \
+LTFAT_NAME(k ## _done)(LTFAT_NAME(k ## _plan)** p) \
+{ \
+    LTFAT_NAME(k ## _plan)* pp = NULL; \
+    int status = LTFATERR_SUCCESS; \
+    CHECKNULL(p); CHECKNULL(*p); \
+    pp = *p; \
+    DISPATCH(pp->backend, OP_DONE, k) \
+    ltfat_free(pp); \
+    *p = NULL; \
+error: \
+    return status; \
+}
+
+LTFAT_FFT_DISPATCH_DEFINE(fft, LTFAT_FFT_KIND_FFT, LTFAT_COMPLEX, LTFAT_COMPLEX)
+LTFAT_FFT_DISPATCH_DEFINE(ifft, LTFAT_FFT_KIND_IFFT, LTFAT_COMPLEX, LTFAT_COMPLEX)
+LTFAT_FFT_DISPATCH_DEFINE(fftreal, LTFAT_FFT_KIND_FFTREAL, LTFAT_REAL, LTFAT_COMPLEX)
+LTFAT_FFT_DISPATCH_DEFINE(ifftreal, LTFAT_FFT_KIND_IFFTREAL, LTFAT_COMPLEX, LTFAT_REAL)
+
+LTFAT_API int
+LTFAT_NAME(fft_cache_clear)(void)
+{
+    int destroyed = 0;
+
+    for (ltfat_int ii = 0; ii < LTFAT_FFT_NBACKENDS; ii++)
+    {
+        int status = LTFATERR_SUCCESS;
+        DISPATCH(LTFAT_NAME(fft_backends)[ii], OP_CACHECLEAR, fft)
+        (void) status;
+    }
+
+    return destroyed;
+}
+
+#ifndef FFTW
+LTFAT_API int
+LTFAT_NAME(fftw_wisdom_load)(const char* UNUSED(path))
+{
+    return LTFATERR_NOTSUPPORTED;
+}
+
+LTFAT_API int
+LTFAT_NAME(fftw_wisdom_save)(const char* UNUSED(path))
+{
+    return LTFATERR_NOTSUPPORTED;
+}
+
+LTFAT_API int
+LTFAT_NAME(fftw_set_wisdomonly)(int UNUSED(do_wisdomonly))
+{
+    return LTFATERR_SUCCESS;
+}
+#endif
+
+/****** AUTOTUNING ******/
+/* Doubles the number of repetitions until a run takes at least
+ * LTFAT_FFT_TUNE_MINTIME, then takes the best of 3 runs */
+#define LTFAT_FFT_TIMEIT(call, t) \
+    do { \
+        ltfat_int reps = 1; \
+        double t0, elapsed; \
+        call; \
+        for (;;) \
+        { \
+            t0 = ltfat_fft_tune_clock(); \
+            for (ltfat_int r = 0; r < reps; r++) call; \
+            elapsed = ltfat_fft_tune_clock() - t0; \
+            if (elapsed >= LTFAT_FFT_TUNE_MINTIME || reps >= (1 << 20)) break; \
+            reps *= 2; \
+        } \
+        t = elapsed; \
+        for (int run = 0; run < 2; run++) \
+        { \
+            t0 = ltfat_fft_tune_clock(); \
+            for (ltfat_int r = 0; r < reps; r++) call; \
+            elapsed = ltfat_fft_tune_clock() - t0; \
+            if (elapsed < t) t = elapsed; \
+        } \
+        t /= (double) reps; \
+    } while (0)
+
+/* Returns the time per execution or a negative number on failure */
+static double
+LTFAT_NAME(fft_time)(ltfat_fft_kind kind, ltfat_int L, ltfat_int W,
+                     LTFAT_COMPLEX* in, LTFAT_COMPLEX* out, unsigned flags)
+{
+    double t = -1.0;
+
+    switch (kind)
+    {
+    case LTFAT_FFT_KIND_FFT:
+    {
+        LTFAT_NAME(fft_plan)* p = NULL;
+        if (LTFAT_NAME(fft_init)(L, W, in, out, flags, &p) < 0) break;
+        LTFAT_FFT_TIMEIT(LTFAT_NAME(fft_execute)(p), t);
+        LTFAT_NAME(fft_done)(&p);
+        break;
+    }
+    case LTFAT_FFT_KIND_IFFT:
+    {
+        LTFAT_NAME(ifft_plan)* p = NULL;
+        if (LTFAT_NAME(ifft_init)(L, W, in, out, flags, &p) < 0) break;
+        LTFAT_FFT_TIMEIT(LTFAT_NAME(ifft_execute)(p), t);
+        LTFAT_NAME(ifft_done)(&p);
+        break;
+    }
+    case LTFAT_FFT_KIND_FFTREAL:
+    {
+        LTFAT_NAME(fftreal_plan)* p = NULL;
+        if (LTFAT_NAME(fftreal_init)(L, W, (LTFAT_REAL*) in, out, flags, &p) < 0)
+            break;
+        LTFAT_FFT_TIMEIT(LTFAT_NAME(fftreal_execute)(p), t);
+        LTFAT_NAME(fftreal_done)(&p);
+        break;
+    }
+    case LTFAT_FFT_KIND_IFFTREAL:
+    {
+        LTFAT_NAME(ifftreal_plan)* p = NULL;
+        if (LTFAT_NAME(ifftreal_init)(L, W, in, (LTFAT_REAL*) out, flags, &p) < 0)
+            break;
+        LTFAT_FFT_TIMEIT(LTFAT_NAME(ifftreal_execute)(p), t);
+        LTFAT_NAME(ifftreal_done)(&p);
+        break;
+    }
+    }
+
+    return t;
+}
+
+/* Returns the fastest backend or LTFAT_FFT_BACKEND_AUTO on failure */
+static ltfat_fft_backend
+LTFAT_NAME(fft_tune_kind)(ltfat_fft_kind kind, ltfat_int L, ltfat_int W,
+                          unsigned flags)
+{
+    ltfat_fft_backend best = LTFAT_FFT_BACKEND_AUTO;
+    LTFAT_COMPLEX* in = NULL;
+    LTFAT_COMPLEX* out = NULL;
+    double besttime = -1.0;
+
+    if (LTFAT_FFT_NBACKENDS == 1)
+        return LTFAT_NAME(fft_backends)[0];
+
+    if (!(in = LTFAT_NAME_COMPLEX(calloc)(L * W)) ||
+        !(out = LTFAT_NAME_COMPLEX(calloc)(L * W)))
+        goto cleanup;
+
+    flags &= ~LTFAT_FFT_BACKENDMASK;
+
+    for (ltfat_int ii = 0; ii < LTFAT_FFT_NBACKENDS; ii++)
+    {
+        ltfat_fft_backend b = LTFAT_NAME(fft_backends)[ii];
+        double t = LTFAT_NAME(fft_time)(kind, L, W, in, out,
+                                        flags | LTFAT_FFT_BACKEND(b));
+        if (t >= 0.0 && (besttime < 0.0 || t < besttime))
+        {
+            besttime = t;
+            best = b;
+        }
+    }
+
+cleanup:
+    ltfat_safefree(in);
+    ltfat_safefree(out);
+    return best;
+}
+
+LTFAT_API int
+LTFAT_NAME(fft_tune)(ltfat_int L, ltfat_int W, unsigned flags)
+{
+    int status = LTFATERR_SUCCESS;
+
+    CHECK(LTFATERR_NOTPOSARG, L > 0, "L must be positive");
+    CHECK(LTFATERR_NOTPOSARG, W > 0, "W must be positive");
+
+    for (int kind = LTFAT_FFT_KIND_FFT; kind <= LTFAT_FFT_KIND_IFFTREAL; kind++)
+    {
+        ltfat_fft_backend b =
+            LTFAT_NAME(fft_tune_kind)((ltfat_fft_kind) kind, L, W, flags);
+        CHECK(LTFATERR_FAILED, b != LTFAT_FFT_BACKEND_AUTO,
+              "Timing of the FFT backends failed");
+        CHECKSTATUS( ltfat_fft_tune_store(LTFAT_FFT_ISSINGLE,
+                                          (ltfat_fft_kind) kind, L, W, b));
+    }
+error:
+    return status;
+}
+
+#else
+
+LTFAT_API int
+LTFAT_NAME(fft_tune)(ltfat_int UNUSED(L), ltfat_int UNUSED(W),
+                     unsigned UNUSED(flags))
+{
+    return LTFATERR_NOTSUPPORTED;
+}
+
+#endif
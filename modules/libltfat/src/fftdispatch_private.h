@@ -0,0 +1,104 @@
+#ifndef _ltfat_fftdispatch_private_h
+#define _ltfat_fftdispatch_private_h
+
+/*
+ * With LTFAT_FFT_DISPATCH, each FFT backend compiles its fft, ifft,
+ * fftreal and ifftreal functions under its own prefix (e.g.
+ * ltfat_native_fft_init_d) and fftdispatch.c provides the public ones.
+ * Otherwise, the single backend provides the public functions directly.
+ */
+#ifdef LTFAT_FFT_DISPATCH
+#  define LTFAT_FFTBACKEND_API
+#  define LTFAT_FFTBACKEND_NAME(backend, name) LTFAT_NAME(backend ## _ ## name)
+#else
+#  define LTFAT_FFTBACKEND_API LTFAT_API
+#  define LTFAT_FFTBACKEND_NAME(backend, name) LTFAT_NAME(name)
+#endif
+
+/* Bits of the plan flags selecting the backend, see LTFAT_FFT_BACKEND */
+#define LTFAT_FFT_BACKENDMASK LTFAT_FFT_BACKEND(0x3U)
+
+typedef enum
+{
+    LTFAT_FFT_KIND_FFT = 0,
+    LTFAT_FFT_KIND_IFFT,
+    LTFAT_FFT_KIND_FFTREAL,
+    LTFAT_FFT_KIND_IFFTREAL
+} ltfat_fft_kind;
+
+/* Tuning table, see fftdispatch_typeconstant.c */
+ltfat_fft_backend
+ltfat_fft_tune_lookup(int single, ltfat_fft_kind kind, ltfat_int L, ltfat_int W);
+
+int
+ltfat_fft_tune_store(int single, ltfat_fft_kind kind, ltfat_int L, ltfat_int W,
+                     ltfat_fft_backend backend);
+
+int
+ltfat_fft_get_autotune(void);
+
+/* Monotonic time in seconds */
+double
+ltfat_fft_tune_clock(void);
+
+#endif
+
+/* Typed part, included from type-dependent files only */
+#if defined(LTFAT_FFT_DISPATCH) && defined(LTFAT_NAME) && !defined(LTFAT_FFTBACKEND_DECLARE)
+#define LTFAT_FFTBACKEND_DECLARE(b) \
+typedef struct LTFAT_NAME(b ## _fft_plan) LTFAT_NAME(b ## _fft_plan); \
+int LTFAT_NAME(b ## _fft_init)(ltfat_int L, ltfat_int W, \
+        LTFAT_COMPLEX in[], LTFAT_COMPLEX out[], \
+        unsigned flags, LTFAT_NAME(b ## _fft_plan)** p); \
+int LTFAT_NAME(b ## _fft_execute_newarray)(LTFAT_NAME(b ## _fft_plan)* p, \
+        const LTFAT_COMPLEX in[], LTFAT_COMPLEX out[]); \
+int LTFAT_NAME(b ## _fft_execute)(LTFAT_NAME(b ## _fft_plan)* p); \
+size_t LTFAT_NAME(b ## _fft_get_workspace_size)(const LTFAT_NAME(b ## _fft_plan)* p); \
+int LTFAT_NAME(b ## _fft_execute_ws)(const LTFAT_NAME(b ## _fft_plan)* p, \
+        const LTFAT_COMPLEX in[], LTFAT_COMPLEX out[], void* work); \
+int LTFAT_NAME(b ## _fft_done)(LTFAT_NAME(b ## _fft_plan)** p); \
+typedef struct LTFAT_NAME(b ## _ifft_plan) LTFAT_NAME(b ## _ifft_plan); \
+int LTFAT_NAME(b ## _ifft_init)(ltfat_int L, ltfat_int W, \
+        LTFAT_COMPLEX in[], LTFAT_COMPLEX out[], \
+        unsigned flags, LTFAT_NAME(b ## _ifft_plan)** p); \
+int LTFAT_NAME(b ## _ifft_execute_newarray)(LTFAT_NAME(b ## _ifft_plan)* p, \
+        const LTFAT_COMPLEX in[], LTFAT_COMPLEX out[]); \
+int LTFAT_NAME(b ## _ifft_execute)(LTFAT_NAME(b ## _ifft_plan)* p); \
+size_t LTFAT_NAME(b ## _ifft_get_workspace_size)(const LTFAT_NAME(b ## _ifft_plan)* p); \
+int LTFAT_NAME(b ## _ifft_execute_ws)(const LTFAT_NAME(b ## _ifft_plan)* p, \
+        const LTFAT_COMPLEX in[], LTFAT_COMPLEX out[], void* work); \
+int LTFAT_NAME(b ## _ifft_done)(LTFAT_NAME(b ## _ifft_plan)** p); \
+typedef struct LTFAT_NAME(b ## _fftreal_plan) LTFAT_NAME(b ## _fftreal_plan); \
+int LTFAT_NAME(b ## _fftreal_init)(ltfat_int L, ltfat_int W, \
+        LTFAT_REAL in[], LTFAT_COMPLEX out[], \
+        unsigned flags, LTFAT_NAME(b ## _fftreal_plan)** p); \
+int LTFAT_NAME(b ## _fftreal_execute_newarray)(LTFAT_NAME(b ## _fftreal_plan)* p, \
+        const LTFAT_REAL in[], LTFAT_COMPLEX out[]); \
+int LTFAT_NAME(b ## _fftreal_execute)(LTFAT_NAME(b ## _fftreal_plan)* p); \
+size_t LTFAT_NAME(b ## _fftreal_get_workspace_size)(const LTFAT_NAME(b ## _fftreal_plan)* p); \
+int LTFAT_NAME(b ## _fftreal_execute_ws)(const LTFAT_NAME(b ## _fftreal_plan)* p, \
+        const LTFAT_REAL in[], LTFAT_COMPLEX out[], void* work); \
+int LTFAT_NAME(b ## _fftreal_done)(LTFAT_NAME(b ## _fftreal_plan)** p); \
+typedef struct LTFAT_NAME(b ## _ifftreal_plan) LTFAT_NAME(b ## _ifftreal_plan); \
+int LTFAT_NAME(b ## _ifftreal_init)(ltfat_int L, ltfat_int W, \
+        LTFAT_COMPLEX in[], LTFAT_REAL out[], \
+        unsigned flags, LTFAT_NAME(b ## _ifftreal_plan)** p); \
+int LTFAT_NAME(b ## _ifftreal_execute_newarray)(LTFAT_NAME(b ## _ifftreal_plan)* p, \
+        const LTFAT_COMPLEX in[], LTFAT_REAL out[]); \
+int LTFAT_NAME(b ## _ifftreal_execute)(LTFAT_NAME(b ## _ifftreal_plan)* p); \
+size_t LTFAT_NAME(b ## _ifftreal_get_workspace_size)(const LTFAT_NAME(b ## _ifftreal_plan)* p); \
+int LTFAT_NAME(b ## _ifftreal_execute_ws)(const LTFAT_NAME(b ## _ifftreal_plan)* p, \
+        const LTFAT_COMPLEX in[], LTFAT_REAL out[], void* work); \
+int LTFAT_NAME(b ## _ifftreal_done)(LTFAT_NAME(b ## _ifftreal_plan)** p); \
+int LTFAT_NAME(b ## _fft_cache_clear)(void);
+
+#ifdef FFTW
+LTFAT_FFTBACKEND_DECLARE(fftw)
+#endif
+#ifdef NATIVEFFT
+LTFAT_FFTBACKEND_DECLARE(native)
+#endif
+#ifdef KISS
+LTFAT_FFTBACKEND_DECLARE(kiss)
+#endif
+#endif
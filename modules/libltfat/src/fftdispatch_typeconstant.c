@@ -0,0 +1,273 @@
+#if !defined(_WIN32) && !defined(__WIN32__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "ltfat.h"
+#include "ltfat/types.h"
+#include "ltfat/macros.h"
+#include "fftdispatch_private.h"
+#include "threads_private.h"
+
+#include <stdio.h>
+
+#if defined(_WIN32) || defined(__WIN32__)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+typedef struct ltfat_fft_tuneentry ltfat_fft_tuneentry;
+
+struct ltfat_fft_tuneentry
+{
+    int single;
+    ltfat_fft_kind kind;
+    ltfat_int L;
+    ltfat_int W;
+    ltfat_fft_backend backend;
+    ltfat_fft_tuneentry* next;
+};
+
+static ltfat_mutex_t tune_mutex = LTFAT_MUTEX_INITIALIZER;
+static ltfat_fft_tuneentry* tune_head = NULL;
+static ltfat_fft_backend fft_backend = LTFAT_FFT_BACKEND_AUTO;
+static int fft_autotune = 0;
+
+static const char* ltfat_fft_kind_names[] = {"fft", "ifft", "fftreal", "ifftreal"};
+static const char* ltfat_fft_backend_names[] = {"auto", "fftw", "native", "kiss"};
+
+LTFAT_API int
+ltfat_fft_backend_available(ltfat_fft_backend backend)
+{
+    switch (backend)
+    {
+#ifdef FFTW
+    case LTFAT_FFT_BACKEND_FFTW: return 1;
+#endif
+#ifdef NATIVEFFT
+    case LTFAT_FFT_BACKEND_NATIVE: return 1;
+#endif
+#ifdef KISS
+    case LTFAT_FFT_BACKEND_KISS: return 1;
+#endif
+    default: return 0;
+    }
+}
+
+LTFAT_API const char*
+ltfat_fft_backend_name(ltfat_fft_backend backend)
+{
+    if ((int) backend < 0 || (int) backend > LTFAT_FFT_BACKEND_KISS)
+        return NULL;
+    return ltfat_fft_backend_names[backend];
+}
+
+LTFAT_API int
+ltfat_fft_set_backend(ltfat_fft_backend backend)
+{
+    int status = LTFATERR_SUCCESS;
+    CHECK(LTFATERR_NOTSUPPORTED,
+          backend == LTFAT_FFT_BACKEND_AUTO || ltfat_fft_backend_available(backend),
+          "FFT backend %d is not compiled in", (int) backend);
+
+    fft_backend = backend;
+error:
+    return status;
+}
+
+LTFAT_API ltfat_fft_backend
+ltfat_fft_get_backend(void)
+{
+    return fft_backend;
+}
+
+LTFAT_API int
+ltfat_fft_set_autotune(int do_autotune)
+{
+    fft_autotune = do_autotune;
+    return LTFATERR_SUCCESS;
+}
+
+int
+ltfat_fft_get_autotune(void)
+{
+    return fft_autotune;
+}
+
+double
+ltfat_fft_tune_clock(void)
+{
+#if defined(_WIN32) || defined(__WIN32__)
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (double) count.QuadPart / (double) freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + 1e-9 * (double) ts.tv_nsec;
+#endif
+}
+
+/* Expects the table to be locked */
+static int
+ltfat_fft_tune_store_locked(int single, ltfat_fft_kind kind, ltfat_int L,
+                            ltfat_int W, ltfat_fft_backend backend)
+{
+    ltfat_fft_tuneentry* e;
+    int status = LTFATERR_SUCCESS;
+
+    for (e = tune_head; e; e = e->next)
+        if (e->single == single && e->kind == kind && e->L == L && e->W == W)
+            break;
+
+    if (!e)
+    {
+        CHECKMEM( e = LTFAT_NEW(ltfat_fft_tuneentry) );
+        e->single = single; e->kind = kind; e->L = L; e->W = W;
+        e->next = tune_head;
+        tune_head = e;
+    }
+    e->backend = backend;
+error:
+    return status;
+}
+
+int
+ltfat_fft_tune_store(int single, ltfat_fft_kind kind, ltfat_int L, ltfat_int W,
+                     ltfat_fft_backend backend)
+{
+    int status;
+    ltfat_mutex_lock(&tune_mutex);
+    status = ltfat_fft_tune_store_locked(single, kind, L, W, backend);
+    ltfat_mutex_unlock(&tune_mutex);
+    return status;
+}
+
+ltfat_fft_backend
+ltfat_fft_tune_lookup(int single, ltfat_fft_kind kind, ltfat_int L, ltfat_int W)
+{
+    ltfat_fft_backend backend = LTFAT_FFT_BACKEND_AUTO;
+
+    ltfat_mutex_lock(&tune_mutex);
+    for (ltfat_fft_tuneentry* e = tune_head; e; e = e->next)
+        if (e->single == single && e->kind == kind && e->L == L && e->W == W)
+        {
+            backend = e->backend;
+            break;
+        }
+    ltfat_mutex_unlock(&tune_mutex);
+
+    return backend;
+}
+
+LTFAT_API int
+ltfat_fft_tune_clear(void)
+{
+    int removed = 0;
+
+    ltfat_mutex_lock(&tune_mutex);
+    while (tune_head)
+    {
+        ltfat_fft_tuneentry* e = tune_head;
+        tune_head = e->next;
+        ltfat_free(e);
+        removed++;
+    }
+    ltfat_mutex_unlock(&tune_mutex);
+
+    return removed;
+}
+
+/*
+ * The file is a text file with one entry per line
+ *
+ *   precision transform L W backend
+ *
+ * e.g. "d fftreal 44100 1 native". Lines starting with # are ignored.
+ */
+LTFAT_API int
+ltfat_fft_tune_load(const char* path)
+{
+    FILE* fp = NULL;
+    char line[256];
+    int status = LTFATERR_SUCCESS;
+
+    CHECKNULL(path);
+    fp = fopen(path, "r");
+    CHECK(LTFATERR_FAILED, fp, "Cannot open %s", path);
+
+    ltfat_mutex_lock(&tune_mutex);
+    while (status == LTFATERR_SUCCESS && fgets(line, sizeof line, fp))
+    {
+        char prec, kindstr[16], backendstr[16];
+        long long L, W;
+        int kind = -1, backend = -1;
+
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r')
+            continue;
+
+        if (sscanf(line, " %c %15s %lld %lld %15s",
+                   &prec, kindstr, &L, &W, backendstr) != 5 ||
+            (prec != 'd' && prec != 's') || L <= 0 || W <= 0)
+        {
+            status = LTFATERR_FAILED;
+            break;
+        }
+
+        for (int ii = 0; ii < 4; ii++)
+        {
+            if (!strcmp(kindstr, ltfat_fft_kind_names[ii])) kind = ii;
+            if (!strcmp(backendstr, ltfat_fft_backend_names[ii])) backend = ii;
+        }
+
+        if (kind < 0 || backend < 0)
+        {
+            status = LTFATERR_FAILED;
+            break;
+        }
+
+        if (!ltfat_fft_backend_available((ltfat_fft_backend) backend))
+            continue;
+
+        status = ltfat_fft_tune_store_locked(prec == 's', (ltfat_fft_kind) kind,
+                                             (ltfat_int) L, (ltfat_int) W,
+                                             (ltfat_fft_backend) backend);
+    }
+    ltfat_mutex_unlock(&tune_mutex);
+
+    CHECK(status, status == LTFATERR_SUCCESS, "Cannot parse %s", path);
+error:
+    if (fp) fclose(fp);
+    return status;
+}
+
+LTFAT_API int
+ltfat_fft_tune_save(const char* path)
+{
+    FILE* fp = NULL;
+    int status = LTFATERR_SUCCESS;
+    int failed = 0;
+
+    CHECKNULL(path);
+    fp = fopen(path, "w");
+    CHECK(LTFATERR_FAILED, fp, "Cannot open %s", path);
+
+    ltfat_mutex_lock(&tune_mutex);
+    failed = fprintf(fp, "# ltfat FFT tuning table v1\n"
+                     "# precision transform L W backend\n") < 0;
+
+    for (ltfat_fft_tuneentry* e = tune_head; e && !failed; e = e->next)
+        failed = fprintf(fp, "%c %s %lld %lld %s\n", e->single ? 's' : 'd',
+                         ltfat_fft_kind_names[e->kind], (long long) e->L,
+                         (long long) e->W,
+                         ltfat_fft_backend_names[e->backend]) < 0;
+    ltfat_mutex_unlock(&tune_mutex);
+
+    failed = fclose(fp) || failed;
+    fp = NULL;
+    CHECK(LTFATERR_FAILED, !failed, "Cannot write %s", path);
+error:
+    if (fp) fclose(fp);
+    return status;
+}
@@ -0,0 +1,17 @@
+#ifndef _ltfat_fftw_private_h
+#define _ltfat_fftw_private_h
+
+/*
+ * The FFTW planner is not thread-safe. Plans created outside of
+ * fftw_wrappers.c must go through these, which hold the plan cache lock.
+ */
+LTFAT_FFTW(plan)
+LTFAT_NAME_REAL(fftw_plan_r2r)(const LTFAT_FFTW(iodim64)* dims,
+                               const LTFAT_FFTW(iodim64)* howmany_dims,
+                               LTFAT_REAL* in, LTFAT_REAL* out,
+                               LTFAT_FFTW(r2r_kind) kind, unsigned flags);
+
+void
+LTFAT_NAME_REAL(fftw_destroy_plan)(LTFAT_FFTW(plan) p);
+
+#endif
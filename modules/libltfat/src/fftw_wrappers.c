@@ -2,9 +2,338 @@
 #include "ltfat/types.h"
 #include "ltfat/macros.h"
 #include "ltfat/thirdparty/fftw3.h"
+#include "threads_private.h"
+#include "rtsafe_private.h"
+#include "fftdispatch_private.h"
+#include "fftw_private.h"
+
+#define FFTNAME(name) LTFAT_FFTBACKEND_NAME(fftw, name)
+
+/****** PLAN CACHE ******/
+/*
+ * FFTW plans are shared by all wrapper plans having the same geometry.
+ * Each wrapper plan only keeps its own in/out pointers and always runs
+ * through the new-array execute interface, which is thread-safe.
+ * Unused plans are kept around (most recently used first) so that
+ * plans which are repeatedly created and destroyed are planned only once.
+ * The number of threads is passed in the upper bits of flags, see
+ * LTFAT_FFT_NTHREADS. It is honored only if FFTW threads are available
+ * (LTFAT_FFTW_THREADS).
+ */
+#ifndef LTFAT_FFTW_PLANCACHE_MAXIDLE
+#define LTFAT_FFTW_PLANCACHE_MAXIDLE 64
+#endif
+
+/* Transforms with less than that many samples in total are not worth
+ * spreading among several threads. */
+#ifndef LTFAT_FFTW_THREADS_MINSIZE
+#define LTFAT_FFTW_THREADS_MINSIZE 16384
+#endif
+
+enum
+{
+    LTFAT_FFTW_CACHE_FFT,
+    LTFAT_FFTW_CACHE_IFFT,
+    LTFAT_FFTW_CACHE_FFTREAL,
+    LTFAT_FFTW_CACHE_IFFTREAL
+};
+
+typedef struct
+{
+    int kind;
+    ltfat_int L;
+    ltfat_int W;
+    int inplace;
+    int inalign;
+    int outalign;
+    int nthreads;
+    unsigned flags;
+} LTFAT_NAME(fftw_cachekey);
+
+typedef struct LTFAT_NAME(fftw_cacheentry) LTFAT_NAME(fftw_cacheentry);
+
+struct LTFAT_NAME(fftw_cacheentry)
+{
+    LTFAT_NAME(fftw_cachekey) key;
+    size_t refcount;
+    LTFAT_FFTW(plan) p;
+    LTFAT_NAME(fftw_cacheentry)* next;
+};
+
+static ltfat_mutex_t plancache_mutex = LTFAT_MUTEX_INITIALIZER;
+static LTFAT_NAME(fftw_cacheentry)* plancache_head = NULL;
+static int wisdomonly = 0;
+#ifdef LTFAT_FFTW_THREADS
+static int threadsinitialized = 0;
+#endif
+
+static int
+LTFAT_NAME(fftw_cachekey_isequal)(const LTFAT_NAME(fftw_cachekey)* k1,
+                                  const LTFAT_NAME(fftw_cachekey)* k2)
+{
+    return k1->kind == k2->kind && k1->L == k2->L && k1->W == k2->W &&
+           k1->inplace == k2->inplace && k1->inalign == k2->inalign &&
+           k1->outalign == k2->outalign && k1->nthreads == k2->nthreads &&
+           k1->flags == k2->flags;
+}
+
+static LTFAT_FFTW(plan)
+LTFAT_NAME(fftw_plan_guru)(const LTFAT_NAME(fftw_cachekey)* k,
+                           void* in, void* out)
+{
+    LTFAT_FFTW(iodim64) dims;
+    LTFAT_FFTW(iodim64) howmany_dims;
+    ltfat_int M2 = k->L / 2 + 1;
+
+    dims.n = k->L; dims.is = 1; dims.os = 1;
+    howmany_dims.n = k->W;
+
+#ifdef LTFAT_FFTW_THREADS
+    if (!threadsinitialized)
+        threadsinitialized = LTFAT_FFTW(init_threads)();
+
+    if (threadsinitialized)
+        LTFAT_FFTW(plan_with_nthreads)(k->nthreads);
+#endif
+
+    switch (k->kind)
+    {
+    case LTFAT_FFTW_CACHE_FFT:
+    case LTFAT_FFTW_CACHE_IFFT:
+        howmany_dims.is = k->L; howmany_dims.os = k->L;
+        return LTFAT_FFTW(plan_guru64_dft)(1, &dims, 1, &howmany_dims,
+                                           (LTFAT_FFTW(complex)*) in,
+                                           (LTFAT_FFTW(complex)*) out,
+                                           k->kind == LTFAT_FFTW_CACHE_FFT ?
+                                           FFTW_FORWARD : FFTW_BACKWARD,
+                                           k->flags);
+    case LTFAT_FFTW_CACHE_FFTREAL:
+        howmany_dims.is = k->inplace ? 2 * M2 : k->L; howmany_dims.os = M2;
+        return LTFAT_FFTW(plan_guru64_dft_r2c)(1, &dims, 1, &howmany_dims,
+                                               (LTFAT_REAL*) in,
+                                               (LTFAT_FFTW(complex)*) out,
+                                               k->flags);
+    case LTFAT_FFTW_CACHE_IFFTREAL:
+        howmany_dims.is = M2; howmany_dims.os = k->inplace ? 2 * M2 : k->L;
+        return LTFAT_FFTW(plan_guru64_dft_c2r)(1, &dims, 1, &howmany_dims,
+                                               (LTFAT_FFTW(complex)*) in,
+                                               (LTFAT_REAL*) out,
+                                               k->flags);
+    }
+    return NULL;
+}
+
+/* Destroys unused plans exceeding maxidle. Expects the cache to be locked. */
+static ltfat_int
+LTFAT_NAME(fftw_plancache_trim)(size_t maxidle)
+{
+    LTFAT_NAME(fftw_cacheentry)** link = &plancache_head;
+    size_t idle = 0;
+    ltfat_int destroyed = 0;
+
+    while (*link)
+    {
+        LTFAT_NAME(fftw_cacheentry)* e = *link;
+        if (e->refcount == 0 && ++idle > maxidle)
+        {
+            *link = e->next;
+            LTFAT_FFTW(destroy_plan)(e->p);
+            ltfat_free(e);
+            destroyed++;
+        }
+        else
+            link = &e->next;
+    }
+    return destroyed;
+}
+
+/* Looks up or creates a plan. Expects the cache to be locked. */
+static LTFAT_FFTW(plan)
+LTFAT_NAME(fftw_plancache_lookup)(const LTFAT_NAME(fftw_cachekey)* k,
+                                  void* in, void* out)
+{
+    LTFAT_NAME(fftw_cacheentry)* prev = NULL;
+    LTFAT_NAME(fftw_cacheentry)* e = NULL;
+
+    for (e = plancache_head; e; prev = e, e = e->next)
+        if (LTFAT_NAME(fftw_cachekey_isequal)(&e->key, k))
+            break;
+
+    if (e)
+    {
+        if (prev)
+        {
+            prev->next = e->next;
+            e->next = plancache_head;
+            plancache_head = e;
+        }
+        e->refcount++;
+        return e->p;
+    }
+
+    if (!(e = LTFAT_NEW(LTFAT_NAME(fftw_cacheentry))))
+        return NULL;
+
+    e->key = *k;
+    e->p = LTFAT_NAME(fftw_plan_guru)(k, in, out);
+    if (!e->p)
+    {
+        ltfat_free(e);
+        return NULL;
+    }
+
+    e->refcount = 1;
+    e->next = plancache_head;
+    plancache_head = e;
+    return e->p;
+}
+
+static LTFAT_FFTW(plan)
+LTFAT_NAME(fftw_plancache_acquire)(int kind, ltfat_int L, ltfat_int W,
+                                   void* in, void* out, unsigned flags)
+{
+    LTFAT_NAME(fftw_cachekey) k;
+    LTFAT_FFTW(plan) p = NULL;
+    int nthreads = 1;
+
+#ifdef LTFAT_FFTW_THREADS
+    nthreads = LTFAT_FFT_GETNTHREADS(flags);
+    if (!nthreads) nthreads = ltfat_get_num_threads();
+    if ((size_t) L * W < LTFAT_FFTW_THREADS_MINSIZE) nthreads = 1;
+#endif
+    flags &= ~(LTFAT_FFT_NTHREADS(0xFF) | LTFAT_FFT_BACKENDMASK);
+
+    ltfat_rtsafe_blocking("the FFT plan cache");
+    ltfat_mutex_lock(&plancache_mutex);
+
+    if (wisdomonly && !(flags & FFTW_ESTIMATE))
+        flags |= FFTW_WISDOM_ONLY;
+
+    k.kind = kind; k.L = L; k.W = W; k.flags = flags; k.nthreads = nthreads;
+    k.inplace = in == out;
+    k.inalign = LTFAT_FFTW(alignment_of)((LTFAT_REAL*) in);
+    k.outalign = LTFAT_FFTW(alignment_of)((LTFAT_REAL*) out);
+
+    p = LTFAT_NAME(fftw_plancache_lookup)(&k, in, out);
+
+    // No wisdom for this geometry, settle for an estimated plan
+    if (!p && (flags & FFTW_WISDOM_ONLY))
+    {
+        k.flags = (flags & ~(FFTW_WISDOM_ONLY | FFTW_MEASURE |
+                             FFTW_PATIENT | FFTW_EXHAUSTIVE)) | FFTW_ESTIMATE;
+        p = LTFAT_NAME(fftw_plancache_lookup)(&k, in, out);
+    }
+
+    ltfat_mutex_unlock(&plancache_mutex);
+    return p;
+}
+
+static void
+LTFAT_NAME(fftw_plancache_release)(LTFAT_FFTW(plan) p)
+{
+    LTFAT_NAME(fftw_cacheentry)* e;
+
+    ltfat_rtsafe_blocking("the FFT plan cache");
+    ltfat_mutex_lock(&plancache_mutex);
+
+    for (e = plancache_head; e; e = e->next)
+        if (e->p == p)
+        {
+            if (e->refcount > 0) e->refcount--;
+            break;
+        }
+
+    LTFAT_NAME(fftw_plancache_trim)(LTFAT_FFTW_PLANCACHE_MAXIDLE);
+    ltfat_mutex_unlock(&plancache_mutex);
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(fft_cache_clear)(void)
+{
+    ltfat_int destroyed;
+    ltfat_mutex_lock(&plancache_mutex);
+    destroyed = LTFAT_NAME(fftw_plancache_trim)(0);
+    ltfat_mutex_unlock(&plancache_mutex);
+    return (int) destroyed;
+}
+
+/****** R2R ******/
+LTFAT_FFTW(plan)
+LTFAT_NAME(fftw_plan_r2r)(const LTFAT_FFTW(iodim64)* dims,
+                          const LTFAT_FFTW(iodim64)* howmany_dims,
+                          LTFAT_REAL* in, LTFAT_REAL* out,
+                          LTFAT_FFTW(r2r_kind) kind, unsigned flags)
+{
+    LTFAT_FFTW(plan) p;
+
+    flags &= ~(LTFAT_FFT_NTHREADS(0xFF) | LTFAT_FFT_BACKENDMASK);
+
+    ltfat_mutex_lock(&plancache_mutex);
+#ifdef LTFAT_FFTW_THREADS
+    // Whatever the last cached plan asked for is still in effect
+    if (threadsinitialized)
+        LTFAT_FFTW(plan_with_nthreads)(1);
+#endif
+    p = LTFAT_FFTW(plan_guru64_r2r)(1, dims, 1, howmany_dims, in, out,
+                                    &kind, flags);
+    ltfat_mutex_unlock(&plancache_mutex);
+    return p;
+}
+
+void
+LTFAT_NAME(fftw_destroy_plan)(LTFAT_FFTW(plan) p)
+{
+    ltfat_mutex_lock(&plancache_mutex);
+    LTFAT_FFTW(destroy_plan)(p);
+    ltfat_mutex_unlock(&plancache_mutex);
+}
+
+/****** WISDOM ******/
+/* The planner and the wisdom are shared, hence the cache lock */
+LTFAT_API int
+LTFAT_NAME(fftw_wisdom_load)(const char* path)
+{
+    int success;
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(path);
+
+    ltfat_mutex_lock(&plancache_mutex);
+    success = LTFAT_FFTW(import_wisdom_from_filename)(path);
+    ltfat_mutex_unlock(&plancache_mutex);
+
+    CHECK(LTFATERR_FAILED, success, "Could not import FFTW wisdom from %s", path);
+error:
+    return status;
+}
+
+LTFAT_API int
+LTFAT_NAME(fftw_wisdom_save)(const char* path)
+{
+    int success;
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(path);
+
+    ltfat_mutex_lock(&plancache_mutex);
+    success = LTFAT_FFTW(export_wisdom_to_filename)(path);
+    ltfat_mutex_unlock(&plancache_mutex);
+
+    CHECK(LTFATERR_FAILED, success, "Could not export FFTW wisdom to %s", path);
+error:
+    return status;
+}
+
+LTFAT_API int
+LTFAT_NAME(fftw_set_wisdomonly)(int do_wisdomonly)
+{
+    ltfat_mutex_lock(&plancache_mutex);
+    wisdomonly = do_wisdomonly;
+    ltfat_mutex_unlock(&plancache_mutex);
+    return LTFATERR_SUCCESS;
+}
+
 
 /****** FFT ******/
-struct LTFAT_NAME(fft_plan)
+struct FFTNAME(fft_plan)
 {
     ltfat_int L;
     ltfat_int W;
@@ -13,71 +342,60 @@ struct LTFAT_NAME(fft_plan)
     LTFAT_FFTW(plan) p;
 };
 
-LTFAT_API int
-LTFAT_NAME(fft)(LTFAT_COMPLEX in[], ltfat_int L, ltfat_int W,
+LTFAT_FFTBACKEND_API int
+FFTNAME(fft)(LTFAT_COMPLEX in[], ltfat_int L, ltfat_int W,
                 LTFAT_COMPLEX out[])
 {
-    LTFAT_NAME(fft_plan)* p = NULL;
+    FFTNAME(fft_plan)* p = NULL;
     int status = LTFATERR_SUCCESS;
 
-    CHECKSTATUS( LTFAT_NAME(fft_init)(L, W, in, out, FFTW_ESTIMATE, &p));
-    LTFAT_NAME(fft_execute)(p);
-    LTFAT_NAME(fft_done)(&p);
+    CHECKSTATUS( FFTNAME(fft_init)(L, W, in, out, FFTW_ESTIMATE, &p));
+    FFTNAME(fft_execute)(p);
+    FFTNAME(fft_done)(&p);
 error:
     return status;
 }
 
-LTFAT_API int
-LTFAT_NAME(fft_init)(ltfat_int L, ltfat_int W,
+LTFAT_FFTBACKEND_API int
+FFTNAME(fft_init)(ltfat_int L, ltfat_int W,
                      LTFAT_COMPLEX in[], LTFAT_COMPLEX out[],
-                     unsigned flags, LTFAT_NAME(fft_plan)** p)
+                     unsigned flags, FFTNAME(fft_plan)** p)
 {
-    LTFAT_FFTW(iodim64) dims;
-    LTFAT_FFTW(iodim64) howmany_dims;
-    LTFAT_NAME(fft_plan)* fftwp = NULL;
+    FFTNAME(fft_plan)* fftwp = NULL;
 
     int status = LTFATERR_SUCCESS;
 
     CHECKNULL(p);
     CHECK(LTFATERR_NOTPOSARG, L > 0, "L must be positive");
     CHECK(LTFATERR_NOTPOSARG, W > 0, "W must be positive");
-    CHECKMEM( fftwp = LTFAT_NEW(LTFAT_NAME(fft_plan)) );
+    CHECKMEM( fftwp = LTFAT_NEW(FFTNAME(fft_plan)) );
 
     fftwp->L = L; fftwp->W = W; fftwp->in = in; fftwp->out = out;
 
-    dims.n = L; dims.is = 1; dims.os = 1;
-    howmany_dims.n = W; howmany_dims.is = L; howmany_dims.os = L;
-
-    fftwp->p = LTFAT_FFTW(plan_guru64_dft)(1, &dims, 1, &howmany_dims,
-                                           (LTFAT_FFTW(complex)*)  in,
-                                           (LTFAT_FFTW(complex)*) out,
-                                           FFTW_FORWARD, flags);
+    fftwp->p = LTFAT_NAME(fftw_plancache_acquire)(LTFAT_FFTW_CACHE_FFT,
+               L, W, in, out, flags);
 
     CHECKINIT(fftwp->p, "FFTW plan creation failed.");
     *p = fftwp;
     return status;
 error:
-    if (fftwp)
-    {
-        if (fftwp->p) LTFAT_FFTW(destroy_plan)(fftwp->p);
-        ltfat_free(fftwp);
-    }
-    *p = NULL;
+    if (fftwp) ltfat_free(fftwp);
+    if (p) *p = NULL;
     return status;
 }
 
-LTFAT_API int
-LTFAT_NAME(fft_execute)(LTFAT_NAME(fft_plan)* p)
+LTFAT_FFTBACKEND_API int
+FFTNAME(fft_execute)(FFTNAME(fft_plan)* p)
 {
     int status = LTFATERR_SUCCESS;
-    CHECKNULL(p); CHECKNULL(p->in); CHECKNULL(p->out);
-    LTFAT_FFTW(execute)(p->p);
+    CHECKNULL(p);
+    return FFTNAME(fft_execute_newarray)(p, p->in, p->out);
 error:
     return status;
 }
 
-LTFAT_API int
-LTFAT_NAME(fft_execute_newarray)(LTFAT_NAME(fft_plan)* p,
+LTFAT_FFTBACKEND_API int
+FFTNAME(fft_execute_newarray)(FFTNAME(fft_plan)* p,
                                  const LTFAT_COMPLEX in[], LTFAT_COMPLEX out[])
 {
     int status = LTFATERR_SUCCESS;
@@ -89,22 +407,36 @@ error:
     return status;
 }
 
-LTFAT_API int
-LTFAT_NAME(fft_done)(LTFAT_NAME(fft_plan)** p)
+/* FFTW new-array execute functions are thread-safe and need no scratch */
+LTFAT_FFTBACKEND_API size_t
+FFTNAME(fft_get_workspace_size)(const FFTNAME(fft_plan)* UNUSED(p))
+{
+    return 0;
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(fft_execute_ws)(const FFTNAME(fft_plan)* p,
+                       const LTFAT_COMPLEX in[], LTFAT_COMPLEX out[], void* UNUSED(work))
+{
+    return FFTNAME(fft_execute_newarray)((FFTNAME(fft_plan)*) p, in, out);
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(fft_done)(FFTNAME(fft_plan)** p)
 {
     int status = LTFATERR_SUCCESS;
-    LTFAT_NAME(fft_plan)* pp = NULL;
+    FFTNAME(fft_plan)* pp = NULL;
     CHECKNULL(p); CHECKNULL(*p);
     pp = *p;
-    LTFAT_FFTW(destroy_plan)(pp->p);
+    LTFAT_NAME(fftw_plancache_release)(pp->p);
     ltfat_free(pp);
-    pp = NULL;
+    *p = NULL;
 error:
     return status;
 }
 
-/******* IFFT ******/
-struct LTFAT_NAME(ifft_plan)
+/****** IFFT ******/
+struct FFTNAME(ifft_plan)
 {
     ltfat_int L;
     ltfat_int W;
@@ -113,71 +445,60 @@ struct LTFAT_NAME(ifft_plan)
     LTFAT_FFTW(plan) p;
 };
 
-LTFAT_API int
-LTFAT_NAME(ifft)(LTFAT_COMPLEX in[], ltfat_int L, ltfat_int W,
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifft)(LTFAT_COMPLEX in[], ltfat_int L, ltfat_int W,
                  LTFAT_COMPLEX out[])
 {
-    LTFAT_NAME(ifft_plan)* p = NULL;
+    FFTNAME(ifft_plan)* p = NULL;
     int status = LTFATERR_SUCCESS;
 
-    CHECKSTATUS( LTFAT_NAME(ifft_init)(L, W, in, out, FFTW_ESTIMATE, &p));
-    LTFAT_NAME(ifft_execute)(p);
-    LTFAT_NAME(ifft_done)(&p);
+    CHECKSTATUS( FFTNAME(ifft_init)(L, W, in, out, FFTW_ESTIMATE, &p));
+    FFTNAME(ifft_execute)(p);
+    FFTNAME(ifft_done)(&p);
 error:
     return status;
 }
 
-LTFAT_API int
-LTFAT_NAME(ifft_init)(ltfat_int L, ltfat_int W,
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifft_init)(ltfat_int L, ltfat_int W,
                       LTFAT_COMPLEX in[], LTFAT_COMPLEX out[],
-                      unsigned flags, LTFAT_NAME(ifft_plan)** p)
+                      unsigned flags, FFTNAME(ifft_plan)** p)
 {
-    LTFAT_FFTW(iodim64) dims;
-    LTFAT_FFTW(iodim64) howmany_dims;
-    LTFAT_NAME(ifft_plan)* fftwp = NULL;
+    FFTNAME(ifft_plan)* fftwp = NULL;
 
     int status = LTFATERR_SUCCESS;
 
     CHECKNULL(p);
     CHECK(LTFATERR_NOTPOSARG, L > 0, "L must be positive");
     CHECK(LTFATERR_NOTPOSARG, W > 0, "W must be positive");
-    CHECKMEM( fftwp = LTFAT_NEW(LTFAT_NAME(ifft_plan)) );
+    CHECKMEM( fftwp = LTFAT_NEW(FFTNAME(ifft_plan)) );
 
     fftwp->L = L; fftwp->W = W; fftwp->in = in; fftwp->out = out;
 
-    dims.n = L; dims.is = 1; dims.os = 1;
-    howmany_dims.n = W; howmany_dims.is = L; howmany_dims.os = L;
-
-    fftwp->p = LTFAT_FFTW(plan_guru64_dft)(1, &dims, 1, &howmany_dims,
-                                           (LTFAT_FFTW(complex)*)  in,
-                                           (LTFAT_FFTW(complex)*) out,
-                                           FFTW_BACKWARD, flags);
+    fftwp->p = LTFAT_NAME(fftw_plancache_acquire)(LTFAT_FFTW_CACHE_IFFT,
+               L, W, in, out, flags);
 
     CHECKINIT(fftwp->p, "FFTW plan creation failed.");
     *p = fftwp;
     return status;
 error:
-    if (fftwp)
-    {
-        if (fftwp->p) LTFAT_FFTW(destroy_plan)(fftwp->p);
-        ltfat_free(fftwp);
-    }
-    *p = NULL;
+    if (fftwp) ltfat_free(fftwp);
+    if (p) *p = NULL;
     return status;
 }
 
-LTFAT_API int
-LTFAT_NAME(ifft_execute)(LTFAT_NAME(ifft_plan)* p)
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifft_execute)(FFTNAME(ifft_plan)* p)
 {
     int status = LTFATERR_SUCCESS;
-    CHECKNULL(p); CHECKNULL(p->in); CHECKNULL(p->out);
-    LTFAT_FFTW(execute)(p->p);
+    CHECKNULL(p);
+    return FFTNAME(ifft_execute_newarray)(p, p->in, p->out);
 error:
     return status;
 }
 
-LTFAT_API int
-LTFAT_NAME(ifft_execute_newarray)(LTFAT_NAME(ifft_plan)* p,
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifft_execute_newarray)(FFTNAME(ifft_plan)* p,
                                   const LTFAT_COMPLEX in[], LTFAT_COMPLEX out[])
 {
     int status = LTFATERR_SUCCESS;
@@ -189,22 +510,35 @@ error:
     return status;
 }
 
-LTFAT_API int
-LTFAT_NAME(ifft_done)(LTFAT_NAME(ifft_plan)** p)
+LTFAT_FFTBACKEND_API size_t
+FFTNAME(ifft_get_workspace_size)(const FFTNAME(ifft_plan)* UNUSED(p))
+{
+    return 0;
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifft_execute_ws)(const FFTNAME(ifft_plan)* p,
+                       const LTFAT_COMPLEX in[], LTFAT_COMPLEX out[], void* UNUSED(work))
+{
+    return FFTNAME(ifft_execute_newarray)((FFTNAME(ifft_plan)*) p, in, out);
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifft_done)(FFTNAME(ifft_plan)** p)
 {
     int status = LTFATERR_SUCCESS;
-    LTFAT_NAME(ifft_plan)* pp = NULL;
+    FFTNAME(ifft_plan)* pp = NULL;
     CHECKNULL(p); CHECKNULL(*p);
     pp = *p;
-    LTFAT_FFTW(destroy_plan)(pp->p);
+    LTFAT_NAME(fftw_plancache_release)(pp->p);
     ltfat_free(pp);
-    pp = NULL;
+    *p = NULL;
 error:
     return status;
 }
 
 /****** FFTREAL ******/
-struct LTFAT_NAME(fftreal_plan)
+struct FFTNAME(fftreal_plan)
 {
     ltfat_int L;
     ltfat_int W;
@@ -213,78 +547,60 @@ struct LTFAT_NAME(fftreal_plan)
     LTFAT_FFTW(plan) p;
 };
 
-LTFAT_API int
-LTFAT_NAME(fftreal)(LTFAT_REAL in[], ltfat_int L, ltfat_int W,
+LTFAT_FFTBACKEND_API int
+FFTNAME(fftreal)(LTFAT_REAL in[], ltfat_int L, ltfat_int W,
                     LTFAT_COMPLEX out[])
 {
-    LTFAT_NAME(fftreal_plan)* p = NULL;
+    FFTNAME(fftreal_plan)* p = NULL;
     int status = LTFATERR_SUCCESS;
 
-    CHECKSTATUS( LTFAT_NAME(fftreal_init)(L, W, in, out, FFTW_ESTIMATE, &p));
-    LTFAT_NAME(fftreal_execute)(p);
-    LTFAT_NAME(fftreal_done)(&p);
+    CHECKSTATUS( FFTNAME(fftreal_init)(L, W, in, out, FFTW_ESTIMATE, &p));
+    FFTNAME(fftreal_execute)(p);
+    FFTNAME(fftreal_done)(&p);
 error:
     return status;
 }
 
-LTFAT_API int
-LTFAT_NAME(fftreal_init)(ltfat_int L, ltfat_int W,
+LTFAT_FFTBACKEND_API int
+FFTNAME(fftreal_init)(ltfat_int L, ltfat_int W,
                          LTFAT_REAL in[], LTFAT_COMPLEX out[],
-                         unsigned flags, LTFAT_NAME(fftreal_plan)** p)
+                         unsigned flags, FFTNAME(fftreal_plan)** p)
 {
-    LTFAT_FFTW(iodim64) dims;
-    LTFAT_FFTW(iodim64) howmany_dims;
-    ltfat_int M2;
-    LTFAT_NAME(fftreal_plan)* fftwp = NULL;
+    FFTNAME(fftreal_plan)* fftwp = NULL;
 
     int status = LTFATERR_SUCCESS;
 
     CHECKNULL(p);
     CHECK(LTFATERR_NOTPOSARG, L > 0, "L must be positive");
     CHECK(LTFATERR_NOTPOSARG, W > 0, "W must be positive");
-    CHECKMEM( fftwp = LTFAT_NEW(LTFAT_NAME(fftreal_plan)) );
+    CHECKMEM( fftwp = LTFAT_NEW(FFTNAME(fftreal_plan)) );
 
     fftwp->L = L; fftwp->W = W; fftwp->in = in; fftwp->out = out;
 
-    M2 = L / 2 + 1;
-    dims.n = L; dims.is = 1; dims.os = 1;
-    howmany_dims.n = W;  howmany_dims.os = M2;
-
-    if (in != (LTFAT_REAL*) out )
-        howmany_dims.is = L;
-    else
-        howmany_dims.is = 2 * M2;
-
-    fftwp->p =
-        LTFAT_FFTW(plan_guru64_dft_r2c)(1, &dims, 1, &howmany_dims,
-                                        in, (LTFAT_FFTW(complex)*) out,
-                                        flags);
+    fftwp->p = LTFAT_NAME(fftw_plancache_acquire)(LTFAT_FFTW_CACHE_FFTREAL,
+               L, W, in, out, flags);
 
     CHECKINIT(fftwp->p, "FFTW plan creation failed.");
     *p = fftwp;
     return status;
 error:
-    if (fftwp)
-    {
-        if (fftwp->p) LTFAT_FFTW(destroy_plan)(fftwp->p);
-        ltfat_free(fftwp);
-    }
-    *p = NULL;
+    if (fftwp) ltfat_free(fftwp);
+    if (p) *p = NULL;
     return status;
 }
 
-LTFAT_API int
-LTFAT_NAME(fftreal_execute)(LTFAT_NAME(fftreal_plan)* p)
+LTFAT_FFTBACKEND_API int
+FFTNAME(fftreal_execute)(FFTNAME(fftreal_plan)* p)
 {
     int status = LTFATERR_SUCCESS;
-    CHECKNULL(p); CHECKNULL(p->in); CHECKNULL(p->out);
-    LTFAT_FFTW(execute)(p->p);
+    CHECKNULL(p);
+    return FFTNAME(fftreal_execute_newarray)(p, p->in, p->out);
 error:
     return status;
 }
 
-LTFAT_API int
-LTFAT_NAME(fftreal_execute_newarray)(LTFAT_NAME(fftreal_plan)* p,
+LTFAT_FFTBACKEND_API int
+FFTNAME(fftreal_execute_newarray)(FFTNAME(fftreal_plan)* p,
                                      const LTFAT_REAL in[], LTFAT_COMPLEX out[])
 {
     int status = LTFATERR_SUCCESS;
@@ -294,22 +610,35 @@ error:
     return status;
 }
 
-LTFAT_API int
-LTFAT_NAME(fftreal_done)(LTFAT_NAME(fftreal_plan)** p)
+LTFAT_FFTBACKEND_API size_t
+FFTNAME(fftreal_get_workspace_size)(const FFTNAME(fftreal_plan)* UNUSED(p))
+{
+    return 0;
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(fftreal_execute_ws)(const FFTNAME(fftreal_plan)* p,
+                       const LTFAT_REAL in[], LTFAT_COMPLEX out[], void* UNUSED(work))
+{
+    return FFTNAME(fftreal_execute_newarray)((FFTNAME(fftreal_plan)*) p, in, out);
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(fftreal_done)(FFTNAME(fftreal_plan)** p)
 {
     int status = LTFATERR_SUCCESS;
-    LTFAT_NAME(fftreal_plan)* pp = NULL;
+    FFTNAME(fftreal_plan)* pp = NULL;
     CHECKNULL(p); CHECKNULL(*p);
     pp = *p;
-    LTFAT_FFTW(destroy_plan)(pp->p);
+    LTFAT_NAME(fftw_plancache_release)(pp->p);
     ltfat_free(pp);
-    pp = NULL;
+    *p = NULL;
 error:
     return status;
 }
 
-/******* IFFTREAL ******/
-struct LTFAT_NAME(ifftreal_plan)
+/****** IFFTREAL ******/
+struct FFTNAME(ifftreal_plan)
 {
     ltfat_int L;
     ltfat_int W;
@@ -318,79 +647,60 @@ struct LTFAT_NAME(ifftreal_plan)
     LTFAT_FFTW(plan) p;
 };
 
-LTFAT_API int
-LTFAT_NAME(ifftreal)(LTFAT_COMPLEX in[], ltfat_int L, ltfat_int W,
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifftreal)(LTFAT_COMPLEX in[], ltfat_int L, ltfat_int W,
                      LTFAT_REAL out[])
 {
-    LTFAT_NAME(ifftreal_plan)* p = NULL;
+    FFTNAME(ifftreal_plan)* p = NULL;
     int status = LTFATERR_SUCCESS;
 
-    CHECKSTATUS( LTFAT_NAME(ifftreal_init)(L, W, in, out, FFTW_ESTIMATE, &p));
-    LTFAT_NAME(ifftreal_execute)(p);
-    LTFAT_NAME(ifftreal_done)(&p);
+    CHECKSTATUS( FFTNAME(ifftreal_init)(L, W, in, out, FFTW_ESTIMATE, &p));
+    FFTNAME(ifftreal_execute)(p);
+    FFTNAME(ifftreal_done)(&p);
 error:
     return status;
 }
 
-LTFAT_API int
-LTFAT_NAME(ifftreal_init)(ltfat_int L, ltfat_int W,
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifftreal_init)(ltfat_int L, ltfat_int W,
                           LTFAT_COMPLEX in[], LTFAT_REAL out[],
-                          unsigned flags, LTFAT_NAME(ifftreal_plan)** p)
+                          unsigned flags, FFTNAME(ifftreal_plan)** p)
 {
-    LTFAT_FFTW(iodim64) dims;
-    LTFAT_FFTW(iodim64) howmany_dims;
-    ltfat_int M2;
-    LTFAT_NAME(ifftreal_plan)* fftwp = NULL;
+    FFTNAME(ifftreal_plan)* fftwp = NULL;
 
     int status = LTFATERR_SUCCESS;
 
     CHECKNULL(p);
     CHECK(LTFATERR_NOTPOSARG, L > 0, "L must be positive");
     CHECK(LTFATERR_NOTPOSARG, W > 0, "W must be positive");
-    CHECKMEM( fftwp = LTFAT_NEW(LTFAT_NAME(ifftreal_plan)) );
-
-    M2 = L / 2 + 1;
+    CHECKMEM( fftwp = LTFAT_NEW(FFTNAME(ifftreal_plan)) );
 
     fftwp->L = L; fftwp->W = W; fftwp->in = in; fftwp->out = out;
 
-    dims.n = L; dims.is = 1; dims.os = 1;
-    howmany_dims.n = W; howmany_dims.is = L / 2 + 1;
-
-    if (in != (LTFAT_COMPLEX*) out )
-        howmany_dims.os = L;
-    else
-        howmany_dims.os = 2 * M2;
-
-    fftwp->p =
-        LTFAT_FFTW(plan_guru64_dft_c2r)(1, &dims, 1, &howmany_dims,
-                                        (LTFAT_FFTW(complex)*)  in,
-                                        out, flags);
+    fftwp->p = LTFAT_NAME(fftw_plancache_acquire)(LTFAT_FFTW_CACHE_IFFTREAL,
+               L, W, in, out, flags);
 
     CHECKINIT(fftwp->p, "FFTW plan creation failed.");
     *p = fftwp;
     return status;
 error:
-    if (fftwp)
-    {
-        if (fftwp->p) LTFAT_FFTW(destroy_plan)(fftwp->p);
-        ltfat_free(fftwp);
-    }
-    *p = NULL;
+    if (fftwp) ltfat_free(fftwp);
+    if (p) *p = NULL;
     return status;
 }
 
-LTFAT_API int
-LTFAT_NAME(ifftreal_execute)(LTFAT_NAME(ifftreal_plan)* p)
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifftreal_execute)(FFTNAME(ifftreal_plan)* p)
 {
     int status = LTFATERR_SUCCESS;
-    CHECKNULL(p); CHECKNULL(p->in); CHECKNULL(p->out);
-    LTFAT_FFTW(execute)(p->p);
+    CHECKNULL(p);
+    return FFTNAME(ifftreal_execute_newarray)(p, p->in, p->out);
 error:
     return status;
 }
 
-LTFAT_API int
-LTFAT_NAME(ifftreal_execute_newarray)(LTFAT_NAME(ifftreal_plan)* p,
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifftreal_execute_newarray)(FFTNAME(ifftreal_plan)* p,
                                       const LTFAT_COMPLEX in[], LTFAT_REAL out[])
 {
     int status = LTFATERR_SUCCESS;
@@ -400,16 +710,29 @@ error:
     return status;
 }
 
-LTFAT_API int
-LTFAT_NAME(ifftreal_done)(LTFAT_NAME(ifftreal_plan)** p)
+LTFAT_FFTBACKEND_API size_t
+FFTNAME(ifftreal_get_workspace_size)(const FFTNAME(ifftreal_plan)* UNUSED(p))
+{
+    return 0;
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifftreal_execute_ws)(const FFTNAME(ifftreal_plan)* p,
+                       const LTFAT_COMPLEX in[], LTFAT_REAL out[], void* UNUSED(work))
+{
+    return FFTNAME(ifftreal_execute_newarray)((FFTNAME(ifftreal_plan)*) p, in, out);
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifftreal_done)(FFTNAME(ifftreal_plan)** p)
 {
     int status = LTFATERR_SUCCESS;
-    LTFAT_NAME(ifftreal_plan)* pp = NULL;
+    FFTNAME(ifftreal_plan)* pp = NULL;
     CHECKNULL(p); CHECKNULL(*p);
     pp = *p;
-    LTFAT_FFTW(destroy_plan)(pp->p);
+    LTFAT_NAME(fftw_plancache_release)(pp->p);
     ltfat_free(pp);
-    pp = NULL;
+    *p = NULL;
 error:
     return status;
 }
@@ -1,18 +1,18 @@
-files = dgt.c dgtreal_fb.c dgt_multi.c dgt_ola.c dgt_shear.c	\
+files = dgt.c dgtreal_fb.c dgt_multi.c dgt_shear.c	\
 		dgtreal_long.c dwilt.c idwilt.c wmdct.c iwmdct.c \
 		filterbank.c ifilterbank.c heapint.c heap.c wfacreal.c \
 		idgtreal_long.c idgtreal_fb.c iwfacreal.c pfilt.c reassign_ti.c \
 		windows.c  \
 		dgt_shearola.c utils.c rtdgtreal.c circularbuf.c slicingbuf.c \
 		dgtrealwrapper.c dgtrealmp.c dgtrealmp_parbuf.c dgtrealmp_kernel.c dgtrealmp_guts.c maxtree.c \
-		slidgtrealmp.c \
+		slidgtrealmp.c fftdispatch.c \
 		filterbankphaseret.c fbheapint.c
 
 files_complextransp =\
 ci_utils.c ci_windows.c spread.c wavelets.c goertzel.c \
 reassign.c gabdual_painless.c wfac.c iwfac.c \
 dgt_long.c idgt_long.c dgt_fb.c idgt_fb.c ci_memalloc.c \
-dgtwrapper.c
+dgtwrapper.c dgt_ola.c
 
 files_blaslapack = ltfat_blaslapack.c gabdual_fac.c gabtight_fac.c
 
@@ -23,13 +23,20 @@ files_fftw_complextransp = dct.c dst.c
 files_notypechange = memalloc.c error.c version.c argchecks.c \
 					 dgtwrapper_typeconstant.c dgtrealmp_typeconstant.c  \
 				   	 reassign_typeconstant.c wavelets_typeconstant.c \
-					 integer_manip.c firwin_typeconstant.c
+					 integer_manip.c firwin_typeconstant.c \
+					 threads_typeconstant.c fftdispatch_typeconstant.c \
+					 wfaccache_typeconstant.c procstats_typeconstant.c \
+					 dgtrealmp_kernelcache_typeconstant.c
 
 FFTBACKEND ?= FFTW
 
 ifneq ($(FFTBACKEND),FFTW)
 ifneq ($(FFTBACKEND),KISS)
-$(error FFTBACKEND must be either FFTW or KISS)
+ifneq ($(FFTBACKEND),NATIVE)
+ifneq ($(FFTBACKEND),DISPATCH)
+$(error FFTBACKEND must be either FFTW, NATIVE, KISS or DISPATCH)
+endif
+endif
 endif
 endif
 
@@ -45,6 +52,19 @@ ifeq ($(FFTBACKEND),KISS)
 	CFLAGS+=-DKISS
 endif
 
+ifeq ($(FFTBACKEND),NATIVE)
+	files += nativefft_wrappers.c nativefft.c
+	CFLAGS+=-DNATIVEFFT
+endif
+
+ifeq ($(FFTBACKEND),DISPATCH)
+	files += fftw_wrappers.c nativefft_wrappers.c nativefft.c \
+			 kissfft_wrappers.c kiss_fft.c
+	files_complextransp += $(files_fftw_complextransp)
+	LFLAGS+= $(FFTWLIBS)
+	CFLAGS+=-DFFTW -DNATIVEFFT -DKISS -DLTFAT_FFT_DISPATCH
+endif
+
 ifndef NOBLASLAPACK
 	files += $(files_blaslapack)
 	files_complextransp += $(files_blaslapack_complextransp)
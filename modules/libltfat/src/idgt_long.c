@@ -3,6 +3,23 @@
 #include "ltfat/macros.h"
 
 #include "ltfat/thirdparty/fftw3.h"
+#include "threads_private.h"
+#include "walnut_private.h"
+#include "wfaccache_private.h"
+#include "workspace_private.h"
+
+/* Buffers and FFT plans of the factorization used by a single thread.
+ * ff and cf are only allocated for the threads processing whole cosets.
+ * fftwork is the FFT scratch, NULL for the one owned by the FFT plans. */
+typedef struct
+{
+    LTFAT_NAME_REAL(ifft_plan)* p_before;
+    LTFAT_NAME_REAL(fft_plan)* p_after;
+    LTFAT_COMPLEX* cbuf;
+    LTFAT_REAL* gt;
+    LTFAT_COMPLEX* ff, *cf;
+    void* fftwork;
+} LTFAT_NAME(idgt_long_scratch);
 
 struct LTFAT_NAME(idgt_long_plan)
 {
@@ -16,12 +33,21 @@ struct LTFAT_NAME(idgt_long_plan)
     LTFAT_REAL scalconst;
     LTFAT_COMPLEX* f;
     const LTFAT_COMPLEX* cin;
-    LTFAT_COMPLEX* gf, *ff, *cf, *cwork, *cbuf;
+    const LTFAT_COMPLEX* gf;
+    LTFAT_COMPLEX* cwork;
+    unsigned flags;
+    int nthreads;
+    LTFAT_NAME(idgt_long_scratch)* scratch;
     LTFAT_NAME_REAL(ifft_plan)* p_veryend;
-    LTFAT_NAME_REAL(ifft_plan)* p_before;
-    LTFAT_NAME_REAL(fft_plan)* p_after;
 };
 
+/* Job shared by the threads of a single idgt_walnut_execute call */
+typedef struct
+{
+    LTFAT_NAME(idgt_long_plan)* p;
+    ltfat_int r;
+} LTFAT_NAME(idgt_walnut_job);
+
 LTFAT_API int
 LTFAT_NAME(idgt_long)(const LTFAT_COMPLEX* cin, const LTFAT_TYPE* g,
                       ltfat_int L, ltfat_int W,
@@ -46,6 +72,75 @@ error:
     return status;
 }
 
+static void
+LTFAT_NAME(idgt_long_scratch_free)(LTFAT_NAME(idgt_long_scratch)* scratch,
+                                   int nthreads)
+{
+    for (int t = 0; t < nthreads; t++)
+    {
+        if (scratch[t].p_before) LTFAT_NAME_REAL(ifft_done)(&scratch[t].p_before);
+        if (scratch[t].p_after) LTFAT_NAME_REAL(fft_done)(&scratch[t].p_after);
+        LTFAT_SAFEFREEALL(scratch[t].cbuf, scratch[t].gt, scratch[t].ff,
+                          scratch[t].cf);
+    }
+    ltfat_free(scratch);
+}
+
+/* Replaces the per-thread scratch such that it is prepared for nthreads
+ * threads. */
+static int
+LTFAT_NAME(idgt_long_scratch_realloc)(LTFAT_NAME(idgt_long_plan)* plan,
+                                      int nthreads)
+{
+    LTFAT_NAME(idgt_long_scratch)* scratch = NULL;
+    ltfat_int p = plan->a / plan->c;
+    ltfat_int q = plan->M / plan->c;
+    ltfat_int d = plan->L / plan->M / p;
+    unsigned flags = plan->flags;
+    int nbufs;
+    int status = LTFATERR_SUCCESS;
+
+    if (nthreads == plan->nthreads)
+        return status;
+
+    nbufs = ltfat_walnut_parallel_cosets(plan->c, nthreads) ? nthreads : 1;
+
+    /* The short FFTs are already done in parallel */
+    if (nthreads > 1)
+        flags &= ~LTFAT_FFT_NTHREADS(0xFF);
+
+    CHECKMEM( scratch = LTFAT_NEWARRAY(LTFAT_NAME(idgt_long_scratch), nthreads));
+
+    for (int t = 0; t < nthreads; t++)
+    {
+        CHECKMEM( scratch[t].cbuf = LTFAT_NAME_COMPLEX(malloc)(d));
+        CHECKMEM( scratch[t].gt   = LTFAT_NAME_REAL(malloc)(2 * p * q));
+
+        if (t < nbufs)
+        {
+            CHECKMEM( scratch[t].ff = LTFAT_NAME_COMPLEX(malloc)(d * p * q * plan->W));
+            CHECKMEM( scratch[t].cf = LTFAT_NAME_COMPLEX(malloc)(d * q * q * plan->W));
+        }
+
+        CHECKSTATUS(
+            LTFAT_NAME_REAL(fft_init)(d, 1, scratch[t].cbuf, scratch[t].cbuf, flags,
+                                      &scratch[t].p_after));
+
+        CHECKSTATUS(
+            LTFAT_NAME_REAL(ifft_init)(d, 1, scratch[t].cbuf, scratch[t].cbuf, flags,
+                                       &scratch[t].p_before));
+    }
+
+    if (plan->scratch)
+        LTFAT_NAME(idgt_long_scratch_free)(plan->scratch, plan->nthreads);
+    plan->scratch = scratch;
+    plan->nthreads = nthreads;
+    return status;
+error:
+    if (scratch) LTFAT_NAME(idgt_long_scratch_free)(scratch, nthreads);
+    return status;
+}
+
 LTFAT_API int
 LTFAT_NAME(idgt_long_init)( const LTFAT_TYPE* g,
                             ltfat_int L, ltfat_int W,
@@ -54,7 +149,7 @@ LTFAT_NAME(idgt_long_init)( const LTFAT_TYPE* g,
                             const ltfat_phaseconvention ptype, unsigned flags,
                             LTFAT_NAME(idgt_long_plan)** pout)
 {
-    ltfat_int minL, b, N, p, q, d;
+    ltfat_int minL, b, N, p, d;
     LTFAT_NAME(idgt_long_plan)* plan = NULL;
     // Downcast to int
     int status = LTFATERR_SUCCESS;
@@ -79,6 +174,7 @@ LTFAT_NAME(idgt_long_init)( const LTFAT_TYPE* g,
     ltfat_int h_m;
 
     plan->a = a; plan->L = L; plan->M = M; plan->W = W; plan->ptype = ptype;
+    plan->flags = flags;
     /*  ----------- calculation of parameters and plans -------- */
 
     b = L / M;
@@ -86,41 +182,19 @@ LTFAT_NAME(idgt_long_init)( const LTFAT_TYPE* g,
 
     plan->c = ltfat_gcd(a, M, &plan->h_a, &h_m);
     p = a / plan->c;
-    q = M / plan->c;
     d = b / p;
 
-    CHECKMEM( plan->gf    = LTFAT_NAME_COMPLEX(malloc)(L));
-    CHECKMEM( plan->ff    = LTFAT_NAME_COMPLEX(malloc)(d * p * q * W));
-    CHECKMEM( plan->cf    = LTFAT_NAME_COMPLEX(malloc)(d * q * q * W));
     CHECKMEM( plan->cwork = LTFAT_NAME_COMPLEX(malloc)(M * N * W));
-    CHECKMEM( plan->cbuf  = LTFAT_NAME_COMPLEX(malloc)(d));
     plan->cin = cin;
     plan->f = f;
-    LTFAT_NAME(wfac)(g, L, 1, a, M, plan->gf);
+    CHECKSTATUS(
+        LTFAT_NAME(wfac_shared)(g, L, a, M, &plan->gf));
 
     /* Scaling constant needed because of FFTWs normalization. */
     plan->scalconst = (LTFAT_REAL)(1.0 / ((double)d * sqrt((double)M)));
 
-    /* Create plans. In-place. */
-
-    /* plan->p_after  = LTFAT_FFTW(plan_dft_1d)((int)d, */
-    /*                  (LTFAT_FFTW(complex)*) plan->cbuf, */
-    /*                  (LTFAT_FFTW(complex)*) plan->cbuf, */
-    /*                  FFTW_FORWARD, flags); */
-    /*  */
-    /* CHECKINIT(plan->p_after, "FFTW plan failed."); */
-
-    CHECKSTATUS(
-        LTFAT_NAME_REAL(fft_init)(d, 1, plan->cbuf, plan->cbuf, flags, &plan->p_after));
-
-    /* plan->p_before = LTFAT_FFTW(plan_dft_1d)((int)d, */
-    /*                  (LTFAT_FFTW(complex)*) plan->cbuf, */
-    /*                  (LTFAT_FFTW(complex)*) plan->cbuf, FFTW_BACKWARD, flags); */
-    /* CHECKINIT(plan->p_before, "FFTW plan failed."); */
-
-    CHECKSTATUS(
-        LTFAT_NAME_REAL(ifft_init)(d, 1, plan->cbuf, plan->cbuf, flags,
-                                   &plan->p_before));
+    /* Create plans of the short FFTs. In-place. */
+    CHECKSTATUS( LTFAT_NAME(idgt_long_scratch_realloc)(plan, 1));
 
     /* Create plan. Copy data so we do not overwrite input. Therefore
        it is ok to cast away the constness of cin.*/
@@ -143,6 +217,21 @@ error:
     return status;
 }
 
+LTFAT_API int
+LTFAT_NAME(idgt_long_set_numthreads)(LTFAT_NAME(idgt_long_plan)* p,
+                                     int nthreads)
+{
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(p);
+    CHECK(LTFATERR_NOTINRANGE, nthreads >= 0 && nthreads <= LTFAT_MAXTHREADS,
+          "nthreads (passed %d) must be in range 0-%d.", nthreads, LTFAT_MAXTHREADS);
+
+    return LTFAT_NAME(idgt_long_scratch_realloc)(
+               p, nthreads ? nthreads : ltfat_get_num_threads());
+error:
+    return status;
+}
+
 LTFAT_API int
 LTFAT_NAME(idgt_long_done)(LTFAT_NAME(idgt_long_plan)** plan)
 {
@@ -151,10 +240,10 @@ LTFAT_NAME(idgt_long_done)(LTFAT_NAME(idgt_long_plan)** plan)
     CHECKNULL(plan); CHECKNULL(*plan);
     p = *plan;
 
-    if (p->p_before) LTFAT_NAME_REAL(ifft_done)(&p->p_before);
-    if (p->p_after) LTFAT_NAME_REAL(fft_done)(&p->p_after);
     if (p->p_veryend) LTFAT_NAME_REAL(ifft_done)(&p->p_veryend);
-    LTFAT_SAFEFREEALL(p->gf, p->ff, p->cf, p->cwork, p->cbuf);
+    if (p->scratch) LTFAT_NAME(idgt_long_scratch_free)(p->scratch, p->nthreads);
+    ltfat_wfac_cache_release(p->gf);
+    LTFAT_SAFEFREEALL(p->cwork);
 
     ltfat_free(p);
     p = NULL;
@@ -202,146 +291,279 @@ error:
     return status;
 }
 
-LTFAT_API void
-LTFAT_NAME(idgt_walnut_execute)(LTFAT_NAME(idgt_long_plan)* p)
+/* Takes the buffers of a single-threaded scratch and the plan's cwork from
+ * the workspace at base, or only counts their size if base is NULL */
+static size_t
+LTFAT_NAME(idgt_long_ws_carve)(const LTFAT_NAME(idgt_long_plan)* p, char* base,
+                               LTFAT_NAME(idgt_long_scratch)* sc,
+                               LTFAT_COMPLEX** cwork)
 {
-    ltfat_int b = p->L / p->M;
-    ltfat_int N = p->L / p->a;
+    const LTFAT_NAME(idgt_long_scratch)* sc0 = p->scratch;
+    ltfat_int pp = p->a / p->c;
+    ltfat_int q = p->M / p->c;
+    ltfat_int d = p->L / p->M / pp;
+    size_t fftws, off = 0;
+
+    fftws = LTFAT_NAME_REAL(ifft_get_workspace_size)(sc0->p_before);
+    fftws = ltfat_ws_max(fftws, LTFAT_NAME_REAL(fft_get_workspace_size)(sc0->p_after));
+    fftws = ltfat_ws_max(fftws, LTFAT_NAME_REAL(ifft_get_workspace_size)(p->p_veryend));
+
+    *cwork = (LTFAT_COMPLEX*) ltfat_ws_take(base, &off,
+                                            p->M * (p->L / p->a) * p->W * sizeof(LTFAT_COMPLEX));
+    *sc = *sc0;
+    sc->cbuf = (LTFAT_COMPLEX*) ltfat_ws_take(base, &off, d * sizeof(LTFAT_COMPLEX));
+    sc->gt = (LTFAT_REAL*) ltfat_ws_take(base, &off, 2 * pp * q * sizeof(LTFAT_REAL));
+    sc->ff = (LTFAT_COMPLEX*) ltfat_ws_take(base, &off,
+                                            d * pp * q * p->W * sizeof(LTFAT_COMPLEX));
+    sc->cf = (LTFAT_COMPLEX*) ltfat_ws_take(base, &off,
+                                            d * q * q * p->W * sizeof(LTFAT_COMPLEX));
+    sc->fftwork = ltfat_ws_take(base, &off, fftws);
+    return off;
+}
+
+LTFAT_API size_t
+LTFAT_NAME(idgt_long_get_workspace_size)(const LTFAT_NAME(idgt_long_plan)* p)
+{
+    LTFAT_NAME(idgt_long_scratch) sc;
+    LTFAT_COMPLEX* cwork;
+    if (!p) return 0;
+    return ltfat_ws_size(LTFAT_NAME(idgt_long_ws_carve)(p, NULL, &sc, &cwork));
+}
+
+LTFAT_API int
+LTFAT_NAME(idgt_long_execute_ws)(const LTFAT_NAME(idgt_long_plan)* p,
+                                 const LTFAT_COMPLEX c[], LTFAT_COMPLEX f[],
+                                 void* ws)
+{
+    LTFAT_NAME(idgt_long_plan) p2;
+    LTFAT_NAME(idgt_long_scratch) sc;
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(p); CHECKNULL(c); CHECKNULL(f); CHECKNULL(ws);
+
+    // Shallow copy running single-threaded on the workspace
+    p2 = *p;
+    LTFAT_NAME(idgt_long_ws_carve)(p, ltfat_ws_begin(ws), &sc, &p2.cwork);
+    p2.f = f;
+    p2.nthreads = 1;
+    p2.scratch = &sc;
+
+    LTFAT_NAME_REAL(ifft_execute_ws)(p->p_veryend, c, p2.cwork, sc.fftwork);
+
+    if (p->ptype == LTFAT_TIMEINV)
+        LTFAT_NAME_COMPLEX(dgtphaseunlockhelper)(p2.cwork, p->L, p->W, p->a,
+                p->M, p->M, p2.cwork);
+
+    LTFAT_NAME(idgt_walnut_execute)(&p2);
+error:
+    return status;
+}
 
+/* Coefficient factorization of coset r, items (w,l,u) in range
+ * start..end-1 */
+static void
+LTFAT_NAME(idgt_walnut_fac)(LTFAT_NAME(idgt_long_plan)* p,
+                            LTFAT_NAME(idgt_long_scratch)* sc,
+                            ltfat_int r, LTFAT_COMPLEX* cf,
+                            ltfat_int start, ltfat_int end)
+{
+    ltfat_int N = p->L / p->a;
     ltfat_int c = p->c;
     ltfat_int pp = p->a / c;
     ltfat_int q = p->M / c;
-    ltfat_int d = b / pp;
-
-    ltfat_int L = p->L;
-    ltfat_int W = p->W;
-    ltfat_int a = p->a;
+    ltfat_int d = p->L / p->M / pp;
     ltfat_int M = p->M;
-
     ltfat_int h_a = -p->h_a;
 
-    /* Scaling constant needed because of FFTWs normalization. */
-    const LTFAT_REAL scalconst = p->scalconst;
-
-    /* -------- Main loop ----------------------------------- */
-
     ltfat_int ld4c = M * N;
 
     /* Leading dimensions of cf */
-    ltfat_int ld3b = q * q * W;
+    ltfat_int ld3b = q * q * p->W;
 
-    /* Leading dimensions of the 4dim array. */
-    ltfat_int ld2ff = pp * q * W;
-
-    for (ltfat_int r = 0; r < c; r++)
+    for (ltfat_int t = start; t < end; t++)
     {
-        LTFAT_COMPLEX* cfp = p->cf;
+        ltfat_int w = t / (q * q);
+        ltfat_int l = (t / q) % q;
+        ltfat_int u = t % q;
+
+        /* The loops are placed such that the cf pointer advances linearly
+         * through memory with t. */
+        LTFAT_COMPLEX* cfp = cf + t;
 
-        for (ltfat_int w = 0; w < W; w++)
+        for (ltfat_int s = 0; s < d; s++)
         {
-            /* Complete inverse fac of coefficients */
-            for (ltfat_int l = 0; l < q; l++)
-            {
-                for (ltfat_int u = 0; u < q; u++)
-                {
-                    for (ltfat_int s = 0; s < d; s++)
-                    {
-                        ltfat_int rem = r + l * c +
-                                        M * ltfat_positiverem(u + s * q - l * h_a, N)
-                                        + w * ld4c;
-                        p->cbuf[s] = p->cwork[rem];
-                    }
-
-                    /* Do inverse fft of length d */
-                    LTFAT_NAME_REAL(fft_execute)(p->p_after);
-
-                    for (ltfat_int s = 0; s < d; s++)
-                    {
-                        cfp[s * ld3b] =  p->cbuf[s];
-                    }
-                    /* Advance the cf pointer. This is only done in this
-                    * one place, because the loops are placed such that
-                    * this pointer will advance linearly through
-                    * memory. Reordering the loops will break this. */
-                    cfp++;
-                }
-            }
+            ltfat_int rem = r + l * c +
+                            M * ltfat_positiverem(u + s * q - l * h_a, N)
+                            + w * ld4c;
+            sc->cbuf[s] = p->cwork[rem];
         }
 
+        /* Do inverse fft of length d */
+        LTFAT_NAME_REAL(fft_execute_ws)(sc->p_after, sc->cbuf, sc->cbuf,
+                                        sc->fftwork);
 
+        for (ltfat_int s = 0; s < d; s++)
+        {
+            cfp[s * ld3b] =  sc->cbuf[s];
+        }
+    }
+}
 
-        /* -------- compute matrix multiplication ---------- */
+/* Matrix product of coset r for s in range start..end-1 */
+static void
+LTFAT_NAME(idgt_walnut_matmul)(LTFAT_NAME(idgt_long_plan)* p,
+                               LTFAT_NAME(idgt_long_scratch)* sc,
+                               ltfat_int r, const LTFAT_COMPLEX* cf,
+                               LTFAT_COMPLEX* ff, ltfat_int start, ltfat_int end)
+{
+    ltfat_int c = p->c;
+    ltfat_int pp = p->a / c;
+    ltfat_int q = p->M / c;
+    ltfat_int W = p->W;
 
+    for (ltfat_int s = start; s < end; s++)
+    {
+        const LTFAT_REAL* gbase = (const LTFAT_REAL*) (p->gf + (r + s * c) * pp * q);
 
-        /* Do the matmul  */
-        for (ltfat_int s = 0; s < d; s++)
+        if (pp > 1)
         {
-
-            const LTFAT_COMPLEX* gbase = p->gf + (r + s * c) * pp * q;
-            LTFAT_COMPLEX*       fbase = p->ff + s * pp * q * W;
-            const LTFAT_COMPLEX* cbase = (const LTFAT_COMPLEX*)p->cf + s * q * q * W;
-
-            for (ltfat_int nm = 0; nm < q * W; nm++)
-            {
-                for (ltfat_int km = 0; km < pp; km++)
-                {
-
-                    fbase[km + nm * pp] = 0.0;
-                    for (ltfat_int mm = 0; mm < q; mm++)
-                    {
-                        fbase[km + nm * pp] += gbase[km + mm * pp] * cbase[mm + nm * q];
-                    }
-                    /* Scale because of FFTWs normalization. */
-                    fbase[km + nm * pp] = fbase[km + nm * pp] * scalconst;
-                }
-            }
+            LTFAT_NAME_REAL(walnut_transpose)(gbase, pp, q, sc->gt);
+            gbase = sc->gt;
         }
 
+        /* Scale because of FFTWs normalization. */
+        LTFAT_NAME_REAL(walnut_invmatmul)(gbase,
+                                          (const LTFAT_REAL*) (cf + s * q * q * W),
+                                          pp, q, q * W, p->scalconst,
+                                          (LTFAT_REAL*) (ff + s * pp * q * W));
+    }
+}
 
+/* Inverse signal factorization of coset r, items (w,l,k) in range
+ * start..end-1 */
+static void
+LTFAT_NAME(idgt_walnut_ifac)(LTFAT_NAME(idgt_long_plan)* p,
+                             LTFAT_NAME(idgt_long_scratch)* sc,
+                             ltfat_int r, const LTFAT_COMPLEX* ff,
+                             ltfat_int start, ltfat_int end)
+{
+    ltfat_int L = p->L;
+    ltfat_int a = p->a;
+    ltfat_int M = p->M;
+    ltfat_int c = p->c;
+    ltfat_int pp = a / c;
+    ltfat_int q = M / c;
+    ltfat_int d = L / M / pp;
+    ltfat_int h_a = -p->h_a;
 
+    /* Leading dimensions of the 4dim array. */
+    ltfat_int ld2ff = pp * q * p->W;
 
-        /* ----------- compute inverse signal factorization ---------- */
+    for (ltfat_int t = start; t < end; t++)
+    {
+        ltfat_int w = t / (q * pp);
+        ltfat_int l = (t / pp) % q;
+        ltfat_int k = t % pp;
+        const LTFAT_COMPLEX* ffp = ff + t;
+        LTFAT_COMPLEX* fp  = p->f + r + w * L;
 
+        for (ltfat_int s = 0; s < d; s++)
+        {
+            sc->cbuf[s] = ffp[s * ld2ff];
+        }
 
-        LTFAT_COMPLEX* ffp = p->ff;
-        LTFAT_COMPLEX* fp  = p->f + r;
+        LTFAT_NAME_REAL(ifft_execute_ws)(sc->p_before, sc->cbuf, sc->cbuf,
+                                         sc->fftwork);
 
-        for (ltfat_int w = 0; w < W; w++)
+        for (ltfat_int s = 0; s < d; s++)
         {
-            for (ltfat_int l = 0; l < q; l++)
-            {
-                for (ltfat_int k = 0; k < pp; k++)
-                {
-                    for (ltfat_int s = 0; s < d; s++)
-                    {
-                        p->cbuf[s] = ffp[s * ld2ff];
-                    }
-
-                    LTFAT_NAME_REAL(ifft_execute)(p->p_before);
-
-                    for (ltfat_int s = 0; s < d; s++)
-                    {
-                        ltfat_int rem = ltfat_positiverem(k * M + s * pp * M -
-                                                          l * h_a * a, L);
-                        fp[rem] = p->cbuf[s];
-                    }
-
-                    /* Advance the ff pointer. This is only done in this
-                    * one place, because the loops are placed such that
-                    * this pointer will advance linearly through
-                    * memory. Reordering the loops will break this. */
-                    ffp++;
-                }
-            }
-            fp += L;
+            ltfat_int rem = ltfat_positiverem(k * M + s * pp * M -
+                                              l * h_a * a, L);
+            fp[rem] = sc->cbuf[s];
         }
-        fp -= L * W;
+    }
+}
 
-        /* ----- Main loop ends here ------------- */
+static void
+LTFAT_NAME(idgt_walnut_cosets)(void* userdata, ltfat_int start, ltfat_int end,
+                               int threadid)
+{
+    LTFAT_NAME(idgt_walnut_job)* job = (LTFAT_NAME(idgt_walnut_job)*) userdata;
+    LTFAT_NAME(idgt_long_plan)* p = job->p;
+    LTFAT_NAME(idgt_long_scratch)* sc = p->scratch + threadid;
+    ltfat_int q = p->M / p->c;
+    ltfat_int pp = p->a / p->c;
+    ltfat_int d = p->L / p->M / pp;
+
+    for (ltfat_int r = start; r < end; r++)
+    {
+        LTFAT_NAME(idgt_walnut_fac)(p, sc, r, sc->cf, 0, p->W * q * q);
+        LTFAT_NAME(idgt_walnut_matmul)(p, sc, r, sc->cf, sc->ff, 0, d);
+        LTFAT_NAME(idgt_walnut_ifac)(p, sc, r, sc->ff, 0, p->W * q * pp);
     }
+}
 
+static void
+LTFAT_NAME(idgt_walnut_fac_items)(void* userdata, ltfat_int start,
+                                  ltfat_int end, int threadid)
+{
+    LTFAT_NAME(idgt_walnut_job)* job = (LTFAT_NAME(idgt_walnut_job)*) userdata;
+    LTFAT_NAME(idgt_long_plan)* p = job->p;
 
+    LTFAT_NAME(idgt_walnut_fac)(p, p->scratch + threadid, job->r,
+                                p->scratch[0].cf, start, end);
+}
 
+static void
+LTFAT_NAME(idgt_walnut_matmul_items)(void* userdata, ltfat_int start,
+                                     ltfat_int end, int threadid)
+{
+    LTFAT_NAME(idgt_walnut_job)* job = (LTFAT_NAME(idgt_walnut_job)*) userdata;
+    LTFAT_NAME(idgt_long_plan)* p = job->p;
+
+    LTFAT_NAME(idgt_walnut_matmul)(p, p->scratch + threadid, job->r,
+                                   p->scratch[0].cf, p->scratch[0].ff, start, end);
+}
+
+static void
+LTFAT_NAME(idgt_walnut_ifac_items)(void* userdata, ltfat_int start,
+                                   ltfat_int end, int threadid)
+{
+    LTFAT_NAME(idgt_walnut_job)* job = (LTFAT_NAME(idgt_walnut_job)*) userdata;
+    LTFAT_NAME(idgt_long_plan)* p = job->p;
+
+    LTFAT_NAME(idgt_walnut_ifac)(p, p->scratch + threadid, job->r,
+                                 p->scratch[0].ff, start, end);
+}
+
+LTFAT_API void
+LTFAT_NAME(idgt_walnut_execute)(LTFAT_NAME(idgt_long_plan)* p)
+{
+    LTFAT_NAME(idgt_walnut_job) job;
+    ltfat_int c = p->c;
+    ltfat_int pp = p->a / c;
+    ltfat_int q = p->M / c;
+    ltfat_int d = p->L / p->M / pp;
+
+    job.p = p;
+    job.r = 0;
+
+    if (ltfat_walnut_parallel_cosets(c, p->nthreads))
+    {
+        ltfat_parallel_for(p->nthreads, c,
+                           &LTFAT_NAME(idgt_walnut_cosets), &job);
+    }
+    else
+    {
+        for (job.r = 0; job.r < c; job.r++)
+        {
+            ltfat_parallel_for(p->nthreads, p->W * q * q,
+                               &LTFAT_NAME(idgt_walnut_fac_items), &job);
+            ltfat_parallel_for(p->nthreads, d,
+                               &LTFAT_NAME(idgt_walnut_matmul_items), &job);
+            ltfat_parallel_for(p->nthreads, p->W * q * pp,
+                               &LTFAT_NAME(idgt_walnut_ifac_items), &job);
+        }
+    }
 }
 
 /* LTFAT_API void */
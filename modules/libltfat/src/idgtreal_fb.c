@@ -1,35 +1,38 @@
 #include "ltfat.h"
 #include "ltfat/types.h"
 #include "ltfat/macros.h"
+#include "dgt_fb_private.h"
+#include "threads_private.h"
+#include "workspace_private.h"
 
 #include "ltfat/thirdparty/fftw3.h"
 
+/* Buffers and FFT plan used by a single thread. fftwork is the FFT
+ * scratch, NULL for the one owned by the FFT plan. */
+typedef struct
+{
+    LTFAT_NAME(ifftreal_plan)* p_small;
+    LTFAT_COMPLEX* cbuf;
+    LTFAT_REAL*    crbuf;
+    LTFAT_REAL*    ff;
+    void*          fftwork;
+} LTFAT_NAME(idgtreal_fb_scratch);
+
 struct LTFAT_NAME(idgtreal_fb_plan)
 {
     ltfat_int a;
     ltfat_int M;
     ltfat_int gl;
     ltfat_phaseconvention ptype;
-    LTFAT_COMPLEX* cbuf;
-    LTFAT_REAL*    crbuf;
+    unsigned flags;
+    ltfat_int blocksize;
+    int nthreads;
+    LTFAT_NAME(idgtreal_fb_scratch)* scratch;
     LTFAT_REAL*    gw;
-    LTFAT_REAL*    ff;
-    LTFAT_NAME(ifftreal_plan)* p_small;
     int do_overwriteoutarray;
 };
 
 
-/* ------------------- IDGTREAL ---------------------- */
-
-#define THE_SUM_REAL { \
-    memcpy(cbuf,cin+n*M2+w*M2*N, M2*sizeof*cbuf); \
-    LTFAT_NAME(ifftreal_execute)(p->p_small); \
-    LTFAT_NAME_REAL(circshift)(crbuf,M,p->ptype==LTFAT_TIMEINV?glh:-n*a+glh,ff); \
-    LTFAT_NAME_REAL(periodize_array)(ff,M,gl,ff); \
-    for (ltfat_int ii=0; ii<gl; ii++) \
-        ff[ii] *= gw[ii]; \
-}
-
 LTFAT_API int
 LTFAT_NAME(idgtreal_fb)(const LTFAT_COMPLEX* cin, const LTFAT_REAL* g,
                         ltfat_int L, ltfat_int gl, ltfat_int W,
@@ -63,12 +66,63 @@ error:
     return status;
 }
 
+static void
+LTFAT_NAME(idgtreal_fb_scratch_free)(LTFAT_NAME(idgtreal_fb_scratch)* scratch,
+                                     int nthreads)
+{
+    for (int t = 0; t < nthreads; t++)
+    {
+        if (scratch[t].p_small) LTFAT_NAME(ifftreal_done)(&scratch[t].p_small);
+        LTFAT_SAFEFREEALL(scratch[t].cbuf, scratch[t].crbuf, scratch[t].ff);
+    }
+    ltfat_free(scratch);
+}
+
+static int
+LTFAT_NAME(idgtreal_fb_scratch_realloc)(LTFAT_NAME(idgtreal_fb_plan)* p,
+                                        ltfat_int K, int nthreads)
+{
+    LTFAT_NAME(idgtreal_fb_scratch)* scratch = NULL;
+    unsigned flags = p->flags;
+    /* This is a floor operation. */
+    ltfat_int M2 = p->M / 2 + 1;
+    int status = LTFATERR_SUCCESS;
+
+    if (K == p->blocksize && nthreads == p->nthreads)
+        return status;
+
+    /* Frames are already processed in parallel */
+    if (nthreads > 1)
+        flags &= ~LTFAT_FFT_NTHREADS(0xFF);
+
+    CHECKMEM( scratch = LTFAT_NEWARRAY(LTFAT_NAME(idgtreal_fb_scratch), nthreads));
+
+    for (int t = 0; t < nthreads; t++)
+    {
+        CHECKMEM( scratch[t].ff    = LTFAT_NAME_REAL(malloc)(ltfat_imax(p->gl, p->M)));
+        CHECKMEM( scratch[t].cbuf  = LTFAT_NAME_COMPLEX(malloc)(M2 * K));
+        CHECKMEM( scratch[t].crbuf = LTFAT_NAME_REAL(malloc)(p->M * K));
+        CHECKSTATUS(
+            LTFAT_NAME(ifftreal_init)(p->M, K, scratch[t].cbuf, scratch[t].crbuf,
+                                      flags, &scratch[t].p_small));
+    }
+
+    if (p->scratch)
+        LTFAT_NAME(idgtreal_fb_scratch_free)(p->scratch, p->nthreads);
+    p->scratch = scratch;
+    p->blocksize = K;
+    p->nthreads = nthreads;
+    return status;
+error:
+    if (scratch) LTFAT_NAME(idgtreal_fb_scratch_free)(scratch, nthreads);
+    return status;
+}
+
 LTFAT_API int
 LTFAT_NAME(idgtreal_fb_init)(const LTFAT_REAL* g, ltfat_int gl,
                              ltfat_int a, ltfat_int M, const ltfat_phaseconvention ptype,
                              unsigned flags, LTFAT_NAME(idgtreal_fb_plan)** pout)
 {
-    ltfat_int M2;
     LTFAT_NAME(idgtreal_fb_plan)* p = NULL;
     int status = LTFATERR_SUCCESS;
     CHECKNULL(g); CHECKNULL(pout);
@@ -81,18 +135,12 @@ LTFAT_NAME(idgtreal_fb_init)(const LTFAT_REAL* g, ltfat_int gl,
     CHECKMEM(p = LTFAT_NEW(LTFAT_NAME(idgtreal_fb_plan)) );
 
     p->ptype = ptype; p->a = a; p->M = M; p->gl = gl;
+    p->flags = flags;
     p->do_overwriteoutarray = 1;
 
-    /* This is a floor operation. */
-    M2 = M / 2 + 1;
-
-    CHECKMEM( p->cbuf  = LTFAT_NAME_COMPLEX(malloc)(M2));
-    CHECKMEM( p->crbuf = LTFAT_NAME_REAL(malloc)(M));
     CHECKMEM( p->gw    = LTFAT_NAME_REAL(malloc)(gl));
-    CHECKMEM( p->ff    = LTFAT_NAME_REAL(malloc)(gl > M ? gl : M));
 
-    CHECKSTATUS(
-        LTFAT_NAME(ifftreal_init)(M, 1, p->cbuf, p->crbuf, flags, &p->p_small));
+    CHECKSTATUS( LTFAT_NAME(idgtreal_fb_scratch_realloc)(p, 1, 1));
 
     LTFAT_NAME_REAL(fftshift)(g, gl, p->gw);
 
@@ -103,6 +151,36 @@ error:
     return status;
 }
 
+LTFAT_API int
+LTFAT_NAME(idgtreal_fb_set_blocksize)(LTFAT_NAME(idgtreal_fb_plan)* p,
+                                      ltfat_int blocksize)
+{
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(p);
+    CHECK(LTFATERR_BADARG, blocksize >= 0,
+          "blocksize (passed %td) must be nonnegative.", blocksize);
+
+    return LTFAT_NAME(idgtreal_fb_scratch_realloc)(
+               p, ltfat_dgt_fb_blocksize(p->M, blocksize), p->nthreads);
+error:
+    return status;
+}
+
+LTFAT_API int
+LTFAT_NAME(idgtreal_fb_set_numthreads)(LTFAT_NAME(idgtreal_fb_plan)* p,
+                                       int nthreads)
+{
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(p);
+    CHECK(LTFATERR_NOTINRANGE, nthreads >= 0 && nthreads <= LTFAT_MAXTHREADS,
+          "nthreads (passed %d) must be in range 0-%d.", nthreads, LTFAT_MAXTHREADS);
+
+    return LTFAT_NAME(idgtreal_fb_scratch_realloc)(
+               p, p->blocksize, nthreads ? nthreads : ltfat_get_num_threads());
+error:
+    return status;
+}
+
 LTFAT_API int
 LTFAT_NAME(idgtreal_fb_done)(LTFAT_NAME(idgtreal_fb_plan)** p)
 {
@@ -110,105 +188,167 @@ LTFAT_NAME(idgtreal_fb_done)(LTFAT_NAME(idgtreal_fb_plan)** p)
     int status = LTFATERR_SUCCESS;
     CHECKNULL(p); CHECKNULL(*p);
     pp = *p;
-    LTFAT_SAFEFREEALL(pp->cbuf, pp->crbuf, pp->ff, pp->gw);
-    if (pp->p_small) LTFAT_NAME(ifftreal_done)(&pp->p_small);
+    if (pp->scratch)
+        LTFAT_NAME(idgtreal_fb_scratch_free)(pp->scratch, pp->nthreads);
+    ltfat_safefree(pp->gw);
     ltfat_free(pp);
     pp = NULL;
 error:
     return status;
 }
 
+/* Adds the windowed frame ff to a single channel at position sp,
+ * wrapping around the end of the signal.
+ */
+static void
+LTFAT_NAME(idgtreal_fb_overlapadd)(const LTFAT_REAL* ff, ltfat_int gl,
+                                   ltfat_int sp, ltfat_int L, LTFAT_REAL* fchan)
+{
+    ltfat_int glfirst = ltfat_imin(gl, L - sp);
+
+    for (ltfat_int ii = 0; ii < glfirst; ii++)
+        fchan[sp + ii] += ff[ii];
+
+    for (ltfat_int ii = glfirst; ii < gl; ii++)
+        fchan[ii - glfirst] += ff[ii];
+}
+
+typedef struct
+{
+    const LTFAT_NAME(idgtreal_fb_plan)* p;
+    const LTFAT_COMPLEX* cin;
+    ltfat_int L;
+    ltfat_int N;
+    ltfat_int ntiles;
+    ltfat_int pass;
+    LTFAT_REAL* f;
+} LTFAT_NAME(idgtreal_fb_job);
+
+/* See idgt_fb_execute_tiles */
+static void
+LTFAT_NAME(idgtreal_fb_execute_tiles)(void* userdata, ltfat_int start,
+                                      ltfat_int end, int threadid)
+{
+    LTFAT_NAME(idgtreal_fb_job)* job = (LTFAT_NAME(idgtreal_fb_job)*) userdata;
+    const LTFAT_NAME(idgtreal_fb_plan)* p = job->p;
+    LTFAT_NAME(idgtreal_fb_scratch)* s = &p->scratch[threadid];
+    ltfat_int L = job->L, N = job->N, a = p->a, M = p->M, K = p->blocksize;
+    ltfat_int gl = p->gl, glh = p->gl / 2;
+    /* This is a floor operation. */
+    ltfat_int M2 = M / 2 + 1;
+    ltfat_int tilesperpass = job->ntiles > 1 ? job->ntiles / 2 : 1;
+
+    for (ltfat_int t = start; t < end; t++)
+    {
+        ltfat_int w = t / tilesperpass;
+        ltfat_int tile = job->ntiles > 1 ? 2 * (t % tilesperpass) + job->pass : 0;
+        ltfat_int nfirst = tile * N / job->ntiles;
+        ltfat_int nlast = (tile + 1) * N / job->ntiles;
+        LTFAT_REAL* fchan = job->f + w * L;
+        const LTFAT_COMPLEX* cchan = job->cin + w * M2 * N;
+
+        for (ltfat_int nstart = nfirst; nstart < nlast; nstart += K)
+        {
+            ltfat_int nK = ltfat_imin(K, nlast - nstart);
+
+            memcpy(s->cbuf, cchan + nstart * M2, nK * M2 * sizeof * s->cbuf);
+            LTFAT_NAME(ifftreal_execute_ws)(s->p_small, s->cbuf, s->crbuf,
+                                            s->fftwork);
+
+            for (ltfat_int k = 0; k < nK; k++)
+            {
+                ltfat_int n = nstart + k;
+
+                LTFAT_NAME_REAL(circshift)(
+                    s->crbuf + k * M, M,
+                    p->ptype == LTFAT_TIMEINV ? glh : -n * a + glh, s->ff);
+                LTFAT_NAME_REAL(periodize_array)(s->ff, M, gl, s->ff);
+                for (ltfat_int ii = 0; ii < gl; ii++)
+                    s->ff[ii] *= p->gw[ii];
+
+                LTFAT_NAME(idgtreal_fb_overlapadd)(
+                    s->ff, gl, ltfat_positiverem(n * a - glh, L), L, fchan);
+            }
+        }
+    }
+}
+
 LTFAT_API int
 LTFAT_NAME(idgtreal_fb_execute)(LTFAT_NAME(idgtreal_fb_plan)* p,
                                 const LTFAT_COMPLEX* cin,
                                 ltfat_int L, ltfat_int W, LTFAT_REAL* f)
 {
-    ltfat_int M2, M, a, gl, N, ep, sp, glh, glh_d_a;
-    LTFAT_COMPLEX* cbuf;
-    LTFAT_REAL* crbuf, *gw, *ff;
+    LTFAT_NAME(idgtreal_fb_job) job;
     int status = LTFATERR_SUCCESS;
     CHECKNULL(p); CHECKNULL(cin); CHECKNULL(f);
     CHECK(LTFATERR_BADTRALEN, L >= p->gl && !(L % p->a) ,
           "L (passed %td) must be greater or equal to gl and divisible by a (passed %td).", L, p->a);
     CHECK(LTFATERR_NOTPOSARG, W > 0, "W (passed %td) must be positive.", W);
 
-    M = p->M;
-    a = p->a;
-    gl = p->gl;
-    N = L / a;
-
-    /* This is a floor operation. */
-    M2 = M / 2 + 1;
-
-    /* This is a floor operation. */
-    glh = gl / 2;
-
-    /* This is a ceil operation. */
-    glh_d_a = (ltfat_int)ceil((glh * 1.0) / (a));
-
-    cbuf  = p->cbuf;
-    crbuf = p->crbuf;
-    gw  = p->gw;
-    ff  = p->ff;
+    job.p = p; job.cin = cin; job.L = L; job.f = f;
+    job.N = L / p->a;
+    job.ntiles = ltfat_dgt_fb_ntiles(job.N, p->a, p->gl, p->nthreads);
 
     if(p->do_overwriteoutarray)
         memset(f, 0, L * W * sizeof * f);
 
-    for (ltfat_int w = 0; w < W; w++)
-    {
-        LTFAT_REAL* fw = f + w * L;
+    /* Tiles of the same pass do not overlap */
+    for (job.pass = 0; job.pass < (job.ntiles > 1 ? 2 : 1); job.pass++)
+        ltfat_parallel_for(p->nthreads, W * (job.ntiles > 1 ? job.ntiles / 2 : 1),
+                           LTFAT_NAME(idgtreal_fb_execute_tiles), &job);
 
-        /* ----- Handle the first boundary using periodic boundary conditions. --- */
-        for (ltfat_int n = 0; n < glh_d_a; n++)
-        {
-            THE_SUM_REAL;
-
-            sp = ltfat_positiverem(n * a - glh, L);
-            ep = ltfat_positiverem(n * a - glh + gl - 1, L);
-
-            /* % Add the ff vector to f at position sp. */
-            for (ltfat_int ii = 0; ii < L - sp; ii++)
-                fw[sp + ii] += ff[ii];
-
-            for (ltfat_int ii = 0; ii < ep + 1; ii++)
-                fw[ii] += ff[L - sp + ii];
-        }
-
-
-        /* ----- Handle the middle case. --------------------- */
-        for (ltfat_int n = glh_d_a; n < (L - (gl + 1) / 2) / a + 1; n++)
-        {
-            THE_SUM_REAL;
-
-            sp = ltfat_positiverem(n * a - glh, L);
-            ep = ltfat_positiverem(n * a - glh + gl - 1, L);
+error:
+    return status;
+}
 
-            /* Add the ff vector to f at position sp. */
-            for (ltfat_int ii = 0; ii < ep - sp + 1; ii++)
-                fw[ii + sp] += ff[ii];
-        }
+/* Takes the buffers of a single-threaded scratch from the workspace at
+ * base, or only counts their size if base is NULL */
+static size_t
+LTFAT_NAME(idgtreal_fb_ws_carve)(const LTFAT_NAME(idgtreal_fb_plan)* p, char* base,
+                                 LTFAT_NAME(idgtreal_fb_scratch)* sc)
+{
+    ltfat_int M2 = p->M / 2 + 1;
+    size_t off = 0;
+
+    *sc = p->scratch[0];
+    sc->ff = (LTFAT_REAL*) ltfat_ws_take(base, &off,
+                                         ltfat_imax(p->gl, p->M) * sizeof(LTFAT_REAL));
+    sc->cbuf = (LTFAT_COMPLEX*) ltfat_ws_take(base, &off,
+                                              M2 * p->blocksize * sizeof(LTFAT_COMPLEX));
+    sc->crbuf = (LTFAT_REAL*) ltfat_ws_take(base, &off,
+                                            p->M * p->blocksize * sizeof(LTFAT_REAL));
+    sc->fftwork = ltfat_ws_take(base, &off,
+                                LTFAT_NAME(ifftreal_get_workspace_size)(sc->p_small));
+    return off;
+}
 
-        /* Handle the last boundary using periodic boundary conditions. */
-        for (ltfat_int n = (L - (gl + 1) / 2) / a + 1; n < N; n++)
-        {
-            THE_SUM_REAL;
+LTFAT_API size_t
+LTFAT_NAME(idgtreal_fb_get_workspace_size)(const LTFAT_NAME(idgtreal_fb_plan)* p)
+{
+    LTFAT_NAME(idgtreal_fb_scratch) sc;
+    if (!p) return 0;
+    return ltfat_ws_size(LTFAT_NAME(idgtreal_fb_ws_carve)(p, NULL, &sc));
+}
 
-            sp = ltfat_positiverem(n * a - glh, L);
-            ep = ltfat_positiverem(n * a - glh + gl - 1, L);
+LTFAT_API int
+LTFAT_NAME(idgtreal_fb_execute_ws)(const LTFAT_NAME(idgtreal_fb_plan)* p,
+                                   const LTFAT_COMPLEX* cin,
+                                   ltfat_int L, ltfat_int W, LTFAT_REAL* f,
+                                   void* ws)
+{
+    LTFAT_NAME(idgtreal_fb_plan) p2;
+    LTFAT_NAME(idgtreal_fb_scratch) sc;
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(p); CHECKNULL(ws);
 
-            /* Add the ff vector to f at position sp. */
-            for (ltfat_int ii = 0; ii < L - sp; ii++)
-                fw[sp + ii] += ff[ii];
+    LTFAT_NAME(idgtreal_fb_ws_carve)(p, ltfat_ws_begin(ws), &sc);
 
-            for (ltfat_int ii = 0; ii < ep + 1; ii++)
-                fw[ii] += ff[L - sp + ii];
-        }
-    }
+    // Shallow copy running single-threaded on the workspace
+    p2 = *p;
+    p2.nthreads = 1;
+    p2.scratch = &sc;
 
+    return LTFAT_NAME(idgtreal_fb_execute)(&p2, cin, L, W, f);
 error:
     return status;
 }
-
-
-
-#undef THE_SUM_REAL
@@ -3,6 +3,24 @@
 #include "ltfat/macros.h"
 
 #include "ltfat/thirdparty/fftw3.h"
+#include "threads_private.h"
+#include "walnut_private.h"
+#include "wfaccache_private.h"
+#include "workspace_private.h"
+
+/* Buffers and FFT plans of the factorization used by a single thread.
+ * ff and cf are only allocated for the threads processing whole cosets.
+ * fftwork is the FFT scratch, NULL for the one owned by the FFT plans. */
+typedef struct
+{
+    LTFAT_NAME(ifftreal_plan)* p_before;
+    LTFAT_NAME(fftreal_plan)* p_after;
+    LTFAT_COMPLEX* cbuf;
+    LTFAT_REAL* sbuf;
+    LTFAT_REAL* gt;
+    LTFAT_COMPLEX* ff, *cf;
+    void* fftwork;
+} LTFAT_NAME(idgtreal_long_scratch);
 
 struct LTFAT_NAME(idgtreal_long_plan)
 {
@@ -16,19 +34,23 @@ struct LTFAT_NAME(idgtreal_long_plan)
     LTFAT_REAL scalconst;
     LTFAT_REAL* f;
     LTFAT_COMPLEX* cin;
-    LTFAT_COMPLEX* gf;
-    LTFAT_COMPLEX* ff;
-    LTFAT_COMPLEX* cf;
-    LTFAT_COMPLEX* cbuf;
+    const LTFAT_COMPLEX* gf;
     LTFAT_REAL* cwork;
     int freecwork;
-    LTFAT_REAL* sbuf;
+    unsigned flags;
+    int nthreads;
+    LTFAT_NAME(idgtreal_long_scratch)* scratch;
     LTFAT_NAME(ifftreal_plan)* p_veryend;
-    LTFAT_NAME(ifftreal_plan)* p_before;
-    LTFAT_NAME(fftreal_plan)* p_after;
     int do_overwriteoutarray;
 };
 
+/* Job shared by the threads of a single idgtreal_walnut_execute call */
+typedef struct
+{
+    LTFAT_NAME(idgtreal_long_plan)* p;
+    ltfat_int r;
+} LTFAT_NAME(idgtreal_walnut_job);
+
 
 LTFAT_API int
 LTFAT_NAME(idgtreal_long)(const LTFAT_COMPLEX* cin, const LTFAT_REAL* g,
@@ -53,6 +75,78 @@ error:
     return status;
 }
 
+static void
+LTFAT_NAME(idgtreal_long_scratch_free)(LTFAT_NAME(idgtreal_long_scratch)* scratch,
+                                       int nthreads)
+{
+    for (int t = 0; t < nthreads; t++)
+    {
+        if (scratch[t].p_before) LTFAT_NAME(ifftreal_done)(&scratch[t].p_before);
+        if (scratch[t].p_after) LTFAT_NAME(fftreal_done)(&scratch[t].p_after);
+        LTFAT_SAFEFREEALL(scratch[t].cbuf, scratch[t].sbuf, scratch[t].gt,
+                          scratch[t].ff, scratch[t].cf);
+    }
+    ltfat_free(scratch);
+}
+
+/* Replaces the per-thread scratch such that it is prepared for nthreads
+ * threads. */
+static int
+LTFAT_NAME(idgtreal_long_scratch_realloc)(LTFAT_NAME(idgtreal_long_plan)* plan,
+        int nthreads)
+{
+    LTFAT_NAME(idgtreal_long_scratch)* scratch = NULL;
+    ltfat_int p = plan->a / plan->c;
+    ltfat_int q = plan->M / plan->c;
+    ltfat_int d = plan->L / plan->M / p;
+    ltfat_int d2 = d / 2 + 1;
+    unsigned flags = plan->flags;
+    int nbufs;
+    int status = LTFATERR_SUCCESS;
+
+    if (nthreads == plan->nthreads)
+        return status;
+
+    nbufs = ltfat_walnut_parallel_cosets(plan->c, nthreads) ? nthreads : 1;
+
+    /* The short FFTs are already done in parallel */
+    if (nthreads > 1)
+        flags &= ~LTFAT_FFT_NTHREADS(0xFF);
+
+    CHECKMEM( scratch = LTFAT_NEWARRAY(LTFAT_NAME(idgtreal_long_scratch),
+                                       nthreads));
+
+    for (int t = 0; t < nthreads; t++)
+    {
+        CHECKMEM( scratch[t].cbuf = LTFAT_NAME_COMPLEX(malloc)(d2));
+        CHECKMEM( scratch[t].sbuf = LTFAT_NAME_REAL(malloc)(d));
+        CHECKMEM( scratch[t].gt   = LTFAT_NAME_REAL(malloc)(2 * p * q));
+
+        if (t < nbufs)
+        {
+            CHECKMEM( scratch[t].ff = LTFAT_NAME_COMPLEX(malloc)(d2 * p * q * plan->W));
+            CHECKMEM( scratch[t].cf = LTFAT_NAME_COMPLEX(malloc)(d2 * q * q * plan->W));
+        }
+
+        CHECKSTATUS(
+            LTFAT_NAME(ifftreal_init)(d, 1, scratch[t].cbuf, scratch[t].sbuf, flags,
+                                      &scratch[t].p_before));
+
+        CHECKSTATUS(
+            LTFAT_NAME(fftreal_init)(d, 1, scratch[t].sbuf, scratch[t].cbuf, flags,
+                                     &scratch[t].p_after));
+    }
+
+    if (plan->scratch)
+        LTFAT_NAME(idgtreal_long_scratch_free)(plan->scratch, plan->nthreads);
+    plan->scratch = scratch;
+    plan->nthreads = nthreads;
+    return status;
+error:
+    if (scratch) LTFAT_NAME(idgtreal_long_scratch_free)(scratch, nthreads);
+    return status;
+}
+
 LTFAT_API int
 LTFAT_NAME(idgtreal_long_set_overwriteoutarray)(
     LTFAT_NAME(idgtreal_long_plan)* p, int do_overwriteoutarray)
@@ -72,7 +166,7 @@ LTFAT_NAME(idgtreal_long_init)( const LTFAT_REAL* g,
                                 const ltfat_phaseconvention ptype, unsigned flags,
                                 LTFAT_NAME(idgtreal_long_plan)** pout)
 {
-    ltfat_int minL, h_m, b, N, p, q, d, d2, size;
+    ltfat_int minL, h_m, b, N, p, d;
     // Downcast to int
     LTFAT_NAME(idgtreal_long_plan)* plan = NULL;
     int status = LTFATERR_SUCCESS;
@@ -97,24 +191,15 @@ LTFAT_NAME(idgtreal_long_init)( const LTFAT_REAL* g,
     /*  ----------- calculation of parameters and plans -------- */
 
     plan->a = a; plan->L = L; plan->M = M; plan->W = W; plan->ptype = ptype;
+    plan->flags = flags;
     plan->do_overwriteoutarray = 1;
     b = L / M;
     N = L / a;
 
     plan->c = ltfat_gcd(a, M, &plan->h_a, &h_m);
     p = a / plan->c;
-    q = M / plan->c;
     d = b / p;
 
-    /* This is a floor operation. */
-    d2 = d / 2 + 1;
-
-    size = wfacreal_size(L, a, M);
-    CHECKMEM( plan->gf    = LTFAT_NAME_COMPLEX(malloc)(size));
-    CHECKMEM( plan->ff    = LTFAT_NAME_COMPLEX(malloc)(d2 * p * q * W));
-    CHECKMEM( plan->cf    = LTFAT_NAME_COMPLEX(malloc)(d2 * q * q * W));
-    CHECKMEM( plan->cbuf  = LTFAT_NAME_COMPLEX(malloc)(d2));
-    CHECKMEM( plan->sbuf  = LTFAT_NAME_REAL(malloc)(d));
     plan->cin = cin;
     plan->f = f;
 
@@ -136,17 +221,13 @@ LTFAT_NAME(idgtreal_long_init)( const LTFAT_REAL* g,
                                       flags | FFTW_PRESERVE_INPUT, &plan->p_veryend));
     }
 
-    LTFAT_NAME(wfacreal)(g, L, 1, a, M, plan->gf);
+    CHECKSTATUS(
+        LTFAT_NAME(wfacreal_shared)(g, L, a, M, &plan->gf));
 
     /* Scaling constant needed because of FFTWs normalization. */
     plan->scalconst = (LTFAT_REAL) ( 1.0 / ((double)d * sqrt((double)M)));
 
-    CHECKSTATUS(
-        LTFAT_NAME(ifftreal_init)(d, 1, plan->cbuf, plan->sbuf, flags,
-                                  &plan->p_before));
-
-    CHECKSTATUS(
-        LTFAT_NAME(fftreal_init)(d, 1, plan->sbuf, plan->cbuf, flags, &plan->p_after));
+    CHECKSTATUS( LTFAT_NAME(idgtreal_long_scratch_realloc)(plan, 1));
 
     *pout = plan;
     return status;
@@ -155,6 +236,21 @@ error:
     return status;
 }
 
+LTFAT_API int
+LTFAT_NAME(idgtreal_long_set_numthreads)(LTFAT_NAME(idgtreal_long_plan)* p,
+        int nthreads)
+{
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(p);
+    CHECK(LTFATERR_NOTINRANGE, nthreads >= 0 && nthreads <= LTFAT_MAXTHREADS,
+          "nthreads (passed %d) must be in range 0-%d.", nthreads, LTFAT_MAXTHREADS);
+
+    return LTFAT_NAME(idgtreal_long_scratch_realloc)(
+               p, nthreads ? nthreads : ltfat_get_num_threads());
+error:
+    return status;
+}
+
 LTFAT_API int
 LTFAT_NAME(idgtreal_long_done)(LTFAT_NAME(idgtreal_long_plan)** plan)
 {
@@ -163,10 +259,10 @@ LTFAT_NAME(idgtreal_long_done)(LTFAT_NAME(idgtreal_long_plan)** plan)
     CHECKNULL(plan); CHECKNULL(*plan);
     p = *plan;
 
-    if (p->p_before)  LTFAT_NAME(ifftreal_done)(&p->p_before);
-    if (p->p_after)   LTFAT_NAME(fftreal_done)(&p->p_after);
     if (p->p_veryend) LTFAT_NAME(ifftreal_done)(&p->p_veryend);
-    LTFAT_SAFEFREEALL(p->gf, p->ff, p->cf, p->cbuf, p->sbuf);
+    if (p->scratch)
+        LTFAT_NAME(idgtreal_long_scratch_free)(p->scratch, p->nthreads);
+    ltfat_wfac_cache_release(p->gf);
     if ( p->freecwork) ltfat_free(p->cwork);
     ltfat_free(p);
     p = NULL;
@@ -215,130 +311,289 @@ error:
     return status;
 }
 
-LTFAT_API void
-LTFAT_NAME(idgtreal_walnut_execute)(LTFAT_NAME(idgtreal_long_plan)* p)
+/* Takes the buffers of a single-threaded scratch and the plan's cwork from
+ * the workspace at base, or only counts their size if base is NULL */
+static size_t
+LTFAT_NAME(idgtreal_long_ws_carve)(const LTFAT_NAME(idgtreal_long_plan)* p,
+                                   char* base,
+                                   LTFAT_NAME(idgtreal_long_scratch)* sc,
+                                   LTFAT_REAL** cwork)
 {
-    ltfat_int b = p->L / p->M;
-    ltfat_int N = p->L / p->a;
+    const LTFAT_NAME(idgtreal_long_scratch)* sc0 = p->scratch;
+    ltfat_int pp = p->a / p->c;
+    ltfat_int q = p->M / p->c;
+    ltfat_int d = p->L / p->M / pp;
+    ltfat_int d2 = d / 2 + 1;
+    size_t fftws, off = 0;
+
+    fftws = LTFAT_NAME(ifftreal_get_workspace_size)(sc0->p_before);
+    fftws = ltfat_ws_max(fftws, LTFAT_NAME(fftreal_get_workspace_size)(sc0->p_after));
+    fftws = ltfat_ws_max(fftws, LTFAT_NAME(ifftreal_get_workspace_size)(p->p_veryend));
+
+    *cwork = (LTFAT_REAL*) ltfat_ws_take(base, &off,
+                                         p->M * (p->L / p->a) * p->W * sizeof(LTFAT_REAL));
+    *sc = *sc0;
+    sc->cbuf = (LTFAT_COMPLEX*) ltfat_ws_take(base, &off, d2 * sizeof(LTFAT_COMPLEX));
+    sc->sbuf = (LTFAT_REAL*) ltfat_ws_take(base, &off, d * sizeof(LTFAT_REAL));
+    sc->gt = (LTFAT_REAL*) ltfat_ws_take(base, &off, 2 * pp * q * sizeof(LTFAT_REAL));
+    sc->ff = (LTFAT_COMPLEX*) ltfat_ws_take(base, &off,
+                                            d2 * pp * q * p->W * sizeof(LTFAT_COMPLEX));
+    sc->cf = (LTFAT_COMPLEX*) ltfat_ws_take(base, &off,
+                                            d2 * q * q * p->W * sizeof(LTFAT_COMPLEX));
+    sc->fftwork = ltfat_ws_take(base, &off, fftws);
+    return off;
+}
+
+LTFAT_API size_t
+LTFAT_NAME(idgtreal_long_get_workspace_size)(
+    const LTFAT_NAME(idgtreal_long_plan)* p)
+{
+    LTFAT_NAME(idgtreal_long_scratch) sc;
+    LTFAT_REAL* cwork;
+    if (!p) return 0;
+    return ltfat_ws_size(LTFAT_NAME(idgtreal_long_ws_carve)(p, NULL, &sc, &cwork));
+}
+
+LTFAT_API int
+LTFAT_NAME(idgtreal_long_execute_ws)(const LTFAT_NAME(idgtreal_long_plan)* p,
+                                     const LTFAT_COMPLEX c[], LTFAT_REAL f[],
+                                     void* ws)
+{
+    LTFAT_NAME(idgtreal_long_plan) p2;
+    LTFAT_NAME(idgtreal_long_scratch) sc;
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(p); CHECKNULL(c); CHECKNULL(f); CHECKNULL(ws);
+    CHECK(LTFATERR_NOTSUPPORTED, p->freecwork,
+          "Plans created with FFTW_DESTROY_INPUT work in-place on cin and cannot be shared.");
+
+    // Shallow copy running single-threaded on the workspace
+    p2 = *p;
+    LTFAT_NAME(idgtreal_long_ws_carve)(p, ltfat_ws_begin(ws), &sc, &p2.cwork);
+    p2.f = f;
+    p2.nthreads = 1;
+    p2.scratch = &sc;
+
+    LTFAT_NAME(ifftreal_execute_ws)(p->p_veryend, c, p2.cwork, sc.fftwork);
+
+    if (p->ptype == LTFAT_TIMEINV)
+        LTFAT_NAME_REAL(dgtphaseunlockhelper)(p2.cwork, p->L, p->W, p->a, p->M, p->M,
+                                              p2.cwork);
+
+    LTFAT_NAME(idgtreal_walnut_execute)(&p2);
+error:
+    return status;
+}
 
+/* Coefficient factorization of coset r, items (w,l,u) in range
+ * start..end-1 */
+static void
+LTFAT_NAME(idgtreal_walnut_fac)(LTFAT_NAME(idgtreal_long_plan)* p,
+                                LTFAT_NAME(idgtreal_long_scratch)* sc,
+                                ltfat_int r, LTFAT_COMPLEX* cf,
+                                ltfat_int start, ltfat_int end)
+{
+    ltfat_int N = p->L / p->a;
     ltfat_int c = p->c;
     ltfat_int pp = p->a / c;
     ltfat_int q = p->M / c;
-    ltfat_int d = b / pp;
-
-    ltfat_int L = p->L;
-    ltfat_int W = p->W;
-    ltfat_int a = p->a;
+    ltfat_int d = p->L / p->M / pp;
     ltfat_int M = p->M;
+    ltfat_int h_a = -p->h_a;
 
     /* This is a floor operation. */
     ltfat_int d2 = d / 2 + 1;
 
-    ltfat_int h_a = -p->h_a;
+    ltfat_int ld4c = M * N;
 
-    /* Scaling constant needed because of FFTWs normalization. */
-    const LTFAT_REAL scalconst = p->scalconst;
+    /* Leading dimensions of cf */
+    ltfat_int ld3b = q * q * p->W;
 
-    ltfat_int ld4c = p->M * N;
+    for (ltfat_int t = start; t < end; t++)
+    {
+        ltfat_int w = t / (q * q);
+        ltfat_int l = (t / q) % q;
+        ltfat_int u = t % q;
 
-    /* Leading dimensions of cf */
-    ltfat_int ld3b = q * q * W;
+        /* The loops are placed such that the cf pointer advances linearly
+         * through memory with t. */
+        LTFAT_COMPLEX* cfp = cf + t;
 
-    /* Leading dimensions of the 4dim array. */
-    ltfat_int ld2ff = pp * q * W;
+        for (ltfat_int s = 0; s < d; s++)
+        {
+            sc->sbuf[s] = p->cwork[r + l * c +
+                                   ltfat_positiverem(u + s * q - l * h_a, N) *
+                                   M + w * ld4c];
+        }
 
-    /* -------- Main loop ----------------------------------- */
-    for (ltfat_int r = 0; r < c; r++)
-    {
-        /* -------- compute coefficient factorization ----------- */
+        /* Do inverse fft of length d */
+        LTFAT_NAME(fftreal_execute_ws)(sc->p_after, sc->sbuf, sc->cbuf,
+                                       sc->fftwork);
+
+        for (ltfat_int s = 0; s < d2; s++)
+        {
+            cfp[s * ld3b] = sc->cbuf[s];
+        }
+    }
+}
+
+/* Matrix product of coset r for s in range start..end-1 */
+static void
+LTFAT_NAME(idgtreal_walnut_matmul)(LTFAT_NAME(idgtreal_long_plan)* p,
+                                   LTFAT_NAME(idgtreal_long_scratch)* sc,
+                                   ltfat_int r, const LTFAT_COMPLEX* cf,
+                                   LTFAT_COMPLEX* ff, ltfat_int start,
+                                   ltfat_int end)
+{
+    ltfat_int c = p->c;
+    ltfat_int pp = p->a / c;
+    ltfat_int q = p->M / c;
+    ltfat_int W = p->W;
 
-        LTFAT_COMPLEX* cfp = p->cf;
+    for (ltfat_int s = start; s < end; s++)
+    {
+        const LTFAT_REAL* gbase = (const LTFAT_REAL*) (p->gf + (r + s * c) * pp * q);
 
-        for (ltfat_int w = 0; w < W; w++)
+        if (pp > 1)
         {
-            /* Complete inverse fac of coefficients */
-            for (ltfat_int l = 0; l < q; l++)
-            {
-                for (ltfat_int u = 0; u < q; u++)
-                {
-                    for (ltfat_int s = 0; s < d; s++)
-                    {
-                        p->sbuf[s] = p->cwork[r + l * c +
-                                              ltfat_positiverem(u + s * q - l * h_a, N) *
-                                              M + w * ld4c];
-                    }
-
-                    /* Do inverse fft of length d */
-                    LTFAT_NAME(fftreal_execute)(p->p_after);
-
-                    for (ltfat_int s = 0; s < d2; s++)
-                    {
-                        cfp[s * ld3b] = p->cbuf[s];
-                    }
-                    /* Advance the cf pointer. This is only done in this
-                    * one place, because the loops are placed such that
-                    * this pointer will advance linearly through
-                    * memory. Reordering the loops will break this. */
-                    cfp++;
-                }
-            }
+            LTFAT_NAME_REAL(walnut_transpose)(gbase, pp, q, sc->gt);
+            gbase = sc->gt;
         }
-        /* -------- compute matrix multiplication ---------- */
-        /* Do the matmul  */
+
+        /* Scale because of FFTWs normalization. */
+        LTFAT_NAME_REAL(walnut_invmatmul)(gbase,
+                                          (const LTFAT_REAL*) (cf + s * q * q * W),
+                                          pp, q, q * W, p->scalconst,
+                                          (LTFAT_REAL*) (ff + s * pp * q * W));
+    }
+}
+
+/* Inverse signal factorization of coset r, items (w,l,k) in range
+ * start..end-1 */
+static void
+LTFAT_NAME(idgtreal_walnut_ifac)(LTFAT_NAME(idgtreal_long_plan)* p,
+                                 LTFAT_NAME(idgtreal_long_scratch)* sc,
+                                 ltfat_int r, const LTFAT_COMPLEX* ff,
+                                 ltfat_int start, ltfat_int end)
+{
+    ltfat_int L = p->L;
+    ltfat_int a = p->a;
+    ltfat_int M = p->M;
+    ltfat_int c = p->c;
+    ltfat_int pp = a / c;
+    ltfat_int q = M / c;
+    ltfat_int d = L / M / pp;
+    ltfat_int d2 = d / 2 + 1;
+    ltfat_int h_a = -p->h_a;
+
+    /* Leading dimensions of the 4dim array. */
+    ltfat_int ld2ff = pp * q * p->W;
+
+    for (ltfat_int t = start; t < end; t++)
+    {
+        ltfat_int w = t / (q * pp);
+        ltfat_int l = (t / pp) % q;
+        ltfat_int k = t % pp;
+        const LTFAT_COMPLEX* ffp = ff + t;
+        LTFAT_REAL* fp  = p->f + r + w * L;
+
         for (ltfat_int s = 0; s < d2; s++)
         {
-            const LTFAT_COMPLEX* gbase = p->gf + (r + s * c) * pp * q;
-            LTFAT_COMPLEX*       fbase = p->ff + s * pp * q * W;
-            const LTFAT_COMPLEX* cbase = p->cf + s * q * q * W;
-
-            for (ltfat_int nm = 0; nm < q * W; nm++)
-            {
-                for (ltfat_int km = 0; km < pp; km++)
-                {
-                    fbase[km + nm * pp] = 0.0;
-                    for (ltfat_int mm = 0; mm < q; mm++)
-                    {
-                        fbase[km + nm * pp] += gbase[km + mm * pp] * cbase[mm + nm * q];
-                    }
-                    /* Scale because of FFTWs normalization. */
-                    fbase[km + nm * pp] = fbase[km + nm * pp] * scalconst;
-                }
-            }
+            sc->cbuf[s] = ffp[s * ld2ff];
         }
-        /* ----------- compute inverse signal factorization ---------- */
 
-        LTFAT_COMPLEX* ffp = p->ff;
-        LTFAT_REAL*    fp  = p->f + r;
+        LTFAT_NAME(ifftreal_execute_ws)(sc->p_before, sc->cbuf, sc->sbuf,
+                                        sc->fftwork);
+
+        for (ltfat_int s = 0; s < d; s++)
+        {
+            if (p->do_overwriteoutarray)
+                fp[ltfat_positiverem(k * M + s * pp * M - l * h_a * a, L)] = sc->sbuf[s];
+            else
+                fp[ltfat_positiverem(k * M + s * pp * M - l * h_a * a, L)] += sc->sbuf[s];
+        }
+    }
+}
+
+static void
+LTFAT_NAME(idgtreal_walnut_cosets)(void* userdata, ltfat_int start,
+                                   ltfat_int end, int threadid)
+{
+    LTFAT_NAME(idgtreal_walnut_job)* job = (LTFAT_NAME(idgtreal_walnut_job)*) userdata;
+    LTFAT_NAME(idgtreal_long_plan)* p = job->p;
+    LTFAT_NAME(idgtreal_long_scratch)* sc = p->scratch + threadid;
+    ltfat_int q = p->M / p->c;
+    ltfat_int pp = p->a / p->c;
+    ltfat_int d2 = p->L / p->M / pp / 2 + 1;
+
+    for (ltfat_int r = start; r < end; r++)
+    {
+        LTFAT_NAME(idgtreal_walnut_fac)(p, sc, r, sc->cf, 0, p->W * q * q);
+        LTFAT_NAME(idgtreal_walnut_matmul)(p, sc, r, sc->cf, sc->ff, 0, d2);
+        LTFAT_NAME(idgtreal_walnut_ifac)(p, sc, r, sc->ff, 0, p->W * q * pp);
+    }
+}
+
+static void
+LTFAT_NAME(idgtreal_walnut_fac_items)(void* userdata, ltfat_int start,
+                                      ltfat_int end, int threadid)
+{
+    LTFAT_NAME(idgtreal_walnut_job)* job = (LTFAT_NAME(idgtreal_walnut_job)*) userdata;
+    LTFAT_NAME(idgtreal_long_plan)* p = job->p;
 
-        for (ltfat_int w = 0; w < W; w++)
+    LTFAT_NAME(idgtreal_walnut_fac)(p, p->scratch + threadid, job->r,
+                                    p->scratch[0].cf, start, end);
+}
+
+static void
+LTFAT_NAME(idgtreal_walnut_matmul_items)(void* userdata, ltfat_int start,
+        ltfat_int end, int threadid)
+{
+    LTFAT_NAME(idgtreal_walnut_job)* job = (LTFAT_NAME(idgtreal_walnut_job)*) userdata;
+    LTFAT_NAME(idgtreal_long_plan)* p = job->p;
+
+    LTFAT_NAME(idgtreal_walnut_matmul)(p, p->scratch + threadid, job->r,
+                                       p->scratch[0].cf, p->scratch[0].ff,
+                                       start, end);
+}
+
+static void
+LTFAT_NAME(idgtreal_walnut_ifac_items)(void* userdata, ltfat_int start,
+                                       ltfat_int end, int threadid)
+{
+    LTFAT_NAME(idgtreal_walnut_job)* job = (LTFAT_NAME(idgtreal_walnut_job)*) userdata;
+    LTFAT_NAME(idgtreal_long_plan)* p = job->p;
+
+    LTFAT_NAME(idgtreal_walnut_ifac)(p, p->scratch + threadid, job->r,
+                                     p->scratch[0].ff, start, end);
+}
+
+LTFAT_API void
+LTFAT_NAME(idgtreal_walnut_execute)(LTFAT_NAME(idgtreal_long_plan)* p)
+{
+    LTFAT_NAME(idgtreal_walnut_job) job;
+    ltfat_int c = p->c;
+    ltfat_int pp = p->a / c;
+    ltfat_int q = p->M / c;
+    ltfat_int d2 = p->L / p->M / pp / 2 + 1;
+
+    job.p = p;
+    job.r = 0;
+
+    if (ltfat_walnut_parallel_cosets(c, p->nthreads))
+    {
+        ltfat_parallel_for(p->nthreads, c,
+                           &LTFAT_NAME(idgtreal_walnut_cosets), &job);
+    }
+    else
+    {
+        for (job.r = 0; job.r < c; job.r++)
         {
-            for (ltfat_int l = 0; l < q; l++)
-            {
-                for (ltfat_int k = 0; k < pp; k++)
-                {
-                    for (ltfat_int s = 0; s < d2; s++)
-                    {
-                        p->cbuf[s] = ffp[s * ld2ff];
-                    }
-
-                    LTFAT_NAME(ifftreal_execute)(p->p_before);
-
-                    for (ltfat_int s = 0; s < d; s++)
-                    {
-                        if (p->do_overwriteoutarray)
-                            fp[ltfat_positiverem(k * M + s * pp * M - l * h_a * a, L)] = p->sbuf[s];
-                        else
-                            fp[ltfat_positiverem(k * M + s * pp * M - l * h_a * a, L)] += p->sbuf[s];
-                    }
-
-                    /* Advance the ff pointer. This is only done in this
-                    * one place, because the loops are placed such that
-                    * this pointer will advance linearly through
-                    * memory. Reordering the loops will break this. */
-                    ffp++;
-                }
-            }
-            fp += L;
+            ltfat_parallel_for(p->nthreads, p->W * q * q,
+                               &LTFAT_NAME(idgtreal_walnut_fac_items), &job);
+            ltfat_parallel_for(p->nthreads, d2,
+                               &LTFAT_NAME(idgtreal_walnut_matmul_items), &job);
+            ltfat_parallel_for(p->nthreads, p->W * q * pp,
+                               &LTFAT_NAME(idgtreal_walnut_ifac_items), &job);
         }
     }
 }
@@ -3,6 +3,14 @@
 #include "ltfat/macros.h"
 
 #include "ltfat/thirdparty/fftw3.h"
+#include "threads_private.h"
+
+/* Buffer and FFT plan used by a single thread */
+typedef struct
+{
+    LTFAT_REAL* sbuf;
+    LTFAT_NAME_REAL(ifft_plan)* p_before;
+} LTFAT_NAME(iwfac_scratch);
 
 struct LTFAT_NAME(iwfac_plan)
 {
@@ -15,11 +23,20 @@ struct LTFAT_NAME(iwfac_plan)
     ltfat_int M;
     ltfat_int L;
     LTFAT_REAL scaling;
-    LTFAT_REAL* sbuf;
-    /* LTFAT_FFTW(plan) p_before; */
-    LTFAT_NAME_REAL(ifft_plan)* p_before;
+    unsigned flags;
+    int nthreads;
+    LTFAT_NAME(iwfac_scratch)* scratch;
 };
 
+/* Job shared by the threads of a single iwfac_execute call */
+typedef struct
+{
+    LTFAT_NAME(iwfac_plan)* plan;
+    const LTFAT_COMPLEX* gf;
+    ltfat_int R;
+    LTFAT_TYPE* g;
+} LTFAT_NAME(iwfac_job);
+
 LTFAT_API int
 LTFAT_NAME(iwfac)(const LTFAT_COMPLEX* gf, ltfat_int L, ltfat_int R,
                   ltfat_int a, ltfat_int M, LTFAT_TYPE* g)
@@ -39,6 +56,61 @@ error:
     return status;
 }
 
+static void
+LTFAT_NAME(iwfac_scratch_free)(LTFAT_NAME(iwfac_scratch)* scratch, int nthreads)
+{
+    for (int t = 0; t < nthreads; t++)
+    {
+        if (scratch[t].p_before) LTFAT_NAME_REAL(ifft_done)(&scratch[t].p_before);
+        ltfat_safefree(scratch[t].sbuf);
+    }
+    ltfat_free(scratch);
+}
+
+/* Replaces the per-thread scratch such that it is prepared for nthreads
+ * threads. */
+static int
+LTFAT_NAME(iwfac_scratch_realloc)(LTFAT_NAME(iwfac_plan)* plan, int nthreads)
+{
+    LTFAT_NAME(iwfac_scratch)* scratch = NULL;
+    unsigned flags = plan->flags;
+    int status = LTFATERR_SUCCESS;
+
+    if (nthreads == plan->nthreads)
+        return status;
+
+    /* The short FFTs are already done in parallel */
+    if (nthreads > 1)
+        flags &= ~LTFAT_FFT_NTHREADS(0xFF);
+
+    CHECKMEM( scratch = LTFAT_NEWARRAY(LTFAT_NAME(iwfac_scratch), nthreads));
+
+    for (int t = 0; t < nthreads; t++)
+    {
+        CHECKMEM(scratch[t].sbuf = LTFAT_NAME_REAL(malloc)(2 * plan->d));
+
+        /* Create plan. In-place. */
+        /* plan->p_before = LTFAT_FFTW(plan_dft_1d)((int)plan->d, */
+        /*                  (LTFAT_FFTW(complex)*) plan->sbuf, */
+        /*                  (LTFAT_FFTW(complex)*) plan->sbuf, */
+        /*                  FFTW_BACKWARD, flags); */
+        LTFAT_NAME_REAL(ifft_init)(plan->d, 1,
+                                   (LTFAT_COMPLEX*) scratch[t].sbuf,
+                                   (LTFAT_COMPLEX*) scratch[t].sbuf,
+                                   flags, &scratch[t].p_before);
+
+        CHECKINIT(scratch[t].p_before, "FFTW plan creation failed.");
+    }
+
+    if (plan->scratch) LTFAT_NAME(iwfac_scratch_free)(plan->scratch, plan->nthreads);
+    plan->scratch = scratch;
+    plan->nthreads = nthreads;
+    return status;
+error:
+    if (scratch) LTFAT_NAME(iwfac_scratch_free)(scratch, nthreads);
+    return status;
+}
+
 LTFAT_API int
 LTFAT_NAME(iwfac_init)(ltfat_int L, ltfat_int a, ltfat_int M,
                        unsigned flags, LTFAT_NAME(iwfac_plan)** pout)
@@ -65,29 +137,17 @@ LTFAT_NAME(iwfac_init)(ltfat_int L, ltfat_int a, ltfat_int M,
     plan->d = plan->b / plan->p;
     plan->a = a; plan->M = M; plan->L = L;
     plan->scaling = (LTFAT_REAL)( 1.0 / sqrt((double)M) / plan->d );
+    plan->flags = flags;
 
-    CHECKMEM(plan->sbuf = LTFAT_NAME_REAL(malloc)(2 * plan->d));
-
-    /* Create plan. In-place. */
-    /* plan->p_before = LTFAT_FFTW(plan_dft_1d)((int)plan->d, */
-    /*                  (LTFAT_FFTW(complex)*) plan->sbuf, */
-    /*                  (LTFAT_FFTW(complex)*) plan->sbuf, */
-    /*                  FFTW_BACKWARD, flags); */
-    LTFAT_NAME_REAL(ifft_init)(plan->d, 1,
-                               (LTFAT_COMPLEX*) plan->sbuf,
-                               (LTFAT_COMPLEX*) plan->sbuf,
-                               flags, &plan->p_before);
-
-    CHECKINIT(plan->p_before, "FFTW plan creation failed.");
+    CHECKSTATUS( LTFAT_NAME(iwfac_scratch_realloc)(plan, 1));
 
     *pout = plan;
     return status;
 error:
     if (plan)
     {
-        /* if (plan->p_before) LTFAT_FFTW(destroy_plan)(plan->p_before); */
-        if (plan->p_before) LTFAT_NAME_REAL(ifft_done)(&plan->p_before);
-        ltfat_free(plan->sbuf);
+        if (plan->scratch)
+            LTFAT_NAME(iwfac_scratch_free)(plan->scratch, plan->nthreads);
         ltfat_free(plan);
     }
     *pout = NULL;
@@ -95,67 +155,94 @@ error:
 }
 
 LTFAT_API int
-LTFAT_NAME(iwfac_execute)(LTFAT_NAME(iwfac_plan)* plan, const LTFAT_COMPLEX* gf,
-                          ltfat_int R, LTFAT_TYPE* g)
+LTFAT_NAME(iwfac_set_numthreads)(LTFAT_NAME(iwfac_plan)* plan, int nthreads)
 {
-    ltfat_int rem, negrem, c, p, q, d, M, a, L, ld3;
-    LTFAT_REAL scaling;
-    LTFAT_REAL* sbuf, *gfp;
-    /* LTFAT_FFTW(plan) p_before; */
-    LTFAT_NAME_REAL(ifft_plan)* p_before;
     int status = LTFATERR_SUCCESS;
-    CHECKNULL(plan); CHECKNULL(g); CHECKNULL(gf);
-    CHECK(LTFATERR_NOTPOSARG, R > 0, "R (passed %td) must be positive.", R);
+    CHECKNULL(plan);
+    CHECK(LTFATERR_NOTINRANGE, nthreads >= 0 && nthreads <= LTFAT_MAXTHREADS,
+          "nthreads (passed %d) must be in range 0-%d.", nthreads, LTFAT_MAXTHREADS);
 
-    c = plan->c;
-    p = plan->p;
-    q = plan->q;
-    d = plan->d;
-    M = plan->M;
-    a = plan->a;
-    L = plan->L;
+    return LTFAT_NAME(iwfac_scratch_realloc)(
+               plan, nthreads ? nthreads : ltfat_get_num_threads());
+error:
+    return status;
+}
+
+/* Items (r,w,l,k) in range start..end-1 */
+static void
+LTFAT_NAME(iwfac_items)(void* userdata, ltfat_int start, ltfat_int end,
+                        int threadid)
+{
+    LTFAT_NAME(iwfac_job)* job = (LTFAT_NAME(iwfac_job)*) userdata;
+    LTFAT_NAME(iwfac_plan)* plan = job->plan;
+    LTFAT_TYPE* g = job->g;
+    ltfat_int R = job->R;
+    ltfat_int c = plan->c;
+    ltfat_int p = plan->p;
+    ltfat_int q = plan->q;
+    ltfat_int d = plan->d;
+    ltfat_int M = plan->M;
+    ltfat_int a = plan->a;
+    ltfat_int L = plan->L;
 
-    scaling = plan->scaling;
-    sbuf = plan->sbuf;
-    p_before = plan->p_before;
+    LTFAT_REAL scaling = plan->scaling;
+    LTFAT_REAL* sbuf = plan->scratch[threadid].sbuf;
+    /* LTFAT_FFTW(plan) p_before; */
+    LTFAT_NAME_REAL(ifft_plan)* p_before = plan->scratch[threadid].p_before;
 
-    ld3 = c * p * q * R;
-    gfp = (LTFAT_REAL*)gf;
+    ltfat_int ld3 = c * p * q * R;
 
-    for (ltfat_int r = 0; r < c; r++)
+    for (ltfat_int t = start; t < end; t++)
     {
-        for (ltfat_int w = 0; w < R; w++)
+        ltfat_int r = t / (R * q * p);
+        ltfat_int w = (t / (q * p)) % R;
+        ltfat_int l = (t / p) % q;
+        ltfat_int k = t % p;
+        ltfat_int negrem = ltfat_positiverem(k * M - l * a, L);
+
+        /* The loops are placed such that the gf pointer advances linearly
+         * through memory with t. */
+        const LTFAT_REAL* gfp = (const LTFAT_REAL*) job->gf + 2 * t;
+
+        for (ltfat_int s = 0; s < 2 * d; s += 2)
         {
-            for (ltfat_int l = 0; l < q; l++)
-            {
-                for (ltfat_int k = 0; k < p; k++)
-                {
-                    negrem = ltfat_positiverem(k * M - l * a, L);
-                    for (ltfat_int s = 0; s < 2 * d; s += 2)
-                    {
-                        sbuf[s]   = gfp[s * ld3] * scaling;
-                        sbuf[s + 1] = gfp[s * ld3 + 1] * scaling;
-                    }
-
-                    /* LTFAT_FFTW(execute)(p_before); */
-                    LTFAT_NAME_REAL(ifft_execute)(p_before);
-
-                    for (ltfat_int s = 0; s < d; s++)
-                    {
-                        rem = (negrem + s * p * M) % L;
+            sbuf[s]   = gfp[s * ld3] * scaling;
+            sbuf[s + 1] = gfp[s * ld3 + 1] * scaling;
+        }
+
+        /* LTFAT_FFTW(execute)(p_before); */
+        LTFAT_NAME_REAL(ifft_execute)(p_before);
+
+        for (ltfat_int s = 0; s < d; s++)
+        {
+            ltfat_int rem = (negrem + s * p * M) % L;
 #ifdef LTFAT_COMPLEXTYPE
-                        LTFAT_REAL* gTmp = (LTFAT_REAL*) & (g[r + rem + L * w]);
-                        gTmp[0] = sbuf[2 * s];
-                        gTmp[1] = sbuf[2 * s + 1];
+            LTFAT_REAL* gTmp = (LTFAT_REAL*) & (g[r + rem + L * w]);
+            gTmp[0] = sbuf[2 * s];
+            gTmp[1] = sbuf[2 * s + 1];
 #else
-                        g[r + rem + L * w] = sbuf[2 * s];
+            g[r + rem + L * w] = sbuf[2 * s];
 #endif
-                    }
-                    gfp += 2;
-                }
-            }
         }
     }
+}
+
+LTFAT_API int
+LTFAT_NAME(iwfac_execute)(LTFAT_NAME(iwfac_plan)* plan, const LTFAT_COMPLEX* gf,
+                          ltfat_int R, LTFAT_TYPE* g)
+{
+    LTFAT_NAME(iwfac_job) job;
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(plan); CHECKNULL(g); CHECKNULL(gf);
+    CHECK(LTFATERR_NOTPOSARG, R > 0, "R (passed %td) must be positive.", R);
+
+    job.plan = plan;
+    job.gf = gf;
+    job.R = R;
+    job.g = g;
+
+    ltfat_parallel_for(plan->nthreads, plan->c * R * plan->q * plan->p,
+                       &LTFAT_NAME(iwfac_items), &job);
 
 error:
     return status;
@@ -168,9 +255,7 @@ LTFAT_NAME(iwfac_done)(LTFAT_NAME(iwfac_plan)** pout)
     CHECKNULL(pout);
     CHECKNULL(*pout);
 
-    /* LTFAT_FFTW(destroy_plan)((*pout)->p_before); */
-    LTFAT_NAME_REAL(ifft_done)(&(*pout)->p_before);
-    ltfat_free((*pout)->sbuf);
+    LTFAT_NAME(iwfac_scratch_free)((*pout)->scratch, (*pout)->nthreads);
     ltfat_free(*pout);
     *pout = NULL;
 error:
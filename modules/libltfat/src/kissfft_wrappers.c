@@ -3,9 +3,160 @@
 #include "ltfat/types.h"
 #include "ltfat/macros.h"
 #include "ltfat/thirdparty/kiss_fft.h"
+#include "threads_private.h"
+#include "rtsafe_private.h"
+#include "fftdispatch_private.h"
+
+#define FFTNAME(name) LTFAT_FFTBACKEND_NAME(kiss, name)
+
+/****** PLAN CACHE ******/
+/*
+ * Complex kiss_fft configurations are read-only once created and can
+ * therefore be shared among plans. Unused configurations are kept around
+ * (most recently used first) so that repeatedly created plans of the same
+ * length do not recompute the twiddle factors.
+ * Real kiss_fftr configurations carry a scratch buffer and are not shared,
+ * the *_execute_ws functions replace it by one from the workspace.
+ */
+#ifndef LTFAT_KISS_PLANCACHE_MAXIDLE
+#define LTFAT_KISS_PLANCACHE_MAXIDLE 64
+#endif
+
+typedef struct LTFAT_NAME(kiss_cacheentry) LTFAT_NAME(kiss_cacheentry);
+
+struct LTFAT_NAME(kiss_cacheentry)
+{
+    ltfat_int L;
+    unsigned inverse;
+    size_t refcount;
+    LTFAT_KISS(fft_plan)* kiss_plan;
+    LTFAT_NAME(kiss_cacheentry)* next;
+};
+
+static ltfat_mutex_t plancache_mutex = LTFAT_MUTEX_INITIALIZER;
+static LTFAT_NAME(kiss_cacheentry)* plancache_head = NULL;
+
+/* Frees unused configurations exceeding maxidle. Expects the cache to be locked. */
+static ltfat_int
+LTFAT_NAME(kiss_plancache_trim)(size_t maxidle)
+{
+    LTFAT_NAME(kiss_cacheentry)** link = &plancache_head;
+    size_t idle = 0;
+    ltfat_int destroyed = 0;
+
+    while (*link)
+    {
+        LTFAT_NAME(kiss_cacheentry)* e = *link;
+        if (e->refcount == 0 && ++idle > maxidle)
+        {
+            *link = e->next;
+            ltfat_free(e->kiss_plan);
+            ltfat_free(e);
+            destroyed++;
+        }
+        else
+            link = &e->next;
+    }
+    return destroyed;
+}
+
+static LTFAT_KISS(fft_plan)*
+LTFAT_NAME(kiss_plancache_acquire)(ltfat_int L, unsigned inverse)
+{
+    LTFAT_NAME(kiss_cacheentry)* prev = NULL;
+    LTFAT_NAME(kiss_cacheentry)* e = NULL;
+    LTFAT_KISS(fft_plan)* p = NULL;
+
+    ltfat_rtsafe_blocking("the FFT plan cache");
+    ltfat_mutex_lock(&plancache_mutex);
+
+    for (e = plancache_head; e; prev = e, e = e->next)
+        if (e->L == L && e->inverse == inverse)
+            break;
+
+    if (e)
+    {
+        if (prev)
+        {
+            prev->next = e->next;
+            e->next = plancache_head;
+            plancache_head = e;
+        }
+        e->refcount++;
+        p = e->kiss_plan;
+    }
+    else if ((e = LTFAT_NEW(LTFAT_NAME(kiss_cacheentry))))
+    {
+        e->L = L; e->inverse = inverse;
+        e->kiss_plan = LTFAT_KISS(fft_alloc)(L, inverse, NULL, NULL);
+        if (e->kiss_plan)
+        {
+            e->refcount = 1;
+            e->next = plancache_head;
+            plancache_head = e;
+            p = e->kiss_plan;
+        }
+        else
+            ltfat_free(e);
+    }
+
+    ltfat_mutex_unlock(&plancache_mutex);
+    return p;
+}
+
+static void
+LTFAT_NAME(kiss_plancache_release)(LTFAT_KISS(fft_plan)* p)
+{
+    LTFAT_NAME(kiss_cacheentry)* e;
+
+    ltfat_rtsafe_blocking("the FFT plan cache");
+    ltfat_mutex_lock(&plancache_mutex);
+
+    for (e = plancache_head; e; e = e->next)
+        if (e->kiss_plan == p)
+        {
+            if (e->refcount > 0) e->refcount--;
+            break;
+        }
+
+    LTFAT_NAME(kiss_plancache_trim)(LTFAT_KISS_PLANCACHE_MAXIDLE);
+    ltfat_mutex_unlock(&plancache_mutex);
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(fft_cache_clear)(void)
+{
+    ltfat_int destroyed;
+    ltfat_mutex_lock(&plancache_mutex);
+    destroyed = LTFAT_NAME(kiss_plancache_trim)(0);
+    ltfat_mutex_unlock(&plancache_mutex);
+    return (int) destroyed;
+}
+
+/****** WISDOM ******/
+/* There is no planning in KISS FFT, so there is nothing to load or save */
+#ifndef LTFAT_FFT_DISPATCH
+LTFAT_API int
+LTFAT_NAME(fftw_wisdom_load)(const char* UNUSED(path))
+{
+    return LTFATERR_NOTSUPPORTED;
+}
+
+LTFAT_API int
+LTFAT_NAME(fftw_wisdom_save)(const char* UNUSED(path))
+{
+    return LTFATERR_NOTSUPPORTED;
+}
+
+LTFAT_API int
+LTFAT_NAME(fftw_set_wisdomonly)(int UNUSED(do_wisdomonly))
+{
+    return LTFATERR_SUCCESS;
+}
+#endif
 
 /****** FFT ******/
-struct LTFAT_NAME(fft_plan)
+struct FFTNAME(fft_plan)
 {
     ltfat_int L;
     ltfat_int W;
@@ -15,16 +166,16 @@ struct LTFAT_NAME(fft_plan)
     LTFAT_KISS(fft_plan)* kiss_plan;
 };
 
-LTFAT_API int
-LTFAT_NAME(fft)(LTFAT_COMPLEX in[], ltfat_int L, ltfat_int W,
+LTFAT_FFTBACKEND_API int
+FFTNAME(fft)(LTFAT_COMPLEX in[], ltfat_int L, ltfat_int W,
                 LTFAT_COMPLEX out[])
 {
-    LTFAT_NAME(fft_plan)* p = NULL;
+    FFTNAME(fft_plan)* p = NULL;
     int status = LTFATERR_SUCCESS;
 
-    CHECKSTATUS( LTFAT_NAME(fft_init)(L, W, in, out, 0, &p));
-    LTFAT_NAME(fft_execute)(p);
-    LTFAT_NAME(fft_done)(&p);
+    CHECKSTATUS( FFTNAME(fft_init)(L, W, in, out, 0, &p));
+    FFTNAME(fft_execute)(p);
+    FFTNAME(fft_done)(&p);
 error:
     return status;
 }
@@ -32,9 +183,9 @@ error:
 static int
 LTFAT_NAME(fft_init_common)(ltfat_int L, ltfat_int W,
                             LTFAT_COMPLEX in[], LTFAT_COMPLEX out[],
-                            unsigned inverse, LTFAT_NAME(fft_plan)** p)
+                            unsigned inverse, FFTNAME(fft_plan)** p)
 {
-    LTFAT_NAME(fft_plan)* fftwp = NULL;
+    FFTNAME(fft_plan)* fftwp = NULL;
     ltfat_int nextfastL = 0;
 
     int status = LTFATERR_SUCCESS;
@@ -53,10 +204,10 @@ LTFAT_NAME(fft_init_common)(ltfat_int L, ltfat_int W,
               "during execution.", L, nextfastL);
     }
 
-    CHECKMEM( fftwp = LTFAT_NEW(LTFAT_NAME(fft_plan)) );
+    CHECKMEM( fftwp = LTFAT_NEW(FFTNAME(fft_plan)) );
     fftwp->L = L; fftwp->W = W; fftwp->in = in; fftwp->out = out;
 
-    fftwp->kiss_plan = LTFAT_KISS(fft_alloc)(L, inverse, NULL, NULL);
+    fftwp->kiss_plan = LTFAT_NAME(kiss_plancache_acquire)(L, inverse);
     CHECKINIT(fftwp->kiss_plan, "FFTW plan creation failed.");
 
     if (in == out)
@@ -66,42 +217,59 @@ LTFAT_NAME(fft_init_common)(ltfat_int L, ltfat_int W,
     return status;
 error:
     if (fftwp)
-        LTFAT_NAME(fft_done)(&fftwp);
+        FFTNAME(fft_done)(&fftwp);
     *p = NULL;
     return status;
 }
 
 
-LTFAT_API int
-LTFAT_NAME(fft_init)(ltfat_int L, ltfat_int W,
+LTFAT_FFTBACKEND_API int
+FFTNAME(fft_init)(ltfat_int L, ltfat_int W,
                      LTFAT_COMPLEX in[], LTFAT_COMPLEX out[],
-                     unsigned UNUSED(flags), LTFAT_NAME(fft_plan)** p)
+                     unsigned UNUSED(flags), FFTNAME(fft_plan)** p)
 {
     return LTFAT_NAME(fft_init_common)(L, W, in, out, 0, p);
 }
 
-LTFAT_API int
-LTFAT_NAME(fft_execute)(LTFAT_NAME(fft_plan)* p)
+LTFAT_FFTBACKEND_API int
+FFTNAME(fft_execute)(FFTNAME(fft_plan)* p)
 {
-    return LTFAT_NAME(fft_execute_newarray)( p, p->in, p->out);
+    return FFTNAME(fft_execute_newarray)( p, p->in, p->out);
 }
 
-LTFAT_API int
-LTFAT_NAME(fft_execute_newarray)(LTFAT_NAME(fft_plan)* p,
+LTFAT_FFTBACKEND_API int
+FFTNAME(fft_execute_newarray)(FFTNAME(fft_plan)* p,
                                  const LTFAT_COMPLEX in[], LTFAT_COMPLEX out[])
 {
+    return FFTNAME(fft_execute_ws)(p, in, out, NULL);
+}
+
+LTFAT_FFTBACKEND_API size_t
+FFTNAME(fft_get_workspace_size)(const FFTNAME(fft_plan)* p)
+{
+    // Copy of the input of in-place transforms
+    return p && p->tmp ? p->L * sizeof(LTFAT_COMPLEX) : 0;
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(fft_execute_ws)(const FFTNAME(fft_plan)* p,
+                        const LTFAT_COMPLEX in[], LTFAT_COMPLEX out[],
+                        void* work)
+{
+    LTFAT_COMPLEX* tmp;
     int status = LTFATERR_SUCCESS;
     CHECKNULL(p); CHECKNULL(in); CHECKNULL(out);
+    tmp = work ? (LTFAT_COMPLEX*) work : p->tmp;
 
     if (in == out)
     {
-        CHECKNULL(p->tmp);
+        CHECKNULL(tmp);
 
         for (ltfat_int w = 0; w < p->W; w++)
         {
-            memcpy(p->tmp, in + w * p->L, p->L * sizeof * p->tmp);
+            memcpy(tmp, in + w * p->L, p->L * sizeof * tmp);
             LTFAT_KISS(fft)(p->kiss_plan,
-                            (const kiss_fft_cpx*) p->tmp,
+                            (const kiss_fft_cpx*) tmp,
                             (kiss_fft_cpx*) out + w * p->L);
         }
     }
@@ -117,72 +285,86 @@ error:
     return status;
 }
 
-LTFAT_API int
-LTFAT_NAME(fft_done)(LTFAT_NAME(fft_plan)** p)
+LTFAT_FFTBACKEND_API int
+FFTNAME(fft_done)(FFTNAME(fft_plan)** p)
 {
     int status = LTFATERR_SUCCESS;
-    LTFAT_NAME(fft_plan)* pp = NULL;
+    FFTNAME(fft_plan)* pp = NULL;
     CHECKNULL(p); CHECKNULL(*p);
     pp = *p;
     if (pp->tmp) ltfat_free(pp->tmp);
-    if (pp->kiss_plan) ltfat_free(pp->kiss_plan);
+    if (pp->kiss_plan) LTFAT_NAME(kiss_plancache_release)(pp->kiss_plan);
     ltfat_free(pp);
-    pp = NULL;
+    *p = NULL;
 error:
     return status;
 }
 
 /******* IFFT ******/
-struct LTFAT_NAME(ifft_plan)
+struct FFTNAME(ifft_plan)
 {
-    struct LTFAT_NAME(fft_plan) inplan;
+    struct FFTNAME(fft_plan) inplan;
 };
 
-LTFAT_API int
-LTFAT_NAME(ifft)(LTFAT_COMPLEX in[], ltfat_int L, ltfat_int W,
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifft)(LTFAT_COMPLEX in[], ltfat_int L, ltfat_int W,
                  LTFAT_COMPLEX out[])
 {
-    LTFAT_NAME(ifft_plan)* p = NULL;
+    FFTNAME(ifft_plan)* p = NULL;
     int status = LTFATERR_SUCCESS;
 
-    CHECKSTATUS( LTFAT_NAME(ifft_init)(L, W, in, out, 0, &p));
-    LTFAT_NAME(ifft_execute)(p);
-    LTFAT_NAME(ifft_done)(&p);
+    CHECKSTATUS( FFTNAME(ifft_init)(L, W, in, out, 0, &p));
+    FFTNAME(ifft_execute)(p);
+    FFTNAME(ifft_done)(&p);
 error:
     return status;
 }
 
-LTFAT_API int
-LTFAT_NAME(ifft_init)(ltfat_int L, ltfat_int W,
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifft_init)(ltfat_int L, ltfat_int W,
                       LTFAT_COMPLEX in[], LTFAT_COMPLEX out[],
-                      unsigned UNUSED(flags), LTFAT_NAME(ifft_plan)** p)
+                      unsigned UNUSED(flags), FFTNAME(ifft_plan)** p)
 {
     return LTFAT_NAME(fft_init_common)(L, W, in, out, 1,
-                                       (LTFAT_NAME(fft_plan)**) p);
+                                       (FFTNAME(fft_plan)**) p);
 }
 
-LTFAT_API int
-LTFAT_NAME(ifft_execute)(LTFAT_NAME(ifft_plan)* p)
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifft_execute)(FFTNAME(ifft_plan)* p)
 {
-    return LTFAT_NAME(fft_execute)((LTFAT_NAME(fft_plan)*) p);
+    return FFTNAME(fft_execute)((FFTNAME(fft_plan)*) p);
 }
 
-LTFAT_API int
-LTFAT_NAME(ifft_execute_newarray)(LTFAT_NAME(ifft_plan)* p,
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifft_execute_newarray)(FFTNAME(ifft_plan)* p,
                                   const LTFAT_COMPLEX in[], LTFAT_COMPLEX out[])
 {
-    return LTFAT_NAME(fft_execute_newarray)((LTFAT_NAME(fft_plan)*) p, in, out);
+    return FFTNAME(fft_execute_newarray)((FFTNAME(fft_plan)*) p, in, out);
 
 }
 
-LTFAT_API int
-LTFAT_NAME(ifft_done)(LTFAT_NAME(ifft_plan)** p)
+LTFAT_FFTBACKEND_API size_t
+FFTNAME(ifft_get_workspace_size)(const FFTNAME(ifft_plan)* p)
 {
-    return LTFAT_NAME(fft_done)((LTFAT_NAME(fft_plan)**) p);
+    return FFTNAME(fft_get_workspace_size)((const FFTNAME(fft_plan)*) p);
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifft_execute_ws)(const FFTNAME(ifft_plan)* p,
+                         const LTFAT_COMPLEX in[], LTFAT_COMPLEX out[],
+                         void* work)
+{
+    return FFTNAME(fft_execute_ws)((const FFTNAME(fft_plan)*) p, in, out, work);
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifft_done)(FFTNAME(ifft_plan)** p)
+{
+    return FFTNAME(fft_done)((FFTNAME(fft_plan)**) p);
 }
 
 /****** FFTREAL ******/
-struct LTFAT_NAME(fftreal_plan)
+struct FFTNAME(fftreal_plan)
 {
     ltfat_int L;
     ltfat_int W;
@@ -193,16 +375,16 @@ struct LTFAT_NAME(fftreal_plan)
     LTFAT_KISS(fftr_plan)* kiss_plan;
 };
 
-LTFAT_API int
-LTFAT_NAME(fftreal)(LTFAT_REAL in[], ltfat_int L, ltfat_int W,
+LTFAT_FFTBACKEND_API int
+FFTNAME(fftreal)(LTFAT_REAL in[], ltfat_int L, ltfat_int W,
                     LTFAT_COMPLEX out[])
 {
-    LTFAT_NAME(fftreal_plan)* p = NULL;
+    FFTNAME(fftreal_plan)* p = NULL;
     int status = LTFATERR_SUCCESS;
 
-    CHECKSTATUS( LTFAT_NAME(fftreal_init)(L, W, in, out, 0, &p));
-    LTFAT_NAME(fftreal_execute)(p);
-    LTFAT_NAME(fftreal_done)(&p);
+    CHECKSTATUS( FFTNAME(fftreal_init)(L, W, in, out, 0, &p));
+    FFTNAME(fftreal_execute)(p);
+    FFTNAME(fftreal_done)(&p);
 error:
     return status;
 }
@@ -210,9 +392,9 @@ error:
 static int
 LTFAT_NAME(fftreal_init_common)(ltfat_int L, ltfat_int W,
                                 LTFAT_REAL in[], LTFAT_REAL out[],
-                                unsigned inverse, LTFAT_NAME(fftreal_plan)** p)
+                                unsigned inverse, FFTNAME(fftreal_plan)** p)
 {
-    LTFAT_NAME(fftreal_plan)* fftwp = NULL;
+    FFTNAME(fftreal_plan)* fftwp = NULL;
     ltfat_int M2;
     ltfat_int nextfastL;
 
@@ -224,7 +406,7 @@ LTFAT_NAME(fftreal_init_common)(ltfat_int L, ltfat_int W,
 
     M2 = L / 2 + 1;
 
-    CHECKMEM( fftwp = LTFAT_NEW(LTFAT_NAME(fftreal_plan)) );
+    CHECKMEM( fftwp = LTFAT_NEW(FFTNAME(fftreal_plan)) );
     fftwp->L = L; fftwp->W = W; fftwp->in = in; fftwp->out = out;
 
     nextfastL = ltfat_nextfastfft(L);
@@ -244,7 +426,7 @@ LTFAT_NAME(fftreal_init_common)(ltfat_int L, ltfat_int W,
             DEBUGNOTE("Warning: Odd L is a \"very slow\" FFT lengh. Full FFT will be performed.");
         }
         // Workaround for odd-length transforms
-        fftwp->kiss_plan_cpx = LTFAT_KISS(fft_alloc)(L, inverse, NULL, NULL);
+        fftwp->kiss_plan_cpx = LTFAT_NAME(kiss_plancache_acquire)(L, inverse);
         CHECKINIT(fftwp->kiss_plan_cpx, "FFTW plan creation failed.");
         CHECKMEM( fftwp->tmp = LTFAT_NAME_COMPLEX(malloc)(4 * M2 ) );
     }
@@ -260,37 +442,80 @@ LTFAT_NAME(fftreal_init_common)(ltfat_int L, ltfat_int W,
     return status;
 error:
     if (fftwp)
-        LTFAT_NAME(fftreal_done)(&fftwp);
+        FFTNAME(fftreal_done)(&fftwp);
     *p = NULL;
     return status;
 }
 
 
-LTFAT_API int
-LTFAT_NAME(fftreal_init)(ltfat_int L, ltfat_int W,
+LTFAT_FFTBACKEND_API int
+FFTNAME(fftreal_init)(ltfat_int L, ltfat_int W,
                          LTFAT_REAL in[], LTFAT_COMPLEX out[],
-                         unsigned UNUSED(flags), LTFAT_NAME(fftreal_plan)** p)
+                         unsigned UNUSED(flags), FFTNAME(fftreal_plan)** p)
 {
     return  LTFAT_NAME(fftreal_init_common)(L, W, in, (LTFAT_REAL*) out, 0, p);
 }
 
-LTFAT_API int
-LTFAT_NAME(fftreal_execute)(LTFAT_NAME(fftreal_plan)* p)
+LTFAT_FFTBACKEND_API int
+FFTNAME(fftreal_execute)(FFTNAME(fftreal_plan)* p)
 {
-    return LTFAT_NAME(fftreal_execute_newarray)( p, p->in,
+    return FFTNAME(fftreal_execute_newarray)( p, p->in,
             (LTFAT_COMPLEX*) p->out);
 }
 
-LTFAT_API int
-LTFAT_NAME(fftreal_execute_newarray)(LTFAT_NAME(fftreal_plan)* p,
+LTFAT_FFTBACKEND_API int
+FFTNAME(fftreal_execute_newarray)(FFTNAME(fftreal_plan)* p,
                                      const LTFAT_REAL in[], LTFAT_COMPLEX out[])
+{
+    return FFTNAME(fftreal_execute_ws)(p, in, out, NULL);
+}
+
+/* Odd lengths need the full complex buffer, even lengths need a copy of
+ * the input of in-place transforms followed by the kiss_fftr scratch. */
+LTFAT_FFTBACKEND_API size_t
+FFTNAME(fftreal_get_workspace_size)(const FFTNAME(fftreal_plan)* p)
+{
+    ltfat_int M2;
+    if (!p) return 0;
+    M2 = p->L / 2 + 1;
+
+    if (p->L % 2)
+        return 4 * M2 * sizeof(LTFAT_COMPLEX);
+
+    return ((p->tmp ? M2 : 0) + p->L / 2) * sizeof(LTFAT_COMPLEX);
+}
+
+/* Splits work as described above, NULL pointers mean the plan-owned
+ * buffers. */
+static void
+LTFAT_NAME(fftreal_split_ws)(const FFTNAME(fftreal_plan)* p, void* work,
+                             LTFAT_COMPLEX** tmp, kiss_fft_cpx** rtmp)
+{
+    *tmp = p->tmp;
+    *rtmp = NULL;
+
+    if (work)
+    {
+        *tmp = (LTFAT_COMPLEX*) work;
+        if (!(p->L % 2))
+            *rtmp = (kiss_fft_cpx*) (*tmp + (p->tmp ? p->L / 2 + 1 : 0));
+    }
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(fftreal_execute_ws)(const FFTNAME(fftreal_plan)* p,
+                            const LTFAT_REAL in[], LTFAT_COMPLEX out[],
+                            void* work)
 {
     int status = LTFATERR_SUCCESS;
     ltfat_int M2;
+    LTFAT_COMPLEX* tmp;
+    kiss_fft_cpx* rtmp;
 
     CHECKNULL(p); CHECKNULL(in); CHECKNULL(out);
 
     M2 = p->L / 2 + 1;
+    LTFAT_NAME(fftreal_split_ws)(p, work, &tmp, &rtmp);
 
     if (p->L % 2)
     {
@@ -300,105 +525,123 @@ LTFAT_NAME(fftreal_execute_newarray)(LTFAT_NAME(fftreal_plan)* p,
 
         for (ltfat_int w = 0; w < p->W; w++)
         {
-            LTFAT_NAME(real2complex_array)(in + w * step, p->L, p->tmp);
+            LTFAT_NAME(real2complex_array)(in + w * step, p->L, tmp);
 
             LTFAT_KISS(fft)(p->kiss_plan_cpx,
-                            (const kiss_fft_cpx*) p->tmp,
-                            (kiss_fft_cpx*) p->tmp + 2 * M2);
+                            (const kiss_fft_cpx*) tmp,
+                            (kiss_fft_cpx*) tmp + 2 * M2);
 
-            memcpy(out + w * M2, p->tmp + 2 * M2, M2 * sizeof * out);
+            memcpy(out + w * M2, tmp + 2 * M2, M2 * sizeof * out);
         }
     }
     else
     {
         if ( in == (const LTFAT_REAL*) out )
         {
-            CHECKNULL(p->tmp);
+            CHECKNULL(tmp);
 
             for (ltfat_int w = 0; w < p->W; w++)
             {
-                memcpy(p->tmp, in + w * 2 * M2, p->L * sizeof * p->in);
-                LTFAT_KISS(fftr)(p->kiss_plan,
-                                 (const kiss_fft_scalar*) p->tmp,
-                                 (kiss_fft_cpx*) out + w * M2);
+                memcpy(tmp, in + w * 2 * M2, p->L * sizeof * p->in);
+                LTFAT_KISS(fftr_tmp)(p->kiss_plan,
+                                     (const kiss_fft_scalar*) tmp,
+                                     (kiss_fft_cpx*) out + w * M2, rtmp);
             }
         }
         else
         {
             for (ltfat_int w = 0; w < p->W; w++)
-                LTFAT_KISS(fftr)(p->kiss_plan,
-                                 (const kiss_fft_scalar*) in + w * p->L,
-                                 (kiss_fft_cpx*) out + w * M2);
+                LTFAT_KISS(fftr_tmp)(p->kiss_plan,
+                                     (const kiss_fft_scalar*) in + w * p->L,
+                                     (kiss_fft_cpx*) out + w * M2, rtmp);
         }
     }
 error:
     return status;
 }
 
-LTFAT_API int
-LTFAT_NAME(fftreal_done)(LTFAT_NAME(fftreal_plan)** p)
+LTFAT_FFTBACKEND_API int
+FFTNAME(fftreal_done)(FFTNAME(fftreal_plan)** p)
 {
     int status = LTFATERR_SUCCESS;
-    LTFAT_NAME(fftreal_plan)* pp = NULL;
+    FFTNAME(fftreal_plan)* pp = NULL;
     CHECKNULL(p); CHECKNULL(*p);
     pp = *p;
     if (pp->tmp) ltfat_free(pp->tmp);
     if (pp->kiss_plan) ltfat_free(pp->kiss_plan);
-    if (pp->kiss_plan_cpx) ltfat_free(pp->kiss_plan_cpx);
+    if (pp->kiss_plan_cpx)
+        LTFAT_NAME(kiss_plancache_release)(pp->kiss_plan_cpx);
     ltfat_free(pp);
-    pp = NULL;
+    *p = NULL;
 error:
     return status;
 }
 
 /******* IFFTREAL ******/
-struct LTFAT_NAME(ifftreal_plan)
+struct FFTNAME(ifftreal_plan)
 {
-    struct LTFAT_NAME(fftreal_plan) inplan;
+    struct FFTNAME(fftreal_plan) inplan;
 };
 
-LTFAT_API int
-LTFAT_NAME(ifftreal)(LTFAT_COMPLEX in[], ltfat_int L, ltfat_int W,
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifftreal)(LTFAT_COMPLEX in[], ltfat_int L, ltfat_int W,
                      LTFAT_REAL out[])
 {
-    LTFAT_NAME(ifftreal_plan)* p = NULL;
+    FFTNAME(ifftreal_plan)* p = NULL;
     int status = LTFATERR_SUCCESS;
 
-    CHECKSTATUS( LTFAT_NAME(ifftreal_init)(L, W, in, out, 0, &p));
-    LTFAT_NAME(ifftreal_execute)(p);
-    LTFAT_NAME(ifftreal_done)(&p);
+    CHECKSTATUS( FFTNAME(ifftreal_init)(L, W, in, out, 0, &p));
+    FFTNAME(ifftreal_execute)(p);
+    FFTNAME(ifftreal_done)(&p);
 error:
     return status;
 }
 
-LTFAT_API int
-LTFAT_NAME(ifftreal_init)(ltfat_int L, ltfat_int W,
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifftreal_init)(ltfat_int L, ltfat_int W,
                           LTFAT_COMPLEX in[], LTFAT_REAL out[],
-                          unsigned UNUSED(flags), LTFAT_NAME(ifftreal_plan)** p)
+                          unsigned UNUSED(flags), FFTNAME(ifftreal_plan)** p)
 {
     return LTFAT_NAME(fftreal_init_common)(L, W, (LTFAT_REAL*)in, out, 1,
-                                           (LTFAT_NAME(fftreal_plan)**) p);
+                                           (FFTNAME(fftreal_plan)**) p);
 }
 
-LTFAT_API int
-LTFAT_NAME(ifftreal_execute)(LTFAT_NAME(ifftreal_plan)* pin)
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifftreal_execute)(FFTNAME(ifftreal_plan)* pin)
 {
-    LTFAT_NAME(fftreal_plan)* p = (LTFAT_NAME(fftreal_plan)*) pin;
-    return LTFAT_NAME(ifftreal_execute_newarray)( pin, (const LTFAT_COMPLEX*) p->in,
+    FFTNAME(fftreal_plan)* p = (FFTNAME(fftreal_plan)*) pin;
+    return FFTNAME(ifftreal_execute_newarray)( pin, (const LTFAT_COMPLEX*) p->in,
             p->out);
 }
 
-LTFAT_API int
-LTFAT_NAME(ifftreal_execute_newarray)(LTFAT_NAME(ifftreal_plan)* pin,
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifftreal_execute_newarray)(FFTNAME(ifftreal_plan)* pin,
                                       const LTFAT_COMPLEX in[], LTFAT_REAL out[])
+{
+    return FFTNAME(ifftreal_execute_ws)(pin, in, out, NULL);
+}
+
+LTFAT_FFTBACKEND_API size_t
+FFTNAME(ifftreal_get_workspace_size)(const FFTNAME(ifftreal_plan)* p)
+{
+    return FFTNAME(fftreal_get_workspace_size)((const FFTNAME(fftreal_plan)*) p);
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifftreal_execute_ws)(const FFTNAME(ifftreal_plan)* pin,
+                             const LTFAT_COMPLEX in[], LTFAT_REAL out[],
+                             void* work)
 {
     int status = LTFATERR_SUCCESS;
     ltfat_int M2;
-    LTFAT_NAME(fftreal_plan)* p;
+    const FFTNAME(fftreal_plan)* p;
+    LTFAT_COMPLEX* tmp;
+    kiss_fft_cpx* rtmp;
     CHECKNULL(pin); CHECKNULL(in); CHECKNULL(out);
-    p = (LTFAT_NAME(fftreal_plan)*) pin;
+    p = (const FFTNAME(fftreal_plan)*) pin;
 
     M2 = p->L / 2 + 1;
+    LTFAT_NAME(fftreal_split_ws)(p, work, &tmp, &rtmp);
 
     if (p->L % 2)
     {
@@ -409,46 +652,46 @@ LTFAT_NAME(ifftreal_execute_newarray)(LTFAT_NAME(ifftreal_plan)* pin,
         for (ltfat_int w = 0; w < p->W; w++)
         {
             const LTFAT_COMPLEX* inTmp = in + w * M2;
-            memcpy(p->tmp, inTmp, M2 * sizeof * in);
+            memcpy(tmp, inTmp, M2 * sizeof * in);
 
             for (ltfat_int ii = p->L - 1, jj = 1; ii >= M2; ii--, jj++)
-                p->tmp[ii] = conj(inTmp[jj]);
+                tmp[ii] = conj(inTmp[jj]);
 
             LTFAT_KISS(fft)(p->kiss_plan_cpx,
-                            (const kiss_fft_cpx*) p->tmp,
-                            (kiss_fft_cpx*) p->tmp + 2 * M2);
+                            (const kiss_fft_cpx*) tmp,
+                            (kiss_fft_cpx*) tmp + 2 * M2);
 
-            LTFAT_NAME(complex2real_array)( p->tmp + 2 * M2, p->L, out + w * step);
+            LTFAT_NAME(complex2real_array)( tmp + 2 * M2, p->L, out + w * step);
         }
     }
     else
     {
         if (in == (const LTFAT_COMPLEX*) out)
         {
-            CHECKNULL(p->tmp);
+            CHECKNULL(tmp);
 
             for (ltfat_int w = 0; w < p->W; w++)
             {
-                memcpy(p->tmp, in + w * M2, M2 * sizeof * in);
-                LTFAT_KISS(fftri)(p->kiss_plan,
-                                  (const kiss_fft_cpx*) p->tmp,
-                                  (kiss_fft_scalar*) out + w * 2 * M2);
+                memcpy(tmp, in + w * M2, M2 * sizeof * in);
+                LTFAT_KISS(fftri_tmp)(p->kiss_plan,
+                                      (const kiss_fft_cpx*) tmp,
+                                      (kiss_fft_scalar*) out + w * 2 * M2, rtmp);
             }
         }
         else
         {
             for (ltfat_int w = 0; w < p->W; w++)
-                LTFAT_KISS(fftri)(p->kiss_plan,
-                                  (const kiss_fft_cpx*) in + w * M2,
-                                  (kiss_fft_scalar*) out + w * p->L);
+                LTFAT_KISS(fftri_tmp)(p->kiss_plan,
+                                      (const kiss_fft_cpx*) in + w * M2,
+                                      (kiss_fft_scalar*) out + w * p->L, rtmp);
         }
     }
 error:
     return status;
 }
 
-LTFAT_API int
-LTFAT_NAME(ifftreal_done)(LTFAT_NAME(ifftreal_plan)** p)
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifftreal_done)(FFTNAME(ifftreal_plan)** p)
 {
-    return LTFAT_NAME(fftreal_done)((LTFAT_NAME(fftreal_plan)**) p);
+    return FFTNAME(fftreal_done)((FFTNAME(fftreal_plan)**) p);
 }
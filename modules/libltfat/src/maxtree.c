@@ -1,6 +1,10 @@
 #include "ltfat.h"
 #include "ltfat/types.h"
 #include "ltfat/macros.h"
+#include "simd_private.h"
+
+/* Children of a node of the flat tree, one cache line */
+#define LTFAT_MAXTREE_FANOUT ((ltfat_int)(64 / sizeof(LTFAT_REAL)))
 
 struct LTFAT_NAME(maxtree)
 {
@@ -20,6 +24,12 @@ struct LTFAT_NAME(maxtree)
     int is_complexinput;
     LTFAT_NAME(maxtree_complexinput_callback)* callback;
     void* userdata;
+    // Flat tree, see maxtree_init_flat
+    int          is_flat;
+    ltfat_int    flatLevels; // Excluding the leaves, which are not stored
+    ltfat_int*   flatOff;    // Offset of each level in flatVals and flatPos
+    LTFAT_REAL*  flatVals;   // Levels padded to whole nodes
+    ltfat_int*   flatPos;    // Leaf index of each value
 };
 
 LTFAT_API int
@@ -96,6 +106,57 @@ error:
     return status;
 }
 
+LTFAT_API int
+LTFAT_NAME(maxtree_init_flat)(
+    ltfat_int L, ltfat_int Lstep, LTFAT_NAME(maxtree)** pout)
+{
+    LTFAT_NAME(maxtree)* p = NULL;
+    ltfat_int D = LTFAT_MAXTREE_FANOUT;
+    ltfat_int levels, len, total;
+    int status = LTFATERR_SUCCESS;
+
+    CHECK(LTFATERR_NOTPOSARG, L > 0,
+          "L must be positive (passed %td)" , L);
+
+    levels = 0;
+    for (len = L; len > 1; len = ltfat_idivceil(len, D))
+        levels++;
+
+    CHECKMEM( p = LTFAT_NEW( LTFAT_NAME(maxtree)) );
+    CHECKMEM( p->flatOff = LTFAT_NEWARRAY(ltfat_int, levels + 1) );
+
+    total = 0; len = L;
+    for (ltfat_int k = 0; k < levels; k++)
+    {
+        len = ltfat_idivceil(len, D);
+        p->flatOff[k] = total;
+        total += D * ltfat_idivceil(len, D);
+    }
+    p->flatOff[levels] = total;
+
+    if (levels > 0)
+    {
+        CHECKMEM( p->flatVals = LTFAT_NAME_REAL(malloc)( total ));
+        CHECKMEM( p->flatPos = LTFAT_NEWARRAY(ltfat_int, total));
+
+        // Padding never wins
+        for (ltfat_int l = 0; l < total; l++)
+            p->flatVals[l] = (LTFAT_REAL) -HUGE_VAL;
+    }
+
+    p->is_flat = 1; p->flatLevels = levels;
+    p->L = L; p->Lstep = Lstep;
+
+    p->dirtystart = p->Lstep;
+    p->dirtyend   = 0;
+
+    *pout = p;
+    return LTFATERR_SUCCESS;
+error:
+    if (p) LTFAT_NAME(maxtree_done)(&p);
+    return status;
+}
+
 LTFAT_API int
 LTFAT_NAME(maxtree_done)(LTFAT_NAME(maxtree)** p)
 {
@@ -109,6 +170,9 @@ LTFAT_NAME(maxtree_done)(LTFAT_NAME(maxtree)** p)
     ltfat_safefree(pp->levelL);
     ltfat_safefree(pp->treePtrs);
     ltfat_safefree(pp->treePosPtrs);
+    ltfat_safefree(pp->flatOff);
+    ltfat_safefree(pp->flatVals);
+    ltfat_safefree(pp->flatPos);
 
     ltfat_free(pp);
     *p = NULL;
@@ -139,7 +203,10 @@ LTFAT_API int
 LTFAT_NAME(maxtree_reset_complex)(
     LTFAT_NAME(maxtree)* p, const LTFAT_COMPLEX inarray[])
 {
-    p->treePtrs[p->depth] = (LTFAT_REAL*) inarray;
+    if (p->is_flat)
+        p->pointedarray = (LTFAT_REAL*) inarray;
+    else
+        p->treePtrs[p->depth] = (LTFAT_REAL*) inarray;
     p->is_complexinput = 1;
 
     return LTFAT_NAME(maxtree_updaterange)(p, 0, p->L);
@@ -149,7 +216,10 @@ LTFAT_API int
 LTFAT_NAME(maxtree_reset)(
     LTFAT_NAME(maxtree)* p, const LTFAT_REAL inarray[])
 {
-    p->treePtrs[p->depth] = (LTFAT_REAL*) inarray;
+    if (p->is_flat)
+        p->pointedarray = (LTFAT_REAL*) inarray;
+    else
+        p->treePtrs[p->depth] = (LTFAT_REAL*) inarray;
     p->is_complexinput = 0;
 
     return LTFAT_NAME(maxtree_updaterange)(p, 0, p->L);
@@ -186,10 +256,118 @@ LTFAT_NAME(maxtree_updatedirty)(LTFAT_NAME(maxtree)* p)
     return ret;
 }
 
+/* Returns index of the first maximum of the LTFAT_MAXTREE_FANOUT values,
+ * the first n of which are not padding */
+static inline ltfat_int
+LTFAT_NAME(maxtree_flat_nodemax)(const LTFAT_REAL* v, ltfat_int n,
+                                 LTFAT_REAL* max)
+{
+    LTFAT_REAL m;
+    ltfat_int j = 0;
+#ifdef LTFAT_SIMD
+    LTFAT_REAL lanes[2 * LTFAT_SIMD_VL];
+    ltfat_simd_v vm = V_LOAD(v);
+    for (ltfat_int l = 2 * LTFAT_SIMD_VL; l < LTFAT_MAXTREE_FANOUT;
+         l += 2 * LTFAT_SIMD_VL)
+        vm = V_MAX(vm, V_LOAD(v + l));
+
+    V_STORE(lanes, vm);
+    m = lanes[0];
+    for (ltfat_int l = 1; l < 2 * LTFAT_SIMD_VL; l++)
+        if (lanes[l] > m) m = lanes[l];
+#else
+    m = v[0];
+    for (ltfat_int l = 1; l < LTFAT_MAXTREE_FANOUT; l++)
+        if (v[l] > m) m = v[l];
+#endif
+    // Nothing compares equal to NaN and the padding can win over it, the
+    // first value is reported then
+    while (j < n && v[j] != m) j++;
+    if (j == n) j = 0;
+
+    *max = m;
+    return j;
+}
+
+static inline LTFAT_REAL
+LTFAT_NAME(maxtree_flat_leaf)(LTFAT_NAME(maxtree)* p, ltfat_int l)
+{
+    const LTFAT_REAL* in = p->pointedarray;
+
+    if (!p->is_complexinput)
+        return in[l];
+    else if (p->callback)
+        return p->callback(p->userdata, ((const LTFAT_COMPLEX*)in)[l], l);
+    else
+        return in[2 * l] * in[2 * l] + in[2 * l + 1] * in[2 * l + 1];
+}
+
+static int
+LTFAT_NAME(maxtree_flat_updaterange)(LTFAT_NAME(maxtree)* p, ltfat_int start,
+                                     ltfat_int end)
+{
+    ltfat_int D = LTFAT_MAXTREE_FANOUT;
+    ltfat_int len; // Number of values of the level being read
+    LTFAT_REAL leaves[LTFAT_MAXTREE_FANOUT];
+
+    if (end > p->Lstep)
+        LTFAT_NAME(maxtree_flat_updaterange)( p, 0, end - p->Lstep);
+
+    if (end > p->L) end = p->L;
+    if (start >= end || p->flatLevels == 0) return 0;
+
+    // The first level reads the leaves directly from the input
+    start = start / D; end = (end - 1) / D + 1;
+
+    for (ltfat_int n = start; n < end; n++)
+    {
+        const LTFAT_REAL* v = leaves;
+        ltfat_int lstart = n * D;
+        ltfat_int lno = ltfat_imin(D, p->L - lstart);
+
+        if (!p->is_complexinput && lno == D)
+            v = p->pointedarray + lstart;
+        else
+        {
+            for (ltfat_int l = 0; l < lno; l++)
+                leaves[l] = LTFAT_NAME(maxtree_flat_leaf)(p, lstart + l);
+            for (ltfat_int l = lno; l < D; l++)
+                leaves[l] = (LTFAT_REAL) -HUGE_VAL;
+        }
+
+        p->flatPos[n] = lstart +
+            LTFAT_NAME(maxtree_flat_nodemax)(v, lno, &p->flatVals[n]);
+    }
+
+    len = ltfat_idivceil(p->L, D);
+
+    for (ltfat_int k = 1; k < p->flatLevels; k++)
+    {
+        const LTFAT_REAL* vals = p->flatVals + p->flatOff[k - 1];
+        const ltfat_int* pos = p->flatPos + p->flatOff[k - 1];
+        LTFAT_REAL* valsnext = p->flatVals + p->flatOff[k];
+        ltfat_int* posnext = p->flatPos + p->flatOff[k];
+
+        start = start / D; end = (end - 1) / D + 1;
+
+        for (ltfat_int n = start; n < end; n++)
+            posnext[n] = pos[n * D +
+                LTFAT_NAME(maxtree_flat_nodemax)(vals + n * D,
+                        ltfat_imin(D, len - n * D), &valsnext[n])];
+
+        len = ltfat_idivceil(len, D);
+    }
+
+    return 0;
+}
+
 int
 LTFAT_NAME(maxtree_updaterange)(LTFAT_NAME(maxtree)* p, ltfat_int start,
                                 ltfat_int end)
 {
+    if (p->is_flat)
+        return LTFAT_NAME(maxtree_flat_updaterange)(p, start, end);
+
     if (p->depth == 0) return 0;
 
     if (end > p->Lstep)
@@ -315,6 +493,20 @@ LTFAT_NAME(maxtree_findmax)(LTFAT_NAME(maxtree)* p, LTFAT_REAL* max,
 {
     LTFAT_NAME(maxtree_updatedirty)(p);
 
+    if (p->is_flat)
+    {
+        if (p->flatLevels == 0)
+        {
+            *max = LTFAT_NAME(maxtree_flat_leaf)(p, 0);
+            *maxPos = 0;
+            return 0;
+        }
+
+        *max = p->flatVals[p->flatOff[p->flatLevels - 1]];
+        *maxPos = p->flatPos[p->flatOff[p->flatLevels - 1]];
+        return 0;
+    }
+
     if(  p->is_complexinput && p->depth == 0 )
     {
         LTFAT_COMPLEX* toplevel = (LTFAT_COMPLEX*)p->treePtrs[0];
@@ -7,12 +7,110 @@
 #endif
 
 #include <stdlib.h>
+#include <stdio.h>
+#include "rtsafe_private.h"
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#endif
 /* #include "ltfat/macros.h" */
 
 
 void* (*ltfat_custom_malloc)(size_t) = NULL;
 void (*ltfat_custom_free)(void*) = NULL;
 
+#if defined(__cplusplus) && __cplusplus >= 201103L
+#define LTFAT_THREADLOCAL thread_local
+#elif defined(_MSC_VER)
+#define LTFAT_THREADLOCAL __declspec(thread)
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define LTFAT_THREADLOCAL _Thread_local
+#else
+#define LTFAT_THREADLOCAL __thread
+#endif
+
+static volatile ltfat_rtsafe_policy rtsafe_policy = ltfat_rtsafe_off;
+static volatile size_t rtsafe_violations = 0;
+static LTFAT_THREADLOCAL int rtsafe_depth = 0;
+
+void
+ltfat_rtsafe_enter(void)
+{
+    rtsafe_depth++;
+}
+
+void
+ltfat_rtsafe_leave(void)
+{
+    rtsafe_depth--;
+}
+
+int
+ltfat_rtsafe_inside(void)
+{
+    return rtsafe_depth > 0;
+}
+
+/* fmt has a single %s for what */
+static void
+ltfat_rtsafe_check(const char* fmt, const char* what)
+{
+    if (rtsafe_depth <= 0)
+        return;
+
+    switch (rtsafe_policy)
+    {
+    case ltfat_rtsafe_off:
+        break;
+    case ltfat_rtsafe_count:
+#if defined(_MSC_VER)
+        InterlockedIncrementSizeT(&rtsafe_violations);
+#else
+        __atomic_fetch_add(&rtsafe_violations, 1, __ATOMIC_RELAXED);
+#endif
+        break;
+    case ltfat_rtsafe_abort:
+        fprintf(stderr, "[ERROR]: libltfat: ");
+        fprintf(stderr, fmt, what);
+        fprintf(stderr, " from a real-time execute function\n");
+        abort();
+    }
+}
+
+void
+ltfat_rtsafe_blocking(const char* what)
+{
+    ltfat_rtsafe_check("blocking on %s", what);
+}
+
+LTFAT_API ltfat_rtsafe_policy
+ltfat_rtsafe_setpolicy(ltfat_rtsafe_policy policy)
+{
+    ltfat_rtsafe_policy old = rtsafe_policy;
+    rtsafe_policy = policy;
+    return old;
+}
+
+LTFAT_API size_t
+ltfat_rtsafe_getviolations(void)
+{
+#if defined(_MSC_VER)
+    return rtsafe_violations;
+#else
+    return __atomic_load_n(&rtsafe_violations, __ATOMIC_RELAXED);
+#endif
+}
+
+LTFAT_API void
+ltfat_rtsafe_resetviolations(void)
+{
+#if defined(_MSC_VER)
+    rtsafe_violations = 0;
+#else
+    __atomic_store_n(&rtsafe_violations, 0, __ATOMIC_RELAXED);
+#endif
+}
+
 ltfat_memory_handler_t
 ltfat_set_memory_handler (ltfat_memory_handler_t new_handler)
 {
@@ -23,7 +121,7 @@ ltfat_set_memory_handler (ltfat_memory_handler_t new_handler)
     return retVal;
 }
 
-#ifdef KISS
+#if defined(KISS) || defined(NATIVEFFT)
 #define ALIGNBOUNDARY 64
 
 static void*
@@ -50,15 +148,17 @@ ltfat_malloc (size_t n)
 {
     void* outp;
 
+    ltfat_rtsafe_check("%s called", "ltfat_malloc");
+
     if (ltfat_custom_malloc)
         outp = (*ltfat_custom_malloc)(n);
     else
 #ifdef FFTW
         outp = LTFAT_FFTW(malloc)(n);
-#elif KISS
+#elif defined(KISS) || defined(NATIVEFFT)
         outp = ltfat_aligned_malloc(n);
 #else
-#error "No FFT backend specified. Use -DKISS or -DFFTW"
+#error "No FFT backend specified. Use -DKISS, -DNATIVEFFT or -DFFTW"
 #endif
     return outp;
 }
@@ -113,12 +213,14 @@ ltfat_calloc (size_t nmemb, size_t size)
 LTFAT_API void
 ltfat_free(const void* ptr)
 {
+    ltfat_rtsafe_check("%s called", "ltfat_free");
+
     if (ltfat_custom_free)
         (*ltfat_custom_free)((void*)ptr);
     else
 #ifdef FFTW
         LTFAT_FFTW(free)((void*)ptr);
-#elif KISS
+#elif defined(KISS) || defined(NATIVEFFT)
         ltfat_aligned_free((void*)ptr);
 #endif
 }
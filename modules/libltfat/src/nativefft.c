@@ -0,0 +1,606 @@
+#include "ltfat.h"
+#include "ltfat/types.h"
+#include "ltfat/macros.h"
+#include "nativefft_private.h"
+#include "simd_private.h"
+
+/*
+ * Mixed-radix Stockham autosort FFT with radix 4, 2, 3, 5 kernels and
+ * a generic kernel for other small odd primes. Lengths containing a prime
+ * factor larger than NATIVEFFT_MAXRADIX are done using Bluestein's
+ * algorithm with power-of-two sub-transforms.
+ *
+ * The vector kernels are selected at compile time according to the
+ * instruction set the compiler targets (see simd_private.h). The loop over
+ * the stride is vectorized, the remainder (and the very first stage,
+ * which has a unit stride) is done using the scalar kernels.
+ */
+
+#ifndef NATIVEFFT_MAXRADIX
+#define NATIVEFFT_MAXRADIX 61
+#endif
+
+#define NATIVEFFT_MAXSTAGES 64
+
+/* Scalar "vector" holding a single complex number */
+typedef struct
+{
+    LTFAT_REAL re;
+    LTFAT_REAL im;
+} LTFAT_NAME(nativefft_s);
+
+static inline LTFAT_NAME(nativefft_s)
+LTFAT_NAME(nativefft_s_pair)(LTFAT_REAL re, LTFAT_REAL im)
+{
+    LTFAT_NAME(nativefft_s) c; c.re = re; c.im = im; return c;
+}
+
+static inline LTFAT_NAME(nativefft_s)
+LTFAT_NAME(nativefft_s_load)(const LTFAT_REAL* p)
+{
+    return LTFAT_NAME(nativefft_s_pair)(p[0], p[1]);
+}
+
+static inline void
+LTFAT_NAME(nativefft_s_store)(LTFAT_REAL* p, LTFAT_NAME(nativefft_s) a)
+{
+    p[0] = a.re; p[1] = a.im;
+}
+
+static inline LTFAT_NAME(nativefft_s)
+LTFAT_NAME(nativefft_s_add)(LTFAT_NAME(nativefft_s) a, LTFAT_NAME(nativefft_s) b)
+{
+    return LTFAT_NAME(nativefft_s_pair)(a.re + b.re, a.im + b.im);
+}
+
+static inline LTFAT_NAME(nativefft_s)
+LTFAT_NAME(nativefft_s_sub)(LTFAT_NAME(nativefft_s) a, LTFAT_NAME(nativefft_s) b)
+{
+    return LTFAT_NAME(nativefft_s_pair)(a.re - b.re, a.im - b.im);
+}
+
+static inline LTFAT_NAME(nativefft_s)
+LTFAT_NAME(nativefft_s_mul)(LTFAT_NAME(nativefft_s) a, LTFAT_NAME(nativefft_s) b)
+{
+    return LTFAT_NAME(nativefft_s_pair)(a.re * b.re, a.im * b.im);
+}
+
+static inline LTFAT_NAME(nativefft_s)
+LTFAT_NAME(nativefft_s_swap)(LTFAT_NAME(nativefft_s) a)
+{
+    return LTFAT_NAME(nativefft_s_pair)(a.im, a.re);
+}
+
+/****** KERNELS ******/
+#define VT LTFAT_NAME(nativefft_s)
+#define VL 1
+#define VLOAD(p) LTFAT_NAME(nativefft_s_load)(p)
+#define VSTORE(p, a) LTFAT_NAME(nativefft_s_store)((p), (a))
+#define VADD(a, b) LTFAT_NAME(nativefft_s_add)((a), (b))
+#define VSUB(a, b) LTFAT_NAME(nativefft_s_sub)((a), (b))
+#define VMUL(a, b) LTFAT_NAME(nativefft_s_mul)((a), (b))
+#define VSWAP(a) LTFAT_NAME(nativefft_s_swap)(a)
+#define VPAIR(r, i) LTFAT_NAME(nativefft_s_pair)((r), (i))
+#define VSET1(a) LTFAT_NAME(nativefft_s_pair)((a), (a))
+#define KNAME(name) LTFAT_NAME(nativefft_s_ ## name)
+#include "nativefft_kernels_private.h"
+#undef VT
+#undef VL
+#undef VLOAD
+#undef VSTORE
+#undef VADD
+#undef VSUB
+#undef VMUL
+#undef VSWAP
+#undef VPAIR
+#undef VSET1
+#undef KNAME
+
+#ifdef LTFAT_SIMD
+#define VT ltfat_simd_v
+#define VL LTFAT_SIMD_VL
+#define VLOAD(p) V_LOAD(p)
+#define VSTORE(p, a) V_STORE((p), (a))
+#define VADD(a, b) V_ADD((a), (b))
+#define VSUB(a, b) V_SUB((a), (b))
+#define VMUL(a, b) V_MUL((a), (b))
+#define VSWAP(a) V_SWAP(a)
+#define VPAIR(r, i) V_PAIR((r), (i))
+#define VSET1(a) V_SET1(a)
+#define KNAME(name) LTFAT_NAME(nativefft_v_ ## name)
+#include "nativefft_kernels_private.h"
+#undef VT
+#undef VL
+#undef VLOAD
+#undef VSTORE
+#undef VADD
+#undef VSUB
+#undef VMUL
+#undef VSWAP
+#undef VPAIR
+#undef VSET1
+#undef KNAME
+#endif
+
+/****** COMPLEX FFT ******/
+struct LTFAT_NAME(nativefft_plan)
+{
+    ltfat_int N;
+    int inverse;
+    int nstages;
+    ltfat_int radix[NATIVEFFT_MAXSTAGES];
+    ltfat_int twoff[NATIVEFFT_MAXSTAGES];
+    ltfat_int rtoff[NATIVEFFT_MAXSTAGES];
+    LTFAT_REAL* tw;
+    LTFAT_REAL* rt;
+    /* Bluestein */
+    ltfat_int Nb;
+    LTFAT_NAME(nativefft_plan)* bfwd;
+    LTFAT_NAME(nativefft_plan)* binv;
+    LTFAT_REAL* chirp;
+    LTFAT_REAL* filt;
+};
+
+/* Returns 0 if N has a prime factor larger than NATIVEFFT_MAXRADIX */
+static int
+LTFAT_NAME(nativefft_factorize)(ltfat_int N, ltfat_int radix[], int* nstages)
+{
+    ltfat_int n = N;
+    int S = 0;
+
+    while (n % 4 == 0) { radix[S++] = 4; n /= 4; }
+    while (n % 2 == 0) { radix[S++] = 2; n /= 2; }
+    for (ltfat_int f = 3; f <= NATIVEFFT_MAXRADIX && n > 1; f += 2)
+        while (n % f == 0) { radix[S++] = f; n /= f; }
+
+    *nstages = S;
+    return n == 1;
+}
+
+static int
+LTFAT_NAME(nativefft_init_bluestein)(LTFAT_NAME(nativefft_plan)* p)
+{
+    ltfat_int N = p->N, Nb = 1;
+    ltfat_int sq = 0;
+    LTFAT_REAL* work = NULL;
+    double dir = p->inverse ? -1.0 : 1.0;
+    int status = LTFATERR_SUCCESS;
+
+    while (Nb < 2 * N - 1) Nb *= 2;
+    p->Nb = Nb;
+
+    CHECKSTATUS( LTFAT_NAME(nativefft_init)(Nb, 0, &p->bfwd));
+    CHECKSTATUS( LTFAT_NAME(nativefft_init)(Nb, 1, &p->binv));
+    CHECKMEM( p->chirp = LTFAT_NAME_REAL(malloc)(2 * N));
+    CHECKMEM( p->filt = LTFAT_NAME_REAL(calloc)(2 * Nb));
+    CHECKMEM( work = LTFAT_NAME_REAL(malloc)(
+                         LTFAT_NAME(nativefft_worksize)(p->bfwd)));
+
+    /* chirp[n] = exp(-+i*pi*n^2/N), n^2 is kept modulo 2N */
+    for (ltfat_int n = 0; n < N; n++)
+    {
+        double ang = -dir * M_PI * (double) sq / (double) N;
+        p->chirp[2 * n] = (LTFAT_REAL) cos(ang);
+        p->chirp[2 * n + 1] = (LTFAT_REAL) sin(ang);
+        sq += 2 * n + 1;
+        if (sq >= 2 * N) sq -= 2 * N;
+    }
+
+    /* Conjugated chirp wrapped around, transformed and normalized */
+    for (ltfat_int n = 0; n < N; n++)
+    {
+        p->filt[2 * n] = p->chirp[2 * n];
+        p->filt[2 * n + 1] = -p->chirp[2 * n + 1];
+        if (n > 0)
+        {
+            p->filt[2 * (Nb - n)] = p->chirp[2 * n];
+            p->filt[2 * (Nb - n) + 1] = -p->chirp[2 * n + 1];
+        }
+    }
+
+    LTFAT_NAME(nativefft_execute)(p->bfwd, p->filt, p->filt, work);
+
+    for (ltfat_int n = 0; n < 2 * Nb; n++)
+        p->filt[n] /= (LTFAT_REAL) Nb;
+
+error:
+    ltfat_safefree(work);
+    return status;
+}
+
+int
+LTFAT_NAME(nativefft_init)(ltfat_int N, int inverse,
+                           LTFAT_NAME(nativefft_plan)** p)
+{
+    LTFAT_NAME(nativefft_plan)* pp = NULL;
+    ltfat_int twlen = 0, rtlen = 0, n;
+    double dir = inverse ? -1.0 : 1.0;
+    int status = LTFATERR_SUCCESS;
+
+    CHECKNULL(p);
+    CHECK(LTFATERR_NOTPOSARG, N > 0, "N must be positive");
+
+    CHECKMEM( pp = LTFAT_NEW(LTFAT_NAME(nativefft_plan)) );
+    pp->N = N; pp->inverse = inverse;
+
+    if (!LTFAT_NAME(nativefft_factorize)(N, pp->radix, &pp->nstages))
+    {
+        pp->nstages = 0;
+        CHECKSTATUS( LTFAT_NAME(nativefft_init_bluestein)(pp));
+        *p = pp;
+        return status;
+    }
+
+    for (int i = 0; i < pp->nstages; i++)
+    {
+        pp->twoff[i] = twlen;
+        pp->rtoff[i] = rtlen;
+        twlen += 2 * (N - N / pp->radix[i]);
+        N /= pp->radix[i];
+        if (pp->radix[i] > 5)
+            rtlen += 2 * pp->radix[i];
+    }
+    N = pp->N;
+
+    if (twlen > 0)
+        CHECKMEM( pp->tw = LTFAT_NAME_REAL(malloc)(twlen));
+    if (rtlen > 0)
+        CHECKMEM( pp->rt = LTFAT_NAME_REAL(malloc)(rtlen));
+
+    /* Twiddle factors w^(p*j), w = exp(-+2*pi*i/n), p < m, 0 < j < r */
+    n = N;
+    for (int i = 0; i < pp->nstages; i++)
+    {
+        ltfat_int r = pp->radix[i], m = n / r;
+        LTFAT_REAL* tw = pp->tw + pp->twoff[i];
+
+        for (ltfat_int pi = 0; pi < m; pi++)
+            for (ltfat_int j = 1; j < r; j++)
+            {
+                double ang = -dir * 2.0 * M_PI * (double)((pi * j) % n) / (double) n;
+                *tw++ = (LTFAT_REAL) cos(ang);
+                *tw++ = (LTFAT_REAL) sin(ang);
+            }
+
+        if (r > 5)
+        {
+            LTFAT_REAL* rt = pp->rt + pp->rtoff[i];
+            for (ltfat_int t = 0; t < r; t++)
+            {
+                rt[2 * t] = (LTFAT_REAL) cos(2.0 * M_PI * (double) t / (double) r);
+                rt[2 * t + 1] = (LTFAT_REAL) sin(2.0 * M_PI * (double) t / (double) r);
+            }
+        }
+        n = m;
+    }
+
+    *p = pp;
+    return status;
+error:
+    if (pp) LTFAT_NAME(nativefft_done)(&pp);
+    if (p) *p = NULL;
+    return status;
+}
+
+ltfat_int
+LTFAT_NAME(nativefft_worksize)(const LTFAT_NAME(nativefft_plan)* p)
+{
+    return p->bfwd ? 4 * p->Nb : 2 * p->N;
+}
+
+static void
+LTFAT_NAME(nativefft_stage)(const LTFAT_NAME(nativefft_plan)* p, int i,
+                            const LTFAT_REAL* x, LTFAT_REAL* y,
+                            ltfat_int s, ltfat_int m)
+{
+    ltfat_int r = p->radix[i];
+    const LTFAT_REAL* tw = p->tw + p->twoff[i];
+    const LTFAT_REAL* rt = p->rt ? p->rt + p->rtoff[i] : NULL;
+    LTFAT_REAL dir = p->inverse ? -1 : 1;
+    ltfat_int qv = 0;
+
+#ifdef LTFAT_SIMD
+    qv = s - s % LTFAT_SIMD_VL;
+    if (qv > 0)
+    {
+        switch (r)
+        {
+        case 2: LTFAT_NAME(nativefft_v_radix2)(x, y, s, m, tw, dir, 0); break;
+        case 3: LTFAT_NAME(nativefft_v_radix3)(x, y, s, m, tw, dir, 0); break;
+        case 4: LTFAT_NAME(nativefft_v_radix4)(x, y, s, m, tw, dir, 0); break;
+        case 5: LTFAT_NAME(nativefft_v_radix5)(x, y, s, m, tw, dir, 0); break;
+        default:
+            LTFAT_NAME(nativefft_v_radixg)(x, y, s, m, r, tw, rt, dir, 0);
+        }
+    }
+#endif
+
+    if (qv < s)
+    {
+        switch (r)
+        {
+        case 2: LTFAT_NAME(nativefft_s_radix2)(x, y, s, m, tw, dir, qv); break;
+        case 3: LTFAT_NAME(nativefft_s_radix3)(x, y, s, m, tw, dir, qv); break;
+        case 4: LTFAT_NAME(nativefft_s_radix4)(x, y, s, m, tw, dir, qv); break;
+        case 5: LTFAT_NAME(nativefft_s_radix5)(x, y, s, m, tw, dir, qv); break;
+        default:
+            LTFAT_NAME(nativefft_s_radixg)(x, y, s, m, r, tw, rt, dir, qv);
+        }
+    }
+}
+
+static void
+LTFAT_NAME(nativefft_execute_bluestein)(const LTFAT_NAME(nativefft_plan)* p,
+                                        const LTFAT_REAL* in, LTFAT_REAL* out,
+                                        LTFAT_REAL* work)
+{
+    ltfat_int N = p->N, Nb = p->Nb;
+    const LTFAT_REAL* c = p->chirp;
+    const LTFAT_REAL* h = p->filt;
+    LTFAT_REAL* a = work;
+
+    for (ltfat_int n = 0; n < N; n++)
+    {
+        LTFAT_REAL re = in[2 * n], im = in[2 * n + 1];
+        a[2 * n] = re * c[2 * n] - im * c[2 * n + 1];
+        a[2 * n + 1] = re * c[2 * n + 1] + im * c[2 * n];
+    }
+    memset(a + 2 * N, 0, 2 * (Nb - N) * sizeof * a);
+
+    LTFAT_NAME(nativefft_execute)(p->bfwd, a, a, work + 2 * Nb);
+
+    for (ltfat_int n = 0; n < Nb; n++)
+    {
+        LTFAT_REAL re = a[2 * n], im = a[2 * n + 1];
+        a[2 * n] = re * h[2 * n] - im * h[2 * n + 1];
+        a[2 * n + 1] = re * h[2 * n + 1] + im * h[2 * n];
+    }
+
+    LTFAT_NAME(nativefft_execute)(p->binv, a, a, work + 2 * Nb);
+
+    for (ltfat_int n = 0; n < N; n++)
+    {
+        LTFAT_REAL re = a[2 * n], im = a[2 * n + 1];
+        out[2 * n] = re * c[2 * n] - im * c[2 * n + 1];
+        out[2 * n + 1] = re * c[2 * n + 1] + im * c[2 * n];
+    }
+}
+
+void
+LTFAT_NAME(nativefft_execute)(const LTFAT_NAME(nativefft_plan)* p,
+                              const LTFAT_REAL* in, LTFAT_REAL* out,
+                              LTFAT_REAL* work)
+{
+    const LTFAT_REAL* src = in;
+    ltfat_int s = 1, m = p->N;
+    int S = p->nstages;
+
+    if (p->bfwd)
+    {
+        LTFAT_NAME(nativefft_execute_bluestein)(p, in, out, work);
+        return;
+    }
+
+    if (S == 0)
+    {
+        if (in != out) memcpy(out, in, 2 * p->N * sizeof * out);
+        return;
+    }
+
+    /* Ping-pong between out and work such that the last stage ends in out */
+    if (in == out && S % 2)
+    {
+        memcpy(work, in, 2 * p->N * sizeof * work);
+        src = work;
+    }
+
+    for (int i = 0; i < S; i++)
+    {
+        LTFAT_REAL* dst = (S - 1 - i) % 2 ? work : out;
+        m /= p->radix[i];
+        LTFAT_NAME(nativefft_stage)(p, i, src, dst, s, m);
+        src = dst;
+        s *= p->radix[i];
+    }
+}
+
+int
+LTFAT_NAME(nativefft_done)(LTFAT_NAME(nativefft_plan)** p)
+{
+    LTFAT_NAME(nativefft_plan)* pp;
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(p); CHECKNULL(*p);
+    pp = *p;
+    ltfat_safefree(pp->tw);
+    ltfat_safefree(pp->rt);
+    ltfat_safefree(pp->chirp);
+    ltfat_safefree(pp->filt);
+    if (pp->bfwd) LTFAT_NAME(nativefft_done)(&pp->bfwd);
+    if (pp->binv) LTFAT_NAME(nativefft_done)(&pp->binv);
+    ltfat_free(pp);
+    *p = NULL;
+error:
+    return status;
+}
+
+/****** REAL FFT ******/
+/*
+ * Even N is done using a complex FFT of length N/2 of the even and odd
+ * samples packed as real and imaginary parts, followed (or preceded for
+ * the inverse) by a split step. Odd N uses a full complex FFT.
+ */
+struct LTFAT_NAME(nativefftreal_plan)
+{
+    ltfat_int N;
+    int inverse;
+    LTFAT_NAME(nativefft_plan)* cplan;
+    LTFAT_REAL* tw;
+};
+
+int
+LTFAT_NAME(nativefftreal_init)(ltfat_int N, int inverse,
+                               LTFAT_NAME(nativefftreal_plan)** p)
+{
+    LTFAT_NAME(nativefftreal_plan)* pp = NULL;
+    int status = LTFATERR_SUCCESS;
+
+    CHECKNULL(p);
+    CHECK(LTFATERR_NOTPOSARG, N > 0, "N must be positive");
+
+    CHECKMEM( pp = LTFAT_NEW(LTFAT_NAME(nativefftreal_plan)) );
+    pp->N = N; pp->inverse = inverse;
+
+    if (N % 2)
+    {
+        CHECKSTATUS( LTFAT_NAME(nativefft_init)(N, inverse, &pp->cplan));
+    }
+    else
+    {
+        ltfat_int n = N / 2;
+        CHECKSTATUS( LTFAT_NAME(nativefft_init)(n, inverse, &pp->cplan));
+        CHECKMEM( pp->tw = LTFAT_NAME_REAL(malloc)(2 * (n / 2 + 1)));
+
+        /* exp(-2*pi*i*k/N) */
+        for (ltfat_int k = 0; k <= n / 2; k++)
+        {
+            double ang = -2.0 * M_PI * (double) k / (double) N;
+            pp->tw[2 * k] = (LTFAT_REAL) cos(ang);
+            pp->tw[2 * k + 1] = (LTFAT_REAL) sin(ang);
+        }
+    }
+
+    *p = pp;
+    return status;
+error:
+    if (pp) LTFAT_NAME(nativefftreal_done)(&pp);
+    if (p) *p = NULL;
+    return status;
+}
+
+ltfat_int
+LTFAT_NAME(nativefftreal_worksize)(const LTFAT_NAME(nativefftreal_plan)* p)
+{
+    ltfat_int cwork = LTFAT_NAME(nativefft_worksize)(p->cplan);
+
+    if (p->N % 2)
+        return 2 * p->N + cwork;
+
+    return p->inverse ? p->N + cwork : cwork;
+}
+
+static void
+LTFAT_NAME(nativefftreal_forward_even)(const LTFAT_NAME(nativefftreal_plan)* p,
+                                       const LTFAT_REAL* in, LTFAT_REAL* out,
+                                       LTFAT_REAL* work)
+{
+    ltfat_int n = p->N / 2;
+    const LTFAT_REAL* tw = p->tw;
+
+    LTFAT_NAME(nativefft_execute)(p->cplan, in, out, work);
+
+    for (ltfat_int k = 0; k <= n / 2; k++)
+    {
+        LTFAT_REAL* zk = out + 2 * k;
+        LTFAT_REAL* znk = out + 2 * (n - k);
+        LTFAT_REAL zr = zk[0], zi = zk[1];
+        LTFAT_REAL znr = k ? znk[0] : zr, zni = k ? znk[1] : zi;
+        LTFAT_REAL er = (zr + znr) / 2, ei = (zi - zni) / 2;
+        LTFAT_REAL odr = (zi + zni) / 2, odi = (znr - zr) / 2;
+        LTFAT_REAL tr = tw[2 * k] * odr - tw[2 * k + 1] * odi;
+        LTFAT_REAL ti = tw[2 * k] * odi + tw[2 * k + 1] * odr;
+
+        if (k != n - k)
+        {
+            znk[0] = er - tr;
+            znk[1] = ti - ei;
+        }
+        zk[0] = er + tr;
+        zk[1] = ei + ti;
+    }
+}
+
+static void
+LTFAT_NAME(nativefftreal_inverse_even)(const LTFAT_NAME(nativefftreal_plan)* p,
+                                       const LTFAT_REAL* in, LTFAT_REAL* out,
+                                       LTFAT_REAL* work)
+{
+    ltfat_int n = p->N / 2;
+    const LTFAT_REAL* tw = p->tw;
+
+    for (ltfat_int k = 0; k <= n / 2; k++)
+    {
+        const LTFAT_REAL* xk = in + 2 * k;
+        const LTFAT_REAL* xnk = in + 2 * (n - k);
+        LTFAT_REAL er = xk[0] + xnk[0], ei = xk[1] - xnk[1];
+        LTFAT_REAL dr = xk[0] - xnk[0], di = xk[1] + xnk[1];
+        LTFAT_REAL odr = dr * tw[2 * k] + di * tw[2 * k + 1];
+        LTFAT_REAL odi = di * tw[2 * k] - dr * tw[2 * k + 1];
+
+        work[2 * k] = er - odi;
+        work[2 * k + 1] = ei + odr;
+        if (k != 0 && k != n - k)
+        {
+            work[2 * (n - k)] = er + odi;
+            work[2 * (n - k) + 1] = odr - ei;
+        }
+    }
+
+    LTFAT_NAME(nativefft_execute)(p->cplan, work, out, work + 2 * n);
+}
+
+void
+LTFAT_NAME(nativefftreal_execute)(const LTFAT_NAME(nativefftreal_plan)* p,
+                                  const LTFAT_REAL* in, LTFAT_REAL* out,
+                                  LTFAT_REAL* work)
+{
+    ltfat_int N = p->N;
+    ltfat_int M2 = N / 2 + 1;
+
+    if (N % 2 == 0)
+    {
+        if (p->inverse)
+            LTFAT_NAME(nativefftreal_inverse_even)(p, in, out, work);
+        else
+            LTFAT_NAME(nativefftreal_forward_even)(p, in, out, work);
+    }
+    else if (!p->inverse)
+    {
+        for (ltfat_int l = 0; l < N; l++)
+        {
+            work[2 * l] = in[l];
+            work[2 * l + 1] = 0;
+        }
+
+        LTFAT_NAME(nativefft_execute)(p->cplan, work, work, work + 2 * N);
+        memcpy(out, work, 2 * M2 * sizeof * out);
+    }
+    else
+    {
+        memcpy(work, in, 2 * M2 * sizeof * work);
+        for (ltfat_int k = 1; k < M2; k++)
+        {
+            work[2 * (N - k)] = in[2 * k];
+            work[2 * (N - k) + 1] = -in[2 * k + 1];
+        }
+
+        LTFAT_NAME(nativefft_execute)(p->cplan, work, work, work + 2 * N);
+
+        for (ltfat_int l = 0; l < N; l++)
+            out[l] = work[2 * l];
+    }
+}
+
+int
+LTFAT_NAME(nativefftreal_done)(LTFAT_NAME(nativefftreal_plan)** p)
+{
+    LTFAT_NAME(nativefftreal_plan)* pp;
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(p); CHECKNULL(*p);
+    pp = *p;
+    if (pp->cplan) LTFAT_NAME(nativefft_done)(&pp->cplan);
+    ltfat_safefree(pp->tw);
+    ltfat_free(pp);
+    *p = NULL;
+error:
+    return status;
+}
@@ -0,0 +1,223 @@
+/*
+ * Radix stage kernels of the native FFT.
+ *
+ * This file is included several times from nativefft.c, once for each
+ * vector type. The including file defines
+ *
+ *   VT           vector type holding VL interleaved complex numbers
+ *   VLOAD, VSTORE          unaligned load and store
+ *   VADD, VSUB, VMUL       elementwise arithmetic
+ *   VSWAP(a)     swaps real and imaginary parts of each complex number
+ *   VPAIR(r,i)   (r,i,r,i,...)
+ *   VSET1(a)     (a,a,a,a,...)
+ *   KNAME(name)  name of the kernel
+ *
+ * A stage with radix r reads sequences of length n = r*m with stride s
+ * and writes them with stride r*s (Stockham autosort):
+ *
+ *   y[q + s*(r*p + j)] = w^(p*j) * sum_k x[q + s*(p + k*m)] * e^(-+2*pi*i*j*k/r)
+ *
+ * where w = e^(-+2*pi*i/n). The kernels process q in [q0, s) in steps of VL.
+ * tw holds the (r-1) twiddle factors for each p and dir is 1 for the
+ * forward and -1 for the inverse transform.
+ */
+
+/* a * (wr + i*wi), where wrv = VSET1(wr) and wiv = VPAIR(-wi, wi) */
+#define TWMUL(a, wrv, wiv) VADD(VMUL((a), (wrv)), VMUL(VSWAP(a), (wiv)))
+/* a * (-i) for the forward and a * i for the inverse transform */
+#define ROT(a) VMUL(VSWAP(a), rotv)
+#define LOADTW(j) \
+    const VT w##j##r = VSET1(twp[2 * (j - 1)]); \
+    const VT w##j##i = VPAIR(-twp[2 * (j - 1) + 1], twp[2 * (j - 1) + 1]);
+
+static void
+KNAME(radix2)(const LTFAT_REAL* x, LTFAT_REAL* y, ltfat_int s, ltfat_int m,
+              const LTFAT_REAL* tw, LTFAT_REAL UNUSED(dir), ltfat_int q0)
+{
+    for (ltfat_int p = 0; p < m; p++)
+    {
+        const LTFAT_REAL* twp = tw + 2 * p;
+        const LTFAT_REAL* x0 = x + 2 * s * p;
+        const LTFAT_REAL* x1 = x0 + 2 * s * m;
+        LTFAT_REAL* y0 = y + 4 * s * p;
+        LTFAT_REAL* y1 = y0 + 2 * s;
+        LOADTW(1)
+
+        for (ltfat_int q = 2 * q0; q + 2 * VL <= 2 * s; q += 2 * VL)
+        {
+            VT a0 = VLOAD(x0 + q), a1 = VLOAD(x1 + q);
+            VSTORE(y0 + q, VADD(a0, a1));
+            VSTORE(y1 + q, TWMUL(VSUB(a0, a1), w1r, w1i));
+        }
+    }
+}
+
+static void
+KNAME(radix3)(const LTFAT_REAL* x, LTFAT_REAL* y, ltfat_int s, ltfat_int m,
+              const LTFAT_REAL* tw, LTFAT_REAL dir, ltfat_int q0)
+{
+    const VT rotv = VPAIR(dir, -dir);
+    const VT c = VSET1((LTFAT_REAL) - 0.5);
+    const VT sn = VSET1((LTFAT_REAL) 0.86602540378443864676);
+
+    for (ltfat_int p = 0; p < m; p++)
+    {
+        const LTFAT_REAL* twp = tw + 4 * p;
+        const LTFAT_REAL* x0 = x + 2 * s * p;
+        const LTFAT_REAL* x1 = x0 + 2 * s * m;
+        const LTFAT_REAL* x2 = x1 + 2 * s * m;
+        LTFAT_REAL* y0 = y + 6 * s * p;
+        LTFAT_REAL* y1 = y0 + 2 * s;
+        LTFAT_REAL* y2 = y1 + 2 * s;
+        LOADTW(1) LOADTW(2)
+
+        for (ltfat_int q = 2 * q0; q + 2 * VL <= 2 * s; q += 2 * VL)
+        {
+            VT a0 = VLOAD(x0 + q), a1 = VLOAD(x1 + q), a2 = VLOAD(x2 + q);
+            VT t1 = VADD(a1, a2);
+            VT t2 = VADD(a0, VMUL(c, t1));
+            VT t3 = ROT(VMUL(sn, VSUB(a1, a2)));
+            VSTORE(y0 + q, VADD(a0, t1));
+            VSTORE(y1 + q, TWMUL(VADD(t2, t3), w1r, w1i));
+            VSTORE(y2 + q, TWMUL(VSUB(t2, t3), w2r, w2i));
+        }
+    }
+}
+
+static void
+KNAME(radix4)(const LTFAT_REAL* x, LTFAT_REAL* y, ltfat_int s, ltfat_int m,
+              const LTFAT_REAL* tw, LTFAT_REAL dir, ltfat_int q0)
+{
+    const VT rotv = VPAIR(dir, -dir);
+
+    for (ltfat_int p = 0; p < m; p++)
+    {
+        const LTFAT_REAL* twp = tw + 6 * p;
+        const LTFAT_REAL* x0 = x + 2 * s * p;
+        const LTFAT_REAL* x1 = x0 + 2 * s * m;
+        const LTFAT_REAL* x2 = x1 + 2 * s * m;
+        const LTFAT_REAL* x3 = x2 + 2 * s * m;
+        LTFAT_REAL* y0 = y + 8 * s * p;
+        LTFAT_REAL* y1 = y0 + 2 * s;
+        LTFAT_REAL* y2 = y1 + 2 * s;
+        LTFAT_REAL* y3 = y2 + 2 * s;
+        LOADTW(1) LOADTW(2) LOADTW(3)
+
+        for (ltfat_int q = 2 * q0; q + 2 * VL <= 2 * s; q += 2 * VL)
+        {
+            VT a0 = VLOAD(x0 + q), a1 = VLOAD(x1 + q);
+            VT a2 = VLOAD(x2 + q), a3 = VLOAD(x3 + q);
+            VT t0 = VADD(a0, a2), t1 = VSUB(a0, a2);
+            VT t2 = VADD(a1, a3), t3 = ROT(VSUB(a1, a3));
+            VSTORE(y0 + q, VADD(t0, t2));
+            VSTORE(y1 + q, TWMUL(VADD(t1, t3), w1r, w1i));
+            VSTORE(y2 + q, TWMUL(VSUB(t0, t2), w2r, w2i));
+            VSTORE(y3 + q, TWMUL(VSUB(t1, t3), w3r, w3i));
+        }
+    }
+}
+
+static void
+KNAME(radix5)(const LTFAT_REAL* x, LTFAT_REAL* y, ltfat_int s, ltfat_int m,
+              const LTFAT_REAL* tw, LTFAT_REAL dir, ltfat_int q0)
+{
+    const VT rotv = VPAIR(dir, -dir);
+    const VT c1 = VSET1((LTFAT_REAL) 0.30901699437494742410);
+    const VT c2 = VSET1((LTFAT_REAL) - 0.80901699437494742410);
+    const VT s1 = VSET1((LTFAT_REAL) 0.95105651629515357212);
+    const VT s2 = VSET1((LTFAT_REAL) 0.58778525229247312917);
+
+    for (ltfat_int p = 0; p < m; p++)
+    {
+        const LTFAT_REAL* twp = tw + 8 * p;
+        const LTFAT_REAL* x0 = x + 2 * s * p;
+        const LTFAT_REAL* x1 = x0 + 2 * s * m;
+        const LTFAT_REAL* x2 = x1 + 2 * s * m;
+        const LTFAT_REAL* x3 = x2 + 2 * s * m;
+        const LTFAT_REAL* x4 = x3 + 2 * s * m;
+        LTFAT_REAL* y0 = y + 10 * s * p;
+        LTFAT_REAL* y1 = y0 + 2 * s;
+        LTFAT_REAL* y2 = y1 + 2 * s;
+        LTFAT_REAL* y3 = y2 + 2 * s;
+        LTFAT_REAL* y4 = y3 + 2 * s;
+        LOADTW(1) LOADTW(2) LOADTW(3) LOADTW(4)
+
+        for (ltfat_int q = 2 * q0; q + 2 * VL <= 2 * s; q += 2 * VL)
+        {
+            VT a0 = VLOAD(x0 + q), a1 = VLOAD(x1 + q), a2 = VLOAD(x2 + q);
+            VT a3 = VLOAD(x3 + q), a4 = VLOAD(x4 + q);
+            VT t1 = VADD(a1, a4), t2 = VADD(a2, a3);
+            VT t3 = VSUB(a1, a4), t4 = VSUB(a2, a3);
+            VT u1 = VADD(a0, VADD(VMUL(c1, t1), VMUL(c2, t2)));
+            VT u2 = VADD(a0, VADD(VMUL(c2, t1), VMUL(c1, t2)));
+            VT v1 = ROT(VADD(VMUL(s1, t3), VMUL(s2, t4)));
+            VT v2 = ROT(VSUB(VMUL(s2, t3), VMUL(s1, t4)));
+            VSTORE(y0 + q, VADD(a0, VADD(t1, t2)));
+            VSTORE(y1 + q, TWMUL(VADD(u1, v1), w1r, w1i));
+            VSTORE(y2 + q, TWMUL(VADD(u2, v2), w2r, w2i));
+            VSTORE(y3 + q, TWMUL(VSUB(u2, v2), w3r, w3i));
+            VSTORE(y4 + q, TWMUL(VSUB(u1, v1), w4r, w4i));
+        }
+    }
+}
+
+/*
+ * Any odd radix up to NATIVEFFT_MAXRADIX. rt holds cos(2*pi*t/r) and
+ * sin(2*pi*t/r) for t=0,...,r-1. The symmetric and antisymmetric parts
+ * of the inputs are combined so that only real constants are needed.
+ */
+static void
+KNAME(radixg)(const LTFAT_REAL* x, LTFAT_REAL* y, ltfat_int s, ltfat_int m,
+              ltfat_int r, const LTFAT_REAL* tw, const LTFAT_REAL* rt,
+              LTFAT_REAL dir, ltfat_int q0)
+{
+    const VT rotv = VPAIR(dir, -dir);
+    const ltfat_int h = r / 2;
+    VT sum[NATIVEFFT_MAXRADIX / 2], dif[NATIVEFFT_MAXRADIX / 2];
+
+    for (ltfat_int p = 0; p < m; p++)
+    {
+        const LTFAT_REAL* twp = tw + 2 * (r - 1) * p;
+        const LTFAT_REAL* xp = x + 2 * s * p;
+        LTFAT_REAL* yp = y + 2 * s * r * p;
+
+        for (ltfat_int q = 2 * q0; q + 2 * VL <= 2 * s; q += 2 * VL)
+        {
+            VT a0 = VLOAD(xp + q);
+            VT b0 = a0;
+
+            for (ltfat_int k = 1; k <= h; k++)
+            {
+                VT ak = VLOAD(xp + q + 2 * s * m * k);
+                VT ark = VLOAD(xp + q + 2 * s * m * (r - k));
+                sum[k - 1] = VADD(ak, ark);
+                dif[k - 1] = VSUB(ak, ark);
+                b0 = VADD(b0, sum[k - 1]);
+            }
+            VSTORE(yp + q, b0);
+
+            for (ltfat_int j = 1; j <= h; j++)
+            {
+                VT u = a0, v = VSET1(0);
+                ltfat_int t = 0;
+                for (ltfat_int k = 1; k <= h; k++)
+                {
+                    t += j; if (t >= r) t -= r;
+                    u = VADD(u, VMUL(VSET1(rt[2 * t]), sum[k - 1]));
+                    v = VADD(v, VMUL(VSET1(rt[2 * t + 1]), dif[k - 1]));
+                }
+                v = ROT(v);
+                VSTORE(yp + q + 2 * s * j,
+                       TWMUL(VADD(u, v), VSET1(twp[2 * (j - 1)]),
+                             VPAIR(-twp[2 * (j - 1) + 1], twp[2 * (j - 1) + 1])));
+                VSTORE(yp + q + 2 * s * (r - j),
+                       TWMUL(VSUB(u, v), VSET1(twp[2 * (r - j - 1)]),
+                             VPAIR(-twp[2 * (r - j - 1) + 1], twp[2 * (r - j - 1) + 1])));
+            }
+        }
+    }
+}
+
+#undef TWMUL
+#undef ROT
+#undef LOADTW
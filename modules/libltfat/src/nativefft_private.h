@@ -0,0 +1,53 @@
+#ifndef _ltfat_nativefft_private_h
+#define _ltfat_nativefft_private_h
+
+/*
+ * In-tree mixed-radix FFT.
+ *
+ * Plans are read-only after init and can be shared among threads.
+ * All temporary storage is passed to execute by the caller, see
+ * nativefft_worksize and nativefftreal_worksize (counted in LTFAT_REAL).
+ * Complex data are stored interleaved. The inverse transforms are not
+ * normalized.
+ */
+
+typedef struct LTFAT_NAME(nativefft_plan) LTFAT_NAME(nativefft_plan);
+typedef struct LTFAT_NAME(nativefftreal_plan) LTFAT_NAME(nativefftreal_plan);
+
+int
+LTFAT_NAME(nativefft_init)(ltfat_int N, int inverse,
+                           LTFAT_NAME(nativefft_plan)** p);
+
+ltfat_int
+LTFAT_NAME(nativefft_worksize)(const LTFAT_NAME(nativefft_plan)* p);
+
+/* in and out might be equal */
+void
+LTFAT_NAME(nativefft_execute)(const LTFAT_NAME(nativefft_plan)* p,
+                              const LTFAT_REAL* in, LTFAT_REAL* out,
+                              LTFAT_REAL* work);
+
+int
+LTFAT_NAME(nativefft_done)(LTFAT_NAME(nativefft_plan)** p);
+
+/*
+ * Forward: N real samples to N/2+1 complex coefficients.
+ * Inverse: N/2+1 complex coefficients to N real samples.
+ */
+int
+LTFAT_NAME(nativefftreal_init)(ltfat_int N, int inverse,
+                               LTFAT_NAME(nativefftreal_plan)** p);
+
+ltfat_int
+LTFAT_NAME(nativefftreal_worksize)(const LTFAT_NAME(nativefftreal_plan)* p);
+
+/* in and out might be equal */
+void
+LTFAT_NAME(nativefftreal_execute)(const LTFAT_NAME(nativefftreal_plan)* p,
+                                  const LTFAT_REAL* in, LTFAT_REAL* out,
+                                  LTFAT_REAL* work);
+
+int
+LTFAT_NAME(nativefftreal_done)(LTFAT_NAME(nativefftreal_plan)** p);
+
+#endif
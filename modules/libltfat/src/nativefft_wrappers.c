@@ -0,0 +1,582 @@
+#include "ltfat.h"
+#include "ltfat/types.h"
+#include "ltfat/macros.h"
+#include "nativefft_private.h"
+#include "threads_private.h"
+#include "rtsafe_private.h"
+#include "fftdispatch_private.h"
+
+#define FFTNAME(name) LTFAT_FFTBACKEND_NAME(native, name)
+
+/****** PLAN CACHE ******/
+/*
+ * Native FFT plans are read-only once created and are shared among all
+ * fft/ifft/fftreal/ifftreal plans of the same length and direction.
+ * Each wrapper plan owns a work buffer, so that execution does not
+ * allocate. The *_execute_ws functions take the work buffer from the
+ * caller instead.
+ */
+#ifndef LTFAT_NATIVEFFT_PLANCACHE_MAXIDLE
+#define LTFAT_NATIVEFFT_PLANCACHE_MAXIDLE 64
+#endif
+
+enum
+{
+    LTFAT_NATIVEFFT_CACHE_FFT,
+    LTFAT_NATIVEFFT_CACHE_IFFT,
+    LTFAT_NATIVEFFT_CACHE_FFTREAL,
+    LTFAT_NATIVEFFT_CACHE_IFFTREAL
+};
+
+typedef struct LTFAT_NAME(nativefft_cacheentry) LTFAT_NAME(nativefft_cacheentry);
+
+struct LTFAT_NAME(nativefft_cacheentry)
+{
+    int kind;
+    ltfat_int L;
+    size_t refcount;
+    void* plan;
+    LTFAT_NAME(nativefft_cacheentry)* next;
+};
+
+static ltfat_mutex_t plancache_mutex = LTFAT_MUTEX_INITIALIZER;
+static LTFAT_NAME(nativefft_cacheentry)* plancache_head = NULL;
+
+static void
+LTFAT_NAME(nativefft_plancache_destroy)(LTFAT_NAME(nativefft_cacheentry)* e)
+{
+    if (e->kind == LTFAT_NATIVEFFT_CACHE_FFT ||
+        e->kind == LTFAT_NATIVEFFT_CACHE_IFFT)
+    {
+        LTFAT_NAME(nativefft_plan)* cp = (LTFAT_NAME(nativefft_plan)*) e->plan;
+        LTFAT_NAME(nativefft_done)(&cp);
+    }
+    else
+    {
+        LTFAT_NAME(nativefftreal_plan)* rp = (LTFAT_NAME(nativefftreal_plan)*) e->plan;
+        LTFAT_NAME(nativefftreal_done)(&rp);
+    }
+    ltfat_free(e);
+}
+
+/* Frees unused plans exceeding maxidle. Expects the cache to be locked. */
+static ltfat_int
+LTFAT_NAME(nativefft_plancache_trim)(size_t maxidle)
+{
+    LTFAT_NAME(nativefft_cacheentry)** link = &plancache_head;
+    size_t idle = 0;
+    ltfat_int destroyed = 0;
+
+    while (*link)
+    {
+        LTFAT_NAME(nativefft_cacheentry)* e = *link;
+        if (e->refcount == 0 && ++idle > maxidle)
+        {
+            *link = e->next;
+            LTFAT_NAME(nativefft_plancache_destroy)(e);
+            destroyed++;
+        }
+        else
+            link = &e->next;
+    }
+    return destroyed;
+}
+
+static void*
+LTFAT_NAME(nativefft_plancache_acquire)(int kind, ltfat_int L)
+{
+    LTFAT_NAME(nativefft_cacheentry)* prev = NULL;
+    LTFAT_NAME(nativefft_cacheentry)* e = NULL;
+    void* p = NULL;
+
+    ltfat_rtsafe_blocking("the FFT plan cache");
+    ltfat_mutex_lock(&plancache_mutex);
+
+    for (e = plancache_head; e; prev = e, e = e->next)
+        if (e->kind == kind && e->L == L)
+            break;
+
+    if (e)
+    {
+        if (prev)
+        {
+            prev->next = e->next;
+            e->next = plancache_head;
+            plancache_head = e;
+        }
+        e->refcount++;
+        p = e->plan;
+    }
+    else if ((e = LTFAT_NEW(LTFAT_NAME(nativefft_cacheentry))))
+    {
+        int status;
+        e->kind = kind; e->L = L;
+
+        if (kind == LTFAT_NATIVEFFT_CACHE_FFT || kind == LTFAT_NATIVEFFT_CACHE_IFFT)
+        {
+            LTFAT_NAME(nativefft_plan)* cp = NULL;
+            status = LTFAT_NAME(nativefft_init)(
+                         L, kind == LTFAT_NATIVEFFT_CACHE_IFFT, &cp);
+            e->plan = cp;
+        }
+        else
+        {
+            LTFAT_NAME(nativefftreal_plan)* rp = NULL;
+            status = LTFAT_NAME(nativefftreal_init)(
+                         L, kind == LTFAT_NATIVEFFT_CACHE_IFFTREAL, &rp);
+            e->plan = rp;
+        }
+
+        if (status == LTFATERR_SUCCESS)
+        {
+            e->refcount = 1;
+            e->next = plancache_head;
+            plancache_head = e;
+            p = e->plan;
+        }
+        else
+            ltfat_free(e);
+    }
+
+    ltfat_mutex_unlock(&plancache_mutex);
+    return p;
+}
+
+static void
+LTFAT_NAME(nativefft_plancache_release)(const void* p)
+{
+    LTFAT_NAME(nativefft_cacheentry)* e;
+
+    ltfat_rtsafe_blocking("the FFT plan cache");
+    ltfat_mutex_lock(&plancache_mutex);
+
+    for (e = plancache_head; e; e = e->next)
+        if (e->plan == p)
+        {
+            if (e->refcount > 0) e->refcount--;
+            break;
+        }
+
+    LTFAT_NAME(nativefft_plancache_trim)(LTFAT_NATIVEFFT_PLANCACHE_MAXIDLE);
+    ltfat_mutex_unlock(&plancache_mutex);
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(fft_cache_clear)(void)
+{
+    ltfat_int destroyed;
+    ltfat_mutex_lock(&plancache_mutex);
+    destroyed = LTFAT_NAME(nativefft_plancache_trim)(0);
+    ltfat_mutex_unlock(&plancache_mutex);
+    return (int) destroyed;
+}
+
+/****** WISDOM ******/
+/* Plans of the native FFT are fully determined by the length */
+#ifndef LTFAT_FFT_DISPATCH
+LTFAT_API int
+LTFAT_NAME(fftw_wisdom_load)(const char* UNUSED(path))
+{
+    return LTFATERR_NOTSUPPORTED;
+}
+
+LTFAT_API int
+LTFAT_NAME(fftw_wisdom_save)(const char* UNUSED(path))
+{
+    return LTFATERR_NOTSUPPORTED;
+}
+
+LTFAT_API int
+LTFAT_NAME(fftw_set_wisdomonly)(int UNUSED(do_wisdomonly))
+{
+    return LTFATERR_SUCCESS;
+}
+#endif
+
+/****** FFT ******/
+struct FFTNAME(fft_plan)
+{
+    ltfat_int L;
+    ltfat_int W;
+    LTFAT_COMPLEX* in;
+    LTFAT_COMPLEX* out;
+    LTFAT_REAL* work;
+    const LTFAT_NAME(nativefft_plan)* plan;
+};
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(fft)(LTFAT_COMPLEX in[], ltfat_int L, ltfat_int W,
+                LTFAT_COMPLEX out[])
+{
+    FFTNAME(fft_plan)* p = NULL;
+    int status = LTFATERR_SUCCESS;
+
+    CHECKSTATUS( FFTNAME(fft_init)(L, W, in, out, 0, &p));
+    FFTNAME(fft_execute)(p);
+    FFTNAME(fft_done)(&p);
+error:
+    return status;
+}
+
+static int
+LTFAT_NAME(fft_init_common)(ltfat_int L, ltfat_int W,
+                            LTFAT_COMPLEX in[], LTFAT_COMPLEX out[],
+                            int kind, FFTNAME(fft_plan)** p)
+{
+    FFTNAME(fft_plan)* fftp = NULL;
+
+    int status = LTFATERR_SUCCESS;
+
+    CHECKNULL(p);
+    CHECK(LTFATERR_NOTPOSARG, L > 0, "L must be positive");
+    CHECK(LTFATERR_NOTPOSARG, W > 0, "W must be positive");
+
+    CHECKMEM( fftp = LTFAT_NEW(FFTNAME(fft_plan)) );
+    fftp->L = L; fftp->W = W; fftp->in = in; fftp->out = out;
+
+    fftp->plan = (const LTFAT_NAME(nativefft_plan)*)
+                 LTFAT_NAME(nativefft_plancache_acquire)(kind, L);
+    CHECKINIT(fftp->plan, "FFT plan creation failed.");
+
+    CHECKMEM( fftp->work = LTFAT_NAME_REAL(malloc)(
+                               LTFAT_NAME(nativefft_worksize)(fftp->plan)));
+
+    *p = fftp;
+    return status;
+error:
+    if (fftp)
+        FFTNAME(fft_done)(&fftp);
+    if (p) *p = NULL;
+    return status;
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(fft_init)(ltfat_int L, ltfat_int W,
+                     LTFAT_COMPLEX in[], LTFAT_COMPLEX out[],
+                     unsigned UNUSED(flags), FFTNAME(fft_plan)** p)
+{
+    return LTFAT_NAME(fft_init_common)(L, W, in, out,
+                                       LTFAT_NATIVEFFT_CACHE_FFT, p);
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(fft_execute)(FFTNAME(fft_plan)* p)
+{
+    return FFTNAME(fft_execute_newarray)( p, p->in, p->out);
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(fft_execute_newarray)(FFTNAME(fft_plan)* p,
+                                 const LTFAT_COMPLEX in[], LTFAT_COMPLEX out[])
+{
+    return FFTNAME(fft_execute_ws)(p, in, out, NULL);
+}
+
+LTFAT_FFTBACKEND_API size_t
+FFTNAME(fft_get_workspace_size)(const FFTNAME(fft_plan)* p)
+{
+    return p ? LTFAT_NAME(nativefft_worksize)(p->plan) * sizeof(LTFAT_REAL) : 0;
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(fft_execute_ws)(const FFTNAME(fft_plan)* p,
+                        const LTFAT_COMPLEX in[], LTFAT_COMPLEX out[],
+                        void* work)
+{
+    int status = LTFATERR_SUCCESS;
+    LTFAT_REAL* w_work;
+    CHECKNULL(p); CHECKNULL(in); CHECKNULL(out);
+    w_work = work ? (LTFAT_REAL*) work : p->work;
+
+    for (ltfat_int w = 0; w < p->W; w++)
+        LTFAT_NAME(nativefft_execute)(p->plan,
+                                      (const LTFAT_REAL*) (in + w * p->L),
+                                      (LTFAT_REAL*) (out + w * p->L),
+                                      w_work);
+
+error:
+    return status;
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(fft_done)(FFTNAME(fft_plan)** p)
+{
+    int status = LTFATERR_SUCCESS;
+    FFTNAME(fft_plan)* pp = NULL;
+    CHECKNULL(p); CHECKNULL(*p);
+    pp = *p;
+    if (pp->work) ltfat_free(pp->work);
+    if (pp->plan) LTFAT_NAME(nativefft_plancache_release)(pp->plan);
+    ltfat_free(pp);
+    *p = NULL;
+error:
+    return status;
+}
+
+/******* IFFT ******/
+struct FFTNAME(ifft_plan)
+{
+    struct FFTNAME(fft_plan) inplan;
+};
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifft)(LTFAT_COMPLEX in[], ltfat_int L, ltfat_int W,
+                 LTFAT_COMPLEX out[])
+{
+    FFTNAME(ifft_plan)* p = NULL;
+    int status = LTFATERR_SUCCESS;
+
+    CHECKSTATUS( FFTNAME(ifft_init)(L, W, in, out, 0, &p));
+    FFTNAME(ifft_execute)(p);
+    FFTNAME(ifft_done)(&p);
+error:
+    return status;
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifft_init)(ltfat_int L, ltfat_int W,
+                      LTFAT_COMPLEX in[], LTFAT_COMPLEX out[],
+                      unsigned UNUSED(flags), FFTNAME(ifft_plan)** p)
+{
+    return LTFAT_NAME(fft_init_common)(L, W, in, out,
+                                       LTFAT_NATIVEFFT_CACHE_IFFT,
+                                       (FFTNAME(fft_plan)**) p);
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifft_execute)(FFTNAME(ifft_plan)* p)
+{
+    return FFTNAME(fft_execute)((FFTNAME(fft_plan)*) p);
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifft_execute_newarray)(FFTNAME(ifft_plan)* p,
+                                  const LTFAT_COMPLEX in[], LTFAT_COMPLEX out[])
+{
+    return FFTNAME(fft_execute_newarray)((FFTNAME(fft_plan)*) p, in, out);
+}
+
+LTFAT_FFTBACKEND_API size_t
+FFTNAME(ifft_get_workspace_size)(const FFTNAME(ifft_plan)* p)
+{
+    return FFTNAME(fft_get_workspace_size)((const FFTNAME(fft_plan)*) p);
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifft_execute_ws)(const FFTNAME(ifft_plan)* p,
+                         const LTFAT_COMPLEX in[], LTFAT_COMPLEX out[],
+                         void* work)
+{
+    return FFTNAME(fft_execute_ws)((const FFTNAME(fft_plan)*) p, in, out, work);
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifft_done)(FFTNAME(ifft_plan)** p)
+{
+    return FFTNAME(fft_done)((FFTNAME(fft_plan)**) p);
+}
+
+/****** FFTREAL ******/
+struct FFTNAME(fftreal_plan)
+{
+    ltfat_int L;
+    ltfat_int W;
+    LTFAT_REAL* in;
+    LTFAT_REAL* out;
+    LTFAT_REAL* work;
+    const LTFAT_NAME(nativefftreal_plan)* plan;
+};
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(fftreal)(LTFAT_REAL in[], ltfat_int L, ltfat_int W,
+                    LTFAT_COMPLEX out[])
+{
+    FFTNAME(fftreal_plan)* p = NULL;
+    int status = LTFATERR_SUCCESS;
+
+    CHECKSTATUS( FFTNAME(fftreal_init)(L, W, in, out, 0, &p));
+    FFTNAME(fftreal_execute)(p);
+    FFTNAME(fftreal_done)(&p);
+error:
+    return status;
+}
+
+static int
+LTFAT_NAME(fftreal_init_common)(ltfat_int L, ltfat_int W,
+                                LTFAT_REAL in[], LTFAT_REAL out[],
+                                int kind, FFTNAME(fftreal_plan)** p)
+{
+    FFTNAME(fftreal_plan)* fftp = NULL;
+
+    int status = LTFATERR_SUCCESS;
+
+    CHECKNULL(p);
+    CHECK(LTFATERR_NOTPOSARG, L > 0, "L must be positive");
+    CHECK(LTFATERR_NOTPOSARG, W > 0, "W must be positive");
+
+    CHECKMEM( fftp = LTFAT_NEW(FFTNAME(fftreal_plan)) );
+    fftp->L = L; fftp->W = W; fftp->in = in; fftp->out = out;
+
+    fftp->plan = (const LTFAT_NAME(nativefftreal_plan)*)
+                 LTFAT_NAME(nativefft_plancache_acquire)(kind, L);
+    CHECKINIT(fftp->plan, "FFT plan creation failed.");
+
+    CHECKMEM( fftp->work = LTFAT_NAME_REAL(malloc)(
+                               LTFAT_NAME(nativefftreal_worksize)(fftp->plan)));
+
+    *p = fftp;
+    return status;
+error:
+    if (fftp)
+        FFTNAME(fftreal_done)(&fftp);
+    if (p) *p = NULL;
+    return status;
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(fftreal_init)(ltfat_int L, ltfat_int W,
+                         LTFAT_REAL in[], LTFAT_COMPLEX out[],
+                         unsigned UNUSED(flags), FFTNAME(fftreal_plan)** p)
+{
+    return LTFAT_NAME(fftreal_init_common)(L, W, in, (LTFAT_REAL*) out,
+                                           LTFAT_NATIVEFFT_CACHE_FFTREAL, p);
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(fftreal_execute)(FFTNAME(fftreal_plan)* p)
+{
+    return FFTNAME(fftreal_execute_newarray)( p, p->in,
+            (LTFAT_COMPLEX*) p->out);
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(fftreal_execute_newarray)(FFTNAME(fftreal_plan)* p,
+                                     const LTFAT_REAL in[], LTFAT_COMPLEX out[])
+{
+    return FFTNAME(fftreal_execute_ws)(p, in, out, NULL);
+}
+
+LTFAT_FFTBACKEND_API size_t
+FFTNAME(fftreal_get_workspace_size)(const FFTNAME(fftreal_plan)* p)
+{
+    return p ? LTFAT_NAME(nativefftreal_worksize)(p->plan) * sizeof(LTFAT_REAL) : 0;
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(fftreal_execute_ws)(const FFTNAME(fftreal_plan)* p,
+                            const LTFAT_REAL in[], LTFAT_COMPLEX out[],
+                            void* work)
+{
+    int status = LTFATERR_SUCCESS;
+    ltfat_int M2, instep;
+    LTFAT_REAL* w_work;
+
+    CHECKNULL(p); CHECKNULL(in); CHECKNULL(out);
+    w_work = work ? (LTFAT_REAL*) work : p->work;
+
+    M2 = p->L / 2 + 1;
+    instep = in == (const LTFAT_REAL*) out ? 2 * M2 : p->L;
+
+    for (ltfat_int w = 0; w < p->W; w++)
+        LTFAT_NAME(nativefftreal_execute)(p->plan, in + w * instep,
+                                          (LTFAT_REAL*) (out + w * M2),
+                                          w_work);
+error:
+    return status;
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(fftreal_done)(FFTNAME(fftreal_plan)** p)
+{
+    int status = LTFATERR_SUCCESS;
+    FFTNAME(fftreal_plan)* pp = NULL;
+    CHECKNULL(p); CHECKNULL(*p);
+    pp = *p;
+    if (pp->work) ltfat_free(pp->work);
+    if (pp->plan) LTFAT_NAME(nativefft_plancache_release)(pp->plan);
+    ltfat_free(pp);
+    *p = NULL;
+error:
+    return status;
+}
+
+/******* IFFTREAL ******/
+struct FFTNAME(ifftreal_plan)
+{
+    struct FFTNAME(fftreal_plan) inplan;
+};
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifftreal)(LTFAT_COMPLEX in[], ltfat_int L, ltfat_int W,
+                     LTFAT_REAL out[])
+{
+    FFTNAME(ifftreal_plan)* p = NULL;
+    int status = LTFATERR_SUCCESS;
+
+    CHECKSTATUS( FFTNAME(ifftreal_init)(L, W, in, out, 0, &p));
+    FFTNAME(ifftreal_execute)(p);
+    FFTNAME(ifftreal_done)(&p);
+error:
+    return status;
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifftreal_init)(ltfat_int L, ltfat_int W,
+                          LTFAT_COMPLEX in[], LTFAT_REAL out[],
+                          unsigned UNUSED(flags), FFTNAME(ifftreal_plan)** p)
+{
+    return LTFAT_NAME(fftreal_init_common)(L, W, (LTFAT_REAL*)in, out,
+                                           LTFAT_NATIVEFFT_CACHE_IFFTREAL,
+                                           (FFTNAME(fftreal_plan)**) p);
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifftreal_execute)(FFTNAME(ifftreal_plan)* pin)
+{
+    FFTNAME(fftreal_plan)* p = (FFTNAME(fftreal_plan)*) pin;
+    return FFTNAME(ifftreal_execute_newarray)( pin, (const LTFAT_COMPLEX*) p->in,
+            p->out);
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifftreal_execute_newarray)(FFTNAME(ifftreal_plan)* pin,
+                                      const LTFAT_COMPLEX in[], LTFAT_REAL out[])
+{
+    return FFTNAME(ifftreal_execute_ws)(pin, in, out, NULL);
+}
+
+LTFAT_FFTBACKEND_API size_t
+FFTNAME(ifftreal_get_workspace_size)(const FFTNAME(ifftreal_plan)* p)
+{
+    return FFTNAME(fftreal_get_workspace_size)((const FFTNAME(fftreal_plan)*) p);
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifftreal_execute_ws)(const FFTNAME(ifftreal_plan)* pin,
+                             const LTFAT_COMPLEX in[], LTFAT_REAL out[],
+                             void* work)
+{
+    int status = LTFATERR_SUCCESS;
+    ltfat_int M2, outstep;
+    const FFTNAME(fftreal_plan)* p;
+    LTFAT_REAL* w_work;
+    CHECKNULL(pin); CHECKNULL(in); CHECKNULL(out);
+    p = (const FFTNAME(fftreal_plan)*) pin;
+    w_work = work ? (LTFAT_REAL*) work : p->work;
+
+    M2 = p->L / 2 + 1;
+    outstep = in == (const LTFAT_COMPLEX*) out ? 2 * M2 : p->L;
+
+    for (ltfat_int w = 0; w < p->W; w++)
+        LTFAT_NAME(nativefftreal_execute)(p->plan,
+                                          (const LTFAT_REAL*) (in + w * M2),
+                                          out + w * outstep, w_work);
+error:
+    return status;
+}
+
+LTFAT_FFTBACKEND_API int
+FFTNAME(ifftreal_done)(FFTNAME(ifftreal_plan)** p)
+{
+    return FFTNAME(fftreal_done)((FFTNAME(fftreal_plan)**) p);
+}
@@ -0,0 +1,52 @@
+#ifndef _ltfat_procstats_private_h
+#define _ltfat_procstats_private_h
+
+#include <stdint.h>
+
+typedef struct ltfat_procstats_state ltfat_procstats_state;
+
+/* Durations of the stages of a single execute call. Lives on the stack of
+ * the thread doing the work and is added to the shared counters at once. */
+typedef struct
+{
+    uint64_t ns[ltfat_procstats_nstages];
+    unsigned recorded; /* Bit mask of the stages which occurred */
+    size_t frames;
+    uint64_t t0; /* Time of ltfat_procstats_begin */
+    uint64_t t; /* Time of the last ltfat_procstats_lap */
+} ltfat_procstats_call;
+
+int
+ltfat_procstats_init(ltfat_procstats_state** p);
+
+void
+ltfat_procstats_done(ltfat_procstats_state* p);
+
+/* Monotonic clock in nanoseconds */
+uint64_t
+ltfat_procstats_now(void);
+
+void
+ltfat_procstats_begin(ltfat_procstats_call* c);
+
+/* Adds the time elapsed since the previous lap (or begin) to stage */
+void
+ltfat_procstats_lap(ltfat_procstats_call* c, ltfat_procstats_stage stage);
+
+/* Records the time elapsed since begin as ltfat_procstats_total */
+void
+ltfat_procstats_end(ltfat_procstats_call* c);
+
+/* Adds the durations to the histograms. countcall is 0 for passes
+ * of a worker thread which do not correspond to an execute call. */
+void
+ltfat_procstats_commit(ltfat_procstats_state* p, const ltfat_procstats_call* c,
+                       int countcall);
+
+void
+ltfat_procstats_reset(ltfat_procstats_state* p);
+
+int
+ltfat_procstats_snapshot(const ltfat_procstats_state* p, ltfat_procstats* s);
+
+#endif
@@ -0,0 +1,225 @@
+#include "ltfat.h"
+#include "ltfat/types.h"
+#include "ltfat/macros.h"
+#include "procstats_private.h"
+#include "threads_private.h"
+
+#if defined(_WIN32) || defined(__WIN32__)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+/* 8 bins per octave, durations up to 2^40 ns (about 18 minutes) */
+#define PROCSTATS_SUBBITS 3
+#define PROCSTATS_SUB (1 << PROCSTATS_SUBBITS)
+#define PROCSTATS_OCTAVES 40
+#define PROCSTATS_NBINS ((PROCSTATS_OCTAVES - PROCSTATS_SUBBITS + 1) * PROCSTATS_SUB)
+
+typedef struct
+{
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+    uint64_t bins[PROCSTATS_NBINS];
+} ltfat_procstats_hist;
+
+struct ltfat_procstats_state
+{
+    uint64_t calls;
+    uint64_t frames;
+    ltfat_procstats_hist hist[ltfat_procstats_nstages];
+};
+
+static int
+ltfat_procstats_log2(uint64_t x)
+{
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(x);
+#else
+    int o = 0;
+    while (x >>= 1) o++;
+    return o;
+#endif
+}
+
+/* Values below PROCSTATS_SUB have their own bins, above that each octave
+ * is split into PROCSTATS_SUB bins of equal width. */
+static int
+ltfat_procstats_bin(uint64_t ns)
+{
+    int o, bin;
+    if (ns < PROCSTATS_SUB)
+        return (int) ns;
+
+    o = ltfat_procstats_log2(ns);
+    bin = (o - PROCSTATS_SUBBITS + 1) * PROCSTATS_SUB +
+          (int)((ns >> (o - PROCSTATS_SUBBITS)) & (PROCSTATS_SUB - 1));
+
+    return bin < PROCSTATS_NBINS ? bin : PROCSTATS_NBINS - 1;
+}
+
+/* Largest value falling into bin */
+static uint64_t
+ltfat_procstats_binupper(int bin)
+{
+    int o, sub;
+    if (bin < PROCSTATS_SUB)
+        return (uint64_t) bin;
+
+    o = bin / PROCSTATS_SUB + PROCSTATS_SUBBITS - 1;
+    sub = bin % PROCSTATS_SUB;
+    return ((uint64_t)(PROCSTATS_SUB + sub + 1) << (o - PROCSTATS_SUBBITS)) - 1;
+}
+
+int
+ltfat_procstats_init(ltfat_procstats_state** p)
+{
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(p);
+    CHECKMEM( *p = (ltfat_procstats_state*) ltfat_calloc(1, sizeof**p) );
+error:
+    return status;
+}
+
+void
+ltfat_procstats_done(ltfat_procstats_state* p)
+{
+    ltfat_safefree(p);
+}
+
+uint64_t
+ltfat_procstats_now(void)
+{
+#if defined(_WIN32) || defined(__WIN32__)
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (uint64_t)((double) count.QuadPart * 1e9 / (double) freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+void
+ltfat_procstats_begin(ltfat_procstats_call* c)
+{
+    memset(c, 0, sizeof * c);
+    c->t0 = c->t = ltfat_procstats_now();
+}
+
+void
+ltfat_procstats_end(ltfat_procstats_call* c)
+{
+    c->ns[ltfat_procstats_total] = ltfat_procstats_now() - c->t0;
+    c->recorded |= 1U << ltfat_procstats_total;
+}
+
+void
+ltfat_procstats_lap(ltfat_procstats_call* c, ltfat_procstats_stage stage)
+{
+    uint64_t t = ltfat_procstats_now();
+    c->ns[stage] += t - c->t;
+    c->recorded |= 1U << stage;
+    c->t = t;
+}
+
+static void
+ltfat_procstats_hist_add(ltfat_procstats_hist* h, uint64_t ns)
+{
+    uint64_t cur = ltfat_atomic_load_u64(&h->max);
+
+    ltfat_atomic_add_u64(&h->bins[ltfat_procstats_bin(ns)], 1);
+    ltfat_atomic_add_u64(&h->sum, ns);
+    ltfat_atomic_add_u64(&h->count, 1);
+
+    while (ns > cur && !ltfat_atomic_cas_u64(&h->max, cur, ns))
+        cur = ltfat_atomic_load_u64(&h->max);
+}
+
+void
+ltfat_procstats_commit(ltfat_procstats_state* p, const ltfat_procstats_call* c,
+                       int countcall)
+{
+    for (int s = 0; s < ltfat_procstats_nstages; s++)
+        if (c->recorded & (1U << s))
+            ltfat_procstats_hist_add(&p->hist[s], c->ns[s]);
+
+    if (c->frames)
+        ltfat_atomic_add_u64(&p->frames, (uint64_t) c->frames);
+
+    if (countcall)
+        ltfat_atomic_add_u64(&p->calls, 1);
+}
+
+void
+ltfat_procstats_reset(ltfat_procstats_state* p)
+{
+    ltfat_atomic_store_u64(&p->calls, 0);
+    ltfat_atomic_store_u64(&p->frames, 0);
+
+    for (int s = 0; s < ltfat_procstats_nstages; s++)
+    {
+        ltfat_procstats_hist* h = &p->hist[s];
+        ltfat_atomic_store_u64(&h->count, 0);
+        ltfat_atomic_store_u64(&h->sum, 0);
+        ltfat_atomic_store_u64(&h->max, 0);
+        for (int b = 0; b < PROCSTATS_NBINS; b++)
+            ltfat_atomic_store_u64(&h->bins[b], 0);
+    }
+}
+
+/* Smallest bin upper edge below which at least q of the values lie */
+static double
+ltfat_procstats_quantile(const uint64_t* bins, uint64_t total, double q,
+                         uint64_t max)
+{
+    uint64_t target = (uint64_t) ceil(q * (double) total), acc = 0;
+    if (target == 0) target = 1;
+
+    for (int b = 0; b < PROCSTATS_NBINS; b++)
+    {
+        acc += bins[b];
+        if (acc >= target)
+        {
+            uint64_t upper = ltfat_procstats_binupper(b);
+            return 1e-9 * (double)(upper < max ? upper : max);
+        }
+    }
+    return 1e-9 * (double) max;
+}
+
+int
+ltfat_procstats_snapshot(const ltfat_procstats_state* p, ltfat_procstats* s)
+{
+    uint64_t bins[PROCSTATS_NBINS];
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(p); CHECKNULL(s);
+
+    s->calls = (size_t) ltfat_atomic_load_u64(&p->calls);
+    s->frames = (size_t) ltfat_atomic_load_u64(&p->frames);
+
+    for (int st = 0; st < ltfat_procstats_nstages; st++)
+    {
+        const ltfat_procstats_hist* h = &p->hist[st];
+        ltfat_procstats_timing* t = &s->stage[st];
+        uint64_t total = 0, max;
+
+        // The count is taken from the bins so that the percentiles are
+        // consistent even if the histogram is being updated
+        for (int b = 0; b < PROCSTATS_NBINS; b++)
+            total += bins[b] = ltfat_atomic_load_u64(&h->bins[b]);
+
+        max = ltfat_atomic_load_u64(&h->max);
+        t->count = (size_t) total;
+        t->max = 1e-9 * (double) max;
+        t->mean = total ?
+                  1e-9 * (double) ltfat_atomic_load_u64(&h->sum) / (double) total : 0.0;
+        t->p50 = total ? ltfat_procstats_quantile(bins, total, 0.50, max) : 0.0;
+        t->p99 = total ? ltfat_procstats_quantile(bins, total, 0.99, max) : 0.0;
+    }
+error:
+    return status;
+}
@@ -3,6 +3,13 @@
 #include "ltfat/macros.h"
 #include "ltfat/thirdparty/fftw3.h"
 #include "circularbuf_private.h"
+#include "simd_private.h"
+#include "threads_private.h"
+#include "rtsafe_private.h"
+#include "procstats_private.h"
+#include "workspace_private.h"
+
+#include <stdint.h>
 
 // These are non-public function header templates
 typedef int LTFAT_NAME(realtocomplextransform)(void* userdata,
@@ -22,6 +29,11 @@ struct LTFAT_NAME(rtdgtreal_plan)
     ltfat_int fftBufLen; //!< Internal buffer length
     LTFAT_NAME_REAL(fftreal_plan)*  pfft;
     LTFAT_NAME_REAL(ifftreal_plan)* pifft;
+    ltfat_int framesMax; //!< Number of frames of the multi-frame FFT
+    LTFAT_REAL* framesBuf; //!< Multi-frame buffer, M x framesMax
+    LTFAT_COMPLEX* framesBuf_cpx; //!< Multi-frame buffer, M2 x framesMax
+    LTFAT_NAME_REAL(fftreal_plan)*  pfftFrames;
+    LTFAT_NAME_REAL(ifftreal_plan)* pifftFrames;
 };
 
 int
@@ -90,45 +102,317 @@ LTFAT_NAME(rtidgtreal_init)(const LTFAT_REAL* g, ltfat_int gl,
     return LTFAT_NAME(rtdgtreal_commoninit)(g, gl, M, ptype, LTFAT_INVERSE, p);
 }
 
+/* out[ii] = f[ii]*g[ii] and out[ii] += f[ii]*g[ii] */
+static void
+LTFAT_NAME(rtdgtreal_winmul)(const LTFAT_REAL* f, const LTFAT_REAL* g,
+                             ltfat_int len, LTFAT_REAL* out)
+{
+    ltfat_int ii = 0;
+#ifdef LTFAT_SIMD
+    for (; ii + 2 * LTFAT_SIMD_VL <= len; ii += 2 * LTFAT_SIMD_VL)
+        V_STORE(out + ii, V_MUL(V_LOAD(f + ii), V_LOAD(g + ii)));
+#endif
+    for (; ii < len; ii++)
+        out[ii] = f[ii] * g[ii];
+}
+
+static void
+LTFAT_NAME(rtdgtreal_winmuladd)(const LTFAT_REAL* f, const LTFAT_REAL* g,
+                                ltfat_int len, LTFAT_REAL* out)
+{
+    ltfat_int ii = 0;
+#ifdef LTFAT_SIMD
+    for (; ii + 2 * LTFAT_SIMD_VL <= len; ii += 2 * LTFAT_SIMD_VL)
+        V_STORE(out + ii,
+                V_ADD(V_LOAD(out + ii), V_MUL(V_LOAD(f + ii), V_LOAD(g + ii))));
+#endif
+    for (; ii < len; ii++)
+        out[ii] += f[ii] * g[ii];
+}
+
+/* Index of the FFT buffer sample 0 of the window maps to */
+static ltfat_int
+LTFAT_NAME(rtdgtreal_rotation)(const LTFAT_NAME(rtdgtreal_plan)* p)
+{
+    return p->ptype == LTFAT_RTDGTPHASE_ZERO ?
+           ltfat_positiverem(-(p->gl / 2), p->M) : 0;
+}
+
+/* Window, fold and circular shift in a single pass.
+ * Window sample ii is added to buf[(ii - gl/2) mod M] (zero-phase) or
+ * buf[ii mod M]. The first M window samples overwrite buf, such that it
+ * does not need to be cleared. buf holds M samples. */
+static void
+LTFAT_NAME(rtdgtreal_prepframe)(const LTFAT_NAME(rtdgtreal_plan)* p,
+                                const LTFAT_REAL* fchan, LTFAT_REAL* buf)
+{
+    ltfat_int M = p->M, gl = p->gl;
+    ltfat_int idx = LTFAT_NAME(rtdgtreal_rotation)(p);
+
+    for (ltfat_int ii = 0; ii < gl;)
+    {
+        // Split such that neither buf nor the first M samples are crossed
+        ltfat_int len = ltfat_imin(gl - ii, M - idx);
+        if (ii < M) len = ltfat_imin(len, M - ii);
+
+        if (ii < M)
+            LTFAT_NAME(rtdgtreal_winmul)(fchan + ii, p->g + ii, len, buf + idx);
+        else
+            LTFAT_NAME(rtdgtreal_winmuladd)(fchan + ii, p->g + ii, len, buf + idx);
+
+        ii += len;
+        idx += len;
+        if (idx == M) idx = 0;
+    }
+
+    // Zero padding, idx points just after the last written sample
+    if (gl < M)
+    {
+        ltfat_int len = ltfat_imin(M - gl, M - idx);
+        memset(buf + idx, 0, len * sizeof * buf);
+        memset(buf, 0, (M - gl - len) * sizeof * buf);
+    }
+}
+
+/* Inverse of the previous, fchan[ii] = g[ii]*buf[(ii - gl/2) mod M]
+ * (zero-phase) or g[ii]*buf[ii mod M]. */
+static void
+LTFAT_NAME(rtidgtreal_postframe)(const LTFAT_NAME(rtidgtreal_plan)* p,
+                                 const LTFAT_REAL* buf, LTFAT_REAL* fchan)
+{
+    ltfat_int M = p->M, gl = p->gl;
+    ltfat_int idx = LTFAT_NAME(rtdgtreal_rotation)(p);
+
+    for (ltfat_int ii = 0; ii < gl;)
+    {
+        ltfat_int len = ltfat_imin(gl - ii, M - idx);
+
+        LTFAT_NAME(rtdgtreal_winmul)(buf + idx, p->g + ii, len, fchan + ii);
+
+        ii += len;
+        idx += len;
+        if (idx == M) idx = 0;
+    }
+}
+
+/* FFTW requires arrays passed to the new-array execute functions to have
+ * the same alignment as the arrays the plan was created with. */
+static int
+LTFAT_NAME(rtdgtreal_samealignment)(const void* a, const void* b)
+{
+    return ((uintptr_t) a - (uintptr_t) b) % 16 == 0;
+}
+
+/* Single-frame transforms using the given buffers, fftwork is NULL for
+ * the plan-owned FFT scratch */
+static void
+LTFAT_NAME(rtdgtreal_execute_buf)(const LTFAT_NAME(rtdgtreal_plan)* p,
+                                  const LTFAT_REAL* f, ltfat_int W,
+                                  LTFAT_COMPLEX* c, LTFAT_REAL* fftBuf,
+                                  LTFAT_COMPLEX* fftBuf_cpx, void* fftwork)
+{
+    ltfat_int M2 = p->M / 2 + 1;
+    ltfat_int gl = p->gl;
+
+    for (ltfat_int w = 0; w < W; w++)
+    {
+        LTFAT_COMPLEX* cchan = c + w * M2;
+
+        LTFAT_NAME(rtdgtreal_prepframe)(p, f + w * gl, fftBuf);
+
+        if (LTFAT_NAME(rtdgtreal_samealignment)(cchan, fftBuf_cpx))
+        {
+            LTFAT_NAME_REAL(fftreal_execute_ws)(p->pfft, fftBuf, cchan, fftwork);
+        }
+        else
+        {
+            LTFAT_NAME_REAL(fftreal_execute_ws)(p->pfft, fftBuf, fftBuf_cpx, fftwork);
+            memcpy(cchan, fftBuf_cpx, M2 * sizeof * c);
+        }
+    }
+}
+
+static void
+LTFAT_NAME(rtidgtreal_execute_buf)(const LTFAT_NAME(rtidgtreal_plan)* p,
+                                   const LTFAT_COMPLEX* c, ltfat_int W,
+                                   LTFAT_REAL* f, LTFAT_REAL* fftBuf,
+                                   LTFAT_COMPLEX* fftBuf_cpx, void* fftwork)
+{
+    ltfat_int M2 = p->M / 2 + 1;
+    ltfat_int gl = p->gl;
+
+    for (ltfat_int w = 0; w < W; w++)
+    {
+        // The complex-to-real FFT overwrites its input, c must be copied
+        memcpy(fftBuf_cpx, c + w * M2, M2 * sizeof * c);
+
+        LTFAT_NAME_REAL(ifftreal_execute_ws)(p->pifft, fftBuf_cpx, fftBuf, fftwork);
+
+        LTFAT_NAME(rtidgtreal_postframe)(p, fftBuf, f + w * gl);
+    }
+}
+
+/* Takes fftBuf, fftBuf_cpx and the FFT scratch from the workspace at base,
+ * or only counts their size if base is NULL */
+static size_t
+LTFAT_NAME(rtdgtreal_ws_carve)(const LTFAT_NAME(rtdgtreal_plan)* p, char* base,
+                               LTFAT_REAL** fftBuf, LTFAT_COMPLEX** fftBuf_cpx,
+                               void** fftwork)
+{
+    size_t fftws, off = 0;
+
+    fftws = p->pfft ? LTFAT_NAME_REAL(fftreal_get_workspace_size)(p->pfft) :
+            LTFAT_NAME_REAL(ifftreal_get_workspace_size)(p->pifft);
+
+    *fftBuf = (LTFAT_REAL*) ltfat_ws_take(base, &off, p->fftBufLen * sizeof(LTFAT_REAL));
+    *fftBuf_cpx = (LTFAT_COMPLEX*) ltfat_ws_take(base, &off,
+                  (p->M / 2 + 1) * sizeof(LTFAT_COMPLEX));
+    *fftwork = ltfat_ws_take(base, &off, fftws);
+    return off;
+}
+
 LTFAT_API int
 LTFAT_NAME(rtdgtreal_execute)(const LTFAT_NAME(rtdgtreal_plan)* p,
                               const LTFAT_REAL* f, ltfat_int W,
                               LTFAT_COMPLEX* c)
 {
-    ltfat_int M, M2, gl;
+    int status = LTFATERR_FAILED;
+    CHECKNULL(p); CHECKNULL(f); CHECKNULL(c);
+    CHECK(LTFATERR_NOTPOSARG, W > 0, "W must be positive");
+
+    LTFAT_NAME(rtdgtreal_execute_buf)(p, f, W, c, p->fftBuf, p->fftBuf_cpx, NULL);
+
+    return LTFATERR_SUCCESS;
+error:
+    return status;
+}
+
+LTFAT_API size_t
+LTFAT_NAME(rtdgtreal_get_workspace_size)(const LTFAT_NAME(rtdgtreal_plan)* p)
+{
+    LTFAT_REAL* fftBuf;
+    LTFAT_COMPLEX* fftBuf_cpx;
+    void* fftwork;
+    if (!p) return 0;
+    return ltfat_ws_size(
+               LTFAT_NAME(rtdgtreal_ws_carve)(p, NULL, &fftBuf, &fftBuf_cpx, &fftwork));
+}
+
+LTFAT_API int
+LTFAT_NAME(rtdgtreal_execute_ws)(const LTFAT_NAME(rtdgtreal_plan)* p,
+                                 const LTFAT_REAL* f, ltfat_int W,
+                                 LTFAT_COMPLEX* c, void* ws)
+{
     LTFAT_REAL* fftBuf;
     LTFAT_COMPLEX* fftBuf_cpx;
+    void* fftwork;
     int status = LTFATERR_FAILED;
-    CHECKNULL(p); CHECKNULL(f); CHECKNULL(c);
+    CHECKNULL(p); CHECKNULL(f); CHECKNULL(c); CHECKNULL(ws);
     CHECK(LTFATERR_NOTPOSARG, W > 0, "W must be positive");
+    CHECK(LTFATERR_BADARG, p->pfft, "Plan was not created by rtdgtreal_init");
+
+    LTFAT_NAME(rtdgtreal_ws_carve)(p, ltfat_ws_begin(ws), &fftBuf, &fftBuf_cpx,
+                                   &fftwork);
+    LTFAT_NAME(rtdgtreal_execute_buf)(p, f, W, c, fftBuf, fftBuf_cpx, fftwork);
+
+    return LTFATERR_SUCCESS;
+error:
+    return status;
+}
+
+LTFAT_API int
+LTFAT_NAME(rtdgtreal_setmaxframes)(LTFAT_NAME(rtdgtreal_plan)* p,
+                                   ltfat_int framesMax)
+{
+    ltfat_int M, M2;
+    int status = LTFATERR_FAILED;
+    CHECKNULL(p);
+    CHECK(LTFATERR_BADARG, framesMax >= 0,
+          "framesMax must be nonnegative (passed %td)", framesMax);
+
+    if (framesMax == 1) framesMax = 0;
+    if (framesMax == p->framesMax) return LTFATERR_SUCCESS;
+
+    if (p->pfftFrames) LTFAT_NAME_REAL(fftreal_done)(&p->pfftFrames);
+    if (p->pifftFrames) LTFAT_NAME_REAL(ifftreal_done)(&p->pifftFrames);
+    ltfat_safefree(p->framesBuf); p->framesBuf = NULL;
+    ltfat_safefree(p->framesBuf_cpx); p->framesBuf_cpx = NULL;
+    p->framesMax = 0;
+
+    if (framesMax == 0) return LTFATERR_SUCCESS;
 
     M = p->M;
     M2 = M / 2 + 1;
-    gl = p->gl;
-    fftBuf = p->fftBuf;
-    fftBuf_cpx = p->fftBuf_cpx;
+    CHECKMEM( p->framesBuf = LTFAT_NAME_REAL(calloc)(M * framesMax));
+    CHECKMEM( p->framesBuf_cpx = LTFAT_NAME_COMPLEX(calloc)(M2 * framesMax));
 
-    for (ltfat_int w = 0; w < W; w++)
+    if (p->pfft)
     {
-        const LTFAT_REAL* fchan = f + w * gl;
-        LTFAT_COMPLEX* cchan = c + w * M2;
+        LTFAT_NAME_REAL(fftreal_init)(M, framesMax, p->framesBuf,
+                                      p->framesBuf_cpx, FFTW_MEASURE,
+                                      &p->pfftFrames);
+        CHECKINIT(p->pfftFrames, "FFTW plan creation failed.");
+    }
+    else
+    {
+        LTFAT_NAME_REAL(ifftreal_init)(M, framesMax, p->framesBuf_cpx,
+                                       p->framesBuf, FFTW_MEASURE,
+                                       &p->pifftFrames);
+        CHECKINIT(p->pifftFrames, "FFTW plan creation failed.");
+    }
+
+    p->framesMax = framesMax;
+    return LTFATERR_SUCCESS;
+error:
+    ltfat_safefree(p->framesBuf); p->framesBuf = NULL;
+    ltfat_safefree(p->framesBuf_cpx); p->framesBuf_cpx = NULL;
+    return status;
+}
+
+/* The multi-frame FFT always transforms framesMax columns. When less than
+ * half of them is used, transforming the frames one by one is cheaper. */
+static int
+LTFAT_NAME(rtdgtreal_use_multiframe)(const LTFAT_NAME(rtdgtreal_plan)* p,
+                                     ltfat_int frames)
+{
+    return p->framesMax > 0 && 2 * frames > p->framesMax;
+}
 
-        if (p->g)
-            for (ltfat_int ii = 0; ii < gl; ii++)
-                fftBuf[ii] = fchan[ii] * p->g[ii];
+LTFAT_API int
+LTFAT_NAME(rtdgtreal_execute_frames)(const LTFAT_NAME(rtdgtreal_plan)* p,
+                                     const LTFAT_REAL* f, ltfat_int N,
+                                     ltfat_int W, LTFAT_COMPLEX* c)
+{
+    ltfat_int M, M2, gl;
+    int status = LTFATERR_FAILED;
+    CHECKNULL(p); CHECKNULL(f); CHECKNULL(c);
+    CHECK(LTFATERR_NOTPOSARG, N > 0, "N must be positive");
+    CHECK(LTFATERR_NOTPOSARG, W > 0, "W must be positive");
 
-        if (M > gl)
-            memset(fftBuf + gl, 0, (M - gl) * sizeof * fftBuf);
+    // The layout gl x N x W is the same as gl x (N*W)
+    if (!LTFAT_NAME(rtdgtreal_use_multiframe)(p, N * W))
+        return LTFAT_NAME(rtdgtreal_execute)(p, f, N * W, c);
 
-        if (gl > M)
-            LTFAT_NAME_REAL(fold_array)(fftBuf, gl, M, 0, fftBuf);
+    CHECK(LTFATERR_BADARG, N * W <= p->framesMax,
+          "N*W (passed %td) must be at most %td", N * W, p->framesMax);
 
-        if (p->ptype == LTFAT_RTDGTPHASE_ZERO)
-            LTFAT_NAME_REAL(circshift)(fftBuf, M, -(gl / 2), fftBuf );
+    M = p->M;
+    M2 = M / 2 + 1;
+    gl = p->gl;
 
-        LTFAT_NAME_REAL(fftreal_execute)(p->pfft);
+    for (ltfat_int n = 0; n < N * W; n++)
+        LTFAT_NAME(rtdgtreal_prepframe)(p, f + n * gl, p->framesBuf + n * M);
 
-        memcpy(cchan, fftBuf_cpx, M2 * sizeof * c);
+    // Unused columns are transformed too, c must not be written beyond N*W
+    if (N * W == p->framesMax &&
+        LTFAT_NAME(rtdgtreal_samealignment)(c, p->framesBuf_cpx))
+    {
+        LTFAT_NAME_REAL(fftreal_execute_newarray)(p->pfftFrames, p->framesBuf, c);
+    }
+    else
+    {
+        LTFAT_NAME_REAL(fftreal_execute)(p->pfftFrames);
+        memcpy(c, p->framesBuf_cpx, N * W * M2 * sizeof * c);
     }
 
     return LTFATERR_SUCCESS;
@@ -149,40 +433,79 @@ LTFAT_NAME(rtidgtreal_execute)(const LTFAT_NAME(rtidgtreal_plan)* p,
                                const LTFAT_COMPLEX* c, ltfat_int W,
                                LTFAT_REAL* f)
 {
-    ltfat_int M, M2, gl;
+    int status = LTFATERR_FAILED;
+    CHECKNULL(p); CHECKNULL(c); CHECKNULL(f);
+    CHECK(LTFATERR_NOTPOSARG, W > 0, "W must be positive");
+
+    LTFAT_NAME(rtidgtreal_execute_buf)(p, c, W, f, p->fftBuf, p->fftBuf_cpx, NULL);
+
+    return LTFATERR_SUCCESS;
+error:
+    return status;
+}
+
+LTFAT_API size_t
+LTFAT_NAME(rtidgtreal_get_workspace_size)(const LTFAT_NAME(rtidgtreal_plan)* p)
+{
+    return LTFAT_NAME(rtdgtreal_get_workspace_size)(p);
+}
+
+LTFAT_API int
+LTFAT_NAME(rtidgtreal_execute_ws)(const LTFAT_NAME(rtidgtreal_plan)* p,
+                                  const LTFAT_COMPLEX* c, ltfat_int W,
+                                  LTFAT_REAL* f, void* ws)
+{
     LTFAT_REAL* fftBuf;
     LTFAT_COMPLEX* fftBuf_cpx;
+    void* fftwork;
     int status = LTFATERR_FAILED;
-    CHECKNULL(p); CHECKNULL(c); CHECKNULL(f);
+    CHECKNULL(p); CHECKNULL(c); CHECKNULL(f); CHECKNULL(ws);
     CHECK(LTFATERR_NOTPOSARG, W > 0, "W must be positive");
+    CHECK(LTFATERR_BADARG, p->pifft, "Plan was not created by rtidgtreal_init");
 
-    M = p->M;
-    M2 = M / 2 + 1;
-    gl = p->gl;
-    fftBuf = p->fftBuf;
-    fftBuf_cpx = p->fftBuf_cpx;
+    LTFAT_NAME(rtdgtreal_ws_carve)(p, ltfat_ws_begin(ws), &fftBuf, &fftBuf_cpx,
+                                   &fftwork);
+    LTFAT_NAME(rtidgtreal_execute_buf)(p, c, W, f, fftBuf, fftBuf_cpx, fftwork);
 
-    for (ltfat_int w = 0; w < W; w++)
-    {
-        const LTFAT_COMPLEX* cchan = c + w * M2;
-        LTFAT_REAL* fchan = f + w * gl;
+    return LTFATERR_SUCCESS;
+error:
+    return status;
+}
 
-        memcpy(fftBuf_cpx, cchan, M2 * sizeof * cchan);
+LTFAT_API int
+LTFAT_NAME(rtidgtreal_setmaxframes)(LTFAT_NAME(rtidgtreal_plan)* p,
+                                    ltfat_int framesMax)
+{
+    return LTFAT_NAME(rtdgtreal_setmaxframes)(p, framesMax);
+}
 
-        LTFAT_NAME_REAL(ifftreal_execute)(p->pifft);
+LTFAT_API int
+LTFAT_NAME(rtidgtreal_execute_frames)(const LTFAT_NAME(rtidgtreal_plan)* p,
+                                      const LTFAT_COMPLEX* c, ltfat_int N,
+                                      ltfat_int W, LTFAT_REAL* f)
+{
+    ltfat_int M, M2, gl;
+    int status = LTFATERR_FAILED;
+    CHECKNULL(p); CHECKNULL(c); CHECKNULL(f);
+    CHECK(LTFATERR_NOTPOSARG, N > 0, "N must be positive");
+    CHECK(LTFATERR_NOTPOSARG, W > 0, "W must be positive");
 
-        if (p->ptype == LTFAT_RTDGTPHASE_ZERO)
-            LTFAT_NAME_REAL(circshift)(fftBuf, M, gl / 2, fftBuf );
+    if (!LTFAT_NAME(rtdgtreal_use_multiframe)(p, N * W))
+        return LTFAT_NAME(rtidgtreal_execute)(p, c, N * W, f);
 
-        if (gl > M)
-            LTFAT_NAME_REAL(periodize_array)(fftBuf, M , gl, fftBuf);
+    CHECK(LTFATERR_BADARG, N * W <= p->framesMax,
+          "N*W (passed %td) must be at most %td", N * W, p->framesMax);
 
-        if (p->g)
-            for (ltfat_int ii = 0; ii < gl; ii++)
-                fftBuf[ii] *= p->g[ii];
+    M = p->M;
+    M2 = M / 2 + 1;
+    gl = p->gl;
 
-        memcpy(fchan, fftBuf, gl * sizeof * fchan);
-    }
+    memcpy(p->framesBuf_cpx, c, N * W * M2 * sizeof * c);
+
+    LTFAT_NAME_REAL(ifftreal_execute)(p->pifftFrames);
+
+    for (ltfat_int n = 0; n < N * W; n++)
+        LTFAT_NAME(rtidgtreal_postframe)(p, p->framesBuf + n * M, f + n * gl);
 
     return LTFATERR_SUCCESS;
 error:
@@ -211,6 +534,10 @@ LTFAT_NAME(rtdgtreal_done)(LTFAT_NAME(rtdgtreal_plan)** p)
     ltfat_safefree(pp->fftBuf_cpx);
     if (pp->pfft) LTFAT_NAME_REAL(fftreal_done)(&pp->pfft);
     if (pp->pifft) LTFAT_NAME_REAL(ifftreal_done)(&pp->pifft);
+    if (pp->pfftFrames) LTFAT_NAME_REAL(fftreal_done)(&pp->pfftFrames);
+    if (pp->pifftFrames) LTFAT_NAME_REAL(ifftreal_done)(&pp->pifftFrames);
+    ltfat_safefree(pp->framesBuf);
+    ltfat_safefree(pp->framesBuf_cpx);
     ltfat_free(pp);
     pp = NULL;
 
@@ -246,8 +573,75 @@ struct LTFAT_NAME(rtdgtreal_processor_state)
     int garbageBinSize;
     const LTFAT_REAL** inTmp;
     LTFAT_REAL** outTmp;
+    LTFAT_NAME(rtdgtreal_processor_batchcallback)*
+    batchCallback; //!< Custom multi-frame processor callback
+    void* batchUserdata; //!< Multi-frame callback data
+    ltfat_int batchMax; //!< Maximum number of frames per batch
+    LTFAT_REAL* batchBuf; //!< max(gal,gsl) x batchMax x numChans
+    LTFAT_COMPLEX* batchIn; //!< M2 x batchMax x numChans
+    LTFAT_COMPLEX* batchOut; //!< M2 x batchMax x numChans
+    ltfat_int procDelay;
+    ltfat_thread_t worker; //!< DSP thread of the worker mode
+    ltfat_mutex_t workerMutex;
+    ltfat_cond_t workerCond;
+    int workerRunning;
+    ltfat_int workerStop;
+    uint64_t underruns; //!< Output samples the worker did not deliver in time (atomic)
+    ltfat_int lateSamples; //!< Late output samples still to be dropped, audio thread only
+    ltfat_procstats_state* stats; //!< NULL unless recording is enabled
+    int nthreads; //!< Number of threads processing the channels
+    ltfat_threadpool* pool; //!< nthreads - 1 workers owned by the processor
+    char* threadws; //!< Workspace of each thread for fwdplan and backplan
+    size_t threadwsLen; //!< Bytes per thread in threadws
+    LTFAT_REAL* parBuf; //!< gsl x numChans synthesis output of the threads
+    LTFAT_NAME(rtdgtreal_processor_groupcallback)*
+    groupCallback; //!< Custom callback processing a range of channels
+    void* groupUserdata; //!< Channel group callback data
 };
 
+static void
+LTFAT_NAME(rtdgtreal_processor_freethreads)(
+    LTFAT_NAME(rtdgtreal_processor_state)* p)
+{
+    ltfat_threadpool_done(&p->pool);
+    LTFAT_SAFEFREEALL(p->threadws, p->parBuf);
+    p->threadws = NULL; p->parBuf = NULL;
+    p->threadwsLen = 0;
+    p->nthreads = 1;
+}
+
+/* (Re)creates the FIFOs. The synthesis FIFO is prefilled with latency
+ * zeros and both FIFOs have room for additional latency samples. */
+static int
+LTFAT_NAME(rtdgtreal_processor_makefifos)(
+    LTFAT_NAME(rtdgtreal_processor_state)* p, ltfat_int numChans,
+    ltfat_int anaa, ltfat_int syna, ltfat_int latency)
+{
+    LTFAT_NAME(analysis_fifo_state)* fwdfifo = NULL;
+    LTFAT_NAME(synthesis_fifo_state)* backfifo = NULL;
+    ltfat_int gal = p->fwdplan->gl, gsl = p->backplan->gl;
+    int status = LTFATERR_SUCCESS;
+
+    CHECKSTATUS(
+        LTFAT_NAME(analysis_fifo_init)(p->bufLenMax + gal + latency, p->procDelay,
+                                       gal, anaa, numChans, &fwdfifo));
+
+    CHECKSTATUS(
+        LTFAT_NAME(synthesis_fifo_init)(p->bufLenMax + gsl + latency, gsl, syna,
+                                        numChans, &backfifo));
+    backfifo->writeIdx = latency;
+
+    if (p->fwdfifo) LTFAT_NAME(analysis_fifo_done)(&p->fwdfifo);
+    if (p->backfifo) LTFAT_NAME(synthesis_fifo_done)(&p->backfifo);
+    p->fwdfifo = fwdfifo;
+    p->backfifo = backfifo;
+    p->lateSamples = 0;
+    return status;
+error:
+    if (fwdfifo) LTFAT_NAME(analysis_fifo_done)(&fwdfifo);
+    return status;
+}
+
 
 LTFAT_API int
 LTFAT_NAME(rtdgtreal_processor_init)(const LTFAT_REAL* ga, ltfat_int gal,
@@ -280,17 +674,10 @@ LTFAT_NAME(rtdgtreal_processor_init)(const LTFAT_REAL* ga, ltfat_int gal,
     CHECKMEM(
         p->fftbufOut = LTFAT_NAME_COMPLEX(malloc)( numChans * (M / 2 + 1)));
 
-    CHECKMEM( p->buf = LTFAT_NAME_REAL(malloc)( numChans * gal));
+    CHECKMEM( p->buf = LTFAT_NAME_REAL(malloc)( numChans * (glmax + 1)));
     CHECKMEM( p->inTmp =  LTFAT_NEWARRAY(const LTFAT_REAL*, numChans));
     CHECKMEM( p->outTmp = LTFAT_NEWARRAY(LTFAT_REAL*, numChans));
 
-    CHECKSTATUS(
-        LTFAT_NAME(analysis_fifo_init)(bufLenMax + gal, procDelay,
-                                        gal, a, numChans, &p->fwdfifo));
-
-    CHECKSTATUS(
-        LTFAT_NAME(synthesis_fifo_init)(bufLenMax + gsl, gsl, a, numChans, &p->backfifo));
-
     CHECKSTATUS( LTFAT_NAME(rtdgtreal_init)(ga, gal, M, LTFAT_RTDGTPHASE_ZERO,
                                             &p->fwdplan));
 
@@ -300,6 +687,11 @@ LTFAT_NAME(rtdgtreal_processor_init)(const LTFAT_REAL* ga, ltfat_int gal,
     p->fwdtra = &LTFAT_NAME(rtdgtreal_execute_wrapper);
     p->backtra = &LTFAT_NAME(rtidgtreal_execute_wrapper);
     p->bufLenMax = bufLenMax;
+    p->procDelay = procDelay;
+    p->nthreads = 1;
+
+    CHECKSTATUS(
+        LTFAT_NAME(rtdgtreal_processor_makefifos)(p, numChans, a, a, 0));
 
     *pout = p;
     return LTFATERR_SUCCESS;
@@ -313,6 +705,8 @@ LTFAT_NAME(rtdgtreal_processor_reset)(LTFAT_NAME(rtdgtreal_processor_state)* p)
 {
     int status = LTFATERR_FAILED;
     CHECKNULL(p);
+    CHECK(LTFATERR_BADARG, !p->workerRunning,
+          "The processor cannot be reset while the worker is running.");
 
     LTFAT_NAME(analysis_fifo_reset)(p->fwdfifo);
     LTFAT_NAME(synthesis_fifo_reset)(p->backfifo);
@@ -328,6 +722,8 @@ LTFAT_NAME(rtdgtreal_processor_setanaa)(LTFAT_NAME(rtdgtreal_processor_state)*
 {
     int status = LTFATERR_FAILED;
     CHECKNULL(p);
+    CHECK(LTFATERR_BADARG, !p->workerRunning,
+          "The hop size cannot be changed while the worker is running.");
 
     LTFAT_NAME(analysis_fifo_sethop)(p->fwdfifo, a);
 
@@ -342,6 +738,8 @@ LTFAT_NAME(rtdgtreal_processor_setsyna)(LTFAT_NAME(rtdgtreal_processor_state)*
 {
     int status = LTFATERR_FAILED;
     CHECKNULL(p);
+    CHECK(LTFATERR_BADARG, !p->workerRunning,
+          "The hop size cannot be changed while the worker is running.");
 
     LTFAT_NAME(synthesis_fifo_sethop)(p->backfifo, a);
 
@@ -399,6 +797,8 @@ LTFAT_NAME(rtdgtreal_processor_setcallback)(
 {
     int status = LTFATERR_FAILED;
     CHECKNULL(p);
+    CHECK(LTFATERR_BADARG, !p->workerRunning,
+          "The callback cannot be replaced while the worker is running.");
     p->processorCallback = callback;
     p->userdata = userdata;
 
@@ -407,6 +807,467 @@ error:
     return status;
 }
 
+static void
+LTFAT_NAME(rtdgtreal_processor_freebatch)(
+    LTFAT_NAME(rtdgtreal_processor_state)* p)
+{
+    LTFAT_SAFEFREEALL(p->batchBuf, p->batchIn, p->batchOut);
+    p->batchBuf = NULL; p->batchIn = NULL; p->batchOut = NULL;
+    p->batchMax = 0;
+}
+
+LTFAT_API int
+LTFAT_NAME(rtdgtreal_processor_setbatchcallback)(
+    LTFAT_NAME(rtdgtreal_processor_state)* p,
+    LTFAT_NAME(rtdgtreal_processor_batchcallback)* callback,
+    void* userdata)
+{
+    ltfat_int batchMax, W, M2, glmax;
+    int status = LTFATERR_FAILED;
+    CHECKNULL(p);
+    CHECK(LTFATERR_BADARG, !p->workerRunning,
+          "The callback cannot be replaced while the worker is running.");
+
+    W = p->fwdfifo->numChans;
+    M2 = p->fwdplan->M / 2 + 1;
+    glmax = ltfat_imax(p->fwdplan->gl, p->backplan->gl);
+    // Frames accumulated from a single bufLenMax long input
+    batchMax = ltfat_idivceil(p->bufLenMax, p->fwdfifo->hop) + 1;
+
+    p->batchCallback = NULL;
+
+    if (!callback)
+    {
+        LTFAT_NAME(rtdgtreal_processor_freebatch)(p);
+        CHECKSTATUS( LTFAT_NAME(rtdgtreal_setmaxframes)(p->fwdplan, 0));
+        CHECKSTATUS( LTFAT_NAME(rtidgtreal_setmaxframes)(p->backplan, 0));
+        return LTFATERR_SUCCESS;
+    }
+
+    if (batchMax != p->batchMax)
+    {
+        LTFAT_NAME(rtdgtreal_processor_freebatch)(p);
+        CHECKMEM( p->batchBuf = LTFAT_NAME_REAL(malloc)(glmax * batchMax * W));
+        CHECKMEM( p->batchIn = LTFAT_NAME_COMPLEX(malloc)(M2 * batchMax * W));
+        CHECKMEM( p->batchOut = LTFAT_NAME_COMPLEX(malloc)(M2 * batchMax * W));
+        CHECKSTATUS(
+            LTFAT_NAME(rtdgtreal_setmaxframes)(p->fwdplan, batchMax * W));
+        CHECKSTATUS(
+            LTFAT_NAME(rtidgtreal_setmaxframes)(p->backplan, batchMax * W));
+        p->batchMax = batchMax;
+    }
+
+    p->batchCallback = callback;
+    p->batchUserdata = userdata;
+
+    return LTFATERR_SUCCESS;
+error:
+    LTFAT_NAME(rtdgtreal_processor_freebatch)(p);
+    return status;
+}
+
+#define RTDGTREAL_CHAN_FWD 1
+#define RTDGTREAL_CHAN_CB  2
+#define RTDGTREAL_CHAN_INV 4
+
+typedef struct
+{
+    LTFAT_NAME(rtdgtreal_processor_state)* p;
+    int steps;
+} LTFAT_NAME(rtdgtreal_processor_chanjob);
+
+/* Processes channels start,...,end-1 of the current frame using the
+ * workspace of thread threadid. The channels are independent so the result does not
+ * depend on how they are split among the threads. */
+static void
+LTFAT_NAME(rtdgtreal_processor_chanrange)(void* userdata, ltfat_int start,
+        ltfat_int end, int threadid)
+{
+    LTFAT_NAME(rtdgtreal_processor_chanjob)* job =
+        (LTFAT_NAME(rtdgtreal_processor_chanjob)*) userdata;
+    LTFAT_NAME(rtdgtreal_processor_state)* p = job->p;
+    ltfat_int M2 = p->fwdplan->M / 2 + 1, W = end - start;
+    void* ws = p->threadws + threadid * p->threadwsLen;
+
+    if (job->steps & RTDGTREAL_CHAN_FWD)
+        LTFAT_NAME(rtdgtreal_execute_ws)(p->fwdplan,
+                                         p->buf + start * p->fwdplan->gl, W,
+                                         p->fftbufIn + start * M2, ws);
+
+    if (job->steps & RTDGTREAL_CHAN_CB)
+        p->groupCallback(p->groupUserdata, p->fftbufIn + start * M2, M2,
+                         start, W, p->fftbufOut + start * M2);
+
+    if (job->steps & RTDGTREAL_CHAN_INV)
+        LTFAT_NAME(rtidgtreal_execute_ws)(p->backplan,
+                                          p->fftbufOut + start * M2, W,
+                                          p->parBuf + start * p->backplan->gl, ws);
+}
+
+static void
+LTFAT_NAME(rtdgtreal_processor_drainparallel)(
+    LTFAT_NAME(rtdgtreal_processor_state)* p,
+    LTFAT_NAME(rtdgtreal_processor_callback)* processorCallback,
+    ltfat_procstats_call* sc)
+{
+    LTFAT_NAME(rtdgtreal_processor_chanjob) job;
+    ltfat_int W = p->fwdfifo->numChans;
+    job.p = p;
+
+    while ( LTFAT_NAME(synthesis_fifo_writable)(p->backfifo) > 0 &&
+            LTFAT_NAME(analysis_fifo_read)(p->fwdfifo, p->buf) > 0 )
+    {
+        if (p->groupCallback)
+        {
+            // A single pass, each thread takes its channels all the way through
+            job.steps = RTDGTREAL_CHAN_FWD | RTDGTREAL_CHAN_CB | RTDGTREAL_CHAN_INV;
+            ltfat_threadpool_run(p->pool, W,
+                                 &LTFAT_NAME(rtdgtreal_processor_chanrange), &job);
+            if (sc) ltfat_procstats_lap(sc, ltfat_procstats_callback);
+        }
+        else
+        {
+            // The callback sees all channels at once
+            job.steps = RTDGTREAL_CHAN_FWD;
+            ltfat_threadpool_run(p->pool, W,
+                                 &LTFAT_NAME(rtdgtreal_processor_chanrange), &job);
+            if (sc) ltfat_procstats_lap(sc, ltfat_procstats_forward);
+
+            processorCallback(p->userdata, p->fftbufIn, p->fwdplan->M / 2 + 1,
+                              W, p->fftbufOut);
+            if (sc) ltfat_procstats_lap(sc, ltfat_procstats_callback);
+
+            job.steps = RTDGTREAL_CHAN_INV;
+            ltfat_threadpool_run(p->pool, W,
+                                 &LTFAT_NAME(rtdgtreal_processor_chanrange), &job);
+        }
+
+        // ltfat_threadpool_run returns only after all channels are done
+        LTFAT_NAME(synthesis_fifo_write)(p->backfifo, p->parBuf);
+
+        if (sc)
+        {
+            ltfat_procstats_lap(sc, ltfat_procstats_inverse);
+            sc->frames++;
+        }
+    }
+}
+
+/* Processes all frames which are both available in the analysis FIFO and
+ * fit in the synthesis FIFO. */
+static void
+LTFAT_NAME(rtdgtreal_processor_drain)(LTFAT_NAME(rtdgtreal_processor_state)* p,
+                                      ltfat_procstats_call* sc)
+{
+    // Get default processor if none was set
+    LTFAT_NAME(rtdgtreal_processor_callback)* processorCallback =
+        p->processorCallback;
+
+    if (!processorCallback)
+        processorCallback = &LTFAT_NAME(default_rtdgtreal_processor_callback);
+
+    if (p->batchCallback)
+    {
+        ltfat_int N, W = p->fwdfifo->numChans;
+        ltfat_int gal = p->fwdplan->gl, gsl = p->backplan->gl;
+
+        // Frames of all channels are read into a gal x N x W array
+        while ( (N = ltfat_imin(p->batchMax, ltfat_imin(
+                                    LTFAT_NAME(analysis_fifo_readable)(p->fwdfifo),
+                                    LTFAT_NAME(synthesis_fifo_writable)(p->backfifo)))) > 0 )
+        {
+            LTFAT_NAME(analysis_fifo_setreadchanstride)(p->fwdfifo, N * gal);
+            for (ltfat_int n = 0; n < N; n++)
+                LTFAT_NAME(analysis_fifo_read)(p->fwdfifo, p->batchBuf + n * gal);
+
+            LTFAT_NAME(rtdgtreal_execute_frames)(p->fwdplan, p->batchBuf, N, W,
+                                                 p->batchIn);
+            if (sc) ltfat_procstats_lap(sc, ltfat_procstats_forward);
+
+            p->batchCallback(p->batchUserdata, p->batchIn,
+                             p->fwdplan->M / 2 + 1, N, W, p->batchOut);
+            if (sc) ltfat_procstats_lap(sc, ltfat_procstats_callback);
+
+            LTFAT_NAME(rtidgtreal_execute_frames)(p->backplan, p->batchOut, N, W,
+                                                  p->batchBuf);
+
+            LTFAT_NAME(synthesis_fifo_setwritechanstride)(p->backfifo, N * gsl);
+            for (ltfat_int n = 0; n < N; n++)
+                LTFAT_NAME(synthesis_fifo_write)(p->backfifo, p->batchBuf + n * gsl);
+
+            if (sc)
+            {
+                ltfat_procstats_lap(sc, ltfat_procstats_inverse);
+                sc->frames += N;
+            }
+        }
+
+        LTFAT_NAME(analysis_fifo_setreadchanstride)(p->fwdfifo, gal);
+        LTFAT_NAME(synthesis_fifo_setwritechanstride)(p->backfifo, gsl);
+    }
+    else if (p->nthreads > 1)
+    {
+        LTFAT_NAME(rtdgtreal_processor_drainparallel)(p, processorCallback, sc);
+    }
+    else
+    {
+        // While there is new data in the input fifo
+        while ( LTFAT_NAME(synthesis_fifo_writable)(p->backfifo) > 0 &&
+                LTFAT_NAME(analysis_fifo_read)(p->fwdfifo, p->buf) > 0 )
+        {
+            // Transform
+            p->fwdtra((void*)p->fwdplan, p->buf, p->fwdfifo->numChans,
+                      p->fftbufIn);
+            if (sc) ltfat_procstats_lap(sc, ltfat_procstats_forward);
+
+            // Process
+            if (p->groupCallback)
+                p->groupCallback(p->groupUserdata, p->fftbufIn,
+                                 p->fwdplan->M / 2 + 1, 0, p->fwdfifo->numChans,
+                                 p->fftbufOut);
+            else
+                processorCallback(p->userdata, p->fftbufIn, p->fwdplan->M / 2 + 1,
+                                  p->fwdfifo->numChans, p->fftbufOut);
+            if (sc) ltfat_procstats_lap(sc, ltfat_procstats_callback);
+
+            // Reconstruct
+            p->backtra((void*)p->backplan, p->fftbufOut, p->backfifo->numChans, p->buf);
+
+            // Write (and overlap) to out fifo
+            LTFAT_NAME(synthesis_fifo_write)(p->backfifo, p->buf);
+
+            if (sc)
+            {
+                ltfat_procstats_lap(sc, ltfat_procstats_inverse);
+                sc->frames++;
+            }
+        }
+    }
+}
+
+static int
+LTFAT_NAME(rtdgtreal_processor_pending)(LTFAT_NAME(rtdgtreal_processor_state)* p)
+{
+    return LTFAT_NAME(analysis_fifo_readable)(p->fwdfifo) > 0 &&
+           LTFAT_NAME(synthesis_fifo_writable)(p->backfifo) > 0;
+}
+
+/* The DSP thread of the worker mode.
+ * The audio thread signals new data only if it gets the mutex without
+ * waiting, so a wakeup can be missed. The timeout bounds the resulting
+ * delay. */
+static void
+LTFAT_NAME(rtdgtreal_processor_worker)(void* arg)
+{
+    LTFAT_NAME(rtdgtreal_processor_state)* p =
+        (LTFAT_NAME(rtdgtreal_processor_state)*) arg;
+
+    while (!ltfat_atomic_load_acquire(&p->workerStop))
+    {
+        // The frames are due for the audio thread just as in the other modes
+        ltfat_rtsafe_enter();
+        if (p->stats)
+        {
+            ltfat_procstats_call sc;
+            ltfat_procstats_begin(&sc);
+            LTFAT_NAME(rtdgtreal_processor_drain)(p, &sc);
+            if (sc.frames) ltfat_procstats_commit(p->stats, &sc, 0);
+        }
+        else
+            LTFAT_NAME(rtdgtreal_processor_drain)(p, NULL);
+        ltfat_rtsafe_leave();
+
+        ltfat_mutex_lock(&p->workerMutex);
+        if (!ltfat_atomic_load_acquire(&p->workerStop) &&
+            !LTFAT_NAME(rtdgtreal_processor_pending)(p))
+            ltfat_cond_timedwait_ms(&p->workerCond, &p->workerMutex, 1);
+        ltfat_mutex_unlock(&p->workerMutex);
+    }
+}
+
+static void
+LTFAT_NAME(rtdgtreal_processor_joinworker)(
+    LTFAT_NAME(rtdgtreal_processor_state)* p)
+{
+    ltfat_mutex_lock(&p->workerMutex);
+    ltfat_atomic_store_release(&p->workerStop, 1);
+    ltfat_cond_signal(&p->workerCond);
+    ltfat_mutex_unlock(&p->workerMutex);
+
+    ltfat_thread_join(&p->worker);
+    ltfat_cond_destroy(&p->workerCond);
+    ltfat_mutex_destroy(&p->workerMutex);
+    p->workerRunning = 0;
+}
+
+LTFAT_API int
+LTFAT_NAME(rtdgtreal_processor_startworker)(
+    LTFAT_NAME(rtdgtreal_processor_state)* p, ltfat_int latency)
+{
+    int threadfailed;
+    int status = LTFATERR_FAILED;
+    CHECKNULL(p);
+    CHECK(LTFATERR_BADARG, latency >= 0,
+          "latency must be nonnegative (passed %td)", latency);
+    CHECK(LTFATERR_BADARG, !p->workerRunning, "The worker is already running.");
+
+    CHECKSTATUS(
+        LTFAT_NAME(rtdgtreal_processor_makefifos)(p, p->fwdfifo->numChans,
+                p->fwdfifo->hop, p->backfifo->hop, latency));
+
+    ltfat_mutex_init(&p->workerMutex);
+    ltfat_cond_init(&p->workerCond);
+    p->workerStop = 0;
+    ltfat_atomic_store_u64(&p->underruns, 0);
+
+    threadfailed = ltfat_thread_create(&p->worker,
+                                       &LTFAT_NAME(rtdgtreal_processor_worker), p);
+    if (threadfailed)
+    {
+        ltfat_cond_destroy(&p->workerCond);
+        ltfat_mutex_destroy(&p->workerMutex);
+        LTFAT_NAME(rtdgtreal_processor_makefifos)(p, p->fwdfifo->numChans,
+                p->fwdfifo->hop, p->backfifo->hop, 0);
+    }
+    CHECKINIT(!threadfailed, "Worker thread creation failed.");
+
+    p->workerRunning = 1;
+    return LTFATERR_SUCCESS;
+error:
+    return status;
+}
+
+LTFAT_API int
+LTFAT_NAME(rtdgtreal_processor_stopworker)(
+    LTFAT_NAME(rtdgtreal_processor_state)* p)
+{
+    int status = LTFATERR_FAILED;
+    CHECKNULL(p);
+
+    if (!p->workerRunning) return LTFATERR_SUCCESS;
+
+    LTFAT_NAME(rtdgtreal_processor_joinworker)(p);
+
+    CHECKSTATUS(
+        LTFAT_NAME(rtdgtreal_processor_makefifos)(p, p->fwdfifo->numChans,
+                p->fwdfifo->hop, p->backfifo->hop, 0));
+
+    return LTFATERR_SUCCESS;
+error:
+    return status;
+}
+
+LTFAT_API int
+LTFAT_NAME(rtdgtreal_processor_set_numthreads)(
+    LTFAT_NAME(rtdgtreal_processor_state)* p, int nthreads)
+{
+    ltfat_int numChans;
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(p);
+    CHECK(LTFATERR_NOTINRANGE, nthreads >= 0 && nthreads <= LTFAT_MAXTHREADS,
+          "nthreads (passed %d) must be in range 0-%d.", nthreads, LTFAT_MAXTHREADS);
+    CHECK(LTFATERR_BADARG, !p->workerRunning,
+          "The number of threads cannot be changed while the worker is running.");
+
+    numChans = p->fwdfifo->numChans;
+    if (nthreads == 0) nthreads = ltfat_get_num_threads();
+    // Each thread gets at least one channel
+    if (nthreads > numChans) nthreads = (int) numChans;
+
+    LTFAT_NAME(rtdgtreal_processor_freethreads)(p);
+    if (nthreads <= 1) return LTFATERR_SUCCESS;
+
+    // The plans are shared, the forward and the inverse transform of a
+    // thread run one after another and use the same workspace.
+    p->threadwsLen = ltfat_ws_roundup(ltfat_ws_max(
+            LTFAT_NAME(rtdgtreal_get_workspace_size)(p->fwdplan),
+            LTFAT_NAME(rtidgtreal_get_workspace_size)(p->backplan)));
+    CHECKMEM( p->threadws = (char*) ltfat_malloc(nthreads * p->threadwsLen));
+    CHECKMEM( p->parBuf = LTFAT_NAME_REAL(malloc)(numChans * p->backplan->gl));
+    // The processor has its own threads so that it never waits for
+    // somebody else's job in the library pool
+    CHECKSTATUS( ltfat_threadpool_init(nthreads - 1, &p->pool) );
+    p->nthreads = nthreads;
+
+    return LTFATERR_SUCCESS;
+error:
+    if (p) LTFAT_NAME(rtdgtreal_processor_freethreads)(p);
+    return status;
+}
+
+LTFAT_API int
+LTFAT_NAME(rtdgtreal_processor_setgroupcallback)(
+    LTFAT_NAME(rtdgtreal_processor_state)* p,
+    LTFAT_NAME(rtdgtreal_processor_groupcallback)* callback, void* userdata)
+{
+    int status = LTFATERR_FAILED;
+    CHECKNULL(p);
+    CHECK(LTFATERR_BADARG, !p->workerRunning,
+          "The callback cannot be replaced while the worker is running.");
+    p->groupCallback = callback;
+    p->groupUserdata = userdata;
+
+    return LTFATERR_SUCCESS;
+error:
+    return status;
+}
+
+LTFAT_API size_t
+LTFAT_NAME(rtdgtreal_processor_getunderruns)(
+    const LTFAT_NAME(rtdgtreal_processor_state)* p)
+{
+    return p ? (size_t) ltfat_atomic_load_u64(&p->underruns) : 0;
+}
+
+LTFAT_API int
+LTFAT_NAME(rtdgtreal_processor_setstats)(
+    LTFAT_NAME(rtdgtreal_processor_state)* p, int enable)
+{
+    int status = LTFATERR_FAILED;
+    CHECKNULL(p);
+    CHECK(LTFATERR_BADARG, !p->workerRunning,
+          "The stats cannot be switched while the worker is running.");
+
+    if (enable && !p->stats)
+        CHECKSTATUS( ltfat_procstats_init(&p->stats) );
+    else if (!enable && p->stats)
+    {
+        ltfat_procstats_done(p->stats);
+        p->stats = NULL;
+    }
+
+    return LTFATERR_SUCCESS;
+error:
+    return status;
+}
+
+LTFAT_API int
+LTFAT_NAME(rtdgtreal_processor_getstats)(
+    const LTFAT_NAME(rtdgtreal_processor_state)* p, ltfat_procstats* stats)
+{
+    int status = LTFATERR_FAILED;
+    CHECKNULL(p); CHECKNULL(stats);
+    CHECK(LTFATERR_FAILED, p->stats, "The stats are not enabled.");
+
+    return ltfat_procstats_snapshot(p->stats, stats);
+error:
+    return status;
+}
+
+LTFAT_API int
+LTFAT_NAME(rtdgtreal_processor_resetstats)(
+    LTFAT_NAME(rtdgtreal_processor_state)* p)
+{
+    int status = LTFATERR_FAILED;
+    CHECKNULL(p);
+    CHECK(LTFATERR_FAILED, p->stats, "The stats are not enabled.");
+
+    ltfat_procstats_reset(p->stats);
+    return LTFATERR_SUCCESS;
+error:
+    return status;
+}
+
 LTFAT_API int
 LTFAT_NAME(rtdgtreal_processor_execute_compact)(
     LTFAT_NAME(rtdgtreal_processor_state)* p, const LTFAT_REAL* in,
@@ -464,17 +1325,16 @@ LTFAT_NAME(rtdgtreal_processor_execute)(
 }
 
 
-LTFAT_API int
-LTFAT_NAME(rtdgtreal_processor_execute_gen)(
+/* Sample l of channel w is in[w][l*stride] and out[w][l*stride] */
+static int
+LTFAT_NAME(rtdgtreal_processor_execute_gen_guts)(
     LTFAT_NAME(rtdgtreal_processor_state)* p,
     const LTFAT_REAL** in, ltfat_int inLen, ltfat_int chanNo, ltfat_int outLen,
-    LTFAT_REAL** out)
+    LTFAT_REAL** out, ltfat_int stride)
 {
     int status = LTFATERR_FAILED;
     ltfat_int samplesWritten = 0, samplesRead = 0;
-    // Get default processor if none was set
-    LTFAT_NAME(rtdgtreal_processor_callback)* processorCallback =
-        p->processorCallback;
+    ltfat_procstats_call scbuf, *sc = NULL;
 
     // Failing these checks prohibits execution altogether
     CHECKNULL(p); CHECKNULL(in); CHECKNULL(out);
@@ -486,13 +1346,19 @@ LTFAT_NAME(rtdgtreal_processor_execute_gen)(
     // Just dont do anything
     if (chanNo == 0 || (inLen == 0 && outLen == 0)) return LTFATERR_SUCCESS;
 
+    if (p->stats)
+    {
+        sc = &scbuf;
+        ltfat_procstats_begin(sc);
+    }
+
     if ( chanNo > p->fwdfifo->numChans )
     {
         DEBUG("Channel overflow (passed %td, max %td)", chanNo, p->fwdfifo->numChans);
         status = LTFATERR_OVERFLOW;
 
         for (ltfat_int w = p->fwdfifo->numChans; w < chanNo; w++)
-            memset(out[w], 0, outLen * sizeof * out[w]);
+            LTFAT_NAME(clear_strided)(out[w], outLen, stride);
 
         chanNo = p->fwdfifo->numChans;
     }
@@ -510,40 +1376,65 @@ LTFAT_NAME(rtdgtreal_processor_execute_gen)(
         status = LTFATERR_OVERFLOW;
 
         for (ltfat_int w = 0; w < chanNo; w++)
-            memset(out[w] + p->bufLenMax, 0, (outLen - p->bufLenMax)*sizeof * out[w]);
+            LTFAT_NAME(clear_strided)(out[w] + p->bufLenMax * stride,
+                                      outLen - p->bufLenMax, stride);
 
         outLen = p->bufLenMax;
     }
 
-    if (!processorCallback)
-        processorCallback = &LTFAT_NAME(default_rtdgtreal_processor_callback);
-
     // Write new data
     samplesWritten =
-        LTFAT_NAME(analysis_fifo_write)(p->fwdfifo, in, inLen, chanNo);
+        LTFAT_NAME(analysis_fifo_write_strided)(p->fwdfifo, in, inLen, stride,
+                chanNo);
+    if (sc) ltfat_procstats_lap(sc, ltfat_procstats_fifowrite);
 
-    // While there is new data in the input fifo
-    while ( LTFAT_NAME(analysis_fifo_read)(p->fwdfifo, p->buf) > 0 )
+    if (p->workerRunning)
     {
-        // Transform
-        p->fwdtra((void*)p->fwdplan, p->buf, p->fwdfifo->numChans,
-                  p->fftbufIn);
-
-        // Process
-        processorCallback(p->userdata, p->fftbufIn, p->fwdplan->M / 2 + 1,
-                          p->fwdfifo->numChans, p->fftbufOut);
-
-        // Reconstruct
-        p->backtra((void*)p->backplan, p->fftbufOut, p->backfifo->numChans, p->buf);
-
-        // Write (and overlap) to out fifo
-        LTFAT_NAME(synthesis_fifo_write)(p->backfifo, p->buf);
+        // Never blocks the audio thread, see rtdgtreal_processor_worker
+        if (ltfat_mutex_trylock(&p->workerMutex))
+        {
+            ltfat_cond_signal(&p->workerCond);
+            ltfat_mutex_unlock(&p->workerMutex);
+        }
+
+        // Samples replaced by zeros earlier are not output late, so that
+        // the delay stays at latency
+        if (p->lateSamples > 0)
+            p->lateSamples -=
+                LTFAT_NAME(synthesis_fifo_skip)(p->backfifo, p->lateSamples);
+
+        samplesRead =
+            LTFAT_NAME(synthesis_fifo_read_strided)(p->backfifo, outLen, chanNo,
+                    stride, out);
+        if (sc) ltfat_procstats_lap(sc, ltfat_procstats_fiforead);
+
+        // The worker did not make it in time
+        if (samplesRead >= 0 && samplesRead < outLen)
+        {
+            for (ltfat_int w = 0; w < chanNo; w++)
+                LTFAT_NAME(clear_strided)(out[w] + samplesRead * stride,
+                                          outLen - samplesRead, stride);
+
+            p->lateSamples += outLen - samplesRead;
+            ltfat_atomic_add_u64(&p->underruns, (uint64_t)(outLen - samplesRead));
+        }
     }
+    else
+    {
+        LTFAT_NAME(rtdgtreal_processor_drain)(p, sc);
 
-    // Read sampples for output
-    samplesRead =
-        LTFAT_NAME(synthesis_fifo_read)(p->backfifo, outLen, chanNo, out);
+        // Read sampples for output
+        samplesRead =
+            LTFAT_NAME(synthesis_fifo_read_strided)(p->backfifo, outLen, chanNo,
+                    stride, out);
+        if (sc) ltfat_procstats_lap(sc, ltfat_procstats_fiforead);
+    }
 
+    if (sc)
+    {
+        ltfat_procstats_end(sc);
+        ltfat_procstats_commit(p->stats, sc, 1);
+    }
     status = LTFATERR_SUCCESS;
 error:
     if (status != LTFATERR_SUCCESS) return status;
@@ -553,6 +1444,74 @@ error:
     return status;
 }
 
+LTFAT_API int
+LTFAT_NAME(rtdgtreal_processor_execute_gen)(
+    LTFAT_NAME(rtdgtreal_processor_state)* p,
+    const LTFAT_REAL** in, ltfat_int inLen, ltfat_int chanNo, ltfat_int outLen,
+    LTFAT_REAL** out)
+{
+    int status;
+
+    // Nothing called from here on is allowed to allocate
+    ltfat_rtsafe_enter();
+    status = LTFAT_NAME(rtdgtreal_processor_execute_gen_guts)(p, in, inLen, chanNo,
+             outLen, out, 1);
+    ltfat_rtsafe_leave();
+    return status;
+}
+
+LTFAT_API int
+LTFAT_NAME(rtdgtreal_processor_execute_interleaved)(
+    LTFAT_NAME(rtdgtreal_processor_state)* p, const LTFAT_REAL* in,
+    ltfat_int len, ltfat_int chanNo, LTFAT_REAL* out)
+{
+    return LTFAT_NAME(rtdgtreal_processor_execute_gen_interleaved)(
+               p, in, len, chanNo, len, out);
+}
+
+LTFAT_API int
+LTFAT_NAME(rtdgtreal_processor_execute_gen_interleaved)(
+    LTFAT_NAME(rtdgtreal_processor_state)* p, const LTFAT_REAL* in,
+    ltfat_int inLen, ltfat_int chanNo, ltfat_int outLen, LTFAT_REAL* out)
+{
+    ltfat_int chanLoc;
+    int status2 = LTFATERR_SUCCESS;
+    int status = LTFATERR_SUCCESS;
+
+    CHECKNULL(p); CHECKNULL(in); CHECKNULL(out);
+    CHECK(LTFATERR_BADSIZE, chanNo >= 0,
+          "chanNo must be positive or zero (passed %td)", chanNo);
+    if (chanNo == 0) return LTFATERR_SUCCESS;
+
+    chanLoc = chanNo > p->fwdfifo->numChans ? p->fwdfifo->numChans : chanNo;
+
+    // No de-interleaving, the FIFOs access the samples with stride chanNo
+    for (ltfat_int w = 0; w < chanLoc; w++)
+    {
+        p->inTmp[w] = in + w;
+        p->outTmp[w] = out + w;
+    }
+
+    // Clear superfluous channels
+    if (chanNo > chanLoc)
+    {
+        DEBUG("Channel overflow (passed %td, max %td)", chanNo, chanLoc);
+        status = LTFATERR_OVERFLOW;
+
+        for (ltfat_int w = chanLoc; w < chanNo; w++)
+            LTFAT_NAME(clear_strided)(out + w, outLen, chanNo);
+    }
+
+    ltfat_rtsafe_enter();
+    status2 = LTFAT_NAME(rtdgtreal_processor_execute_gen_guts)(
+                  p, p->inTmp, inLen, chanLoc, outLen, p->outTmp, chanNo);
+    ltfat_rtsafe_leave();
+
+    if (status2 != LTFATERR_SUCCESS) return status2;
+error:
+    return status;
+}
+
 LTFAT_API int
 LTFAT_NAME(rtdgtreal_processor_done)(LTFAT_NAME(rtdgtreal_processor_state)** p)
 {
@@ -561,11 +1520,15 @@ LTFAT_NAME(rtdgtreal_processor_done)(LTFAT_NAME(rtdgtreal_processor_state)** p)
     CHECKNULL(p); CHECKNULL(*p);
 
     pp = *p;
+    if (pp->workerRunning) LTFAT_NAME(rtdgtreal_processor_joinworker)(pp);
     if (pp->fwdfifo) LTFAT_NAME(analysis_fifo_done)(&pp->fwdfifo);
     if (pp->backfifo) LTFAT_NAME(synthesis_fifo_done)(&pp->backfifo);
     if (pp->fwdplan) LTFAT_NAME(rtdgtreal_done)(&pp->fwdplan);
     if (pp->backplan) LTFAT_NAME(rtidgtreal_done)(&pp->backplan);
     LTFAT_SAFEFREEALL(pp->buf, pp->fftbufIn, pp->fftbufOut, pp->inTmp, pp->outTmp );
+    LTFAT_NAME(rtdgtreal_processor_freebatch)(pp);
+    LTFAT_NAME(rtdgtreal_processor_freethreads)(pp);
+    ltfat_procstats_done(pp->stats);
 
     if (pp->garbageBinSize)
     {
@@ -0,0 +1,25 @@
+#ifndef _ltfat_rtsafe_private_h
+#define _ltfat_rtsafe_private_h
+
+/*
+ * Marks the calling thread as being inside a real-time execute call.
+ * While inside, ltfat_malloc, ltfat_free and ltfat_rtsafe_blocking report
+ * a violation according to the policy set by ltfat_rtsafe_setpolicy.
+ * The calls can be nested.
+ */
+void
+ltfat_rtsafe_enter(void);
+
+void
+ltfat_rtsafe_leave(void);
+
+/* Nonzero if the calling thread is inside, e.g. for passing it on to
+ * the threads doing work on its behalf */
+int
+ltfat_rtsafe_inside(void);
+
+/* To be called before waiting for a lock or for another thread */
+void
+ltfat_rtsafe_blocking(const char* what);
+
+#endif
@@ -0,0 +1,160 @@
+#ifndef _ltfat_simd_private_h
+#define _ltfat_simd_private_h
+
+/*
+ * Vector type holding LTFAT_SIMD_VL interleaved complex numbers of type
+ * LTFAT_REAL. The instruction set is selected at compile time according to
+ * what the compiler targets (SSE2, AVX, AVX-512, NEON). LTFAT_SIMD is not
+ * defined if none of them is available.
+ *
+ *   V_LOAD, V_STORE        unaligned load and store
+ *   V_ADD, V_SUB, V_MUL    elementwise arithmetic
+ *   V_MAX                  elementwise maximum of the 2*LTFAT_SIMD_VL reals
+ *   V_SWAP(a)    swaps real and imaginary parts of each complex number
+ *   V_DUPRE(a), V_DUPIM(a)
+ *                copies the real (imaginary) part of each complex number
+ *                to both of its slots
+ *   V_PAIR(r,i)  (r,i,r,i,...)
+ *   V_SET1(a)    (a,a,a,a,...)
+ */
+
+#if defined(LTFAT_DOUBLE)
+#  if defined(__AVX512F__)
+#    include <immintrin.h>
+#    define LTFAT_SIMD
+#    define LTFAT_SIMD_VL 4
+typedef __m512d ltfat_simd_v;
+#    define V_LOAD(p) _mm512_loadu_pd(p)
+#    define V_STORE(p, a) _mm512_storeu_pd((p), (a))
+#    define V_ADD(a, b) _mm512_add_pd((a), (b))
+#    define V_SUB(a, b) _mm512_sub_pd((a), (b))
+#    define V_MUL(a, b) _mm512_mul_pd((a), (b))
+#    define V_MAX(a, b) _mm512_max_pd((a), (b))
+#    define V_SWAP(a) _mm512_permute_pd((a), 0x55)
+#    define V_DUPRE(a) _mm512_movedup_pd(a)
+#    define V_DUPIM(a) _mm512_permute_pd((a), 0xFF)
+#    define V_PAIR(r, i) _mm512_setr_pd((r), (i), (r), (i), (r), (i), (r), (i))
+#    define V_SET1(a) _mm512_set1_pd(a)
+#  elif defined(__AVX__)
+#    include <immintrin.h>
+#    define LTFAT_SIMD
+#    define LTFAT_SIMD_VL 2
+typedef __m256d ltfat_simd_v;
+#    define V_LOAD(p) _mm256_loadu_pd(p)
+#    define V_STORE(p, a) _mm256_storeu_pd((p), (a))
+#    define V_ADD(a, b) _mm256_add_pd((a), (b))
+#    define V_SUB(a, b) _mm256_sub_pd((a), (b))
+#    define V_MUL(a, b) _mm256_mul_pd((a), (b))
+#    define V_MAX(a, b) _mm256_max_pd((a), (b))
+#    define V_SWAP(a) _mm256_permute_pd((a), 0x5)
+#    define V_DUPRE(a) _mm256_movedup_pd(a)
+#    define V_DUPIM(a) _mm256_permute_pd((a), 0xF)
+#    define V_PAIR(r, i) _mm256_setr_pd((r), (i), (r), (i))
+#    define V_SET1(a) _mm256_set1_pd(a)
+#  elif defined(__SSE2__) || defined(_M_X64)
+#    include <emmintrin.h>
+#    define LTFAT_SIMD
+#    define LTFAT_SIMD_VL 1
+typedef __m128d ltfat_simd_v;
+#    define V_LOAD(p) _mm_loadu_pd(p)
+#    define V_STORE(p, a) _mm_storeu_pd((p), (a))
+#    define V_ADD(a, b) _mm_add_pd((a), (b))
+#    define V_SUB(a, b) _mm_sub_pd((a), (b))
+#    define V_MUL(a, b) _mm_mul_pd((a), (b))
+#    define V_MAX(a, b) _mm_max_pd((a), (b))
+#    define V_SWAP(a) _mm_shuffle_pd((a), (a), 1)
+#    define V_DUPRE(a) _mm_unpacklo_pd((a), (a))
+#    define V_DUPIM(a) _mm_unpackhi_pd((a), (a))
+#    define V_PAIR(r, i) _mm_setr_pd((r), (i))
+#    define V_SET1(a) _mm_set1_pd(a)
+#  elif defined(__ARM_NEON) && defined(__aarch64__)
+#    include <arm_neon.h>
+#    define LTFAT_SIMD
+#    define LTFAT_SIMD_VL 1
+typedef float64x2_t ltfat_simd_v;
+static inline float64x2_t
+ltfat_simd_pair_d(double r, double i) { double t[2] = {r, i}; return vld1q_f64(t); }
+#    define V_LOAD(p) vld1q_f64(p)
+#    define V_STORE(p, a) vst1q_f64((p), (a))
+#    define V_ADD(a, b) vaddq_f64((a), (b))
+#    define V_SUB(a, b) vsubq_f64((a), (b))
+#    define V_MUL(a, b) vmulq_f64((a), (b))
+#    define V_MAX(a, b) vmaxq_f64((a), (b))
+#    define V_SWAP(a) vextq_f64((a), (a), 1)
+#    define V_DUPRE(a) vdupq_laneq_f64((a), 0)
+#    define V_DUPIM(a) vdupq_laneq_f64((a), 1)
+#    define V_PAIR(r, i) ltfat_simd_pair_d((r), (i))
+#    define V_SET1(a) vdupq_n_f64(a)
+#  endif
+#elif defined(LTFAT_SINGLE)
+#  if defined(__AVX512F__)
+#    include <immintrin.h>
+#    define LTFAT_SIMD
+#    define LTFAT_SIMD_VL 8
+typedef __m512 ltfat_simd_v;
+#    define V_LOAD(p) _mm512_loadu_ps(p)
+#    define V_STORE(p, a) _mm512_storeu_ps((p), (a))
+#    define V_ADD(a, b) _mm512_add_ps((a), (b))
+#    define V_SUB(a, b) _mm512_sub_ps((a), (b))
+#    define V_MUL(a, b) _mm512_mul_ps((a), (b))
+#    define V_MAX(a, b) _mm512_max_ps((a), (b))
+#    define V_SWAP(a) _mm512_permute_ps((a), 0xB1)
+#    define V_DUPRE(a) _mm512_moveldup_ps(a)
+#    define V_DUPIM(a) _mm512_movehdup_ps(a)
+#    define V_PAIR(r, i) _mm512_setr_ps((r), (i), (r), (i), (r), (i), (r), (i), \
+                                         (r), (i), (r), (i), (r), (i), (r), (i))
+#    define V_SET1(a) _mm512_set1_ps(a)
+#  elif defined(__AVX__)
+#    include <immintrin.h>
+#    define LTFAT_SIMD
+#    define LTFAT_SIMD_VL 4
+typedef __m256 ltfat_simd_v;
+#    define V_LOAD(p) _mm256_loadu_ps(p)
+#    define V_STORE(p, a) _mm256_storeu_ps((p), (a))
+#    define V_ADD(a, b) _mm256_add_ps((a), (b))
+#    define V_SUB(a, b) _mm256_sub_ps((a), (b))
+#    define V_MUL(a, b) _mm256_mul_ps((a), (b))
+#    define V_MAX(a, b) _mm256_max_ps((a), (b))
+#    define V_SWAP(a) _mm256_permute_ps((a), 0xB1)
+#    define V_DUPRE(a) _mm256_moveldup_ps(a)
+#    define V_DUPIM(a) _mm256_movehdup_ps(a)
+#    define V_PAIR(r, i) _mm256_setr_ps((r), (i), (r), (i), (r), (i), (r), (i))
+#    define V_SET1(a) _mm256_set1_ps(a)
+#  elif defined(__SSE2__) || defined(_M_X64)
+#    include <emmintrin.h>
+#    define LTFAT_SIMD
+#    define LTFAT_SIMD_VL 2
+typedef __m128 ltfat_simd_v;
+#    define V_LOAD(p) _mm_loadu_ps(p)
+#    define V_STORE(p, a) _mm_storeu_ps((p), (a))
+#    define V_ADD(a, b) _mm_add_ps((a), (b))
+#    define V_SUB(a, b) _mm_sub_ps((a), (b))
+#    define V_MUL(a, b) _mm_mul_ps((a), (b))
+#    define V_MAX(a, b) _mm_max_ps((a), (b))
+#    define V_SWAP(a) _mm_shuffle_ps((a), (a), 0xB1)
+#    define V_DUPRE(a) _mm_shuffle_ps((a), (a), 0xA0)
+#    define V_DUPIM(a) _mm_shuffle_ps((a), (a), 0xF5)
+#    define V_PAIR(r, i) _mm_setr_ps((r), (i), (r), (i))
+#    define V_SET1(a) _mm_set1_ps(a)
+#  elif defined(__ARM_NEON)
+#    include <arm_neon.h>
+#    define LTFAT_SIMD
+#    define LTFAT_SIMD_VL 2
+typedef float32x4_t ltfat_simd_v;
+static inline float32x4_t
+ltfat_simd_pair_s(float r, float i) { float t[4] = {r, i, r, i}; return vld1q_f32(t); }
+#    define V_LOAD(p) vld1q_f32(p)
+#    define V_STORE(p, a) vst1q_f32((p), (a))
+#    define V_ADD(a, b) vaddq_f32((a), (b))
+#    define V_SUB(a, b) vsubq_f32((a), (b))
+#    define V_MUL(a, b) vmulq_f32((a), (b))
+#    define V_MAX(a, b) vmaxq_f32((a), (b))
+#    define V_SWAP(a) vrev64q_f32(a)
+#    define V_DUPRE(a) vtrnq_f32((a), (a)).val[0]
+#    define V_DUPIM(a) vtrnq_f32((a), (a)).val[1]
+#    define V_PAIR(r, i) ltfat_simd_pair_s((r), (i))
+#    define V_SET1(a) vdupq_n_f32(a)
+#  endif
+#endif
+
+#endif
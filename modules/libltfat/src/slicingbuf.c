@@ -3,6 +3,7 @@
 #include "ltfat/macros.h"
 #include "circularbuf_private.h"
 #include "slicingbuf_private.h"
+#include "threads_private.h"
 
 LTFAT_API int
 LTFAT_NAME(slicing_processor_init)( ltfat_int winLen, ltfat_int taperLen,
@@ -33,6 +34,7 @@ LTFAT_NAME(slicing_processor_init)( ltfat_int winLen, ltfat_int taperLen,
 
     CHECKMEM( p = LTFAT_NEW(LTFAT_NAME(slicing_processor_state)));
     p->winLen = winLen; p->taperLen = taperLen; p->zpadLen = zpadLen;
+    p->numChans = numChans; p->nthreads = 1;
 
     CHECKMEM( p->ga = LTFAT_NAME_REAL(malloc)(taperLen));
     CHECKMEM( p->gs = LTFAT_NAME_REAL(malloc)(taperLen));
@@ -79,6 +81,10 @@ LTFAT_NAME(slicing_processor_getprocdelay)( LTFAT_NAME(slicing_processor_state)*
 {
     int status = LTFATERR_FAILED;
     CHECKNULL(p);
+    if (p->nthreads > 1)
+        return p->winLen - p->zpadLen - 1 +
+               2 * p->nthreads * (p->winLen - p->zpadLen - p->taperLen / 2);
+
     return p->winLen - p->zpadLen - 1;
 error:
     return status;
@@ -90,6 +96,7 @@ LTFAT_NAME(slicing_processor_settaper)(
 {
     int status = LTFATERR_FAILED;
     CHECKNULL(p); CHECKNULL(g);
+    LTFAT_NAME(slicing_processor_sync)(p);
 
     if (do_analysis)
     {
@@ -111,6 +118,19 @@ error:
     return status;
 }
 
+static void
+LTFAT_NAME(slicing_processor_freethreads)(LTFAT_NAME(slicing_processor_state)* p)
+{
+    LTFAT_NAME(slicing_processor_sync)(p);
+    ltfat_threadpool_done(&p->pool);
+    LTFAT_SAFEFREEALL(p->pipeIn[0], p->pipeIn[1], p->pipeOut[0], p->pipeOut[1],
+                      p->pipeStatus);
+    p->pipeIn[0] = NULL; p->pipeIn[1] = NULL;
+    p->pipeOut[0] = NULL; p->pipeOut[1] = NULL;
+    p->pipeStatus = NULL;
+    p->nthreads = 1; p->slot = 0; p->cur = 0;
+}
+
 LTFAT_API int
 LTFAT_NAME(slicing_processor_done)(LTFAT_NAME(slicing_processor_state)** p)
 {
@@ -119,8 +139,9 @@ LTFAT_NAME(slicing_processor_done)(LTFAT_NAME(slicing_processor_state)** p)
     CHECKNULL(p); CHECKNULL(*p);
 
     pp = *p;
+    LTFAT_NAME(slicing_processor_freethreads)(pp);
     if(pp->block_processor) LTFAT_NAME(block_processor_done)(&pp->block_processor);
-    LTFAT_SAFEFREEALL(pp->bufIn_start, pp->bufOut_start, pp->ga, pp->gs );
+    LTFAT_SAFEFREEALL(pp->bufIn_start, pp->bufOut_start, pp->ga, pp->gs);
 
     ltfat_free(pp);
     pp = NULL;
@@ -129,6 +150,86 @@ error:
     return status;
 }
 
+/* Applies the taper to both ends of the slices in buf */
+static void
+LTFAT_NAME(slicing_processor_taper)(LTFAT_NAME(slicing_processor_state)* p,
+                                    const LTFAT_REAL g[], ltfat_int W,
+                                    LTFAT_REAL buf[])
+{
+    for (ltfat_int w = 0; w < W; w++)
+        for (ltfat_int l = 0; l < p->taperLen / 2; l++)
+            buf[p->zpadLen / 2 + l + w * p->winLen] *= g[p->taperLen / 2 + l];
+
+    for (ltfat_int w = 0; w < W; w++)
+        for (ltfat_int l = 0; l < p->taperLen / 2; l++)
+            buf[(w + 1)*p->winLen - p->taperLen / 2  - p->zpadLen / 2 + l] *= g[l];
+}
+
+static int
+LTFAT_NAME(slicing_processor_process)(LTFAT_NAME(slicing_processor_state)* p,
+                                      const LTFAT_REAL in[], int W, int threadid,
+                                      LTFAT_REAL out[])
+{
+    if (p->threadCallback)
+        return p->threadCallback(p->threadUserdata, in, p->winLen, p->taperLen,
+                                 p->zpadLen, W, threadid, out);
+
+    if (p->processorCallback)
+        return p->processorCallback(p->userdata, in, p->winLen, p->taperLen,
+                                    p->zpadLen, W, out);
+
+    return LTFAT_NAME(default_slicing_processor_callback)(NULL, in, p->winLen,
+            p->taperLen, p->zpadLen, W, out);
+}
+
+/* Processes slices start,...,end-1 of the batch in flight, which is the
+ * one not being filled */
+static void
+LTFAT_NAME(slicing_processor_slotrange)(void* userdata, ltfat_int start,
+                                        ltfat_int end, int threadid)
+{
+    LTFAT_NAME(slicing_processor_state)* p =
+        (LTFAT_NAME(slicing_processor_state)*) userdata;
+    ltfat_int slotLen = p->winLen * p->numChans;
+    const LTFAT_REAL* pipeIn = p->pipeIn[1 - p->cur];
+    LTFAT_REAL* pipeOut = p->pipeOut[1 - p->cur];
+
+    for (ltfat_int s = start; s < end; s++)
+    {
+        p->pipeStatus[s] = LTFAT_NAME(slicing_processor_process)(
+                               p, pipeIn + s * slotLen, (int) p->numChans,
+                               threadid, pipeOut + s * slotLen);
+
+        if (p->gs)
+            LTFAT_NAME(slicing_processor_taper)(p, p->gs, p->numChans,
+                                                pipeOut + s * slotLen);
+    }
+}
+
+/* Waits for the batch in flight and returns the lowest status of its
+ * slices */
+static int
+LTFAT_NAME(slicing_processor_collect)(LTFAT_NAME(slicing_processor_state)* p)
+{
+    int status = 0;
+
+    if (!p->inflight) return status;
+
+    ltfat_threadpool_wait(p->pool);
+    p->inflight = 0;
+
+    for (int s = 0; s < p->nthreads; s++)
+        if (p->pipeStatus[s] < status) status = p->pipeStatus[s];
+
+    return status;
+}
+
+void
+LTFAT_NAME(slicing_processor_sync)(LTFAT_NAME(slicing_processor_state)* p)
+{
+    LTFAT_NAME(slicing_processor_collect)(p);
+}
+
 int
 LTFAT_NAME(slicing_processor_execute_callback)(void* userdata,
         const LTFAT_REAL* UNUSED(in), int UNUSED(winLen), int W, LTFAT_REAL* UNUSED(out))
@@ -137,36 +238,44 @@ LTFAT_NAME(slicing_processor_execute_callback)(void* userdata,
     LTFAT_NAME(slicing_processor_state)* p =
     (LTFAT_NAME(slicing_processor_state)*) userdata;
 
-    LTFAT_NAME(slicing_processor_callback)* processorCallback = p->processorCallback;
-    if(!processorCallback)
-        processorCallback = &LTFAT_NAME(default_slicing_processor_callback);
-
     if (p->ga)
+        LTFAT_NAME(slicing_processor_taper)(p, p->ga, W, p->bufIn_start);
+
+    if (p->nthreads > 1)
     {
-        for (ltfat_int w = 0; w < W; w++)
-            for (ltfat_int l = 0; l < p->taperLen / 2; l++)
-                p->bufIn[l + w * p->winLen] *= p->ga[p->taperLen / 2 + l];
-
-        for (ltfat_int w = 0; w < W; w++)
-            for (ltfat_int l = 0; l < p->taperLen / 2; l++)
-                p->bufIn_start[(w + 1)*p->winLen - p->taperLen / 2  - p->zpadLen / 2 + l] *=
-                    p->ga[l];
+        // The slice is only stored and the output is the slice processed
+        // from the batch before the one in flight, i.e. 2*nthreads slices
+        // ago. A full batch is handed to the pool threads and processed
+        // while the next one is being filled.
+        ltfat_int slotLen = p->winLen * p->numChans;
+        memcpy(p->pipeIn[p->cur] + p->slot * slotLen, p->bufIn_start,
+               slotLen * sizeof * p->bufIn_start);
+        memcpy(p->bufOut_start, p->pipeOut[p->cur] + p->slot * slotLen,
+               slotLen * sizeof * p->bufOut_start);
+
+        if (++p->slot == p->nthreads)
+        {
+            // Normally finished long ago, otherwise the rest is done here
+            status = LTFAT_NAME(slicing_processor_collect)(p);
+
+            p->slot = 0;
+            p->cur = 1 - p->cur;
+            p->inflight = 1;
+            // Slices of a plain callback are processed one after another
+            // by a single thread as the callback need not be reentrant
+            ltfat_threadpool_submit(p->pool, p->threadCallback ? p->nthreads : 1,
+                                    p->nthreads,
+                                    &LTFAT_NAME(slicing_processor_slotrange), p);
+        }
+        return status;
     }
 
-    status = processorCallback(p->userdata, p->bufIn_start, p->winLen, p->taperLen,
-                               p->zpadLen, W, p->bufOut_start);
+    status = LTFAT_NAME(slicing_processor_process)(p, p->bufIn_start, W, 0,
+             p->bufOut_start);
 
     if (p->gs)
-    {
-        for (ltfat_int w = 0; w < W; w++)
-            for (ltfat_int l = 0; l < p->taperLen / 2; l++)
-                p->bufOut[l + w * p->winLen] *= p->gs[p->taperLen / 2 + l];
-
-        for (ltfat_int w = 0; w < W; w++)
-            for (ltfat_int l = 0; l < p->taperLen / 2; l++)
-                p->bufOut_start[(w + 1)*p->winLen - p->taperLen / 2  - p->zpadLen / 2 + l] *=
-                    p->gs[l];
-    }
+        LTFAT_NAME(slicing_processor_taper)(p, p->gs, W, p->bufOut_start);
+
     return status;
 }
 
@@ -188,6 +297,7 @@ LTFAT_NAME(slicing_processor_setcallback)(
 {
     int status = LTFATERR_FAILED;
     CHECKNULL(p);
+    LTFAT_NAME(slicing_processor_sync)(p);
     p->processorCallback = callback;
     p->userdata = userdata;
 
@@ -202,13 +312,72 @@ LTFAT_NAME(slicing_processor_reset)(LTFAT_NAME(slicing_processor_state)* p)
     int status = LTFATERR_FAILED;
     CHECKNULL(p);
 
+    LTFAT_NAME(slicing_processor_sync)(p);
     LTFAT_NAME(block_processor_reset)(p->block_processor);
 
+    for (int b = 0; b < 2; b++)
+        if (p->pipeOut[b])
+            memset(p->pipeOut[b], 0,
+                   p->nthreads * p->winLen * p->numChans * sizeof * p->pipeOut[b]);
+    p->slot = 0; p->cur = 0;
+
     return LTFATERR_SUCCESS;
 error:
     return status;
 }
 
+int
+LTFAT_NAME(slicing_processor_setthreadcallback)(
+    LTFAT_NAME(slicing_processor_state)* p,
+    LTFAT_NAME(slicing_processor_threadcallback)* callback, void* userdata)
+{
+    int status = LTFATERR_FAILED;
+    CHECKNULL(p);
+    LTFAT_NAME(slicing_processor_sync)(p);
+    p->threadCallback = callback;
+    p->threadUserdata = userdata;
+
+    return LTFATERR_SUCCESS;
+error:
+    return status;
+}
+
+LTFAT_API int
+LTFAT_NAME(slicing_processor_set_numthreads)(
+    LTFAT_NAME(slicing_processor_state)* p, int nthreads)
+{
+    ltfat_int slotLen;
+    int status = LTFATERR_FAILED;
+    CHECKNULL(p);
+    CHECK(LTFATERR_NOTINRANGE, nthreads >= 0 && nthreads <= LTFAT_MAXTHREADS,
+          "nthreads (passed %d) must be in range 0-%d.", nthreads, LTFAT_MAXTHREADS);
+
+    if (nthreads == 0) nthreads = ltfat_get_num_threads();
+
+    LTFAT_NAME(slicing_processor_freethreads)(p);
+
+    if (nthreads > 1)
+    {
+        slotLen = p->winLen * p->numChans;
+        for (int b = 0; b < 2; b++)
+        {
+            CHECKMEM( p->pipeIn[b]  = LTFAT_NAME_REAL(calloc)(nthreads * slotLen));
+            CHECKMEM( p->pipeOut[b] = LTFAT_NAME_REAL(calloc)(nthreads * slotLen));
+        }
+        CHECKMEM( p->pipeStatus = LTFAT_NEWARRAY(int, nthreads));
+        CHECKSTATUS( ltfat_threadpool_init(nthreads, &p->pool));
+        p->nthreads = nthreads;
+    }
+
+    // The delay has changed
+    LTFAT_NAME(block_processor_reset)(p->block_processor);
+
+    return LTFATERR_SUCCESS;
+error:
+    if (p) LTFAT_NAME(slicing_processor_freethreads)(p);
+    return status;
+}
+
 LTFAT_API int
 LTFAT_NAME(slicing_processor_execute_gen)(
     LTFAT_NAME(slicing_processor_state)* p,
@@ -235,6 +404,19 @@ error:
     return status;
 }
 
+LTFAT_API int
+LTFAT_NAME(slicing_processor_execute_gen_interleaved)(
+    LTFAT_NAME(slicing_processor_state)* p,
+    const LTFAT_REAL* in, ltfat_int inLen, ltfat_int chanNo, ltfat_int outLen,
+    LTFAT_REAL* out)
+{
+    int status = LTFATERR_FAILED;
+    CHECKNULL(p);
+    return LTFAT_NAME(block_processor_execute_interleaved)( p->block_processor, in, inLen, chanNo, outLen, out);
+error:
+    return status;
+}
+
 LTFAT_API int
 LTFAT_NAME(slicing_processor_execute)(
     LTFAT_NAME(slicing_processor_state)* p,
@@ -251,3 +433,12 @@ LTFAT_NAME(slicing_processor_execute_compact)(
     return LTFAT_NAME(slicing_processor_execute_gen_compact)(
                p, in, len, chanNo, len, out);
 }
+
+LTFAT_API int
+LTFAT_NAME(slicing_processor_execute_interleaved)(
+    LTFAT_NAME(slicing_processor_state)* p,
+    const LTFAT_REAL* in, ltfat_int len, ltfat_int chanNo, LTFAT_REAL* out)
+{
+    return LTFAT_NAME(slicing_processor_execute_gen_interleaved)(
+               p, in, len, chanNo, len, out);
+}
@@ -1,3 +1,11 @@
+#include "threads_private.h"
+
+/* Callback variant for callers keeping per-thread data. threadid is smaller
+ * than the number of threads set by slicing_processor_set_numthreads(). */
+typedef int LTFAT_NAME(slicing_processor_threadcallback)(void* userdata,
+        const LTFAT_REAL in[], int winLen, int taperLen, int zpadLen, int W,
+        int threadid, LTFAT_REAL out[]);
+
 struct LTFAT_NAME(slicing_processor_state)
 {
     LTFAT_NAME(slicing_processor_callback)*
@@ -13,6 +21,27 @@ struct LTFAT_NAME(slicing_processor_state)
     ltfat_int zpadLen;
     LTFAT_REAL* ga;
     LTFAT_REAL* gs;
-
+    ltfat_int numChans;
+    LTFAT_NAME(slicing_processor_threadcallback)* threadCallback;
+    void* threadUserdata;
+    // Pipelined mode, see slicing_processor_set_numthreads()
+    int nthreads; //!< Slices per batch
+    int slot; //!< Position of the current slice in the batch
+    int cur; //!< Batch being filled, the other one can be in flight
+    int inflight; //!< Nonzero if a batch was submitted and not waited for
+    LTFAT_REAL* pipeIn[2]; //!< Tapered input slices, winLen x numChans x nthreads
+    LTFAT_REAL* pipeOut[2]; //!< Processed slices
+    int* pipeStatus;
+    ltfat_threadpool* pool;
 };
 
+/* Waits for the batch in flight. Everything the callbacks use must only be
+ * changed after this. */
+void
+LTFAT_NAME(slicing_processor_sync)(LTFAT_NAME(slicing_processor_state)* p);
+
+int
+LTFAT_NAME(slicing_processor_setthreadcallback)(
+    LTFAT_NAME(slicing_processor_state)* p,
+    LTFAT_NAME(slicing_processor_threadcallback)* callback, void* userdata);
+
@@ -4,6 +4,7 @@
 #include "dgtrealmp_private.h"
 #include "slicingbuf_private.h"
 #include "slidgtrealmp_private.h"
+#include "threads_private.h"
 
 LTFAT_API int
 LTFAT_NAME(slidgtrealmp_init)(
@@ -41,12 +42,16 @@ LTFAT_NAME(slidgtrealmp_init)(
 
     p->owning_mpstate = 1;
     p->owning_slistate = 1;
+
     *pout = p;
     return LTFATERR_SUCCESS;
 error:
-    if (mpstate) LTFAT_NAME(dgtrealmp_done)(&mpstate);
-    if (slistate) LTFAT_NAME(slicing_processor_done)(&slistate);
     if (p) LTFAT_NAME(slidgtrealmp_done)(&p);
+    else
+    {
+        if (mpstate) LTFAT_NAME(dgtrealmp_done)(&mpstate);
+        if (slistate) LTFAT_NAME(slicing_processor_done)(&slistate);
+    }
     return status;
 }
 
@@ -63,6 +68,7 @@ LTFAT_NAME(slidgtrealmp_init_fromstates)(
     CHECKNULL(mpstate); CHECKNULL(slistate); CHECKNULL(pout);
     CHECKMEM( p = LTFAT_NEW(LTFAT_NAME(slidgtrealmp_state)));
     p->P = mpstate->P;
+    p->nthreads = 1;
     CHECKMEM( p->couttmp = LTFAT_NEWARRAY(LTFAT_COMPLEX*, p->P));
 
     for (ltfat_int pidx = 0; pidx < p->P; pidx++)
@@ -119,6 +125,47 @@ error:
     return status;
 }
 
+LTFAT_API int
+LTFAT_NAME(slidgtrealmp_execute_interleaved)(
+    LTFAT_NAME(slidgtrealmp_state)* p,
+    const LTFAT_REAL in[], ltfat_int inLen, ltfat_int chanNo,
+    LTFAT_REAL out[])
+{
+    int status = LTFATERR_FAILED;
+    CHECKNULL(p);
+    return LTFAT_NAME(slicing_processor_execute_interleaved)( p->slistate, in, inLen,
+            chanNo, out);
+error:
+    return status;
+}
+
+static void
+LTFAT_NAME(slidgtrealmp_freethreads)(LTFAT_NAME(slidgtrealmp_state)* p)
+{
+    if (p->slistate)
+        LTFAT_NAME(slicing_processor_sync)(p->slistate);
+
+    for (int t = 1; t < p->nthreads; t++)
+    {
+        if (p->mpstates && p->mpstates[t])
+            LTFAT_NAME(dgtrealmp_done)(&p->mpstates[t]);
+
+        if (p->couttmps && p->couttmps[t])
+        {
+            for (ltfat_int k = 0; k < p->P; k++)
+                ltfat_safefree(p->couttmps[t][k]);
+            ltfat_free(p->couttmps[t]);
+        }
+    }
+
+    LTFAT_SAFEFREEALL(p->mpstates, p->couttmps);
+    p->mpstates = NULL; p->couttmps = NULL;
+    p->nthreads = 1;
+
+    if (p->slistate)
+        LTFAT_NAME(slicing_processor_setthreadcallback)(p->slistate, NULL, NULL);
+}
+
 LTFAT_API int
 LTFAT_NAME(slidgtrealmp_done)(LTFAT_NAME(slidgtrealmp_state)** p)
 {
@@ -127,6 +174,8 @@ LTFAT_NAME(slidgtrealmp_done)(LTFAT_NAME(slidgtrealmp_state)** p)
     CHECKNULL(p); CHECKNULL(*p);
     pp = *p;
 
+    LTFAT_NAME(slidgtrealmp_freethreads)(pp);
+
     if (pp->couttmp)
     {
         for (ltfat_int k = 0; k < pp->P; k++)
@@ -151,19 +200,17 @@ LTFAT_API int
 LTFAT_NAME(slidgtrealmp_reset)(
     LTFAT_NAME(slidgtrealmp_state)* p);
 
-int
-LTFAT_NAME(slidgtrealmp_execute_callback)(void* userdata,
-        const LTFAT_REAL in[], int winLen, int UNUSED(taperLen),
-        int UNUSED(zpadLen), int W, LTFAT_REAL out[])
+static int
+LTFAT_NAME(slidgtrealmp_process)(LTFAT_NAME(slidgtrealmp_state)* p,
+                                 LTFAT_NAME(dgtrealmp_state)* mpstate,
+                                 LTFAT_COMPLEX** couttmp,
+                                 const LTFAT_REAL in[], int winLen, int W,
+                                 LTFAT_REAL out[])
 {
-
-    LTFAT_NAME(slidgtrealmp_state)* p =
-        (LTFAT_NAME(slidgtrealmp_state)*) userdata;
-
     for (ltfat_int w = 0; w < W; w++)
     {
         LTFAT_NAME(dgtrealmp_execute_decompose)(
-            p->mpstate, in + w * winLen, p->couttmp);
+            mpstate, in + w * winLen, couttmp);
 
         if(p->callback)
         {
@@ -174,13 +221,93 @@ LTFAT_NAME(slidgtrealmp_execute_callback)(void* userdata,
         else
         {
             LTFAT_NAME(dgtrealmp_execute_synthesize)(
-                p->mpstate, (const LTFAT_COMPLEX**)p->couttmp, NULL, out + w * winLen);
+                mpstate, (const LTFAT_COMPLEX**)couttmp, NULL, out + w * winLen);
         }
 
     }
     return  0;
 }
 
+int
+LTFAT_NAME(slidgtrealmp_execute_callback)(void* userdata,
+        const LTFAT_REAL in[], int winLen, int UNUSED(taperLen),
+        int UNUSED(zpadLen), int W, LTFAT_REAL out[])
+{
+    LTFAT_NAME(slidgtrealmp_state)* p =
+        (LTFAT_NAME(slidgtrealmp_state)*) userdata;
+
+    return LTFAT_NAME(slidgtrealmp_process)(p, p->mpstate, p->couttmp,
+                                            in, winLen, W, out);
+}
+
+static int
+LTFAT_NAME(slidgtrealmp_execute_threadcallback)(void* userdata,
+        const LTFAT_REAL in[], int winLen, int UNUSED(taperLen),
+        int UNUSED(zpadLen), int W, int threadid, LTFAT_REAL out[])
+{
+    LTFAT_NAME(slidgtrealmp_state)* p =
+        (LTFAT_NAME(slidgtrealmp_state)*) userdata;
+
+    return LTFAT_NAME(slidgtrealmp_process)(p, p->mpstates[threadid],
+                                            p->couttmps[threadid],
+                                            in, winLen, W, out);
+}
+
+LTFAT_API int
+LTFAT_NAME(slidgtrealmp_set_numthreads)(LTFAT_NAME(slidgtrealmp_state)* p,
+                                        int nthreads)
+{
+    LTFAT_NAME(dgtrealmp_state)* mp = NULL;
+    int status = LTFATERR_FAILED;
+    CHECKNULL(p);
+    CHECK(LTFATERR_NOTINRANGE, nthreads >= 0 && nthreads <= LTFAT_MAXTHREADS,
+          "nthreads (passed %d) must be in range 0-%d.", nthreads, LTFAT_MAXTHREADS);
+
+    if (nthreads == 0) nthreads = ltfat_get_num_threads();
+
+    LTFAT_NAME(slidgtrealmp_freethreads)(p);
+    CHECKSTATUS( LTFAT_NAME(slicing_processor_set_numthreads)(p->slistate, nthreads));
+
+    if (nthreads == 1) return LTFATERR_SUCCESS;
+
+    mp = p->mpstate;
+    CHECKMEM( p->mpstates = LTFAT_NEWARRAY(LTFAT_NAME(dgtrealmp_state)*, nthreads));
+    CHECKMEM( p->couttmps = LTFAT_NEWARRAY(LTFAT_COMPLEX**, nthreads));
+    p->nthreads = nthreads;
+    p->mpstates[0] = mp;
+    p->couttmps[0] = p->couttmp;
+
+    // The copies share the dictionary and take the current parameters
+    // of the original state
+    for (int t = 1; t < nthreads; t++)
+    {
+        CHECKSTATUS(
+            LTFAT_NAME(dgtrealmp_init_fromdict)(
+                mp->dict, mp->params, &p->mpstates[t]));
+
+        LTFAT_NAME(dgtrealmp_set_iterstepcallback)(
+            p->mpstates[t], mp->callback, mp->userdata);
+        memcpy(p->mpstates[t]->chanmask, mp->chanmask, mp->P * sizeof * mp->chanmask);
+
+        CHECKMEM( p->couttmps[t] = LTFAT_NEWARRAY(LTFAT_COMPLEX*, p->P));
+        for (ltfat_int k = 0; k < p->P; k++)
+            CHECKMEM( p->couttmps[t][k] =
+                          LTFAT_NAME_COMPLEX(malloc)(mp->M2[k] * mp->N[k]));
+    }
+
+    LTFAT_NAME(slicing_processor_setthreadcallback)(
+        p->slistate, &LTFAT_NAME(slidgtrealmp_execute_threadcallback), p);
+
+    return LTFATERR_SUCCESS;
+error:
+    if (p)
+    {
+        LTFAT_NAME(slidgtrealmp_freethreads)(p);
+        LTFAT_NAME(slicing_processor_set_numthreads)(p->slistate, 1);
+    }
+    return status;
+}
+
 LTFAT_API int
 LTFAT_NAME(slidgtrealmp_setcallback)(LTFAT_NAME(slidgtrealmp_state)* p,
         LTFAT_NAME(slidgtrealmp_processor_callback)* callback,
@@ -188,6 +315,7 @@ LTFAT_NAME(slidgtrealmp_setcallback)(LTFAT_NAME(slidgtrealmp_state)* p,
 {
     int status = LTFATERR_FAILED;
     CHECKNULL(p);
+    LTFAT_NAME(slicing_processor_sync)(p->slistate);
     p->callback = callback;
     p->userdata = userdata;
     return LTFATERR_SUCCESS;
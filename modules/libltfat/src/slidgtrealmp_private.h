@@ -14,6 +14,9 @@ struct LTFAT_NAME(slidgtrealmp_state)
     ltfat_int P;
     void* userdata;
     LTFAT_NAME(slidgtrealmp_processor_callback)* callback;
+    int nthreads;
+    LTFAT_NAME(dgtrealmp_state)** mpstates; //!< One per thread, [0] is mpstate
+    LTFAT_COMPLEX*** couttmps; //!< One per thread, [0] is couttmp
 };
 
 
@@ -0,0 +1,247 @@
+#ifndef _ltfat_threads_private_h
+#define _ltfat_threads_private_h
+
+/*
+ * Minimal portability layer over the native threading primitives.
+ * Only what the library needs internally is exposed here.
+ */
+
+#if defined(_WIN32) || defined(__WIN32__)
+#include <windows.h>
+
+typedef SRWLOCK ltfat_mutex_t;
+#define LTFAT_MUTEX_INITIALIZER SRWLOCK_INIT
+#define ltfat_mutex_lock(m)   AcquireSRWLockExclusive(m)
+#define ltfat_mutex_unlock(m) ReleaseSRWLockExclusive(m)
+
+typedef CONDITION_VARIABLE ltfat_cond_t;
+#define LTFAT_COND_INITIALIZER CONDITION_VARIABLE_INIT
+#define ltfat_cond_wait(c, m)   SleepConditionVariableSRW(c, m, INFINITE, 0)
+#define ltfat_cond_signal(c)    WakeConditionVariable(c)
+#define ltfat_cond_broadcast(c) WakeAllConditionVariable(c)
+
+#define ltfat_mutex_init(m)    InitializeSRWLock(m)
+#define ltfat_mutex_destroy(m) ((void)(m))
+#define ltfat_mutex_trylock(m) (TryAcquireSRWLockExclusive(m) != 0)
+#define ltfat_cond_init(c)     InitializeConditionVariable(c)
+#define ltfat_cond_destroy(c)  ((void)(c))
+
+typedef HANDLE ltfat_thread_handle;
+typedef HANDLE ltfat_sem_t;
+
+#else
+#include <pthread.h>
+
+typedef pthread_mutex_t ltfat_mutex_t;
+#define LTFAT_MUTEX_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+#define ltfat_mutex_lock(m)   pthread_mutex_lock(m)
+#define ltfat_mutex_unlock(m) pthread_mutex_unlock(m)
+
+typedef pthread_cond_t ltfat_cond_t;
+#define LTFAT_COND_INITIALIZER PTHREAD_COND_INITIALIZER
+#define ltfat_cond_wait(c, m)   pthread_cond_wait(c, m)
+#define ltfat_cond_signal(c)    pthread_cond_signal(c)
+#define ltfat_cond_broadcast(c) pthread_cond_broadcast(c)
+
+#define ltfat_mutex_init(m)    pthread_mutex_init((m), NULL)
+#define ltfat_mutex_destroy(m) pthread_mutex_destroy(m)
+#define ltfat_mutex_trylock(m) (pthread_mutex_trylock(m) == 0)
+#define ltfat_cond_init(c)     pthread_cond_init((c), NULL)
+#define ltfat_cond_destroy(c)  pthread_cond_destroy(c)
+
+typedef pthread_t ltfat_thread_handle;
+
+#if defined(__APPLE__)
+/* Unnamed POSIX semaphores are not implemented on macOS */
+#include <dispatch/dispatch.h>
+typedef dispatch_semaphore_t ltfat_sem_t;
+#else
+#include <semaphore.h>
+typedef sem_t ltfat_sem_t;
+#endif
+
+#endif
+
+/*
+ * Loads and stores of indices shared by exactly two threads, e.g. the
+ * read and write positions of a single-producer single-consumer ring buffer.
+ * The release store makes all preceding writes visible to the thread
+ * doing the acquire load of the same variable.
+ */
+#if defined(_MSC_VER)
+static __inline ltfat_int
+ltfat_atomic_load_acquire(const volatile ltfat_int* p)
+{
+    ltfat_int v = *p;
+    MemoryBarrier();
+    return v;
+}
+
+static __inline void
+ltfat_atomic_store_release(volatile ltfat_int* p, ltfat_int v)
+{
+    MemoryBarrier();
+    *p = v;
+}
+#else
+#define ltfat_atomic_load_acquire(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define ltfat_atomic_store_release(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#endif
+
+/*
+ * Counters updated by several threads without any ordering requirements.
+ */
+#if defined(_MSC_VER)
+#define ltfat_atomic_add_u64(p, v) \
+    ((void)InterlockedExchangeAdd64((volatile LONG64*)(p), (LONG64)(v)))
+#define ltfat_atomic_load_u64(p) \
+    ((uint64_t)InterlockedCompareExchange64((volatile LONG64*)(p), 0, 0))
+#define ltfat_atomic_store_u64(p, v) \
+    ((void)InterlockedExchange64((volatile LONG64*)(p), (LONG64)(v)))
+#define ltfat_atomic_cas_u64(p, oldv, newv) \
+    ((uint64_t)InterlockedCompareExchange64((volatile LONG64*)(p), \
+            (LONG64)(newv), (LONG64)(oldv)) == (oldv))
+#else
+#define ltfat_atomic_add_u64(p, v)   ((void)__atomic_fetch_add((p), (v), __ATOMIC_RELAXED))
+#define ltfat_atomic_load_u64(p)     __atomic_load_n((p), __ATOMIC_RELAXED)
+#define ltfat_atomic_store_u64(p, v) __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#define ltfat_atomic_cas_u64(p, oldv, newv) \
+    __atomic_compare_exchange_n((p), &(oldv), (newv), 0, \
+                                __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+#endif
+
+/*
+ * The same with ordering, for counters and states one thread publishes and
+ * others act upon. The compare-and-swap writes newv only if *p equals oldv
+ * and returns nonzero on success.
+ */
+#if defined(_MSC_VER)
+#define ltfat_atomic_load_acquire_u64(p)     ltfat_atomic_load_u64(p)
+#define ltfat_atomic_store_release_u64(p, v) ltfat_atomic_store_u64((p), (v))
+#define ltfat_atomic_add_release_u64(p, v)   ltfat_atomic_add_u64((p), (v))
+#define ltfat_atomic_cas_acqrel_u64(p, oldv, newv) \
+    ltfat_atomic_cas_u64((p), (oldv), (newv))
+#define ltfat_cpu_relax() YieldProcessor()
+#else
+#define ltfat_atomic_load_acquire_u64(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define ltfat_atomic_store_release_u64(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define ltfat_atomic_add_release_u64(p, v) \
+    ((void)__atomic_fetch_add((p), (v), __ATOMIC_RELEASE))
+#define ltfat_atomic_cas_acqrel_u64(p, oldv, newv) \
+    __atomic_compare_exchange_n((p), &(oldv), (newv), 0, \
+                                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#if defined(__x86_64__) || defined(__i386__)
+#define ltfat_cpu_relax() __builtin_ia32_pause()
+#elif defined(__aarch64__)
+#define ltfat_cpu_relax() __asm__ __volatile__("yield")
+#else
+#define ltfat_cpu_relax() ((void)0)
+#endif
+#endif
+
+/* Waits at most ms milliseconds. Spurious wakeups are possible. */
+void
+ltfat_cond_timedwait_ms(ltfat_cond_t* c, ltfat_mutex_t* m, int ms);
+
+/* Counting semaphore with initial count 0. Posting never blocks, so it
+ * can be done from a real-time thread. Init returns nonzero on failure. */
+int
+ltfat_sem_init(ltfat_sem_t* s);
+
+void
+ltfat_sem_destroy(ltfat_sem_t* s);
+
+void
+ltfat_sem_post(ltfat_sem_t* s);
+
+void
+ltfat_sem_wait(ltfat_sem_t* s);
+
+typedef void ltfat_thread_func(void* arg);
+
+typedef struct
+{
+    ltfat_thread_handle handle;
+    ltfat_thread_func* fn;
+    void* arg;
+} ltfat_thread_t;
+
+/* Starts fn(arg) in a new thread. t must stay valid until ltfat_thread_join.
+ * Returns nonzero on failure. */
+int
+ltfat_thread_create(ltfat_thread_t* t, ltfat_thread_func* fn, void* arg);
+
+void
+ltfat_thread_join(ltfat_thread_t* t);
+
+/* Upper limit for the number of threads of ltfat_parallel_for */
+#define LTFAT_MAXTHREADS 256
+
+/* Processes items start,...,end-1. threadid is in range 0,...,nthreads-1
+ * and it differs for each chunk of a single ltfat_parallel_for call. */
+typedef void ltfat_parallel_func(void* userdata, ltfat_int start,
+                                 ltfat_int end, int threadid);
+
+/*
+ * Splits the range 0,...,n-1 into (at most) nthreads contiguous chunks and
+ * processes them in parallel using a process-wide pool of worker threads.
+ * The calling thread processes the first chunk.
+ *
+ * The pool runs one job at a time. Calls made while the pool is busy
+ * (e.g. from another thread or from within fn) run serially in the calling
+ * thread with threadid 0.
+ */
+void
+ltfat_parallel_for(int nthreads, ltfat_int n, ltfat_parallel_func* fn,
+                   void* userdata);
+
+/*
+ * A pool of worker threads owned by a single object, e.g. a real-time
+ * processor, for which waiting for the shared pool of ltfat_parallel_for
+ * is not an option.
+ *
+ * A job splits 0,...,n-1 into nchunks chunks the same way as
+ * ltfat_parallel_for and chunk k is passed threadid k. The chunks are
+ * claimed by the workers and by the thread waiting for the job, so a
+ * worker which is late to wake up only reduces the parallelism. Neither
+ * submit nor wait block on a lock, wait spins until the claimed chunks
+ * are finished. Idle workers sleep until the next submit.
+ *
+ * Only one thread may submit and wait and a job must be waited for before
+ * the next one is submitted.
+ */
+typedef struct ltfat_threadpool ltfat_threadpool;
+
+/* Starts nworkers threads. Returns LTFATERR_INITFAILED if they cannot be
+ * created. */
+int
+ltfat_threadpool_init(int nworkers, ltfat_threadpool** p);
+
+int
+ltfat_threadpool_nworkers(const ltfat_threadpool* p);
+
+/* Starts the job and returns immediately. nchunks is at most
+ * LTFAT_MAXTHREADS + 1. */
+void
+ltfat_threadpool_submit(ltfat_threadpool* p, int nchunks, ltfat_int n,
+                        ltfat_parallel_func* fn, void* userdata);
+
+/* Helps with the unclaimed chunks of the last job and returns when all of
+ * them are finished */
+void
+ltfat_threadpool_wait(ltfat_threadpool* p);
+
+/* Nonzero if the last job is finished */
+int
+ltfat_threadpool_isdone(const ltfat_threadpool* p);
+
+/* Submits a job with nworkers + 1 chunks and waits for it */
+void
+ltfat_threadpool_run(ltfat_threadpool* p, ltfat_int n,
+                     ltfat_parallel_func* fn, void* userdata);
+
+/* Joins the threads. Must not be called while a job is running. */
+void
+ltfat_threadpool_done(ltfat_threadpool** p);
+
+#endif
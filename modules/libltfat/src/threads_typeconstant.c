@@ -0,0 +1,567 @@
+#include "ltfat.h"
+#include "ltfat/types.h"
+#include "ltfat/macros.h"
+#include "threads_private.h"
+#include "rtsafe_private.h"
+
+#include <stdint.h>
+
+#if defined(_WIN32) || defined(__WIN32__)
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#endif
+
+static int ltfat_num_threads = 1;
+
+static int
+ltfat_num_processors(void)
+{
+#if defined(_WIN32) || defined(__WIN32__)
+    SYSTEM_INFO sysinfo;
+    GetSystemInfo(&sysinfo);
+    return (int) sysinfo.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    long nproc = sysconf(_SC_NPROCESSORS_ONLN);
+    return nproc > 0 ? (int) nproc : 1;
+#else
+    return 1;
+#endif
+}
+
+LTFAT_API int
+ltfat_set_num_threads(int nthreads)
+{
+    int status = LTFATERR_SUCCESS;
+    CHECK(LTFATERR_NOTINRANGE, nthreads >= 0, "nthreads must be nonnegative");
+
+    ltfat_num_threads = nthreads ? nthreads : ltfat_num_processors();
+error:
+    return status;
+}
+
+LTFAT_API int
+ltfat_get_num_threads(void)
+{
+    return ltfat_num_threads;
+}
+
+/* ---------------------- Worker pool -------------------------- */
+
+typedef struct
+{
+    ltfat_parallel_func* fn;
+    void* userdata;
+    ltfat_int n;
+    int nchunks;
+    int rtsafe; //!< Submitted from within a real-time execute call
+} ltfat_pool_job;
+
+static ltfat_mutex_t pool_mutex = LTFAT_MUTEX_INITIALIZER;
+static ltfat_cond_t pool_workcond = LTFAT_COND_INITIALIZER;
+static ltfat_cond_t pool_donecond = LTFAT_COND_INITIALIZER;
+static ltfat_pool_job pool_job;
+static unsigned pool_generation = 0;
+static int pool_nworkers = 0;
+static int pool_pending = 0;
+static int pool_busy = 0;
+
+static void
+ltfat_pool_runchunk(const ltfat_pool_job* job, int chunk)
+{
+    ltfat_int start = (ltfat_int)( (long long) chunk * job->n / job->nchunks );
+    ltfat_int end = (ltfat_int)( (long long) (chunk + 1) * job->n / job->nchunks );
+
+    if (end <= start) return;
+
+    // The chunks run on behalf of the submitting thread
+    if (job->rtsafe) ltfat_rtsafe_enter();
+    job->fn(job->userdata, start, end, chunk);
+    if (job->rtsafe) ltfat_rtsafe_leave();
+}
+
+/* Worker id processes chunk id + 1 of every job having more than
+ * id + 1 chunks. A new job is announced by incrementing pool_generation. */
+static void
+ltfat_pool_worker(int id)
+{
+    unsigned seen = 0;
+
+    for (;;)
+    {
+        ltfat_pool_job job;
+
+        ltfat_mutex_lock(&pool_mutex);
+        while (pool_generation == seen)
+            ltfat_cond_wait(&pool_workcond, &pool_mutex);
+        seen = pool_generation;
+        job = pool_job;
+        ltfat_mutex_unlock(&pool_mutex);
+
+        if (id + 1 >= job.nchunks)
+            continue;
+
+        ltfat_pool_runchunk(&job, id + 1);
+
+        ltfat_mutex_lock(&pool_mutex);
+        if (--pool_pending == 0)
+            ltfat_cond_broadcast(&pool_donecond);
+        ltfat_mutex_unlock(&pool_mutex);
+    }
+}
+
+#if defined(_WIN32) || defined(__WIN32__)
+static DWORD WINAPI
+ltfat_pool_threadmain(LPVOID arg)
+{
+    ltfat_pool_worker((int)(intptr_t) arg);
+    return 0;
+}
+
+static int
+ltfat_pool_spawn(int id)
+{
+    HANDLE h = CreateThread(NULL, 0, ltfat_pool_threadmain,
+                            (LPVOID)(intptr_t) id, 0, NULL);
+    if (!h) return 1;
+    CloseHandle(h);
+    return 0;
+}
+#else
+static void*
+ltfat_pool_threadmain(void* arg)
+{
+    ltfat_pool_worker((int)(intptr_t) arg);
+    return NULL;
+}
+
+static int
+ltfat_pool_spawn(int id)
+{
+    pthread_t t;
+    if (pthread_create(&t, NULL, ltfat_pool_threadmain, (void*)(intptr_t) id))
+        return 1;
+    pthread_detach(t);
+    return 0;
+}
+#endif
+
+#if defined(_WIN32) || defined(__WIN32__)
+static DWORD WINAPI
+ltfat_thread_main(LPVOID arg)
+{
+    ltfat_thread_t* t = (ltfat_thread_t*) arg;
+    t->fn(t->arg);
+    return 0;
+}
+
+int
+ltfat_thread_create(ltfat_thread_t* t, ltfat_thread_func* fn, void* arg)
+{
+    t->fn = fn; t->arg = arg;
+    t->handle = CreateThread(NULL, 0, ltfat_thread_main, (LPVOID) t, 0, NULL);
+    return t->handle == NULL;
+}
+
+void
+ltfat_thread_join(ltfat_thread_t* t)
+{
+    WaitForSingleObject(t->handle, INFINITE);
+    CloseHandle(t->handle);
+}
+
+void
+ltfat_cond_timedwait_ms(ltfat_cond_t* c, ltfat_mutex_t* m, int ms)
+{
+    SleepConditionVariableSRW(c, m, (DWORD) ms, 0);
+}
+
+int
+ltfat_sem_init(ltfat_sem_t* s)
+{
+    *s = CreateSemaphore(NULL, 0, 0x7FFFFFFF, NULL);
+    return *s == NULL;
+}
+
+void
+ltfat_sem_destroy(ltfat_sem_t* s)
+{
+    CloseHandle(*s);
+}
+
+void
+ltfat_sem_post(ltfat_sem_t* s)
+{
+    ReleaseSemaphore(*s, 1, NULL);
+}
+
+void
+ltfat_sem_wait(ltfat_sem_t* s)
+{
+    WaitForSingleObject(*s, INFINITE);
+}
+#else
+static void*
+ltfat_thread_main(void* arg)
+{
+    ltfat_thread_t* t = (ltfat_thread_t*) arg;
+    t->fn(t->arg);
+    return NULL;
+}
+
+int
+ltfat_thread_create(ltfat_thread_t* t, ltfat_thread_func* fn, void* arg)
+{
+    t->fn = fn; t->arg = arg;
+    return pthread_create(&t->handle, NULL, ltfat_thread_main, (void*) t) != 0;
+}
+
+void
+ltfat_thread_join(ltfat_thread_t* t)
+{
+    pthread_join(t->handle, NULL);
+}
+
+void
+ltfat_cond_timedwait_ms(ltfat_cond_t* c, ltfat_mutex_t* m, int ms)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_nsec += (long) ms * 1000000L;
+    ts.tv_sec += ts.tv_nsec / 1000000000L;
+    ts.tv_nsec %= 1000000000L;
+    pthread_cond_timedwait(c, m, &ts);
+}
+
+#if defined(__APPLE__)
+int
+ltfat_sem_init(ltfat_sem_t* s)
+{
+    *s = dispatch_semaphore_create(0);
+    return *s == NULL;
+}
+
+void
+ltfat_sem_destroy(ltfat_sem_t* s)
+{
+    dispatch_release(*s);
+}
+
+void
+ltfat_sem_post(ltfat_sem_t* s)
+{
+    dispatch_semaphore_signal(*s);
+}
+
+void
+ltfat_sem_wait(ltfat_sem_t* s)
+{
+    dispatch_semaphore_wait(*s, DISPATCH_TIME_FOREVER);
+}
+#else
+int
+ltfat_sem_init(ltfat_sem_t* s)
+{
+    return sem_init(s, 0, 0) != 0;
+}
+
+void
+ltfat_sem_destroy(ltfat_sem_t* s)
+{
+    sem_destroy(s);
+}
+
+void
+ltfat_sem_post(ltfat_sem_t* s)
+{
+    sem_post(s);
+}
+
+void
+ltfat_sem_wait(ltfat_sem_t* s)
+{
+    // Interrupted by a signal, the count was not taken
+    while (sem_wait(s) != 0 && errno == EINTR)
+        ;
+}
+#endif
+#endif
+
+void
+ltfat_parallel_for(int nthreads, ltfat_int n, ltfat_parallel_func* fn,
+                   void* userdata)
+{
+    ltfat_pool_job job;
+
+    if (n <= 0) return;
+
+    if (nthreads > LTFAT_MAXTHREADS) nthreads = LTFAT_MAXTHREADS;
+    if (nthreads > n) nthreads = (int) n;
+
+    if (nthreads <= 1)
+    {
+        fn(userdata, 0, n, 0);
+        return;
+    }
+
+    ltfat_rtsafe_blocking("the shared thread pool");
+
+    ltfat_mutex_lock(&pool_mutex);
+    if (pool_busy)
+    {
+        ltfat_mutex_unlock(&pool_mutex);
+        fn(userdata, 0, n, 0);
+        return;
+    }
+    pool_busy = 1;
+
+    /* Failing to start a thread is not an error, just less parallelism */
+    while (pool_nworkers < nthreads - 1)
+    {
+        if (ltfat_pool_spawn(pool_nworkers))
+            break;
+        pool_nworkers++;
+    }
+    if (nthreads > pool_nworkers + 1)
+        nthreads = pool_nworkers + 1;
+
+    job.fn = fn; job.userdata = userdata; job.n = n; job.nchunks = nthreads;
+    job.rtsafe = ltfat_rtsafe_inside();
+    pool_job = job;
+    pool_pending = nthreads - 1;
+    pool_generation++;
+    ltfat_cond_broadcast(&pool_workcond);
+    ltfat_mutex_unlock(&pool_mutex);
+
+    ltfat_pool_runchunk(&job, 0);
+
+    ltfat_mutex_lock(&pool_mutex);
+    while (pool_pending > 0)
+        ltfat_cond_wait(&pool_donecond, &pool_mutex);
+    pool_busy = 0;
+    ltfat_mutex_unlock(&pool_mutex);
+}
+
+/* ---------------------- Private pools -------------------------- */
+
+/* Idle iterations a worker spins for before it goes to sleep */
+#ifndef LTFAT_THREADPOOL_SPIN
+#define LTFAT_THREADPOOL_SPIN 4096
+#endif
+
+/* The job state packs generation << 32 | nchunks << 16 | next chunk */
+#define LTFAT_THREADPOOL_NCHUNKS(s) ((int)(((s) >> 16) & 0xFFFF))
+#define LTFAT_THREADPOOL_NEXT(s)    ((int)((s) & 0xFFFF))
+
+struct ltfat_threadpool
+{
+    ltfat_thread_t* threads;
+    int nworkers;
+    ltfat_sem_t sem;
+    int hassem;
+    /* Two's complement count, negative: number of workers sleeping on sem,
+     * positive: wakeups the next workers going to sleep take at once */
+    uint64_t wakeups;
+    ltfat_pool_job job;
+    uint64_t state;
+    uint64_t done;
+    uint64_t generation;
+    ltfat_int stop;
+};
+
+/* Wakes a sleeping worker or keeps the wakeup for the next one going to
+ * sleep. At most nworkers wakeups are kept, so the ones nobody needed
+ * do not pile up. */
+static void
+ltfat_threadpool_wake(ltfat_threadpool* p)
+{
+    uint64_t c = ltfat_atomic_load_acquire_u64(&p->wakeups);
+
+    for (;;)
+    {
+        uint64_t old = c;
+        if ((int64_t) c >= p->nworkers)
+            return;
+        if (ltfat_atomic_cas_acqrel_u64(&p->wakeups, old, c + 1))
+            break;
+        c = ltfat_atomic_load_acquire_u64(&p->wakeups);
+    }
+
+    if ((int64_t) c < 0)
+        ltfat_sem_post(&p->sem);
+}
+
+static void
+ltfat_threadpool_sleep(ltfat_threadpool* p)
+{
+    uint64_t c = ltfat_atomic_load_acquire_u64(&p->wakeups);
+
+    for (;;)
+    {
+        uint64_t old = c;
+        if (ltfat_atomic_cas_acqrel_u64(&p->wakeups, old, c - 1))
+            break;
+        c = ltfat_atomic_load_acquire_u64(&p->wakeups);
+    }
+
+    if ((int64_t) c <= 0)
+        ltfat_sem_wait(&p->sem);
+}
+
+/* Claims and processes a single chunk. Returns zero if there was none. */
+static int
+ltfat_threadpool_runone(ltfat_threadpool* p)
+{
+    uint64_t s = ltfat_atomic_load_acquire_u64(&p->state);
+
+    for (;;)
+    {
+        uint64_t claimed = s;
+        if (LTFAT_THREADPOOL_NEXT(s) >= LTFAT_THREADPOOL_NCHUNKS(s))
+            return 0;
+        if (ltfat_atomic_cas_acqrel_u64(&p->state, claimed, s + 1))
+            break;
+        s = ltfat_atomic_load_acquire_u64(&p->state);
+    }
+
+    // The job cannot change before this chunk is done
+    ltfat_pool_runchunk(&p->job, LTFAT_THREADPOOL_NEXT(s));
+    ltfat_atomic_add_release_u64(&p->done, 1);
+    return 1;
+}
+
+static void
+ltfat_threadpool_worker(void* arg)
+{
+    ltfat_threadpool* p = (ltfat_threadpool*) arg;
+    int idle = 0;
+
+    while (!ltfat_atomic_load_acquire(&p->stop))
+    {
+        if (ltfat_threadpool_runone(p))
+        {
+            idle = 0;
+            continue;
+        }
+
+        if (idle < LTFAT_THREADPOOL_SPIN)
+        {
+            idle++;
+            ltfat_cpu_relax();
+            continue;
+        }
+
+        // submit wakes the workers after publishing the job, so the
+        // wakeup cannot be missed
+        ltfat_threadpool_sleep(p);
+        idle = 0;
+    }
+}
+
+int
+ltfat_threadpool_init(int nworkers, ltfat_threadpool** p)
+{
+    ltfat_threadpool* pp = NULL;
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(p);
+    CHECK(LTFATERR_NOTINRANGE, nworkers >= 0 && nworkers <= LTFAT_MAXTHREADS,
+          "nworkers (passed %d) must be in range 0-%d.", nworkers, LTFAT_MAXTHREADS);
+
+    CHECKMEM( pp = LTFAT_NEW(ltfat_threadpool) );
+    if (nworkers > 0)
+        CHECKMEM( pp->threads = LTFAT_NEWARRAY(ltfat_thread_t, nworkers) );
+    CHECKINIT( !ltfat_sem_init(&pp->sem), "Semaphore creation failed.");
+    pp->hassem = 1;
+
+    for (; pp->nworkers < nworkers; pp->nworkers++)
+        if (ltfat_thread_create(&pp->threads[pp->nworkers],
+                                &ltfat_threadpool_worker, pp))
+            break;
+
+    CHECKINIT(pp->nworkers == nworkers, "Worker thread creation failed.");
+
+    *p = pp;
+    return status;
+error:
+    if (pp) ltfat_threadpool_done(&pp);
+    return status;
+}
+
+int
+ltfat_threadpool_nworkers(const ltfat_threadpool* p)
+{
+    return p->nworkers;
+}
+
+void
+ltfat_threadpool_submit(ltfat_threadpool* p, int nchunks, ltfat_int n,
+                        ltfat_parallel_func* fn, void* userdata)
+{
+    if (nchunks > LTFAT_MAXTHREADS + 1) nchunks = LTFAT_MAXTHREADS + 1;
+    if (nchunks < 1) nchunks = 1;
+
+    p->job.fn = fn; p->job.userdata = userdata;
+    p->job.n = n; p->job.nchunks = nchunks;
+    p->job.rtsafe = ltfat_rtsafe_inside();
+    ltfat_atomic_store_u64(&p->done, 0);
+    p->generation++;
+    ltfat_atomic_store_release_u64(&p->state,
+                                   (p->generation << 32) | ((uint64_t) nchunks << 16));
+
+    // One wakeup per chunk up to the number of workers, none of them blocks
+    for (int k = 0; k < nchunks && k < p->nworkers; k++)
+        ltfat_threadpool_wake(p);
+}
+
+int
+ltfat_threadpool_isdone(const ltfat_threadpool* p)
+{
+    return ltfat_atomic_load_acquire_u64(&p->done) >= (uint64_t) p->job.nchunks;
+}
+
+void
+ltfat_threadpool_wait(ltfat_threadpool* p)
+{
+    while (ltfat_threadpool_runone(p))
+        ;
+
+    while (!ltfat_threadpool_isdone(p))
+        ltfat_cpu_relax();
+}
+
+void
+ltfat_threadpool_run(ltfat_threadpool* p, ltfat_int n,
+                     ltfat_parallel_func* fn, void* userdata)
+{
+    if (p->nworkers == 0 || n <= 1)
+    {
+        if (n > 0) fn(userdata, 0, n, 0);
+        return;
+    }
+
+    ltfat_threadpool_submit(p, n < p->nworkers + 1 ? (int) n : p->nworkers + 1,
+                            n, fn, userdata);
+    ltfat_threadpool_wait(p);
+}
+
+void
+ltfat_threadpool_done(ltfat_threadpool** p)
+{
+    ltfat_threadpool* pp;
+    if (!p || !*p) return;
+    pp = *p;
+
+    ltfat_atomic_store_release(&pp->stop, 1);
+    for (int ii = 0; ii < pp->nworkers; ii++)
+        ltfat_threadpool_wake(pp);
+
+    for (int ii = 0; ii < pp->nworkers; ii++)
+        ltfat_thread_join(&pp->threads[ii]);
+
+    if (pp->hassem) ltfat_sem_destroy(&pp->sem);
+    ltfat_safefree(pp->threads);
+    ltfat_free(pp);
+    *p = NULL;
+}
@@ -0,0 +1,122 @@
+#ifndef _ltfat_walnut_private_h
+#define _ltfat_walnut_private_h
+#include "simd_private.h"
+
+/*
+ * Complex matrix products of the factorization (Walnut) algorithm.
+ *
+ * The window factorization gf holds one p x q block (column-major, complex
+ * interleaved) for each coset r and each s. The kernels expect the block
+ * transposed to gt[mm + km*q] = gf[km + mm*p] (see walnut_transpose) such
+ * that both products can run over the contiguous q dimension.
+ */
+
+static inline void
+LTFAT_NAME_REAL(walnut_transpose)(const LTFAT_REAL* g, ltfat_int p, ltfat_int q,
+                                  LTFAT_REAL* gt)
+{
+    for (ltfat_int km = 0; km < p; km++)
+        for (ltfat_int mm = 0; mm < q; mm++)
+        {
+            gt[2 * (mm + km * q)]     = g[2 * (km + mm * p)];
+            gt[2 * (mm + km * q) + 1] = g[2 * (km + mm * p) + 1];
+        }
+}
+
+/* C[mm + nm*q] = sum_km conj(gt[mm + km*q]) * F[km + nm*p] for nm < n */
+static inline void
+LTFAT_NAME_REAL(walnut_fwdmatmul)(const LTFAT_REAL* gt, const LTFAT_REAL* F,
+                                  ltfat_int p, ltfat_int q, ltfat_int n,
+                                  LTFAT_REAL* C)
+{
+    for (ltfat_int nm = 0; nm < n; nm++)
+    {
+        const LTFAT_REAL* fp = F + 2 * nm * p;
+        LTFAT_REAL* cp = C + 2 * nm * q;
+
+        for (ltfat_int mm = 0; mm < 2 * q; mm++)
+            cp[mm] = 0.0;
+
+        for (ltfat_int km = 0; km < p; km++)
+        {
+            const LTFAT_REAL* gp = gt + 2 * km * q;
+            const LTFAT_REAL fr = fp[2 * km], fi = fp[2 * km + 1];
+            ltfat_int mm = 0;
+#ifdef LTFAT_SIMD
+            const ltfat_simd_v frv = V_PAIR(fr, -fr);
+            const ltfat_simd_v fiv = V_SET1(fi);
+
+            for (; mm + LTFAT_SIMD_VL <= q; mm += LTFAT_SIMD_VL)
+            {
+                ltfat_simd_v g = V_LOAD(gp + 2 * mm);
+                ltfat_simd_v t = V_ADD(V_MUL(g, frv), V_MUL(V_SWAP(g), fiv));
+                V_STORE(cp + 2 * mm, V_ADD(V_LOAD(cp + 2 * mm), t));
+            }
+#endif
+            for (; mm < q; mm++)
+            {
+                cp[2 * mm]     += gp[2 * mm] * fr + gp[2 * mm + 1] * fi;
+                cp[2 * mm + 1] += gp[2 * mm] * fi - gp[2 * mm + 1] * fr;
+            }
+        }
+    }
+}
+
+/* F[km + nm*p] = scal * sum_mm gt[mm + km*q] * C[mm + nm*q] for nm < n */
+static inline void
+LTFAT_NAME_REAL(walnut_invmatmul)(const LTFAT_REAL* gt, const LTFAT_REAL* C,
+                                  ltfat_int p, ltfat_int q, ltfat_int n,
+                                  LTFAT_REAL scal, LTFAT_REAL* F)
+{
+    for (ltfat_int nm = 0; nm < n; nm++)
+    {
+        const LTFAT_REAL* cp = C + 2 * nm * q;
+        LTFAT_REAL* fp = F + 2 * nm * p;
+
+        for (ltfat_int km = 0; km < p; km++)
+        {
+            const LTFAT_REAL* gp = gt + 2 * km * q;
+            LTFAT_REAL re = 0.0, im = 0.0;
+            ltfat_int mm = 0;
+#ifdef LTFAT_SIMD
+            /* Accumulates (gr*cr, gi*ci) and (gi*cr, gr*ci) */
+            LTFAT_REAL tre[2 * LTFAT_SIMD_VL], tim[2 * LTFAT_SIMD_VL];
+            ltfat_simd_v accre = V_SET1(0.0), accim = V_SET1(0.0);
+
+            for (; mm + LTFAT_SIMD_VL <= q; mm += LTFAT_SIMD_VL)
+            {
+                ltfat_simd_v g = V_LOAD(gp + 2 * mm);
+                ltfat_simd_v c = V_LOAD(cp + 2 * mm);
+                accre = V_ADD(accre, V_MUL(g, c));
+                accim = V_ADD(accim, V_MUL(V_SWAP(g), c));
+            }
+
+            V_STORE(tre, accre);
+            V_STORE(tim, accim);
+            for (ltfat_int v = 0; v < LTFAT_SIMD_VL; v++)
+            {
+                re += tre[2 * v] - tre[2 * v + 1];
+                im += tim[2 * v] + tim[2 * v + 1];
+            }
+#endif
+            for (; mm < q; mm++)
+            {
+                re += gp[2 * mm] * cp[2 * mm] - gp[2 * mm + 1] * cp[2 * mm + 1];
+                im += gp[2 * mm] * cp[2 * mm + 1] + gp[2 * mm + 1] * cp[2 * mm];
+            }
+
+            fp[2 * km]     = re * scal;
+            fp[2 * km + 1] = im * scal;
+        }
+    }
+}
+
+/* The coset loop is split among the threads if there are enough cosets,
+ * otherwise the stages of each coset are split. */
+static inline int
+ltfat_walnut_parallel_cosets(ltfat_int c, int nthreads)
+{
+    return c >= nthreads;
+}
+
+#endif
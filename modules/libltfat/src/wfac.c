@@ -3,6 +3,7 @@
 #include "ltfat/macros.h"
 
 #include "ltfat/thirdparty/fftw3.h"
+#include "wfaccache_private.h"
 
 struct LTFAT_NAME(wfac_plan)
 {
@@ -249,3 +250,21 @@ error:
 /*     ltfat_free(sbuf); */
 /*     LTFAT_FFTW(destroy_plan)(p_before); */
 /* } */
+
+static int
+LTFAT_NAME(wfac_cache_func)(const void* g, ltfat_int L, ltfat_int a,
+                            ltfat_int M, void* gf)
+{
+    return LTFAT_NAME(wfac)((const LTFAT_TYPE*) g, L, 1, a, M,
+                            (LTFAT_COMPLEX*) gf);
+}
+
+int
+LTFAT_NAME(wfac_shared)(const LTFAT_TYPE* g, ltfat_int L, ltfat_int a,
+                        ltfat_int M, const LTFAT_COMPLEX** gf)
+{
+    return ltfat_wfac_cache_acquire(&LTFAT_NAME(wfac_cache_func),
+                                    g, L * sizeof * g, L, a, M,
+                                    L * sizeof(LTFAT_COMPLEX),
+                                    (const void**) gf);
+}
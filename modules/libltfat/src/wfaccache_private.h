@@ -0,0 +1,46 @@
+#ifndef _ltfat_wfaccache_private_h
+#define _ltfat_wfaccache_private_h
+#include <stdint.h>
+
+/* Computes factorization gf of window g of length L */
+typedef int ltfat_wfac_cache_func(const void* g, ltfat_int L, ltfat_int a,
+                                  ltfat_int M, void* gf);
+
+/*
+ * Returns a shared read-only factorization of g, computing it by func
+ * if it is not in the cache (see wfaccache_typeconstant.c).
+ * func also identifies the kind of the factorization.
+ * The buffer must be returned by ltfat_wfac_cache_release.
+ */
+int
+ltfat_wfac_cache_acquire(ltfat_wfac_cache_func* func,
+                         const void* g, size_t gbytes,
+                         ltfat_int L, ltfat_int a, ltfat_int M,
+                         size_t gfbytes, const void** gf);
+
+void
+ltfat_wfac_cache_release(const void* gf);
+
+/* Hash of nbytes of data, also used by the dgtrealmp kernel cache.
+ * Chaining the result as seed hashes a concatenation of buffers. */
+uint64_t
+ltfat_wfac_cache_hash(const void* data, size_t nbytes, uint64_t seed);
+
+#endif
+
+/* Typed part, included from type-dependent files only */
+#if defined(LTFAT_NAME) && !defined(LTFAT_WFACCACHE_TYPED)
+#define LTFAT_WFACCACHE_TYPED
+
+/* Shared factorization of g, length L */
+int
+LTFAT_NAME(wfac_shared)(const LTFAT_TYPE* g, ltfat_int L, ltfat_int a,
+                        ltfat_int M, const LTFAT_COMPLEX** gf);
+
+/* Shared factorization of real g, length wfacreal_size(L,a,M) */
+int
+LTFAT_NAME_REAL(wfacreal_shared)(const LTFAT_REAL* g, ltfat_int L,
+                                 ltfat_int a, ltfat_int M,
+                                 const LTFAT_COMPLEX** gf);
+
+#endif
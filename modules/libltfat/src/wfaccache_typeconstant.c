@@ -0,0 +1,246 @@
+#include "ltfat.h"
+#include "ltfat/types.h"
+#include "ltfat/macros.h"
+#include "wfaccache_private.h"
+#include "threads_private.h"
+
+#include <stdint.h>
+
+typedef struct ltfat_wfac_cacheentry ltfat_wfac_cacheentry;
+
+struct ltfat_wfac_cacheentry
+{
+    ltfat_wfac_cache_func* func;
+    ltfat_int L;
+    ltfat_int a;
+    ltfat_int M;
+    uint64_t hash;
+    void* g;
+    size_t gbytes;
+    void* gf;
+    size_t gfbytes;
+    int refcount;
+    uint64_t lastuse;
+    ltfat_wfac_cacheentry* next;
+};
+
+static ltfat_mutex_t cache_mutex = LTFAT_MUTEX_INITIALIZER;
+static ltfat_wfac_cacheentry* cache_head = NULL;
+static size_t cache_limit = 64 * 1024 * 1024;
+static size_t cache_bytes = 0;
+static uint64_t cache_tick = 0;
+static size_t cache_hits = 0, cache_misses = 0, cache_evictions = 0;
+
+/* 64-bit multiplicative hash over 8 byte words */
+uint64_t
+ltfat_wfac_cache_hash(const void* data, size_t nbytes, uint64_t seed)
+{
+    const unsigned char* d = (const unsigned char*) data;
+    uint64_t h = 0xcbf29ce484222325ULL ^ seed ^ (uint64_t) nbytes;
+    size_t ii = 0;
+
+    for (; ii + 8 <= nbytes; ii += 8)
+    {
+        uint64_t w;
+        memcpy(&w, d + ii, 8);
+        h = (h ^ w) * 0x9e3779b97f4a7c15ULL;
+        h ^= h >> 29;
+    }
+    for (; ii < nbytes; ii++)
+        h = (h ^ d[ii]) * 0x100000001b3ULL;
+
+    return h ^ (h >> 32);
+}
+
+static size_t
+ltfat_wfac_cacheentry_bytes(ltfat_wfac_cacheentry* e)
+{
+    return sizeof * e + e->gbytes + e->gfbytes;
+}
+
+static void
+ltfat_wfac_cacheentry_free(ltfat_wfac_cacheentry* e)
+{
+    ltfat_safefree(e->g);
+    ltfat_safefree(e->gf);
+    ltfat_free(e);
+}
+
+/* Expects the cache to be locked.
+ * Evicts the least recently used unreferenced entries until the cache
+ * holds at most limit bytes. */
+static int
+ltfat_wfac_cache_shrink_locked(size_t limit)
+{
+    int removed = 0;
+
+    while (cache_bytes > limit)
+    {
+        ltfat_wfac_cacheentry** victim = NULL;
+
+        for (ltfat_wfac_cacheentry** e = &cache_head; *e; e = &(*e)->next)
+            if ((*e)->refcount == 0 &&
+                (!victim || (*e)->lastuse < (*victim)->lastuse))
+                victim = e;
+
+        if (!victim)
+            break;
+
+        ltfat_wfac_cacheentry* tmp = *victim;
+        *victim = tmp->next;
+        cache_bytes -= ltfat_wfac_cacheentry_bytes(tmp);
+        ltfat_wfac_cacheentry_free(tmp);
+        removed++;
+    }
+
+    cache_evictions += removed;
+    return removed;
+}
+
+/* Expects the cache to be locked */
+static ltfat_wfac_cacheentry*
+ltfat_wfac_cache_find_locked(ltfat_wfac_cache_func* func, uint64_t hash,
+                             const void* g, size_t gbytes,
+                             ltfat_int L, ltfat_int a, ltfat_int M)
+{
+    for (ltfat_wfac_cacheentry* e = cache_head; e; e = e->next)
+        if (e->func == func && e->hash == hash && e->L == L && e->a == a &&
+            e->M == M && e->gbytes == gbytes && !memcmp(e->g, g, gbytes))
+            return e;
+
+    return NULL;
+}
+
+int
+ltfat_wfac_cache_acquire(ltfat_wfac_cache_func* func,
+                         const void* g, size_t gbytes,
+                         ltfat_int L, ltfat_int a, ltfat_int M,
+                         size_t gfbytes, const void** gf)
+{
+    ltfat_wfac_cacheentry* e = NULL, *other;
+    uint64_t hash;
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(func); CHECKNULL(g); CHECKNULL(gf);
+
+    hash = ltfat_wfac_cache_hash(g, gbytes, 0);
+
+    ltfat_mutex_lock(&cache_mutex);
+    other = ltfat_wfac_cache_find_locked(func, hash, g, gbytes, L, a, M);
+    if (other)
+    {
+        other->refcount++;
+        cache_hits++;
+        *gf = other->gf;
+    }
+    ltfat_mutex_unlock(&cache_mutex);
+
+    if (other)
+        return status;
+
+    /* The factorization is computed without holding the lock */
+    CHECKMEM( e = LTFAT_NEW(ltfat_wfac_cacheentry) );
+    CHECKMEM( e->g = ltfat_malloc(gbytes) );
+    CHECKMEM( e->gf = ltfat_malloc(gfbytes) );
+    memcpy(e->g, g, gbytes);
+    e->func = func; e->hash = hash;
+    e->L = L; e->a = a; e->M = M;
+    e->gbytes = gbytes; e->gfbytes = gfbytes;
+    e->refcount = 1;
+
+    CHECKSTATUS( func(g, L, a, M, e->gf));
+
+    ltfat_mutex_lock(&cache_mutex);
+    /* Another thread might have inserted the same factorization meanwhile */
+    other = ltfat_wfac_cache_find_locked(func, hash, g, gbytes, L, a, M);
+    if (other)
+    {
+        other->refcount++;
+        cache_hits++;
+        *gf = other->gf;
+    }
+    else
+    {
+        ltfat_wfac_cache_shrink_locked(
+            cache_limit > ltfat_wfac_cacheentry_bytes(e) ?
+            cache_limit - ltfat_wfac_cacheentry_bytes(e) : 0);
+        e->next = cache_head;
+        cache_head = e;
+        cache_bytes += ltfat_wfac_cacheentry_bytes(e);
+        cache_misses++;
+        *gf = e->gf;
+    }
+    ltfat_mutex_unlock(&cache_mutex);
+
+    if (other)
+        ltfat_wfac_cacheentry_free(e);
+
+    return status;
+error:
+    if (e) ltfat_wfac_cacheentry_free(e);
+    return status;
+}
+
+void
+ltfat_wfac_cache_release(const void* gf)
+{
+    if (!gf) return;
+
+    ltfat_mutex_lock(&cache_mutex);
+    for (ltfat_wfac_cacheentry* e = cache_head; e; e = e->next)
+        if (e->gf == gf)
+        {
+            if (--e->refcount == 0)
+            {
+                e->lastuse = ++cache_tick;
+                ltfat_wfac_cache_shrink_locked(cache_limit);
+            }
+            break;
+        }
+    ltfat_mutex_unlock(&cache_mutex);
+}
+
+LTFAT_API int
+ltfat_wfac_cache_set_limit(size_t bytes)
+{
+    ltfat_mutex_lock(&cache_mutex);
+    cache_limit = bytes;
+    ltfat_wfac_cache_shrink_locked(cache_limit);
+    ltfat_mutex_unlock(&cache_mutex);
+    return LTFATERR_SUCCESS;
+}
+
+LTFAT_API int
+ltfat_wfac_cache_get_stats(ltfat_wfac_cache_stats* stats)
+{
+    int status = LTFATERR_SUCCESS;
+    CHECKNULL(stats);
+
+    ltfat_mutex_lock(&cache_mutex);
+    stats->bytes = cache_bytes;
+    stats->limit = cache_limit;
+    stats->entries = 0;
+    stats->inuse = 0;
+    for (ltfat_wfac_cacheentry* e = cache_head; e; e = e->next)
+    {
+        stats->entries++;
+        if (e->refcount > 0) stats->inuse++;
+    }
+    stats->hits = cache_hits;
+    stats->misses = cache_misses;
+    stats->evictions = cache_evictions;
+    ltfat_mutex_unlock(&cache_mutex);
+error:
+    return status;
+}
+
+LTFAT_API int
+ltfat_wfac_cache_clear(void)
+{
+    int removed;
+
+    ltfat_mutex_lock(&cache_mutex);
+    removed = ltfat_wfac_cache_shrink_locked(0);
+    ltfat_mutex_unlock(&cache_mutex);
+
+    return removed;
+}
@@ -3,6 +3,7 @@
 #include "ltfat/macros.h"
 
 #include "ltfat/thirdparty/fftw3.h"
+#include "wfaccache_private.h"
 
 /* wfac for real valued input. Produces only half the output coefficients of wfac_r */
 LTFAT_API void
@@ -77,3 +78,22 @@ LTFAT_NAME(wfacreal)(const LTFAT_REAL* g, ltfat_int L, ltfat_int R,
     /* LTFAT_FFTW(destroy_plan)(p_before); */
     LTFAT_NAME(fftreal_done)(&p_before);
 }
+
+static int
+LTFAT_NAME(wfacreal_cache_func)(const void* g, ltfat_int L, ltfat_int a,
+                                ltfat_int M, void* gf)
+{
+    LTFAT_NAME(wfacreal)((const LTFAT_REAL*) g, L, 1, a, M,
+                         (LTFAT_COMPLEX*) gf);
+    return LTFATERR_SUCCESS;
+}
+
+int
+LTFAT_NAME(wfacreal_shared)(const LTFAT_REAL* g, ltfat_int L, ltfat_int a,
+                            ltfat_int M, const LTFAT_COMPLEX** gf)
+{
+    return ltfat_wfac_cache_acquire(&LTFAT_NAME(wfacreal_cache_func),
+                                    g, L * sizeof * g, L, a, M,
+                                    wfacreal_size(L, a, M) * sizeof(LTFAT_COMPLEX),
+                                    (const void**) gf);
+}
@@ -0,0 +1,55 @@
+#ifndef _ltfat_workspace_private_h
+#define _ltfat_workspace_private_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Carving of the caller-supplied workspace of the *_execute_ws functions.
+ *
+ * Buffers are taken one after another at offsets rounded up to
+ * LTFAT_WS_ALIGN bytes, which is the alignment of ltfat_malloc, such that
+ * FFT plans created on plan-owned buffers can be executed on them.
+ * Calling the same sequence of ltfat_ws_take with base == NULL only
+ * advances the offset and gives the workspace size, ltfat_ws_size adds
+ * the slack needed for aligning an arbitrary workspace pointer.
+ */
+#define LTFAT_WS_ALIGN 64
+
+static inline size_t
+ltfat_ws_roundup(size_t bytes)
+{
+    return (bytes + LTFAT_WS_ALIGN - 1) & ~((size_t) LTFAT_WS_ALIGN - 1);
+}
+
+static inline char*
+ltfat_ws_begin(void* ws)
+{
+    return (char*) (((uintptr_t) ws + LTFAT_WS_ALIGN - 1)
+                    & ~((uintptr_t) LTFAT_WS_ALIGN - 1));
+}
+
+/* Returns the buffer of the given size at *off and advances *off past it.
+ * Zero-sized buffers are returned as NULL. */
+static inline void*
+ltfat_ws_take(char* base, size_t* off, size_t bytes)
+{
+    void* buf = base && bytes ? base + *off : NULL;
+    *off += ltfat_ws_roundup(bytes);
+    return buf;
+}
+
+/* Buffers used one after another, e.g. FFT scratch, share a single one */
+static inline size_t
+ltfat_ws_max(size_t a, size_t b)
+{
+    return a > b ? a : b;
+}
+
+static inline size_t
+ltfat_ws_size(size_t off)
+{
+    return off + LTFAT_WS_ALIGN - 1;
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include <stdlib.h>
 #include <time.h>
 #include <stdio.h>
+#include <math.h>
 
 int tests_run;
 
@@ -79,6 +80,11 @@ do{ \
 }while(0)
 
 
+double maxDiff_d(const double* a, const double* b, int L);
+double maxDiff_s(const float* a, const float* b, int L);
+double maxDiff_dc(const double _Complex* a, const double _Complex* b, int L);
+double maxDiff_sc(const float _Complex* a, const float _Complex* b, int L);
+
 void fillRand_d(double *in, int L);
 void fillRand_s(float *in, int L);
 void fillRand_dc(double _Complex *in, int L);
@@ -133,8 +139,42 @@ void fillRand_sc(float _Complex* f, int L)
 }
 
 
+/*
+Maximum absolute elementwise difference
+*/
+double maxDiff_d(const double* a, const double* b, int L)
+{
+    double d = 0.0;
+    for (int m = 0; m < L; m++)
+    {
+        double e = fabs((double) a[m] - b[m]);
+        if (e != e) return INFINITY;
+        if (e > d) d = e;
+    }
+    return d;
+}
+
+double maxDiff_s(const float* a, const float* b, int L)
+{
+    double d = 0.0;
+    for (int m = 0; m < L; m++)
+    {
+        double e = fabs((double) a[m] - b[m]);
+        if (e != e) return INFINITY;
+        if (e > d) d = e;
+    }
+    return d;
+}
 
+double maxDiff_dc(const double _Complex* a, const double _Complex* b, int L)
+{
+    return maxDiff_d((const double*) a, (const double*) b, 2 * L);
+}
 
+double maxDiff_sc(const float _Complex* a, const float _Complex* b, int L)
+{
+    return maxDiff_s((const float*) a, (const float*) b, 2 * L);
+}
 
 
 
@@ -2,6 +2,7 @@
 #include "ltfat/errno.h"
 #include "ltfat/macros.h"
 #include "minunit.h"
+#include "multiinclude.h"
 
 
 void all_tests()
@@ -25,6 +26,8 @@ void all_tests()
     mu_run_test_singledouble(test_idgtreal_fb);
     mu_run_test_singledouble(test_dgtreal_long);
     mu_run_test_singledouble(test_idgtreal_long);
+    mu_run_test_singledouble(test_dgtreal_execute_ws);
+    mu_run_test_singledouble(test_wfac_cache);
     mu_run_test_singledouble(test_pgauss);
     mu_run_test_singledouble(test_fftcircshift);
     mu_run_test_singledouble(test_fftfftshift);
@@ -32,6 +35,12 @@ void all_tests()
     mu_run_test_singledouble(test_fftrealcircshift);
     mu_run_test_singledouble(test_fftrealfftshift);
     mu_run_test_singledouble(test_fftrealifftshift);
+    mu_run_test_singledouble(test_fft);
+    mu_run_test_singledouble(test_maxtree);
+    mu_run_test_singledouble(test_dgtrealmp_batch);
+    mu_run_test_singledouble(test_dgtrealmp_dict);
+    mu_run_test_singledouble(test_rtdgtreal_modes);
+    mu_run_test_singledouble(test_rtsafe);
 
     mu_suite_stop();
 }
@@ -0,0 +1,142 @@
+#include "ltfat/thirdparty/fftw3.h"
+
+/* The frame blocking, the threads and the caller-supplied workspace must
+ * not change the result. The filter bank and the factorization algorithm
+ * must agree. */
+int TEST_NAME(test_dgtreal_execute_ws)()
+{
+    ltfat_int L = 480, gl = 48, a = 24, M = 60, W = 3;
+    ltfat_int blocksize[] = {1, 3, 7, 0};
+    int nthreads[] = {1, 2, 4};
+    ltfat_int N = L / a, M2 = M / 2 + 1;
+    double tol = sizeof(LTFAT_REAL) == sizeof(double) ? 1e-10 : 1e-3;
+    char msg[128];
+
+    LTFAT_REAL* f = LTFAT_NAME_REAL(malloc)(L * W);
+    LTFAT_REAL* fref = LTFAT_NAME_REAL(malloc)(L * W);
+    LTFAT_REAL* fout = LTFAT_NAME_REAL(malloc)(L * W);
+    LTFAT_REAL* g = LTFAT_NAME_REAL(malloc)(gl);
+    LTFAT_REAL* gd = LTFAT_NAME_REAL(malloc)(gl);
+    LTFAT_REAL* glong = LTFAT_NAME_REAL(malloc)(L);
+    LTFAT_REAL* gdlong = LTFAT_NAME_REAL(malloc)(L);
+    LTFAT_COMPLEX* c = LTFAT_NAME_COMPLEX(malloc)(M2 * N * W);
+    LTFAT_COMPLEX* cref = LTFAT_NAME_COMPLEX(malloc)(M2 * N * W);
+    LTFAT_COMPLEX* cout = LTFAT_NAME_COMPLEX(malloc)(M2 * N * W);
+    TEST_NAME(fillRand)(f, L * W);
+    LTFAT_NAME_REAL(firwin)(LTFAT_HANN, gl, g);
+    LTFAT_NAME_REAL(gabdual_painless)(g, gl, a, M, gd);
+    LTFAT_NAME_REAL(fir2long)(g, gl, L, glong);
+    LTFAT_NAME_REAL(fir2long)(gd, gl, L, gdlong);
+
+    // Reference: one frame at a time, single thread
+    mu_assert( LTFAT_NAME(dgtreal_fb)(f, g, L, gl, W, a, M, LTFAT_FREQINV, cref)
+               == LTFATERR_SUCCESS, "dgtreal_fb reference");
+    mu_assert( LTFAT_NAME(idgtreal_fb)(cref, gd, L, gl, W, a, M, LTFAT_FREQINV, fref)
+               == LTFATERR_SUCCESS, "idgtreal_fb reference");
+    mu_assert( TEST_NAME(maxDiff)(f, fref, L * W) < tol,
+               "idgtreal_fb reconstructs");
+
+    for (unsigned int bId = 0; bId < ARRAYLEN(blocksize); bId++)
+    {
+        for (unsigned int tId = 0; tId < ARRAYLEN(nthreads); tId++)
+        {
+            LTFAT_NAME(dgtreal_fb_plan)* plan = NULL;
+            LTFAT_NAME(idgtreal_fb_plan)* iplan = NULL;
+
+            mu_assert( LTFAT_NAME(dgtreal_fb_init)(g, gl, a, M, LTFAT_FREQINV,
+                       FFTW_ESTIMATE, &plan) == LTFATERR_SUCCESS, "dgtreal_fb_init");
+            mu_assert( LTFAT_NAME(idgtreal_fb_init)(gd, gl, a, M, LTFAT_FREQINV,
+                       FFTW_ESTIMATE, &iplan) == LTFATERR_SUCCESS, "idgtreal_fb_init");
+            LTFAT_NAME(dgtreal_fb_set_blocksize)(plan, blocksize[bId]);
+            LTFAT_NAME(dgtreal_fb_set_numthreads)(plan, nthreads[tId]);
+            LTFAT_NAME(idgtreal_fb_set_blocksize)(iplan, blocksize[bId]);
+            LTFAT_NAME(idgtreal_fb_set_numthreads)(iplan, nthreads[tId]);
+            LTFAT_NAME(idgtreal_fb_set_overwriteoutarray)(iplan, 1);
+
+            // Deliberately misaligned, any alignment is accepted
+            size_t wsLen = LTFAT_NAME(dgtreal_fb_get_workspace_size)(plan);
+            size_t iwsLen = LTFAT_NAME(idgtreal_fb_get_workspace_size)(iplan);
+            char* ws = (char*) ltfat_malloc((wsLen > iwsLen ? wsLen : iwsLen) + 1);
+
+            sprintf(msg, "dgtreal_fb blocksize %td, %d threads",
+                    blocksize[bId], nthreads[tId]);
+            LTFAT_NAME(dgtreal_fb_execute)(plan, f, L, W, c);
+            mu_assert( TEST_NAME_COMPLEX(maxDiff)(c, cref, M2 * N * W) < tol, msg);
+
+            sprintf(msg, "dgtreal_fb_execute_ws blocksize %td, %d threads",
+                    blocksize[bId], nthreads[tId]);
+            TEST_NAME_COMPLEX(fillRand)(cout, M2 * N * W);
+            LTFAT_NAME(dgtreal_fb_execute_ws)(plan, f, L, W, cout, ws + 1);
+            mu_assert( TEST_NAME_COMPLEX(maxDiff)(cout, c, M2 * N * W) == 0, msg);
+
+            sprintf(msg, "idgtreal_fb blocksize %td, %d threads",
+                    blocksize[bId], nthreads[tId]);
+            LTFAT_NAME(idgtreal_fb_execute)(iplan, cref, L, W, fout);
+            mu_assert( TEST_NAME(maxDiff)(fout, fref, L * W) < tol, msg);
+
+            sprintf(msg, "idgtreal_fb_execute_ws blocksize %td, %d threads",
+                    blocksize[bId], nthreads[tId]);
+            TEST_NAME(fillRand)(fout, L * W);
+            LTFAT_NAME(idgtreal_fb_execute_ws)(iplan, cref, L, W, fout, ws + 1);
+            mu_assert( TEST_NAME(maxDiff)(fout, fref, L * W) < tol, msg);
+
+            ltfat_free(ws);
+            LTFAT_NAME(dgtreal_fb_done)(&plan);
+            LTFAT_NAME(idgtreal_fb_done)(&iplan);
+        }
+    }
+
+    for (unsigned int tId = 0; tId < ARRAYLEN(nthreads); tId++)
+    {
+        LTFAT_NAME(dgtreal_long_plan)* plan = NULL;
+        LTFAT_NAME(idgtreal_long_plan)* iplan = NULL;
+
+        mu_assert( LTFAT_NAME(dgtreal_long_init)(glong, L, W, a, M, f, c,
+                   LTFAT_FREQINV, FFTW_ESTIMATE, &plan) == LTFATERR_SUCCESS,
+                   "dgtreal_long_init");
+        mu_assert( LTFAT_NAME(idgtreal_long_init)(gdlong, L, W, a, M, c, fout,
+                   LTFAT_FREQINV, FFTW_ESTIMATE, &iplan) == LTFATERR_SUCCESS,
+                   "idgtreal_long_init");
+        LTFAT_NAME(dgtreal_long_set_numthreads)(plan, nthreads[tId]);
+        LTFAT_NAME(idgtreal_long_set_numthreads)(iplan, nthreads[tId]);
+        LTFAT_NAME(idgtreal_long_set_overwriteoutarray)(iplan, 1);
+
+        size_t wsLen = LTFAT_NAME(dgtreal_long_get_workspace_size)(plan);
+        size_t iwsLen = LTFAT_NAME(idgtreal_long_get_workspace_size)(iplan);
+        char* ws = (char*) ltfat_malloc((wsLen > iwsLen ? wsLen : iwsLen) + 1);
+
+        sprintf(msg, "dgtreal_long equals dgtreal_fb, %d threads", nthreads[tId]);
+        LTFAT_NAME(dgtreal_long_execute_newarray)(plan, f, c);
+        mu_assert( TEST_NAME_COMPLEX(maxDiff)(c, cref, M2 * N * W) < tol, msg);
+
+        sprintf(msg, "dgtreal_long_execute_ws, %d threads", nthreads[tId]);
+        TEST_NAME_COMPLEX(fillRand)(cout, M2 * N * W);
+        LTFAT_NAME(dgtreal_long_execute_ws)(plan, f, cout, ws + 1);
+        mu_assert( TEST_NAME_COMPLEX(maxDiff)(cout, c, M2 * N * W) == 0, msg);
+
+        sprintf(msg, "idgtreal_long equals idgtreal_fb, %d threads", nthreads[tId]);
+        LTFAT_NAME(idgtreal_long_execute_newarray)(iplan, cref, fout);
+        mu_assert( TEST_NAME(maxDiff)(fout, fref, L * W) < tol, msg);
+
+        sprintf(msg, "idgtreal_long_execute_ws, %d threads", nthreads[tId]);
+        TEST_NAME(fillRand)(fout, L * W);
+        LTFAT_NAME(idgtreal_long_execute_ws)(iplan, cref, fout, ws + 1);
+        mu_assert( TEST_NAME(maxDiff)(fout, fref, L * W) < tol, msg);
+
+        ltfat_free(ws);
+        LTFAT_NAME(dgtreal_long_done)(&plan);
+        LTFAT_NAME(idgtreal_long_done)(&iplan);
+    }
+
+    ltfat_free(f);
+    ltfat_free(fref);
+    ltfat_free(fout);
+    ltfat_free(g);
+    ltfat_free(gd);
+    ltfat_free(glong);
+    ltfat_free(gdlong);
+    ltfat_free(c);
+    ltfat_free(cref);
+    ltfat_free(cout);
+    return 0;
+}
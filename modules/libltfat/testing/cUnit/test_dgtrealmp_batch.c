@@ -0,0 +1,92 @@
+/* Decomposes f with the given algorithm, returns the status of execute */
+static int
+TEST_NAME(batchmp_run)(ltfat_dgtmp_alg alg, int nthreads, size_t batchsize,
+                       const LTFAT_REAL f[], ltfat_int L, LTFAT_COMPLEX* c[],
+                       size_t* atoms)
+{
+    LTFAT_NAME(dgtrealmp_parbuf)* pb = NULL;
+    LTFAT_NAME(dgtrealmp_state)* p = NULL;
+    int status;
+
+    LTFAT_NAME(dgtrealmp_parbuf_init)(&pb);
+    LTFAT_NAME(dgtrealmp_parbuf_add_firwin)(pb, LTFAT_HANN, 512, 64, 512);
+    LTFAT_NAME(dgtrealmp_parbuf_add_firwin)(pb, LTFAT_BLACKMAN, 128, 32, 128);
+    LTFAT_NAME(dgtrealmp_setparbuf_snrdb)(pb, 40);
+    LTFAT_NAME(dgtrealmp_setparbuf_maxatoms)(pb, 5000);
+    LTFAT_NAME(dgtrealmp_setparbuf_alg)(pb, alg);
+    LTFAT_NAME(dgtrealmp_setparbuf_nthreads)(pb, nthreads);
+    LTFAT_NAME(dgtrealmp_setparbuf_batchsize)(pb, batchsize);
+
+    status = LTFAT_NAME(dgtrealmp_init)(pb, L, &p);
+    if (status == LTFATERR_SUCCESS)
+    {
+        status = LTFAT_NAME(dgtrealmp_execute_decompose)(p, f, c);
+        LTFAT_NAME(dgtrealmp_get_numatoms)(p, atoms);
+        LTFAT_NAME(dgtrealmp_done)(&p);
+    }
+
+    LTFAT_NAME(dgtrealmp_parbuf_done)(&pb);
+    return status;
+}
+
+/* Batch MP with batches of a single atom is plain MP and the threads do not
+ * change the batch MP decomposition */
+int TEST_NAME(test_dgtrealmp_batch)()
+{
+    ltfat_int L = 4096;
+    ltfat_int clen[] = { 257 * (4096 / 64), 65 * (4096 / 32) };
+    size_t atomsref, atoms;
+    char msg[128];
+
+    LTFAT_REAL* f = LTFAT_NAME_REAL(malloc)(L);
+    LTFAT_COMPLEX* cref[2];
+    LTFAT_COMPLEX* c[2];
+    for (int k = 0; k < 2; k++)
+    {
+        cref[k] = LTFAT_NAME_COMPLEX(malloc)(clen[k]);
+        c[k] = LTFAT_NAME_COMPLEX(malloc)(clen[k]);
+    }
+
+    for (ltfat_int l = 0; l < L; l++)
+        f[l] = (LTFAT_REAL)(sin(0.1 * l) * (1.0 + sin(0.003 * l)) +
+                            0.5 * sin(0.0002 * l * l) + (l % 1024 < 16 ? 1.0 : 0.0));
+
+    mu_assert( TEST_NAME(batchmp_run)(ltfat_dgtmp_alg_mp, 1, 0, f, L, cref,
+               &atomsref) >= 0, "Plain MP");
+
+    for (int nthreads = 1; nthreads <= 2; nthreads++)
+    {
+        int status = TEST_NAME(batchmp_run)(ltfat_dgtmp_alg_batchmp, nthreads, 1,
+                                            f, L, c, &atoms);
+        int same = status >= 0 && atoms == atomsref;
+        for (int k = 0; k < 2; k++)
+            same = same && !memcmp(c[k], cref[k], clen[k] * sizeof * c[k]);
+
+        sprintf(msg, "Batch MP with batchsize 1 and %d threads equals plain MP",
+                nthreads);
+        mu_assert( same, msg);
+    }
+
+    mu_assert( TEST_NAME(batchmp_run)(ltfat_dgtmp_alg_batchmp, 1, 32, f, L, cref,
+               &atomsref) >= 0, "Batch MP, 1 thread");
+
+    for (int nthreads = 2; nthreads <= 4; nthreads += 2)
+    {
+        int status = TEST_NAME(batchmp_run)(ltfat_dgtmp_alg_batchmp, nthreads, 32,
+                                            f, L, c, &atoms);
+        int same = status >= 0 && atoms == atomsref;
+        for (int k = 0; k < 2; k++)
+            same = same && !memcmp(c[k], cref[k], clen[k] * sizeof * c[k]);
+
+        sprintf(msg, "Batch MP with %d threads equals 1 thread", nthreads);
+        mu_assert( same, msg);
+    }
+
+    ltfat_free(f);
+    for (int k = 0; k < 2; k++)
+    {
+        ltfat_free(cref[k]);
+        ltfat_free(c[k]);
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+/* States sharing a dictionary must decompose exactly like independent
+ * states, also when their iterations are interleaved */
+int TEST_NAME(test_dgtrealmp_dict)()
+{
+    enum { J = 3 };
+    ltfat_int L = 4096;
+    ltfat_int clen[2];
+    LTFAT_NAME(dgtrealmp_parbuf)* pb = NULL;
+    LTFAT_NAME(dgtrealmp_dict)* dict = NULL;
+    LTFAT_NAME(dgtrealmp_state)* p[J] = {NULL};
+    LTFAT_REAL* f[J];
+    LTFAT_REAL* fref[J];
+    LTFAT_REAL* fout[J];
+    LTFAT_COMPLEX* cref[J][2];
+    LTFAT_COMPLEX* c[J][2];
+    int status[J];
+    char msg[128];
+
+    LTFAT_NAME(dgtrealmp_parbuf_init)(&pb);
+    LTFAT_NAME(dgtrealmp_parbuf_add_firwin)(pb, LTFAT_HANN, 512, 64, 512);
+    LTFAT_NAME(dgtrealmp_parbuf_add_firwin)(pb, LTFAT_BLACKMAN, 128, 32, 128);
+    LTFAT_NAME(dgtrealmp_setparbuf_snrdb)(pb, 40);
+    LTFAT_NAME(dgtrealmp_setparbuf_maxatoms)(pb, 5000);
+    for (int k = 0; k < 2; k++)
+        clen[k] = LTFAT_NAME(dgtrealmp_getparbuf_coeflen)(pb, L, k);
+
+    for (int j = 0; j < J; j++)
+    {
+        f[j] = LTFAT_NAME_REAL(malloc)(L);
+        fref[j] = LTFAT_NAME_REAL(malloc)(L);
+        fout[j] = LTFAT_NAME_REAL(malloc)(L);
+        for (int k = 0; k < 2; k++)
+        {
+            cref[j][k] = LTFAT_NAME_COMPLEX(malloc)(clen[k]);
+            c[j][k] = LTFAT_NAME_COMPLEX(malloc)(clen[k]);
+        }
+        for (ltfat_int l = 0; l < L; l++)
+            f[j][l] = (LTFAT_REAL)(sin((0.05 + 0.03 * j) * l) * (1.0 + sin(0.002 * l)) +
+                                   (l % (512 * (j + 1)) < 8 ? 1.0 : 0.0));
+    }
+
+    // Reference: independent states
+    for (int j = 0; j < J; j++)
+    {
+        mu_assert( LTFAT_NAME(dgtrealmp_init)(pb, L, &p[j]) == LTFATERR_SUCCESS,
+                   "dgtrealmp_init");
+        mu_assert( LTFAT_NAME(dgtrealmp_execute)(p[j], f[j], cref[j], fref[j]) >= 0,
+                   "dgtrealmp_execute");
+        LTFAT_NAME(dgtrealmp_done)(&p[j]);
+    }
+
+    // The states keep the dictionary alive
+    mu_assert( LTFAT_NAME(dgtrealmp_dict_init)(pb, L, &dict) == LTFATERR_SUCCESS,
+               "dgtrealmp_dict_init");
+    for (int j = 0; j < J; j++)
+        mu_assert( LTFAT_NAME(dgtrealmp_init_fromdict)(dict, NULL, &p[j])
+                   == LTFATERR_SUCCESS, "dgtrealmp_init_fromdict");
+    LTFAT_NAME(dgtrealmp_dict_done)(&dict);
+
+    for (int j = 0; j < J; j++)
+    {
+        LTFAT_NAME(dgtrealmp_reset)(p[j], f[j]);
+        for (int k = 0; k < 2; k++)
+            memset(c[j][k], 0, clen[k] * sizeof * c[j][k]);
+        status[j] = LTFAT_DGTREALMP_STATUS_CANCONTINUE;
+    }
+
+    for (int running = J; running > 0; )
+    {
+        running = 0;
+        for (int j = 0; j < J; j++)
+        {
+            if (status[j] != LTFAT_DGTREALMP_STATUS_CANCONTINUE) continue;
+            status[j] = LTFAT_NAME(dgtrealmp_execute_niters)(p[j], 7, c[j]);
+            running++;
+        }
+    }
+
+    for (int j = 0; j < J; j++)
+    {
+        LTFAT_NAME(dgtrealmp_execute_synthesize)(
+            p[j], (const LTFAT_COMPLEX**) c[j], NULL, fout[j]);
+
+        int same = status[j] >= 0 &&
+                   !memcmp(fout[j], fref[j], L * sizeof * fout[j]);
+        for (int k = 0; k < 2; k++)
+            same = same && !memcmp(c[j][k], cref[j][k], clen[k] * sizeof * c[j][k]);
+
+        sprintf(msg, "Interleaved state %d sharing the dictionary equals independent", j);
+        mu_assert( same, msg);
+    }
+
+    // A state decomposes another signal just like a fresh one
+    mu_assert( LTFAT_NAME(dgtrealmp_execute)(p[0], f[1], c[0], fout[0]) >= 0,
+               "dgtrealmp_execute");
+    int same = !memcmp(fout[0], fref[1], L * sizeof * fout[0]);
+    for (int k = 0; k < 2; k++)
+        same = same && !memcmp(c[0][k], cref[1][k], clen[k] * sizeof * c[0][k]);
+    mu_assert( same, "Reused state equals independent");
+
+    for (int j = 0; j < J; j++)
+    {
+        LTFAT_NAME(dgtrealmp_done)(&p[j]);
+        ltfat_free(f[j]);
+        ltfat_free(fref[j]);
+        ltfat_free(fout[j]);
+        for (int k = 0; k < 2; k++)
+        {
+            ltfat_free(cref[j][k]);
+            ltfat_free(c[j][k]);
+        }
+    }
+    LTFAT_NAME(dgtrealmp_parbuf_done)(&pb);
+    return 0;
+}
@@ -0,0 +1,174 @@
+/* Reference DFT computed directly in double precision. sign = -1 gives the
+ * forward, sign = 1 the (unnormalized) inverse transform. */
+static void
+TEST_NAME(naive_dft)(const LTFAT_COMPLEX in[], ltfat_int L, ltfat_int W,
+                     int sign, LTFAT_COMPLEX out[])
+{
+    for (ltfat_int w = 0; w < W; w++)
+    {
+        for (ltfat_int k = 0; k < L; k++)
+        {
+            double re = 0.0, im = 0.0;
+
+            for (ltfat_int l = 0; l < L; l++)
+            {
+                double phi = sign * 2.0 * M_PI * ((k * l) % L) / L;
+                double xr = ltfat_real(in[l + w * L]);
+                double xi = ltfat_imag(in[l + w * L]);
+                re += xr * cos(phi) - xi * sin(phi);
+                im += xr * sin(phi) + xi * cos(phi);
+            }
+
+            out[k + w * L] = (LTFAT_REAL) re + I * (LTFAT_REAL) im;
+        }
+    }
+}
+
+int TEST_NAME(test_fft)()
+{
+    ltfat_int L[]  = { 1, 9, 64, 100, 257 };
+    ltfat_int W[]  = { 1, 3 };
+    ltfat_fft_backend backends[] = { LTFAT_FFT_BACKEND_FFTW,
+                                     LTFAT_FFT_BACKEND_NATIVE,
+                                     LTFAT_FFT_BACKEND_KISS };
+    double tol = sizeof(LTFAT_REAL) == sizeof(float) ? 1e-4 : 1e-10;
+
+    // The one-shot functions must not plan in a way that overwrites the
+    // input, e.g. by FFTW_MEASURE, so they must agree with a plan created
+    // on other arrays. All of them must agree with the reference DFT.
+    for (unsigned int bId = 0; bId < ARRAYLEN(backends); bId++)
+    {
+        if (!ltfat_fft_backend_available(backends[bId]))
+            continue;
+
+        ltfat_fft_set_backend(backends[bId]);
+
+        for (unsigned int lId = 0; lId < ARRAYLEN(L); lId++)
+        {
+            for (unsigned int wId = 0; wId < ARRAYLEN(W); wId++)
+            {
+                ltfat_int Ll = L[lId], M2 = L[lId] / 2 + 1;
+                ltfat_int LW = L[lId] * W[wId];
+                ltfat_int M2W = M2 * W[wId];
+                const char* name = ltfat_fft_backend_name(backends[bId]);
+                LTFAT_COMPLEX* fc = LTFAT_NAME_COMPLEX(malloc)(LW);
+                LTFAT_COMPLEX* fc2 = LTFAT_NAME_COMPLEX(malloc)(LW);
+                LTFAT_COMPLEX* f0 = LTFAT_NAME_COMPLEX(malloc)(LW);
+                LTFAT_COMPLEX* c = LTFAT_NAME_COMPLEX(malloc)(LW);
+                LTFAT_COMPLEX* c2 = LTFAT_NAME_COMPLEX(malloc)(LW);
+                LTFAT_COMPLEX* cref = LTFAT_NAME_COMPLEX(malloc)(LW);
+                LTFAT_REAL* fr = LTFAT_NAME_REAL(malloc)(LW);
+                LTFAT_REAL* fr2 = LTFAT_NAME_REAL(malloc)(LW);
+                LTFAT_REAL* r = LTFAT_NAME_REAL(malloc)(LW);
+                LTFAT_REAL* r2 = LTFAT_NAME_REAL(malloc)(LW);
+                LTFAT_REAL* rref = LTFAT_NAME_REAL(malloc)(LW);
+
+                LTFAT_NAME(fft_plan)* pfft = NULL;
+                LTFAT_NAME(ifft_plan)* pifft = NULL;
+                LTFAT_NAME(fftreal_plan)* pfftreal = NULL;
+                LTFAT_NAME(ifftreal_plan)* pifftreal = NULL;
+
+                mu_assert(
+                    LTFAT_NAME(fft_init)(Ll, W[wId], fc2, c2, 0, &pfft) == 0 &&
+                    LTFAT_NAME(ifft_init)(Ll, W[wId], fc2, c2, 0, &pifft) == 0 &&
+                    LTFAT_NAME(fftreal_init)(Ll, W[wId], fr2, c2, 0, &pfftreal) == 0 &&
+                    LTFAT_NAME(ifftreal_init)(Ll, W[wId], c2, r2, 0, &pifftreal) == 0,
+                    "%s plans L=%td, W=%td", name, Ll, W[wId]);
+
+                // fft
+                TEST_NAME_COMPLEX(fillRand)(fc, LW);
+                memcpy(fc2, fc, LW * sizeof * fc);
+                memcpy(f0, fc, LW * sizeof * fc);
+                TEST_NAME(naive_dft)(f0, Ll, W[wId], -1, cref);
+                LTFAT_NAME(fft_execute_newarray)(pfft, fc2, c2);
+                mu_assert( LTFAT_NAME(fft)(fc, Ll, W[wId], c) == 0 &&
+                           TEST_NAME_COMPLEX(maxDiff)(c, c2, LW) <= tol * Ll,
+                           "%s fft one-shot L=%td, W=%td", name, Ll, W[wId]);
+                mu_assert( TEST_NAME_COMPLEX(maxDiff)(c, cref, LW) <= tol * Ll,
+                           "%s fft equals DFT L=%td, W=%td", name, Ll, W[wId]);
+
+                // Round trip, ifft is not normalized
+                mu_assert( LTFAT_NAME(ifft)(c, Ll, W[wId], fc2) == 0,
+                           "%s ifft L=%td, W=%td", name, Ll, W[wId]);
+                for (ltfat_int l = 0; l < LW; l++)
+                    fc2[l] /= (LTFAT_REAL) Ll;
+                mu_assert( TEST_NAME_COMPLEX(maxDiff)(fc2, f0, LW) <= tol * Ll,
+                           "%s ifft(fft) round trip L=%td, W=%td", name, Ll, W[wId]);
+
+                // ifft
+                TEST_NAME_COMPLEX(fillRand)(fc, LW);
+                memcpy(fc2, fc, LW * sizeof * fc);
+                memcpy(f0, fc, LW * sizeof * fc);
+                TEST_NAME(naive_dft)(f0, Ll, W[wId], 1, cref);
+                LTFAT_NAME(ifft_execute_newarray)(pifft, fc2, c2);
+                mu_assert( LTFAT_NAME(ifft)(fc, Ll, W[wId], c) == 0 &&
+                           TEST_NAME_COMPLEX(maxDiff)(c, c2, LW) <= tol * Ll,
+                           "%s ifft one-shot L=%td, W=%td", name, Ll, W[wId]);
+                mu_assert( TEST_NAME_COMPLEX(maxDiff)(c, cref, LW) <= tol * Ll,
+                           "%s ifft equals DFT L=%td, W=%td", name, Ll, W[wId]);
+
+                // fftreal, the reference keeps the first M2 coefficients
+                TEST_NAME(fillRand)(fr, LW);
+                memcpy(fr2, fr, LW * sizeof * fr);
+                memcpy(rref, fr, LW * sizeof * fr);
+                for (ltfat_int l = 0; l < LW; l++)
+                    f0[l] = fr[l];
+                TEST_NAME(naive_dft)(f0, Ll, W[wId], -1, cref);
+                for (ltfat_int w = 0; w < W[wId]; w++)
+                    memmove(cref + w * M2, cref + w * Ll, M2 * sizeof * cref);
+                LTFAT_NAME(fftreal_execute_newarray)(pfftreal, fr2, c2);
+                mu_assert( LTFAT_NAME(fftreal)(fr, Ll, W[wId], c) == 0 &&
+                           TEST_NAME_COMPLEX(maxDiff)(c, c2, M2W) <= tol * Ll,
+                           "%s fftreal one-shot L=%td, W=%td", name, Ll, W[wId]);
+                mu_assert( TEST_NAME_COMPLEX(maxDiff)(c, cref, M2W) <= tol * Ll,
+                           "%s fftreal equals DFT L=%td, W=%td", name, Ll, W[wId]);
+
+                // ifftreal of the spectrum of a real signal, so that the
+                // result is well defined. The reference extends it to the
+                // full Hermitian spectrum.
+                for (ltfat_int w = 0; w < W[wId]; w++)
+                {
+                    for (ltfat_int m = 0; m < M2; m++)
+                        f0[m + w * Ll] = c[m + w * M2];
+                    for (ltfat_int m = M2; m < Ll; m++)
+                        f0[m + w * Ll] = ltfat_real(c[Ll - m + w * M2]) -
+                                         I * ltfat_imag(c[Ll - m + w * M2]);
+                }
+                TEST_NAME(naive_dft)(f0, Ll, W[wId], 1, cref);
+                memcpy(fc, c, M2W * sizeof * c);
+                memcpy(fc2, c, M2W * sizeof * c);
+                LTFAT_NAME(ifftreal_execute_newarray)(pifftreal, fc2, r2);
+                mu_assert( LTFAT_NAME(ifftreal)(fc, Ll, W[wId], r) == 0 &&
+                           TEST_NAME(maxDiff)(r, r2, LW) <= tol * Ll,
+                           "%s ifftreal one-shot L=%td, W=%td", name, Ll, W[wId]);
+
+                double err = 0.0;
+                for (ltfat_int l = 0; l < LW; l++)
+                {
+                    double e = fabs(r[l] - ltfat_real(cref[l]));
+                    if (e > err) err = e;
+                }
+                mu_assert( err <= tol * Ll,
+                           "%s ifftreal equals DFT L=%td, W=%td", name, Ll, W[wId]);
+
+                for (ltfat_int l = 0; l < LW; l++)
+                    r[l] /= (LTFAT_REAL) Ll;
+                mu_assert( TEST_NAME(maxDiff)(r, rref, LW) <= tol * Ll,
+                           "%s ifftreal(fftreal) round trip L=%td, W=%td",
+                           name, Ll, W[wId]);
+
+                LTFAT_NAME(fft_done)(&pfft);
+                LTFAT_NAME(ifft_done)(&pifft);
+                LTFAT_NAME(fftreal_done)(&pfftreal);
+                LTFAT_NAME(ifftreal_done)(&pifftreal);
+                ltfat_free(fc); ltfat_free(fc2); ltfat_free(f0);
+                ltfat_free(c); ltfat_free(c2); ltfat_free(cref);
+                ltfat_free(fr); ltfat_free(fr2);
+                ltfat_free(r); ltfat_free(r2); ltfat_free(rref);
+            }
+        }
+    }
+
+    ltfat_fft_set_backend(LTFAT_FFT_BACKEND_AUTO);
+    return 0;
+}
@@ -1,61 +1,163 @@
-ltfat_int      L[] = {  9 , 10, 100, 101 };
-ltfat_int  depth[] = {  1, 2, 3, 4, 5 };
-ltfat_int  rLen[]  = { 1, 2, 3, 4, 7, 8, 10, 19, 21};
+// Energy weighted by the position, mimics the dgtrealmp callbacks
+static LTFAT_REAL
+TEST_NAME(maxtree_weight)(void* userdata, LTFAT_COMPLEX cval, ltfat_int pos)
+{
+    (void) userdata;
+    return ltfat_energy(cval) * (LTFAT_REAL) (1 + pos % 5);
+}
 
-for (unsigned int lId = 0; lId < ARRAYLEN(L); lId++)
+int TEST_NAME(test_maxtree)()
 {
-    LTFAT_REAL* fin = LTFAT_NAME_REAL(malloc)(L[lId]);
-    TEST_NAME(fillRand)(fin, L[lId]);
+    ltfat_int      L[] = {  9 , 10, 100, 101 };
+    ltfat_int  depth[] = {  1, 2, 3, 4, 5 };
+    ltfat_int  rLen[]  = { 1, 2, 3, 4, 7, 8, 10, 19, 21};
 
-    for (unsigned int dId = 0; dId < ARRAYLEN(depth); dId++)
+    for (unsigned int lId = 0; lId < ARRAYLEN(L); lId++)
     {
-        ltfat_int maxPos;
-        LTFAT_REAL max;
-        ltfat_int maxPos2;
-        LTFAT_REAL max2;
-        /* fin[L[lId]-1] = 100; */
-        LTFAT_NAME(findmaxinarray)(fin, L[lId], &max, &maxPos);
-        printf("max=%.2f, maxPos=%td\n", max, maxPos);
-
-        LTFAT_NAME(maxtree)* p = NULL;
-        LTFAT_NAME(maxtree_initwitharray)(L[lId], depth[dId], fin, &p);
-        LTFAT_NAME(maxtree_findmax)(p, &max2, &maxPos2);
-        printf("max=%.2f, maxPos=%td\n", max2, maxPos2);
-
-        for (unsigned int idx = 0; idx < L[lId]; idx++)
+        LTFAT_REAL* fin = LTFAT_NAME_REAL(malloc)(L[lId]);
+        TEST_NAME(fillRand)(fin, L[lId]);
+
+        for (unsigned int dId = 0; dId < ARRAYLEN(depth); dId++)
         {
-            for (unsigned int rIdx = 0; rIdx < ARRAYLEN(rLen); rIdx++)
-            {
+            ltfat_int maxPos;
+            LTFAT_REAL max;
+            ltfat_int maxPos2;
+            LTFAT_REAL max2;
+            /* fin[L[lId]-1] = 100; */
+            LTFAT_NAME(findmaxinarray)(fin, L[lId], &max, &maxPos);
 
-                max = -100; max2 = -101; maxPos = -1; maxPos2 = -1;
-                TEST_NAME(fillRand)(fin, L[lId]);
-                LTFAT_NAME(maxtree_reset)(p, fin);
+            LTFAT_NAME(maxtree)* p = NULL;
+            LTFAT_NAME(maxtree_initwitharray)(L[lId], depth[dId], fin, &p);
+            LTFAT_NAME(maxtree_findmax)(p, &max2, &maxPos2);
 
-                for (unsigned int ii = 0; ii < rLen[rIdx]; ii++)
+            for (unsigned int idx = 0; idx < L[lId]; idx++)
+            {
+                for (unsigned int rIdx = 0; rIdx < ARRAYLEN(rLen); rIdx++)
                 {
-                    ltfat_int pos = idx + ii;
-                    if (pos >= L[lId])
-                        pos = pos%L[lId];
 
-                    fin[pos] = 100 + ii;
-                }
+                    max = -100; max2 = -101; maxPos = -1; maxPos2 = -1;
+                    TEST_NAME(fillRand)(fin, L[lId]);
+                    LTFAT_NAME(maxtree_reset)(p, fin);
+
+                    for (unsigned int ii = 0; ii < rLen[rIdx]; ii++)
+                    {
+                        ltfat_int pos = idx + ii;
+                        if (pos >= L[lId])
+                            pos = pos%L[lId];
 
-                LTFAT_NAME(findmaxinarray)(fin, L[lId], &max, &maxPos);
-                /* printf("max=%.2f, maxPos=%td\n",max,maxPos); */
+                        fin[pos] = 100 + ii;
+                    }
 
-                LTFAT_NAME(maxtree_setdirty)(p, idx, idx + rLen[rIdx]);
-                LTFAT_NAME(maxtree_findmax)(p, &max2, &maxPos2);
+                    LTFAT_NAME(findmaxinarray)(fin, L[lId], &max, &maxPos);
+                    /* printf("max=%.2f, maxPos=%td\n",max,maxPos); */
 
-                /* printf("max=%.2f, maxPos=%td\n",max2,maxPos2);  */
-                mu_assert( max == max2 && maxPos == maxPos2 ,
-                           "TREEMAX L=%td, d=%td, idx=%d, r=%td",
-                           L[lId], depth[dId], idx, rLen[rIdx] );
+                    LTFAT_NAME(maxtree_setdirty)(p, idx, idx + rLen[rIdx]);
+                    LTFAT_NAME(maxtree_findmax)(p, &max2, &maxPos2);
+
+                    /* printf("max=%.2f, maxPos=%td\n",max2,maxPos2);  */
+                    mu_assert( max == max2 && maxPos == maxPos2 ,
+                               "TREEMAX L=%td, d=%td, idx=%d, r=%td",
+                               L[lId], depth[dId], idx, rLen[rIdx] );
+                }
             }
+
+
+            LTFAT_NAME(maxtree_done)(&p);
         }
 
+        ltfat_free(fin);
+    }
+
+    // Flat trees, real and complex inputs with and without the callback.
+    // Lstep > L is the frequency tree case, where the dirty range can wrap
+    // around to the beginning.
+    ltfat_int  flatL[]     = { 1, 7, 8, 9, 64, 65, 513, 4097 };
+    ltfat_int  flatLstep[] = { 0, 3 };
+    ltfat_int  flatrLen[]  = { 1, 3, 17 };
+
+    for (unsigned int lId = 0; lId < ARRAYLEN(flatL); lId++)
+    {
+        for (unsigned int sId = 0; sId < ARRAYLEN(flatLstep); sId++)
+        {
+            ltfat_int Lf = flatL[lId];
+            ltfat_int Lstep = Lf + flatLstep[sId];
+            LTFAT_REAL* fin = LTFAT_NAME_REAL(malloc)(Lf);
+            LTFAT_COMPLEX* cin = LTFAT_NAME_COMPLEX(malloc)(Lf);
+            LTFAT_REAL* ref = LTFAT_NAME_REAL(malloc)(Lf);
+
+            for (int mode = 0; mode < 3; mode++)
+            {
+                LTFAT_NAME(maxtree)* p = NULL;
+                mu_assert( LTFAT_NAME(maxtree_init_flat)(Lf, Lstep, &p) == LTFATERR_SUCCESS,
+                           "FLATINIT L=%td", Lf);
+
+                TEST_NAME(fillRand)(fin, Lf);
+                TEST_NAME_COMPLEX(fillRand)(cin, Lf);
 
-        LTFAT_NAME(maxtree_done)(&p);
+                if (mode == 0)
+                    LTFAT_NAME(maxtree_reset)(p, fin);
+                else
+                {
+                    if (mode == 2)
+                        LTFAT_NAME(maxtree_setcallback)(p, &TEST_NAME(maxtree_weight), NULL);
+                    LTFAT_NAME(maxtree_reset_complex)(p, cin);
+                }
+
+                for (ltfat_int idx = 0; idx < Lstep; idx += 1 + Lstep / 23)
+                {
+                    for (unsigned int rIdx = 0; rIdx < ARRAYLEN(flatrLen); rIdx++)
+                    {
+                        ltfat_int maxPos, maxPos2;
+                        LTFAT_REAL max, max2;
+
+                        // Values outside of 0,...,L-1 do not exist, only the
+                        // wrapped part of the dirty range is changed there
+                        for (ltfat_int ii = 0; ii < flatrLen[rIdx]; ii++)
+                        {
+                            ltfat_int pos = (idx + ii) % Lstep;
+                            if (pos >= Lf) continue;
+                            if (mode == 0)
+                                fin[pos] = (LTFAT_REAL) (ii % 2 ? -fin[pos] : 100 + ii);
+                            else
+                                cin[pos] = (LTFAT_COMPLEX) (ii % 2 ? 0 : 100 + ii);
+                        }
+
+                        for (ltfat_int l = 0; l < Lf; l++)
+                            ref[l] = mode == 0 ? fin[l] :
+                                     mode == 1 ? ltfat_energy(cin[l]) :
+                                     TEST_NAME(maxtree_weight)(NULL, cin[l], l);
+
+                        LTFAT_NAME(findmaxinarray)(ref, Lf, &max, &maxPos);
+
+                        LTFAT_NAME(maxtree_setdirty)(p, idx, idx + flatrLen[rIdx]);
+                        LTFAT_NAME(maxtree_findmax)(p, &max2, &maxPos2);
+
+                        mu_assert( max == max2 && maxPos == maxPos2,
+                                   "FLATMAX mode=%d L=%td, Lstep=%td, idx=%td, r=%td",
+                                   mode, Lf, Lstep, idx, flatrLen[rIdx] );
+                    }
+                }
+
+                LTFAT_NAME(maxtree_done)(&p);
+            }
+
+            // A NaN must not make the search run past the node
+            {
+                LTFAT_NAME(maxtree)* p = NULL;
+                ltfat_int maxPos;
+                LTFAT_REAL max;
+                for (ltfat_int l = 0; l < Lf; l++) fin[l] = (LTFAT_REAL) NAN;
+
+                LTFAT_NAME(maxtree_init_flat)(Lf, Lstep, &p);
+                LTFAT_NAME(maxtree_reset)(p, fin);
+                LTFAT_NAME(maxtree_findmax)(p, &max, &maxPos);
+                mu_assert( maxPos >= 0 && maxPos < Lf, "FLATNAN L=%td, pos=%td", Lf, maxPos);
+                LTFAT_NAME(maxtree_done)(&p);
+            }
+
+            ltfat_free(fin); ltfat_free(cin); ltfat_free(ref);
+        }
     }
 
-    ltfat_free(fin);
+    return 0;
 }
@@ -0,0 +1,187 @@
+/* Set to make the worker stall in the callback */
+static int TEST_NAME(rtmodes_stall) = 0;
+
+/* Frame-by-frame reference modification, it also counts the frames */
+static void
+TEST_NAME(rtmodes_cb)(void* userdata, const LTFAT_COMPLEX in[], int M2, int W,
+                      LTFAT_COMPLEX out[])
+{
+    while (__atomic_load_n(&TEST_NAME(rtmodes_stall), __ATOMIC_ACQUIRE))
+        ;
+
+    for (int w = 0; w < W; w++)
+        for (int m = 0; m < M2; m++)
+            out[m + w * M2] = in[m + w * M2] * (LTFAT_REAL)(1.0 + 0.5 * (m % 3) + w);
+
+    if (userdata) __atomic_fetch_add((int*) userdata, 1, __ATOMIC_RELEASE);
+}
+
+static void
+TEST_NAME(rtmodes_batchcb)(void* userdata, const LTFAT_COMPLEX in[], int M2,
+                           int N, int W, LTFAT_COMPLEX out[])
+{
+    (void) userdata;
+    for (int w = 0; w < W; w++)
+        for (int n = 0; n < N; n++)
+            for (int m = 0; m < M2; m++)
+                out[m + (n + w * N) * M2] =
+                    in[m + (n + w * N) * M2] * (LTFAT_REAL)(1.0 + 0.5 * (m % 3) + w);
+}
+
+/* The batch, interleaved and worker modes must give the output of the
+ * frame-by-frame mode, the worker mode delayed by its latency. In the last
+ * mode, the worker stalls until it misses some output. The output must be
+ * delayed by the latency again once it has caught up. */
+int TEST_NAME(test_rtdgtreal_modes)()
+{
+    ltfat_int gl = 256, a = 64, M = 256, W = 2, bufLenMax = 512;
+    ltfat_int latency = 2 * bufLenMax;
+    // Trailing blocks of zeros flush the latency of the worker
+    int nblocks = 40, ntail = 3;
+    ltfat_int blLen[43];
+    int frames[43];
+    ltfat_int Lsig = 0, Ltotal = 0;
+    double tol = sizeof(LTFAT_REAL) == sizeof(double) ? 1e-10 : 1e-4;
+    int framecount = 0;
+    // Blocks executed while the worker stalls
+    int stallStart = 10, stallEnd = stallStart;
+    ltfat_int alignedFrom = 0;
+
+    for (int b = 0; b < nblocks + ntail; b++)
+    {
+        blLen[b] = b < nblocks ? 1 + (b * 97) % bufLenMax : bufLenMax;
+        if (b < nblocks) Lsig += blLen[b];
+        Ltotal += blLen[b];
+    }
+
+    LTFAT_REAL* f = LTFAT_NAME_REAL(calloc)(Ltotal * W);
+    LTFAT_REAL* fref = LTFAT_NAME_REAL(malloc)(Ltotal * W);
+    LTFAT_REAL* fout = LTFAT_NAME_REAL(malloc)(Ltotal * W);
+    LTFAT_REAL* bufin = LTFAT_NAME_REAL(malloc)(bufLenMax * W);
+    LTFAT_REAL* bufout = LTFAT_NAME_REAL(malloc)(bufLenMax * W);
+    for (ltfat_int w = 0; w < W; w++)
+        TEST_NAME(fillRand)(f + w * Ltotal, Lsig);
+
+    for (int mode = 0; mode < 5; mode++)
+    {
+        LTFAT_NAME(rtdgtreal_processor_state)* p = NULL;
+        LTFAT_REAL* o = mode == 0 ? fref : fout;
+        ltfat_int pos = 0;
+        int overflow = 0;
+
+        framecount = 0;
+
+        mu_assert( LTFAT_NAME(rtdgtreal_processor_init_win)(LTFAT_HANN, gl, a, M,
+                   W, bufLenMax, gl - 1, &p) == LTFATERR_SUCCESS,
+                   "rtdgtreal_processor_init_win");
+        LTFAT_NAME(rtdgtreal_processor_setcallback)(p, TEST_NAME(rtmodes_cb),
+                mode == 0 || mode >= 3 ? &framecount : NULL);
+        if (mode == 1)
+            LTFAT_NAME(rtdgtreal_processor_setbatchcallback)(
+                p, TEST_NAME(rtmodes_batchcb), NULL);
+        if (mode >= 3)
+            mu_assert( LTFAT_NAME(rtdgtreal_processor_startworker)(p, latency)
+                       == LTFATERR_SUCCESS, "rtdgtreal_processor_startworker");
+
+        for (int b = 0; b < nblocks + ntail; b++)
+        {
+            ltfat_int bl = blLen[b];
+            int status = LTFATERR_SUCCESS;
+
+            if (mode == 4 && b == stallStart)
+                __atomic_store_n(&TEST_NAME(rtmodes_stall), 1, __ATOMIC_RELEASE);
+
+            if (mode == 2)
+            {
+                // Interleaved in place
+                for (ltfat_int w = 0; w < W; w++)
+                    for (ltfat_int l = 0; l < bl; l++)
+                        bufout[w + l * W] = f[pos + l + w * Ltotal];
+                LTFAT_NAME(rtdgtreal_processor_execute_interleaved)(
+                    p, bufout, bl, W, bufout);
+                for (ltfat_int w = 0; w < W; w++)
+                    for (ltfat_int l = 0; l < bl; l++)
+                        o[pos + l + w * Ltotal] = bufout[w + l * W];
+            }
+            else
+            {
+                for (ltfat_int w = 0; w < W; w++)
+                    memcpy(bufin + w * bl, f + pos + w * Ltotal, bl * sizeof * f);
+                status = LTFAT_NAME(rtdgtreal_processor_execute_compact)(p, bufin,
+                         bl, W, bufout);
+                for (ltfat_int w = 0; w < W; w++)
+                    memcpy(o + pos + w * Ltotal, bufout + w * bl, bl * sizeof * f);
+            }
+
+            if (mode == 0) frames[b] = framecount;
+
+            if (status == LTFATERR_OVERFLOW) overflow = 1;
+
+            // Stall until some output is missing
+            if (mode == 4 && __atomic_load_n(&TEST_NAME(rtmodes_stall), __ATOMIC_ACQUIRE))
+            {
+                if (LTFAT_NAME(rtdgtreal_processor_getunderruns)(p) == 0)
+                {
+                    pos += bl;
+                    continue;
+                }
+                __atomic_store_n(&TEST_NAME(rtmodes_stall), 0, __ATOMIC_RELEASE);
+                stallEnd = b + 1;
+                alignedFrom = pos + bl;
+            }
+
+            /* Give the worker time to catch up, the audio thread would be
+             * waiting for the next buffer */
+            if (mode >= 3)
+            {
+                clock_t start = clock();
+                while (__atomic_load_n(&framecount, __ATOMIC_ACQUIRE) < frames[b] &&
+                       clock() - start < 2 * CLOCKS_PER_SEC);
+            }
+
+            pos += bl;
+        }
+
+        if (mode == 3)
+            mu_assert( LTFAT_NAME(rtdgtreal_processor_getunderruns)(p) == 0,
+                       "Worker mode keeps up");
+        if (mode == 4)
+        {
+            __atomic_store_n(&TEST_NAME(rtmodes_stall), 0, __ATOMIC_RELEASE);
+            mu_assert( stallEnd > stallStart && stallEnd < nblocks,
+                       "Stalled worker misses output");
+        }
+        if (mode >= 3)
+            LTFAT_NAME(rtdgtreal_processor_stopworker)(p);
+        mu_assert( !overflow, "No input dropped");
+        LTFAT_NAME(rtdgtreal_processor_done)(&p);
+
+        if (mode == 0)
+            continue;
+
+        double err = 0.0;
+        ltfat_int shift = mode >= 3 ? latency : 0;
+        // The output the stalled worker missed is not compared
+        ltfat_int from = mode == 4 ? alignedFrom : shift;
+        for (ltfat_int w = 0; w < W; w++)
+        {
+            double e = TEST_NAME(maxDiff)(fref + w * Ltotal + from - shift,
+                                          fout + w * Ltotal + from, Ltotal - from);
+            if (e > err) err = e;
+        }
+
+        const char* msg[] = {"", "Batch mode equals frame mode",
+                             "Interleaved mode equals frame mode",
+                             "Worker mode equals frame mode",
+                             "Worker mode stays aligned after an underrun"
+                            };
+        mu_assert( err < tol, msg[mode]);
+    }
+
+    ltfat_free(f);
+    ltfat_free(fref);
+    ltfat_free(fout);
+    ltfat_free(bufin);
+    ltfat_free(bufout);
+    return 0;
+}
@@ -0,0 +1,216 @@
+#include "ltfat/thirdparty/fftw3.h"
+#include <time.h>
+
+/* Non-NULL userdata makes the callbacks allocate */
+static void
+TEST_NAME(rtsafe_cb)(void* userdata, const LTFAT_COMPLEX in[], int M2, int W,
+                     LTFAT_COMPLEX out[])
+{
+    if (userdata) ltfat_free(ltfat_malloc(16));
+    memcpy(out, in, M2 * W * sizeof * out);
+}
+
+static void
+TEST_NAME(rtsafe_batchcb)(void* userdata, const LTFAT_COMPLEX in[], int M2,
+                          int N, int W, LTFAT_COMPLEX out[])
+{
+    if (userdata) ltfat_free(ltfat_malloc(16));
+    memcpy(out, in, M2 * N * W * sizeof * out);
+}
+
+static void
+TEST_NAME(rtsafe_groupcb)(void* userdata, const LTFAT_COMPLEX in[], int M2,
+                          int chanStart, int W, LTFAT_COMPLEX out[])
+{
+    (void) chanStart;
+    if (userdata) ltfat_free(ltfat_malloc(16));
+    memcpy(out, in, M2 * W * sizeof * out);
+}
+
+static int
+TEST_NAME(rtsafe_slicecb)(void* userdata, const LTFAT_REAL in[], int winLen,
+                          int taperLen, int zpadLen, int W, LTFAT_REAL out[])
+{
+    (void) taperLen; (void) zpadLen;
+    if (userdata) ltfat_free(ltfat_malloc(16));
+    memcpy(out, in, winLen * W * sizeof * out);
+    return 0;
+}
+
+/* Runs a DGT plan with nthreads > 1, which has to wait for the shared pool */
+static int
+TEST_NAME(rtsafe_dgtcb)(void* userdata, const LTFAT_REAL in[], int winLen,
+                        int W, LTFAT_REAL out[])
+{
+    LTFAT_COMPLEX c[(1024 / 64) * (256 / 2 + 1) * 2];
+    LTFAT_NAME(dgtreal_fb_execute)((LTFAT_NAME(dgtreal_fb_plan)*) userdata,
+                                   in, winLen, W, c);
+    memcpy(out, in, winLen * W * sizeof * out);
+    return 0;
+}
+
+/* Runs the processor in mode 0: frame, 1: batch, 2: worker, 3: parallel */
+static size_t
+TEST_NAME(rtsafe_rtdgtreal)(int mode, int do_alloc, LTFAT_REAL* in,
+                            LTFAT_REAL* out, ltfat_int L, ltfat_int W, int nblocks)
+{
+    LTFAT_NAME(rtdgtreal_processor_state)* p = NULL;
+    void* ud = do_alloc ? (void*) 1 : NULL;
+
+    if (LTFAT_NAME(rtdgtreal_processor_init_win)(LTFAT_HANN, 1024, 256, 1024,
+            W, L, 1023, &p)) return (size_t) -1;
+
+    LTFAT_NAME(rtdgtreal_processor_setcallback)(p, TEST_NAME(rtsafe_cb), ud);
+    if (mode == 1)
+        LTFAT_NAME(rtdgtreal_processor_setbatchcallback)(
+            p, TEST_NAME(rtsafe_batchcb), ud);
+    if (mode == 2)
+        LTFAT_NAME(rtdgtreal_processor_startworker)(p, 1024);
+    if (mode == 3)
+    {
+        LTFAT_NAME(rtdgtreal_processor_set_numthreads)(p, 2);
+        LTFAT_NAME(rtdgtreal_processor_setgroupcallback)(
+            p, TEST_NAME(rtsafe_groupcb), ud);
+    }
+
+    ltfat_rtsafe_resetviolations();
+    for (int b = 0; b < nblocks; b++)
+        LTFAT_NAME(rtdgtreal_processor_execute_compact)(p, in, L, W, out);
+
+    /* The execute calls do not wait for the worker, give it a chance to
+     * process something. Stopping joins it. */
+    if (mode == 2)
+    {
+        clock_t start = clock();
+        while (do_alloc && ltfat_rtsafe_getviolations() == 0 &&
+               clock() - start < 2 * CLOCKS_PER_SEC);
+        LTFAT_NAME(rtdgtreal_processor_stopworker)(p);
+    }
+
+    size_t violations = ltfat_rtsafe_getviolations();
+    LTFAT_NAME(rtdgtreal_processor_done)(&p);
+    return violations;
+}
+
+static size_t
+TEST_NAME(rtsafe_slicing)(int nthreads, int do_alloc, LTFAT_REAL* in,
+                          LTFAT_REAL* out, ltfat_int L, ltfat_int W, int nblocks)
+{
+    LTFAT_NAME(slicing_processor_state)* p = NULL;
+
+    if (LTFAT_NAME(slicing_processor_init)(2048, 512, 256, W, L, &p))
+        return (size_t) -1;
+
+    LTFAT_NAME(slicing_processor_setcallback)(p, TEST_NAME(rtsafe_slicecb),
+            do_alloc ? (void*) 1 : NULL);
+    LTFAT_NAME(slicing_processor_set_numthreads)(p, nthreads);
+
+    ltfat_rtsafe_resetviolations();
+    for (int b = 0; b < nblocks; b++)
+        LTFAT_NAME(slicing_processor_execute_compact)(p, in, L, W, out);
+
+    /* Waits for the batch in flight */
+    LTFAT_NAME(slicing_processor_done)(&p);
+    return ltfat_rtsafe_getviolations();
+}
+
+int TEST_NAME(test_rtsafe)()
+{
+    ltfat_int L = 512, W = 2;
+    int nblocks = 40;
+    const char* rtdgtrealmodes[] = {"frame", "batch", "worker", "parallel"};
+    char msg[128];
+
+    LTFAT_REAL* in = LTFAT_NAME_REAL(malloc)(L * W);
+    LTFAT_REAL* out = LTFAT_NAME_REAL(malloc)(L * W);
+    TEST_NAME(fillRand)(in, L * W);
+
+    ltfat_rtsafe_policy oldpolicy = ltfat_rtsafe_setpolicy(ltfat_rtsafe_count);
+
+    for (int mode = 0; mode < 4; mode++)
+    {
+        sprintf(msg, "rtdgtreal_processor %s mode is real-time safe",
+                rtdgtrealmodes[mode]);
+        mu_assert( TEST_NAME(rtsafe_rtdgtreal)(mode, 0, in, out, L, W,
+                   nblocks) == 0, msg);
+
+        /* Also checks that the threads of the processor are covered */
+        sprintf(msg, "rtdgtreal_processor %s mode reports allocating callback",
+                rtdgtrealmodes[mode]);
+        size_t v = TEST_NAME(rtsafe_rtdgtreal)(mode, 1, in, out, L, W, nblocks);
+        mu_assert( v > 0 && v != (size_t) -1, msg);
+    }
+
+    // block_processor, the callback runs a DGT plan with nthreads = 2
+    {
+        LTFAT_NAME(block_processor_state)* p = NULL;
+        LTFAT_NAME(dgtreal_fb_plan)* plan = NULL;
+        LTFAT_REAL* g = LTFAT_NAME_REAL(malloc)(256);
+        LTFAT_NAME_REAL(firwin)(LTFAT_HANN, 256, g);
+
+        mu_assert( LTFAT_NAME(block_processor_init)(1024, 256, W, L, 1024, &p)
+                   == LTFATERR_SUCCESS, "block_processor_init");
+        mu_assert( LTFAT_NAME(dgtreal_fb_init)(g, 256, 64, 256, LTFAT_FREQINV,
+                   FFTW_ESTIMATE, &plan) == LTFATERR_SUCCESS, "dgtreal_fb_init");
+
+        LTFAT_NAME(block_processor_setcallback)(p, TEST_NAME(rtsafe_dgtcb), plan);
+        ltfat_rtsafe_resetviolations();
+        for (int b = 0; b < nblocks; b++)
+            LTFAT_NAME(block_processor_execute_compact)(p, in, L, W, L, out);
+        mu_assert( ltfat_rtsafe_getviolations() == 0, "block_processor is real-time safe");
+
+        LTFAT_NAME(dgtreal_fb_set_numthreads)(plan, 2);
+        ltfat_rtsafe_resetviolations();
+        for (int b = 0; b < nblocks; b++)
+            LTFAT_NAME(block_processor_execute_compact)(p, in, L, W, L, out);
+        mu_assert( ltfat_rtsafe_getviolations() > 0,
+                   "Waiting for the shared thread pool reported");
+
+        LTFAT_NAME(block_processor_done)(&p);
+        LTFAT_NAME(dgtreal_fb_done)(&plan);
+        ltfat_free(g);
+    }
+
+    for (int nthreads = 1; nthreads <= 2; nthreads++)
+    {
+        sprintf(msg, "slicing_processor with %d threads is real-time safe", nthreads);
+        mu_assert( TEST_NAME(rtsafe_slicing)(nthreads, 0, in, out, L, W,
+                   nblocks) == 0, msg);
+
+        sprintf(msg, "slicing_processor with %d threads reports allocating callback",
+                nthreads);
+        size_t v = TEST_NAME(rtsafe_slicing)(nthreads, 1, in, out, L, W, nblocks);
+        mu_assert( v > 0 && v != (size_t) -1, msg);
+    }
+
+    for (int nthreads = 1; nthreads <= 2; nthreads++)
+    {
+        LTFAT_NAME(dgtrealmp_parbuf)* pb = NULL;
+        LTFAT_NAME(slidgtrealmp_state)* p = NULL;
+
+        LTFAT_NAME(dgtrealmp_parbuf_init)(&pb);
+        LTFAT_NAME(dgtrealmp_parbuf_add_firwin)(pb, LTFAT_BLACKMAN, 256, 64, 256);
+        mu_assert( LTFAT_NAME(slidgtrealmp_init)(pb, 2048, W, L, &p)
+                   == LTFATERR_SUCCESS, "slidgtrealmp_init");
+        LTFAT_NAME(slidgtrealmp_set_numthreads)(p, nthreads);
+
+        ltfat_rtsafe_resetviolations();
+        for (int b = 0; b < nblocks; b++)
+            LTFAT_NAME(slidgtrealmp_execute_compact)(p, in, L, W, out);
+        LTFAT_NAME(slidgtrealmp_done)(&p);
+
+        sprintf(msg, "slidgtrealmp with %d threads is real-time safe", nthreads);
+        mu_assert( ltfat_rtsafe_getviolations() == 0, msg);
+        LTFAT_NAME(dgtrealmp_parbuf_done)(&pb);
+    }
+
+    // Nothing is reported outside of the execute functions
+    ltfat_rtsafe_resetviolations();
+    ltfat_free(ltfat_malloc(16));
+    mu_assert( ltfat_rtsafe_getviolations() == 0, "Allocation outside execute not reported");
+
+    ltfat_rtsafe_setpolicy(oldpolicy);
+    ltfat_free(in);
+    ltfat_free(out);
+    return 0;
+}
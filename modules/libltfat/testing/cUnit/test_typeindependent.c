@@ -4,8 +4,16 @@
 #include "test_fftrealcircshift.c"
 #include "test_fftrealfftshift.c"
 #include "test_fftrealifftshift.c"
+#include "test_fft.c"
+#include "test_maxtree.c"
 #include "test_pgauss.c"
 #include "test_dgtreal_fb.c"
 #include "test_idgtreal_fb.c"
 #include "test_dgtreal_long.c"
 #include "test_idgtreal_long.c"
+#include "test_dgtreal_execute_ws.c"
+#include "test_wfac_cache.c"
+#include "test_dgtrealmp_batch.c"
+#include "test_dgtrealmp_dict.c"
+#include "test_rtdgtreal_modes.c"
+#include "test_rtsafe.c"
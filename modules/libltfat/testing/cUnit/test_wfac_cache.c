@@ -0,0 +1,117 @@
+#include "ltfat/thirdparty/fftw3.h"
+
+int TEST_NAME(test_wfac_cache)()
+{
+    ltfat_int L = 240, a = 20, M = 30, W = 2;
+    ltfat_int N = L / a, M2 = M / 2 + 1;
+    double tol = sizeof(LTFAT_REAL) == sizeof(double) ? 1e-8 : 1e-2;
+    ltfat_wfac_cache_stats st0, st;
+    LTFAT_NAME(dgtreal_long_plan)* p1 = NULL;
+    LTFAT_NAME(dgtreal_long_plan)* p2 = NULL;
+    LTFAT_NAME(idgtreal_long_plan)* ip = NULL;
+
+    LTFAT_REAL* f = LTFAT_NAME_REAL(malloc)(L * W);
+    LTFAT_REAL* g = LTFAT_NAME_REAL(malloc)(L);
+    LTFAT_REAL* g2 = LTFAT_NAME_REAL(malloc)(L);
+    LTFAT_COMPLEX* c1 = LTFAT_NAME_COMPLEX(malloc)(M2 * N * W);
+    LTFAT_COMPLEX* c2 = LTFAT_NAME_COMPLEX(malloc)(M2 * N * W);
+    LTFAT_COMPLEX* cref = LTFAT_NAME_COMPLEX(malloc)(M2 * N * W);
+    TEST_NAME(fillRand)(f, L * W);
+    TEST_NAME(fillRand)(g, L);
+    memcpy(g2, g, L * sizeof * g);
+    g2[L / 2] += 1;
+
+    ltfat_wfac_cache_get_stats(&st0);
+    size_t oldlimit = st0.limit;
+    ltfat_wfac_cache_clear();
+
+    // Plans with the same window share one entry
+    ltfat_wfac_cache_get_stats(&st0);
+    mu_assert( LTFAT_NAME(dgtreal_long_init)(g, L, W, a, M, f, c1, LTFAT_FREQINV,
+               FFTW_ESTIMATE, &p1) == LTFATERR_SUCCESS, "dgtreal_long_init");
+    mu_assert( LTFAT_NAME(dgtreal_long_init)(g, L, W, a, M, f, c2, LTFAT_FREQINV,
+               FFTW_ESTIMATE, &p2) == LTFATERR_SUCCESS, "dgtreal_long_init");
+    mu_assert( LTFAT_NAME(idgtreal_long_init)(g, L, W, a, M, c1, f, LTFAT_FREQINV,
+               FFTW_ESTIMATE, &ip) == LTFATERR_SUCCESS, "idgtreal_long_init");
+    ltfat_wfac_cache_get_stats(&st);
+    mu_assert( st.misses == st0.misses + 1 && st.hits == st0.hits + 2 &&
+               st.entries == st0.entries + 1 && st.inuse == st0.inuse + 1,
+               "Same window shares the factorization");
+
+    LTFAT_NAME(dgtreal_fb)(f, g, L, L, W, a, M, LTFAT_FREQINV, cref);
+    LTFAT_NAME(dgtreal_long_execute_newarray)(p1, f, c1);
+    LTFAT_NAME(dgtreal_long_execute_newarray)(p2, f, c2);
+    mu_assert( TEST_NAME_COMPLEX(maxDiff)(c1, cref, M2 * N * W) < tol &&
+               TEST_NAME_COMPLEX(maxDiff)(c2, c1, M2 * N * W) == 0,
+               "Shared factorization gives the same coefficients");
+
+    LTFAT_NAME(dgtreal_long_done)(&p1);
+    LTFAT_NAME(dgtreal_long_done)(&p2);
+    LTFAT_NAME(idgtreal_long_done)(&ip);
+    ltfat_wfac_cache_get_stats(&st);
+    mu_assert( st.entries == st0.entries + 1 && st.inuse == st0.inuse,
+               "Released entry is kept");
+
+    // Re-created plan reuses the released entry
+    ltfat_wfac_cache_get_stats(&st0);
+    LTFAT_NAME(dgtreal_long_init)(g, L, W, a, M, f, c1, LTFAT_FREQINV,
+                                  FFTW_ESTIMATE, &p1);
+    ltfat_wfac_cache_get_stats(&st);
+    mu_assert( st.hits == st0.hits + 1 && st.misses == st0.misses,
+               "Released entry is reused");
+
+    // A different window must not hit
+    LTFAT_NAME(dgtreal_long_init)(g2, L, W, a, M, f, c2, LTFAT_FREQINV,
+                                  FFTW_ESTIMATE, &p2);
+    ltfat_wfac_cache_get_stats(&st);
+    mu_assert( st.misses == st0.misses + 1 && st.entries == st0.entries + 1,
+               "Different window gets its own entry");
+    LTFAT_NAME(dgtreal_fb)(f, g2, L, L, W, a, M, LTFAT_FREQINV, cref);
+    LTFAT_NAME(dgtreal_long_execute_newarray)(p2, f, c2);
+    mu_assert( TEST_NAME_COMPLEX(maxDiff)(c2, cref, M2 * N * W) < tol,
+               "Different window gives its own coefficients");
+    LTFAT_NAME(dgtreal_long_done)(&p2);
+
+    // Limit of a single entry evicts the least recently released one
+    ltfat_wfac_cache_clear();
+    LTFAT_NAME(dgtreal_long_done)(&p1);
+    ltfat_wfac_cache_get_stats(&st);
+    mu_assert( st.entries == 1 && st.inuse == 0, "Only the released entry left");
+    ltfat_wfac_cache_set_limit(st.bytes);
+
+    ltfat_wfac_cache_get_stats(&st0);
+    LTFAT_NAME(dgtreal_long_init)(g2, L, W, a, M, f, c2, LTFAT_FREQINV,
+                                  FFTW_ESTIMATE, &p2);
+    LTFAT_NAME(dgtreal_long_done)(&p2);
+    ltfat_wfac_cache_get_stats(&st);
+    mu_assert( st.evictions == st0.evictions + 1 && st.entries == 1,
+               "Least recently released entry evicted");
+
+    ltfat_wfac_cache_get_stats(&st0);
+    LTFAT_NAME(dgtreal_long_init)(g2, L, W, a, M, f, c2, LTFAT_FREQINV,
+                                  FFTW_ESTIMATE, &p2);
+    ltfat_wfac_cache_get_stats(&st);
+    mu_assert( st.hits == st0.hits + 1, "Most recently released entry kept");
+
+    // Entries in use are never evicted, but they are still shared
+    ltfat_wfac_cache_set_limit(0);
+    LTFAT_NAME(dgtreal_long_init)(g2, L, W, a, M, f, c1, LTFAT_FREQINV,
+                                  FFTW_ESTIMATE, &p1);
+    ltfat_wfac_cache_get_stats(&st);
+    mu_assert( st.entries == 1 && st.inuse == 1 && st.hits == st0.hits + 2,
+               "Entry in use kept with zero limit");
+    LTFAT_NAME(dgtreal_long_done)(&p1);
+    LTFAT_NAME(dgtreal_long_done)(&p2);
+    ltfat_wfac_cache_get_stats(&st);
+    mu_assert( st.entries == 0 && st.bytes == 0,
+               "Zero limit keeps no released entries");
+
+    ltfat_wfac_cache_set_limit(oldlimit);
+    ltfat_free(f);
+    ltfat_free(g);
+    ltfat_free(g2);
+    ltfat_free(c1);
+    ltfat_free(c2);
+    ltfat_free(cref);
+    return 0;
+}
@@ -607,3 +607,22 @@ LTFAT_KISS(fftri)(LTFAT_KISS(fftr_plan)* st,const kiss_fft_cpx *freqdata,kiss_ff
     }
     LTFAT_KISS(fft)(st->substate, st->tmpbuf, (kiss_fft_cpx *) timedata);
 }
+
+void
+LTFAT_KISS(fftr_tmp)(const LTFAT_KISS(fftr_plan)* cfg, const kiss_fft_scalar *timedata,
+                     kiss_fft_cpx *freqdata, kiss_fft_cpx *tmpbuf)
+{
+    /* cfg is read-only apart from tmpbuf, work on a copy using the caller's one */
+    LTFAT_KISS(fftr_plan) st = *cfg;
+    if (tmpbuf) st.tmpbuf = tmpbuf;
+    LTFAT_KISS(fftr)(&st, timedata, freqdata);
+}
+
+void
+LTFAT_KISS(fftri_tmp)(const LTFAT_KISS(fftr_plan)* cfg, const kiss_fft_cpx *freqdata,
+                      kiss_fft_scalar *timedata, kiss_fft_cpx *tmpbuf)
+{
+    LTFAT_KISS(fftr_plan) st = *cfg;
+    if (tmpbuf) st.tmpbuf = tmpbuf;
+    LTFAT_KISS(fftri)(&st, freqdata, timedata);
+}